@@ -22,7 +22,8 @@ let package = Package(
         .executable(name: "DcmSR", targets: ["DcmSR"]),
         .executable(name: "DcmGet", targets: ["DcmGet"]),
         .executable(name: "DcmMove", targets: ["DcmMove"]),
-        .executable(name: "DcmDecompress", targets: ["DcmDecompress"])
+        .executable(name: "DcmDecompress", targets: ["DcmDecompress"]),
+        .executable(name: "DcmJ2KBench", targets: ["DcmJ2KBench"])
     ],
     dependencies: [
         // Dependencies declare other packages that this package depends on.
@@ -65,7 +66,29 @@ let package = Package(
                 .define("OJPH_DISABLE_TIFF_SUPPORT", to: "1"),
                 .define("OJPH_DISABLE_TIFF", to: "1"),
                 .define("OJPH_DISABLE_WASM_SIMD", to: "1"),
-                .unsafeFlags(["-std=c++17"], .when(platforms: [.macOS, .iOS]))
+                .unsafeFlags(["-std=c++17"], .when(platforms: [.macOS, .iOS])),
+                // the SIMD kernels must round as the generic ones do; a fused
+                // multiply-add would not
+                .unsafeFlags(["-ffp-contract=off"])
+            ]
+        ),
+        // Microbenchmarks of OpenJPH's internal kernels, for DcmJ2KBench; kept
+        // out of the OpenJPH target so that apps do not link them
+        .target(
+            name: "OpenJPHKernelBench",
+            dependencies: ["OpenJPH"],
+            path: "Sources/OpenJPHKernelBench",
+            publicHeadersPath: "include",
+            cxxSettings: [
+                .headerSearchPath("../OpenJPH/core"),
+                .headerSearchPath("../OpenJPH/core/common"),
+                .headerSearchPath("../OpenJPH/core/others"),
+                .headerSearchPath("../OpenJPH/core/codestream"),
+                .headerSearchPath("../OpenJPH/core/coding"),
+                .headerSearchPath("../OpenJPH/core/transform"),
+                .define("OJPH_DISABLE_WASM_SIMD", to: "1"),
+                .unsafeFlags(["-std=c++17"], .when(platforms: [.macOS, .iOS])),
+                .unsafeFlags(["-ffp-contract=off"])
             ]
         ),
         .executableTarget(
@@ -127,11 +150,22 @@ let package = Package(
             dependencies: [
                 "DcmSwift"
             ]),
+        .executableTarget(
+            name: "DcmJ2KBench",
+            dependencies: [
+                "OpenJPH",
+                "OpenJPHKernelBench",
+                .product(name: "ArgumentParser", package: "swift-argument-parser")
+            ]),
         .testTarget(
             name: "DcmSwiftTests",
-            dependencies: ["DcmSwift"],
+            dependencies: ["DcmSwift", "OpenJPH"],
+            exclude: [
+                "Resources/make_j2k_part1.py"
+            ],
             resources: [
-                .process("../DICOM_Test")
+                .process("../DICOM_Test"),
+                .copy("Resources/J2KPart1")
             ]
         )
     ]
@@ -0,0 +1,457 @@
+//
+//  DcmJ2KBench - Native JPEG 2000 / HTJ2K decode benchmark
+//  DcmSwift
+//
+//  Decodes every raw codestream (.j2c, .j2k, .jph, .jhc) of a directory with
+//  the OpenJPH decoder and prints throughput, per-frame latency percentiles,
+//  peak memory and thread scaling as JSON, so that runs can be compared
+//  across releases. The kernels mode times the SIMD variants of the inner
+//  decoder kernels against each other instead.
+//
+
+import Foundation
+import OpenJPH
+import OpenJPHKernelBench
+import ArgumentParser
+
+
+enum BenchMode: String, ExpressibleByArgument, Codable {
+    /// Whole image, as `ojph_decode_image` decodes it.
+    case full
+    /// Reduced resolution, as `ojph_decode_thumbnail` decodes it.
+    case thumbnail
+    /// A window of the image, as `ojph_decode_region` decodes it.
+    case region
+    /// All files at once per pass, through `ojph_decode_frames`.
+    case batch
+    /// Every variant of the block decoder, line transfer and wavelet kernels,
+    /// through `ojph_benchmark_kernels`, on synthetic data and on the
+    /// codeblocks and rows of the files.
+    case kernels
+}
+
+struct LatencySummary: Codable {
+    let min: Double
+    let p50: Double
+    let p90: Double
+    let p99: Double
+    let max: Double
+    let mean: Double
+
+    init(_ samples: [Double]) {
+        let sorted = samples.sorted()
+        func percentile(_ p: Double) -> Double {
+            guard !sorted.isEmpty else { return 0 }
+            return sorted[Int((p / 100 * Double(sorted.count - 1)).rounded())]
+        }
+        min = sorted.first ?? 0
+        p50 = percentile(50)
+        p90 = percentile(90)
+        p99 = percentile(99)
+        max = sorted.last ?? 0
+        mean = sorted.isEmpty ? 0 : sorted.reduce(0, +) / Double(sorted.count)
+    }
+}
+
+struct BenchRun: Codable {
+    let threads: Int
+    let frames: Int
+    let errors: Int
+    let seconds: Double
+    let megapixelsPerSecond: Double
+    let framesPerSecond: Double
+    /// Throughput relative to the first run, normally the single-thread one.
+    let speedup: Double
+    let latencyMs: LatencySummary
+    /// Largest amount of memory lent by the OpenJPH pool so far.
+    let peakPoolBytes: Int
+    /// Largest resident set of the process so far.
+    let peakResidentBytes: Int
+}
+
+struct BenchFailure: Codable {
+    let file: String
+    let error: String
+}
+
+struct BenchReport: Codable {
+    let mode: BenchMode
+    /// What one latency sample measures: one `frame`, or one `batch` of all files.
+    let latencyUnit: String
+    let files: Int
+    /// Output pixels of one pass over all files.
+    let pixelsPerPass: Int
+    let iterations: Int
+    let reuseDecoder: Bool
+    let discardLevels: UInt32
+    let region: [UInt32]?
+    let runs: [BenchRun]
+    let failures: [BenchFailure]
+}
+
+struct KernelTiming: Codable {
+    let kernel: String
+    let variant: String
+    /// `synthetic`, or `captured` from the files.
+    let input: String
+    /// The variant that the decoder selects on this CPU.
+    let dispatched: Bool
+    let samples: UInt64
+    let passes: UInt64
+    let nsPerSample: Double
+    /// Speed relative to the `gen` variant of the same kernel and input.
+    let speedup: Double
+    /// Largest output difference to the `gen` variant; 0 for the integer kernels
+    /// unless one of them is broken.
+    let maxAbsError: Double
+}
+
+struct KernelReport: Codable {
+    let mode: BenchMode
+    let files: Int
+    let minSeconds: Double
+    let timings: [KernelTiming]
+}
+
+/// A codestream loaded into memory, with the number of pixels it decodes to.
+struct BenchStream {
+    let name: String
+    let bytes: UnsafeMutablePointer<UInt8>
+    let length: Int
+    var pixels: Int = 0
+}
+
+final class Benchmark {
+    let mode: BenchMode
+    let iterations: Int
+    let reuseDecoder: Bool
+    let options: ojph_decode_options
+    var streams: [BenchStream] = []
+    var failures: [BenchFailure] = []
+
+    init(mode: BenchMode, iterations: Int, reuseDecoder: Bool,
+         options: ojph_decode_options) {
+        self.mode = mode
+        self.iterations = iterations
+        self.reuseDecoder = reuseDecoder
+        self.options = options
+    }
+
+    deinit {
+        for stream in streams {
+            stream.bytes.deallocate()
+        }
+    }
+
+    func load(directory: String) throws {
+        let extensions: Set<String> = ["j2c", "j2k", "jph", "jhc"]
+        let url = URL(fileURLWithPath: directory)
+        let names = try FileManager.default.contentsOfDirectory(atPath: directory)
+            .filter { extensions.contains(($0 as NSString).pathExtension.lowercased()) }
+            .sorted()
+        for name in names {
+            let data = try Data(contentsOf: url.appendingPathComponent(name))
+            guard !data.isEmpty else { continue }
+            let bytes = UnsafeMutablePointer<UInt8>.allocate(capacity: data.count)
+            data.copyBytes(to: bytes, count: data.count)
+            streams.append(BenchStream(name: name, bytes: bytes, length: data.count))
+        }
+    }
+
+    /// Decodes every stream once, recording its output size, and drops the
+    /// ones that fail; this also warms up caches and the memory pool.
+    func validate() {
+        var message = [CChar](repeating: 0, count: 256)
+        var valid: [BenchStream] = []
+        for var stream in streams {
+            var options = self.options
+            var image = ojph_decoded_image()
+            let status = ojph_decode_with_options(nil, stream.bytes, stream.length,
+                                                  &options, &image,
+                                                  &message, message.count)
+            if status == OJPH_STATUS_OK {
+                stream.pixels = Int(image.width) * Int(image.height)
+                ojph_free_image(&image)
+                valid.append(stream)
+            } else {
+                failures.append(BenchFailure(file: stream.name,
+                                             error: String(cString: message)))
+                stream.bytes.deallocate()
+            }
+        }
+        streams = valid
+    }
+
+    var pixelsPerPass: Int {
+        streams.reduce(0) { $0 + $1.pixels }
+    }
+
+    /// Times the kernel variants on codeblocks and rows captured from all
+    /// streams, each pass repeated for at least `minSeconds`.
+    func runKernels(minSeconds: Double) -> [KernelTiming] {
+        let codestreams: [UnsafePointer<UInt8>?] = streams.map { UnsafePointer($0.bytes) }
+        let lengths = streams.map { $0.length }
+        let count = ojph_benchmark_kernels(codestreams, lengths, streams.count,
+                                           minSeconds, nil, 0)
+        var results = [ojph_kernel_timing](repeating: ojph_kernel_timing(), count: count)
+        let written = ojph_benchmark_kernels(codestreams, lengths, streams.count,
+                                             minSeconds, &results, count)
+        let timings = results.prefix(min(count, written))
+        func generic(_ t: ojph_kernel_timing) -> ojph_kernel_timing? {
+            timings.first {
+                strcmp($0.kernel, t.kernel) == 0 && strcmp($0.input, t.input) == 0 &&
+                    strcmp($0.variant, "gen") == 0
+            }
+        }
+        return timings.map { t in
+            let gen = generic(t)?.ns_per_sample ?? 0
+            return KernelTiming(kernel: String(cString: t.kernel),
+                                variant: String(cString: t.variant),
+                                input: String(cString: t.input),
+                                dispatched: t.dispatched != 0,
+                                samples: t.samples,
+                                passes: t.passes,
+                                nsPerSample: t.ns_per_sample,
+                                speedup: t.ns_per_sample > 0 ? gen / t.ns_per_sample : 1,
+                                maxAbsError: t.max_abs_error)
+        }
+    }
+
+    func run(threads: Int, baseline: Double?) -> BenchRun {
+        let samples: [Double]
+        let errors: Int
+        let start = DispatchTime.now().uptimeNanoseconds
+        if mode == .batch {
+            (samples, errors) = runBatches(threads: threads)
+        } else {
+            (samples, errors) = runFrames(threads: threads)
+        }
+        let seconds = Double(DispatchTime.now().uptimeNanoseconds - start) / 1e9
+        let frames = iterations * streams.count
+        let megapixels = Double(iterations * pixelsPerPass) / 1e6
+        let throughput = seconds > 0 ? megapixels / seconds : 0
+
+        var stats = ojph_memory_stats()
+        ojph_get_memory_stats(&stats)
+        return BenchRun(threads: threads, frames: frames, errors: errors,
+                        seconds: seconds,
+                        megapixelsPerSecond: throughput,
+                        framesPerSecond: seconds > 0 ? Double(frames) / seconds : 0,
+                        speedup: (baseline ?? 0) > 0 ? throughput / baseline! : 1,
+                        latencyMs: LatencySummary(samples),
+                        peakPoolBytes: stats.peak_bytes,
+                        peakResidentBytes: peakResidentBytes())
+    }
+
+    /// Spreads `iterations` passes over the streams across `threads` workers,
+    /// each with its own decoder context when `reuseDecoder` is set; returns
+    /// the latency of every frame.
+    private func runFrames(threads: Int) -> ([Double], Int) {
+        let count = streams.count
+        let jobs = iterations * count
+        var latencies = [Double](repeating: 0, count: jobs)
+        var errors = [Int](repeating: 0, count: threads)
+        latencies.withUnsafeMutableBufferPointer { latency in
+            errors.withUnsafeMutableBufferPointer { error in
+                DispatchQueue.concurrentPerform(iterations: threads) { worker in
+                    let decoder = reuseDecoder ? ojph_decoder_create() : nil
+                    defer { ojph_decoder_destroy(decoder) }
+                    var options = self.options
+                    var message = [CChar](repeating: 0, count: 256)
+                    var job = worker
+                    while job < jobs {
+                        let stream = streams[job % count]
+                        var image = ojph_decoded_image()
+                        let t0 = DispatchTime.now().uptimeNanoseconds
+                        let status = ojph_decode_with_options(decoder, stream.bytes,
+                                                              stream.length, &options,
+                                                              &image, &message,
+                                                              message.count)
+                        if status == OJPH_STATUS_OK {
+                            ojph_free_image(&image)
+                        } else {
+                            error[worker] += 1
+                        }
+                        let t1 = DispatchTime.now().uptimeNanoseconds
+                        latency[job] = Double(t1 - t0) / 1e6
+                        job += threads
+                    }
+                }
+            }
+        }
+        return (latencies, errors.reduce(0, +))
+    }
+
+    /// Decodes all streams `iterations` times with `ojph_decode_frames`;
+    /// returns the latency of every batch.
+    private func runBatches(threads: Int) -> ([Double], Int) {
+        let count = streams.count
+        let codestreams: [UnsafePointer<UInt8>?] = streams.map { UnsafePointer($0.bytes) }
+        let lengths = streams.map { $0.length }
+        var images = [ojph_decoded_image](repeating: ojph_decoded_image(), count: count)
+        var statuses = [ojph_status](repeating: OJPH_STATUS_OK, count: count)
+        var latencies: [Double] = []
+        var errors = 0
+        for _ in 0..<iterations {
+            let t0 = DispatchTime.now().uptimeNanoseconds
+            _ = ojph_decode_frames(codestreams, lengths, count, &images, &statuses,
+                                   UInt32(threads))
+            for i in 0..<count {
+                if statuses[i] == OJPH_STATUS_OK {
+                    ojph_free_image(&images[i])
+                } else {
+                    errors += 1
+                }
+            }
+            let t1 = DispatchTime.now().uptimeNanoseconds
+            latencies.append(Double(t1 - t0) / 1e6)
+        }
+        return (latencies, errors)
+    }
+
+    private func peakResidentBytes() -> Int {
+        var usage = rusage()
+        getrusage(RUSAGE_SELF, &usage)
+        #if os(Linux)
+        return usage.ru_maxrss * 1024
+        #else
+        return usage.ru_maxrss
+        #endif
+    }
+}
+
+
+struct DcmJ2KBench: ParsableCommand {
+    static var configuration = CommandConfiguration(
+        abstract: "Benchmark the native JPEG 2000 / HTJ2K decoder and print the results as JSON.")
+
+    @Argument(help: "Directory holding .j2c, .j2k, .jph or .jhc codestreams")
+    var directory: String
+
+    @Option(help: "full, thumbnail, region, batch or kernels")
+    var mode: BenchMode = .full
+
+    @Option(name: .shortAndLong, help: "Passes over all files per thread count")
+    var iterations: Int = 10
+
+    @Option(help: "Comma-separated thread counts; defaults to powers of two up to the core count")
+    var threads: String?
+
+    @Option(help: "Resolution levels discarded in thumbnail and region modes")
+    var discardLevels: UInt32 = 0
+
+    @Option(help: "Window decoded in region mode, as x,y,width,height")
+    var region: String = "0,0,512,512"
+
+    @Option(help: "Seconds each kernel variant is timed for, per input, in kernels mode")
+    var minTime: Double = 0.05
+
+    @Flag(help: "Keep one decoder context per thread instead of a fresh one per frame")
+    var reuseDecoder = false
+
+    @Flag(help: "Indent the JSON output")
+    var pretty = false
+
+    func validate() throws {
+        guard iterations > 0 else {
+            throw ValidationError("--iterations must be positive")
+        }
+        guard minTime > 0 else {
+            throw ValidationError("--min-time must be positive")
+        }
+        _ = try threadCounts()
+        if mode == .region {
+            _ = try regionWindow()
+        }
+    }
+
+    func threadCounts() throws -> [Int] {
+        guard let threads = threads else {
+            let cores = ProcessInfo.processInfo.activeProcessorCount
+            var counts = [1]
+            while counts.last! * 2 < cores {
+                counts.append(counts.last! * 2)
+            }
+            if cores > 1 {
+                counts.append(cores)
+            }
+            return counts
+        }
+        let counts = threads.split(separator: ",").compactMap { Int($0) }
+        guard !counts.isEmpty, counts.allSatisfy({ $0 > 0 }) else {
+            throw ValidationError("--threads expects positive integers, e.g. 1,2,4")
+        }
+        return counts
+    }
+
+    func regionWindow() throws -> [UInt32] {
+        let window = region.split(separator: ",").compactMap { UInt32($0) }
+        guard window.count == 4, window[2] > 0, window[3] > 0 else {
+            throw ValidationError("--region expects x,y,width,height")
+        }
+        return window
+    }
+
+    func run() throws {
+        var options = ojph_decode_options()
+        var window: [UInt32]? = nil
+        switch mode {
+        case .thumbnail:
+            options.discard_levels = discardLevels
+        case .region:
+            let w = try regionWindow()
+            options.discard_levels = discardLevels
+            options.region_x = w[0]
+            options.region_y = w[1]
+            options.region_width = w[2]
+            options.region_height = w[3]
+            window = w
+        case .full, .batch, .kernels:
+            break
+        }
+
+        let bench = Benchmark(mode: mode, iterations: iterations,
+                              reuseDecoder: reuseDecoder, options: options)
+        try bench.load(directory: directory)
+        let encoder = JSONEncoder()
+        encoder.outputFormatting = pretty ? [.prettyPrinted, .sortedKeys] : [.sortedKeys]
+
+        if mode == .kernels {
+            // synthetic inputs are timed even without files
+            let report = KernelReport(mode: mode, files: bench.streams.count,
+                                      minSeconds: minTime,
+                                      timings: bench.runKernels(minSeconds: minTime))
+            print(String(data: try encoder.encode(report), encoding: .utf8)!)
+            return
+        }
+
+        bench.validate()
+        guard !bench.streams.isEmpty else {
+            for failure in bench.failures {
+                FileHandle.standardError.write("\(failure.file): \(failure.error)\n".data(using: .utf8)!)
+            }
+            throw ValidationError("No decodable codestream in \(directory)")
+        }
+
+        var runs: [BenchRun] = []
+        for count in try threadCounts() {
+            runs.append(bench.run(threads: count,
+                                  baseline: runs.first?.megapixelsPerSecond))
+        }
+
+        let report = BenchReport(mode: mode,
+                                 latencyUnit: mode == .batch ? "batch" : "frame",
+                                 files: bench.streams.count,
+                                 pixelsPerPass: bench.pixelsPerPass,
+                                 iterations: iterations,
+                                 reuseDecoder: reuseDecoder,
+                                 discardLevels: mode == .full || mode == .batch ? 0 : discardLevels,
+                                 region: window,
+                                 runs: runs,
+                                 failures: bench.failures)
+        let json = try encoder.encode(report)
+        print(String(data: json, encoding: .utf8)!)
+    }
+}
+
+DcmJ2KBench.main()
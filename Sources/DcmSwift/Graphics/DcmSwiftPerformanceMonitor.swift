@@ -62,6 +62,22 @@ public final class DcmSwiftPerformanceMonitor {
                        token.operation.rawValue, duration * 1000, success ? "true" : "false")
         }
     }
+
+    // MARK: - Native Decoding
+
+    /// Emits the stage breakdown of a native JPEG 2000 / HTJ2K decode as a
+    /// signpost event, so that slow frames can be attributed in Instruments.
+    public func recordNativeDecode(_ stats: J2KNativeDecodeStatistics, label: String = "") {
+        guard enabled else { return }
+        os_signpost(.event,
+                    log: signpostLog,
+                    name: "NativeDecode",
+                    "%{public}@ total: %.3fms, headers: %.3fms, packets: %.3fms, codeblocks: %.3fms, wait: %.3fms, idwt: %.3fms, colour: %.3fms, output: %.3fms, blocks: %ld, zero: %ld",
+                    label, stats.total * 1000, stats.headers * 1000, stats.packets * 1000,
+                    stats.codeblocks * 1000, stats.codeblockWait * 1000,
+                    stats.inverseWavelet * 1000, stats.colourTransform * 1000,
+                    stats.output * 1000, stats.codeblocksDecoded, stats.zeroBlocks)
+    }
 }
 
 // MARK: - Supporting Types
@@ -14,14 +14,703 @@ public struct J2KNativeResult {
     public let components: Int
     public let bitsPerSample: Int
     public let isSigned: Bool
+    /// `true` when the pixels hold one plane of `width * height` samples per
+    /// component, one after the other, instead of interleaved samples.
+    public let isPlanar: Bool
+    /// `true` for float outputs; `pixels16` then holds IEEE half-float bit
+    /// patterns, or `pixels32` holds the samples, see `J2KNativeSampleFormat`.
+    public let isFloat: Bool
     public let pixels8: [UInt8]?
     public let pixels16: [UInt16]?
+    public let pixels32: [Float]?
+}
+
+/// Rows handed over by `J2KNativeDecoder.decodeRows`, in the layout of a
+/// `J2KNativeResult`; `bytes` is only valid while the closure receiving the
+/// band runs.
+public struct J2KNativeRowBand {
+    public let width: Int
+    /// Of the whole image.
+    public let height: Int
+    public let components: Int
+    public let bitsPerSample: Int
+    public let isSigned: Bool
+    public let isPlanar: Bool
+    public let isFloat: Bool
+    /// Image row of the first row of the band.
+    public let firstRow: Int
+    public let rowCount: Int
+    /// Bytes between the starts of two rows, and of two planes when planar.
+    public let rowPitch: Int
+    public let planePitch: Int
+    public let bytes: UnsafeRawBufferPointer
+}
+
+/// Storage of the decoded samples.
+public enum J2KNativeSampleFormat {
+    /// 8-bit or 16-bit integers, as described by `bitsPerSample` and `isSigned`.
+    case integer
+    /// 32-bit floats in `pixels32`, after the sample transform.
+    case float32
+    /// IEEE half floats in `pixels16`, e.g. for half-float textures; values
+    /// beyond the half range become infinities.
+    case float16
+
+    var native: ojph_sample_format {
+        switch self {
+        case .integer: return OJPH_SAMPLE_INTEGER
+        case .float32: return OJPH_SAMPLE_FLOAT32
+        case .float16: return OJPH_SAMPLE_FLOAT16
+        }
+    }
+}
+
+/// Sample transforms the native decoder applies while it converts samples to
+/// their output format, instead of in separate passes over the pixels. When
+/// any is set, `bitsPerSample` and `isSigned` of the result describe the
+/// transformed samples.
+public struct J2KNativeSampleTransform {
+    /// Reflect samples within their nominal range, as MONOCHROME1 requires.
+    public var invert: Bool
+    /// Modality rescale, `value * rescaleSlope + rescaleIntercept`.
+    public var rescaleSlope: Double
+    public var rescaleIntercept: Double
+    /// Added after the rescale, e.g. to turn signed samples into unsigned ones.
+    public var bias: Int32
+
+    public init(invert: Bool = false,
+                rescaleSlope: Double = 1,
+                rescaleIntercept: Double = 0,
+                bias: Int32 = 0) {
+        self.invert = invert
+        self.rescaleSlope = rescaleSlope
+        self.rescaleIntercept = rescaleIntercept
+        self.bias = bias
+    }
+
+    public static let identity = J2KNativeSampleTransform()
+}
+
+/// VOI window applied by the native decoder to the transformed samples,
+/// producing 8-bit display pixels in `pixels8` without a 16-bit pass.
+public struct J2KNativeWindow {
+    /// `VOILUTFunction` of the window.
+    public enum Function {
+        case linear
+        case linearExact
+        case sigmoid
+    }
+
+    public var center: Double
+    public var width: Double
+    public var function: Function
+
+    public init(center: Double, width: Double, function: Function = .linear) {
+        self.center = center
+        self.width = width
+        self.function = function
+    }
+
+    var native: ojph_voi_function {
+        switch function {
+        case .linear: return OJPH_VOI_LINEAR
+        case .linearExact: return OJPH_VOI_LINEAR_EXACT
+        case .sigmoid: return OJPH_VOI_SIGMOID
+        }
+    }
+}
+
+/// What the main header of a codestream tells, read without decoding it; see
+/// `J2KNativeDecoder.probe(_:)`. Sizes are those of the full resolution.
+public struct J2KNativeImageInfo {
+    public let width: Int
+    public let height: Int
+    public let components: Int
+    /// Of component 0.
+    public let bitsPerSample: Int
+    public let isSigned: Bool
+    /// Every component has the bit depth, signedness and sampling of the first.
+    public let isUniform: Bool
+    /// Horizontal and vertical subsampling factors of the first four components.
+    public let subsampling: [(x: Int, y: Int)]
+    /// HTJ2K codeblocks; JPEG 2000 Part 1 ones otherwise.
+    public let isHighThroughput: Bool
+    public let isReversible: Bool
+    public let usesColorTransform: Bool
+    public let tileWidth: Int
+    public let tileHeight: Int
+    public let tilesAcross: Int
+    public let tilesDown: Int
+    /// The most levels `J2KNativeDecoder.decodeThumbnail` can discard.
+    public let decompositionLevels: Int
+    public let qualityLayers: Int
+    public let blockWidth: Int
+    public let blockHeight: Int
+    /// "LRCP", "RLCP", "RPCL", "PCRL" or "CPRL".
+    public let progression: String
+    /// `nil` when the native decoder can decode the codestream; why it cannot
+    /// otherwise.
+    public let unsupportedReason: String?
+    /// Bytes of the pixels a default decode returns; 0 when unsupported.
+    public let decodedSize: Int
+
+    public var isSubsampled: Bool { subsampling.contains { $0.x != 1 || $0.y != 1 } }
+    public var isDecodable: Bool { unsupportedReason == nil }
+}
+
+/// Counters of the pool the native decoder borrows its working memory from.
+/// Memory released by one decode is kept for the next, up to
+/// `retentionLimit` idle bytes, instead of going back to the heap.
+public struct J2KNativeMemoryStatistics {
+    /// Bytes held by the pool, in use or idle.
+    public let reservedBytes: Int
+    /// Bytes lent to decoders at the moment.
+    public let inUseBytes: Int
+    /// Largest `inUseBytes` so far.
+    public let peakBytes: Int
+    /// Idle bytes the pool may keep.
+    public let retentionLimit: Int
+}
+
+/// Where the time of one native decode went, and how much work it did.
+/// Stage times are in seconds and exclude each other; stages that run on
+/// worker threads, such as codeblock decoding, are summed over threads and
+/// can exceed `total`. All values are zero when OpenJPH is built with
+/// `OJPH_DISABLE_STATS`.
+public struct J2KNativeDecodeStatistics {
+    public let total: TimeInterval
+    /// Main and tile-part header marker segments.
+    public let headers: TimeInterval
+    /// Packet headers and bodies.
+    public let packets: TimeInterval
+    /// Codeblock decoding and dequantization.
+    public let codeblocks: TimeInterval
+    /// Waiting for codeblocks decoded by worker threads.
+    public let codeblockWait: TimeInterval
+    public let inverseWavelet: TimeInterval
+    /// Inverse colour transform and level shift.
+    public let colourTransform: TimeInterval
+    /// Conversion of the decoded lines into the output samples.
+    public let output: TimeInterval
+    public let bytesParsed: Int
+    public let packetsParsed: Int
+    /// Packets stepped over using PLT lengths.
+    public let packetsSkipped: Int
+    public let codeblocksDecoded: Int
+    /// Codeblocks without coded data, or outside the requested region.
+    public let zeroBlocks: Int
+    /// Bytes the decode held at its peak, output samples included.
+    public let memoryBytes: Int
+    /// Whether `J2KNativeDecoder.memoryLimit` made the decode give up buffers.
+    public let memoryLimited: Bool
+
+    init(_ stats: ojph_decode_stats) {
+        func seconds(_ ns: UInt64) -> TimeInterval { TimeInterval(ns) / 1e9 }
+        total = seconds(stats.total_ns)
+        headers = seconds(stats.headers_ns)
+        packets = seconds(stats.packets_ns)
+        codeblocks = seconds(stats.blocks_ns)
+        codeblockWait = seconds(stats.block_wait_ns)
+        inverseWavelet = seconds(stats.idwt_ns)
+        colourTransform = seconds(stats.colour_ns)
+        output = seconds(stats.output_ns)
+        bytesParsed = Int(stats.bytes_parsed)
+        packetsParsed = Int(stats.packets_parsed)
+        packetsSkipped = Int(stats.packets_skipped)
+        codeblocksDecoded = Int(stats.codeblocks_decoded)
+        zeroBlocks = Int(stats.zero_blocks)
+        memoryBytes = Int(stats.memory_bytes)
+        memoryLimited = stats.memory_limited != 0
+    }
+}
+
+/// Highest instruction set the native kernels may use.
+public enum J2KNativeInstructionSet: Int {
+    /// Portable kernels only.
+    case generic = 0
+    case sse2 = 1
+    case ssse3 = 2
+    case avx = 3
+    /// AVX2 and FMA.
+    case avx2 = 4
+    /// Whatever the CPU supports, e.g. AVX-512 or NEON. On ARM, any case
+    /// above `.generic` enables NEON.
+    case all = 5
 }
 
 public enum J2KNativeDecoder {
+    /// Signature shared by the one-shot and context-based "decode into" entry points.
+    typealias DecodeInto = (_ codestream: UnsafePointer<UInt8>,
+                            _ length: Int,
+                            _ destination: UnsafeMutableRawPointer?,
+                            _ destinationSize: Int,
+                            _ info: UnsafeMutablePointer<ojph_decoded_image>,
+                            _ requiredSize: UnsafeMutablePointer<Int>,
+                            _ errorMessage: UnsafeMutablePointer<CChar>,
+                            _ errorLength: Int) -> ojph_status
+
     /// Decode JPEG 2000 / HTJ2K codestream using the native OpenJPH backend.
+    /// With `planar`, each component is returned as its own plane, as GPU
+    /// pipelines expect, and codestreams without a colour transform are
+    /// decoded one component at a time.
+    /// `transform` is fused into the conversion of the decoded samples, which
+    /// are written in `format`, e.g. Hounsfield units as half floats. With a
+    /// `window`, the result holds 8-bit display pixels instead, and `format`
+    /// must be `.integer`.
+    /// With `previewQuality`, HTJ2K codeblocks are decoded from their cleanup
+    /// pass alone, skipping the refinement passes, for a faster and slightly
+    /// coarser image, e.g. while scrolling; decode again without it once the
+    /// scrolling stops.
     /// Returns `nil` if the codestream cannot be handled by the native decoder.
-    public static func decode(_ codestream: Data) -> J2KNativeResult? {
+    public static func decode(_ codestream: Data, planar: Bool = false,
+                              transform: J2KNativeSampleTransform = .identity,
+                              format: J2KNativeSampleFormat = .integer,
+                              window: J2KNativeWindow? = nil,
+                              previewQuality: Bool = false) -> J2KNativeResult? {
+        decode(codestream, decoder: nil, planar: planar, transform: transform,
+               format: format, window: window, previewQuality: previewQuality)
+    }
+
+    static func decode(_ codestream: Data, decoder: OpaquePointer?, planar: Bool,
+                       transform: J2KNativeSampleTransform,
+                       format: J2KNativeSampleFormat,
+                       window: J2KNativeWindow?,
+                       previewQuality: Bool = false,
+                       statistics: UnsafeMutablePointer<ojph_decode_stats>? = nil) -> J2KNativeResult? {
+        var options = decodeOptions(planar: planar, transform: transform,
+                                    format: format, window: window,
+                                    cleanupPassOnly: previewQuality)
+        // the last call, which decodes the samples, leaves its measurements
+        options.stats = statistics
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_into_with_options(decoder, base, length, &options, destination, size, 0, 0,
+                                          info, required, error, errorLength)
+        }
+    }
+
+    static func decodeOptions(planar: Bool,
+                              transform: J2KNativeSampleTransform,
+                              format: J2KNativeSampleFormat,
+                              window: J2KNativeWindow?,
+                              componentMask: UInt32 = 0,
+                              ycbcrToRGB: Bool = false,
+                              rgba: Bool = false,
+                              cleanupPassOnly: Bool = false) -> ojph_decode_options {
+        var options = ojph_decode_options()
+        options.component_mask = componentMask
+        options.ycbcr_to_rgb = ycbcrToRGB ? 1 : 0
+        options.fixed_point_synthesis = fixedPointLossyDecoding ? 1 : 0
+        options.cleanup_pass_only = cleanupPassOnly ? 1 : 0
+        options.memory_limit = memoryLimit
+        if planar {
+            options.layout = OJPH_LAYOUT_PLANAR
+        } else {
+            options.layout = rgba ? OJPH_LAYOUT_RGBA : OJPH_LAYOUT_INTERLEAVED
+        }
+        options.invert = transform.invert ? 1 : 0
+        options.rescale_slope = transform.rescaleSlope
+        options.rescale_intercept = transform.rescaleIntercept
+        options.bias = transform.bias
+        options.format = format.native
+        if let window = window {
+            options.voi_function = window.native
+            options.window_center = window.center
+            options.window_width = window.width
+        }
+        return options
+    }
+
+    /// Decode only the given components of the codestream, e.g. `[0]` for the
+    /// luma of a YCbCr frame shown in grayscale. The other components are
+    /// neither decoded nor transformed, and the colour transform is bypassed
+    /// unless all of its three components are included; the result holds the
+    /// components in codestream order. Indices beyond the codestream's
+    /// components are ignored; returns `nil` when none is left, or when an
+    /// index is outside `0..<32`.
+    public static func decode(_ codestream: Data, components: [Int], planar: Bool = false,
+                              format: J2KNativeSampleFormat = .integer) -> J2KNativeResult? {
+        var mask: UInt32 = 0
+        for component in components {
+            guard (0..<32).contains(component) else { return nil }
+            mask |= 1 << UInt32(component)
+        }
+        guard mask != 0 else { return nil }
+        var options = decodeOptions(planar: planar, transform: .identity,
+                                    format: format, window: nil, componentMask: mask)
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_into_with_options(nil, base, length, &options, destination, size, 0, 0,
+                                          info, required, error, errorLength)
+        }
+    }
+
+    /// Decode a full range YCbCr codestream, as `YBR_FULL` and `YBR_FULL_422`
+    /// frames store them, straight into interleaved RGB. Chroma subsampled
+    /// by two is decoded at its own size and repeated while the samples are
+    /// converted. Returns `nil` unless the codestream has three unsigned
+    /// components.
+    public static func decodeYBRFull(_ codestream: Data) -> J2KNativeResult? {
+        var options = decodeOptions(planar: false, transform: .identity,
+                                    format: .integer, window: nil, ycbcrToRGB: true)
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_into_with_options(nil, base, length, &options, destination, size, 0, 0,
+                                          info, required, error, errorLength)
+        }
+    }
+
+    /// Decode a colour codestream into 4-byte RGBA pixels, with an opaque
+    /// alpha sample of all ones, ready to upload to a Metal texture. The
+    /// inverse colour transform of RCT/ICT codestreams is applied in the same
+    /// pass as the interleaving; `ycbcrToRGB` converts full range YCbCr as
+    /// `decodeYBRFull` does. The result reports 4 components; returns `nil`
+    /// unless the codestream has three components, unsigned with `ycbcrToRGB`.
+    public static func decodeRGBA(_ codestream: Data, ycbcrToRGB: Bool = false) -> J2KNativeResult? {
+        var options = decodeOptions(planar: false, transform: .identity,
+                                    format: .integer, window: nil,
+                                    ycbcrToRGB: ycbcrToRGB, rgba: true)
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_into_with_options(nil, base, length, &options, destination, size, 0, 0,
+                                          info, required, error, errorLength)
+        }
+    }
+
+    /// Reads the main header of a codestream without decoding it, to route a
+    /// frame, size its buffers or choose a thumbnail level cheaply. Returns
+    /// `nil` if the header cannot be read.
+    public static func probe(_ codestream: Data) -> J2KNativeImageInfo? {
+        var probe = ojph_image_probe()
+        var error = [CChar](repeating: 0, count: 256)
+        let status = codestream.withUnsafeBytes { rawBuffer -> ojph_status in
+            guard let base = rawBuffer.bindMemory(to: UInt8.self).baseAddress else {
+                return OJPH_STATUS_ERROR
+            }
+            return ojph_probe_image(base, rawBuffer.count, &probe, &error, error.count)
+        }
+        guard status == OJPH_STATUS_OK else { return nil }
+
+        let xFactors = withUnsafeBytes(of: probe.x_subsampling) { Array($0) }
+        let yFactors = withUnsafeBytes(of: probe.y_subsampling) { Array($0) }
+        let listed = min(Int(probe.components), xFactors.count)
+        let progressions = [OJPH_PROGRESSION_LRCP: "LRCP", OJPH_PROGRESSION_RLCP: "RLCP",
+                            OJPH_PROGRESSION_PCRL: "PCRL", OJPH_PROGRESSION_CPRL: "CPRL"]
+        return J2KNativeImageInfo(
+            width: Int(probe.width),
+            height: Int(probe.height),
+            components: Int(probe.components),
+            bitsPerSample: Int(probe.bit_depth),
+            isSigned: probe.is_signed != 0,
+            isUniform: probe.uniform != 0,
+            subsampling: (0..<listed).map { (x: Int(xFactors[$0]), y: Int(yFactors[$0])) },
+            isHighThroughput: probe.high_throughput != 0,
+            isReversible: probe.reversible != 0,
+            usesColorTransform: probe.color_transform != 0,
+            tileWidth: Int(probe.tile_width),
+            tileHeight: Int(probe.tile_height),
+            tilesAcross: Int(probe.tiles_across),
+            tilesDown: Int(probe.tiles_down),
+            decompositionLevels: Int(probe.decompositions),
+            qualityLayers: Int(probe.quality_layers),
+            blockWidth: Int(probe.block_width),
+            blockHeight: Int(probe.block_height),
+            progression: progressions[probe.progression] ?? "RPCL",
+            unsupportedReason: probe.decodable != 0 ? nil : String(cString: error),
+            decodedSize: Int(probe.decoded_size))
+    }
+
+    /// Decode a reduced-resolution version of the codestream, e.g. for series
+    /// thumbnails. Each discarded level halves the width and height; the finer
+    /// resolutions are never decoded. Levels beyond the codestream's wavelet
+    /// decomposition count are clamped, so the result reports the actual size.
+    public static func decodeThumbnail(_ codestream: Data, discardLevels: Int) -> J2KNativeResult? {
+        let levels = UInt32(clamping: max(0, discardLevels))
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_thumbnail_into(base, length, levels, destination, size, 0, 0,
+                                       info, required, error, errorLength)
+        }
+    }
+
+    /// Decode a preview from the first bytes of a codestream, e.g. a byte-range
+    /// prefix of an RPCL frame, where lower resolutions come first. The finest
+    /// resolution held completely by `prefix` is decoded, discarding at least
+    /// `minimumDiscardLevels`; the levels actually discarded are returned with
+    /// the image, which matches `decodeThumbnail` of the whole codestream at
+    /// that level. Returns `nil` until the lowest resolution is complete.
+    public static func decodePreview(_ prefix: Data, minimumDiscardLevels: Int = 0)
+        -> (result: J2KNativeResult, discardLevels: Int)? {
+        guard !prefix.isEmpty else { return nil }
+
+        var options = ojph_decode_options()
+        options.discard_levels = UInt32(clamping: max(0, minimumDiscardLevels))
+        options.fixed_point_synthesis = fixedPointLossyDecoding ? 1 : 0
+        options.memory_limit = memoryLimit
+        var image = ojph_decoded_image()
+        var levels: UInt32 = 0
+        let status = prefix.withUnsafeBytes { rawBuffer -> ojph_status in
+            guard let base = rawBuffer.bindMemory(to: UInt8.self).baseAddress else {
+                return OJPH_STATUS_ERROR
+            }
+            return ojph_decode_preview(nil, base, rawBuffer.count, &options,
+                                       &image, &levels, nil, 0)
+        }
+        defer { ojph_free_image(&image) }
+        guard status == OJPH_STATUS_OK else { return nil }
+        return (result(copying: image), Int(levels))
+    }
+
+    /// Decode the codestream held in bytes `offset ..< offset + length` of the
+    /// file at `url`, e.g. one fragment of a multi-gigabyte whole-slide or
+    /// tomosynthesis object, without loading it into `Data`: the range is
+    /// mapped and read from the page cache. See
+    /// `decode(_:planar:transform:format:window:previewQuality:)` for the options.
+    public static func decode(contentsOf url: URL, offset: UInt64, length: Int,
+                              planar: Bool = false,
+                              transform: J2KNativeSampleTransform = .identity,
+                              format: J2KNativeSampleFormat = .integer,
+                              window: J2KNativeWindow? = nil) -> J2KNativeResult? {
+        guard url.isFileURL, length > 0 else { return nil }
+        let descriptor = open(url.path, O_RDONLY)
+        guard descriptor >= 0 else { return nil }
+        defer { close(descriptor) }
+
+        var options = decodeOptions(planar: planar, transform: transform,
+                                    format: format, window: window)
+        var image = ojph_decoded_image()
+        let status = ojph_decode_file(nil, descriptor, offset, length, &options,
+                                      &image, nil, 0)
+        defer { ojph_free_image(&image) }
+        guard status == OJPH_STATUS_OK else { return nil }
+        return result(copying: image)
+    }
+
+    /// Decode the codestream a band of `bandHeight` rows at a time (0 for
+    /// 32), handing each band to `body` top to bottom as soon as it is
+    /// decoded, e.g. to upload rows into tiled Metal textures or resample
+    /// them for MPR. Only one band is held, so memory and the time to the
+    /// first rows do not grow with the image height. `body` returns `false`
+    /// to stop. See `decode(_:planar:transform:format:window:previewQuality:)`
+    /// for the options. Returns `false` if the decode failed or was stopped.
+    @discardableResult
+    public static func decodeRows(_ codestream: Data, bandHeight: Int = 0,
+                                  planar: Bool = false,
+                                  transform: J2KNativeSampleTransform = .identity,
+                                  format: J2KNativeSampleFormat = .integer,
+                                  window: J2KNativeWindow? = nil,
+                                  body: (J2KNativeRowBand) -> Bool) -> Bool {
+        guard !codestream.isEmpty else { return false }
+        // the decode fills in `info` before handing over the first band
+        final class Sink {
+            let body: (J2KNativeRowBand) -> Bool
+            let info: UnsafeMutablePointer<ojph_decoded_image>
+            init(_ body: @escaping (J2KNativeRowBand) -> Bool,
+                 _ info: UnsafeMutablePointer<ojph_decoded_image>) {
+                self.body = body
+                self.info = info
+            }
+        }
+
+        var options = decodeOptions(planar: planar, transform: transform,
+                                    format: format, window: window)
+        let info = UnsafeMutablePointer<ojph_decoded_image>.allocate(capacity: 1)
+        info.initialize(to: ojph_decoded_image())
+        defer { info.deallocate() }
+        return withoutActuallyEscaping(body) { body in
+            let sink = Sink(body, info)
+            let context = Unmanaged.passUnretained(sink).toOpaque()
+            let status = codestream.withUnsafeBytes { rawBuffer -> ojph_status in
+                guard let base = rawBuffer.bindMemory(to: UInt8.self).baseAddress else {
+                    return OJPH_STATUS_ERROR
+                }
+                return ojph_decode_rows(nil, base, rawBuffer.count, &options,
+                                        UInt32(clamping: max(0, bandHeight)),
+                                        { context, rows, first, count, rowPitch, planePitch in
+                    guard let context = context, let rows = rows else { return 0 }
+                    let sink = Unmanaged<Sink>.fromOpaque(context).takeUnretainedValue()
+                    let info = sink.info.pointee
+                    let planes = info.is_planar != 0 ? Int(info.components) : 1
+                    let size = planePitch * (planes - 1) + rowPitch * Int(count)
+                    let band = J2KNativeRowBand(
+                        width: Int(info.width), height: Int(info.height),
+                        components: Int(info.components),
+                        bitsPerSample: Int(info.bit_depth),
+                        isSigned: info.is_signed != 0, isPlanar: info.is_planar != 0,
+                        isFloat: info.is_float != 0,
+                        firstRow: Int(first), rowCount: Int(count),
+                        rowPitch: rowPitch, planePitch: planePitch,
+                        bytes: UnsafeRawBufferPointer(start: rows, count: size))
+                    return sink.body(band) ? 1 : 0
+                }, context, info, nil, 0)
+            }
+            return status == OJPH_STATUS_OK
+        }
+    }
+
+    /// Decode only a window of the codestream, e.g. the visible part of a
+    /// zoomed viewport. The window is expressed in the coordinates of the image
+    /// after discarding `discardLevels` resolutions and is clipped to it; only
+    /// the tiles and codeblocks that contribute to it are decoded.
+    public static func decodeRegion(_ codestream: Data,
+                                    x: Int, y: Int, width: Int, height: Int,
+                                    discardLevels: Int = 0) -> J2KNativeResult? {
+        guard x >= 0, y >= 0, width > 0, height > 0 else { return nil }
+        let rx = UInt32(clamping: x)
+        let ry = UInt32(clamping: y)
+        let rw = UInt32(clamping: width)
+        let rh = UInt32(clamping: height)
+        let levels = UInt32(clamping: max(0, discardLevels))
+        return decode(codestream) { base, length, destination, size, info, required, error, errorLength in
+            ojph_decode_region_into(base, length, rx, ry, rw, rh, levels,
+                                    destination, size, 0, 0,
+                                    info, required, error, errorLength)
+        }
+    }
+
+    /// Decode several independent codestreams (e.g. the frames of an enhanced
+    /// multi-frame object) concurrently on the native worker pool.
+    /// - Parameters:
+    ///   - codestreams: One codestream per frame.
+    ///   - maxThreads: Upper bound on the threads used, including the caller; 0 uses all cores.
+    /// - Returns: One result per input frame, `nil` for frames that failed to decode.
+    public static func decodeFrames(_ codestreams: [Data], maxThreads: Int = 0) -> [J2KNativeResult?] {
+        guard !codestreams.isEmpty else { return [] }
+
+        // Pack the fragments into one contiguous buffer so that every frame has
+        // a stable base address for the duration of the native call.
+        var offsets = [Int]()
+        offsets.reserveCapacity(codestreams.count)
+        var packed = [UInt8]()
+        packed.reserveCapacity(codestreams.reduce(0) { $0 + $1.count })
+        for codestream in codestreams {
+            offsets.append(packed.count)
+            packed.append(contentsOf: codestream)
+        }
+
+        var images = [ojph_decoded_image](repeating: ojph_decoded_image(), count: codestreams.count)
+        var statuses = [ojph_status](repeating: OJPH_STATUS_ERROR, count: codestreams.count)
+        let lengths = codestreams.map { $0.count }
+
+        packed.withUnsafeBufferPointer { packedBuffer in
+            guard let base = packedBuffer.baseAddress else { return }
+            let pointers: [UnsafePointer<UInt8>?] = offsets.enumerated().map { index, offset in
+                lengths[index] > 0 ? base + offset : nil
+            }
+            _ = ojph_decode_frames(pointers, lengths, codestreams.count,
+                                   &images, &statuses, UInt32(max(0, maxThreads)))
+        }
+
+        var results = [J2KNativeResult?]()
+        results.reserveCapacity(codestreams.count)
+        for index in images.indices {
+            defer { ojph_free_image(&images[index]) }
+            guard statuses[index] == OJPH_STATUS_OK else {
+                results.append(nil)
+                continue
+            }
+            results.append(result(copying: images[index]))
+        }
+        return results
+    }
+
+    /// Current counters of the native memory pool.
+    public static var memoryStatistics: J2KNativeMemoryStatistics {
+        var stats = ojph_memory_stats()
+        ojph_get_memory_stats(&stats)
+        return J2KNativeMemoryStatistics(reservedBytes: Int(stats.reserved_bytes),
+                                         inUseBytes: Int(stats.in_use_bytes),
+                                         peakBytes: Int(stats.peak_bytes),
+                                         retentionLimit: Int(stats.retention_limit))
+    }
+
+    /// Sets how many idle bytes the native memory pool may keep for later
+    /// decodes; 0 returns memory to the heap as soon as a decode ends. The
+    /// default, 4 MB, suits occasional decodes; raise it when scrolling
+    /// through large series.
+    public static func setMemoryRetentionLimit(_ bytes: Int) {
+        ojph_set_memory_retention(max(0, bytes))
+    }
+
+    /// Returns the idle memory of the native pool to the heap, e.g. on a
+    /// memory warning.
+    public static func trimMemory() {
+        ojph_trim_memory()
+    }
+
+    /// Sends the messages of the native decoder, otherwise printed to stdout
+    /// and stderr, to `Logger`, keeping those of `minimumLevel` and above and
+    /// at most `maxPerSecond` of them (0 for no limit). Corrupt packets that
+    /// a decode steps over are reported at the `.info` level.
+    public static func routeMessagesToLogger(minimumLevel: Logger.LogLevel = .WARNING,
+                                             maxPerSecond: Int = 20) {
+        let level: ojph_message_level
+        switch minimumLevel {
+        case .FATAL, .ERROR: level = OJPH_MESSAGE_ERROR
+        case .WARNING: level = OJPH_MESSAGE_WARNING
+        default: level = OJPH_MESSAGE_INFO
+        }
+        ojph_set_message_callback({ _, level, code, message in
+            guard let message = message else { return }
+            let text = String(format: "OpenJPH 0x%08X: %@", code, String(cString: message))
+            switch level {
+            case OJPH_MESSAGE_ERROR: Logger.error(text, "J2K")
+            case OJPH_MESSAGE_WARNING: Logger.warning(text, "J2K")
+            default: Logger.info(text, "J2K")
+            }
+        }, nil, level, UInt32(clamping: max(0, maxPerSecond)))
+    }
+
+    /// Discards the messages of the native decoder; `routeMessagesToLogger`
+    /// brings them back.
+    public static func silenceMessages() {
+        ojph_set_message_callback(nil, nil, OJPH_MESSAGE_NONE, 0)
+    }
+
+    /// When set, lossy (irreversible 9/7) frames are dequantized and
+    /// inverse transformed in fixed point rather than in floats, which is
+    /// noticeably faster on older devices. Meant for display: samples of up
+    /// to 16 bits differ from the default decode by at most 1. Lossless
+    /// frames are unaffected. Change it only while no decode runs.
+    public static var fixedPointLossyDecoding = false
+
+    /// Bytes a native decode should stay within, output included, e.g. a
+    /// share of `os_proc_available_memory()` on iOS; 0 sets no limit. A
+    /// decode predicted to go over gives up its speed-only buffers (the
+    /// strips of tile-parallel decoding, frame cache pyramids) instead of
+    /// failing. Change it only while no decode runs.
+    public static var memoryLimit = 0
+
+    /// Messages the rate limit of `routeMessagesToLogger` has dropped.
+    public static var droppedMessages: Int {
+        Int(ojph_dropped_messages())
+    }
+
+    /// The instruction set the native kernels are chosen for. Setting it
+    /// caps the kernels of the decodes that start afterwards, e.g. to compare
+    /// speeds or to avoid a faulty kernel; `.all` lifts the cap. Change it
+    /// only while no decode runs.
+    public static var instructionSet: J2KNativeInstructionSet {
+        get {
+            J2KNativeInstructionSet(rawValue: Int(ojph_instruction_set_in_use().rawValue)) ?? .all
+        }
+        set {
+            ojph_set_instruction_set_cap(ojph_instruction_set(rawValue: UInt32(newValue.rawValue)))
+        }
+    }
+
+    /// Copies a natively allocated image into Swift-owned storage.
+    static func result(copying image: ojph_decoded_image) -> J2KNativeResult {
+        let sampleCount = Int(image.pixel_count)
+        return J2KNativeResult(
+            width: Int(image.width),
+            height: Int(image.height),
+            components: Int(image.components),
+            bitsPerSample: Int(image.bit_depth),
+            isSigned: image.is_signed != 0,
+            isPlanar: image.is_planar != 0,
+            isFloat: image.is_float != 0,
+            pixels8: image.pixels8.map { Array(UnsafeBufferPointer(start: $0, count: sampleCount)) },
+            pixels16: image.pixels16.map { Array(UnsafeBufferPointer(start: $0, count: sampleCount)) },
+            pixels32: image.pixels32.map { Array(UnsafeBufferPointer(start: $0, count: sampleCount)) })
+    }
+
+    static func decode(_ codestream: Data, using decodeInto: DecodeInto) -> J2KNativeResult? {
         guard !codestream.isEmpty else { return nil }
 
         return codestream.withUnsafeBytes { rawBuffer -> J2KNativeResult? in
@@ -29,51 +718,417 @@ public enum J2KNativeDecoder {
                 return nil
             }
 
-            var image = ojph_decoded_image()
+            // First pass parses the headers only and reports the layout, so the
+            // samples can then be decoded straight into Swift-owned storage.
+            var info = ojph_decoded_image()
+            var requiredSize = 0
             var errorMessage = [CChar](repeating: 0, count: 256)
-            let status = ojph_decode_image(base,
-                                           codestream.count,
-                                           &image,
-                                           &errorMessage,
-                                           errorMessage.count)
-
-            guard status == OJPH_STATUS_OK else {
-                ojph_free_image(&image)
+            let probe = decodeInto(base, codestream.count, nil, 0,
+                                   &info, &requiredSize, &errorMessage, errorMessage.count)
+            guard probe == OJPH_STATUS_BUFFER_TOO_SMALL || probe == OJPH_STATUS_OK else {
                 return nil
             }
 
-            defer { ojph_free_image(&image) }
-
-            let width = Int(image.width)
-            let height = Int(image.height)
-            let components = Int(image.components)
-            let bits = Int(image.bit_depth)
-            let isSigned = image.is_signed != 0
-            let sampleCount = Int(image.pixel_count)
+            let width = Int(info.width)
+            let height = Int(info.height)
+            let components = Int(info.components)
+            let bits = Int(info.bit_depth)
+            let isSigned = info.is_signed != 0
+            let isPlanar = info.is_planar != 0
+            let isFloat = info.is_float != 0
+            let sampleCount = Int(info.pixel_count)
+            let output8 = bits <= 8 && !isSigned && !isFloat
 
-            if let pixels16 = image.pixels16 {
-                let buffer = UnsafeBufferPointer(start: pixels16, count: sampleCount)
+            var status = OJPH_STATUS_ERROR
+            if isFloat && bits == 32 {
+                let pixels = [Float](unsafeUninitializedCapacity: sampleCount) { buffer, initialized in
+                    status = decodeInto(base, codestream.count,
+                                        UnsafeMutableRawPointer(buffer.baseAddress),
+                                        buffer.count * MemoryLayout<Float>.stride,
+                                        &info, &requiredSize, &errorMessage, errorMessage.count)
+                    initialized = status == OJPH_STATUS_OK ? sampleCount : 0
+                }
+                guard status == OJPH_STATUS_OK else { return nil }
                 return J2KNativeResult(width: width,
                                        height: height,
                                        components: components,
                                        bitsPerSample: bits,
                                        isSigned: isSigned,
+                                       isPlanar: isPlanar,
+                                       isFloat: true,
                                        pixels8: nil,
-                                       pixels16: Array(buffer))
+                                       pixels16: nil,
+                                       pixels32: pixels)
             }
-
-            if let pixels8 = image.pixels8 {
-                let buffer = UnsafeBufferPointer(start: pixels8, count: sampleCount)
+            if output8 {
+                let pixels = [UInt8](unsafeUninitializedCapacity: sampleCount) { buffer, initialized in
+                    status = decodeInto(base, codestream.count,
+                                        UnsafeMutableRawPointer(buffer.baseAddress), buffer.count,
+                                        &info, &requiredSize, &errorMessage, errorMessage.count)
+                    initialized = status == OJPH_STATUS_OK ? sampleCount : 0
+                }
+                guard status == OJPH_STATUS_OK else { return nil }
                 return J2KNativeResult(width: width,
                                        height: height,
                                        components: components,
                                        bitsPerSample: bits,
                                        isSigned: isSigned,
-                                       pixels8: Array(buffer),
-                                       pixels16: nil)
+                                       isPlanar: isPlanar,
+                                       isFloat: false,
+                                       pixels8: pixels,
+                                       pixels16: nil,
+                                       pixels32: nil)
             }
 
+            let pixels = [UInt16](unsafeUninitializedCapacity: sampleCount) { buffer, initialized in
+                status = decodeInto(base, codestream.count,
+                                    UnsafeMutableRawPointer(buffer.baseAddress),
+                                    buffer.count * MemoryLayout<UInt16>.stride,
+                                    &info, &requiredSize, &errorMessage, errorMessage.count)
+                initialized = status == OJPH_STATUS_OK ? sampleCount : 0
+            }
+            guard status == OJPH_STATUS_OK else { return nil }
+            return J2KNativeResult(width: width,
+                                   height: height,
+                                   components: components,
+                                   bitsPerSample: bits,
+                                   isSigned: isSigned,
+                                   isPlanar: isPlanar,
+                                   isFloat: isFloat,
+                                   pixels8: nil,
+                                   pixels16: pixels,
+                                   pixels32: nil)
+        }
+    }
+}
+
+/// Reusable native decoder for sequences of similar frames (cine loops,
+/// multi-frame ultrasound). The underlying OpenJPH context keeps its memory
+/// stores between frames, so frames sharing SIZ/COD parameters skip most of
+/// the per-frame setup. Instances are not thread-safe; use one per thread.
+public final class J2KNativeDecoderContext {
+    private let handle: OpaquePointer
+
+    /// Measures every decode into `lastStatistics`, e.g. to attribute slow
+    /// frames with `DcmSwiftPerformanceMonitor.recordNativeDecode(_:label:)`.
+    public var collectsStatistics = false
+    /// Measurements of the last decode, when `collectsStatistics` is set.
+    public private(set) var lastStatistics: J2KNativeDecodeStatistics?
+
+    public init?() {
+        guard let handle = ojph_decoder_create() else { return nil }
+        self.handle = handle
+    }
+
+    deinit {
+        ojph_decoder_destroy(handle)
+    }
+
+    /// Decode one frame, reusing allocations from previous calls; see
+    /// `J2KNativeDecoder.decode(_:planar:transform:format:window:previewQuality:)`
+    /// for the options.
+    public func decode(_ codestream: Data, planar: Bool = false,
+                       transform: J2KNativeSampleTransform = .identity,
+                       format: J2KNativeSampleFormat = .integer,
+                       window: J2KNativeWindow? = nil,
+                       previewQuality: Bool = false) -> J2KNativeResult? {
+        guard collectsStatistics else {
+            lastStatistics = nil
+            return J2KNativeDecoder.decode(codestream, decoder: handle, planar: planar,
+                                           transform: transform, format: format, window: window,
+                                           previewQuality: previewQuality)
+        }
+        var stats = ojph_decode_stats()
+        let result = J2KNativeDecoder.decode(codestream, decoder: handle, planar: planar,
+                                             transform: transform, format: format,
+                                             window: window, previewQuality: previewQuality,
+                                             statistics: &stats)
+        lastStatistics = J2KNativeDecodeStatistics(stats)
+        return result
+    }
+}
+
+/// Native decoder fed with a codestream as it is received, e.g. the chunks of
+/// a C-GET/C-MOVE or DICOMweb transfer. Decoding runs on a background thread
+/// and keeps pace with the appended bytes, so receiving and decoding overlap
+/// and the image is ready shortly after the last chunk. `append` may be called
+/// from any thread; `finish` ends the stream and collects the result.
+public final class J2KNativeStreamDecoder {
+    private let handle: OpaquePointer
+
+    /// Starts decoding; see
+    /// `J2KNativeDecoder.decode(_:planar:transform:format:window:previewQuality:)`
+    /// for the options.
+    public init?(planar: Bool = false,
+                 transform: J2KNativeSampleTransform = .identity,
+                 format: J2KNativeSampleFormat = .integer,
+                 window: J2KNativeWindow? = nil) {
+        var options = J2KNativeDecoder.decodeOptions(planar: planar, transform: transform,
+                                                     format: format, window: window)
+        guard let handle = ojph_stream_create(&options) else { return nil }
+        self.handle = handle
+    }
+
+    deinit {
+        ojph_stream_destroy(handle)
+    }
+
+    /// Appends the next chunk of the codestream. Returns `false` once the
+    /// stream has been finished.
+    @discardableResult
+    public func append(_ chunk: Data) -> Bool {
+        chunk.withUnsafeBytes { rawBuffer in
+            ojph_stream_push(handle, rawBuffer.bindMemory(to: UInt8.self).baseAddress,
+                             rawBuffer.count) == OJPH_STATUS_OK
+        }
+    }
+
+    /// Ends the codestream and waits for the decode. Returns `nil` if the
+    /// codestream cannot be handled by the native decoder.
+    public func finish() -> J2KNativeResult? {
+        var image = ojph_decoded_image()
+        defer { ojph_free_image(&image) }
+        guard ojph_stream_finish(handle, &image, nil, 0) == OJPH_STATUS_OK else { return nil }
+        return J2KNativeDecoder.result(copying: image)
+    }
+}
+
+/// Native background decodes, run most urgent first on the worker pool of
+/// `decodeFrames`, e.g. the frame on screen ahead of the frames prefetched
+/// around it while a stack is scrolled. When every slot is busy, a more
+/// urgent job stops the least urgent running one, which starts over later.
+/// Jobs scrolled past can be cancelled, even halfway through their decode.
+/// Safe to use from several threads.
+public final class J2KNativeDecodeQueue: @unchecked Sendable {
+    private let handle: OpaquePointer
+
+    private final class Completion {
+        let handler: (J2KNativeResult?) -> Void
+        init(_ handler: @escaping (J2KNativeResult?) -> Void) { self.handler = handler }
+    }
+
+    /// Creates a queue running up to `maxJobs` decodes at a time; 0 allows
+    /// one per worker thread.
+    public init?(maxJobs: Int = 0) {
+        guard let handle = ojph_decode_queue_create(UInt32(clamping: max(0, maxJobs))) else {
             return nil
         }
+        self.handle = handle
+    }
+
+    /// Cancels the jobs left; their completions receive `nil`.
+    deinit {
+        ojph_decode_queue_destroy(handle)
+    }
+
+    /// Queues a decode of `codestream`; see
+    /// `J2KNativeDecoder.decode(_:planar:transform:format:window:previewQuality:)`
+    /// for the options. Jobs of higher `priority` start first. `completion` runs
+    /// once on a worker thread with the result, or with `nil` if the job was
+    /// cancelled or the codestream cannot be handled by the native decoder.
+    /// Returns the ID of the job, or `nil` if it could not be queued.
+    @discardableResult
+    public func submit(_ codestream: Data, priority: Int32 = 0, planar: Bool = false,
+                       transform: J2KNativeSampleTransform = .identity,
+                       format: J2KNativeSampleFormat = .integer,
+                       window: J2KNativeWindow? = nil,
+                       completion: @escaping (J2KNativeResult?) -> Void) -> UInt64? {
+        var options = J2KNativeDecoder.decodeOptions(planar: planar, transform: transform,
+                                                     format: format, window: window)
+        let context = Unmanaged.passRetained(Completion(completion)).toOpaque()
+        let jobID = codestream.withUnsafeBytes { rawBuffer -> UInt64 in
+            ojph_decode_queue_submit(handle, rawBuffer.bindMemory(to: UInt8.self).baseAddress,
+                                     rawBuffer.count, &options, priority, { context, _, status, image, _ in
+                guard let context = context else { return }
+                let completion = Unmanaged<Completion>.fromOpaque(context).takeRetainedValue()
+                var result: J2KNativeResult?
+                if let image = image {
+                    if status == OJPH_STATUS_OK {
+                        result = J2KNativeDecoder.result(copying: image.pointee)
+                    }
+                    ojph_free_image(image)
+                }
+                completion.handler(result)
+            }, context)
+        }
+        guard jobID != 0 else {
+            Unmanaged<Completion>.fromOpaque(context).release()
+            return nil
+        }
+        return jobID
+    }
+
+    /// Changes the priority of a job that has not finished, e.g. when a
+    /// prefetched frame comes on screen. Returns `false` once it is done.
+    @discardableResult
+    public func setPriority(_ priority: Int32, of jobID: UInt64) -> Bool {
+        ojph_decode_queue_set_priority(handle, jobID, priority) == OJPH_STATUS_OK
+    }
+
+    /// Cancels a job, whose completion then receives `nil`. Returns `false`
+    /// once it is done.
+    @discardableResult
+    public func cancel(_ jobID: UInt64) -> Bool {
+        ojph_decode_queue_cancel(handle, jobID) == OJPH_STATUS_OK
+    }
+}
+
+/// Counters of a `J2KNativeFrameCache`.
+public struct J2KNativeFrameCacheStatistics {
+    public let hits: Int
+    public let misses: Int
+    /// Frames dropped to stay within the budget.
+    public let evictions: Int
+    /// Decoded frames handed out without being kept, for lack of room.
+    public let uncached: Int
+    /// Coarser images kept from full decodes; see `pyramidLevels`.
+    public let reducedFrames: Int
+    public let cachedBytes: Int
+    /// Bytes of the cached frames that are pinned or in use.
+    public let lockedBytes: Int
+    public let budgetBytes: Int
+    public let frames: Int
+    /// Frames whose `J2KNativeCachedFrame` is still alive.
+    public let framesInUse: Int
+
+    public var hitRate: Double {
+        hits + misses == 0 ? 0 : Double(hits) / Double(hits + misses)
+    }
+}
+
+/// A frame decoded by a `J2KNativeFrameCache`. Its samples are shared with
+/// the cache, not copied, and stay valid while the object lives; they must
+/// not be written.
+public final class J2KNativeCachedFrame {
+    private let cache: J2KNativeFrameCache
+    private var image: ojph_decoded_image
+
+    public var width: Int { Int(image.width) }
+    public var height: Int { Int(image.height) }
+    public var components: Int { Int(image.components) }
+    public var bitsPerSample: Int { Int(image.bit_depth) }
+    public var isSigned: Bool { image.is_signed != 0 }
+    public var isPlanar: Bool { image.is_planar != 0 }
+    public var isFloat: Bool { image.is_float != 0 }
+    public var pixels8: UnsafeBufferPointer<UInt8>? {
+        image.pixels8.map { UnsafeBufferPointer(start: $0, count: Int(image.pixel_count)) }
+    }
+    public var pixels16: UnsafeBufferPointer<UInt16>? {
+        image.pixels16.map { UnsafeBufferPointer(start: $0, count: Int(image.pixel_count)) }
+    }
+    public var pixels32: UnsafeBufferPointer<Float>? {
+        image.pixels32.map { UnsafeBufferPointer(start: $0, count: Int(image.pixel_count)) }
+    }
+
+    init(cache: J2KNativeFrameCache, image: ojph_decoded_image) {
+        self.cache = cache
+        self.image = image
+    }
+
+    deinit {
+        ojph_frame_cache_release(cache.handle, &image)
+    }
+
+    /// Copies the samples into Swift-owned storage.
+    public func result() -> J2KNativeResult {
+        J2KNativeDecoder.result(copying: image)
+    }
+}
+
+/// Native cache of decoded frames, e.g. for cine review of a series, where
+/// frames come back on screen again and again. Frames are kept per frame ID
+/// and decode options within a byte budget, the least recently used going
+/// first; frames in use, or pinned while on screen, are never dropped.
+/// A hit hands back the cached samples without decoding or copying them.
+/// Safe to use from several threads.
+public final class J2KNativeFrameCache: @unchecked Sendable {
+    let handle: OpaquePointer
+
+    public init?(budgetBytes: Int) {
+        guard let handle = ojph_frame_cache_create(max(0, budgetBytes)) else { return nil }
+        self.handle = handle
+    }
+
+    deinit {
+        ojph_frame_cache_destroy(handle)
+    }
+
+    /// Most bytes of decoded samples the cache keeps.
+    public var budgetBytes: Int {
+        get { statistics.budgetBytes }
+        set { ojph_frame_cache_set_budget(handle, max(0, newValue)) }
+    }
+
+    /// Coarser images each full decode leaves in the cache too, one per
+    /// resolution level skipped, so zooming out to `discardLevels` up to
+    /// this many levels above the one decoded is a hit. They count against
+    /// the budget, taking only the room left. Only single-tile codestreams
+    /// whose components are not subsampled have them; meant to be set
+    /// before the cache is shared.
+    public var pyramidLevels: Int = 0 {
+        didSet { ojph_frame_cache_set_pyramid_levels(handle, UInt32(clamping: max(0, pyramidLevels))) }
+    }
+
+    /// Returns frame `frameID` decoded with the given options, decoding
+    /// `codestream` when the cache does not hold it; see
+    /// `J2KNativeDecoder.decode(_:planar:transform:format:window:previewQuality:)`
+    /// for the options, and `decodeThumbnail` for `discardLevels`. A preview
+    /// is also served by a cached full-quality decode of the frame. The ID
+    /// must change whenever the codestream does. Returns `nil` if the
+    /// codestream cannot be handled by the native decoder.
+    public func frame(_ frameID: UInt64, codestream: Data, planar: Bool = false,
+                      transform: J2KNativeSampleTransform = .identity,
+                      format: J2KNativeSampleFormat = .integer,
+                      window: J2KNativeWindow? = nil,
+                      discardLevels: Int = 0,
+                      previewQuality: Bool = false) -> J2KNativeCachedFrame? {
+        var options = J2KNativeDecoder.decodeOptions(planar: planar, transform: transform,
+                                                     format: format, window: window,
+                                                     cleanupPassOnly: previewQuality)
+        options.discard_levels = UInt32(clamping: max(0, discardLevels))
+        var image = ojph_decoded_image()
+        let status = codestream.withUnsafeBytes { rawBuffer -> ojph_status in
+            ojph_frame_cache_decode(handle, nil, frameID,
+                                    rawBuffer.bindMemory(to: UInt8.self).baseAddress,
+                                    rawBuffer.count, &options, &image, nil, 0)
+        }
+        guard status == OJPH_STATUS_OK else { return nil }
+        return J2KNativeCachedFrame(cache: self, image: image)
+    }
+
+    /// Keeps every decode of `frameID` cached until `unpin`, e.g. while it
+    /// is on screen.
+    public func pin(_ frameID: UInt64) {
+        ojph_frame_cache_pin(handle, frameID, 1)
+    }
+
+    public func unpin(_ frameID: UInt64) {
+        ojph_frame_cache_pin(handle, frameID, 0)
+    }
+
+    /// Drops the decodes of `frameID`, e.g. when its pixel data changed.
+    public func evict(_ frameID: UInt64) {
+        ojph_frame_cache_evict(handle, frameID)
+    }
+
+    /// Drops every cached frame, e.g. on a memory warning; frames in use stay
+    /// valid until released.
+    public func removeAll() {
+        ojph_frame_cache_clear(handle)
+    }
+
+    public var statistics: J2KNativeFrameCacheStatistics {
+        var stats = ojph_frame_cache_stats()
+        ojph_frame_cache_get_stats(handle, &stats)
+        return J2KNativeFrameCacheStatistics(hits: Int(stats.hits),
+                                             misses: Int(stats.misses),
+                                             evictions: Int(stats.evictions),
+                                             uncached: Int(stats.uncached),
+                                             reducedFrames: Int(stats.reduced),
+                                             cachedBytes: Int(stats.cached_bytes),
+                                             lockedBytes: Int(stats.locked_bytes),
+                                             budgetBytes: Int(stats.budget_bytes),
+                                             frames: Int(stats.frames),
+                                             framesInUse: Int(stats.handed_out))
     }
 }
@@ -0,0 +1,310 @@
+//  J2KNativeEncoder.swift
+//  DcmSwift
+//
+//  Native HTJ2K encoder backed by OpenJPH, used to transcode uncompressed or
+//  legacy JPEG 2000 pixel data into HTJ2K, e.g. before archiving.
+
+import Foundation
+import OpenJPH
+
+/// Progression order of the encoded codestream.
+public enum J2KNativeProgression {
+    /// Resolution first, as the DICOM HTJ2K RPCL transfer syntax requires.
+    case rpcl
+    case lrcp
+    case rlcp
+    case pcrl
+    case cprl
+
+    var native: ojph_progression {
+        switch self {
+        case .rpcl: return OJPH_PROGRESSION_RPCL
+        case .lrcp: return OJPH_PROGRESSION_LRCP
+        case .rlcp: return OJPH_PROGRESSION_RLCP
+        case .pcrl: return OJPH_PROGRESSION_PCRL
+        case .cprl: return OJPH_PROGRESSION_CPRL
+        }
+    }
+}
+
+/// Coding parameters of `J2KNativeEncoder`. The defaults encode losslessly,
+/// in RPCL order, with five decomposition levels and 64x64 codeblocks, as one
+/// tile.
+public struct J2KNativeEncodingOptions {
+    /// `false` selects lossy coding with the irreversible 9/7 wavelet.
+    public var lossless: Bool
+    /// Applies the colour transform (RCT when lossless, ICT when lossy) to the
+    /// first three components.
+    public var colorTransform: Bool
+    public var progression: J2KNativeProgression
+    /// Wavelet levels; 0 uses five, or fewer (but at least one) when the
+    /// image is small.
+    public var decompositions: Int
+    /// Codeblock size, powers of two with an area of at most 4096 samples.
+    public var blockWidth: Int
+    public var blockHeight: Int
+    /// Tile size; `nil` codes the image as one tile.
+    public var tileSize: (width: Int, height: Int)?
+    /// Base quantization step of lossy coding; smaller is better quality.
+    /// `nil` keeps the OpenJPH default.
+    public var quantizationStep: Float?
+    /// Writes PLT packet lengths in the tile-part headers, so that viewers
+    /// can fetch and decode a region or a thumbnail without parsing every
+    /// packet.
+    public var packetLengths: Bool
+
+    public init(lossless: Bool = true,
+                colorTransform: Bool = false,
+                progression: J2KNativeProgression = .rpcl,
+                decompositions: Int = 0,
+                blockWidth: Int = 64,
+                blockHeight: Int = 64,
+                tileSize: (width: Int, height: Int)? = nil,
+                quantizationStep: Float? = nil,
+                packetLengths: Bool = false) {
+        self.lossless = lossless
+        self.colorTransform = colorTransform
+        self.progression = progression
+        self.decompositions = decompositions
+        self.blockWidth = blockWidth
+        self.blockHeight = blockHeight
+        self.tileSize = tileSize
+        self.quantizationStep = quantizationStep
+        self.packetLengths = packetLengths
+    }
+}
+
+public enum J2KNativeEncoder {
+    /// Encode 8-bit samples, e.g. `BitsAllocated` 8 pixel data, into an HTJ2K
+    /// codestream. `pixels` holds `width * height * components` samples, either
+    /// interleaved or, with `planar`, one plane per component.
+    /// Returns `nil` if the image or parameters cannot be encoded.
+    public static func encode(_ pixels: [UInt8], width: Int, height: Int,
+                              components: Int, bitsStored: Int = 8,
+                              isSigned: Bool = false, planar: Bool = false,
+                              options: J2KNativeEncodingOptions = J2KNativeEncodingOptions()) -> Data? {
+        guard bitsStored <= 8 else { return nil }
+        return pixels.withUnsafeBytes {
+            encode($0, width: width, height: height, components: components,
+                   bitsStored: bitsStored, isSigned: isSigned, planar: planar,
+                   options: options)
+        }
+    }
+
+    /// Encode 16-bit samples, e.g. `BitsAllocated` 16 pixel data with
+    /// `bitsStored` of 9 to 16; bits above `bitsStored` are ignored.
+    /// See `encode(_:width:height:components:bitsStored:isSigned:planar:options:)`
+    /// for the layout.
+    public static func encode(_ pixels: [UInt16], width: Int, height: Int,
+                              components: Int, bitsStored: Int,
+                              isSigned: Bool = false, planar: Bool = false,
+                              options: J2KNativeEncodingOptions = J2KNativeEncodingOptions()) -> Data? {
+        guard bitsStored > 8 && bitsStored <= 16 else { return nil }
+        return pixels.withUnsafeBytes {
+            encode($0, width: width, height: height, components: components,
+                   bitsStored: bitsStored, isSigned: isSigned, planar: planar,
+                   options: options)
+        }
+    }
+
+    /// Encode raw pixel data as stored in the DICOM dataset: bytes for
+    /// `bitsStored` up to 8, little-endian 16-bit words otherwise.
+    public static func encode(pixelData: Data, width: Int, height: Int,
+                              components: Int, bitsStored: Int,
+                              isSigned: Bool = false, planar: Bool = false,
+                              options: J2KNativeEncodingOptions = J2KNativeEncodingOptions()) -> Data? {
+        pixelData.withUnsafeBytes {
+            encode($0, width: width, height: height, components: components,
+                   bitsStored: bitsStored, isSigned: isSigned, planar: planar,
+                   options: options)
+        }
+    }
+
+    static func encode(_ pixels: UnsafeRawBufferPointer, width: Int, height: Int,
+                       components: Int, bitsStored: Int, isSigned: Bool,
+                       planar: Bool, options: J2KNativeEncodingOptions) -> Data? {
+        guard width > 0, height > 0, components > 0,
+              bitsStored > 0, bitsStored <= 16,
+              let base = pixels.baseAddress else { return nil }
+        let bytesPerSample = bitsStored <= 8 ? 1 : 2
+        guard pixels.count >= width * height * components * bytesPerSample else {
+            return nil
+        }
+
+        var native = nativeOptions(width: width, height: height, components: components,
+                                   bitsStored: bitsStored, isSigned: isSigned,
+                                   planar: planar, options: options)
+        var codestream: UnsafeMutablePointer<UInt8>?
+        var length = 0
+        var errorMessage = [CChar](repeating: 0, count: 256)
+        let status = ojph_encode_image(base, 0, &native, &codestream, &length,
+                                       &errorMessage, errorMessage.count)
+        guard status == OJPH_STATUS_OK, let codestream = codestream else { return nil }
+        defer { ojph_free_codestream(codestream) }
+        return Data(bytes: codestream, count: length)
+    }
+
+    /// Encodes the frames of a multi-frame image, packed one after the other
+    /// as stored in the DICOM dataset, straight into encapsulated Pixel Data.
+    /// `expectedRatio` (e.g. 2.5 for lossless CT; 0 when unknown) sizes the
+    /// buffer once up front. Leave `basicOffsetTable` off when writing the
+    /// Extended Offset Table, which needs the Basic Offset Table empty.
+    public static func encodeFrames(pixelData: Data, frameCount: Int,
+                                    width: Int, height: Int, components: Int,
+                                    bitsStored: Int, isSigned: Bool = false,
+                                    planar: Bool = false,
+                                    options: J2KNativeEncodingOptions = J2KNativeEncodingOptions(),
+                                    expectedRatio: Float = 0,
+                                    basicOffsetTable: Bool = true) -> J2KEncapsulatedFrames? {
+        guard frameCount > 0, width > 0, height > 0, components > 0,
+              bitsStored > 0, bitsStored <= 16 else { return nil }
+        let frameBytes = width * height * components * (bitsStored <= 8 ? 1 : 2)
+        guard pixelData.count >= frameBytes * frameCount else { return nil }
+
+        var native = nativeOptions(width: width, height: height, components: components,
+                                   bitsStored: bitsStored, isSigned: isSigned,
+                                   planar: planar, options: options)
+        // the buffer is grown with realloc, so the result is handed to Data
+        // as is; the context tracks it to release it on failure
+        var buffer: UnsafeMutablePointer<UInt8>?
+        var fragments = [ojph_frame_fragment](repeating: ojph_frame_fragment(),
+                                              count: frameCount)
+        var length = 0
+        let status: ojph_status = withUnsafeMutablePointer(to: &buffer) { buffer in
+            var frames = ojph_frames_options()
+            frames.grow = { context, old, capacity in
+                guard let grown = realloc(old, capacity) else { return nil }
+                let bytes = grown.assumingMemoryBound(to: UInt8.self)
+                context?.assumingMemoryBound(to: UnsafeMutablePointer<UInt8>?.self)
+                    .pointee = bytes
+                return bytes
+            }
+            frames.context = UnsafeMutableRawPointer(buffer)
+            frames.expected_ratio = expectedRatio
+            frames.basic_offset_table = basicOffsetTable ? 1 : 0
+            return pixelData.withUnsafeBytes { pixels in
+                ojph_encode_frames(pixels.baseAddress, 0, 0, UInt32(clamping: frameCount),
+                                   &native, &frames, &fragments, &length, nil, 0)
+            }
+        }
+        guard status == OJPH_STATUS_OK, let result = buffer else {
+            free(buffer)
+            return nil
+        }
+        return J2KEncapsulatedFrames(
+            pixelData: Data(bytesNoCopy: result, count: length, deallocator: .free),
+            offsets: fragments.map { $0.offset },
+            lengths: fragments.map { $0.length })
+    }
+
+    static func nativeOptions(width: Int, height: Int, components: Int,
+                              bitsStored: Int, isSigned: Bool, planar: Bool,
+                              options: J2KNativeEncodingOptions) -> ojph_encode_options {
+        var native = ojph_encode_options()
+        native.width = UInt32(clamping: width)
+        native.height = UInt32(clamping: height)
+        native.components = UInt16(clamping: components)
+        native.bit_depth = UInt16(bitsStored)
+        native.is_signed = isSigned ? 1 : 0
+        native.irreversible = options.lossless ? 0 : 1
+        native.color_transform = options.colorTransform ? 1 : 0
+        native.layout = planar ? OJPH_LAYOUT_PLANAR : OJPH_LAYOUT_INTERLEAVED
+        native.progression = options.progression.native
+        native.decompositions = UInt32(clamping: options.decompositions)
+        native.block_width = UInt32(clamping: options.blockWidth)
+        native.block_height = UInt32(clamping: options.blockHeight)
+        if let tile = options.tileSize {
+            native.tile_width = UInt32(clamping: tile.width)
+            native.tile_height = UInt32(clamping: tile.height)
+        }
+        native.quantization_step = options.quantizationStep ?? 0
+        native.packet_lengths = options.packetLengths ? 1 : 0
+        return native
+    }
+}
+
+/// Frames encoded by `J2KNativeEncoder.encodeFrames`, ready to be written.
+public struct J2KEncapsulatedFrames {
+    /// Value of the Pixel Data element (7FE0,0010), OB with undefined
+    /// length: the Basic Offset Table item, one fragment per frame and the
+    /// sequence delimiter.
+    public let pixelData: Data
+    /// Extended Offset Table (7FE0,0001) entries, which are also those of
+    /// the Basic Offset Table.
+    public let offsets: [UInt64]
+    /// Extended Offset Table Lengths (7FE0,0002) entries.
+    public let lengths: [UInt64]
+}
+
+/// Native HTJ2K encoder fed a few rows at a time, e.g. to transcode a
+/// whole-slide level or a large radiograph without holding all of its
+/// samples. The codestream is handed to `write` in order as it is produced,
+/// each row of tiles as soon as its last row is appended; with a tile
+/// height in the options, memory stays bounded whatever the image height.
+public final class J2KNativeStreamEncoder {
+    private final class Sink {
+        let write: (UnsafeRawBufferPointer) -> Bool
+        init(_ write: @escaping (UnsafeRawBufferPointer) -> Bool) { self.write = write }
+    }
+
+    private let handle: OpaquePointer
+    private let sink: Sink
+    private let rowBytes: Int
+
+    /// Starts an encode and writes the main header; see
+    /// `J2KNativeEncoder.encode(_:width:height:components:bitsStored:isSigned:planar:options:)`
+    /// for the image description. `write` receives the bytes, valid for the
+    /// duration of the call, and returns `false` to fail the encode. Returns
+    /// `nil` if the image or parameters cannot be encoded.
+    public init?(width: Int, height: Int, components: Int, bitsStored: Int,
+                 isSigned: Bool = false, planar: Bool = false,
+                 options: J2KNativeEncodingOptions = J2KNativeEncodingOptions(),
+                 write: @escaping (UnsafeRawBufferPointer) -> Bool) {
+        guard width > 0, height > 0, components > 0,
+              bitsStored > 0, bitsStored <= 16 else { return nil }
+        var native = J2KNativeEncoder.nativeOptions(width: width, height: height,
+                                                    components: components,
+                                                    bitsStored: bitsStored,
+                                                    isSigned: isSigned, planar: planar,
+                                                    options: options)
+        let sink = Sink(write)
+        let context = Unmanaged.passUnretained(sink).toOpaque()
+        guard let handle = ojph_encoder_create(&native, { context, data, length in
+            guard let context = context, let data = data else { return 0 }
+            let sink = Unmanaged<Sink>.fromOpaque(context).takeUnretainedValue()
+            return sink.write(UnsafeRawBufferPointer(start: data, count: length)) ? 1 : 0
+        }, context, nil, 0) else { return nil }
+        self.handle = handle
+        self.sink = sink
+        rowBytes = width * components * (bitsStored <= 8 ? 1 : 2)
+    }
+
+    deinit {
+        ojph_encoder_destroy(handle)
+    }
+
+    /// Encodes the next rows, packed in the layout of the encoder: bytes for
+    /// `bitsStored` up to 8, little-endian 16-bit words otherwise; planar
+    /// rows hold the rows of each component one plane after the other.
+    /// Returns `false` if the encode failed.
+    @discardableResult
+    public func append(rows pixels: UnsafeRawBufferPointer) -> Bool {
+        let rows = pixels.count / rowBytes
+        guard rows * rowBytes == pixels.count else { return false }
+        return ojph_encoder_push_rows(handle, pixels.baseAddress, 0, UInt32(clamping: rows),
+                                      nil, 0) == OJPH_STATUS_OK
+    }
+
+    /// Encodes the next rows of raw pixel data, as stored in the DICOM
+    /// dataset; see `append(rows:)`.
+    @discardableResult
+    public func append(_ pixelData: Data) -> Bool {
+        pixelData.withUnsafeBytes { append(rows: $0) }
+    }
+
+    /// Writes the rest of the codestream, once every row has been appended.
+    @discardableResult
+    public func finish() -> Bool {
+        ojph_encoder_finish(handle, nil, 0) == OJPH_STATUS_OK
+    }
+}
@@ -0,0 +1,283 @@
+//
+//  J2KMetalSynthesis.swift
+//  DcmSwift
+//
+//  GPU back end of the native JPEG 2000 decoder: OpenJPH decodes the
+//  codeblocks on the CPU, in parallel, and hands over the dequantized
+//  subbands (`ojph_decode_subbands`); the inverse wavelet transform, the
+//  inverse colour transform and the window run here, into a texture.
+//  Returns nil whenever the codestream or the device does not suit, so
+//  callers fall back to `J2KNativeDecoder`.
+//
+
+import Foundation
+
+#if canImport(Metal)
+import Metal
+import OpenJPH
+
+public final class J2KMetalSynthesis {
+    public static let shared = J2KMetalSynthesis()
+
+    private let device: MTLDevice?
+    private let commandQueue: MTLCommandQueue?
+    private let interleavePipelineState: MTLComputePipelineState?
+    private let synthesis53PipelineState: MTLComputePipelineState?
+    private let synthesis97PipelineState: MTLComputePipelineState?
+    private let outputPipelineState: MTLComputePipelineState?
+
+    public var isAvailable: Bool {
+        interleavePipelineState != nil && synthesis53PipelineState != nil &&
+            synthesis97PipelineState != nil && outputPipelineState != nil
+    }
+
+    private init(accelerator: MetalAccelerator = .shared) {
+        let debug = UserDefaults.standard.bool(forKey: "settings.debugLogsEnabled")
+        device = accelerator.device
+        commandQueue = accelerator.commandQueue
+
+        func pipeline(_ name: String) -> MTLComputePipelineState? {
+            guard let f = accelerator.library?.makeFunction(name: name), let d = accelerator.device else {
+                if debug { print("[J2KMetalSynthesis] \(name) function not found in library") }
+                return nil
+            }
+            let state = try? d.makeComputePipelineState(function: f)
+            if debug { print("[J2KMetalSynthesis] Pipeline \(name) -> \(state != nil ? "ok" : "nil")") }
+            return state
+        }
+        interleavePipelineState = pipeline("j2kInterleaveKernel")
+        synthesis53PipelineState = pipeline("j2kSynthesis53Kernel")
+        synthesis97PipelineState = pipeline("j2kSynthesis97Kernel")
+        outputPipelineState = pipeline("j2kOutputKernel")
+    }
+
+    // Layouts of the parameter structures of Shaders.metal.
+    private struct InterleaveParams {
+        var width, height, originX, originY: UInt32
+        var llPitch, hlPitch, lhPitch, hhPitch: UInt32
+    }
+
+    private struct SynthesisParams {
+        var length, count, stride, lineStep, origin: UInt32
+    }
+
+    private struct OutputParams {
+        var width, height, components, colorTransform: UInt32
+        var isFloat, bitDepth, isSigned, invert: UInt32
+        var rescaleSlope, rescaleIntercept, bias: Float
+        var windowFunction: UInt32
+        var windowCenter, windowWidth: Float
+    }
+
+    /// Subbands of one decode, in shared buffers the kernels read directly.
+    /// Filled by the callback of `ojph_decode_subbands`, which runs on the
+    /// decoding thread, one call at a time, so it is not locked.
+    private final class BandStore {
+        var bands: [Int: (info: ojph_subband, buffer: MTLBuffer)] = [:]
+        let cache: MetalBufferCache
+        var failed = false
+
+        init(cache: MetalBufferCache) {
+            self.cache = cache
+        }
+
+        static func key(_ component: UInt32, _ resolution: UInt32, _ band: UInt32) -> Int {
+            Int(component) << 16 | Int(resolution) << 4 | Int(band)
+        }
+
+        func recycle() {
+            for entry in bands.values { cache.recycle(entry.buffer) }
+            bands.removeAll()
+        }
+    }
+
+    /// Decodes `codestream` into an `rgba8Unorm` texture: grey levels through
+    /// `window` for one component, or RGB for three. Without a window, the
+    /// nominal range of the transformed samples maps to black and white.
+    /// Returns nil for codestreams of more than one tile, subsampled or
+    /// non-uniform components, more than 16 bits per sample, Part 2 wavelets,
+    /// or when Metal is unavailable.
+    public func decode(_ codestream: Data,
+                       discardLevels: Int = 0,
+                       transform: J2KNativeSampleTransform = .identity,
+                       window: J2KNativeWindow? = nil) -> MTLTexture? {
+        guard isAvailable, let device = device, let queue = commandQueue,
+              let info = J2KNativeDecoder.probe(codestream),
+              info.tilesAcross == 1, info.tilesDown == 1,
+              info.isUniform, !info.isSubsampled,
+              info.bitsPerSample >= 1, info.bitsPerSample <= 16,
+              info.components >= 1 else { return nil }
+
+        let components = info.components >= 3 ? 3 : 1
+        let store = BandStore(cache: MetalBufferCache.shared)
+        defer { store.recycle() }
+
+        var options = J2KNativeDecoder.decodeOptions(planar: false, transform: .identity,
+                                                     format: .integer, window: nil,
+                                                     componentMask: components == 3 ? 0x7 : 0x1)
+        options.discard_levels = UInt32(clamping: max(0, discardLevels))
+        let context = Unmanaged.passUnretained(store).toOpaque()
+        let status = codestream.withUnsafeBytes { rawBuffer -> ojph_status in
+            guard let base = rawBuffer.bindMemory(to: UInt8.self).baseAddress else {
+                return OJPH_STATUS_ERROR
+            }
+            return ojph_decode_subbands(nil, base, rawBuffer.count, &options,
+                                        { context, band, row, samples in
+                guard let context = context, let band = band?.pointee,
+                      let samples = samples else { return 0 }
+                let store = Unmanaged<BandStore>.fromOpaque(context).takeUnretainedValue()
+                let key = BandStore.key(band.component, band.resolution, band.band)
+                let rowBytes = Int(band.width) * 4
+                guard rowBytes > 0 else { return 1 }
+                if row == 0 {
+                    guard let buffer = store.cache.buffer(length: rowBytes * Int(band.height)) else {
+                        store.failed = true
+                        return 0
+                    }
+                    store.bands[key] = (band, buffer)
+                }
+                guard let buffer = store.bands[key]?.buffer else { return 0 }
+                memcpy(buffer.contents() + rowBytes * Int(row), samples, rowBytes)
+                return 1
+            }, context, nil, 0)
+        }
+        guard status == OJPH_STATUS_OK, !store.failed,
+              let commandBuffer = queue.makeCommandBuffer(),
+              let encoder = commandBuffer.makeComputeCommandEncoder() else { return nil }
+
+        // synthesize each component from its LL band up
+        var planes: [MTLBuffer] = []
+        var width = 0, height = 0, isFloat = false
+        for c in 0..<UInt32(components) {
+            guard let ll = store.bands[BandStore.key(c, 0, 0)] else {
+                encoder.endEncoding()
+                return nil
+            }
+            var current = ll.buffer
+            var pitch = ll.info.width
+            width = Int(ll.info.width); height = Int(ll.info.height)
+            isFloat = ll.info.is_float != 0
+            let top = store.bands.keys.filter { $0 >> 16 == Int(c) }.map { ($0 >> 4) & 0xFFF }.max() ?? 0
+            for resolution in UInt32(1)..<UInt32(top + 1) {
+                let hl = store.bands[BandStore.key(c, resolution, 1)]
+                let lh = store.bands[BandStore.key(c, resolution, 2)]
+                let hh = store.bands[BandStore.key(c, resolution, 3)]
+                // a resolution without high-pass samples is its LL band
+                guard let band = hl?.info ?? lh?.info ?? hh?.info else { continue }
+                guard let target = store.cache.buffer(length: Int(band.res_width) * Int(band.res_height) * 4) else {
+                    encoder.endEncoding()
+                    return nil
+                }
+                store.bands[BandStore.key(c, resolution, 0)] = (band, target)
+
+                var interleave = InterleaveParams(width: band.res_width, height: band.res_height,
+                                                  originX: band.res_x, originY: band.res_y,
+                                                  llPitch: pitch,
+                                                  hlPitch: hl?.info.width ?? 0,
+                                                  lhPitch: lh?.info.width ?? 0,
+                                                  hhPitch: hh?.info.width ?? 0)
+                encoder.setComputePipelineState(interleavePipelineState!)
+                encoder.setBuffer(current, offset: 0, index: 0)
+                // absent bands are never read; bind something in their place
+                encoder.setBuffer(hl?.buffer ?? current, offset: 0, index: 1)
+                encoder.setBuffer(lh?.buffer ?? current, offset: 0, index: 2)
+                encoder.setBuffer(hh?.buffer ?? current, offset: 0, index: 3)
+                encoder.setBuffer(target, offset: 0, index: 4)
+                encoder.setBytes(&interleave, length: MemoryLayout<InterleaveParams>.stride, index: 5)
+                dispatch(encoder, interleavePipelineState!, width: Int(band.res_width), height: Int(band.res_height))
+                // each pass reads what the one before it wrote into target
+                encoder.memoryBarrier(scope: .buffers)
+
+                let synthesis = isFloat ? synthesis97PipelineState! : synthesis53PipelineState!
+                var rows = SynthesisParams(length: band.res_width, count: band.res_height,
+                                           stride: 1, lineStep: band.res_width, origin: band.res_x)
+                var columns = SynthesisParams(length: band.res_height, count: band.res_width,
+                                              stride: band.res_width, lineStep: 1, origin: band.res_y)
+                encoder.setComputePipelineState(synthesis)
+                encoder.setBuffer(target, offset: 0, index: 0)
+                encoder.setBytes(&rows, length: MemoryLayout<SynthesisParams>.stride, index: 1)
+                dispatch(encoder, synthesis, width: Int(band.res_height), height: 1)
+                encoder.memoryBarrier(scope: .buffers)
+                encoder.setBytes(&columns, length: MemoryLayout<SynthesisParams>.stride, index: 1)
+                dispatch(encoder, synthesis, width: Int(band.res_width), height: 1)
+                encoder.memoryBarrier(scope: .buffers)
+
+                current = target
+                pitch = band.res_width
+                width = Int(band.res_width); height = Int(band.res_height)
+            }
+            planes.append(current)
+        }
+        guard width > 0, height > 0 else {
+            encoder.endEncoding()
+            return nil
+        }
+
+        let descriptor = MTLTextureDescriptor.texture2DDescriptor(pixelFormat: .rgba8Unorm,
+                                                                  width: width, height: height,
+                                                                  mipmapped: false)
+        descriptor.usage = [.shaderRead, .shaderWrite]
+        guard let texture = device.makeTexture(descriptor: descriptor) else {
+            encoder.endEncoding()
+            return nil
+        }
+
+        var windowFunction: UInt32 = 0
+        if let window = window {
+            switch window.function {
+            case .linear: windowFunction = 1
+            case .linearExact: windowFunction = 2
+            case .sigmoid: windowFunction = 3
+            }
+        }
+        var output = OutputParams(width: UInt32(width), height: UInt32(height),
+                                  components: UInt32(components),
+                                  colorTransform: components == 3 && info.usesColorTransform
+                                      ? (isFloat ? 2 : 1) : 0,
+                                  isFloat: isFloat ? 1 : 0,
+                                  bitDepth: UInt32(info.bitsPerSample),
+                                  isSigned: info.isSigned ? 1 : 0,
+                                  invert: transform.invert ? 1 : 0,
+                                  rescaleSlope: Float(transform.rescaleSlope),
+                                  rescaleIntercept: Float(transform.rescaleIntercept),
+                                  bias: Float(transform.bias),
+                                  windowFunction: windowFunction,
+                                  windowCenter: Float(window?.center ?? 0),
+                                  windowWidth: Float(max(window?.width ?? 1, 1e-6)))
+        encoder.setComputePipelineState(outputPipelineState!)
+        for (index, plane) in planes.enumerated() {
+            encoder.setBuffer(plane, offset: 0, index: index)
+        }
+        for index in planes.count..<3 {
+            encoder.setBuffer(planes[0], offset: 0, index: index)
+        }
+        encoder.setBytes(&output, length: MemoryLayout<OutputParams>.stride, index: 3)
+        encoder.setTexture(texture, index: 0)
+        dispatch(encoder, outputPipelineState!, width: width, height: height)
+        encoder.endEncoding()
+
+        commandBuffer.commit()
+        commandBuffer.waitUntilCompleted()
+        return commandBuffer.status == .completed ? texture : nil
+    }
+
+    private func dispatch(_ encoder: MTLComputeCommandEncoder, _ pso: MTLComputePipelineState,
+                          width: Int, height: Int) {
+        let w = min(pso.threadExecutionWidth, pso.maxTotalThreadsPerThreadgroup)
+        let h = height > 1 ? max(1, pso.maxTotalThreadsPerThreadgroup / w) : 1
+        let threadsPerThreadgroup = MTLSize(width: w, height: h, depth: 1)
+        let groups = MTLSize(width: (width + w - 1) / w, height: (height + h - 1) / h, depth: 1)
+        encoder.dispatchThreadgroups(groups, threadsPerThreadgroup: threadsPerThreadgroup)
+    }
+}
+
+#else
+
+// Non-Apple platforms or when Metal is unavailable
+public final class J2KMetalSynthesis {
+    public static let shared = J2KMetalSynthesis()
+    public let isAvailable: Bool = false
+    private init() {}
+}
+
+#endif
@@ -126,3 +126,206 @@ kernel void voiLUTKernel(
         outPixels[outBase + 3] = 255;
     }
 }
+
+// MARK: - JPEG 2000 Synthesis
+
+// The kernels below finish a decode that `ojph_decode_subbands` started: they
+// rebuild a resolution from the one below it and its three high-pass bands,
+// one resolution at a time, then turn the components into display pixels.
+// Samples at odd positions of the resolution grid are the high-pass ones.
+
+struct J2KInterleaveParams {
+    uint width;           // of the resolution
+    uint height;
+    uint originX;         // of the resolution on the grid of the codestream
+    uint originY;
+    uint llPitch;         // samples per row of each band
+    uint hlPitch;
+    uint lhPitch;
+    uint hhPitch;
+};
+
+// Places the samples of the four bands at their positions in the resolution;
+// samples are moved as bits, so both int and float bands use this kernel.
+kernel void j2kInterleaveKernel(
+    device const uint*            ll      [[ buffer(0) ]],
+    device const uint*            hl      [[ buffer(1) ]],
+    device const uint*            lh      [[ buffer(2) ]],
+    device const uint*            hh      [[ buffer(3) ]],
+    device uint*                  out     [[ buffer(4) ]],
+    constant J2KInterleaveParams& params  [[ buffer(5) ]],
+    uint2                         gid     [[ thread_position_in_grid ]]
+) {
+    if (gid.x >= params.width || gid.y >= params.height) return;
+
+    uint gx = params.originX + gid.x, gy = params.originY + gid.y;
+    bool hiX = (gx & 1) != 0, hiY = (gy & 1) != 0;
+    // index of the sample within its band
+    uint bx = hiX ? gx / 2 - (params.originX + 1) / 2 : gx / 2 - params.originX / 2;
+    uint by = hiY ? gy / 2 - (params.originY + 1) / 2 : gy / 2 - params.originY / 2;
+
+    uint v;
+    if (!hiY) v = hiX ? hl[by * params.hlPitch + bx] : ll[by * params.llPitch + bx];
+    else      v = hiX ? hh[by * params.hhPitch + bx] : lh[by * params.lhPitch + bx];
+    out[gid.y * params.width + gid.x] = v;
+}
+
+// One thread runs the 1D synthesis of one line of `length` samples, `stride`
+// apart; lines start `lineStep` apart, so rows and columns use the same
+// kernels. Both ends extend symmetrically.
+struct J2KSynthesisParams {
+    uint length;
+    uint count;           // of lines
+    uint stride;
+    uint lineStep;
+    uint origin;          // of the first sample on the grid of the codestream
+};
+
+// Reversible 5/3 synthesis, on int samples.
+kernel void j2kSynthesis53Kernel(
+    device int*                   samples [[ buffer(0) ]],
+    constant J2KSynthesisParams&  params  [[ buffer(1) ]],
+    uint                          gid     [[ thread_position_in_grid ]]
+) {
+    if (gid >= params.count) return;
+    device int* x = samples + gid * params.lineStep;
+    uint n = params.length, s = params.stride;
+
+    if (n == 1) {
+        // a lone high-pass sample holds twice the value
+        if (params.origin & 1) x[0] >>= 1;
+        return;
+    }
+    // the low-pass samples first, then the high-pass ones
+    for (uint i = params.origin & 1; i < n; i += 2) {
+        uint l = i == 0 ? 1 : i - 1, r = i + 1 == n ? n - 2 : i + 1;
+        x[i * s] -= (2 + x[l * s] + x[r * s]) >> 2;
+    }
+    for (uint i = (params.origin & 1) ^ 1; i < n; i += 2) {
+        uint l = i == 0 ? 1 : i - 1, r = i + 1 == n ? n - 2 : i + 1;
+        x[i * s] += (x[l * s] + x[r * s]) >> 1;
+    }
+}
+
+// Irreversible 9/7 synthesis, on float samples.
+kernel void j2kSynthesis97Kernel(
+    device float*                 samples [[ buffer(0) ]],
+    constant J2KSynthesisParams&  params  [[ buffer(1) ]],
+    uint                          gid     [[ thread_position_in_grid ]]
+) {
+    if (gid >= params.count) return;
+    device float* x = samples + gid * params.lineStep;
+    uint n = params.length, s = params.stride;
+
+    if (n == 1) {
+        if (params.origin & 1) x[0] *= 0.5f;
+        return;
+    }
+    const float A[4] = { 0.443506852043971f, 0.882911075530934f,
+                        -0.052980118572961f, -1.586134342059924f };
+    const float K = 1.230174104914001f;
+    uint lowParity = params.origin & 1;
+    for (uint i = 0; i < n; ++i)
+        x[i * s] *= ((i & 1) == lowParity) ? K : 1.0f / K;
+    // steps 0 and 2 update the low-pass samples, 1 and 3 the high-pass ones
+    for (uint j = 0; j < 4; ++j) {
+        for (uint i = lowParity ^ (j & 1); i < n; i += 2) {
+            uint l = i == 0 ? 1 : i - 1, r = i + 1 == n ? n - 2 : i + 1;
+            x[i * s] -= A[j] * (x[l * s] + x[r * s]);
+        }
+    }
+}
+
+struct J2KOutputParams {
+    uint width;
+    uint height;
+    uint components;      // 1, or 3 for RGB
+    uint colorTransform;  // 0 none, 1 RCT, 2 ICT
+    uint isFloat;         // samples in [-0.5, 0.5), to be scaled by 2^bitDepth
+    uint bitDepth;
+    uint isSigned;
+    uint invert;          // reflect samples within their nominal range
+    float rescaleSlope;
+    float rescaleIntercept;
+    float bias;
+    uint windowFunction;  // 0 the nominal range, 1 LINEAR, 2 LINEAR_EXACT, 3 SIGMOID
+    float windowCenter;
+    float windowWidth;
+};
+
+// Reads sample `i` of component `c` as a stored sample of the codestream.
+static float j2kStoredSample(device const int* c, uint i, constant J2KOutputParams& p, float lo, float hi) {
+    float v = p.isFloat ? rint(as_type<float>(c[i]) * float(1u << p.bitDepth)) : float(c[i]);
+    if (!p.isSigned) v += float(1u << (p.bitDepth - 1));
+    return clamp(v, lo, hi);
+}
+
+// Inverse colour transform, level shift, modality rescale and window of the
+// synthesized components, one pixel per thread, into an RGBA texture.
+kernel void j2kOutputKernel(
+    device const int*             c0      [[ buffer(0) ]],
+    device const int*             c1      [[ buffer(1) ]],
+    device const int*             c2      [[ buffer(2) ]],
+    constant J2KOutputParams&     params  [[ buffer(3) ]],
+    texture2d<float, access::write> out   [[ texture(0) ]],
+    uint2                         gid     [[ thread_position_in_grid ]]
+) {
+    if (gid.x >= params.width || gid.y >= params.height) return;
+    uint i = gid.y * params.width + gid.x;
+
+    float lo = params.isSigned ? -float(1u << (params.bitDepth - 1)) : 0.0f;
+    float hi = params.isSigned ? float(1u << (params.bitDepth - 1)) - 1.0f
+                               : float((1u << params.bitDepth) - 1u);
+
+    if (params.components == 3) {
+        float3 rgb;
+        if (params.colorTransform == 1) {
+            int y = c0[i], cb = c1[i], cr = c2[i];
+            int g = y - ((cb + cr) >> 2);
+            int3 v = int3(cr + g, g, cb + g);
+            if (!params.isSigned) v += int(1u << (params.bitDepth - 1));
+            rgb = clamp(float3(v), lo, hi);
+        } else if (params.colorTransform == 2) {
+            float y = as_type<float>(c0[i]), cb = as_type<float>(c1[i]), cr = as_type<float>(c2[i]);
+            float3 v = float3(y + 1.402f * cr, y - 0.344136f * cb - 0.714136f * cr, y + 1.772f * cb);
+            v = rint(v * float(1u << params.bitDepth));
+            if (!params.isSigned) v += float(1u << (params.bitDepth - 1));
+            rgb = clamp(v, lo, hi);
+        } else {
+            rgb = float3(j2kStoredSample(c0, i, params, lo, hi),
+                         j2kStoredSample(c1, i, params, lo, hi),
+                         j2kStoredSample(c2, i, params, lo, hi));
+        }
+        rgb = (rgb - lo) / (hi - lo);
+        out.write(float4(rgb, 1.0f), gid);
+        return;
+    }
+
+    float v = j2kStoredSample(c0, i, params, lo, hi);
+    if (params.invert) v = lo + hi - v;
+    v = v * params.rescaleSlope + params.rescaleIntercept + params.bias;
+
+    float y;
+    switch (params.windowFunction) {
+    case 1: {
+        float w = max(params.windowWidth - 1.0f, 1.0f / 256.0f);
+        y = (v - (params.windowCenter - 0.5f)) / w + 0.5f;
+        break;
+    }
+    case 2:
+        y = (v - params.windowCenter) / params.windowWidth + 0.5f;
+        break;
+    case 3:
+        y = 1.0f / (1.0f + exp(-4.0f * (v - params.windowCenter) / params.windowWidth));
+        break;
+    default: {
+        // the nominal range of the transformed samples
+        float a = lo * params.rescaleSlope + params.rescaleIntercept + params.bias;
+        float b = hi * params.rescaleSlope + params.rescaleIntercept + params.bias;
+        y = (v - min(a, b)) / max(abs(b - a), 1.0f);
+        break;
+    }
+    }
+    y = clamp(y, 0.0f, 1.0f);
+    out.write(float4(y, y, y, 1.0f), gid);
+}
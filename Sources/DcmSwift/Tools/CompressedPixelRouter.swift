@@ -66,6 +66,38 @@ public enum CompressedPixelRouter {
     }
 }
 
+// MARK: - Native Sample Transform
+
+extension CompressedPixelRouter {
+
+    /// The transform the native decoder applies to grayscale samples while it
+    /// writes them, so that no further pass over the frame is needed.
+    /// MONOCHROME1 is reflected within the nominal range of the samples. An
+    /// integral modality rescale is folded in too, biased to unsigned samples
+    /// when its result spans at most 16 bits; the returned slope and
+    /// intercept are those the frame still carries, which undo the bias.
+    /// Fractional rescales, e.g. of PET, would lose precision as integers
+    /// and are left to the caller.
+    static func nativeGrayTransform(info: J2KNativeImageInfo, invert: Bool,
+                                    slope: Double, intercept: Double)
+        -> (transform: J2KNativeSampleTransform, slope: Double, intercept: Double) {
+        let depth = min(info.bitsPerSample, 32)
+        let lo = info.isSigned ? -pow(2.0, Double(depth - 1)) : 0
+        let hi = pow(2.0, Double(info.isSigned ? depth - 1 : depth)) - 1
+        let slope = slope == 0 ? 1 : slope
+        let a = lo * slope + intercept, b = hi * slope + intercept
+        let lowest = min(a, b), highest = max(a, b)
+        guard slope.rounded() == slope, intercept.rounded() == intercept,
+              highest - lowest <= 65535 else {
+            return (J2KNativeSampleTransform(invert: invert), slope, intercept)
+        }
+        let bias = lowest < 0 ? -lowest : 0
+        return (J2KNativeSampleTransform(invert: invert, rescaleSlope: slope,
+                                         rescaleIntercept: intercept, bias: Int32(bias)),
+                1, -bias)
+    }
+}
+
 // MARK: - Individual Decoder Methods
 
 private extension CompressedPixelRouter {
@@ -101,21 +133,39 @@ private extension CompressedPixelRouter {
         
         // Prefer native decoder (OpenJPH) when requested for high bit-depth streams.
         let preferNativeDecode = (UserDefaults.standard.object(forKey: "settings.decoderPrefer16Bit") as? Bool) ?? true
+        // The header probe is cheap; it spares a failed native decode of
+        // streams OpenJPH cannot handle before falling back below.
         if preferNativeDecode,
-           let native = J2KNativeDecoder.decode(codestream) {
+           let info = J2KNativeDecoder.probe(codestream), info.isDecodable {
+            let mono1 = (pi?.trimmingCharacters(in: .whitespaces).uppercased() == "MONOCHROME1")
+            let gray = nativeGrayTransform(info: info, invert: mono1, slope: slope, intercept: intercept)
+            guard let native = J2KNativeDecoder.decode(codestream,
+                                                       transform: info.components == 1 ? gray.transform : .identity) else {
+                return try decodeJPEG2000Part1ImageIO(codestream: codestream, slope: slope, intercept: intercept,
+                                                      pi: pi, sop: sop, debug: debug, t0: t0)
+            }
             if native.components == 1, let p16 = native.pixels16, native.bitsPerSample > 8 {
-                let mono1 = (pi?.trimmingCharacters(in: .whitespaces).uppercased() == "MONOCHROME1")
-                let p16Out: [UInt16] = mono1 ? p16.map { 0xFFFF &- $0 } : p16
-                let bits = bitsAllocatedTag > 0 ? bitsAllocatedTag : native.bitsPerSample
+                // a folded rescale can widen 8-bit samples
+                let bits = bitsAllocatedTag > 8 ? bitsAllocatedTag : max(16, native.bitsPerSample)
                 let out = DecodedFrame(id: sop, width: native.width, height: native.height, bitsAllocated: bits,
-                                       pixels8: nil, pixels16: p16Out,
-                                       rescaleSlope: slope, rescaleIntercept: intercept,
+                                       pixels8: nil, pixels16: p16,
+                                       rescaleSlope: gray.slope, rescaleIntercept: gray.intercept,
                                        photometricInterpretation: mono1 ? "MONOCHROME2" : pi)
                 if debug {
                     let dt = (CFAbsoluteTimeGetCurrent() - t0) * 1000
                     print("[CompressedPixelRouter] J2K native decode dt=\(String(format: "%.1f", dt)) ms size=\(native.width)x\(native.height)")
                 }
                 return out
+            } else if native.components == 1, let pixels8 = native.pixels8 {
+                let out = DecodedFrame(id: sop, width: native.width, height: native.height, bitsAllocated: 8,
+                                       pixels8: pixels8, pixels16: nil,
+                                       rescaleSlope: gray.slope, rescaleIntercept: gray.intercept,
+                                       photometricInterpretation: mono1 ? "MONOCHROME2" : pi)
+                if debug {
+                    let dt = (CFAbsoluteTimeGetCurrent() - t0) * 1000
+                    print("[CompressedPixelRouter] J2K native 8-bit decode dt=\(String(format: "%.1f", dt)) ms size=\(native.width)x\(native.height)")
+                }
+                return out
             } else if native.components == 3, let rgb = native.pixels8 {
                 let out = DecodedFrame(id: sop, width: native.width, height: native.height, bitsAllocated: 8,
                                        pixels8: rgb, pixels16: nil,
@@ -129,7 +179,14 @@ private extension CompressedPixelRouter {
             }
         }
         
-        // Use ImageIO decoder
+        return try decodeJPEG2000Part1ImageIO(codestream: codestream, slope: slope, intercept: intercept,
+                                              pi: pi, sop: sop, debug: debug, t0: t0)
+    }
+
+    /// Decode a JPEG 2000 Part 1 codestream with ImageIO, for streams the native decoder cannot handle
+    static func decodeJPEG2000Part1ImageIO(codestream: Data, slope: Double, intercept: Double,
+                                           pi: String?, sop: String?, debug: Bool,
+                                           t0: CFAbsoluteTime) throws -> DecodedFrame {
         let j2k = try JPEG2000Decoder.decodeCodestream(codestream)
         
         if j2k.bitsPerComponent > 8 && j2k.components == 1 {
@@ -194,18 +251,27 @@ private extension CompressedPixelRouter {
         let sop = dataset.string(forTag: "SOPInstanceUID")
         let preferNativeDecode = (UserDefaults.standard.object(forKey: "settings.decoderPrefer16Bit") as? Bool) ?? true
 
-        guard preferNativeDecode, let native = J2KNativeDecoder.decode(codestream) else {
+        let probe = J2KNativeDecoder.probe(codestream)
+        if debug, let reason = probe?.unsupportedReason {
+            print("[CompressedPixelRouter] HTJ2K stream not decodable natively: \(reason)")
+        }
+        let mono1 = (pi?.trimmingCharacters(in: .whitespaces).uppercased() == "MONOCHROME1")
+        guard preferNativeDecode, let info = probe else {
+            if debug { print("[CompressedPixelRouter] HTJ2K native decoder unavailable") }
+            throw PixelServiceError.missingPixelData
+        }
+        let gray = nativeGrayTransform(info: info, invert: mono1, slope: slope, intercept: intercept)
+        guard let native = J2KNativeDecoder.decode(codestream,
+                                                   transform: info.components == 1 ? gray.transform : .identity) else {
             if debug { print("[CompressedPixelRouter] HTJ2K native decoder unavailable") }
             throw PixelServiceError.missingPixelData
         }
 
         if native.components == 1, let pixels16 = native.pixels16 {
-            let mono1 = (pi?.trimmingCharacters(in: .whitespaces).uppercased() == "MONOCHROME1")
-            let p16Out: [UInt16] = mono1 ? pixels16.map { 0xFFFF &- $0 } : pixels16
-            let bits = bitsAllocatedTag > 0 ? bitsAllocatedTag : max(16, native.bitsPerSample)
+            let bits = bitsAllocatedTag > 8 ? bitsAllocatedTag : max(16, native.bitsPerSample)
             let out = DecodedFrame(id: sop, width: native.width, height: native.height, bitsAllocated: bits,
-                                   pixels8: nil, pixels16: p16Out,
-                                   rescaleSlope: slope, rescaleIntercept: intercept,
+                                   pixels8: nil, pixels16: pixels16,
+                                   rescaleSlope: gray.slope, rescaleIntercept: gray.intercept,
                                    photometricInterpretation: mono1 ? "MONOCHROME2" : pi)
             if debug {
                 let dt = (CFAbsoluteTimeGetCurrent() - t0) * 1000
@@ -215,11 +281,9 @@ private extension CompressedPixelRouter {
         }
 
         if native.components == 1, let pixels8 = native.pixels8 {
-            let mono1 = (pi?.trimmingCharacters(in: .whitespaces).uppercased() == "MONOCHROME1")
-            let p8Out: [UInt8] = mono1 ? pixels8.map { 255 &- $0 } : pixels8
             let out = DecodedFrame(id: sop, width: native.width, height: native.height, bitsAllocated: 8,
-                                   pixels8: p8Out, pixels16: nil,
-                                   rescaleSlope: slope, rescaleIntercept: intercept,
+                                   pixels8: pixels8, pixels16: nil,
+                                   rescaleSlope: gray.slope, rescaleIntercept: gray.intercept,
                                    photometricInterpretation: mono1 ? "MONOCHROME2" : pi)
             if debug {
                 let dt = (CFAbsoluteTimeGetCurrent() - t0) * 1000
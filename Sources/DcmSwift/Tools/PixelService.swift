@@ -21,6 +21,10 @@ public struct DecodedFrame: Sendable {
     public let bitsAllocated: Int
     public let pixels8: [UInt8]?
     public let pixels16: [UInt16]?
+    /// Turn the samples into modality values. They can differ from the
+    /// dataset's `RescaleSlope`/`RescaleIntercept` when the decoder already
+    /// applied part of the rescale, e.g. an offset that keeps signed CT
+    /// samples unsigned.
     public let rescaleSlope: Double
     public let rescaleIntercept: Double
     public let photometricInterpretation: String?
@@ -40,6 +40,7 @@
 #define OJPH_BITBUFFER_READ_H
 
 #include "ojph_defs.h"
+#include "ojph_arch.h"
 #include "ojph_file.h"
 
 namespace ojph {
@@ -53,13 +54,26 @@ namespace ojph {
 
 
     //////////////////////////////////////////////////////////////////////////
+    // Packet header bits are read several bytes at a time into a 64-bit
+    // register, tmp, whose avail_bits most significant bits are the bits
+    // not read yet; the bits under them are zero.  A byte that follows an
+    // 0xFF one has a stuffed most significant bit, which is dropped as the
+    // byte is moved in.  Past the end of the packet data, zero_bits zeros
+    // are moved in instead, and reading any of them reports failure.
+    // Bytes moved in but not reached when the header ends are given back
+    // to the file by bb_terminate.  Failures set error, which stays set,
+    // and the reads that follow them see zeros.
     struct bit_read_buf
     {
       infile_base *file;
-      ui32 tmp;
+      ui64 tmp;
       int avail_bits;
-      bool unstuff;
+      int zero_bits;
+      bool unstuff;      // the last byte moved in is 0xFF
+      ui32 stuffed;      // bit i is set when the (i+1)-th last byte moved in
+                         // has only 7 bits
       ui32 bytes_left;
+      const char *error; // NULL unless reading the packet failed
     };
 
     //////////////////////////////////////////////////////////////////////////
@@ -67,45 +81,76 @@ namespace ojph {
     void bb_init(bit_read_buf *bbp, ui32 bytes_left, infile_base* file)
     {
       bbp->avail_bits = 0;
+      bbp->zero_bits = 0;
       bbp->file = file;
       bbp->bytes_left = bytes_left;
       bbp->tmp = 0;
       bbp->unstuff = false;
+      bbp->stuffed = 0;
+      bbp->error = NULL;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // records the first failure; the packet is then taken to end here
+    static inline
+    bool bb_fail(bit_read_buf *bbp, const char *error)
+    {
+      if (bbp->error == NULL)
+        bbp->error = error;
+      bbp->bytes_left = 0;
+      return false;
     }
 
     /////////////////////////////////////////////////////////////////////////////
+    // moves as many bytes as fit into tmp, or zeros when there are none left
     static inline
-    bool bb_read(bit_read_buf *bbp)
+    void bb_read(bit_read_buf *bbp)
     {
-      if (bbp->bytes_left > 0)
+      if (bbp->bytes_left == 0)
       {
-        ui32 t = 0;
-        if (bbp->file->read(&t, 1) != 1)
-          throw "error reading from file";
-        bbp->tmp = t;
-        bbp->avail_bits = 8 - bbp->unstuff;
-        bbp->unstuff = (t == 0xFF);
-        --bbp->bytes_left;
-        return true;
+        bbp->zero_bits += 64 - bbp->avail_bits;
+        bbp->avail_bits = 64;
+        return;
       }
-      else
+      ui32 num_bytes = (ui32)(64 - bbp->avail_bits) >> 3;
+      num_bytes = ojph_min(num_bytes, bbp->bytes_left);
+      ui8 bytes[8];
+      num_bytes = (ui32)bbp->file->read(bytes, num_bytes);
+      if (num_bytes == 0)
       {
-        bbp->tmp = 0;
-        bbp->avail_bits = 8 - bbp->unstuff;
-        bbp->unstuff = false;
-        return false;
+        bb_fail(bbp, "error reading from file");
+        bb_read(bbp);
+        return;
       }
+      bbp->bytes_left -= num_bytes;
+      ui64 tmp = bbp->tmp;
+      int avail_bits = bbp->avail_bits;
+      ui32 unstuff = bbp->unstuff, stuffed = bbp->stuffed;
+      for (ui32 i = 0; i < num_bytes; ++i)
+      {
+        ui32 t = bytes[i];
+        int bits = 8 - (int)unstuff;
+        tmp |= (ui64)(t & (0xFFu >> unstuff)) << (64 - avail_bits - bits);
+        avail_bits += bits;
+        stuffed = (stuffed << 1) | unstuff;
+        unstuff = (t == 0xFF);
+      }
+      bbp->tmp = tmp;
+      bbp->avail_bits = avail_bits;
+      bbp->unstuff = unstuff != 0;
+      bbp->stuffed = stuffed;
     }
 
     //////////////////////////////////////////////////////////////////////////
     static inline
     bool bb_read_bit(bit_read_buf *bbp, ui32& bit)
     {
-      bool result = true;
       if (bbp->avail_bits == 0)
-        result = bb_read(bbp);
-      bit = (bbp->tmp >> --bbp->avail_bits) & 1;
-      return result;
+        bb_read(bbp);
+      bit = (ui32)(bbp->tmp >> 63);
+      bbp->tmp <<= 1;
+      --bbp->avail_bits;
+      return bbp->avail_bits >= bbp->zero_bits;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -114,18 +159,70 @@ namespace ojph {
     {
       assert(num_bits <= 32);
 
-      bits = 0;
-      bool result = true;
-      while (num_bits) {
+      while (bbp->avail_bits < num_bits)
+        bb_read(bbp);
+      bits = (ui32)((bbp->tmp >> 1) >> (63 - num_bits));
+      bbp->tmp <<= num_bits;
+      bbp->avail_bits -= num_bits;
+      return bbp->avail_bits >= bbp->zero_bits;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // reads zero bits until a one bit, which is read too, or until
+    // max_zeros of them are read; zeros is set to their number, and one
+    // to whether a one bit ended them
+    static inline
+    bool bb_read_zeros(bit_read_buf *bbp, ui32 max_zeros, ui32& zeros,
+                       bool& one)
+    {
+      zeros = 0;
+      one = false;
+      while (zeros < max_zeros)
+      {
         if (bbp->avail_bits == 0)
-          result = bb_read(bbp);
-        int tx_bits = ojph_min(bbp->avail_bits, num_bits);
-        bits <<= tx_bits;
-        bbp->avail_bits -= tx_bits;
-        num_bits -= tx_bits;
-        bits |= (bbp->tmp >> bbp->avail_bits) & ((1 << tx_bits) - 1);
+          bb_read(bbp);
+        ui32 run = count_leading_zeros(bbp->tmp | 1); // at most 63
+        run = ojph_min(run, (ui32)bbp->avail_bits);
+        run = ojph_min(run, max_zeros - zeros);
+        bbp->tmp <<= run;
+        bbp->avail_bits -= (int)run;
+        zeros += run;
+        if (bbp->avail_bits < bbp->zero_bits)
+          return false;
+        if (zeros < max_zeros && bbp->avail_bits > 0 && (bbp->tmp >> 63))
+        {
+          bbp->tmp <<= 1;
+          --bbp->avail_bits;
+          one = true;
+          break;
+        }
+      }
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // reads one bits until a zero bit, which is read too; ones is set to
+    // their number
+    static inline
+    bool bb_read_ones(bit_read_buf *bbp, ui32& ones)
+    {
+      ones = 0;
+      while (true)
+      {
+        if (bbp->avail_bits == 0)
+          bb_read(bbp);
+        // the bits under the unread ones are zero, so run <= avail_bits
+        ui32 run = count_leading_zeros(~bbp->tmp | 1); // at most 63
+        bbp->tmp <<= run;
+        bbp->avail_bits -= (int)run;
+        ones += run;
+        if (bbp->avail_bits > 0 && (bbp->tmp >> 63) == 0)
+        {
+          bbp->tmp <<= 1;
+          --bbp->avail_bits;
+          return bbp->avail_bits >= bbp->zero_bits;
+        }
       }
-      return result;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -150,31 +247,65 @@ namespace ojph {
 
     //////////////////////////////////////////////////////////////////////////
     static inline
-    void bb_skip_eph(bit_read_buf *bbp)
+    bool bb_skip_eph(bit_read_buf *bbp)
     {
       if (bbp->bytes_left >= 2)
       {
         ui8 marker[2];
         if (bbp->file->read(marker, 2) != 2)
-          throw "error reading from file";
+          return bb_fail(bbp, "error reading from file");
         bbp->bytes_left -= 2;
         if ((int)marker[0] != (EPH >> 8) || (int)marker[1] != (EPH & 0xFF))
-          throw "should find EPH, but found something else";
+          return bb_fail(bbp, "should find EPH, but found something else");
       }
+      return true;
     }
 
     //////////////////////////////////////////////////////////////////////////
+    // ends the packet header after the last byte read from; the bytes moved
+    // into tmp after it are given back to the file, unless the byte after
+    // an 0xFF one, which still belongs to the header
     static inline
     bool bb_terminate(bit_read_buf *bbp, bool uses_eph)
     {
       bool result = true;
-      if (bbp->unstuff)
-        result = bb_read(bbp);
-      assert(bbp->unstuff == false);
-      if (uses_eph)
-        bb_skip_eph(bbp);
+      int bits_left = bbp->avail_bits - bbp->zero_bits;
+      ui32 unread = 0;
+      while (bits_left > 0)
+      {
+        int bits = 8 - (int)((bbp->stuffed >> unread) & 1);
+        if (bits_left < bits)
+          break;
+        bits_left -= bits;
+        ++unread;
+      }
+      if (unread > 0)
+      {
+        if ((bbp->stuffed >> (unread - 1)) & 1)
+          --unread;
+        if (unread > 0)
+        {
+          if (bbp->file->seek(-(si64)unread, infile_base::OJPH_SEEK_CUR))
+            result = bb_fail(bbp, "error seeking file");
+          else
+            bbp->bytes_left += unread;
+        }
+      }
+      else if (bbp->unstuff && bits_left >= 0)
+      {
+        ui8 t;
+        if (bbp->bytes_left > 0 && bbp->file->read(&t, 1) == 1)
+          --bbp->bytes_left;
+        else
+          result = false;
+      }
+      bbp->unstuff = false;
+      if (uses_eph && bbp->error == NULL)
+        result = bb_skip_eph(bbp) && result;
       bbp->tmp = 0;
       bbp->avail_bits = 0;
+      bbp->zero_bits = 0;
+      bbp->stuffed = 0;
       return result;
     }
 
@@ -186,7 +317,7 @@ namespace ojph {
       {
         ui8 marker[2];
         if (bbp->file->read(marker, 2) != 2)
-          throw "error reading from file";
+          return bb_fail(bbp, "error reading from file");
         if ((int)marker[0] == (SOP >> 8) && (int)marker[1] == (SOP & 0xFF))
         {
           bbp->bytes_left -= 2;
@@ -194,25 +325,25 @@ namespace ojph {
           {
             ui16 com_len;
             if (bbp->file->read(&com_len, 2) != 2)
-              throw "error reading from file";
+              return bb_fail(bbp, "error reading from file");
             com_len = swap_byte(com_len);
             if (com_len != 4)
-              throw "something is wrong with SOP length";
+              return bb_fail(bbp, "something is wrong with SOP length");
             int result = 
               bbp->file->seek(com_len - 2, infile_base::OJPH_SEEK_CUR);
             if (result != 0)
-              throw "error seeking file";
+              return bb_fail(bbp, "error seeking file");
             bbp->bytes_left -= com_len;
           }
           else
-            throw "precinct truncated early";
+            return bb_fail(bbp, "precinct truncated early");
           return true;
         }
         else
         {
           //put the bytes back
           if (bbp->file->seek(-2, infile_base::OJPH_SEEK_CUR) != 0)
-            throw "error seeking file";
+            return bb_fail(bbp, "error seeking file");
           return false;
         }
       }
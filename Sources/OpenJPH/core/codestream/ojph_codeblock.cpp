@@ -46,6 +46,7 @@
 #include "ojph_codeblock.h"
 #include "ojph_subband.h"
 #include "ojph_resolution.h"
+#include "../coding/ojph_block_decoder.h" // for part1_segment_of_pass
 
 namespace ojph {
 
@@ -104,11 +105,18 @@ namespace ojph {
       const param_cod* coc = codestream->get_coc(comp_idx);
       this->reversible = coc->is_reversible();
       this->resilient = codestream->is_resilient();
+      this->cleanup_only = codestream->is_cleanup_pass_only();
       this->stripe_causal = coc->get_block_vertical_causality();
+      this->block_style = coc->get_block_style();
+      this->ht = (block_style & param_cod::HT_MODE) != 0;
+      this->band_num = parent->get_band_num();
+      this->elastic = codestream->get_elastic_alloc();
+      this->stats = codestream->get_stats();
       this->zero_block = false;
       this->coded_cb = coded_cb;
 
-      this->codeblock_functions.init(reversible);
+      this->codeblock_functions.init(reversible,
+        codestream->is_fixed_point(comp_idx));
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -187,15 +195,40 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void codeblock::decode()
     {
-      if (coded_cb->pass_length[0] > 0 && coded_cb->num_passes > 0 &&
+      OJPH_STATS_TIMER(stats, BLOCKS);
+      if (!ht)
+        decode_part1();
+      else if (coded_cb->pass_length[0] > 0 && coded_cb->num_passes > 0 &&
           coded_cb->next_coded != NULL)
       {
+        // a preview drops the refinement passes, leaving the samples a
+        // bit-plane coarser where they were coded
+        ui32 num_passes = cleanup_only ? 1 : coded_cb->num_passes;
+        if (stats && stats->sink)
+        {
+          codeblock_record cb;
+          cb.coded =
+            coded_cb->next_coded->buf + coded_cb_header::prefix_buf_size;
+          cb.lengths[0] = coded_cb->pass_length[0];
+          cb.lengths[1] = coded_cb->pass_length[1];
+          cb.missing_msbs = coded_cb->missing_msbs;
+          cb.num_passes = num_passes;
+          cb.width = cb_size.w;
+          cb.height = cb_size.h;
+          cb.K_max = K_max;
+          cb.delta = delta;
+          cb.stripe_causal = stripe_causal;
+          cb.reversible = reversible;
+          cb.wide = precision == BUF64;
+          stats->sink->capture(cb);
+        }
+
         bool result;
         if (precision == BUF32)
         {
           result = this->codeblock_functions.decode_cb32(
             coded_cb->next_coded->buf + coded_cb_header::prefix_buf_size,
-            buf32, coded_cb->missing_msbs, coded_cb->num_passes,
+            buf32, coded_cb->missing_msbs, num_passes,
             coded_cb->pass_length[0], coded_cb->pass_length[1],
             cb_size.w, cb_size.h, stride, stripe_causal);
         }
@@ -204,7 +237,7 @@ namespace ojph {
           assert(precision == BUF64);
           result = this->codeblock_functions.decode_cb64(
             coded_cb->next_coded->buf + coded_cb_header::prefix_buf_size,
-            buf64, coded_cb->missing_msbs, coded_cb->num_passes,
+            buf64, coded_cb->missing_msbs, num_passes,
             coded_cb->pass_length[0], coded_cb->pass_length[1],
             cb_size.w, cb_size.h, stride, stripe_causal);
         }
@@ -221,12 +254,101 @@ namespace ojph {
       }
       else
         zero_block = true;
+
+      if (zero_block)
+        OJPH_STATS_COUNT(stats, ZERO_BLOCKS, 1);
+      else
+        OJPH_STATS_COUNT(stats, CODEBLOCKS_DECODED, 1);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codeblock::decode_part1()
+    {
+      ui32 num_passes = coded_cb->num_passes;
+      ui32 num_bytes = coded_cb->pass_length[0];
+      if (num_passes == 0 || num_bytes == 0 || coded_cb->next_coded == NULL)
+      {
+        zero_block = true;
+        return;
+      }
+
+      // segment lengths, trimmed to the bytes received; the passes at the
+      // end, whose data did not arrive, are not decoded
+      ui32 lengths[3 * 64];
+      ui32 num_segs = part1_segment_of_pass(num_passes - 1, block_style) + 1;
+      assert(num_segs <= sizeof(lengths) / sizeof(ui32));
+      ui32 offset = 0;
+      for (ui32 s = 0; s < num_segs; ++s)
+      {
+        lengths[s] = ojph_min(coded_cb->seg_lengths[s], num_bytes - offset);
+        offset += lengths[s];
+      }
+      while (num_passes > 0 &&
+        lengths[part1_segment_of_pass(num_passes - 1, block_style)] == 0)
+        --num_passes;
+      if (num_passes == 0)
+      {
+        zero_block = true;
+        return;
+      }
+
+      // data from many layers is joined, once, into one buffer
+      const ui32 pad =
+        coded_cb_header::prefix_buf_size + coded_cb_header::suffix_buf_size;
+      coded_lists *list = coded_cb->next_coded;
+      if (list->next_list != NULL)
+      {
+        coded_lists *joined;
+        elastic->get_buffer(num_bytes + pad, joined);
+        ui8 *dp = joined->buf + coded_cb_header::prefix_buf_size;
+        ui32 copied = 0;
+        for (; list != NULL && copied < num_bytes; list = list->next_list)
+        {
+          ui32 bytes = ojph_min(list->buf_size - pad, num_bytes - copied);
+          memcpy(dp + copied, list->buf + coded_cb_header::prefix_buf_size,
+                 bytes);
+          copied += bytes;
+        }
+        memset(dp + copied, 0, num_bytes + coded_cb_header::suffix_buf_size
+                               - copied);
+        coded_cb->next_coded = list = joined;
+      }
+
+      bool result;
+      if (precision == BUF32)
+        result = this->codeblock_functions.decode_part1_cb32(
+          list->buf + coded_cb_header::prefix_buf_size, buf32,
+          coded_cb->missing_msbs, num_passes, lengths, band_num,
+          block_style, cb_size.w, cb_size.h, stride);
+      else
+      {
+        assert(precision == BUF64);
+        result = this->codeblock_functions.decode_part1_cb64(
+          list->buf + coded_cb_header::prefix_buf_size, buf64,
+          coded_cb->missing_msbs, num_passes, lengths, band_num,
+          block_style, cb_size.w, cb_size.h, stride);
+      }
+
+      if (result == false)
+      {
+        if (resilient == true) {
+          OJPH_INFO(0x000300A1, "Error decoding a Part-1 codeblock.");
+          zero_block = true;
+        }
+        else
+          OJPH_ERROR(0x000300A1, "Error decoding a Part-1 codeblock.");
+      }
+    }
 
     //////////////////////////////////////////////////////////////////////////
     void codeblock::pull_line(line_buf *line)
     {
+      if (!zero_block)
+      { // the line's span grows to cover this codeblock
+        line->span_begin = ojph_min(line->span_begin, (ui32)line_offset);
+        line->span_end = ojph_max(line->span_end, line_offset + cb_size.w);
+      }
+
       //convert to sign and magnitude
       if (precision == BUF32)
       {
@@ -244,8 +366,11 @@ namespace ojph {
       else
       {
         assert(precision == BUF64);
-        assert(line->flags & line_buf::LFT_64BIT);
-        si64 *dp = line->i64 + line_offset;
+        // irreversible samples are dequantized to float lines
+        assert(line->flags & (reversible ? line_buf::LFT_64BIT
+                                         : line_buf::LFT_32BIT));
+        void *dp = reversible ? (void*)(line->i64 + line_offset)
+                              : (void*)(line->f32 + line_offset);
         if (!zero_block)
         {
           const ui64 *sp = buf64 + cur_line * stride;
@@ -253,7 +378,8 @@ namespace ojph {
                                                  cb_size.w);
         }
         else
-          this->codeblock_functions.mem_clear(dp, cb_size.w * sizeof(*dp));
+          this->codeblock_functions.mem_clear(dp, cb_size.w * 
+            (reversible ? sizeof(si64) : sizeof(float)));
       }
 
       ++cur_line;
@@ -42,6 +42,7 @@
 
 #include "ojph_defs.h"
 #include "ojph_file.h"
+#include "ojph_stats.h"
 #include "ojph_codeblock_fun.h"
 
 namespace ojph {
@@ -82,6 +83,9 @@ namespace ojph {
       void recreate(const size& cb_size, coded_cb_header* coded_cb);
 
       void decode();
+      void decode_part1();
+      void skip_decode()          // not needed; pulls zeros
+      { zero_block = true; OJPH_STATS_COUNT(stats, ZERO_BLOCKS, 1); }
       void pull_line(line_buf *line);
 
     private:
@@ -101,24 +105,33 @@ namespace ojph {
       ui32 K_max;
       bool reversible;
       bool resilient;
+      bool cleanup_only; // HT blocks decode their cleanup pass alone
       bool stripe_causal;
+      bool ht;          // false for JPEG 2000 Part-1 codeblocks
+      ui32 block_style;
+      ui32 band_num;
       bool zero_block; // true when the decoded block is all zero
       union {
         ui32 max_val32[8]; // supports up to 256 bits
         ui64 max_val64[4]; // supports up to 256 bits
       };
       coded_cb_header* coded_cb;
+      mem_elastic_allocator *elastic; // to join Part-1 data of many layers
+      decode_stats *stats;            // NULL unless collected
       codeblock_fun codeblock_functions;
     };
 
     //////////////////////////////////////////////////////////////////////////
     struct coded_cb_header
     {
-      ui32 pass_length[2];
+      ui32 pass_length[2];   // for Part-1 codeblocks, the bytes received
+                             // so far, and those of the current packet
       ui32 num_passes;       // number of passes to be decoded
       ui32 Kmax;
       ui32 missing_msbs;
       coded_lists *next_coded;
+      ui32 *seg_lengths;     // Part-1: bytes in each codeword segment
+      ui32 Lblock;           // Part-1: the length indicator state
 
       static const int prefix_buf_size = 8;
       static const int suffix_buf_size = 16;
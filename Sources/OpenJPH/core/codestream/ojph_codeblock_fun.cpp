@@ -56,78 +56,7 @@ namespace ojph {
   namespace local
   {
 
-    //////////////////////////////////////////////////////////////////////////
-    void gen_mem_clear(void* addr, size_t count);
-    void sse_mem_clear(void* addr, size_t count);
-    void avx_mem_clear(void* addr, size_t count);
-    void wasm_mem_clear(void* addr, size_t count);
-
-    //////////////////////////////////////////////////////////////////////////
-    ui32  gen_find_max_val32(ui32* address);
-    ui32 sse2_find_max_val32(ui32* address);
-    ui32 avx2_find_max_val32(ui32* address);
-    ui32 wasm_find_max_val32(ui32* address);
-    ui64  gen_find_max_val64(ui64* address);
-    ui64 sse2_find_max_val64(ui64* address);
-    ui64 avx2_find_max_val64(ui64* address);
-    ui64 wasm_find_max_val64(ui64* address);
-
-
-    //////////////////////////////////////////////////////////////////////////
-    void  gen_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void sse2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void avx2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void  gen_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void sse2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void avx2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void wasm_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-    void wasm_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui32* max_val);
-
-    void  gen_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void sse2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void avx2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-    void wasm_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
-                             float delta_inv, ui32 count, ui64* max_val);
-
-    //////////////////////////////////////////////////////////////////////////
-    void  gen_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void  gen_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void wasm_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void wasm_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-
-    void  gen_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void sse2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void avx2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);
-    void wasm_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
-                               float delta, ui32 count);                               
-
-    void codeblock_fun::init(bool reversible) {
+    void codeblock_fun::init(bool reversible, bool fixed_point) {
 
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
 
@@ -155,7 +84,7 @@ namespace ojph {
       else
       {
         tx_to_cb64 = NULL;
-        tx_from_cb64 = NULL;
+        tx_from_cb64 = gen_irv_tx_from_cb64;
       }
       encode_cb64 = ojph_encode_codeblock64;
       bool result = initialize_block_encoder_tables();
@@ -187,11 +116,6 @@ namespace ojph {
             tx_to_cb64 = sse2_rev_tx_to_cb64;
             tx_from_cb64 = sse2_rev_tx_from_cb64;
           }
-          else
-          {
-            tx_to_cb64 = NULL;
-            tx_from_cb64 = NULL;
-          }
         }
       #endif // !OJPH_DISABLE_SSE2
 
@@ -208,6 +132,9 @@ namespace ojph {
       #ifndef OJPH_DISABLE_AVX2
         if (get_cpu_ext_level() >= X86_CPU_EXT_LEVEL_AVX2) {
           decode_cb32 = ojph_decode_codeblock_avx2;
+          decode_cb64 = ojph_decode_codeblock64_avx2;
+          encode_cb32 = ojph_encode_codeblock_avx2;
+          encode_cb64 = ojph_encode_codeblock64_avx2;
           find_max_val32 = avx2_find_max_val32;
           if (reversible) {
             tx_to_cb32 = avx2_rev_tx_to_cb32;
@@ -217,9 +144,6 @@ namespace ojph {
             tx_to_cb32 = avx2_irv_tx_to_cb32;
             tx_from_cb32 = avx2_irv_tx_from_cb32;
           }
-          encode_cb32 = ojph_encode_codeblock_avx2;
-          bool result = initialize_block_encoder_tables_avx2();
-          assert(result); ojph_unused(result);
 
           find_max_val64 = avx2_find_max_val64;
           if (reversible) {
@@ -227,23 +151,30 @@ namespace ojph {
             tx_from_cb64 = avx2_rev_tx_from_cb64;
           }
           else
-          {
-            tx_to_cb64 = NULL;
-            tx_from_cb64 = NULL;
-          }
+            tx_from_cb64 = avx2_irv_tx_from_cb64;
         }
       #endif // !OJPH_DISABLE_AVX2
 
-      #if (defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512))
-        if (get_cpu_ext_level() >= X86_CPU_EXT_LEVEL_AVX512) {
-          encode_cb32 = ojph_encode_codeblock_avx512;
-          bool result = initialize_block_encoder_tables_avx512();
-          assert(result); ojph_unused(result);
+    #elif defined(OJPH_ARCH_ARM)
+
+      #ifdef OJPH_ENABLE_NEON
+        if (get_cpu_ext_level() >= ARM_CPU_EXT_LEVEL_NEON) {
+          decode_cb32 = ojph_decode_codeblock_neon;
+          decode_cb64 = ojph_decode_codeblock64_neon;
+          encode_cb32 = ojph_encode_codeblock_neon;
+          encode_cb64 = ojph_encode_codeblock64_neon;
+          find_max_val32 = neon_find_max_val32;
+          find_max_val64 = neon_find_max_val64;
+          tx_to_cb32 = reversible ? neon_rev_tx_to_cb32
+                                  : neon_irv_tx_to_cb32;
+          // irreversible 64-bit codeblocks are never encoded
+          if (reversible)
+            tx_to_cb64 = neon_rev_tx_to_cb64;
+          tx_from_cb64 = reversible ? neon_rev_tx_from_cb64
+                                    : neon_irv_tx_from_cb64;
         }
-      #endif // !OJPH_DISABLE_AVX512
+      #endif // !OJPH_ENABLE_NEON
 
-    #elif defined(OJPH_ARCH_ARM)
-    
     #endif // !(defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
 
   #endif // !OJPH_DISABLE_SIMD
@@ -273,7 +204,7 @@ namespace ojph {
       else
       {
         tx_to_cb64 = NULL;
-        tx_from_cb64 = NULL;
+        tx_from_cb64 = gen_irv_tx_from_cb64;
       }
       encode_cb64 = ojph_encode_codeblock64;
       bool result = initialize_block_encoder_tables();
@@ -281,6 +212,20 @@ namespace ojph {
 
 #endif // !OJPH_ENABLE_WASM_SIMD
 
+      // fixed-point lines are only used for 32-bit irreversible samples
+      if (fixed_point && !reversible)
+      {
+        tx_from_cb32 = gen_fix_tx_from_cb32;
+  #if !defined(OJPH_DISABLE_SIMD) && defined(OJPH_ARCH_ARM) \
+    && defined(OJPH_ENABLE_NEON)
+        if (get_cpu_ext_level() >= ARM_CPU_EXT_LEVEL_NEON)
+          tx_from_cb32 = neon_fix_tx_from_cb32;
+  #endif
+      }
+
+      // Part-1 codeblocks have a single, generic, decoder
+      decode_part1_cb32 = ojph_decode_part1_codeblock32;
+      decode_part1_cb64 = ojph_decode_part1_codeblock64;
     }
   }  // local
 }  // ojph
@@ -149,6 +149,24 @@ namespace ojph {
     return state->is_tlm_needed();
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::request_plt_marker(bool needed)
+  {
+    state->request_plt_marker(needed);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool codestream::is_plt_requested()
+  {
+    return state->is_plt_needed();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::request_tile_row_output(bool needed)
+  {
+    state->request_tile_row_output(needed);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   bool codestream::is_planar() const
   {
@@ -169,6 +187,12 @@ namespace ojph {
     state->enable_resilience();
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::enable_header_cache()
+  {
+    state->enable_header_cache();
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void codestream::read_headers(infile_base *file)
   {
@@ -183,6 +207,66 @@ namespace ojph {
       skipped_res_for_recon);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::restrict_input_region(const rect& region)
+  {
+    state->restrict_input_region(region);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::restrict_input_components(ui32 mask)
+  {
+    state->restrict_input_components(mask);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::defer_colour_transform()
+  {
+    state->defer_colour_transform();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool codestream::is_colour_transform_deferred() const
+  {
+    return state->is_colour_transform_deferred();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::request_fixed_point_synthesis()
+  {
+    state->request_fixed_point_synthesis();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::request_cleanup_pass_only()
+  {
+    state->request_cleanup_pass_only();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::get_num_incomplete_resolutions()
+  {
+    return state->get_num_incomplete_resolutions();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_thread_pool(thread_pool *pool)
+  {
+    state->set_thread_pool(pool);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_stats(decode_stats *stats)
+  {
+    state->set_stats(stats);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_cancel_flag(const std::atomic<bool> *flag)
+  {
+    state->set_cancel_flag(flag);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void codestream::create()
   {
@@ -196,6 +280,72 @@ namespace ojph {
   }
 
 
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::request_strips(ui32 max_rows)
+  {
+    state->request_strips(max_rows);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::get_strip_height() const
+  {
+    return state->get_strip_height();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t codestream::get_strip_pitch() const
+  {
+    return state->get_strip_pitch();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::pull_strip(line_buf *&rows)
+  {
+    return state->pull_strip(rows);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::retain_resolutions(ui32 levels)
+  {
+    state->retain_resolutions(levels);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui32 codestream::get_retained_levels() const
+  {
+    return state->get_retained_levels();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void codestream::set_memory_limit(size_t bytes)
+  {
+    state->set_memory_limit(bytes);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool codestream::is_memory_limited() const
+  {
+    return state->is_memory_limited();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t codestream::get_memory_use() const
+  {
+    return state->get_memory_use();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  line_buf* codestream::pull_retained(ui32 level, ui32 comp_num)
+  {
+    return state->pull_retained(level, comp_num);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool codestream::pull_subbands(subband_sink *sink)
+  {
+    return state->pull_subbands(sink);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   void codestream::flush()
   {
@@ -0,0 +1,292 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_codestream_avx2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <immintrin.h>
+#include "ojph_defs.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // As with the SSE2 versions, max_val holds one running OR per lane, and
+    // the scalar tail accumulates into the first lane.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 avx2_find_max_val32(ui32* address)
+    {
+      __m256i x256 = _mm256_loadu_si256((__m256i*)address);
+      __m128i x = _mm_or_si128(_mm256_castsi256_si128(x256),
+                               _mm256_extracti128_si256(x256, 1));
+      x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+      x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+      return (ui32)_mm_cvtsi128_si32(x);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui64 avx2_find_max_val64(ui64* address)
+    {
+      __m256i x256 = _mm256_loadu_si256((__m256i*)address);
+      __m128i x = _mm_or_si128(_mm256_castsi256_si128(x256),
+                               _mm256_extracti128_si256(x256, 1));
+      x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+      ui64 t;
+      _mm_storel_epi64((__m128i*)&t, x);
+      return t;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 31 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m256i m0 = _mm256_set1_epi32((int)0x80000000);
+      __m256i tmax = _mm256_loadu_si256((__m256i*)max_val);
+      const si32 *p = (const si32*)sp;
+      for (; count >= 8; count -= 8, p += 8, dp += 8)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)p);
+        __m256i sign = _mm256_and_si256(v, m0);
+        __m256i val = _mm256_sll_epi32(_mm256_abs_epi32(v), vshift);
+        _mm256_storeu_si256((__m256i*)dp, _mm256_or_si256(val, sign));
+        tmax = _mm256_or_si256(tmax, val);
+      }
+      _mm256_storeu_si256((__m256i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si32 v = *p++;
+        ui32 sign = v >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(K_max);
+      __m256 d = _mm256_set1_ps(delta_inv);
+      __m256i m0 = _mm256_set1_epi32((int)0x80000000);
+      __m256i tmax = _mm256_loadu_si256((__m256i*)max_val);
+      const float *p = (const float*)sp;
+      for (; count >= 8; count -= 8, p += 8, dp += 8)
+      {
+        __m256i t =
+          _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(p), d));
+        __m256i sign = _mm256_and_si256(t, m0);
+        __m256i val = _mm256_abs_epi32(t);
+        _mm256_storeu_si256((__m256i*)dp, _mm256_or_si256(val, sign));
+        tmax = _mm256_or_si256(tmax, val);
+      }
+      _mm256_storeu_si256((__m256i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        float v = *p++;
+        si32 t = ojph_trunc(v * delta_inv);
+        ui32 sign = t >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(t >= 0 ? t : -t);
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 31 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m256i m1 = _mm256_set1_epi32(0x7FFFFFFF);
+      si32 *p = (si32*)dp;
+      for (; count >= 8; count -= 8, sp += 8, p += 8)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        __m256i val = _mm256_srl_epi32(_mm256_and_si256(v, m1), vshift);
+        val = _mm256_sign_epi32(val, v); // v is negative iff its sign is set
+        _mm256_storeu_si256((__m256i*)p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui32 v = *sp++;
+        si32 val = (v & 0x7FFFFFFFU) >> shift;
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      __m256i m0 = _mm256_set1_epi32((int)0x80000000);
+      __m256i m1 = _mm256_set1_epi32(0x7FFFFFFF);
+      __m256 d = _mm256_set1_ps(delta);
+      float *p = (float*)dp;
+      for (; count >= 8; count -= 8, sp += 8, p += 8)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        __m256 val = _mm256_cvtepi32_ps(_mm256_and_si256(v, m1));
+        val = _mm256_mul_ps(val, d);
+        val = _mm256_or_ps(val, _mm256_castsi256_ps(_mm256_and_si256(v, m0)));
+        _mm256_storeu_ps(p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui32 v = *sp++;
+        float val = (float)(v & 0x7FFFFFFFU) * delta;
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui64* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 63 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m256i m0 = _mm256_set1_epi64x((si64)0x8000000000000000ULL);
+      __m256i zero = _mm256_setzero_si256();
+      __m256i tmax = _mm256_loadu_si256((__m256i*)max_val);
+      const si64 *p = (const si64*)sp;
+      for (; count >= 4; count -= 4, p += 4, dp += 4)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)p);
+        __m256i sign = _mm256_cmpgt_epi64(zero, v);
+        __m256i val = _mm256_sub_epi64(_mm256_xor_si256(v, sign), sign);
+        val = _mm256_sll_epi64(val, vshift);
+        _mm256_storeu_si256((__m256i*)dp,
+          _mm256_or_si256(val, _mm256_and_si256(sign, m0)));
+        tmax = _mm256_or_si256(tmax, val);
+      }
+      _mm256_storeu_si256((__m256i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si64 v = *p++;
+        ui64 sign = v >= 0 ? 0ULL : 0x8000000000000000ULL;
+        ui64 val = (ui64)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 63 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m256i m1 = _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL);
+      __m256i zero = _mm256_setzero_si256();
+      si64 *p = (si64*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        __m256i val = _mm256_srl_epi64(_mm256_and_si256(v, m1), vshift);
+        __m256i sign = _mm256_cmpgt_epi64(zero, v);
+        val = _mm256_sub_epi64(_mm256_xor_si256(val, sign), sign);
+        _mm256_storeu_si256((__m256i*)p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui64 v = *sp++;
+        si64 val = (v & 0x7FFFFFFFFFFFFFFFULL) >> shift;
+        *p++ = (v & 0x8000000000000000ULL) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      // AVX2 has no 64-bit integer to double conversion; the two 32-bit
+      // halves of the magnitude are placed in the mantissas of 2^84 and
+      // 2^52, which are then removed, so that the only rounding is in the
+      // final addition, as for a cast
+      __m256i m0 = _mm256_set1_epi64x((si64)0x8000000000000000ULL);
+      __m256i m1 = _mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL);
+      __m256i hi_exp = _mm256_set1_epi64x(0x4530000000000000LL); // 2^84
+      __m256i lo_exp = _mm256_set1_epi64x(0x4330000000000000LL); // 2^52
+      // 2^84 + 2^52
+      __m256d bias = _mm256_set1_pd(19342813118337666422669312.0);
+      __m256d d = _mm256_set1_pd((double)delta);
+      float *p = (float*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        __m256i mag = _mm256_and_si256(v, m1);
+        __m256d hi = _mm256_castsi256_pd(
+          _mm256_or_si256(_mm256_srli_epi64(mag, 32), hi_exp));
+        __m256d lo = _mm256_castsi256_pd(
+          _mm256_blend_epi32(mag, lo_exp, 0xAA));
+        __m256d val = _mm256_add_pd(_mm256_sub_pd(hi, bias), lo);
+        val = _mm256_mul_pd(val, d);
+        val = _mm256_or_pd(val,
+          _mm256_castsi256_pd(_mm256_and_si256(v, m0)));
+        _mm_storeu_ps(p, _mm256_cvtpd_ps(val));
+      }
+      for (; count > 0; --count)
+      {
+        ui64 v = *sp++;
+        double val = (double)(v & 0x7FFFFFFFFFFFFFFFULL) * (double)delta;
+        *p++ = (float)((v & 0x8000000000000000ULL) ? -val : val);
+      }
+    }
+
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
@@ -37,6 +37,7 @@
 
 #include "ojph_defs.h"
 #include "ojph_arch.h"
+#include "../transform/ojph_transform.h"
 
 namespace ojph {
   namespace local {
@@ -166,6 +167,39 @@ namespace ojph {
         *p++ = (v & 0x80000000U) ? -val : val;
       }
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_fix_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                              float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      ui32 mult, shift;
+      fix_dequantizer(delta, mult, shift);
+      const ui64 half = (ui64)1 << (shift - 1);
+      si32 *p = (si32*)dp;
+      for (ui32 i = count; i > 0; --i)
+      {
+        ui32 v = *sp++;
+        si32 val = (si32)(((v & 0x7FFFFFFFU) * (ui64)mult + half) >> shift);
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_irv_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                              float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      // the magnitude can exceed the 24 bits of a float mantissa, so it is
+      // scaled in double, leaving a single rounding to float
+      float *p = (float*)dp;
+      for (ui32 i = count; i > 0; --i)
+      {
+        ui64 v = *sp++;
+        double val = (double)(v & 0x7FFFFFFFFFFFFFFFULL) * (double)delta;
+        *p++ = (float)((v & 0x8000000000000000ULL) ? -val : val);
+      }
+    }
     
  }
 }
\ No newline at end of file
@@ -38,9 +38,11 @@
 
 #include <climits>
 #include <cmath>
+#include <cstring>
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_tile.h"
 
@@ -54,7 +56,8 @@ namespace ojph {
 
     //////////////////////////////////////////////////////////////////////////
     codestream::codestream()
-    : precinct_scratch(NULL), allocator(NULL), elastic_alloc(NULL)
+    : precinct_scratch(NULL), cache_headers(false), pool(NULL),
+      stats(NULL), allocator(NULL), elastic_alloc(NULL)
     {
       allocator = new mem_fixed_allocator;
       elastic_alloc = new mem_elastic_allocator(1048576); // 1 megabyte
@@ -68,6 +71,7 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     codestream::~codestream()
     {
+      wait_for_codeblock_jobs();
       if (allocator)
         delete allocator;
       if (elastic_alloc)
@@ -77,6 +81,8 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     void codestream::restart()
     {
+      wait_for_codeblock_jobs();
+
       tiles = NULL;
       lines = NULL;
       comp_size = NULL;
@@ -90,27 +96,101 @@ namespace ojph {
       profile = OJPH_PN_UNDEFINED;
       tilepart_div = OJPH_TILEPART_NO_DIVISIONS;
       need_tlm = false;
+      need_plt = false;
+      tile_row_output = false;
+      tile_rows_written = 0;
+      tile_rows_shared = false;
+      plts.clear();
 
       cur_comp = 0;
       cur_line = 0;
       cur_tile_row = 0;
       resilient = false;
       skipped_res_for_read = skipped_res_for_recon = 0;
+      siz.set_skipped_resolutions(0);
+      has_region = false;
+      region = rect();
+      component_mask = 0xFFFFFFFFu;
+      defer_colour = colour_deferred = false;
+      fixed_point = false;
+      cleanup_only = false;
 
       precinct_scratch_needed_bytes = 0;
 
+      pool = NULL;
+      stats = NULL;
+      cancel = NULL;
+      strips_requested = 0;
+      use_strips = tile_parallel = false;
+      strip_lines = NULL;
+      strip_height = strip_first = strip_count = 0;
+      strip_pitch = 0;
+      retain_requested = retained_levels = 0;
+      memory_limit = 0;
+      memory_limited = false;
+
+      // with a header cache, read_headers() decides whether the parsed
+      // main header can be kept for the next codestream
+      if (!cache_headers)
+        restart_params();
+
+      allocator->restart();
+      elastic_alloc->restart();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::restart_params()
+    {
+      tlm_pairs.clear();
+      tlm_usable = true;
       cod.restart();
       qcd.restart();
       nlt.restart();
       dfs.restart();
       atk.restart();
+    }
 
-      allocator->restart();
-      elastic_alloc->restart();
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::wait_for_codeblock_jobs()
+    {
+      // subbands decode one codeblock row ahead, or encode one behind; if
+      // coding stopped early, those jobs may still reference memory we are
+      // about to release
+      if (pool)
+        while (!codeblock_jobs.is_done() && pool->run_pending_task()) {}
+      codeblock_jobs.wait();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    size_t codestream::get_memory_use() const
+    {
+      return allocator->get_size() + elastic_alloc->get_used();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::check_cancelled() const
+    {
+      if (cancel && cancel->load(std::memory_order_relaxed))
+        throw decode_cancelled();
     }
 
     //////////////////////////////////////////////////////////////////////////
     void codestream::pre_alloc()
+    {
+      mem_fixed_allocator::position start = allocator->get_position();
+      memory_limited = false;
+      size_allocations();
+      if (memory_limit != 0 && allocator->get_size() > memory_limit
+          && (use_strips || retained_levels > 0))
+      { //size everything again, without the optional buffers
+        memory_limited = true;
+        allocator->set_position(start);
+        size_allocations();
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::size_allocations()
     {
       ojph::param_siz sz = access_siz();
       num_tiles.w = sz.get_image_extent().x - sz.get_tile_offset().x;
@@ -120,9 +200,33 @@ namespace ojph {
       if (num_tiles.area() > 65535)
         OJPH_ERROR(0x00030011, "number of tiles cannot exceed 65535");
 
+      //resolutions below the reconstructed one that are kept whole, for
+      //pull_retained(); one tile without a region maps their lines
+      //straight onto the reduced image
+      retained_levels = 0;
+      if (retain_requested > 0 && infile != NULL && !has_region
+          && num_tiles.area() == 1 && !memory_limited)
+      {
+        retained_levels = retain_requested;
+        for (ui32 c = 0; c < sz.get_num_components(); ++c)
+        {
+          ui32 d = get_coc(c)->get_num_decompositions();
+          d = d > skipped_res_for_recon ? d - skipped_res_for_recon : 0;
+          retained_levels = ojph_min(retained_levels, d);
+        }
+      }
+
       //allocate tiles
       allocator->pre_alloc_obj<tile>((size_t)num_tiles.area());
 
+      //a tile row written out as soon as it is pushed needs none of its
+      // objects or buffers any more, so all rows get the memory of the
+      // largest one
+      tile_rows_shared = outfile != NULL && tile_row_output && planar == 0
+        && !need_tlm;
+      mem_fixed_allocator::position rows_start = allocator->get_position();
+      tile_rows_size.obj = tile_rows_size.data = 0;
+
       ui32 num_tileparts = 0;
       point index;
       rect tile_rect, recon_tile_rect;
@@ -163,7 +267,19 @@ namespace ojph {
           tile::pre_alloc(this, tile_rect, recon_tile_rect, tps);
           num_tileparts += tps;
         }
+
+        if (tile_rows_shared)
+        {
+          mem_fixed_allocator::position p = allocator->get_position();
+          tile_rows_size.obj =
+            ojph_max(tile_rows_size.obj, p.obj - rows_start.obj);
+          tile_rows_size.data =
+            ojph_max(tile_rows_size.data, p.data - rows_start.data);
+          allocator->set_position(rows_start);
+        }
       }
+      if (tile_rows_shared)
+        skip_tile_rows(rows_start);
 
       //allocate lines
       //These lines are used by codestream to exchange data with external
@@ -172,9 +288,33 @@ namespace ojph {
       allocator->pre_alloc_obj<line_buf>(num_comps);
       allocator->pre_alloc_obj<size>(num_comps); //for *comp_size
       allocator->pre_alloc_obj<size>(num_comps); //for *recon_comp_size
+      allocator->pre_alloc_obj<comp_pacing>(num_comps); //for *pacing
       for (ui32 i = 0; i < num_comps; ++i)
         allocator->pre_alloc_data<si32>(siz.get_recon_width(i), 0);
 
+      //strips, for the reader or for tile-parallel decoding; the latter
+      // is only worthwhile when more than one tile contributes to a line.
+      // Strips need all components to have the same number of lines, so
+      // a strip holds the same rows of every component
+      use_strips = infile != NULL && planar == 0 && !memory_limited;
+      for (ui32 i = 1; i < num_comps && use_strips; ++i)
+        use_strips = siz.get_recon_height(i) == siz.get_recon_height(0);
+      tile_parallel = use_strips && pool != NULL
+        && pool->get_num_threads() > 0 && num_tiles.w > 1;
+      use_strips = use_strips && (tile_parallel || strips_requested > 0);
+      if (use_strips)
+      {
+        ui32 rows = strips_requested > 0 ? strips_requested : 32u;
+        strip_height = ojph_min(rows, siz.get_recon_height(0));
+        ui32 max_width = 0;
+        for (ui32 i = 0; i < num_comps; ++i)
+          max_width = ojph_max(max_width, siz.get_recon_width(i));
+        strip_pitch = calc_aligned_size<si32, byte_alignment>(max_width);
+        allocator->pre_alloc_obj<line_buf>((size_t)num_comps * strip_height);
+        for (ui32 i = 0; i < num_comps; ++i)
+          allocator->pre_alloc_data<si32>(strip_pitch * strip_height, 0);
+      }
+
       //allocate tlm
       if (outfile != NULL && need_tlm)
         allocator->pre_alloc_obj<param_tlm::Ttlm_Ptlm_pair>(num_tileparts);
@@ -218,37 +358,28 @@ namespace ojph {
       tiles = this->allocator->post_alloc_obj<tile>((size_t)num_tiles.area());
 
       ui32 num_tileparts = 0;
-      point index;
-      rect tile_rect;
       ojph::param_siz sz = access_siz();
-      for (index.y = 0; index.y < num_tiles.h; ++index.y)
-      {
-        ui32 y0 = sz.get_tile_offset().y
-                + index.y * sz.get_tile_size().h;
-        ui32 y1 = y0 + sz.get_tile_size().h; //end of tile
-
-        tile_rect.org.y = ojph_max(y0, sz.get_image_offset().y);
-        tile_rect.siz.h =
-          ojph_min(y1, sz.get_image_extent().y) - tile_rect.org.y;
-
-        ui32 offset = 0;
-        for (index.x = 0; index.x < num_tiles.w; ++index.x)
-        {
-          ui32 x0 = sz.get_tile_offset().x
-                  + index.x * sz.get_tile_size().w;
-          ui32 x1 = x0 + sz.get_tile_size().w;
 
-          tile_rect.org.x = ojph_max(x0, sz.get_image_offset().x);
-          tile_rect.siz.w =
-            ojph_min(x1, sz.get_image_extent().x) - tile_rect.org.x;
-
-          ui32 tps = 0; // number of tileparts for this tile
-          ui32 idx = index.y * num_tiles.w + index.x;
-          tiles[idx].finalize_alloc(this, tile_rect, idx, offset, tps);
-          num_tileparts += tps;
-        }
+      // the tiles leave the colour transform to the reader only when it
+      // is the last step of their reconstruction
+      colour_deferred = defer_colour && cod.is_employing_color_transform()
+        && sz.get_num_components() >= 3;
+      for (ui32 i = 0; i < 3 && colour_deferred; ++i)
+      {
+        ui8 bd, nl_type; bool is;
+        colour_deferred = is_component_selected(i)
+          && !nlt.get_nonlinear_transform(i, bd, is, nl_type);
       }
 
+      //with shared tile rows, the rows after the first are finalized in
+      // turn, as the row before them is written out
+      tile_rows_start = allocator->get_position();
+      ui32 num_rows = tile_rows_shared ? 1 : num_tiles.h;
+      for (ui32 y = 0; y < num_rows; ++y)
+        finalize_tile_row(y, num_tileparts);
+      if (tile_rows_shared)
+        skip_tile_rows(tile_rows_start);
+
       //allocate lines
       //These lines are used by codestream to exchange data with external
       // world
@@ -256,7 +387,9 @@ namespace ojph {
       lines = allocator->post_alloc_obj<line_buf>(this->num_comps);
       comp_size = allocator->post_alloc_obj<size>(this->num_comps);
       recon_comp_size = allocator->post_alloc_obj<size>(this->num_comps);
+      pacing = allocator->post_alloc_obj<comp_pacing>(this->num_comps);
       employ_color_transform = cod.is_employing_color_transform();
+      paced = false;
       for (ui32 i = 0; i < this->num_comps; ++i)
       {
         comp_size[i].w = siz.get_width(i);
@@ -264,7 +397,42 @@ namespace ojph {
         ui32 cw = siz.get_recon_width(i);
         recon_comp_size[i].w = cw;
         recon_comp_size[i].h = siz.get_recon_height(i);
-        lines[i].wrap(allocator->post_alloc_data<si32>(cw, 0), cw, 0);
+        if (colour_deferred && i < 3 && !get_coc(i)->is_reversible())
+          lines[i].wrap(allocator->post_alloc_data<float>(cw, 0), cw, 0);
+        else
+          lines[i].wrap(allocator->post_alloc_data<si32>(cw, 0), cw, 0);
+
+        ui32 step = siz.get_downsampling(i).y << skipped_res_for_recon;
+        pacing[i].step = step;
+        pacing[i].first = ojph_div_ceil(sz.get_image_offset().y, step);
+        pacing[i].pulled = 0;
+        paced = paced || recon_comp_size[i].h != recon_comp_size[0].h;
+      }
+
+      if (use_strips)
+      {
+        strip_lines = allocator->post_alloc_obj<line_buf>(
+          (size_t)this->num_comps * strip_height);
+        size_t block = strip_pitch * strip_height;
+        for (ui32 i = 0; i < this->num_comps; ++i)
+        {
+          ui32 cw = recon_comp_size[i].w;
+          line_buf *t = strip_lines + i * strip_height;
+          if (colour_deferred && i < 3 && !get_coc(i)->is_reversible())
+          {
+            float *p = allocator->post_alloc_data<float>(block, 0);
+            for (ui32 j = 0; j < strip_height; ++j, p += strip_pitch)
+              t[j].wrap(p, cw, 0);
+          }
+          else
+          {
+            si32 *p = allocator->post_alloc_data<si32>(block, 0);
+            for (ui32 j = 0; j < strip_height; ++j, p += strip_pitch)
+              t[j].wrap(p, cw, 0);
+          }
+        }
+        strip_first = strip_count = 0;
+        strip_tasks.resize(num_tiles.w);
       }
 
       cur_comp = 0;
@@ -277,6 +445,44 @@ namespace ojph {
     }
 
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::finalize_tile_row(ui32 row, ui32& num_tileparts)
+    {
+      ojph::param_siz sz = access_siz();
+      rect tile_rect;
+      ui32 y0 = sz.get_tile_offset().y + row * sz.get_tile_size().h;
+      ui32 y1 = y0 + sz.get_tile_size().h; //end of tile
+
+      tile_rect.org.y = ojph_max(y0, sz.get_image_offset().y);
+      tile_rect.siz.h =
+        ojph_min(y1, sz.get_image_extent().y) - tile_rect.org.y;
+
+      ui32 offset = 0;
+      for (ui32 x = 0; x < num_tiles.w; ++x)
+      {
+        ui32 x0 = sz.get_tile_offset().x + x * sz.get_tile_size().w;
+        ui32 x1 = x0 + sz.get_tile_size().w;
+
+        tile_rect.org.x = ojph_max(x0, sz.get_image_offset().x);
+        tile_rect.siz.w =
+          ojph_min(x1, sz.get_image_extent().x) - tile_rect.org.x;
+
+        ui32 tps = 0; // number of tileparts for this tile
+        ui32 idx = row * num_tiles.w + x;
+        tiles[idx].finalize_alloc(this, tile_rect, idx, offset, tps);
+        num_tileparts += tps;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::skip_tile_rows(const mem_fixed_allocator::position& p)
+    {
+      mem_fixed_allocator::position end = p;
+      end.obj += tile_rows_size.obj;
+      end.data += tile_rows_size.data;
+      allocator->set_position(end);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::check_imf_validity()
     {
@@ -736,9 +942,56 @@ namespace ojph {
       return 0;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::match_header_cache(infile_base *file)
+    {
+      ui8 buf[256];
+      size_t done = 0, total = header_cache.size();
+      while (done < total)
+      {
+        size_t n = ojph_min(sizeof(buf), total - done);
+        if (file->read(buf, n) != n
+            || memcmp(buf, header_cache.data() + done, n) != 0)
+          return false;
+        done += n;
+      }
+      return total > 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::fill_header_cache(infile_base *file, si64 start)
+    {
+      si64 end = file->tell();
+      header_cache.resize((size_t)(end - start));
+      if (file->seek(start, infile_base::OJPH_SEEK_SET) != 0
+          || file->read(header_cache.data(), header_cache.size())
+             != header_cache.size())
+        header_cache.clear();   // cannot read back; parse the next one
+      file->seek(end, infile_base::OJPH_SEEK_SET);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::read_headers(infile_base *file)
     {
+      OJPH_STATS_TIMER(stats, HEADERS);
+      si64 start = file->tell();
+      if (cache_headers)
+      {
+        // a codestream whose main header, up to and including the first
+        // SOT marker, is byte-identical to the previous one produces the
+        // same parameters, so these are kept and parsing resumes there
+        if (match_header_cache(file))
+        {
+          OJPH_STATS_COUNT(stats, BYTES_PARSED, (ui64)(file->tell() - start));
+          this->infile = file;
+          planar = cod.is_employing_color_transform() ? 0 : 1;
+          return;
+        }
+        file->seek(start, infile_base::OJPH_SEEK_SET);
+        header_cache.clear();
+        restart_params();
+      }
+
       ui16 marker_list[20] = { SOC, SIZ, CAP, PRF, CPF, COD, COC, QCD, QCC,
         RGN, POC, PPM, TLM, PLM, CRG, COM, DFS, ATK, NLT, SOT };
       find_marker(file, marker_list, 1); //find SOC
@@ -763,10 +1016,11 @@ namespace ojph {
           received_markers |= 1;
           ojph::param_cod c(&cod);
           int num_qlayers = c.get_num_layers();
-          if (num_qlayers != 1)
+          if (num_qlayers != 1 &&
+              (cod.get_block_style() & param_cod::HT_MODE) != 0)
             OJPH_ERROR(0x00030053, "The current implementation supports "
-              "1 quality layer only.  This codestream has %d quality layers",
-              num_qlayers);
+              "1 quality layer only for HT codeblocks.  This codestream has "
+              "%d quality layers", num_qlayers);
         }
         else if (marker_idx == 4)
         {
@@ -811,8 +1065,8 @@ namespace ojph {
           skip_marker(file, "PPM", "PPM is not supported yet",
             OJPH_MSG_LEVEL::WARN, false);
         else if (marker_idx == 10)
-          //Skipping TLM marker segment; this should not cause any issues
-          skip_marker(file, "TLM", NULL, OJPH_MSG_LEVEL::NO_MSG, false);
+          //tile-part lengths; used to locate tiles needed for a region
+          tlm_usable &= tlm.read(file, tlm_pairs);
         else if (marker_idx == 11)
           //Skipping PLM marker segment; this should not cause any issues
           skip_marker(file, "PLM", NULL, OJPH_MSG_LEVEL::NO_MSG, false);
@@ -846,6 +1100,10 @@ namespace ojph {
       if (received_markers != 3)
         OJPH_ERROR(0x00030052, "markers error, COD and QCD are required");
 
+      if (cache_headers)
+        fill_header_cache(file, start);
+      OJPH_STATS_COUNT(stats, BYTES_PARSED, (ui64)(file->tell() - start));
+
       this->infile = file;
       planar = cod.is_employing_color_transform() ? 0 : 1;
     }
@@ -870,6 +1128,81 @@ namespace ojph {
       siz.set_skipped_resolutions(skipped_res_for_recon);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::restrict_input_region(const rect& region)
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300E3, "A decoding region can only be set for a "
+          "codestream being read, after reading its headers.");
+      this->region = region;
+      this->has_region = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::restrict_input_components(ui32 mask)
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300E4, "Components can only be selected for a "
+          "codestream being read, after reading its headers.");
+      ui32 num = siz.get_num_components();
+      ui32 existing = num >= 32 ? 0xFFFFFFFFu : (1u << num) - 1;
+      if ((mask & existing) == 0)
+        OJPH_ERROR(0x000300E5, "The component mask 0x%X selects none of "
+          "the %d components of the codestream.", mask, num);
+      this->component_mask = mask;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::defer_colour_transform()
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300E6, "The colour transform can only be deferred "
+          "for a codestream being read, after reading its headers.");
+      defer_colour = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::request_fixed_point_synthesis()
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300EB, "Fixed-point synthesis can only be requested "
+          "for a codestream being read, after reading its headers.");
+      fixed_point = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::request_cleanup_pass_only()
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300EF, "Cleanup-pass-only decoding can only be "
+          "requested for a codestream being read, after reading its "
+          "headers.");
+      cleanup_only = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::is_fixed_point(ui32 comp_num)
+    {
+      if (!fixed_point || infile == NULL)
+        return false;
+      const param_cod* cdp = get_coc(comp_num);
+      if (cdp->access_atk()->is_reversible())
+        return false;
+      const param_qcd* qp = access_qcd()->get_qcc(comp_num);
+      return qp->propose_precision(cdp) <= 32;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 codestream::get_num_incomplete_resolutions()
+    {
+      ui32 incomplete = 0;
+      ui64 num = num_tiles.area();
+      for (ui64 i = 0; i < num; ++i)
+        incomplete = ojph_max(incomplete,
+          tiles[i].get_num_incomplete_resolutions());
+      return incomplete;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::enable_resilience()
     {
@@ -885,183 +1218,17 @@ namespace ojph {
       this->pre_alloc();
       this->finalize_alloc();
 
+      if (has_region && !resilient && index_tile_parts())
+      { // tiles outside the region are not parsed at all
+        read_indexed_tile_parts();
+        return;
+      }
+
       while (true)
       {
         param_sot sot;
         if (sot.read(infile, resilient))
-        {
-          ui64 tile_start_location = (ui64)infile->tell();
-
-          if (sot.get_tile_index() > (int)num_tiles.area())
-          {
-            if (resilient)
-              OJPH_INFO(0x00030061, "wrong tile index")
-            else
-              OJPH_ERROR(0x00030061, "wrong tile index")
-          }
-
-          if (sot.get_tile_part_index())
-          { //tile part
-            if (sot.get_num_tile_parts() &&
-              sot.get_tile_part_index() >= sot.get_num_tile_parts())
-            {
-              if (resilient)
-                OJPH_INFO(0x00030062,
-                  "error in tile part number, should be smaller than total"
-                  " number of tile parts")
-              else
-                OJPH_ERROR(0x00030062,
-                  "error in tile part number, should be smaller than total"
-                  " number of tile parts")
-            }
-
-            bool sod_found = false;
-            ui16 other_tile_part_markers[7] = { SOT, POC, PPT, PLT, COM,
-              NLT, SOD };
-            while (true)
-            {
-              int marker_idx = 0;
-              int result = 0;
-              marker_idx = find_marker(infile, other_tile_part_markers + 1, 6);
-              if (marker_idx == 0)
-                result = skip_marker(infile, "POC",
-                  "POC marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 1)
-                result = skip_marker(infile, "PPT",
-                  "PPT marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 2)
-                //Skipping PLT marker segment;this should not cause any issues
-                result = skip_marker(infile, "PLT", NULL,
-                  OJPH_MSG_LEVEL::NO_MSG, resilient);
-              else if (marker_idx == 3)
-                result = skip_marker(infile, "COM", NULL,
-                  OJPH_MSG_LEVEL::NO_MSG, resilient);
-              else if (marker_idx == 4)
-                result = skip_marker(infile, "NLT",
-                  "NLT marker in tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 5)
-              {
-                sod_found = true;
-                break;
-              }
-
-              if (marker_idx == -1) //marker not found
-              {
-                if (resilient)
-                  OJPH_INFO(0x00030063,
-                    "File terminated early before start of data is found"
-                    " for tile indexed %d and tile part %d",
-                    sot.get_tile_index(), sot.get_tile_part_index())
-                else
-                  OJPH_ERROR(0x00030063,
-                    "File terminated early before start of data is found"
-                    " for tile indexed %d and tile part %d",
-                    sot.get_tile_index(), sot.get_tile_part_index())
-                break;
-              }
-              if (result == -1) //file terminated during marker seg. skipping
-              {
-                if (resilient)
-                  OJPH_INFO(0x00030064,
-                    "File terminated during marker segment skipping")
-                else
-                  OJPH_ERROR(0x00030064,
-                    "File terminated during marker segment skipping")
-                break;
-              }
-            }
-            if (sod_found)
-              tiles[sot.get_tile_index()].parse_tile_header(sot, infile,
-                tile_start_location);
-          }
-          else
-          { //first tile part
-            bool sod_found = false;
-            ui16 first_tile_part_markers[12] = { SOT, COD, COC, QCD, QCC, RGN,
-              POC, PPT, PLT, COM, NLT, SOD };
-            while (true)
-            {
-              int marker_idx = 0;
-              int result = 0;
-              marker_idx = find_marker(infile, first_tile_part_markers+1, 11);
-              if (marker_idx == 0)
-                result = skip_marker(infile, "COD",
-                  "COD marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 1)
-                result = skip_marker(infile, "COC",
-                  "COC marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 2)
-                result = skip_marker(infile, "QCD",
-                  "QCD marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 3)
-                result = skip_marker(infile, "QCC",
-                  "QCC marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 4)
-                result = skip_marker(infile, "RGN",
-                  "RGN marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 5)
-                result = skip_marker(infile, "POC",
-                  "POC marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 6)
-                result = skip_marker(infile, "PPT",
-                  "PPT marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 7)
-                //Skipping PLT marker segment;this should not cause any issues
-                result = skip_marker(infile, "PLT", NULL,
-                  OJPH_MSG_LEVEL::NO_MSG, resilient);
-              else if (marker_idx == 8)
-                result = skip_marker(infile, "COM", NULL,
-                  OJPH_MSG_LEVEL::NO_MSG, resilient);
-              else if (marker_idx == 9)
-                result = skip_marker(infile, "NLT",
-                  "PPT marker segment in a tile is not supported yet",
-                  OJPH_MSG_LEVEL::WARN, resilient);
-              else if (marker_idx == 10)
-              {
-                sod_found = true;
-                break;
-              }
-
-              if (marker_idx == -1) //marker not found
-              {
-                if (resilient)
-                  OJPH_INFO(0x00030065,
-                    "File terminated early before start of data is found"
-                    " for tile indexed %d and tile part %d",
-                    sot.get_tile_index(), sot.get_tile_part_index())
-                else
-                  OJPH_ERROR(0x00030065,
-                    "File terminated early before start of data is found"
-                    " for tile indexed %d and tile part %d",
-                    sot.get_tile_index(), sot.get_tile_part_index())
-                break;
-              }
-              if (result == -1) //file terminated during marker seg. skipping
-              {
-                if (resilient)
-                  OJPH_INFO(0x00030066,
-                    "File terminated during marker segment skipping")
-                else
-                  OJPH_ERROR(0x00030066,
-                    "File terminated during marker segment skipping")
-                break;
-              }
-            }
-            if (sod_found)
-              tiles[sot.get_tile_index()].parse_tile_header(sot, infile,
-                tile_start_location);
-          }
-        }
+          read_tile_part(sot);
 
         // check the next marker; either SOT or EOC,
         // if something is broken, just an end of file
@@ -1079,6 +1246,273 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::read_tile_part(const param_sot& sot)
+    {
+      OJPH_STATS_TIMER(stats, HEADERS);
+      ui64 tile_start_location = (ui64)infile->tell();
+      plt.restart();
+
+      if (sot.get_tile_index() > (int)num_tiles.area())
+      {
+        if (resilient)
+          OJPH_INFO(0x00030061, "wrong tile index")
+        else
+          OJPH_ERROR(0x00030061, "wrong tile index")
+      }
+
+      if (sot.get_tile_part_index())
+      { //tile part
+        if (sot.get_num_tile_parts() &&
+          sot.get_tile_part_index() >= sot.get_num_tile_parts())
+        {
+          if (resilient)
+            OJPH_INFO(0x00030062,
+              "error in tile part number, should be smaller than total"
+              " number of tile parts")
+          else
+            OJPH_ERROR(0x00030062,
+              "error in tile part number, should be smaller than total"
+              " number of tile parts")
+        }
+
+        bool sod_found = false;
+        ui16 other_tile_part_markers[7] = { SOT, POC, PPT, PLT, COM,
+          NLT, SOD };
+        while (true)
+        {
+          int marker_idx = 0;
+          int result = 0;
+          marker_idx = find_marker(infile, other_tile_part_markers + 1, 6);
+          if (marker_idx == 0)
+            result = skip_marker(infile, "POC",
+              "POC marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 1)
+            result = skip_marker(infile, "PPT",
+              "PPT marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 2)
+            //packet lengths; precincts that are not needed are skipped
+            result = plt.read(infile) ? 0 : -1;
+          else if (marker_idx == 3)
+            result = skip_marker(infile, "COM", NULL,
+              OJPH_MSG_LEVEL::NO_MSG, resilient);
+          else if (marker_idx == 4)
+            result = skip_marker(infile, "NLT",
+              "NLT marker in tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 5)
+          {
+            sod_found = true;
+            break;
+          }
+
+          if (marker_idx == -1) //marker not found
+          {
+            if (resilient)
+              OJPH_INFO(0x00030063,
+                "File terminated early before start of data is found"
+                " for tile indexed %d and tile part %d",
+                sot.get_tile_index(), sot.get_tile_part_index())
+            else
+              OJPH_ERROR(0x00030063,
+                "File terminated early before start of data is found"
+                " for tile indexed %d and tile part %d",
+                sot.get_tile_index(), sot.get_tile_part_index())
+            break;
+          }
+          if (result == -1) //file terminated during marker seg. skipping
+          {
+            if (resilient)
+              OJPH_INFO(0x00030064,
+                "File terminated during marker segment skipping")
+            else
+              OJPH_ERROR(0x00030064,
+                "File terminated during marker segment skipping")
+            break;
+          }
+        }
+        if (sod_found)
+          tiles[sot.get_tile_index()].parse_tile_header(sot, infile,
+            tile_start_location, plt);
+      }
+      else
+      { //first tile part
+        bool sod_found = false;
+        ui16 first_tile_part_markers[12] = { SOT, COD, COC, QCD, QCC, RGN,
+          POC, PPT, PLT, COM, NLT, SOD };
+        while (true)
+        {
+          int marker_idx = 0;
+          int result = 0;
+          marker_idx = find_marker(infile, first_tile_part_markers+1, 11);
+          if (marker_idx == 0)
+            result = skip_marker(infile, "COD",
+              "COD marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 1)
+            result = skip_marker(infile, "COC",
+              "COC marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 2)
+            result = skip_marker(infile, "QCD",
+              "QCD marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 3)
+            result = skip_marker(infile, "QCC",
+              "QCC marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 4)
+            result = skip_marker(infile, "RGN",
+              "RGN marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 5)
+            result = skip_marker(infile, "POC",
+              "POC marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 6)
+            result = skip_marker(infile, "PPT",
+              "PPT marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 7)
+            //packet lengths; precincts that are not needed are skipped
+            result = plt.read(infile) ? 0 : -1;
+          else if (marker_idx == 8)
+            result = skip_marker(infile, "COM", NULL,
+              OJPH_MSG_LEVEL::NO_MSG, resilient);
+          else if (marker_idx == 9)
+            result = skip_marker(infile, "NLT",
+              "PPT marker segment in a tile is not supported yet",
+              OJPH_MSG_LEVEL::WARN, resilient);
+          else if (marker_idx == 10)
+          {
+            sod_found = true;
+            break;
+          }
+
+          if (marker_idx == -1) //marker not found
+          {
+            if (resilient)
+              OJPH_INFO(0x00030065,
+                "File terminated early before start of data is found"
+                " for tile indexed %d and tile part %d",
+                sot.get_tile_index(), sot.get_tile_part_index())
+            else
+              OJPH_ERROR(0x00030065,
+                "File terminated early before start of data is found"
+                " for tile indexed %d and tile part %d",
+                sot.get_tile_index(), sot.get_tile_part_index())
+            break;
+          }
+          if (result == -1) //file terminated during marker seg. skipping
+          {
+            if (resilient)
+              OJPH_INFO(0x00030066,
+                "File terminated during marker segment skipping")
+            else
+              OJPH_ERROR(0x00030066,
+                "File terminated during marker segment skipping")
+            break;
+          }
+        }
+        if (sod_found)
+          tiles[sot.get_tile_index()].parse_tile_header(sot, infile,
+            tile_start_location, plt);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::index_tile_parts()
+    {
+      // read_headers() stops right after the SOT marker of the first
+      // tile-part
+      ui64 first = (ui64)infile->tell() - 2;
+      bool indexed = index_from_tlm(first) || index_from_sot(first);
+      infile->seek((si64)first + 2, infile_base::OJPH_SEEK_SET);
+      return indexed;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::index_from_tlm(ui64 offset)
+    {
+      // TLM gives all tile-part lengths without touching the tile-parts;
+      // the table is trusted if it ends exactly at the EOC marker
+      tile_parts.clear();
+      if (!tlm_usable)
+        return false;
+      for (size_t i = 0; i < tlm_pairs.size(); ++i)
+      {
+        if (tlm_pairs[i].Ttlm >= num_tiles.area() || tlm_pairs[i].Ptlm < 14)
+          return false;
+        tile_part_loc loc = { offset, tlm_pairs[i].Ttlm, true };
+        tile_parts.push_back(loc);
+        offset += tlm_pairs[i].Ptlm;
+      }
+      ui8 buf[2];
+      return !tile_parts.empty()
+        && infile->seek((si64)offset, infile_base::OJPH_SEEK_SET) == 0
+        && infile->read(buf, 2) == 2 && buf[0] == 0xFF && buf[1] == 0xD9;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::index_from_sot(ui64 offset)
+    {
+      // hop from one SOT marker segment to the next using Psot; anything
+      // other than a clean chain of tile-parts ending in EOC is left to
+      // the marker search of the linear walk
+      tile_parts.clear();
+      while (true)
+      {
+        ui8 buf[10];
+        if (infile->seek((si64)offset, infile_base::OJPH_SEEK_SET) != 0 ||
+            infile->read(buf, 2) != 2 || buf[0] != 0xFF)
+          return false;
+        if (buf[1] == 0xD9) // EOC
+          return !tile_parts.empty();
+        if (buf[1] != 0x90 || infile->read(buf + 2, 8) != 8)
+          return false;
+        ui16 Isot = (ui16)((buf[4] << 8) | buf[5]);
+        ui32 Psot = ((ui32)buf[6] << 24) | ((ui32)buf[7] << 16)
+                  | ((ui32)buf[8] << 8) | (ui32)buf[9];
+        if (Isot >= num_tiles.area() || (Psot != 0 && Psot < 14))
+          return false;
+        tile_part_loc loc = { offset, Isot, false };
+        tile_parts.push_back(loc);
+        if (Psot == 0) // the last tile-part, extending to EOC
+          return true;
+        offset += Psot;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::read_indexed_tile_parts()
+    {
+      for (size_t i = 0; i < tile_parts.size(); ++i)
+      {
+        const tile_part_loc& loc = tile_parts[i];
+        if (tiles[loc.tile].is_outside_region())
+          continue;
+
+        infile->seek((si64)loc.offset, infile_base::OJPH_SEEK_SET);
+        ui8 marker[2];
+        param_sot sot;
+        bool found = infile->read(marker, 2) == 2
+          && marker[0] == 0xFF && marker[1] == 0x90
+          && sot.read(infile, resilient) && sot.get_tile_index() == loc.tile;
+        if (!found)
+        { // a wrong TLM; the SOT chain locates the same tile-parts
+          if (!loc.from_tlm || !index_from_sot(tile_parts[0].offset))
+            OJPH_ERROR(0x00030068, "The tile-part index does not match "
+              "the codestream; tile-part %d of tile %d is not found",
+              (int)i, loc.tile);
+          --i;
+          continue;
+        }
+        read_tile_part(sot);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::set_planar(int planar)
     {
@@ -1109,28 +1543,43 @@ namespace ojph {
       need_tlm = needed;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::request_plt_marker(bool needed)
+    {
+      need_plt = needed;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::flush()
     {
-      si32 repeat = (si32)num_tiles.area();
-      for (si32 i = 0; i < repeat; ++i)
-        tiles[i].prepare_for_flush();
-      if (need_tlm)
-      { //write tlm
-        for (si32 i = 0; i < repeat; ++i)
-          tiles[i].fill_tlm(&tlm);
-        tlm.write(outfile);
-      }
-      for (si32 i = 0; i < repeat; ++i)
-        tiles[i].flush(outfile);
+      ui32 first = tile_rows_written * num_tiles.w;
+      flush_tiles(first, (ui32)num_tiles.area() - first);
       ui16 t = swap_byte(JP2K_MARKER::EOC);
       if (!outfile->write(&t, 2))
         OJPH_ERROR(0x00030071, "Error writing to file");
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::flush_tiles(ui32 first_tile, ui32 count)
+    {
+      tile *t = tiles + first_tile;
+      plts.clear();
+      for (ui32 i = 0; i < count; ++i)
+        t[i].prepare_for_flush();
+      if (need_tlm)
+      { //write tlm; tiles are then all flushed together
+        for (ui32 i = 0; i < count; ++i)
+          t[i].fill_tlm(&tlm);
+        tlm.write(outfile);
+      }
+      for (ui32 i = 0; i < count; ++i)
+        t[i].flush(outfile);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void codestream::close()
     {
+      wait_for_codeblock_jobs();
       if (infile)
         infile->close();
       if (outfile)
@@ -1152,6 +1601,21 @@ namespace ojph {
             if ((success &= tiles[idx].push(line, cur_comp)) == false)
               break;
           }
+          if (success == false && tile_rows_shared)
+          { // every line of this tile row is in; nothing of it is
+            // coded later, so its coded data and its buffers can go
+            flush_tiles(cur_tile_row * num_tiles.w, num_tiles.w);
+            tile_rows_written = cur_tile_row + 1;
+            elastic_alloc->restart();
+            if (tile_rows_written < num_tiles.h)
+            {
+              mem_fixed_allocator::position end = allocator->get_position();
+              allocator->set_position(tile_rows_start);
+              ui32 tps = 0;
+              finalize_tile_row(tile_rows_written, tps);
+              allocator->set_position(end);
+            }
+          }
           cur_tile_row += success == false ? 1 : 0;
           if (cur_tile_row >= num_tiles.h)
             cur_tile_row = 0;
@@ -1191,6 +1655,9 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     line_buf* codestream::pull(ui32 &comp_num)
     {
+      if (use_strips)
+        return pull_from_strip(comp_num);
+
       bool success = false;
       while (!success)
       {
@@ -1201,9 +1668,12 @@ namespace ojph {
           if ((success &= tiles[idx].pull(lines + cur_comp, cur_comp)) == false)
             break;
         }
-        cur_tile_row += success == false ? 1 : 0;
-        if (cur_tile_row >= num_tiles.h)
-          cur_tile_row = 0;
+        if (success == false)
+        {
+          check_cancelled();
+          if (++cur_tile_row >= num_tiles.h)
+            cur_tile_row = 0;
+        }
       }
       comp_num = cur_comp;
 
@@ -1222,7 +1692,15 @@ namespace ojph {
       }
       else //process all component for a line
       {
-        if (++cur_comp >= num_comps)
+        if (paced)
+        { // the next component with a line due in this row, if any
+          ++pacing[cur_comp].pulled;
+          while (cur_comp < num_comps && !is_line_due(cur_comp))
+            ++cur_comp;
+        }
+        else
+          ++cur_comp;
+        if (cur_comp >= num_comps)
         {
           cur_comp = 0;
           if (cur_line++ >= recon_comp_size[cur_comp].h)
@@ -1236,5 +1714,180 @@ namespace ojph {
       return lines + comp_num;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::is_line_due(ui32 comp_num) const
+    {
+      // lines of comp_num that start before the next row of component 0,
+      // and at least one, which the first row of component 0 gets even if
+      // it starts before that line
+      const comp_pacing &p0 = pacing[0], &p = pacing[comp_num];
+      ui64 end = ((ui64)p0.first + cur_line + 1) * p0.step;
+      ui64 due = ojph_max((end + p.step - 1) / p.step - p.first, (ui64)1);
+      return p.pulled < ojph_min(due, (ui64)recon_comp_size[comp_num].h);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile_strip_task::execute()
+    {
+      lines_pulled = 0;
+      try {
+        bool more = true;
+        for (ui32 r = 0; r < max_lines && more; ++r)
+        {
+          for (ui32 c = 0; c < num_comps && more; ++c)
+            more = tile_ptr->pull(strip + c * stride + r, c);
+          lines_pulled += more ? 1 : 0;
+        }
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      if (latch)
+        latch->count_down();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::decode_strip()
+    {
+      ui32 remaining = recon_comp_size[0].h - cur_line;
+      ui32 max_lines = ojph_min(strip_height, remaining);
+      for (ui32 attempts = 0; max_lines > 0; ++attempts)
+      {
+        if (attempts > num_tiles.h)
+          OJPH_ERROR(0x000300E1, "tile rows have fewer lines than the image");
+
+        // tiles 1 and up go to the pool, if tile-parallel; the calling
+        // thread decodes tile 0 and then helps with queued work until
+        // every tile is done
+        task_latch latch(tile_parallel ? num_tiles.w - 1 : 0);
+        for (ui32 i = 0; i < num_tiles.w; ++i)
+        {
+          tile_strip_task &t = strip_tasks[i];
+          t.tile_ptr = tiles + cur_tile_row * num_tiles.w + i;
+          t.strip = strip_lines;
+          t.stride = strip_height;
+          t.num_comps = num_comps;
+          t.max_lines = max_lines;
+          t.latch = i == 0 || !tile_parallel ? NULL : &latch;
+          t.error = NULL;
+          if (i == 0)
+            continue;
+          if (tile_parallel)
+            pool->add_task(&t);
+          else
+            t.execute();
+        }
+        strip_tasks[0].execute();
+        if (tile_parallel)
+          while (!latch.is_done() && pool->run_pending_task()) {}
+        latch.wait();
+
+        for (ui32 i = 0; i < num_tiles.w; ++i)
+          if (strip_tasks[i].error)
+            std::rethrow_exception(strip_tasks[i].error);
+
+        ui32 pulled = strip_tasks[0].lines_pulled;
+        for (ui32 i = 1; i < num_tiles.w; ++i)
+          if (strip_tasks[i].lines_pulled != pulled)
+            OJPH_ERROR(0x000300E2, "tiles in tile row %d produced a different "
+              "number of lines", cur_tile_row);
+
+        if (pulled)
+        {
+          strip_first = cur_line;
+          strip_count = pulled;
+          return;
+        }
+
+        // the current tile row is exhausted; move to the next one
+        if (++cur_tile_row >= num_tiles.h)
+          cur_tile_row = 0;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::request_strips(ui32 max_rows)
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300E7, "Strips can only be requested for a "
+          "codestream being read, after reading its headers.");
+      strips_requested = max_rows > 0 ? max_rows : 32;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 codestream::pull_strip(line_buf *&rows)
+    {
+      rows = NULL;
+      if (!use_strips)
+        OJPH_ERROR(0x000300E8, "pull_strip() needs strips; see "
+          "get_strip_height()");
+      assert(cur_comp == 0);
+      if (cur_line >= recon_comp_size[0].h)
+        return 0;
+      if (cur_line >= strip_first + strip_count)
+        decode_strip();
+
+      // rows that pull() did not take yet, if it was used in this strip
+      ui32 first = cur_line - strip_first;
+      ui32 count = strip_first + strip_count - cur_line;
+      rows = strip_lines + first;
+      cur_line += count;
+      return count;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void codestream::retain_resolutions(ui32 levels)
+    {
+      if (infile == NULL)
+        OJPH_ERROR(0x000300E9, "Resolutions can only be retained for a "
+          "codestream being read, after reading its headers.");
+      retain_requested = levels;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    line_buf* codestream::pull_retained(ui32 level, ui32 comp_num)
+    {
+      if (level == 0 || level > retained_levels || comp_num >= num_comps)
+        OJPH_ERROR(0x000300EA, "pull_retained() needs a level from 1 to "
+          "get_retained_levels() and a valid component");
+      if (!tiles[0].pull_retained(lines + comp_num, comp_num, level))
+        return NULL;
+      return lines + comp_num;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool codestream::pull_subbands(subband_sink *sink)
+    {
+      if (num_tiles.area() != 1)
+        OJPH_ERROR(0x000300ED, "pull_subbands() needs a codestream of one "
+          "tile");
+      return tiles[0].pull_subbands(sink);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    line_buf* codestream::pull_from_strip(ui32 &comp_num)
+    {
+      if (cur_comp == 0 && cur_line >= strip_first + strip_count)
+      {
+        check_cancelled();
+        decode_strip();
+      }
+
+      comp_num = cur_comp;
+      line_buf *line =
+        strip_lines + cur_comp * strip_height + (cur_line - strip_first);
+
+      if (++cur_comp >= num_comps)
+      {
+        cur_comp = 0;
+        if (cur_line++ >= recon_comp_size[cur_comp].h)
+        {
+          comp_num = 0;
+          return NULL;
+        }
+      }
+      return line;
+    }
+
   }
 }
@@ -39,14 +39,20 @@
 #ifndef OJPH_CODESTREAM_LOCAL_H
 #define OJPH_CODESTREAM_LOCAL_H
 
+#include <exception>
+#include <vector>
+
 #include "ojph_defs.h"
 #include "ojph_params_local.h"
+#include "ojph_stats.h"
+#include "ojph_threads.h"
 
 namespace ojph {
 
   ////////////////////////////////////////////////////////////////////////////
   //defined elsewhere
   class line_buf;
+  class subband_sink;
   class mem_fixed_allocator;
   class mem_elastic_allocator;
   class codestream;
@@ -64,6 +70,25 @@ namespace ojph {
     //defined elsewhere
     class tile;
 
+    //////////////////////////////////////////////////////////////////////////
+    // pulls up to max_lines lines of every component of one tile into a strip
+    struct tile_strip_task : public worker_thread_base
+    {
+      tile_strip_task()
+      : tile_ptr(NULL), strip(NULL), stride(0), num_comps(0), max_lines(0),
+        lines_pulled(0), latch(NULL) {}
+      void execute() override;
+
+      tile *tile_ptr;
+      line_buf *strip;       // component c, line r is strip[c * stride + r]
+      ui32 stride;
+      ui32 num_comps;
+      ui32 max_lines;
+      ui32 lines_pulled;
+      task_latch *latch;
+      std::exception_ptr error;
+    };
+
     //////////////////////////////////////////////////////////////////////////
     class codestream
     {
@@ -76,6 +101,7 @@ namespace ojph {
       void restart();
 
       void pre_alloc();
+      void size_allocations();
       void finalize_alloc();
 
       ojph::param_siz access_siz()            // returns externally wrapped siz
@@ -103,15 +129,55 @@ namespace ojph {
                          ui32 num_comments);
       void enable_resilience();
       bool is_resilient() { return resilient; }
+      void enable_header_cache() { cache_headers = true; }
       void read_headers(infile_base *file);
       void restrict_input_resolution(ui32 skipped_res_for_data,
         ui32 skipped_res_for_recon);
+      void restrict_input_region(const rect& region);
+      void restrict_input_components(ui32 mask);
+      bool is_component_selected(ui32 comp_num) const
+      { return comp_num < 32 ? ((component_mask >> comp_num) & 1) != 0
+                             : component_mask == 0xFFFFFFFFu; }
+      void defer_colour_transform();
+      bool is_colour_transform_deferred() const { return colour_deferred; }
+      void request_fixed_point_synthesis();
+      // irreversible component comp_num uses fixed-point lines
+      bool is_fixed_point(ui32 comp_num);
+      void request_cleanup_pass_only();
+      bool is_cleanup_pass_only() { return cleanup_only; }
+      ui32 get_num_incomplete_resolutions();
+      const rect* get_region()              // NULL if decoding everything
+      { return has_region ? &region : NULL; }
+      void set_thread_pool(thread_pool *pool) { this->pool = pool; }
+      thread_pool* get_codeblock_pool()       // pool for codeblock coding
+      { return (infile != NULL || outfile != NULL) && pool != NULL
+          && pool->get_num_threads() > 0 ? pool : NULL; }
+      task_latch* get_codeblock_jobs() { return &codeblock_jobs; }
+      void set_stats(decode_stats *stats) { this->stats = stats; }
+      decode_stats* get_stats() { return stats; }  // NULL if not collected
+      void set_cancel_flag(const std::atomic<bool> *flag) { cancel = flag; }
+      const std::atomic<bool>* get_cancel_flag() { return cancel; }
+      void check_cancelled() const;  // throws once the flag is raised
+      void wait_for_codeblock_jobs();
       void read();
       void set_planar(int planar);
       void set_profile(const char *s);
       void set_tilepart_divisions(ui32 value);
       void request_tlm_marker(bool needed);
+      void request_plt_marker(bool needed);
+      void request_tile_row_output(bool needed) { tile_row_output = needed; }
       line_buf* pull(ui32 &comp_num);
+      void request_strips(ui32 max_rows);
+      ui32 get_strip_height() const { return use_strips ? strip_height : 0; }
+      size_t get_strip_pitch() const { return strip_pitch; }
+      ui32 pull_strip(line_buf *&rows);
+      void retain_resolutions(ui32 levels);
+      ui32 get_retained_levels() const { return retained_levels; }
+      void set_memory_limit(size_t bytes) { memory_limit = bytes; }
+      bool is_memory_limited() const { return memory_limited; }
+      size_t get_memory_use() const;
+      line_buf* pull_retained(ui32 level, ui32 comp_num);
+      bool pull_subbands(subband_sink *sink);
       void flush();
       void close();
 
@@ -119,6 +185,8 @@ namespace ojph {
       si32 get_profile() const { return profile; };
       ui32 get_tilepart_div() const { return tilepart_div; };
       bool is_tlm_needed() const { return need_tlm; };
+      bool is_plt_needed() const { return need_plt; };
+      std::vector<param_plt>* get_plts() { return &plts; }
 
       void check_imf_validity();
       void check_broadcast_validity();
@@ -129,6 +197,22 @@ namespace ojph {
       ui32 get_skipped_res_for_read()
       { return skipped_res_for_read; }
 
+    private:
+      bool is_line_due(ui32 comp_num) const;
+      line_buf* pull_from_strip(ui32 &comp_num);
+      void decode_strip();
+      void flush_tiles(ui32 first_tile, ui32 count);
+      void finalize_tile_row(ui32 row, ui32& num_tileparts);
+      void skip_tile_rows(const mem_fixed_allocator::position& p);
+      void restart_params();
+      bool match_header_cache(infile_base *file);
+      void fill_header_cache(infile_base *file, si64 start);
+      void read_tile_part(const param_sot& sot);
+      bool index_tile_parts();
+      bool index_from_tlm(ui64 offset);
+      bool index_from_sot(ui64 offset);
+      void read_indexed_tile_parts();
+
     private:
       ui32 precinct_scratch_needed_bytes;
       ui8* precinct_scratch;
@@ -139,12 +223,30 @@ namespace ojph {
       ui32 cur_tile_row;
       bool resilient;
       ui32 skipped_res_for_read, skipped_res_for_recon;
+      bool has_region;
+      rect region;
+      ui32 component_mask;  // bit c selects component c for decoding
+      bool defer_colour;    // the reader asked to apply the colour transform
+      bool colour_deferred; // and the first three components are pulled raw
+      bool fixed_point;     // fixed-point synthesis of irreversible samples
+      bool cleanup_only;    // HT codeblocks skip their refinement passes
+
+    private:
+      // when the interleaved lines of a component are due; see pull()
+      struct comp_pacing
+      {
+        ui32 step;           // reference grid rows between its lines
+        ui32 first;          // grid index of its first line, ceil(y0 / step)
+        ui32 pulled;         // lines pulled so far
+      };
 
     private:
       size num_tiles;
       tile *tiles;
       line_buf* lines;
       ui32 num_comps;
+      comp_pacing *pacing;   // one per component
+      bool paced;            // components differ in their number of lines
       size *comp_size;       //stores full resolution no. of lines and width
       size *recon_comp_size; //stores number of lines and width of each comp
       bool employ_color_transform;
@@ -152,6 +254,14 @@ namespace ojph {
       int profile;
       ui32 tilepart_div;     // tilepart division value
       bool need_tlm;         // true if tlm markers are needed
+      bool need_plt;         // true if plt markers are needed
+      std::vector<param_plt> plts; // packet lengths of the tile-parts
+                                   // being written, in codestream order
+      bool tile_row_output;  // tile rows are written once pushed
+      ui32 tile_rows_written; // leading tile rows already in the outfile
+      bool tile_rows_shared; // tile rows take turns on one allocation
+      mem_fixed_allocator::position tile_rows_size;  // its extent
+      mem_fixed_allocator::position tile_rows_start; // where it starts
 
     private:
       param_siz siz;         // image and tile size
@@ -159,12 +269,53 @@ namespace ojph {
       param_cap cap;         // extended capabilities
       param_qcd qcd;         // quantization default
       param_tlm tlm;         // tile-part lengths
+      param_plt plt;         // packet lengths of the current tile-part
       param_nlt nlt;         // non-linearity point transformation
 
     private:  // these are from Part 2 of the standard
       param_dfs dfs;         // downsmapling factor styles
       param_atk atk;         // wavelet structure and coefficients
 
+    private: // tile-part index, to visit only the tiles a region needs
+      struct tile_part_loc
+      {
+        ui64 offset;         // file position of the SOT marker
+        ui16 tile;           // Isot
+        bool from_tlm;       // located through TLM rather than SOT
+      };
+      std::vector<param_tlm::Ttlm_Ptlm_pair> tlm_pairs; // from TLM markers
+      bool tlm_usable;       // false if the TLM segments are inconsistent
+      std::vector<tile_part_loc> tile_parts;
+
+    private: // main header reuse across restart()
+      bool cache_headers;    // keep the parsed main header between frames
+      std::vector<ui8> header_cache; // main header bytes the params hold
+
+    private: // strips, and tile-parallel decoding
+      thread_pool *pool;
+      ui32 strips_requested; // rows asked for by request_strips(), or 0
+      bool use_strips;       // lines are pulled through a strip
+      bool tile_parallel;    // tiles of a tile row are decoded concurrently
+      line_buf *strip_lines; // num_comps * strip_height lines
+      ui32 strip_height;     // number of lines a strip can hold
+      size_t strip_pitch;    // samples between the rows of a component
+      ui32 strip_first;      // first image line held by the strip
+      ui32 strip_count;      // number of lines held by the strip
+      std::vector<tile_strip_task> strip_tasks;
+      task_latch codeblock_jobs; // codeblock decoding jobs still in flight
+
+    private: // lower resolutions kept whole, see retain_resolutions()
+      ui32 retain_requested; // levels asked for, or 0
+      ui32 retained_levels;  // levels kept in this decode
+
+    private: // see set_memory_limit()
+      size_t memory_limit;   // bytes of up-front allocations, or 0
+      bool memory_limited;   // strips and retained levels were given up
+
+    private:
+      decode_stats *stats;   // where stage times are added; may be NULL
+      const std::atomic<bool> *cancel; // stops decoding when raised; or NULL
+
     private:
       mem_fixed_allocator *allocator;
       mem_elastic_allocator *elastic_alloc;
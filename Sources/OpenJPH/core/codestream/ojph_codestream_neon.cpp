@@ -0,0 +1,252 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_codestream_neon.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if defined(OJPH_ENABLE_NEON)
+
+#include <arm_neon.h>
+#include "ojph_defs.h"
+#include "../transform/ojph_transform.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // As with the SSE2 versions, max_val holds one running OR per lane, and
+    // the scalar tail accumulates into the first lane.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 neon_find_max_val32(ui32* address)
+    {
+      uint32x4_t x = vld1q_u32(address);
+      uint32x2_t t = vorr_u32(vget_low_u32(x), vget_high_u32(x));
+      return vget_lane_u32(t, 0) | vget_lane_u32(t, 1);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui64 neon_find_max_val64(ui64* address)
+    {
+      return address[0] | address[1];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 31 - K_max;
+      int32x4_t vshift = vdupq_n_s32((si32)shift);
+      uint32x4_t m0 = vdupq_n_u32(0x80000000U);
+      uint32x4_t tmax = vld1q_u32(max_val);
+      const si32 *p = (const si32*)sp;
+      for (; count >= 4; count -= 4, p += 4, dp += 4)
+      {
+        int32x4_t v = vld1q_s32(p);
+        uint32x4_t val = vreinterpretq_u32_s32(vabsq_s32(v));
+        val = vshlq_u32(val, vshift);
+        vst1q_u32(dp, vorrq_u32(val,
+          vandq_u32(vreinterpretq_u32_s32(v), m0)));
+        tmax = vorrq_u32(tmax, val);
+      }
+      vst1q_u32(max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si32 v = *p++;
+        ui32 sign = v >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(K_max);
+      float32x4_t d = vdupq_n_f32(delta_inv);
+      uint32x4_t m0 = vdupq_n_u32(0x80000000U);
+      uint32x4_t tmax = vld1q_u32(max_val);
+      const float *p = (const float*)sp;
+      for (; count >= 4; count -= 4, p += 4, dp += 4)
+      {
+        // vcvtq_s32_f32 truncates, as ojph_trunc does
+        int32x4_t t = vcvtq_s32_f32(vmulq_f32(vld1q_f32(p), d));
+        uint32x4_t val = vreinterpretq_u32_s32(vabsq_s32(t));
+        vst1q_u32(dp, vorrq_u32(val,
+          vandq_u32(vreinterpretq_u32_s32(t), m0)));
+        tmax = vorrq_u32(tmax, val);
+      }
+      vst1q_u32(max_val, tmax);
+      for (; count > 0; --count)
+      {
+        float v = *p++;
+        si32 t = ojph_trunc(v * delta_inv);
+        ui32 sign = t >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(t >= 0 ? t : -t);
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui64* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 63 - K_max;
+      int64x2_t vshift = vdupq_n_s64((si64)shift);
+      uint64x2_t m0 = vdupq_n_u64(0x8000000000000000ULL);
+      uint64x2_t tmax = vld1q_u64(max_val);
+      const si64 *p = (const si64*)sp;
+      for (; count >= 2; count -= 2, p += 2, dp += 2)
+      {
+        int64x2_t v = vld1q_s64(p);
+        uint64x2_t val = vreinterpretq_u64_s64(vabsq_s64(v));
+        val = vshlq_u64(val, vshift);
+        vst1q_u64(dp, vorrq_u64(val,
+          vandq_u64(vreinterpretq_u64_s64(v), m0)));
+        tmax = vorrq_u64(tmax, val);
+      }
+      vst1q_u64(max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si64 v = *p++;
+        ui64 sign = v >= 0 ? 0ULL : 0x8000000000000000ULL;
+        ui64 val = (ui64)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 63 - K_max;
+      int64x2_t vshift = vdupq_n_s64(-(si64)shift);
+      uint64x2_t m1 = vdupq_n_u64(0x7FFFFFFFFFFFFFFFULL);
+      si64 *p = (si64*)dp;
+      for (; count >= 2; count -= 2, sp += 2, p += 2)
+      {
+        uint64x2_t v = vld1q_u64(sp);
+        int64x2_t val = vreinterpretq_s64_u64(
+          vshlq_u64(vandq_u64(v, m1), vshift));
+        // all ones for negative samples
+        int64x2_t sign = vshrq_n_s64(vreinterpretq_s64_u64(v), 63);
+        val = vsubq_s64(veorq_s64(val, sign), sign);
+        vst1q_s64(p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui64 v = *sp++;
+        si64 val = (v & 0x7FFFFFFFFFFFFFFFULL) >> shift;
+        *p++ = (v & 0x8000000000000000ULL) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_irv_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      uint64x2_t m0 = vdupq_n_u64(0x8000000000000000ULL);
+      uint64x2_t m1 = vdupq_n_u64(0x7FFFFFFFFFFFFFFFULL);
+      float64x2_t d = vdupq_n_f64((double)delta);
+      float *p = (float*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        uint64x2_t v0 = vld1q_u64(sp), v1 = vld1q_u64(sp + 2);
+        float64x2_t val0 = vmulq_f64(vcvtq_f64_u64(vandq_u64(v0, m1)), d);
+        float64x2_t val1 = vmulq_f64(vcvtq_f64_u64(vandq_u64(v1, m1)), d);
+        val0 = vreinterpretq_f64_u64(
+          vorrq_u64(vreinterpretq_u64_f64(val0), vandq_u64(v0, m0)));
+        val1 = vreinterpretq_f64_u64(
+          vorrq_u64(vreinterpretq_u64_f64(val1), vandq_u64(v1, m0)));
+        vst1q_f32(p, vcombine_f32(vcvt_f32_f64(val0), vcvt_f32_f64(val1)));
+      }
+      for (; count > 0; --count)
+      {
+        ui64 v = *sp++;
+        double val = (double)(v & 0x7FFFFFFFFFFFFFFFULL) * (double)delta;
+        *p++ = (float)((v & 0x8000000000000000ULL) ? -val : val);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_fix_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      ui32 mult, shift;
+      fix_dequantizer(delta, mult, shift);
+      uint32x4_t m1 = vdupq_n_u32(0x7FFFFFFFU);
+      uint32x2_t vmult = vdup_n_u32(mult);
+      int64x2_t vshift = vdupq_n_s64(-(si64)shift);
+      si32 *p = (si32*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        uint32x4_t v = vld1q_u32(sp);
+        uint32x4_t m = vandq_u32(v, m1);
+        // rounding shifts, as the generic code rounds
+        uint64x2_t lo = vrshlq_u64(vmull_u32(vget_low_u32(m), vmult), vshift);
+        uint64x2_t hi = vrshlq_u64(vmull_u32(vget_high_u32(m), vmult), vshift);
+        int32x4_t val = vreinterpretq_s32_u32(
+          vcombine_u32(vmovn_u64(lo), vmovn_u64(hi)));
+        // all ones for negative samples
+        int32x4_t sign = vshrq_n_s32(vreinterpretq_s32_u32(v), 31);
+        vst1q_s32(p, vsubq_s32(veorq_s32(val, sign), sign));
+      }
+      const ui64 half = (ui64)1 << (shift - 1);
+      for (; count > 0; --count)
+      {
+        ui32 v = *sp++;
+        si32 val = (si32)(((v & 0x7FFFFFFFU) * (ui64)mult + half) >> shift);
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+  }
+}
+
+#endif // OJPH_ENABLE_NEON
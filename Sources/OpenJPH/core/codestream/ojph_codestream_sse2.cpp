@@ -0,0 +1,249 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_codestream_sse2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_SSE2)
+
+#include <immintrin.h>
+#include "ojph_defs.h"
+
+OJPH_TARGET_BEGIN("sse2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // The tx_to_cb functions keep one running OR per lane in max_val, which
+    // find_max_val combines; samples that do not fill a vector are handled
+    // one at a time, and are accumulated into the first lane.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 sse2_find_max_val32(ui32* address)
+    {
+      __m128i x = _mm_loadu_si128((__m128i*)address);
+      x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+      x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+      return (ui32)_mm_cvtsi128_si32(x);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui64 sse2_find_max_val64(ui64* address)
+    {
+      return address[0] | address[1];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 31 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m128i m0 = _mm_set1_epi32((int)0x80000000);
+      __m128i tmax = _mm_loadu_si128((__m128i*)max_val);
+      const si32 *p = (const si32*)sp;
+      for (; count >= 4; count -= 4, p += 4, dp += 4)
+      {
+        __m128i v = _mm_loadu_si128((__m128i*)p);
+        __m128i sign = _mm_srai_epi32(v, 31);
+        __m128i val = _mm_sub_epi32(_mm_xor_si128(v, sign), sign); // abs
+        val = _mm_sll_epi32(val, vshift);
+        _mm_storeu_si128((__m128i*)dp,
+          _mm_or_si128(val, _mm_and_si128(sign, m0)));
+        tmax = _mm_or_si128(tmax, val);
+      }
+      _mm_storeu_si128((__m128i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si32 v = *p++;
+        ui32 sign = v >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_irv_tx_to_cb32(const void *sp, ui32 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui32* max_val)
+    {
+      ojph_unused(K_max);
+      __m128 d = _mm_set1_ps(delta_inv);
+      __m128i m0 = _mm_set1_epi32((int)0x80000000);
+      __m128i tmax = _mm_loadu_si128((__m128i*)max_val);
+      const float *p = (const float*)sp;
+      for (; count >= 4; count -= 4, p += 4, dp += 4)
+      {
+        __m128i t = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(p), d));
+        __m128i sign = _mm_srai_epi32(t, 31);
+        __m128i val = _mm_sub_epi32(_mm_xor_si128(t, sign), sign); // abs
+        _mm_storeu_si128((__m128i*)dp,
+          _mm_or_si128(val, _mm_and_si128(sign, m0)));
+        tmax = _mm_or_si128(tmax, val);
+      }
+      _mm_storeu_si128((__m128i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        float v = *p++;
+        si32 t = ojph_trunc(v * delta_inv);
+        ui32 sign = t >= 0 ? 0U : 0x80000000U;
+        ui32 val = (ui32)(t >= 0 ? t : -t);
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 31 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m128i m1 = _mm_set1_epi32(0x7FFFFFFF);
+      si32 *p = (si32*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        __m128i v = _mm_loadu_si128((__m128i*)sp);
+        __m128i val = _mm_srl_epi32(_mm_and_si128(v, m1), vshift);
+        __m128i sign = _mm_srai_epi32(v, 31);
+        val = _mm_sub_epi32(_mm_xor_si128(val, sign), sign);
+        _mm_storeu_si128((__m128i*)p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui32 v = *sp++;
+        si32 val = (v & 0x7FFFFFFFU) >> shift;
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_irv_tx_from_cb32(const ui32 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(K_max);
+      __m128i m0 = _mm_set1_epi32((int)0x80000000);
+      __m128i m1 = _mm_set1_epi32(0x7FFFFFFF);
+      __m128 d = _mm_set1_ps(delta);
+      float *p = (float*)dp;
+      for (; count >= 4; count -= 4, sp += 4, p += 4)
+      {
+        __m128i v = _mm_loadu_si128((__m128i*)sp);
+        __m128 val = _mm_cvtepi32_ps(_mm_and_si128(v, m1));
+        val = _mm_mul_ps(val, d);
+        val = _mm_or_ps(val, _mm_castsi128_ps(_mm_and_si128(v, m0)));
+        _mm_storeu_ps(p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui32 v = *sp++;
+        float val = (float)(v & 0x7FFFFFFFU) * delta;
+        *p++ = (v & 0x80000000U) ? -val : val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx_to_cb64(const void *sp, ui64 *dp, ui32 K_max,
+                             float delta_inv, ui32 count, ui64* max_val)
+    {
+      ojph_unused(delta_inv);
+      ui32 shift = 63 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m128i m0 = _mm_set1_epi64x((si64)0x8000000000000000ULL);
+      __m128i tmax = _mm_loadu_si128((__m128i*)max_val);
+      const si64 *p = (const si64*)sp;
+      for (; count >= 2; count -= 2, p += 2, dp += 2)
+      {
+        __m128i v = _mm_loadu_si128((__m128i*)p);
+        __m128i sign = _mm_srai_epi32(v, 31); // SSE2 has no 64-bit srai
+        sign = _mm_shuffle_epi32(sign, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i val = _mm_sub_epi64(_mm_xor_si128(v, sign), sign); // abs
+        val = _mm_sll_epi64(val, vshift);
+        _mm_storeu_si128((__m128i*)dp,
+          _mm_or_si128(val, _mm_and_si128(sign, m0)));
+        tmax = _mm_or_si128(tmax, val);
+      }
+      _mm_storeu_si128((__m128i*)max_val, tmax);
+      for (; count > 0; --count)
+      {
+        si64 v = *p++;
+        ui64 sign = v >= 0 ? 0ULL : 0x8000000000000000ULL;
+        ui64 val = (ui64)(v >= 0 ? v : -v);
+        val <<= shift;
+        *dp++ = sign | val;
+        max_val[0] |= val;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_tx_from_cb64(const ui64 *sp, void *dp, ui32 K_max,
+                               float delta, ui32 count)
+    {
+      ojph_unused(delta);
+      ui32 shift = 63 - K_max;
+      __m128i vshift = _mm_cvtsi32_si128((int)shift);
+      __m128i m1 = _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL);
+      si64 *p = (si64*)dp;
+      for (; count >= 2; count -= 2, sp += 2, p += 2)
+      {
+        __m128i v = _mm_loadu_si128((__m128i*)sp);
+        __m128i val = _mm_srl_epi64(_mm_and_si128(v, m1), vshift);
+        __m128i sign = _mm_srai_epi32(v, 31);
+        sign = _mm_shuffle_epi32(sign, _MM_SHUFFLE(3, 3, 1, 1));
+        val = _mm_sub_epi64(_mm_xor_si128(val, sign), sign);
+        _mm_storeu_si128((__m128i*)p, val);
+      }
+      for (; count > 0; --count)
+      {
+        ui64 v = *sp++;
+        si64 val = (v & 0x7FFFFFFFFFFFFFFFULL) >> shift;
+        *p++ = (v & 0x8000000000000000ULL) ? -val : val;
+      }
+    }
+
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
@@ -353,6 +353,12 @@ namespace ojph {
     return state->get_block_vertical_causality();
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  bool param_cod::is_high_throughput() const
+  {
+    return (state->get_block_style() & local::param_cod::HT_MODE) != 0;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   //
   //
@@ -692,9 +698,6 @@ namespace ojph {
       if (file->read(&Rsiz, 2) != 2)
         OJPH_ERROR(0x00050043, "error reading SIZ marker");
       Rsiz = swap_byte(Rsiz);
-      if ((Rsiz & 0x4000) == 0)
-        OJPH_ERROR(0x00050044,
-          "Rsiz bit 14 is not set (this is not a JPH file)");
       if ((Rsiz & 0x8000) != 0 && (Rsiz & 0xD5F) != 0)
         OJPH_WARN(0x00050001, "Rsiz in SIZ has unimplemented fields");
       if (file->read(&Xsiz, 4) != 4)
@@ -2133,6 +2136,136 @@ namespace ojph {
     //
     //////////////////////////////////////////////////////////////////////////
 
+    //////////////////////////////////////////////////////////////////////////
+    bool param_plt::read(infile_base *file)
+    {
+      ui16 Lplt;
+      if (file->read(&Lplt, 2) != 2)
+        return false;
+      Lplt = swap_byte(Lplt);
+      if (Lplt < 3)
+      { // too short to hold Zplt; nothing can be trusted
+        usable = false;
+        return Lplt == 2;
+      }
+
+      ui8 Zplt;
+      if (file->read(&Zplt, 1) != 1)
+        return false;
+      if (Zplt != next_Zplt) // the lengths must be listed in packet order
+        usable = false;
+      next_Zplt = (ui8)(Zplt + 1);
+
+      // each Iplt is stored 7 bits per byte, most significant first; the
+      // top bit of a byte is set when more bytes of the length follow
+      ui8 buf[256];
+      ui32 left = Lplt - 3u;
+      while (left > 0)
+      {
+        ui32 n = ojph_min(left, (ui32)sizeof(buf));
+        if (file->read(buf, n) != n)
+          return false;
+        for (ui32 i = 0; i < n; ++i)
+        {
+          if (partial >> 25) // more than 32 bits
+            usable = false;
+          partial = (partial << 7) | (buf[i] & 0x7Fu);
+          if ((buf[i] & 0x80) == 0)
+          {
+            lengths.push_back(partial);
+            partial = 0;
+          }
+        }
+        left -= n;
+      }
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // a length is stored 7 bits per byte, and never split across segments,
+    // each of which holds at most 65532 bytes of lengths after Lplt and Zplt
+    static const ui32 max_Iplt_bytes = 65535 - 3;
+
+    //////////////////////////////////////////////////////////////////////////
+    static ui32 get_Iplt_bytes(ui32 length)
+    {
+      ui32 n = 1;
+      while (length >>= 7)
+        ++n;
+      return n;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 param_plt::get_marker_bytes() const
+    {
+      ui32 bytes = 0, room = 0, num_segments = 0;
+      for (size_t i = 0; i < lengths.size(); ++i)
+      {
+        ui32 n = get_Iplt_bytes(lengths[i]);
+        if (n > room)
+        { // a new segment: marker, Lplt and Zplt
+          ++num_segments;
+          bytes += 5;
+          room = max_Iplt_bytes;
+        }
+        room -= n;
+        bytes += n;
+      }
+      // Zplt numbers at most 256 segments; without them, readers parse
+      // the packet headers instead
+      return num_segments <= 256 ? bytes : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool param_plt::write(outfile_base *file) const
+    {
+      if (get_marker_bytes() == 0)
+        return true;
+
+      bool result = true;
+      ui8 Zplt = 0;
+      size_t i = 0;
+      while (i < lengths.size())
+      {
+        // the lengths that fit in this segment
+        size_t end = i;
+        ui32 num_bytes = 0;
+        while (end < lengths.size()
+          && num_bytes + get_Iplt_bytes(lengths[end]) <= max_Iplt_bytes)
+          num_bytes += get_Iplt_bytes(lengths[end++]);
+
+        ui8 buf[256];
+        *(ui16*)buf = swap_byte((ui16)JP2K_MARKER::PLT);
+        *(ui16*)(buf + 2) = swap_byte((ui16)(num_bytes + 3));
+        buf[4] = Zplt++;
+        result &= file->write(buf, 5) == 5;
+
+        ui32 used = 0;
+        for (; i < end; ++i)
+        {
+          if (used + 5 > sizeof(buf))
+          {
+            result &= file->write(buf, used) == used;
+            used = 0;
+          }
+          ui32 n = get_Iplt_bytes(lengths[i]);
+          for (ui32 k = n; k > 0; --k)
+            buf[used++] = (ui8)(((lengths[i] >> (7 * (k - 1))) & 0x7Fu)
+                                | (k > 1 ? 0x80u : 0u));
+        }
+        result &= file->write(buf, used) == used;
+      }
+      return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
     //////////////////////////////////////////////////////////////////////////
     void param_tlm::init(ui32 num_pairs, Ttlm_Ptlm_pair *store)
     {
@@ -2158,6 +2291,44 @@ namespace ojph {
       ++next_pair_index;
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool param_tlm::read(infile_base *file, std::vector<Ttlm_Ptlm_pair>& pairs)
+    {
+      ui8 buf[4];
+      if (file->read(buf, 4) != 4)
+        return false;
+      Ltlm = (ui16)((buf[0] << 8) | buf[1]);
+      bool first = pairs.empty();
+      bool usable = first ? buf[2] == 0 : buf[2] == (ui8)(Ztlm + 1);
+      Ztlm = buf[2];
+      Stlm = buf[3];
+
+      ui32 ST = (Stlm >> 4) & 3;            // bytes of Ttlm; 0, 1, or 2
+      ui32 SP = (Stlm >> 6) & 1 ? 4u : 2u;  // bytes of Ptlm
+      ui32 payload = Ltlm >= 4 ? Ltlm - 4u : 0;
+      if (Ltlm < 4 || ST == 3 || payload % (ST + SP) != 0)
+      {
+        file->seek(payload, infile_base::OJPH_SEEK_CUR);
+        return false;
+      }
+      for (ui32 i = payload / (ST + SP); i > 0; --i)
+      {
+        Ttlm_Ptlm_pair p;
+        p.Ttlm = (ui16)pairs.size(); // one tile-part per tile, in order
+        if (ST && file->read(buf, ST) != ST)
+          return false;
+        if (ST)
+          p.Ttlm = ST == 1 ? buf[0] : (ui16)((buf[0] << 8) | buf[1]);
+        if (file->read(buf, SP) != SP)
+          return false;
+        p.Ptlm = SP == 2 ? (ui32)((buf[0] << 8) | buf[1])
+          : ((ui32)buf[0] << 24) | ((ui32)buf[1] << 16)
+          | ((ui32)buf[2] << 8) | (ui32)buf[3];
+        pairs.push_back(p);
+      }
+      return usable;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool param_tlm::write(outfile_base *file)
     {
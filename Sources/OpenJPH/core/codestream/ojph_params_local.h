@@ -41,6 +41,7 @@
 
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 #include "ojph_defs.h"
 #include "ojph_base.h"
@@ -112,6 +113,7 @@ namespace ojph {
     struct param_cap;
     struct param_sot;
     struct param_tlm;
+    struct param_plt;
     struct param_dfs;
     struct param_atk;
 
@@ -378,7 +380,12 @@ namespace ojph {
 
       ////////////////////////////////////////
       enum BLOCK_CODING_STYLES {
+        BYPASS_MODE = 0x1,      // Part-1 only, from here to SEGMARK_MODE
+        RESET_MODE = 0x2,
+        TERMALL_MODE = 0x4,
         VERT_CAUSAL_MODE = 0x8,
+        PRED_TERM_MODE = 0x10,
+        SEGMARK_MODE = 0x20,
         HT_MODE = 0x40
       };
       ////////////////////////////////////////
@@ -564,6 +571,9 @@ namespace ojph {
       bool get_block_vertical_causality() const
       { return (SPcod.block_style & local::param_cod::VERT_CAUSAL_MODE) != 0; }
 
+      ////////////////////////////////////////
+      ui32 get_block_style() const { return SPcod.block_style; }
+
       ////////////////////////////////////////
       bool write(outfile_base *file);
 
@@ -958,6 +968,9 @@ namespace ojph {
 
       void set_next_pair(ui16 Ttlm, ui32 Ptlm);
       bool write(outfile_base *file);
+      // appends the pairs of one TLM marker segment; false if they cannot
+      // be used
+      bool read(infile_base *file, std::vector<Ttlm_Ptlm_pair>& pairs);
 
     private:
       ui16 Ltlm;
@@ -968,6 +981,43 @@ namespace ojph {
       ui32 next_pair_index;
     };
 
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //
+    //
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    // packet lengths of one tile-part, collected from its PLT marker
+    // segments or from the packets being written; HTJ2K has one quality
+    // layer, so there is one packet per precinct, listed in the order the
+    // packets appear in the codestream
+    struct param_plt
+    {
+    public:
+      param_plt() { restart(); }
+      void restart()
+      { lengths.clear(); partial = 0; next_Zplt = 0; usable = true; }
+
+      bool read(infile_base *file);   // appends one PLT marker segment
+
+      void add_length(ui32 length) { lengths.push_back(length); }
+      ui32 get_marker_bytes() const;  // bytes that write() produces
+      bool write(outfile_base *file) const;
+
+      // NULL if there are no usable lengths for this tile-part
+      const ui32* get_lengths() const
+      { return usable && partial == 0 && !lengths.empty()
+          ? lengths.data() : NULL; }
+      ui32 get_num_lengths() const { return (ui32)lengths.size(); }
+
+    private:
+      std::vector<ui32> lengths;  // Iplt values decoded so far
+      ui32 partial;               // a length whose last byte is not read yet
+      ui8 next_Zplt;              // expected index of the next segment
+      bool usable;                // false if the segments are inconsistent
+    };
+
     ///////////////////////////////////////////////////////////////////////////
     //
     //
@@ -47,6 +47,7 @@
 #include "ojph_codeblock.h" // for coded_cb_header
 #include "ojph_bitbuffer_write.h"
 #include "ojph_bitbuffer_read.h"
+#include "../coding/ojph_block_decoder.h" // for part1_segment_of_pass
 
 
 namespace ojph {
@@ -60,7 +61,10 @@ namespace ojph {
       void init(ui8* buf, ui32 *lev_idx, ui32 num_levels, size s, int init_val)
       {
         for (ui32 i = 0; i <= num_levels; ++i) //on extra level
+        {
           levs[i] = buf + lev_idx[i];
+          widths[i] = (s.w + (1u << i) - 1) >> i;
+        }
         for (ui32 i = num_levels + 1; i < 16; ++i)
           levs[i] = (ui8*)INT_MAX; //make it crash on error
         width = s.w;
@@ -76,13 +80,100 @@ namespace ojph {
 
       ui8* get(ui32 x, ui32 y, ui32 lev)
       {
-        return levs[lev] + (x + y * ((width + (1 << lev) - 1) >> lev));
+        return levs[lev] + (x + y * widths[lev]);
       }
 
       ui32 width, height, num_levels;
       ui8* levs[16]; // you cannot have this high number of levels
+      ui32 widths[16]; // of each level
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // a tag tree of Part-1 packet headers; each node keeps its value, 0xFFFF
+    // until known, and a lower bound on it, from one layer to the next
+    struct part1_tag_tree
+    {
+      static ui32 get_num_nodes(size s)
+      {
+        ui32 num_nodes = s.w * s.h;
+        while (s.w > 1 || s.h > 1)
+        {
+          s.w = (s.w + 1) >> 1;
+          s.h = (s.h + 1) >> 1;
+          num_nodes += s.w * s.h;
+        }
+        return num_nodes;
+      }
+
+      void init(ui16* nodes, size s)
+      {
+        this->nodes = nodes;
+        ui32 offset = 0;
+        num_levels = 0;
+        while (true)
+        {
+          offsets[num_levels] = offset;
+          widths[num_levels++] = s.w;
+          offset += s.w * s.h;
+          if (s.w <= 1 && s.h <= 1)
+            break;
+          s.w = (s.w + 1) >> 1;
+          s.h = (s.h + 1) >> 1;
+        }
+      }
+
+      // reads bits until the value of leaf (x, y) is known to be less than
+      // threshold, or not; returns false if the packet header ended early
+      bool decode(bit_read_buf *bb, ui32 x, ui32 y, ui32 threshold,
+                  bool& below)
+      {
+        ui32 low = 0;
+        ui16* node = NULL;
+        for (ui32 l = num_levels; l > 0; --l)
+        {
+          ui32 lev = l - 1;
+          node = nodes +
+            2 * (offsets[lev] + (x >> lev) + (y >> lev) * widths[lev]);
+          if (low > node[1])
+            node[1] = (ui16)low;
+          else
+            low = node[1];
+          ui32 limit = ojph_min(threshold, (ui32)node[0]);
+          if (low < limit)
+          { // a run of zeros, each raising the bound, ended by a one
+            ui32 zeros;
+            bool one;
+            if (bb_read_zeros(bb, limit - low, zeros, one) == false)
+              return false;
+            low += zeros;
+            if (one)
+              node[0] = (ui16)low;
+          }
+          node[1] = (ui16)low;
+        }
+        below = node[0] < threshold;
+        return true;
+      }
+
+      ui32 get_value(ui32 x, ui32 y) const
+      { return nodes[2 * (x + y * widths[0])]; }
+
+      ui16* nodes;
+      ui32 num_levels;
+      ui32 offsets[20], widths[20]; //more than enough
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    // stops parsing at a corrupt packet; nothing more is read from the
+    // tile-part, and the message is left for the caller to report
+    static inline bool packet_error(ui32 &data_left, const char *&error,
+                                    const char *message)
+    {
+      data_left = 0;
+      error = message;
+      return false;
+    }
+
     //////////////////////////////////////////////////////////////////////////
     static inline ui32 log2ceil(ui32 x)
     {
@@ -274,7 +365,8 @@ namespace ojph {
         ph_bytes += cur_coded_list->buf_size - cur_coded_list->avail_size;
       }
 
-      return coded ? cb_bytes + ph_bytes : 1; // 1 for empty packet
+      num_bytes = coded ? cb_bytes + ph_bytes : 1; // 1 for empty packet
+      return num_bytes;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -325,16 +417,42 @@ namespace ojph {
 
 
     //////////////////////////////////////////////////////////////////////////
-    void precinct::parse(int tag_tree_size, ui32* lev_idx,
-                         mem_elastic_allocator *elastic,
+    bool precinct::is_needed() const
+    {
+      // true if any codeblock of the precinct contributes to the decoding
+      // region; without a region, every codeblock does
+      for (int s = 0; s < 4; ++s)
+      {
+        if (bands[s].empty)
+          continue;
+        const rect& cbs = cb_idxs[s];
+        const rect& needed = bands[s].needed_cbs;
+        if (cbs.org.x < needed.org.x + needed.siz.w &&
+            needed.org.x < cbs.org.x + cbs.siz.w &&
+            cbs.org.y < needed.org.y + needed.siz.h &&
+            needed.org.y < cbs.org.y + cbs.siz.h)
+          return true;
+      }
+      return false;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // returns true when the whole packet, header and body, was read
+    bool precinct::parse(int tag_tree_size, ui32* lev_idx,
+                         mem_elastic_allocator *elastic, ui32 layer,
                          ui32 &data_left, infile_base *file,
-                         bool skipped)
+                         bool skipped, const char *&error)
     {
       assert(data_left > 0);
+      if ((block_style & param_cod::HT_MODE) == 0)
+        return parse_part1(elastic, layer, data_left, file, skipped, error);
+
       bit_read_buf bb;
       bb_init(&bb, data_left, file);
       if (may_use_sop)
         bb_skip_sop(&bb);
+      if (bb.error)
+        return packet_error(data_left, error, bb.error);
 
       bool empty_packet = true;
       for (int s = 0; s < 4; ++s)
@@ -350,7 +468,13 @@ namespace ojph {
           ui32 bit;
           bb_read_bit(&bb, bit);
           if (bit == 0) //empty packet
-          { bb_terminate(&bb, uses_eph); data_left = bb.bytes_left; return; }
+          {
+            bb_terminate(&bb, uses_eph);
+            if (bb.error)
+              return packet_error(data_left, error, bb.error);
+            data_left = bb.bytes_left;
+            return true;
+          }
           empty_packet = false;
         }
 
@@ -394,7 +518,8 @@ namespace ojph {
               {
                 ui32 bit;
                 if (bb_read_bit(&bb, bit) == false)
-                { data_left = 0; throw "error reading from file p1"; }
+                return packet_error(data_left, error,
+                  "error reading from file p1");
                 empty_cb = (bit == 0);
                 *inc_tag.get(x>>cur_lev, y>>cur_lev, cur_lev) = (ui8)(1 - bit);
                 *inc_tag_flags.get(x>>cur_lev, y>>cur_lev, cur_lev) = 1;
@@ -415,47 +540,52 @@ namespace ojph {
               //check received
               if (*mmsb_tag_flags.get(x>>cur_lev, y>>cur_lev, cur_lev) == 0)
               {
-                ui32 bit = 0;
-                while (bit == 0)
-                {
-                  if (bb_read_bit(&bb, bit) == false)
-                  { data_left = 0; throw "error reading from file p2"; }
-                  mmsbs += 1 - bit;
-                }
+                ui32 zeros;
+                bool one;
+                if (bb_read_zeros(&bb, 0xFFFFFFFFu, zeros, one) == false)
+                return packet_error(data_left, error,
+                  "error reading from file p2");
+                mmsbs += zeros;
                 *mmsb_tag.get(x>>cur_lev, y>>cur_lev, cur_lev) = (ui8)mmsbs;
                 *mmsb_tag_flags.get(x>>cur_lev, y>>cur_lev, cur_lev) = 1;
               }
             }
 
             if (mmsbs > cp->Kmax)
-              throw "error in parsing a tile header; "
-              "missing msbs are larger or equal to Kmax. The most likely "
-              "cause is a corruption in the bitstream.";
+              return packet_error(data_left, error,
+                "error in parsing a tile header; "
+                "missing msbs are larger or equal to Kmax. The most likely "
+                "cause is a corruption in the bitstream.");
             cp->missing_msbs = mmsbs;
 
             //get number of passes
             ui32 bit, num_passes = 1;
             if (bb_read_bit(&bb, bit) == false)
-            { data_left = 0; throw "error reading from file p3"; }
+            return packet_error(data_left, error,
+              "error reading from file p3");
             if (bit)
             {
               num_passes = 2;
               if (bb_read_bit(&bb, bit) == false)
-              { data_left = 0; throw "error reading from file p4"; }
+              return packet_error(data_left, error,
+                "error reading from file p4");
               if (bit)
               {
                 if (bb_read_bits(&bb, 2, bit) == false)
-                { data_left = 0; throw "error reading from file p5";  }
+                return packet_error(data_left, error,
+                  "error reading from file p5");
                 num_passes = 3 + bit;
                 if (bit == 3)
                 {
                   if (bb_read_bits(&bb, 5, bit) == false)
-                  { data_left = 0; throw "error reading from file p6"; }
+                  return packet_error(data_left, error,
+                    "error reading from file p6");
                   num_passes = 6 + bit;
                   if (bit == 31)
                   {
                     if (bb_read_bits(&bb, 7, bit) == false)
-                    { data_left = 0; throw "error reading from file p7"; }
+                    return packet_error(data_left, error,
+                      "error reading from file p7");
                     num_passes = 37 + bit;
                   }
                 }
@@ -479,26 +609,29 @@ namespace ojph {
             cp->num_passes = num_passes - num_phld_passes;
             cp->pass_length[0] = cp->pass_length[1] = 0;
 
-            int Lblock = 3;
-            bit = 1;
-            while (bit)
-            {
-              // add any extra bits here
-              if (bb_read_bit(&bb, bit) == false)
-              { data_left = 0; throw "error reading from file p8"; }
-              Lblock += bit;
-            }
+            ui32 extra_bits;
+            if (bb_read_ones(&bb, extra_bits) == false)
+            return packet_error(data_left, error,
+              "error reading from file p8");
+            int Lblock = 3 + (int)ojph_min(extra_bits, 32u);
 
             int bits = Lblock + 31 -
               (int)count_leading_zeros(num_phld_passes + 1);
+            if (bits > 32)
+              return packet_error(data_left, error,
+                "error in parsing a tile header; the length "
+                "indicator of a codeblock is too large");
             if (bb_read_bits(&bb, bits, bit) == false)
-            { data_left = 0; throw "error reading from file p9"; }
+            return packet_error(data_left, error,
+              "error reading from file p9");
             if (bit < 2)
-              throw "The cleanup segment of an HT codeblock cannot contain "
-                "less than 2 bytes";
+              return packet_error(data_left, error,
+                "The cleanup segment of an HT codeblock cannot contain "
+                "less than 2 bytes");
             if (bit >= 65535)
-              throw "The cleanup segment of an HT codeblock must contain "
-                "less than 65535 bytes";
+              return packet_error(data_left, error,
+                "The cleanup segment of an HT codeblock must contain "
+                "less than 65535 bytes");
             cp->pass_length[0] = bit;
 
             if (cp->num_passes > 1)
@@ -506,11 +639,17 @@ namespace ojph {
               //bits = Lblock + 31 - count_leading_zeros(cp->num_passes - 1);
               // The following is simpler than the above, I think?
               bits = Lblock + (cp->num_passes > 2 ? 1 : 0);
+              if (bits > 32)
+                return packet_error(data_left, error,
+                  "error in parsing a tile header; the length "
+                  "indicator of a codeblock is too large");
               if (bb_read_bits(&bb, bits, bit) == false)
-              { data_left = 0; throw "error reading from file p10"; }
+              return packet_error(data_left, error,
+                "error reading from file p10");
               if (bit >= 2047)
-                throw "The refinement segment (SigProp and MagRep passes) of "
-                  "an HT codeblock must contain less than 2047 bytes";
+                return packet_error(data_left, error,
+                  "The refinement segment (SigProp and MagRep passes) of "
+                  "an HT codeblock must contain less than 2047 bytes");
               cp->pass_length[1] = bit;
             }
           }
@@ -523,7 +662,10 @@ namespace ojph {
         //assert(bit == 0);
       }
       bb_terminate(&bb, uses_eph);
+      if (bb.error)
+        return packet_error(data_left, error, bb.error);
       //read codeblock data
+      bool complete = true;
       for (int s = 0; s < 4; ++s)
       {
         if (bands[s].empty)
@@ -551,26 +693,308 @@ namespace ojph {
                   ui32 bytes_read = (ui32)(file->tell() - cur_loc);
                   cp->pass_length[0] = cp->pass_length[1] = 0;
                   bb.bytes_left -= bytes_read;
-                  assert(bytes_read == t || bb.bytes_left == 0);
+                  if (bytes_read != t)
+                    data_left = 0; // the file ended early
+                  complete = complete && bytes_read == num_bytes;
                 }
                 else
                 {
+                  if (num_bytes > bb.bytes_left)
+                    complete = false;
                   if (!bb_read_chunk(&bb, num_bytes, cp->next_coded, elastic))
                   {
                     //no need to decode a broken codeblock
                     cp->pass_length[0] = cp->pass_length[1] = 0;
                     data_left = 0;
+                    complete = false;
                   }
                 }
               }
             }
             else
+            {
+              complete = complete && num_bytes == 0;
               cp->pass_length[0] = cp->pass_length[1] = 0;
+            }
+          }
+        }
+      }
+      data_left = bb.bytes_left;
+      return complete;
+    }
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // parses a packet of JPEG 2000 Part-1 codeblocks; unlike HT ones, they
+    // can contribute passes to any number of quality layers, so tag tree
+    // states and the passes of each codeblock are kept between packets
+    bool precinct::parse_part1(mem_elastic_allocator *elastic, ui32 layer,
+                               ui32 &data_left, infile_base *file,
+                               bool skipped, const char *&error)
+    {
+      if (stepped_over)
+        return packet_error(data_left, error,
+          "a packet of a Part-1 precinct was stepped over using PLT "
+          "lengths; the packets that follow it cannot be parsed");
+
+      if (tag_trees == NULL)
+      { // the first packet of this precinct
+        ui32 num_nodes = 0;
+        for (int s = 0; s < 4; ++s)
+          if (!bands[s].empty)
+            num_nodes += part1_tag_tree::get_num_nodes(cb_idxs[s].siz);
+        coded_lists *list;
+        elastic->get_buffer(num_nodes * 4 * (ui32)sizeof(ui16) + 1, list);
+        ui8 *p = list->buf + ((size_t)list->buf & 1);
+        tag_trees = (ui16*)p;
+        for (ui32 i = 0; i < num_nodes * 4; i += 2)
+        { tag_trees[i] = 0xFFFF; tag_trees[i + 1] = 0; }
+      }
+      part1_tag_tree inc_tags[4], mmsb_tags[4];
+      ui16 *nodes = tag_trees;
+      for (int s = 0; s < 4; ++s)
+        if (!bands[s].empty)
+        {
+          ui32 num_nodes = part1_tag_tree::get_num_nodes(cb_idxs[s].siz);
+          inc_tags[s].init(nodes, cb_idxs[s].siz);
+          mmsb_tags[s].init(nodes + 2 * num_nodes, cb_idxs[s].siz);
+          nodes += 4 * num_nodes;
+        }
+
+      // a bound on the bytes of a codeblock, to catch corrupt lengths
+      const ui32 max_cb_bytes = 1u << 24;
+
+      bit_read_buf bb;
+      bb_init(&bb, data_left, file);
+      if (may_use_sop)
+        bb_skip_sop(&bb);
+      if (bb.error)
+        return packet_error(data_left, error, bb.error);
+
+      bool empty_packet = true;
+      for (int s = 0; s < 4; ++s)
+      {
+        if (bands[s].empty)
+          continue;
+
+        if (cb_idxs[s].siz.w == 0 || cb_idxs[s].siz.h == 0)
+          continue;
+
+        if (empty_packet) //one bit to check if the packet is empty
+        {
+          ui32 bit;
+          bb_read_bit(&bb, bit);
+          if (bit == 0) //empty packet
+          {
+            bb_terminate(&bb, uses_eph);
+            if (bb.error)
+              return packet_error(data_left, error, bb.error);
+            data_left = bb.bytes_left;
+            return true;
+          }
+          empty_packet = false;
+        }
+
+        ui32 band_width = bands[s].num_blocks.w;
+        ui32 width = cb_idxs[s].siz.w;
+        ui32 height = cb_idxs[s].siz.h;
+        for (ui32 y = 0; y < height; ++y)
+        {
+          coded_cb_header *cp = bands[s].coded_cbs;
+          cp += cb_idxs[s].org.x + (y + cb_idxs[s].org.y) * band_width;
+          for (ui32 x = 0; x < width; ++x, ++cp)
+          {
+            cp->pass_length[1] = 0;
+
+            //process inclusion
+            bool included;
+            if (cp->num_passes == 0)
+            {
+              if (!inc_tags[s].decode(&bb, x, y, layer + 1, included))
+              return packet_error(data_left, error,
+                "error reading from file p11");
+            }
+            else
+            {
+              ui32 bit;
+              if (bb_read_bit(&bb, bit) == false)
+              return packet_error(data_left, error,
+                "error reading from file p12");
+              included = (bit == 1);
+            }
+            if (!included)
+              continue;
+
+            if (cp->num_passes == 0)
+            { // first inclusion, process missing msbs
+              bool known = false;
+              for (ui32 t = 1; !known; ++t)
+              {
+                if (t > cp->Kmax)
+                  return packet_error(data_left, error,
+                    "error in parsing a tile header; "
+                    "missing msbs are larger or equal to Kmax. The most "
+                    "likely cause is a corruption in the bitstream.");
+                if (!mmsb_tags[s].decode(&bb, x, y, t, known))
+                return packet_error(data_left, error,
+                  "error reading from file p13");
+              }
+              cp->missing_msbs = mmsb_tags[s].get_value(x, y);
+              cp->Lblock = 3;
+
+              ui32 max_passes = 3 * (cp->Kmax - cp->missing_msbs) - 2;
+              ui32 num_segs =
+                part1_segment_of_pass(max_passes - 1, block_style) + 1;
+              coded_lists *list;
+              elastic->get_buffer(num_segs * (ui32)sizeof(ui32) + 3, list);
+              ui8 *p = list->buf + ((0 - (size_t)list->buf) & 3);
+              cp->seg_lengths = (ui32*)p;
+              memset(cp->seg_lengths, 0, num_segs * sizeof(ui32));
+            }
+
+            //get number of passes
+            ui32 bit, num_passes = 1;
+            if (bb_read_bit(&bb, bit) == false)
+            return packet_error(data_left, error,
+              "error reading from file p3");
+            if (bit)
+            {
+              num_passes = 2;
+              if (bb_read_bit(&bb, bit) == false)
+              return packet_error(data_left, error,
+                "error reading from file p4");
+              if (bit)
+              {
+                if (bb_read_bits(&bb, 2, bit) == false)
+                return packet_error(data_left, error,
+                  "error reading from file p5");
+                num_passes = 3 + bit;
+                if (bit == 3)
+                {
+                  if (bb_read_bits(&bb, 5, bit) == false)
+                  return packet_error(data_left, error,
+                    "error reading from file p6");
+                  num_passes = 6 + bit;
+                  if (bit == 31)
+                  {
+                    if (bb_read_bits(&bb, 7, bit) == false)
+                    return packet_error(data_left, error,
+                      "error reading from file p7");
+                    num_passes = 37 + bit;
+                  }
+                }
+              }
+            }
+            ui32 first = cp->num_passes, end = first + num_passes;
+            if (end > 3 * (cp->Kmax - cp->missing_msbs) - 2)
+              return packet_error(data_left, error,
+                "error in parsing a tile header; a codeblock has more "
+                "coding passes than its bitplanes allow");
+
+            ui32 extra_bits;
+            if (bb_read_ones(&bb, extra_bits) == false)
+            return packet_error(data_left, error,
+              "error reading from file p8");
+            if (extra_bits > 32 - cp->Lblock)
+              return packet_error(data_left, error,
+                "error in parsing a tile header; the length "
+                "indicator of a codeblock is too large");
+            cp->Lblock += extra_bits;
+
+            // one length for the passes of each codeword segment
+            while (first < end)
+            {
+              ui32 seg = part1_segment_of_pass(first, block_style);
+              ui32 last = first + 1;
+              while (last < end &&
+                     part1_segment_of_pass(last, block_style) == seg)
+                ++last;
+              int bits = (int)cp->Lblock + 31 -
+                (int)count_leading_zeros(last - first);
+              if (bits > 32)
+                return packet_error(data_left, error,
+                  "error in parsing a tile header; the length "
+                  "indicator of a codeblock is too large");
+              ui32 length;
+              if (bb_read_bits(&bb, bits, length) == false)
+              return packet_error(data_left, error,
+                "error reading from file p9");
+              if (length > max_cb_bytes - cp->pass_length[0]
+                           - cp->pass_length[1])
+                return packet_error(data_left, error,
+                  "error in parsing a tile header; a codeblock "
+                  "holds too many bytes");
+              cp->seg_lengths[seg] += length;
+              cp->pass_length[1] += length;
+              first = last;
+            }
+            cp->num_passes = end;
+          }
+        }
+      }
+      if (empty_packet)
+      { // all subbands are empty
+        ui32 bit = 0;
+        bb_read_bit(&bb, bit);
+      }
+      bb_terminate(&bb, uses_eph);
+      if (bb.error)
+        return packet_error(data_left, error, bb.error);
+      //read codeblock data, appending it to the data of earlier layers
+      bool complete = true;
+      for (int s = 0; s < 4; ++s)
+      {
+        if (bands[s].empty)
+          continue;
+
+        ui32 band_width = bands[s].num_blocks.w;
+        ui32 width = cb_idxs[s].siz.w;
+        ui32 height = cb_idxs[s].siz.h;
+        for (ui32 y = 0; y < height; ++y)
+        {
+          coded_cb_header *cp = bands[s].coded_cbs;
+          cp += cb_idxs[s].org.x + (y + cb_idxs[s].org.y) * band_width;
+          for (ui32 x = 0; x < width; ++x, ++cp)
+          {
+            ui32 num_bytes = cp->pass_length[1];
+            cp->pass_length[1] = 0;
+            if (num_bytes == 0)
+              continue;
+            if (data_left == 0)
+              complete = false;
+            else if (skipped)
+            { //no need to read
+              si64 cur_loc = file->tell();
+              ui32 t = ojph_min(num_bytes, bb.bytes_left);
+              file->seek(t, infile_base::OJPH_SEEK_CUR);
+              ui32 bytes_read = (ui32)(file->tell() - cur_loc);
+              bb.bytes_left -= bytes_read;
+              if (bytes_read != t)
+                data_left = 0; // the file ended early
+              complete = complete && bytes_read == num_bytes;
+            }
+            else
+            {
+              coded_lists **tail = &cp->next_coded;
+              while (*tail != NULL)
+                tail = &(*tail)->next_list;
+              ui32 bytes_left = bb.bytes_left;
+              if (num_bytes > bb.bytes_left)
+                complete = false;
+              if (!bb_read_chunk(&bb, num_bytes, *tail, elastic))
+              {
+                data_left = 0;
+                complete = false;
+              }
+              // only the bytes received are decoded
+              cp->pass_length[0] += bytes_left - bb.bytes_left;
+            }
           }
         }
       }
       data_left = bb.bytes_left;
+      return complete;
     }
 
   }
-}
\ No newline at end of file
+}
@@ -54,19 +54,49 @@ namespace ojph {
     //defined here
     class subband;
     
+    //////////////////////////////////////////////////////////////////////////
+    // walks the packet lengths of a tile-part, as read from its PLT marker
+    // segments, alongside precinct parsing
+    struct packet_index
+    {
+      packet_index() { lengths = NULL; num_lengths = next = 0; error = NULL; }
+      void init(const ui32* lengths, ui32 num_lengths)
+      {
+        this->lengths = lengths; this->num_lengths = num_lengths;
+        next = 0; error = NULL;
+      }
+      ui32 take()          // length of the next packet, or 0 if unknown
+      { return next < num_lengths ? lengths[next++] : 0; }
+      void invalidate() { num_lengths = next; }
+
+      const ui32* lengths;
+      ui32 num_lengths, next;
+      const char *error;   // why parsing stopped, NULL unless corrupt
+    };
+
     //////////////////////////////////////////////////////////////////////////
     struct precinct
     {
       precinct() {
         scratch = NULL; bands = NULL; coded = NULL;
-        may_use_sop = uses_eph = false;
+        may_use_sop = uses_eph = false; num_bytes = 0;
+        block_style = 0; tag_trees = NULL; stepped_over = false;
       }
       ui32 prepare_precinct(int tag_tree_size, ui32* lev_idx,
                             mem_elastic_allocator *elastic);
       void write(outfile_base *file);
-      void parse(int tag_tree_size, ui32* lev_idx,
-                 mem_elastic_allocator *elastic,
-                 ui32& data_left, infile_base *file, bool skipped);
+      bool parse(int tag_tree_size, ui32* lev_idx,
+                 mem_elastic_allocator *elastic, ui32 layer,
+                 ui32& data_left, infile_base *file, bool skipped,
+                 const char *&error);
+      bool is_needed() const;
+
+    private:
+      bool parse_part1(mem_elastic_allocator *elastic, ui32 layer,
+                       ui32& data_left, infile_base *file, bool skipped,
+                       const char *&error);
+
+    public:
 
       ui8 *scratch;
       point img_point; //the precinct projected to full resolution
@@ -74,6 +104,10 @@ namespace ojph {
       subband *bands;  //the subbands
       coded_lists* coded;
       bool may_use_sop, uses_eph;
+      ui32 num_bytes;  //packet length, set by prepare_precinct
+      ui32 block_style; //codeblock style of COD/COC
+      ui16 *tag_trees; //Part-1 tag tree states, kept from layer to layer
+      bool stepped_over; //a packet was skipped without parsing its header
     };
 
   }
@@ -42,6 +42,7 @@
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_resolution.h"
 #include "ojph_tile_comp.h"
@@ -209,9 +210,10 @@ namespace ojph {
         ui32 precision = qp->propose_precision(cdp);
         const param_atk* atk = cdp->access_atk();
         bool reversible = atk->is_reversible();
+        bool fixed_point = codestream->is_fixed_point(comp_num);
 
         ui32 width = res_rect.siz.w + 1;
-        if (reversible)
+        if (reversible || fixed_point)
         {
           if (precision <= 32) {
             for (ui32 i = 0; i < num_steps; ++i)
@@ -233,7 +235,53 @@ namespace ojph {
           allocator->pre_alloc_data<float>(width, 1);
           allocator->pre_alloc_data<float>(width, 1);
         }
+
+        if (retained_depth(codestream, comp_num, res_num) > 0)
+        {
+          size_t samples = (size_t)res_rect.siz.w * res_rect.siz.h;
+          if (!reversible && !fixed_point)
+            allocator->pre_alloc_data<float>(samples, 0);
+          else if (precision <= 32)
+            allocator->pre_alloc_data<si32>(samples, 0);
+          else
+            allocator->pre_alloc_data<si64>(samples, 0);
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 resolution::retained_depth(codestream *codestream, ui32 comp_num,
+                                    ui32 res_num)
+    {
+      // how far below the reconstructed resolution this one is, if its
+      // lines are kept for codestream::pull_retained(); 0 otherwise
+      ui32 num_decomps =
+        codestream->get_coc(comp_num)->get_num_decompositions();
+      ui32 skipped = codestream->get_skipped_res_for_recon();
+      if (skipped > num_decomps || res_num + skipped >= num_decomps)
+        return 0;
+      ui32 depth = num_decomps - skipped - res_num;
+      return depth <= codestream->get_retained_levels() ? depth : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Zero spans; lines pulled from subbands carry the span of their
+    // non-zero codeblocks, and the synthesis below keeps those spans up to
+    // date, so that lines, or parts of lines, known to be zero are not
+    // transformed.  This holds only for lifting steps that map zero to
+    // zero, which all irreversible ones do; a reversible step does unless
+    // its rounding offset, Batk >> Eatk, is non-zero.
+    static bool lifting_keeps_zeros(const param_atk* atk)
+    {
+      if (!atk->is_reversible())
+        return true;
+      for (ui32 i = 0; i < atk->get_num_steps(); ++i)
+      {
+        const lifting_step* s = atk->get_step(i);
+        if ((s->rev.Batk >> s->rev.Eatk) != 0)
+          return false;
       }
+      return true;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -433,6 +481,7 @@ namespace ojph {
           pp->bands = bands;
           pp->may_use_sop = cdp->packets_may_use_sop();
           pp->uses_eph = cdp->packets_use_eph();
+          pp->block_style = cdp->get_block_style();
           pp->scratch = codestream->get_precinct_scratch();
           pp->coded = NULL;
         }
@@ -457,13 +506,19 @@ namespace ojph {
       for (ui32 i = 1; i <= max_num_levels; ++i, val >>= 2)
         level_index[i] = level_index[i - 1] + val;
       cur_precinct_loc = point(0, 0);
+      num_complete_packets = 0;
+      num_layers = (ui32)codestream->access_cod().get_num_layers();
+      cur_layer = 0;
+      stats = codestream->get_stats();
 
       //allocate lines
       if (skipped_res_for_recon == false)
       {
         this->atk = cdp->access_atk();
         this->reversible = atk->is_reversible();
+        this->fixed_point = codestream->is_fixed_point(comp_num);
         this->num_steps = atk->get_num_steps();
+        this->keeps_zeros = lifting_keeps_zeros(atk);
         // create line buffers and lifting_bufs
         lines = allocator->post_alloc_obj<line_buf>(num_steps + 2);
         ssp = allocator->post_alloc_obj<lifting_buf>(num_steps + 2);
@@ -485,7 +540,7 @@ namespace ojph {
 
         // initiate storage of line_buf
         ui32 width = res_rect.siz.w + 1;
-        if (this->reversible)
+        if (this->reversible || this->fixed_point)
         {
           if (precision <= 32)
           {
@@ -523,7 +578,27 @@ namespace ojph {
         rows_to_produce = res_rect.siz.h;
         vert_even = (res_rect.org.y & 1) == 0;
         horz_even = (res_rect.org.x & 1) == 0;
+
+        retained = NULL;
+        retained_rows = 0;
+        if (retained_depth(codestream, comp_num, res_num) > 0)
+        {
+          size_t samples = (size_t)res_rect.siz.w * res_rect.siz.h;
+          if (!this->reversible && !this->fixed_point)
+            retained_line.wrap(
+              allocator->post_alloc_data<float>(samples, 0), samples, 0);
+          else if (precision <= 32)
+            retained_line.wrap(
+              allocator->post_alloc_data<si32>(samples, 0), samples, 0);
+          else
+            retained_line.wrap(
+              allocator->post_alloc_data<si64>(samples, 0), samples, 0);
+          retained = retained_line.p;
+          retained_line.size = res_rect.siz.w;
+        }
       }
+      else
+        retained = NULL;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -709,8 +784,186 @@ namespace ojph {
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    // Finds the samples of a subband, [b0, b1), needed to synthesize the
+    // samples [r0, r1) of its resolution; the subband sample k sits at
+    // 2k + odd, and each synthesized sample depends on the samples within
+    // `margin` of it
+    static void needed_band_range(ui32 r0, ui32 r1, ui32 odd, ui32 margin,
+                                  ui32& b0, ui32& b1)
+    {
+      ui32 t = r0 > margin + odd ? r0 - margin - odd : 0;
+      b0 = (t + 1) >> 1;
+      b1 = (r1 + margin - odd + 1) >> 1;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::restrict_region(const rect& region)
+    {
+      if (skipped_res_for_recon)
+      { // region is in the coordinates of the reconstructed resolution
+        child_res->restrict_region(region);
+        return;
+      }
+
+      if (region.siz.w == 0 || region.siz.h == 0)
+      { // nothing is needed from this resolution
+        if (child_res)
+          child_res->restrict_region(region);
+        for (int i = 0; i < 4; ++i)
+          bands[i].restrict_region(region);
+        return;
+      }
+
+      // each lifting step reaches one sample further on each side
+      ui32 margin = num_steps + 1;
+      ui32 rx0 = region.org.x, rx1 = region.org.x + region.siz.w;
+      ui32 ry0 = region.org.y, ry1 = region.org.y + region.siz.h;
+      for (ui32 i = 0; i < 4; ++i)
+      {
+        ui32 bx0 = rx0, bx1 = rx1, by0 = ry0, by1 = ry1;
+        if (transform_flags & HORZ_TRX)
+          needed_band_range(rx0, rx1, i & 1, margin, bx0, bx1);
+        if (transform_flags & VERT_TRX)
+          needed_band_range(ry0, ry1, i >> 1, margin, by0, by1);
+        rect r;
+        r.org = point(bx0, by0);
+        r.siz.w = bx1 - bx0;
+        r.siz.h = by1 - by0;
+        if (i == 0 && child_res)
+          child_res->restrict_region(r);
+        else
+          bands[i].restrict_region(r);
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     line_buf* resolution::pull_line()
+    {
+      line_buf *line = synthesize_line();
+      if (retained != NULL && line != NULL && retained_rows < res_rect.siz.h)
+      { // kept before the parent resolution transforms it in place
+        size_t bytes = line->flags & line_buf::LFT_SIZE_MASK;
+        assert(bytes == (retained_line.flags & line_buf::LFT_SIZE_MASK));
+        bytes *= res_rect.siz.w;
+        memcpy((ui8*)retained + bytes * retained_rows++, line->p, bytes);
+      }
+      return line;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool resolution::pull_subbands(subband_sink *sink)
+    {
+      // lower resolutions go first, as those above are synthesized from them
+      if (child_res != NULL && !child_res->pull_subbands(sink))
+        return false;
+      if (skipped_res_for_recon)
+        return true;
+      if (res_num > 0 && (transform_flags != (HORZ_TRX | VERT_TRX)
+                          || atk->get_index() > 1))
+        OJPH_ERROR(0x000300EE, "pull_subbands() needs the wavelets of "
+          "Part 1, with every level decomposed both ways");
+
+      for (ui32 b = res_num == 0 ? 0 : 1; b < (res_num == 0 ? 1u : 4u); ++b)
+      {
+        if (!bands[b].exists())
+          continue;
+        const rect& band_rect = bands[b].get_band_rect();
+        sink->begin_band(comp_num, res_num, b, res_rect, band_rect);
+        for (ui32 y = 0; y < band_rect.siz.h; ++y)
+          if (!sink->push_line(bands[b].pull_line()))
+            return false;
+      }
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    line_buf* resolution::get_retained_line(ui32 row)
+    {
+      if (retained == NULL || row >= retained_rows)
+        return NULL;
+      size_t bytes = retained_line.flags & line_buf::LFT_SIZE_MASK;
+      retained_line.p = (ui8*)retained + bytes * res_rect.siz.w * row;
+      return &retained_line;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void copy_line(line_buf* dst, const line_buf* src, ui32 width)
+    {
+      memcpy(dst->p, src->p,
+        (size_t)width * (dst->flags & line_buf::LFT_SIZE_MASK));
+      dst->span_begin = src->span_begin;
+      dst->span_end = src->span_end;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // horizontal synthesis; when both sources are zero, the destination is
+    // cleared instead, and otherwise its span covers those of the sources,
+    // widened by the reach of the lifting steps
+    static void horz_syn_on_span(decltype(rev_horz_syn) horz_syn,
+                                 const param_atk* atk, line_buf* dst,
+                                 const line_buf* lsrc, const line_buf* hsrc,
+                                 ui32 width, bool even, bool keeps_zeros)
+    {
+      // a line of one sample has a source of none, which may be NULL
+      if (!keeps_zeros || width == 1)
+      {
+        horz_syn(atk, dst, lsrc, hsrc, width, even);
+        dst->set_full_span();
+        return;
+      }
+
+      ui32 b = ojph_min(lsrc->span_begin, hsrc->span_begin);
+      ui32 e = ojph_max(ojph_min(lsrc->span_end, width),
+                        ojph_min(hsrc->span_end, width));
+      if (lsrc->is_zero(width) && hsrc->is_zero(width))
+      {
+        memset(dst->p, 0,
+          (size_t)width * (dst->flags & line_buf::LFT_SIZE_MASK));
+        dst->set_zero_span();
+        return;
+      }
+
+      horz_syn(atk, dst, lsrc, hsrc, width, even);
+      ui32 reach = atk->get_num_steps() + 1; // in subband samples
+      dst->span_begin = b > reach ? 2 * (b - reach) : 0;
+      dst->span_end = ojph_min(2 * (e + reach), width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // a vertical lifting step, applied only where its sources are not zero;
+    // the span is started on a multiple of 16 samples, so that the SIMD
+    // kernels write no further than they would for the whole line
+    static void vert_step_on_span(decltype(rev_vert_step) vert_step,
+                                  const lifting_step* s, const line_buf* sp1,
+                                  const line_buf* sp2, line_buf* dp,
+                                  ui32 width, bool keeps_zeros)
+    {
+      if (!keeps_zeros)
+      {
+        vert_step(s, sp1, sp2, dp, width, true);
+        dp->set_full_span();
+        return;
+      }
+
+      ui32 b = ojph_min(sp1->span_begin, sp2->span_begin);
+      ui32 e = ojph_min(ojph_max(sp1->span_end, sp2->span_end), width);
+      if (b >= e)
+        return; // dp is left as it is
+      b &= ~15u;
+
+      size_t offset = (size_t)b * (dp->flags & line_buf::LFT_SIZE_MASK);
+      line_buf s1 = *sp1, s2 = *sp2, d = *dp;
+      s1.p = (ui8*)sp1->p + offset;
+      s2.p = (ui8*)sp2->p + offset;
+      d.p = (ui8*)dp->p + offset;
+      vert_step(s, &s1, &s2, &d, e - b, true);
+      dp->span_begin = ojph_min(dp->span_begin, b);
+      dp->span_end = ojph_max(dp->span_end, e);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    line_buf* resolution::synthesize_line()
     {
       if (res_num == 0)
       {
@@ -725,6 +978,9 @@ namespace ojph {
       if (width == 0)
         return NULL;
 
+      // lines pulled from the child resolution and the subbands are timed
+      // by their own stages
+      OJPH_STATS_TIMER(stats, IDWT);
       if (transform_flags & VERT_TRX)
       {
         if (reversible)
@@ -742,12 +998,11 @@ namespace ojph {
               {
                 if (vert_even) { // even
                   if (transform_flags & HORZ_TRX)
-                    rev_horz_syn(atk, aug->line, child_res->pull_line(), 
-                      bands[1].pull_line(), width, horz_even);
+                    horz_syn_on_span(rev_horz_syn, atk, aug->line,
+                      child_res->pull_line(), bands[1].pull_line(), width,
+                      horz_even, keeps_zeros);
                   else
-                    memcpy(aug->line->p, child_res->pull_line()->p,
-                      (size_t)width 
-                      * (aug->line->flags & line_buf::LFT_SIZE_MASK));
+                    copy_line(aug->line, child_res->pull_line(), width);
                   aug->active = true;
                   vert_even = !vert_even;
                   ++cur_line;
@@ -755,12 +1010,11 @@ namespace ojph {
                 }
                 else {
                   if (transform_flags & HORZ_TRX)
-                    rev_horz_syn(atk, sig->line, bands[2].pull_line(), 
-                      bands[3].pull_line(), width, horz_even);
+                    horz_syn_on_span(rev_horz_syn, atk, sig->line,
+                      bands[2].pull_line(), bands[3].pull_line(), width,
+                      horz_even, keeps_zeros);
                   else
-                    memcpy(sig->line->p, bands[2].pull_line()->p,
-                      (size_t)width 
-                      * (sig->line->flags & line_buf::LFT_SIZE_MASK));
+                    copy_line(sig->line, bands[2].pull_line(), width);
                   sig->active = true;
                   vert_even = !vert_even;
                   ++cur_line;
@@ -776,7 +1030,8 @@ namespace ojph {
                   line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
                   line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
                   const lifting_step* s = atk->get_step(i);
-                  rev_vert_step(s, sp1, sp2, dp, width, true);
+                  vert_step_on_span(rev_vert_step, s, sp1, sp2, dp, width,
+                                    keeps_zeros);
                 }
                 lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
               }
@@ -795,22 +1050,20 @@ namespace ojph {
           {
             if (vert_even) {
               if (transform_flags & HORZ_TRX)
-                rev_horz_syn(atk, aug->line, child_res->pull_line(),
-                  bands[1].pull_line(), width, horz_even);
+                horz_syn_on_span(rev_horz_syn, atk, aug->line,
+                  child_res->pull_line(), bands[1].pull_line(), width,
+                  horz_even, keeps_zeros);
               else
-                memcpy(aug->line->p, child_res->pull_line()->p,
-                  (size_t)width 
-                  * (aug->line->flags & line_buf::LFT_SIZE_MASK));
+                copy_line(aug->line, child_res->pull_line(), width);
             }
             else
             {
               if (transform_flags & HORZ_TRX)
-                rev_horz_syn(atk, aug->line, bands[2].pull_line(),
-                  bands[3].pull_line(), width, horz_even);
+                horz_syn_on_span(rev_horz_syn, atk, aug->line,
+                  bands[2].pull_line(), bands[3].pull_line(), width,
+                  horz_even, keeps_zeros);
               else
-                memcpy(aug->line->p, bands[2].pull_line()->p,
-                  (size_t)width 
-                  * (aug->line->flags & line_buf::LFT_SIZE_MASK));
+                copy_line(aug->line, bands[2].pull_line(), width);
               if (aug->line->flags & line_buf::LFT_32BIT)
               {
                 si32* sp = aug->line->i32;                
@@ -830,6 +1083,13 @@ namespace ojph {
         }
         else
         {
+          // fixed-point lines go through the same steps
+          decltype(irv_horz_syn) horz_syn =
+            fixed_point ? fix_horz_syn : irv_horz_syn;
+          decltype(irv_vert_step) vert_step =
+            fixed_point ? fix_vert_step : irv_vert_step;
+          decltype(irv_vert_times_K) vert_times_K =
+            fixed_point ? fix_vert_times_K : irv_vert_times_K;
           if (res_rect.siz.h > 1)
           {
             if (sig->active) {
@@ -843,33 +1103,35 @@ namespace ojph {
               {
                 if (vert_even) { // even
                   if (transform_flags & HORZ_TRX)
-                    irv_horz_syn(atk, aug->line, child_res->pull_line(), 
-                      bands[1].pull_line(), width, horz_even);
+                    horz_syn_on_span(horz_syn, atk, aug->line,
+                      child_res->pull_line(), bands[1].pull_line(), width,
+                      horz_even, keeps_zeros);
                   else 
-                    memcpy(aug->line->f32, child_res->pull_line()->f32,
-                      width * sizeof(float));
+                    copy_line(aug->line, child_res->pull_line(), width);
                   aug->active = true;
                   vert_even = !vert_even;
                   ++cur_line;
 
                   const float K = atk->get_K();
-                  irv_vert_times_K(K, aug->line, width);
+                  if (!aug->line->is_zero(width))
+                    vert_times_K(K, aug->line, width);
 
                   continue;
                 }
                 else {
                   if (transform_flags & HORZ_TRX)
-                    irv_horz_syn(atk, sig->line, bands[2].pull_line(), 
-                      bands[3].pull_line(), width, horz_even);
+                    horz_syn_on_span(horz_syn, atk, sig->line,
+                      bands[2].pull_line(), bands[3].pull_line(), width,
+                      horz_even, keeps_zeros);
                   else
-                    memcpy(sig->line->f32, bands[2].pull_line()->f32,
-                      width * sizeof(float));
+                    copy_line(sig->line, bands[2].pull_line(), width);
                   sig->active = true;
                   vert_even = !vert_even;
                   ++cur_line;
 
                   const float K_inv = 1.0f / atk->get_K();
-                  irv_vert_times_K(K_inv, sig->line, width);
+                  if (!sig->line->is_zero(width))
+                    vert_times_K(K_inv, sig->line, width);
                 }
               }
 
@@ -882,7 +1144,8 @@ namespace ojph {
                   line_buf* sp1 = sig->active ? sig->line : ssp[i].line;
                   line_buf* sp2 = ssp[i].active ? ssp[i].line : sig->line;
                   const lifting_step* s = atk->get_step(i);
-                  irv_vert_step(s, sp1, sp2, dp, width, true);
+                  vert_step_on_span(vert_step, s, sp1, sp2, dp, width,
+                                    keeps_zeros);
                 }
                 lifting_buf t = *aug; *aug = ssp[i]; ssp[i] = *sig; *sig = t;
               }
@@ -901,23 +1164,32 @@ namespace ojph {
           {
             if (vert_even) {
               if (transform_flags & HORZ_TRX)
-                irv_horz_syn(atk, aug->line, child_res->pull_line(),
-                  bands[1].pull_line(), width, horz_even);
+                horz_syn_on_span(horz_syn, atk, aug->line,
+                  child_res->pull_line(), bands[1].pull_line(), width,
+                  horz_even, keeps_zeros);
               else
-                memcpy(aug->line->f32, child_res->pull_line()->f32,
-                  width * sizeof(float));
+                copy_line(aug->line, child_res->pull_line(), width);
             }
             else
             {
               if (transform_flags & HORZ_TRX)
-                irv_horz_syn(atk, aug->line, bands[2].pull_line(),
-                  bands[3].pull_line(), width, horz_even);
+                horz_syn_on_span(horz_syn, atk, aug->line,
+                  bands[2].pull_line(), bands[3].pull_line(), width,
+                  horz_even, keeps_zeros);
              else
-                memcpy(aug->line->f32, bands[2].pull_line()->f32,
-                  width * sizeof(float));
-              float* sp = aug->line->f32;
-              for (ui32 i = width; i > 0; --i)
-                *sp++ *= 0.5f;
+                copy_line(aug->line, bands[2].pull_line(), width);
+              if (fixed_point)
+              {
+                si32* sp = aug->line->i32;
+                for (ui32 i = width; i > 0; --i)
+                  *sp++ >>= 1;
+              }
+              else
+              {
+                float* sp = aug->line->f32;
+                for (ui32 i = width; i > 0; --i)
+                  *sp++ *= 0.5f;
+              }
             }
             return aug->line;
           }
@@ -928,21 +1200,23 @@ namespace ojph {
         if (reversible)
         {
           if (transform_flags & HORZ_TRX)
-            rev_horz_syn(atk, aug->line, child_res->pull_line(),
-              bands[1].pull_line(), width, horz_even);
+            horz_syn_on_span(rev_horz_syn, atk, aug->line,
+              child_res->pull_line(), bands[1].pull_line(), width,
+              horz_even, keeps_zeros);
           else
-            memcpy(aug->line->p, child_res->pull_line()->p,
-              (size_t)width * (aug->line->flags & line_buf::LFT_SIZE_MASK));
+            copy_line(aug->line, child_res->pull_line(), width);
           return aug->line;
         }
         else
         {
+          decltype(irv_horz_syn) horz_syn =
+            fixed_point ? fix_horz_syn : irv_horz_syn;
           if (transform_flags & HORZ_TRX)
-            irv_horz_syn(atk, aug->line, child_res->pull_line(),
-              bands[1].pull_line(), width, horz_even);
+            horz_syn_on_span(horz_syn, atk, aug->line,
+              child_res->pull_line(), bands[1].pull_line(), width,
+              horz_even, keeps_zeros);
           else
-            memcpy(aug->line->f32, child_res->pull_line()->f32,
-              width * sizeof(float));
+            copy_line(aug->line, child_res->pull_line(), width);
           return aug->line;
         }
       }
@@ -955,6 +1229,9 @@ namespace ojph {
       if (res_num != 0)
         lower_resolutions_bytes = child_res->prepare_precinct();
 
+      for (int i = 0; i < 4; ++i)
+        bands[i].finish_push();
+
       this->num_bytes = 0;
       si32 repeat = (si32)num_precincts.area();
       for (si32 i = 0; i < repeat; ++i)
@@ -971,6 +1248,14 @@ namespace ojph {
         p[i].write(file);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::measure_precincts(param_plt *plt)
+    {
+      precinct* p = precincts;
+      for (si32 i = 0; i < (si32)num_precincts.area(); ++i)
+        plt->add_length(p[i].num_bytes);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool resolution::get_top_left_precinct(point& top_left)
     {
@@ -998,35 +1283,98 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::parse_all_precincts(ui32& data_left, infile_base* file)
+    void resolution::measure_one_precinct(param_plt *plt)
+    {
+      ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
+      assert(idx < num_precincts.area());
+      plt->add_length(precincts[idx].num_bytes);
+
+      if (++cur_precinct_loc.x >= num_precincts.w)
+      {
+        cur_precinct_loc.x = 0;
+        ++cur_precinct_loc.y;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::parse_precinct(precinct *p, ui32 layer,
+                                    ui32& data_left, infile_base *file,
+                                    packet_index *packets)
     {
+      OJPH_STATS_TIMER(stats, PACKETS);
+
+      // a packet whose length is known from PLT, and that carries nothing
+      // to be decoded, is stepped over without parsing its header; without
+      // PLT, its header is parsed but its body is still seeked over
+      ui32 length = packets->take();
+      const bool skip_body = skipped_res_for_read || !p->is_needed();
+      if (length != 0 && length <= data_left && skip_body)
+      {
+        if (file->seek(length, infile_base::OJPH_SEEK_CUR) == 0)
+        {
+          data_left -= length;
+          ++num_complete_packets;
+          p->stepped_over = true;
+          OJPH_STATS_COUNT(stats, PACKETS_SKIPPED, 1);
+        }
+        else
+          data_left = 0;
+        return;
+      }
+
+      ui32 bytes_before = data_left;
+      if (p->parse(tag_tree_size, level_index, elastic, layer, data_left,
+                   file, skip_body, packets->error))
+        ++num_complete_packets;
+      OJPH_STATS_COUNT(stats, PACKETS_PARSED, 1);
+      OJPH_STATS_COUNT(stats, BYTES_PARSED, bytes_before - data_left);
+      if (length != 0 && bytes_before - data_left != length)
+        packets->invalidate(); // the lengths do not describe this tile-part
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void resolution::parse_all_precincts(ui32 layer, ui32& data_left,
+                                         infile_base* file,
+                                         packet_index *packets)
+    {
+      // layer progressive orders read the packets of one layer for all
+      // precincts, then move to the next layer
+      if (layer != cur_layer)
+        return;
       precinct* p = precincts;
       ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
       for (ui32 i = idx; i < num_precincts.area(); ++i)
       {
         if (data_left == 0)
-          break;
-        p[i].parse(tag_tree_size, level_index, elastic, data_left, file,
-          skipped_res_for_read);
+          return;
+        parse_precinct(p + i, layer, data_left, file, packets);
         if (++cur_precinct_loc.x >= num_precincts.w)
         {
           cur_precinct_loc.x = 0;
           ++cur_precinct_loc.y;
         }
       }
+      cur_precinct_loc = point(0, 0);
+      ++cur_layer;
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void resolution::parse_one_precinct(ui32& data_left, infile_base* file)
+    void resolution::parse_one_precinct(ui32& data_left, infile_base* file,
+                                        packet_index *packets)
     {
       ui32 idx = cur_precinct_loc.x + cur_precinct_loc.y * num_precincts.w;
       assert(idx < num_precincts.area());
 
-      if (data_left == 0)
-        return;
-      precinct* p = precincts + idx;
-      p->parse(tag_tree_size, level_index, elastic, data_left, file,
-        skipped_res_for_read);
+      // position and component progressive orders read all the layers of
+      // a precinct before moving to the next one
+      for (; cur_layer < num_layers; ++cur_layer)
+      {
+        if (data_left == 0)
+          return;
+        parse_precinct(precincts + idx, cur_layer, data_left, file,
+                       packets);
+      }
+      cur_layer = 0;
       if (++cur_precinct_loc.x >= num_precincts.w)
       {
         cur_precinct_loc.x = 0;
@@ -46,8 +46,10 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   //defined elsewhere
   class line_buf;
+  class subband_sink;
   class mem_elastic_allocator;
   class codestream;
+  struct decode_stats;
 
   namespace local {
 
@@ -55,6 +57,8 @@ namespace ojph {
     //defined here
     class tile_comp;
     struct precinct;
+    struct packet_index;
+    struct param_plt;
     class subband;
 
     //////////////////////////////////////////////////////////////////////////
@@ -79,24 +83,45 @@ namespace ojph {
       line_buf* get_line();
       void push_line();
       line_buf* pull_line();
+      line_buf* get_retained_line(ui32 row);
+      bool pull_subbands(subband_sink *sink);
+      void restrict_region(const rect& region);
       rect get_rect() { return res_rect; }
       ui32 get_comp_num() { return comp_num; }
+      ui32 get_res_num() { return res_num; }
       bool has_horz_transform() { return (transform_flags & HORZ_TRX) != 0; }
       bool has_vert_transform() { return (transform_flags & VERT_TRX) != 0; }
 
       ui32 prepare_precinct();
       void write_precincts(outfile_base *file);
+      void measure_precincts(param_plt *plt);
       bool get_top_left_precinct(point &top_left);
       void write_one_precinct(outfile_base *file);
+      void measure_one_precinct(param_plt *plt);
+      void rewind_precincts()
+      { cur_precinct_loc = point(0, 0); cur_layer = 0; }
       resolution *next_resolution() { return child_res; }
-      void parse_all_precincts(ui32& data_left, infile_base *file);
-      void parse_one_precinct(ui32& data_left, infile_base *file);
+      void parse_all_precincts(ui32 layer, ui32& data_left,
+                               infile_base *file, packet_index *packets);
+      void parse_one_precinct(ui32& data_left, infile_base *file,
+                              packet_index *packets);
 
       ui32 get_num_bytes() const { return num_bytes; }
       ui32 get_num_bytes(ui32 resolution_num) const;
+      bool is_complete() const
+      { return num_complete_packets == num_precincts.area() * num_layers; }
+
+    private:
+      void parse_precinct(precinct *p, ui32 layer, ui32& data_left,
+                          infile_base *file, packet_index *packets);
+      line_buf* synthesize_line();
+      static ui32 retained_depth(codestream *codestream, ui32 comp_num,
+                                 ui32 res_num);
 
     private:
       bool reversible, skipped_res_for_read, skipped_res_for_recon;
+      bool fixed_point;    // irreversible lines are fixed-point si32 ones
+      bool keeps_zeros;    // lifting maps zero lines to zero lines
       ui32 num_steps;
       ui32 res_num;
       ui32 comp_num;
@@ -113,6 +138,9 @@ namespace ojph {
       //precincts stuff
       precinct *precincts;
       size num_precincts;
+      ui32 num_complete_packets; //packets that were read whole
+      ui32 num_layers, cur_layer; //quality layers, and the one being read
+      decode_stats *stats;        //NULL unless the codestream collects them
       size log_PP;
       ui32 max_num_levels;
       int tag_tree_size;
@@ -125,6 +153,10 @@ namespace ojph {
       ui32 rows_to_produce;
       bool vert_even, horz_even;
       mem_elastic_allocator *elastic;
+      //lines kept for codestream::pull_retained(), or NULL
+      void *retained;
+      ui32 retained_rows;     //lines kept so far
+      line_buf retained_line; //views one of the kept lines
     };
 
   }
@@ -39,9 +39,11 @@
 
 #include <climits>
 #include <cmath>
+#include <new>
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
+#include "ojph_codestream.h"
 #include "ojph_codestream_local.h"
 #include "ojph_subband.h"
 #include "ojph_resolution.h"
@@ -86,23 +88,37 @@ namespace ojph {
       num_blocks.h = (tby1 + (1 << ycb_prime) - 1) >> ycb_prime;
       num_blocks.h -= tby0 >> ycb_prime;
 
+      // a second row of codeblocks, coded by pool workers while the
+      // other row exchanges lines
+      bool parallel = codestream->get_codeblock_pool() != NULL;
+      ui32 num_rows = parallel ? 2 : 1;
+
       allocator->pre_alloc_obj<codeblock>(num_blocks.w);
       //allocate codeblock headers
       allocator->pre_alloc_obj<coded_cb_header>((size_t)num_blocks.area());
+      if (parallel)
+      {
+        allocator->pre_alloc_obj<codeblock>(num_blocks.w);
+        allocator->pre_alloc_obj<codeblock_job>(num_blocks.w);
+        allocator->pre_alloc_obj<codeblock_job>(num_blocks.w);
+        allocator->pre_alloc_obj<task_latch>(1);
+        allocator->pre_alloc_obj<task_latch>(1);
+      }
 
       const param_qcd* qp = codestream->access_qcd()->get_qcc(comp_num);
       ui32 precision = qp->propose_precision(cdp);
       const param_atk* atk = cdp->access_atk();
       bool reversible = atk->is_reversible();
+      bool fixed_point = codestream->is_fixed_point(comp_num);
 
-      for (ui32 i = 0; i < num_blocks.w; ++i)
+      for (ui32 i = 0; i < num_blocks.w * num_rows; ++i)
         codeblock::pre_alloc(codestream, nominal, precision);
 
       //allocate lines
       allocator->pre_alloc_obj<line_buf>(1);
       //allocate line_buf
       ui32 width = band_rect.siz.w + 1;
-      if (reversible)
+      if (reversible || fixed_point)
       {
         if (precision <= 32)
           allocator->pre_alloc_data<si32>(width, 1);
@@ -121,6 +137,8 @@ namespace ojph {
     {
       mem_fixed_allocator* allocator = codestream->get_allocator();
       elastic = codestream->get_elastic_alloc();
+      stats = codestream->get_stats();
+      cancel = codestream->get_cancel_flag();
 
       this->res_num = res_num;
       this->band_num = subband_num;
@@ -153,15 +171,18 @@ namespace ojph {
       const param_qcd* qcd = codestream->access_qcd()->get_qcc(comp_num);
       ui32 num_decomps = cdp->get_num_decompositions();
       this->K_max = qcd->get_Kmax(dfs, num_decomps, this->res_num, band_num);
+      ui32 precision = qcd->propose_precision(cdp);
       if (!reversible)
       {
+        // the magnitude of a codeblock sample is aligned to the MSB of its
+        // 32- or 64-bit word
+        ui32 msb = precision <= 32 ? 31 : 63;
         float d = 
           qcd->get_irrev_delta(dfs, num_decomps, res_num, subband_num);
-        d /= (float)(1u << (31 - this->K_max));
+        d /= (float)((ui64)1 << (msb - this->K_max));
         delta = d;
         delta_inv = (1.0f/d);
       }
-      ui32 precision = qcd->propose_precision(cdp);
 
       this->empty = ((band_rect.siz.w == 0) || (band_rect.siz.h == 0));
       if (this->empty)
@@ -178,10 +199,29 @@ namespace ojph {
       num_blocks.h = (tby1 + (1 << ycb_prime) - 1) >> ycb_prime;
       num_blocks.h -= tby0 >> ycb_prime;
 
+      needed_cbs.org = point(0, 0);
+      needed_cbs.siz = num_blocks;
+
       blocks = allocator->post_alloc_obj<codeblock>(num_blocks.w);
       //allocate codeblock headers
       coded_cb_header *cp = coded_cbs =
         allocator->post_alloc_obj<coded_cb_header>((size_t)num_blocks.area());
+      pool = codestream->get_codeblock_pool();
+      next_row_started = false;
+      if (pool)
+      {
+        codeblock_jobs = codestream->get_codeblock_jobs();
+        next_blocks = allocator->post_alloc_obj<codeblock>(num_blocks.w);
+        cur_jobs = allocator->post_alloc_obj<codeblock_job>(num_blocks.w);
+        next_jobs = allocator->post_alloc_obj<codeblock_job>(num_blocks.w);
+        for (ui32 i = 0; i < num_blocks.w; ++i)
+        {
+          new (cur_jobs + i) codeblock_job;
+          new (next_jobs + i) codeblock_job;
+        }
+        cur_latch = new (allocator->post_alloc_obj<task_latch>(1)) task_latch;
+        next_latch = new (allocator->post_alloc_obj<task_latch>(1)) task_latch;
+      }
       memset(coded_cbs, 0, sizeof(coded_cb_header) * (size_t)num_blocks.area());
       for (int i = (int)num_blocks.area(); i > 0; --i, ++cp)
         cp->Kmax = K_max;
@@ -201,6 +241,10 @@ namespace ojph {
         blocks[i].finalize_alloc(codestream, this, nominal, cb_size,
                                  coded_cbs + i, K_max, line_offset, 
                                  precision, comp_num);
+        if (pool)
+          next_blocks[i].finalize_alloc(codestream, this, nominal, cb_size,
+                                        coded_cbs + i, K_max, line_offset,
+                                        precision, comp_num);
         line_offset += cb_size.w;
       }
 
@@ -208,7 +252,7 @@ namespace ojph {
       lines = allocator->post_alloc_obj<line_buf>(1);
       //allocate line_buf
       ui32 width = band_rect.siz.w + 1;
-      if (reversible)
+      if (reversible || codestream->is_fixed_point(comp_num))
       {
         if (precision <= 32)      
           lines->wrap(allocator->post_alloc_data<si32>(width, 1), width, 1);
@@ -274,6 +318,31 @@ namespace ojph {
       assert(colx == num_blocks.w && coly == num_blocks.h);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void subband::restrict_region(const rect& region)
+    {
+      if (empty)
+        return;
+
+      ui32 tbx0 = band_rect.org.x;
+      ui32 tby0 = band_rect.org.y;
+      ui32 tbx1 = band_rect.org.x + band_rect.siz.w;
+      ui32 tby1 = band_rect.org.y + band_rect.siz.h;
+      ui32 x0 = ojph_max(tbx0, region.org.x);
+      ui32 y0 = ojph_max(tby0, region.org.y);
+      ui32 x1 = ojph_min(tbx1, region.org.x + region.siz.w);
+      ui32 y1 = ojph_min(tby1, region.org.y + region.siz.h);
+
+      needed_cbs = rect();
+      if (x0 < x1 && y0 < y1)
+      { // codeblock indices, relative to the first codeblock of the band
+        needed_cbs.org.x = (x0 >> xcb_prime) - (tbx0 >> xcb_prime);
+        needed_cbs.org.y = (y0 >> ycb_prime) - (tby0 >> ycb_prime);
+        needed_cbs.siz.w = ((x1 - 1) >> xcb_prime) - (x0 >> xcb_prime) + 1;
+        needed_cbs.siz.h = ((y1 - 1) >> ycb_prime) - (y0 >> ycb_prime) + 1;
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////
     void subband::exchange_buf(line_buf *l)
     {
@@ -298,37 +367,156 @@ namespace ojph {
         blocks[i].push(lines + 0);
       if (++cur_line >= cur_cb_height)
       {
-        for (ui32 i = 0; i < num_blocks.w; ++i)
-          blocks[i].encode(elastic);
+        if (pool == NULL)
+          for (ui32 i = 0; i < num_blocks.w; ++i)
+            blocks[i].encode(elastic);
+        else
+          start_encode_row();
 
         if (++cur_cb_row < num_blocks.h)
         {
           cur_line = 0;
+          cur_cb_height = (int)recreate_cb_row(blocks, cur_cb_row);
+        }
+      }
+    }
 
-          ui32 tbx0 = band_rect.org.x;
-          ui32 tby0 = band_rect.org.y;
-          ui32 tbx1 = band_rect.org.x + band_rect.siz.w;
-          ui32 tby1 = band_rect.org.y + band_rect.siz.h;
-          size nominal(1 << xcb_prime, 1 << ycb_prime);
+    //////////////////////////////////////////////////////////////////////////
+    void subband::finish_push()
+    {
+      if (empty)
+        return;
 
-          ui32 x_lower_bound = (tbx0 >> xcb_prime) << xcb_prime;
-          ui32 y_lower_bound = (tby0 >> ycb_prime) << ycb_prime;
-          ui32 cby0 = y_lower_bound + cur_cb_row * nominal.h;
-          ui32 cby1 = ojph_min(tby1, cby0 + nominal.h);
+      // the last codeblock row may still be encoded by pool workers
+      if (pool)
+        wait_encode_row();
+    }
 
-          size cb_size;
-          cb_size.h = cby1 - ojph_max(tby0, cby0);
-          cur_cb_height = (int)cb_size.h;
-          for (ui32 i = 0; i < num_blocks.w; ++i)
-          {
-            ui32 cbx0 = ojph_max(tbx0, x_lower_bound + i * nominal.w);
-            ui32 cbx1 = ojph_min(tbx1, x_lower_bound + (i + 1) * nominal.w);
-            cb_size.w = cbx1 - cbx0;
-            blocks[i].recreate(cb_size,
-                               coded_cbs + i + cur_cb_row * num_blocks.w);
-          }
-        }
+    //////////////////////////////////////////////////////////////////////////
+    void codeblock_job::execute()
+    {
+      try {
+        if (elastic)
+          block->encode(elastic);
+        else
+          block->decode();
+      }
+      catch (...) {
+        error = std::current_exception();
       }
+      row_latch->count_down();
+      jobs->count_down();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 subband::recreate_cb_row(codeblock *row_blocks, ui32 cb_row)
+    {
+      ui32 tbx0 = band_rect.org.x;
+      ui32 tby0 = band_rect.org.y;
+      ui32 tbx1 = band_rect.org.x + band_rect.siz.w;
+      ui32 tby1 = band_rect.org.y + band_rect.siz.h;
+      size nominal(1 << xcb_prime, 1 << ycb_prime);
+
+      ui32 x_lower_bound = (tbx0 >> xcb_prime) << xcb_prime;
+      ui32 y_lower_bound = (tby0 >> ycb_prime) << ycb_prime;
+      ui32 cby0 = ojph_max(tby0, y_lower_bound + cb_row * nominal.h);
+      ui32 cby1 = ojph_min(tby1, y_lower_bound + (cb_row + 1) * nominal.h);
+
+      size cb_size;
+      cb_size.h = cby1 - cby0;
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+      {
+        ui32 cbx0 = ojph_max(tbx0, x_lower_bound + i * nominal.w);
+        ui32 cbx1 = ojph_min(tbx1, x_lower_bound + (i + 1) * nominal.w);
+        cb_size.w = cbx1 - cbx0;
+        row_blocks[i].recreate(cb_size,
+                               coded_cbs + i + cb_row * num_blocks.w);
+      }
+      return cb_size.h;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void subband::start_cb_row(ui32 cb_row)
+    {
+      next_cb_height = (int)recreate_cb_row(next_blocks, cb_row);
+      ui32 num_needed = 0;
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+      {
+        next_jobs[i].error = NULL;
+        if (is_cb_needed(i, cb_row))
+          ++num_needed;
+        else
+          next_blocks[i].skip_decode();
+      }
+      next_latch->add(num_needed);
+      codeblock_jobs->add(num_needed);
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+      {
+        if (!is_cb_needed(i, cb_row))
+          continue;
+        codeblock_job &job = next_jobs[i];
+        job.block = next_blocks + i;
+        job.row_latch = next_latch;
+        job.jobs = codeblock_jobs;
+        pool->add_task(&job);
+      }
+      next_row_started = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void subband::wait_cb_row()
+    {
+      OJPH_STATS_TIMER(stats, BLOCK_WAIT);
+      while (!next_latch->is_done() && pool->run_pending_task()) {}
+      next_latch->wait();
+      next_row_started = false;
+
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+        if (next_jobs[i].error)
+          std::rethrow_exception(next_jobs[i].error);
+
+      // the decoded row becomes the current one
+      codeblock *tb = blocks; blocks = next_blocks; next_blocks = tb;
+      codeblock_job *tj = cur_jobs; cur_jobs = next_jobs; next_jobs = tj;
+      task_latch *tl = cur_latch; cur_latch = next_latch; next_latch = tl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void subband::start_encode_row()
+    {
+      // the row encoded before is reused for the lines that follow
+      wait_encode_row();
+      codeblock *tb = blocks; blocks = next_blocks; next_blocks = tb;
+      codeblock_job *tj = cur_jobs; cur_jobs = next_jobs; next_jobs = tj;
+      task_latch *tl = cur_latch; cur_latch = next_latch; next_latch = tl;
+
+      next_latch->add(num_blocks.w);
+      codeblock_jobs->add(num_blocks.w);
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+      {
+        codeblock_job &job = next_jobs[i];
+        job.block = next_blocks + i;
+        job.elastic = elastic;
+        job.row_latch = next_latch;
+        job.jobs = codeblock_jobs;
+        job.error = NULL;
+        pool->add_task(&job);
+      }
+      next_row_started = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void subband::wait_encode_row()
+    {
+      if (!next_row_started)
+        return;
+      while (!next_latch->is_done() && pool->run_pending_task()) {}
+      next_latch->wait();
+      next_row_started = false;
+
+      for (ui32 i = 0; i < num_blocks.w; ++i)
+        if (next_jobs[i].error)
+          std::rethrow_exception(next_jobs[i].error);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -337,33 +525,32 @@ namespace ojph {
       if (empty)
         return lines;
 
+      OJPH_STATS_TIMER(stats, BLOCKS);
       //pull from codeblocks
       if (--cur_line <= 0)
       {
         if (cur_cb_row < num_blocks.h)
         {
-          ui32 tbx0 = band_rect.org.x;
-          ui32 tby0 = band_rect.org.y;
-          ui32 tbx1 = band_rect.org.x + band_rect.siz.w;
-          ui32 tby1 = band_rect.org.y + band_rect.siz.h;
-          size nominal(1 << xcb_prime, 1 << ycb_prime);
-
-          ui32 x_lower_bound = (tbx0 >> xcb_prime) << xcb_prime;
-          ui32 y_lower_bound = (tby0 >> ycb_prime) << ycb_prime;
-          ui32 cby0 = ojph_max(tby0, y_lower_bound + cur_cb_row * nominal.h);
-          ui32 cby1 = ojph_min(tby1, y_lower_bound+(cur_cb_row+1)*nominal.h);
-
-          size cb_size;
-          cb_size.h = cby1 - cby0;
-          cur_line = cur_cb_height = (int)cb_size.h;
-          for (ui32 i = 0; i < num_blocks.w; ++i)
+          if (cancel && cancel->load(std::memory_order_relaxed))
+            throw decode_cancelled();
+          if (pool == NULL)
           {
-            ui32 cbx0 = ojph_max(tbx0, x_lower_bound + i * nominal.w);
-            ui32 cbx1 = ojph_min(tbx1, x_lower_bound + (i + 1) * nominal.w);
-            cb_size.w = cbx1 - cbx0;
-            blocks[i].recreate(cb_size,
-                               coded_cbs + i + cur_cb_row * num_blocks.w);
-            blocks[i].decode();
+            cur_cb_height = (int)recreate_cb_row(blocks, cur_cb_row);
+            cur_line = cur_cb_height;
+            for (ui32 i = 0; i < num_blocks.w; ++i)
+              if (is_cb_needed(i, cur_cb_row))
+                blocks[i].decode();
+              else
+                blocks[i].skip_decode();
+          }
+          else
+          {
+            if (!next_row_started)
+              start_cb_row(cur_cb_row);
+            wait_cb_row();
+            cur_line = cur_cb_height = next_cb_height;
+            if (cur_cb_row + 1 < num_blocks.h)
+              start_cb_row(cur_cb_row + 1);
           }
           ++cur_cb_row;
         }
@@ -371,7 +558,8 @@ namespace ojph {
 
       assert(cur_line >= 0);
 
-      //pull from codeblocks
+      //pull from codeblocks; those not all zero widen the line's span
+      lines->set_zero_span();
       for (ui32 i = 0; i < num_blocks.w; ++i)
         blocks[i].pull_line(lines + 0);
 
@@ -39,7 +39,10 @@
 #ifndef OJPH_SUBBAND_H
 #define OJPH_SUBBAND_H
 
+#include <exception>
+
 #include "ojph_defs.h"
+#include "ojph_threads.h"
 
 namespace ojph {
 
@@ -48,6 +51,7 @@ namespace ojph {
   class line_buf;
   class mem_elastic_allocator;
   class codestream;
+  struct decode_stats;
 
   namespace local {
 
@@ -57,6 +61,21 @@ namespace ojph {
     struct precinct;
     class codeblock;
     struct coded_cb_header;
+
+    //////////////////////////////////////////////////////////////////////////
+    // decodes or encodes one codeblock on a thread_pool worker
+    struct codeblock_job : public worker_thread_base
+    {
+      codeblock_job() : block(NULL), elastic(NULL), row_latch(NULL),
+                        jobs(NULL) {}
+      void execute() override;
+
+      codeblock *block;
+      mem_elastic_allocator *elastic; // set when encoding
+      task_latch *row_latch;  // the codeblock row this block belongs to
+      task_latch *jobs;       // all jobs of the codestream
+      std::exception_ptr error;
+    };
   
   //////////////////////////////////////////////////////////////////////////
     class subband
@@ -78,6 +97,15 @@ namespace ojph {
         K_max = 0;
         coded_cbs = NULL;
         elastic = NULL;
+        stats = NULL;
+        cancel = NULL;
+        pool = NULL;
+        codeblock_jobs = NULL;
+        next_blocks = NULL;
+        cur_jobs = next_jobs = NULL;
+        cur_latch = next_latch = NULL;
+        next_row_started = false;
+        next_cb_height = 0;
       }
 
       static void pre_alloc(codestream *codestream, const rect& band_rect,
@@ -88,15 +116,29 @@ namespace ojph {
       void exchange_buf(line_buf* l);
       line_buf* get_line() { return lines; }
       void push_line();
+      void finish_push();
 
       void get_cb_indices(const size& num_precincts, precinct *precincts);
       float get_delta() { return delta; }
+      ui32 get_band_num() const { return band_num; }
       bool exists() { return !empty; }
+      const rect& get_band_rect() const { return band_rect; }
 
       line_buf* pull_line();
+      void restrict_region(const rect& region);
       resolution* get_parent() { return parent; }
       const resolution* get_parent() const { return parent; }
 
+    private:
+      ui32 recreate_cb_row(codeblock *row_blocks, ui32 cb_row);
+      bool is_cb_needed(ui32 cb_col, ui32 cb_row) const
+      { return cb_col - needed_cbs.org.x < needed_cbs.siz.w &&
+               cb_row - needed_cbs.org.y < needed_cbs.siz.h; }
+      void start_cb_row(ui32 cb_row);
+      void wait_cb_row();
+      void start_encode_row();
+      void wait_encode_row();
+
     private:
       bool empty;                  // true if the subband has no pixels or
                                    // the subband is NOT USED
@@ -107,6 +149,8 @@ namespace ojph {
       resolution* parent;
       codeblock* blocks;
       size num_blocks;
+      rect needed_cbs;             // codeblocks that contribute to the
+                                   // decoding region; all by default
       size log_PP;
       ui32 xcb_prime, ycb_prime;
       ui32 cur_cb_row;
@@ -116,6 +160,19 @@ namespace ojph {
       ui32 K_max;
       coded_cb_header *coded_cbs;
       mem_elastic_allocator *elastic;
+      decode_stats *stats;         // NULL unless the codestream collects them
+      const std::atomic<bool> *cancel; // the codestream's cancel flag
+
+    private: // parallel coding; the next codeblock row is decoded by
+             // pool workers while lines are pulled from the current one,
+             // or the previous row is encoded while lines are pushed
+      thread_pool *pool;
+      task_latch *codeblock_jobs;
+      codeblock *next_blocks;
+      codeblock_job *cur_jobs, *next_jobs;
+      task_latch *cur_latch, *next_latch;
+      bool next_row_started;
+      int next_cb_height;
     };
 
   }
@@ -38,14 +38,19 @@
 
 #include <climits>
 #include <cmath>
+#include <cstring>
+#include <new>
 
 #include "ojph_mem.h"
 #include "ojph_params.h"
 #include "ojph_codestream_local.h"
 #include "ojph_tile.h"
 #include "ojph_tile_comp.h"
+#include "ojph_resolution.h"
+#include "ojph_precinct.h"
 
 #include "../transform/ojph_colour.h"
+#include "../transform/ojph_transform.h"
 
 namespace ojph {
 
@@ -70,6 +75,10 @@ namespace ojph {
       allocator->pre_alloc_obj<bool>(num_comps); //for reversible
       allocator->pre_alloc_obj<ui8>(num_comps);  //for nlt_type3
       allocator->pre_alloc_obj<ui32>(num_comps); //for cur_line
+      allocator->pre_alloc_obj<ui32>(num_comps); //for retained_row
+      allocator->pre_alloc_obj<bool>(num_comps); //for selected
+      allocator->pre_alloc_obj<bool>(num_comps); //for fixed_point
+      allocator->pre_alloc_obj<line_buf>(num_comps); //for fixed_lines
 
       {
         ui32 tilepart_div = codestream->get_tilepart_div();
@@ -138,6 +147,9 @@ namespace ojph {
         tile_comp::pre_alloc(codestream, i, comp_rect, recon_comp_rect);
         width = ojph_max(width, recon_comp_rect.siz.w);
       }
+      for (ui32 i = 0; i < num_comps; ++i)
+        if (codestream->is_fixed_point(i))
+          allocator->pre_alloc_data<float>(width, 0);
 
       //allocate lines
       const param_cod* cdp = codestream->get_cod();
@@ -177,6 +189,8 @@ namespace ojph {
 
       sot.init(0, (ui16)tile_idx, 0, 1);
       prog_order = codestream->access_cod().get_progression_order();
+      num_layers = (ui32)codestream->access_cod().get_num_layers();
+      stats = codestream->get_stats();
 
       //allocate tiles_comp
       const param_siz *szp = codestream->get_siz();
@@ -194,10 +208,18 @@ namespace ojph {
       reversible = allocator->post_alloc_obj<bool>(num_comps);
       nlt_type3 = allocator->post_alloc_obj<ui8>(num_comps);
       cur_line = allocator->post_alloc_obj<ui32>(num_comps);
+      retained_row = allocator->post_alloc_obj<ui32>(num_comps);
+      retained_level = 0;
+      selected = allocator->post_alloc_obj<bool>(num_comps);
+      fixed_point = allocator->post_alloc_obj<bool>(num_comps);
+      fixed_lines = allocator->post_alloc_obj<line_buf>(num_comps);
 
       profile = codestream->get_profile();
       tilepart_div = codestream->get_tilepart_div();
       need_tlm = codestream->is_tlm_needed();
+      need_plt = codestream->is_plt_needed();
+      plts = codestream->get_plts();
+      first_plt = cur_tile_part = 0;
       {
         ui32 tilepart_div = codestream->get_tilepart_div();
         ui32 t = tilepart_div & OJPH_TILEPART_MASK;
@@ -235,6 +257,9 @@ namespace ojph {
       ui32 tx1 = tile_rect.org.x + tile_rect.siz.w;
       ui32 ty1 = tile_rect.org.y + tile_rect.siz.h;
 
+      const rect* region = codestream->get_region();
+      outside_region = region != NULL;
+
       ui32 width = 0;
       for (ui32 i = 0; i < num_comps; ++i)
       {
@@ -267,6 +292,29 @@ namespace ojph {
           recon_comp_rects[i]);
         width = ojph_max(width, recon_comp_rects[i].siz.w);
 
+        selected[i] = codestream->is_component_selected(i);
+        if (!selected[i])
+          comps[i].restrict_region(rect()); // no codeblock is needed
+        else if (region)
+        { // the region in the coordinates of the reconstructed component
+          ui32 rx1 = region->org.x + region->siz.w;
+          ui32 ry1 = region->org.y + region->siz.h;
+          rect r;
+          r.org.x = ojph_div_ceil(region->org.x, recon_downsamp.x);
+          r.org.y = ojph_div_ceil(region->org.y, recon_downsamp.y);
+          r.siz.w = ojph_div_ceil(rx1, recon_downsamp.x) - r.org.x;
+          r.siz.h = ojph_div_ceil(ry1, recon_downsamp.y) - r.org.y;
+          if (r.siz.w > 0 && r.siz.h > 0 &&
+              r.org.x < recon_tcx1 && r.org.x + r.siz.w > recon_tcx0 &&
+              r.org.y < recon_tcy1 && r.org.y + r.siz.h > recon_tcy0)
+          {
+            outside_region = false;
+            comps[i].restrict_region(r);
+          }
+          else
+            comps[i].restrict_region(rect());
+        }
+
         num_bits[i] = szp->get_bit_depth(i);
         is_signed[i] = szp->is_signed(i);
         bool result = nlp->get_nonlinear_transform(i, bd, is, nlt_type3[i]);
@@ -277,6 +325,7 @@ namespace ojph {
             "for component %d", i, num_bits[i], 
             is_signed[i] ? "True" : "False", bd, is ? "True" : "False");
         cur_line[i] = 0;
+        retained_row[i] = 0;
         reversible[i] = codestream->get_coc(i)->is_reversible();
       }
 
@@ -284,7 +333,12 @@ namespace ojph {
 
       //allocate lines
       const param_cod* cdp = codestream->get_cod();
-      this->employ_color_transform = cdp->is_employing_color_transform();
+      // without all of its components, the colour transform is bypassed;
+      // the reader may take it over
+      this->defer_colour = codestream->is_colour_transform_deferred();
+      this->employ_color_transform = cdp->is_employing_color_transform()
+        && (num_comps < 3 || (selected[0] && selected[1] && selected[2]))
+        && !defer_colour;
       if (this->employ_color_transform)
       {
         num_lines = 3;
@@ -303,6 +357,14 @@ namespace ojph {
         lines = NULL;
         num_lines = 0;
       }
+      for (ui32 i = 0; i < num_comps; ++i)
+      {
+        new (fixed_lines + i) line_buf;
+        fixed_point[i] = codestream->is_fixed_point(i);
+        if (fixed_point[i])
+          fixed_lines[i].wrap(
+            allocator->post_alloc_data<float>(width, 0), width, 0);
+      }
       next_tile_part = 0;
     }
 
@@ -402,57 +464,122 @@ namespace ojph {
     //////////////////////////////////////////////////////////////////////////
     bool tile::pull(line_buf* tgt_line, ui32 comp_num)
     {
-      constexpr ui8 type3 = 
-        param_nlt::nonlinearity::OJPH_NLT_BINARY_COMPLEMENT_NLT;
-
       assert(comp_num < num_comps);
       if (cur_line[comp_num] >= recon_comp_rects[comp_num].siz.h)
         return false;
 
       cur_line[comp_num]++;
 
+      if (outside_region || !selected[comp_num]) // samples are not needed
+        return true;
+
+      OJPH_STATS_TIMER(stats, COLOUR);
+      reconstruct(tgt_line, comp_num, 0, 0, recon_comp_rects[comp_num].siz.w,
+        line_offsets[comp_num]);
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool tile::pull_retained(line_buf* tgt_line, ui32 comp_num, ui32 level)
+    {
+      assert(comp_num < num_comps && level > 0);
+      if (level != retained_level)
+      { // every component starts again from the top of the new level
+        retained_level = level;
+        for (ui32 c = 0; c < num_comps; ++c)
+          retained_row[c] = 0;
+      }
+      if (!selected[comp_num]) // samples are not needed
+        return true;
+
+      resolution *r = comps[comp_num].get_retained_resolution(level);
+      ui32 row = retained_row[comp_num];
+      if (r == NULL || r->get_retained_line(row) == NULL)
+        return false;
+      retained_row[comp_num]++;
+
+      OJPH_STATS_TIMER(stats, OUTPUT);
+      reconstruct(tgt_line, comp_num, level, row, r->get_rect().siz.w, 0);
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    bool tile::pull_subbands(subband_sink *sink)
+    {
+      for (ui32 c = 0; c < num_comps; ++c)
+        if (selected[c] && !comps[c].pull_subbands(sink))
+          return false;
+      return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    line_buf* tile::source_line(ui32 comp_num, ui32 level, ui32 row,
+                                ui32 width)
+    {
+      line_buf *line;
+      if (level == 0)
+        line = comps[comp_num].pull_line();
+      else
+        line = comps[comp_num].get_retained_resolution(level)
+          ->get_retained_line(row);
+      if (line == NULL || !fixed_point[comp_num])
+        return line;
+      fix_to_float(line, fixed_lines + comp_num, width);
+      return fixed_lines + comp_num;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile::reconstruct(line_buf* tgt_line, ui32 comp_num, ui32 level,
+                           ui32 row, ui32 width, ui32 offset)
+    {
+      constexpr ui8 type3 = 
+        param_nlt::nonlinearity::OJPH_NLT_BINARY_COMPLEMENT_NLT;
+
       if (!employ_color_transform || num_comps == 1)
       {
-        line_buf *src_line = comps[comp_num].pull_line();
-        ui32 comp_width = recon_comp_rects[comp_num].siz.w;
+        line_buf *src_line = source_line(comp_num, level, row, width);
+        // colour components left to the reader are not level shifted
+        bool raw = defer_colour && comp_num < 3;
         if (reversible[comp_num])
         {
           si64 shift = (si64)1 << (num_bits[comp_num] - 1);
           if (is_signed[comp_num] && nlt_type3[comp_num] == type3)
             rev_convert_nlt_type3(src_line, 0, tgt_line, 
-              line_offsets[comp_num], shift + 1, comp_width);
+              offset, shift + 1, width);
           else {
-            shift = is_signed[comp_num] ? 0 : shift;
+            shift = is_signed[comp_num] || raw ? 0 : shift;
             rev_convert(src_line, 0, tgt_line, 
-              line_offsets[comp_num], shift, comp_width);
+              offset, shift, width);
           }
         }
+        else if (raw)
+          memcpy(tgt_line->f32 + offset, src_line->f32,
+            width * sizeof(float));
         else
         {
           if (nlt_type3[comp_num] == type3)
             irv_convert_to_integer_nlt_type3(src_line, tgt_line, 
-              line_offsets[comp_num], num_bits[comp_num], 
-              is_signed[comp_num], comp_width);
+              offset, num_bits[comp_num], 
+              is_signed[comp_num], width);
           else
             irv_convert_to_integer(src_line, tgt_line, 
-              line_offsets[comp_num], num_bits[comp_num], 
-              is_signed[comp_num], comp_width);
+              offset, num_bits[comp_num], 
+              is_signed[comp_num], width);
         }
       }
       else
       {
         assert(num_comps >= 3);
-        ui32 comp_width = recon_comp_rects[comp_num].siz.w;
         if (comp_num == 0)
         {
+          line_buf *c0 = source_line(0, level, row, width);
+          line_buf *c1 = source_line(1, level, row, width);
+          line_buf *c2 = source_line(2, level, row, width);
           if (reversible[comp_num])
-            rct_backward(comps[0].pull_line(), comps[1].pull_line(),
-              comps[2].pull_line(), lines + 0, lines + 1,
-              lines + 2, comp_width);
+            rct_backward(c0, c1, c2, lines + 0, lines + 1, lines + 2, width);
           else
-            ict_backward(comps[0].pull_line()->f32, comps[1].pull_line()->f32,
-              comps[2].pull_line()->f32, lines[0].f32, lines[1].f32,
-              lines[2].f32, comp_width);
+            ict_backward(c0->f32, c1->f32, c2->f32, lines[0].f32,
+              lines[1].f32, lines[2].f32, width);
         }
         if (reversible[comp_num])
         {
@@ -461,14 +588,14 @@ namespace ojph {
           if (comp_num < 3)
             src_line = lines + comp_num;
           else
-            src_line = comps[comp_num].pull_line();
+            src_line = source_line(comp_num, level, row, width);
           if (is_signed[comp_num] && nlt_type3[comp_num] == type3)
             rev_convert_nlt_type3(src_line, 0, tgt_line, 
-              line_offsets[comp_num], shift + 1, comp_width);
+              offset, shift + 1, width);
           else {
             shift = is_signed[comp_num] ? 0 : shift;
             rev_convert(src_line, 0, tgt_line, 
-              line_offsets[comp_num], shift, comp_width);
+              offset, shift, width);
           }
         }
         else
@@ -477,19 +604,17 @@ namespace ojph {
           if (comp_num < 3)
             lbp = lines + comp_num;
           else
-            lbp = comps[comp_num].pull_line();            
+            lbp = source_line(comp_num, level, row, width);
           if (nlt_type3[comp_num] == type3)
             irv_convert_to_integer_nlt_type3(lbp, tgt_line, 
-              line_offsets[comp_num], num_bits[comp_num], 
-              is_signed[comp_num], comp_width);
+              offset, num_bits[comp_num], 
+              is_signed[comp_num], width);
           else
             irv_convert_to_integer(lbp, tgt_line, 
-              line_offsets[comp_num], num_bits[comp_num], 
-              is_signed[comp_num], comp_width);
+              offset, num_bits[comp_num], 
+              is_signed[comp_num], width);
         }
       }
-
-      return true;
     }
 
 
@@ -500,13 +625,25 @@ namespace ojph {
       //prepare precinct headers
       for (ui32 c = 0; c < num_comps; ++c)
         num_bytes += comps[c].prepare_precincts();
+
+      if (need_plt)
+      { //a tile-part header lists the lengths of the packets that follow,
+        // so the packets are sequenced once without writing, to get them
+        first_plt = (ui32)plts->size();
+        write_tile_parts(NULL);
+        for (ui32 c = 0; c < num_comps; ++c)
+          comps[c].rewind_precincts();
+        cur_tile_part = 0;
+      }
     }
 
     //////////////////////////////////////////////////////////////////////////
     void tile::fill_tlm(param_tlm *tlm)
     {
+      ui32 tp = 0; //tile-part index, for the bytes of its PLT segments
       if (tilepart_div == OJPH_TILEPART_NO_DIVISIONS) {
-        tlm->set_next_pair(sot.get_tile_index(), this->num_bytes);
+        tlm->set_next_pair(sot.get_tile_index(),
+                           this->num_bytes + get_plt_bytes(tp++));
       }
       else if (tilepart_div == OJPH_TILEPART_RESOLUTIONS)
       { 
@@ -519,7 +656,8 @@ namespace ojph {
           ui32 bytes = 0;
           for (ui32 c = 0; c < num_comps; ++c)
             bytes += comps[c].get_num_bytes(r);
-          tlm->set_next_pair(sot.get_tile_index(), bytes);
+          tlm->set_next_pair(sot.get_tile_index(),
+                             bytes + get_plt_bytes(tp++));
         }
       }      
       else if (tilepart_div == OJPH_TILEPART_COMPONENTS)
@@ -532,12 +670,13 @@ namespace ojph {
           for (ui32 r = 0; r <= max_decs; ++r) 
             for (ui32 c = 0; c < num_comps; ++c)
               if (r <= comps[c].get_num_decompositions())
-                tlm->set_next_pair(sot.get_tile_index(), 
-                                   comps[c].get_num_bytes(r));
+                tlm->set_next_pair(sot.get_tile_index(),
+                  comps[c].get_num_bytes(r) + get_plt_bytes(tp++));
         }
         else if (prog_order == OJPH_PO_CPRL)
           for (ui32 c = 0; c < num_comps; ++c)
-            tlm->set_next_pair(sot.get_tile_index(), comps[c].get_num_bytes());
+            tlm->set_next_pair(sot.get_tile_index(),
+              comps[c].get_num_bytes() + get_plt_bytes(tp++));
         else 
           assert(0); // should not be here
       }
@@ -550,14 +689,73 @@ namespace ojph {
         for (ui32 r = 0; r <= max_decs; ++r) 
           for (ui32 c = 0; c < num_comps; ++c)
             if (r <= comps[c].get_num_decompositions())
-              tlm->set_next_pair(sot.get_tile_index(), 
-                                 comps[c].get_num_bytes(r));
+              tlm->set_next_pair(sot.get_tile_index(),
+                comps[c].get_num_bytes(r) + get_plt_bytes(tp++));
       }
     }
 
 
     //////////////////////////////////////////////////////////////////////////
     void tile::flush(outfile_base *file)
+    {
+      write_tile_parts(file);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 tile::get_plt_bytes(ui32 tile_part) const
+    {
+      return need_plt ? (*plts)[first_plt + tile_part].get_marker_bytes() : 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile::start_tile_part(outfile_base *file, ui32 bytes,
+                               ui8 tile_part_index, ui8 num_tile_parts)
+    {
+      if (file == NULL)
+      { //collecting packet lengths; the packets that follow belong here
+        plts->push_back(param_plt());
+        return;
+      }
+
+      const param_plt *plt = NULL;
+      if (need_plt)
+        plt = &(*plts)[first_plt + cur_tile_part++];
+
+      //write tile header
+      bytes += plt ? plt->get_marker_bytes() : 0;
+      if (!sot.write(file, bytes, tile_part_index, num_tile_parts))
+        OJPH_ERROR(0x00030081, "Error writing to file");
+      if (plt && !plt->write(file))
+        OJPH_ERROR(0x0003008C, "Error writing to file");
+
+      //write start of data
+      ui16 t = swap_byte(JP2K_MARKER::SOD);
+      if (!file->write(&t, 2))
+        OJPH_ERROR(0x00030082, "Error writing to file");
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile::write_precincts(ui32 comp_num, ui32 res_num,
+                               outfile_base *file)
+    {
+      if (file)
+        comps[comp_num].write_precincts(res_num, file);
+      else
+        comps[comp_num].measure_precincts(res_num, &plts->back());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile::write_one_precinct(ui32 comp_num, ui32 res_num,
+                                  outfile_base *file)
+    {
+      if (file)
+        comps[comp_num].write_one_precinct(res_num, file);
+      else
+        comps[comp_num].measure_one_precinct(res_num, &plts->back());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile::write_tile_parts(outfile_base *file)
     {
       ui32 max_decompositions = 0;
       for (ui32 c = 0; c < num_comps; ++c)
@@ -565,17 +763,7 @@ namespace ojph {
           comps[c].get_num_decompositions());
 
       if (tilepart_div == OJPH_TILEPART_NO_DIVISIONS)
-      {
-        //write tile header
-        if (!sot.write(file, this->num_bytes))
-          OJPH_ERROR(0x00030081, "Error writing to file");
-
-        //write start of data
-        ui16 t = swap_byte(JP2K_MARKER::SOD);
-        if (!file->write(&t, 2))
-          OJPH_ERROR(0x00030082, "Error writing to file");
-      }
-
+        start_tile_part(file, this->num_bytes, 0, 1);
 
       //sequence the writing of precincts according to progression order
       if (prog_order == OJPH_PO_LRCP || prog_order == OJPH_PO_RLCP)
@@ -584,7 +772,7 @@ namespace ojph {
         {
           for (ui32 r = 0; r <= max_decompositions; ++r)
             for (ui32 c = 0; c < num_comps; ++c)
-              comps[c].write_precincts(r, file);
+              write_precincts(c, r, file);
         }
         else if (tilepart_div == OJPH_TILEPART_RESOLUTIONS) 
         {
@@ -594,18 +782,12 @@ namespace ojph {
             for (ui32 c = 0; c < num_comps; ++c)
               bytes += comps[c].get_num_bytes(r);
 
-            //write tile header
-            if (!sot.write(file, bytes, (ui8)r, (ui8)(max_decompositions + 1)))
-              OJPH_ERROR(0x00030083, "Error writing to file");
-
-            //write start of data
-            ui16 t = swap_byte(JP2K_MARKER::SOD);
-            if (!file->write(&t, 2))
-              OJPH_ERROR(0x00030084, "Error writing to file");
+            start_tile_part(file, bytes, (ui8)r,
+                            (ui8)(max_decompositions + 1));
             
             //write precincts
             for (ui32 c = 0; c < num_comps; ++c)
-              comps[c].write_precincts(r, file);              
+              write_precincts(c, r, file);
           }
         }
         else 
@@ -614,15 +796,9 @@ namespace ojph {
           for (ui32 r = 0; r <= max_decompositions; ++r)
             for (ui32 c = 0; c < num_comps; ++c)
               if (r <= comps[c].get_num_decompositions()) {
-                //write tile header
-                if (!sot.write(file, comps[c].get_num_bytes(r), 
-                               (ui8)(c + r * num_comps), (ui8)num_tileparts))
-                  OJPH_ERROR(0x00030085, "Error writing to file");
-                //write start of data
-                ui16 t = swap_byte(JP2K_MARKER::SOD);
-                if (!file->write(&t, 2))
-                  OJPH_ERROR(0x00030086, "Error writing to file");                
-                comps[c].write_precincts(r, file);
+                start_tile_part(file, comps[c].get_num_bytes(r),
+                  (ui8)(c + r * num_comps), (ui8)num_tileparts);
+                write_precincts(c, r, file);
               }
         }
       }
@@ -635,14 +811,8 @@ namespace ojph {
             ui32 bytes = 0;
             for (ui32 c = 0; c < num_comps; ++c)
               bytes += comps[c].get_num_bytes(r);
-            //write tile header
-            if (!sot.write(file, bytes, (ui8)r, (ui8)(max_decompositions + 1)))
-              OJPH_ERROR(0x00030087, "Error writing to file");
-
-            //write start of data
-            ui16 t = swap_byte(JP2K_MARKER::SOD);
-            if (!file->write(&t, 2))
-              OJPH_ERROR(0x00030088, "Error writing to file");
+            start_tile_part(file, bytes, (ui8)r,
+                            (ui8)(max_decompositions + 1));
           }
           while (true)
           {
@@ -662,7 +832,7 @@ namespace ojph {
               { smallest = cur; comp_num = c; }
             }
             if (found == true)
-              comps[comp_num].write_one_precinct(r, file);
+              write_one_precinct(comp_num, r, file);
             else
               break;
           }
@@ -698,7 +868,7 @@ namespace ojph {
             }
           }
           if (found == true)
-            comps[comp_num].write_one_precinct(res_num, file);
+            write_one_precinct(comp_num, res_num, file);
           else
             break;
         }
@@ -710,14 +880,7 @@ namespace ojph {
           if (tilepart_div == OJPH_TILEPART_COMPONENTS)
           {
             ui32 bytes = comps[c].get_num_bytes();
-            //write tile header
-            if (!sot.write(file, bytes, (ui8)c, (ui8)num_comps))
-              OJPH_ERROR(0x0003008A, "Error writing to file");
-
-            //write start of data
-            ui16 t = swap_byte(JP2K_MARKER::SOD);
-            if (!file->write(&t, 2))
-              OJPH_ERROR(0x0003008B, "Error writing to file");
+            start_tile_part(file, bytes, (ui8)c, (ui8)num_comps);
           }
 
           while (true)
@@ -738,7 +901,7 @@ namespace ojph {
               { smallest = cur; res_num = r; }
             }
             if (found == true)
-              comps[c].write_one_precinct(res_num, file);
+              write_one_precinct(c, res_num, file);
             else
               break;
           }
@@ -751,7 +914,8 @@ namespace ojph {
 
     //////////////////////////////////////////////////////////////////////////
     void tile::parse_tile_header(const param_sot &sot, infile_base *file,
-                                 const ui64& tile_start_location)
+                                 const ui64& tile_start_location,
+                                 const param_plt& plt)
     {
       if (sot.get_tile_part_index() != next_tile_part)
       {
@@ -768,24 +932,55 @@ namespace ojph {
       ui32 data_left = sot.get_payload_length(); //bytes left to parse
       data_left -= (ui32)((ui64)file->tell() - tile_start_location);
 
+      // the tile-part header, with its SOT marker segment
+      OJPH_STATS_COUNT(stats, BYTES_PARSED,
+        (ui64)file->tell() - tile_start_location + 12);
       if (data_left == 0)
         return;
 
+      // PLT lengths are used only if they account for the whole tile-part
+      packet_index packets;
+      if (plt.get_lengths() != NULL)
+      {
+        ui64 total = 0;
+        for (ui32 i = 0; i < plt.get_num_lengths(); ++i)
+          total += plt.get_lengths()[i];
+        if (total == data_left)
+          packets.init(plt.get_lengths(), plt.get_num_lengths());
+      }
+
       ui32 max_decompositions = 0;
       for (ui32 c = 0; c < num_comps; ++c)
         max_decompositions = ojph_max(max_decompositions,
           comps[c].get_num_decompositions());
 
+      const char *packet_error = NULL;
       try
       {
         //sequence the reading of precincts according to progression order
-        if (prog_order == OJPH_PO_LRCP || prog_order == OJPH_PO_RLCP)
+        if (prog_order == OJPH_PO_LRCP)
+        {
+          for (ui32 l = 0; l < num_layers; ++l)
+          {
+            // skipped resolutions are parsed too, except in the last layer,
+            // since the layers that follow come after them
+            ui32 num_decomps = max_decompositions;
+            if (l + 1 == num_layers)
+              num_decomps -= skipped_res_for_read;
+            for (ui32 r = 0; r <= num_decomps; ++r)
+              for (ui32 c = 0; c < num_comps; ++c)
+                if (data_left > 0)
+                  comps[c].parse_precincts(r, l, data_left, file, &packets);
+          }
+        }
+        else if (prog_order == OJPH_PO_RLCP)
         {
           max_decompositions -= skipped_res_for_read;
           for (ui32 r = 0; r <= max_decompositions; ++r)
-            for (ui32 c = 0; c < num_comps; ++c)
-              if (data_left > 0)
-                comps[c].parse_precincts(r, data_left, file);
+            for (ui32 l = 0; l < num_layers; ++l)
+              for (ui32 c = 0; c < num_comps; ++c)
+                if (data_left > 0)
+                  comps[c].parse_precincts(r, l, data_left, file, &packets);
         }
         else if (prog_order == OJPH_PO_RPCL)
         {
@@ -810,7 +1005,8 @@ namespace ojph {
                 { smallest = cur; comp_num = c; }
               }
               if (found == true && data_left > 0)
-                comps[comp_num].parse_one_precinct(r, data_left, file);
+                comps[comp_num].parse_one_precinct(r, data_left, file,
+                  &packets);
               else
                 break;
             }
@@ -846,7 +1042,8 @@ namespace ojph {
               }
             }
             if (found == true && data_left > 0)
-              comps[comp_num].parse_one_precinct(res_num, data_left, file);
+              comps[comp_num].parse_one_precinct(res_num, data_left, file,
+                &packets);
             else
               break;
           }
@@ -873,7 +1070,8 @@ namespace ojph {
                 { smallest = cur; res_num = r; }
               }
               if (found == true && data_left > 0)
-                comps[c].parse_one_precinct(res_num, data_left, file);
+                comps[c].parse_one_precinct(res_num, data_left, file,
+                  &packets);
               else
                 break;
             }
@@ -882,16 +1080,33 @@ namespace ojph {
         else
           assert(0);
 
+        packet_error = packets.error;
       }
       catch (const char *error)
+      {
+        packet_error = error;
+      }
+      // a corrupt packet ends the parsing of this tile-part; a resilient
+      // decoder goes on with the data read so far, without throwing
+      if (packet_error != NULL)
       {
         if (resilient)
-          OJPH_INFO(0x00030092, "%s", error)
+          OJPH_INFO(0x00030092, "%s", packet_error)
         else
-          OJPH_ERROR(0x00030092, "%s", error)
+          OJPH_ERROR(0x00030092, "%s", packet_error)
       }
       file->seek((si64)tile_end_location, infile_base::OJPH_SEEK_SET);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    ui32 tile::get_num_incomplete_resolutions()
+    {
+      ui32 incomplete = 0;
+      for (ui32 c = 0; c < num_comps; ++c)
+        incomplete = ojph_max(incomplete,
+          comps[c].get_num_incomplete_resolutions());
+      return incomplete;
+    }
+
   }
 }
\ No newline at end of file
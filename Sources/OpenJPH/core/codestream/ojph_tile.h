@@ -48,7 +48,9 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   //defined elsewhere
   class line_buf;
+  class subband_sink;
   class codestream;
+  struct decode_stats;
 
   namespace local {
 
@@ -70,9 +72,14 @@ namespace ojph {
       void fill_tlm(param_tlm* tlm);
       void flush(outfile_base *file);
       void parse_tile_header(const param_sot& sot, infile_base *file,
-                             const ui64& tile_start_location);
+                             const ui64& tile_start_location,
+                             const param_plt& plt);
       bool pull(line_buf *, ui32 comp_num);
+      bool pull_retained(line_buf *, ui32 comp_num, ui32 level);
+      bool pull_subbands(subband_sink *sink);
       rect get_tile_rect() { return tile_rect; }
+      bool is_outside_region() const { return outside_region; }
+      ui32 get_num_incomplete_resolutions();
 
     private:
       //codestream *parent;
@@ -82,16 +89,44 @@ namespace ojph {
       ui32 num_lines;
       line_buf* lines;
       bool employ_color_transform, resilient;
+      bool defer_colour;   // colour components are pulled raw, for the reader
       bool *reversible;
       rect *comp_rects, *recon_comp_rects;
       ui32 *line_offsets;
       ui32 skipped_res_for_read;
+      bool outside_region;   // not reconstructed; see restrict_input_region
+      bool *selected;        // components to be reconstructed; see
+                             // restrict_input_components
+      bool *fixed_point;     // components synthesized in fixed point, and
+      line_buf *fixed_lines; // the float lines their samples are moved to
 
       ui32 *num_bits;
       bool *is_signed;
       ui32 *cur_line;
+      ui32 *retained_row;    // next line of each component for
+      ui32 retained_level;   // pull_retained() at this level
       ui8 *nlt_type3;
       int prog_order;
+      ui32 num_layers;
+      decode_stats *stats;   // NULL unless the codestream collects them
+
+    private:
+      // the line of a component to reconstruct from: the next one its
+      // tile-component produces, or a retained one `level` resolutions down,
+      // in floats for fixed-point components
+      line_buf* source_line(ui32 comp_num, ui32 level, ui32 row,
+                            ui32 width);
+      void reconstruct(line_buf *tgt_line, ui32 comp_num, ui32 level,
+                       ui32 row, ui32 width, ui32 offset);
+      // writes the tile-parts of the tile in progression order; with a NULL
+      // file, only collects the packet lengths of each tile-part in plts
+      void write_tile_parts(outfile_base *file);
+      void start_tile_part(outfile_base *file, ui32 bytes,
+                           ui8 tile_part_index, ui8 num_tile_parts);
+      void write_precincts(ui32 comp_num, ui32 res_num, outfile_base *file);
+      void write_one_precinct(ui32 comp_num, ui32 res_num,
+                              outfile_base *file);
+      ui32 get_plt_bytes(ui32 tile_part) const;
 
     private:
       param_sot sot;
@@ -101,6 +136,11 @@ namespace ojph {
       int profile;
       ui32 tilepart_div;    // tilepart division value
       bool need_tlm;        // true if tlm markers are needed
+      bool need_plt;        // true if plt markers are needed
+      std::vector<param_plt> *plts; // packet lengths of all tile-parts,
+                                    // owned by the codestream
+      ui32 first_plt;       // index in plts of this tile's first tile-part
+      ui32 cur_tile_part;   // tile-part written next
 
       ui32 num_bytes; // number of bytes in this tile
                       // used for tile length
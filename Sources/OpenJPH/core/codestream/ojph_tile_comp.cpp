@@ -75,6 +75,7 @@ namespace ojph {
 
       //allocate a resolution
       num_decomps = codestream->get_coc(comp_num)->get_num_decompositions();
+      skipped_res_for_recon = codestream->get_skipped_res_for_recon();
 
       comp_downsamp = codestream->get_siz()->get_downsampling(comp_num);
       this->comp_rect = comp_rect;
@@ -106,6 +107,32 @@ namespace ojph {
       return res->pull_line();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    bool tile_comp::pull_subbands(subband_sink *sink)
+    {
+      return res->pull_subbands(sink);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    resolution* tile_comp::get_retained_resolution(ui32 level)
+    {
+      // `level` resolutions below the reconstructed one; the finer ones
+      // only forward lines when resolutions are skipped
+      if (skipped_res_for_recon + level > num_decomps)
+        return NULL;
+      ui32 res_num = num_decomps - skipped_res_for_recon - level;
+      resolution *r = res;
+      while (r != NULL && r->get_res_num() > res_num)
+        r = r->next_resolution();
+      return r;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile_comp::restrict_region(const rect& region)
+    {
+      res->restrict_region(region);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     ui32 tile_comp::prepare_precincts()
     {
@@ -128,6 +155,21 @@ namespace ojph {
         r->write_precincts(file);
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    void tile_comp::measure_precincts(ui32 res_num, param_plt *plt)
+    {
+      assert(res_num <= num_decomps);
+      res_num = num_decomps - res_num; //how many levels to go down
+      resolution *r = res;
+      while (res_num > 0 && r != NULL)
+      {
+        r = r->next_resolution();
+        --res_num;
+      }
+      if (r) //resolution does not exist if r is NULL
+        r->measure_precincts(plt);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     bool tile_comp::get_top_left_precinct(ui32 res_num, point &top_left)
     {
@@ -159,8 +201,30 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    void tile_comp::parse_precincts(ui32 res_num, ui32& data_left,
-                                    infile_base *file)
+    void tile_comp::measure_one_precinct(ui32 res_num, param_plt *plt)
+    {
+      int resolution_num = (int)num_decomps - (int)res_num;
+      resolution *r = res;
+      while (resolution_num > 0 && r != NULL)
+      {
+        r = r->next_resolution();
+        --resolution_num;
+      }
+      if (r) //resolution does not exist if r is NULL
+        r->measure_one_precinct(plt);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile_comp::rewind_precincts()
+    {
+      for (resolution *r = res; r != NULL; r = r->next_resolution())
+        r->rewind_precincts();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void tile_comp::parse_precincts(ui32 res_num, ui32 layer,
+                                    ui32& data_left, infile_base *file,
+                                    packet_index *packets)
     {
       assert(res_num <= num_decomps);
       res_num = num_decomps - res_num; //how many levels to go down
@@ -171,13 +235,14 @@ namespace ojph {
         --res_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->parse_all_precincts(data_left, file);
+        r->parse_all_precincts(layer, data_left, file, packets);
     }
 
 
     //////////////////////////////////////////////////////////////////////////
     void tile_comp::parse_one_precinct(ui32 res_num, ui32& data_left,
-                                       infile_base *file)
+                                       infile_base *file,
+                                       packet_index *packets)
     {
       assert(res_num <= num_decomps);
       res_num = num_decomps - res_num;
@@ -188,7 +253,7 @@ namespace ojph {
         --res_num;
       }
       if (r) //resolution does not exist if r is NULL
-        r->parse_one_precinct(data_left, file);
+        r->parse_one_precinct(data_left, file, packets);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -196,5 +261,17 @@ namespace ojph {
     {
       return res->get_num_bytes(resolution_num);
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    ui32 tile_comp::get_num_incomplete_resolutions()
+    {
+      // a resolution is usable only if it and all the ones below it were
+      // read whole; resolutions are visited from the finest down
+      ui32 incomplete = 0, depth = 1;
+      for (resolution *r = res; r != NULL; r = r->next_resolution(), ++depth)
+        if (!r->is_complete())
+          incomplete = depth;
+      return incomplete;
+    }
   }
 }
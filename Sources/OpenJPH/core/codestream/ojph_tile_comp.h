@@ -49,6 +49,7 @@ namespace ojph {
   ////////////////////////////////////////////////////////////////////////////
   //defined elsewhere
   class line_buf;
+  class subband_sink;
   class codestream;
 
   namespace local {
@@ -57,6 +58,8 @@ namespace ojph {
     //defined here
     class tile;
     class resolution;
+    struct packet_index;
+    struct param_plt;
 
     //////////////////////////////////////////////////////////////////////////
     class tile_comp
@@ -75,17 +78,25 @@ namespace ojph {
       line_buf* get_line();
       void push_line();
       line_buf* pull_line();
+      resolution* get_retained_resolution(ui32 level);
+      bool pull_subbands(subband_sink *sink);
+      void restrict_region(const rect& region);
 
       ui32 prepare_precincts();
       void write_precincts(ui32 res_num, outfile_base *file);
+      void measure_precincts(ui32 res_num, param_plt *plt);
       bool get_top_left_precinct(ui32 res_num, point &top_left);
       void write_one_precinct(ui32 res_num, outfile_base *file);
-      void parse_precincts(ui32 res_num, ui32& data_left, infile_base *file);
-      void parse_one_precinct(ui32 res_num, ui32& data_left, 
-                              infile_base *file);
+      void measure_one_precinct(ui32 res_num, param_plt *plt);
+      void rewind_precincts();
+      void parse_precincts(ui32 res_num, ui32 layer, ui32& data_left,
+                           infile_base *file, packet_index *packets);
+      void parse_one_precinct(ui32 res_num, ui32& data_left,
+                              infile_base *file, packet_index *packets);
 
       ui32 get_num_bytes() const { return num_bytes; }
       ui32 get_num_bytes(ui32 resolution_num) const;
+      ui32 get_num_incomplete_resolutions();
 
     private:
       tile *parent_tile;
@@ -93,6 +104,7 @@ namespace ojph {
       rect comp_rect;
       ojph::point comp_downsamp;
       ui32 num_decomps;
+      ui32 skipped_res_for_recon;
       ui32 comp_num;
       ui32 num_bytes; // number of bytes in this tile component
                       // used for tilepart length
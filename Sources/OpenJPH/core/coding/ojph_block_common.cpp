@@ -65,11 +65,70 @@ namespace ojph {
      *  The 3 MSB is the context of for the codeword.                        \n
      */
 
+    //************************************************************************/
+    /** @ingroup vlc_decoding_tables_grp
+     *  @brief A row of table0.h or table1.h, taken from the standard
+     *
+     *  c_q is the context for a quad, rho its significance pattern, u_off
+     *  tells whether its u value is communicated (1) or 0 (0), e_k and e_1
+     *  are the EMB patterns, and cwd and cwd_len the VLC codeword and its
+     *  length.
+     */
+    struct vlc_src_table { int c_q, rho, u_off, e_k, e_1, cwd, cwd_len; };
+
+    /// @brief initial quad rows
+    static constexpr vlc_src_table vlc_src_tbl0[] = {
+    #include "table0.h"
+    };
+
+    /// @brief non-initial quad rows
+    static constexpr vlc_src_table vlc_src_tbl1[] = {
+    #include "table1.h"
+    };
+
+    //************************************************************************/
+    /** @ingroup vlc_decoding_tables_grp
+     *  @brief Fills a decoding table from the rows of table0.h or table1.h
+     *
+     *  The codewords of a context form a prefix code, so each row sets the
+     *  entries of all the 7-bit words that start, from their LSB, with its
+     *  codeword, and every entry is set by one row at most.
+     */
+    template <size_t N>
+    static constexpr void vlc_fill_table(const vlc_src_table (&src)[N],
+                                         ui16 (&tbl)[1024])
+    {
+      for (size_t j = 0; j < N; ++j)
+      {
+        const vlc_src_table& e = src[j];
+        ui16 entry = (ui16)((e.rho << 4) | (e.u_off << 3) | (e.e_k << 12)
+                            | (e.e_1 << 8) | e.cwd_len);
+        for (int high = 0; high < (1 << (7 - e.cwd_len)); ++high)
+          tbl[(e.c_q << 7) | (high << e.cwd_len) | e.cwd] = entry;
+      }
+    }
+
+    //************************************************************************/
+    /** @ingroup vlc_decoding_tables_grp
+     *  @brief Both VLC decoding tables, computed by the compiler
+     */
+    struct vlc_tables { ui16 tbl0[1024]; ui16 tbl1[1024]; };
+
+    static constexpr vlc_tables vlc_init_tables()
+    {
+      vlc_tables t = {};
+      vlc_fill_table(vlc_src_tbl0, t.tbl0);
+      vlc_fill_table(vlc_src_tbl1, t.tbl1);
+      return t;
+    }
+
+    static constexpr vlc_tables vlc_decoding_tables = vlc_init_tables();
+
     /// @brief vlc_tbl0 contains decoding information for initial row of quads
-    ui16 vlc_tbl0[1024] = { 0 };
+    const ui16 (&vlc_tbl0)[1024] = vlc_decoding_tables.tbl0;
     /// @brief vlc_tbl1 contains decoding information for non-initial row of 
     ///        quads
-    ui16 vlc_tbl1[1024] = { 0 };
+    const ui16 (&vlc_tbl1)[1024] = vlc_decoding_tables.tbl1;
     /// @}
 
     //************************************************************************/
@@ -100,123 +159,65 @@ namespace ojph {
      *  \li \c u_q1 bias is 2 bits                                           \n
      */
 
-    /// @brief uvlc_tbl0 contains decoding information for initial row of quads
-    ui16 uvlc_tbl0[256+64] = { 0 };
-    /// @brief uvlc_tbl1 contains decoding information for non-initial row of 
-    ///        quads
-    ui16 uvlc_tbl1[256] = { 0 };
-    /// @brief uvlc_bias contains decoding info. for initial row of quads
-    ui8 uvlc_bias[256+64] = { 0 };
-    /// @}
+    //************************************************************************/
+    /** @ingroup uvlc_decoding_tables_grp
+     *  @brief Decoding of the three bits a UVLC prefix can take
+     *
+     *  There are 8 entries for xx1, x10, 100, 000, where x means do not
+     *  care; an entry is made up of 2 bits in the LSB for the prefix
+     *  length, 3 bits for the suffix length, and 3 bits in the MSB for the
+     *  prefix value (u_pfx in Table 3 of ITU T.814).
+     */
+    static constexpr ui8 uvlc_dec[8] = { // the index is the prefix codeword
+      3 | (5 << 2) | (5 << 5), //000 == 000, prefix codeword "000"
+      1 | (0 << 2) | (1 << 5), //001 == xx1, prefix codeword "1"
+      2 | (0 << 2) | (2 << 5), //010 == x10, prefix codeword "01"
+      1 | (0 << 2) | (1 << 5), //011 == xx1, prefix codeword "1"
+      3 | (1 << 2) | (3 << 5), //100 == 100, prefix codeword "001"
+      1 | (0 << 2) | (1 << 5), //101 == xx1, prefix codeword "1"
+      2 | (0 << 2) | (2 << 5), //110 == x10, prefix codeword "01"
+      1 | (0 << 2) | (1 << 5)  //111 == xx1, prefix codeword "1"
+    };
 
     //************************************************************************/
-    /** @ingroup vlc_decoding_tables_grp
-     *  @brief Initializes vlc_tbl0 and vlc_tbl1 tables, from table0.h and
-     *         table1.h
+    /** @ingroup uvlc_decoding_tables_grp
+     *  @brief Packs the fields of a uvlc_tbl0 or uvlc_tbl1 entry
      */
-    static bool vlc_init_tables()
+    static constexpr ui16 uvlc_entry(ui32 total_prefix, ui32 total_suffix,
+                                     ui32 u0_suffix_len, ui32 u0, ui32 u1)
     {
-      const bool debug = false; //useful for checking 
-
-      //Data in the table is arranged in this format (taken from the standard)
-      // c_q is the context for a quad
-      // rho is the significance pattern for a quad
-      // u_off indicate if u value is 0 (u_off is 0), or communicated
-      // e_k, e_1 EMB patterns
-      // cwd VLC codeword
-      // cwd VLC codeword length
-      struct vlc_src_table { int c_q, rho, u_off, e_k, e_1, cwd, cwd_len; };
-      // initial quad rows
-      vlc_src_table tbl0[] = {
-    #include "table0.h"
-      };
-      // number of entries in the table
-      size_t tbl0_size = sizeof(tbl0) / sizeof(vlc_src_table); 
-
-      // nono-initial quad rows
-      vlc_src_table tbl1[] = {
-    #include "table1.h"
-      };
-      // number of entries in the table
-      size_t tbl1_size = sizeof(tbl1) / sizeof(vlc_src_table);
-
-      if (debug) memset(vlc_tbl0, 0, sizeof(vlc_tbl0)); //unnecessary
-
-      // this is to convert table entries into values for decoder look up
-      // There can be at most 1024 possibilities, not all of them are valid.
-      // 
-      for (int i = 0; i < 1024; ++i)
-      {
-        int cwd = i & 0x7F; // from i extract codeword
-        int c_q = i >> 7;   // from i extract context
-        // See if this case exist in the table, if so then set the entry in
-        // vlc_tbl0
-        for (size_t j = 0; j < tbl0_size; ++j) 
-          if (tbl0[j].c_q == c_q) // this is an and operation
-            if (tbl0[j].cwd == (cwd & ((1 << tbl0[j].cwd_len) - 1)))
-            {
-              if (debug) assert(vlc_tbl0[i] == 0);
-              // Put this entry into the table
-              vlc_tbl0[i] = (ui16)((tbl0[j].rho << 4) | (tbl0[j].u_off << 3)
-                | (tbl0[j].e_k << 12) | (tbl0[j].e_1 << 8) | tbl0[j].cwd_len);
-            }
-      }
-
-      if (debug) memset(vlc_tbl1, 0, sizeof(vlc_tbl1)); //unnecessary
-
-      // this the same as above but for non-initial rows
-      for (int i = 0; i < 1024; ++i)
-      {
-        int cwd = i & 0x7F; //7 bits
-        int c_q = i >> 7;
-        for (size_t j = 0; j < tbl1_size; ++j)
-          if (tbl1[j].c_q == c_q) // this is an and operation
-            if (tbl1[j].cwd == (cwd & ((1 << tbl1[j].cwd_len) - 1)))
-            {
-              if (debug) assert(vlc_tbl1[i] == 0);
-              vlc_tbl1[i] = (ui16)((tbl1[j].rho << 4) | (tbl1[j].u_off << 3)
-                | (tbl1[j].e_k << 12) | (tbl1[j].e_1 << 8) | tbl1[j].cwd_len);
-            }
-      }
-
-      return true;
+      return (ui16)(total_prefix | 
+                    (total_suffix << 3) |
+                    (u0_suffix_len << 7) |
+                    (u0 << 10) |
+                    (u1 << 13));
     }
 
     //************************************************************************/
     /** @ingroup uvlc_decoding_tables_grp
-     *  @brief Initializes uvlc_tbl0 and uvlc_tbl1 tables
+     *  @brief The UVLC decoding tables, computed by the compiler
      */
-    static bool uvlc_init_tables()
-    {
-      // table stores possible decoding three bits from vlc
-      // there are 8 entries for xx1, x10, 100, 000, where x means do not
-      // care table value is made up of
-      // 2 bits in the LSB for prefix length 
-      // 3 bits for suffix length
-      // 3 bits in the MSB for prefix value (u_pfx in Table 3 of ITU T.814)
-      static const ui8 dec[8] = { // the index is the prefix codeword
-        3 | (5 << 2) | (5 << 5), //000 == 000, prefix codeword "000"
-        1 | (0 << 2) | (1 << 5), //001 == xx1, prefix codeword "1"
-        2 | (0 << 2) | (2 << 5), //010 == x10, prefix codeword "01"
-        1 | (0 << 2) | (1 << 5), //011 == xx1, prefix codeword "1"
-        3 | (1 << 2) | (3 << 5), //100 == 100, prefix codeword "001"
-        1 | (0 << 2) | (1 << 5), //101 == xx1, prefix codeword "1"
-        2 | (0 << 2) | (2 << 5), //110 == x10, prefix codeword "01"
-        1 | (0 << 2) | (1 << 5)  //111 == xx1, prefix codeword "1"
-      };
+    struct uvlc_tables {
+      ui16 tbl0[256+64];
+      ui16 tbl1[256];
+      ui8 bias[256+64];
+    };
 
+    static constexpr uvlc_tables uvlc_init_tables()
+    {
+      uvlc_tables t = {};
       for (ui32 i = 0; i < 256 + 64; ++i)
       { 
         ui32 mode = i >> 6;
         ui32 vlc = i & 0x3F;
 
         if (mode == 0) {      // both u_off are 0
-          uvlc_tbl0[i] = 0;
-          uvlc_bias[i] = 0;
+          t.tbl0[i] = 0;
+          t.bias[i] = 0;
         }
         else if (mode <= 2) // u_off are either 01 or 10
         {
-          ui32 d = dec[vlc & 0x7];   //look at the least significant 3 bits
+          ui32 d = uvlc_dec[vlc & 0x7];   //look at the least significant 3 bits
 
           ui32 total_prefix = d & 0x3;
           ui32 total_suffix = (d >> 2) & 0x7;
@@ -224,50 +225,36 @@ namespace ojph {
           ui32 u0 = (mode == 1) ? (d >> 5) : 0;
           ui32 u1 = (mode == 1) ? 0 : (d >> 5);
 
-          uvlc_tbl0[i] = (ui16)(total_prefix | 
-                               (total_suffix << 3) |
-                               (u0_suffix_len << 7) |
-                               (u0 << 10) |
-                               (u1 << 13));
-          
+          t.tbl0[i] = uvlc_entry(total_prefix, total_suffix, u0_suffix_len,
+                                 u0, u1);
         }
         else if (mode == 3) // both u_off are 1, and MEL event is 0
         {
-          ui32 d0 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
-          vlc >>= d0 & 0x3;          // Consume bits
-          ui32 d1 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          ui32 d0 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          vlc >>= d0 & 0x3;               // Consume bits
+          ui32 d1 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
 
-          ui32 total_prefix, u0_suffix_len, total_suffix, u0, u1;
           if ((d0 & 0x3) == 3)
           {
-            total_prefix = (d0 & 0x3) + 1;
-            u0_suffix_len = (d0 >> 2) & 0x7;
-            total_suffix = u0_suffix_len;
-            u0 = d0 >> 5;
-            u1 = (vlc & 1) + 1;
-            uvlc_bias[i] = 4; // 0b00 for u0 and 0b01 for u1
+            ui32 u0_suffix_len = (d0 >> 2) & 0x7;
+            t.tbl0[i] = uvlc_entry((d0 & 0x3) + 1, u0_suffix_len,
+                                   u0_suffix_len, d0 >> 5, (vlc & 1) + 1);
+            t.bias[i] = 4; // 0b00 for u0 and 0b01 for u1
           }
           else
           {
-            total_prefix = (d0 & 0x3) + (d1 & 0x3);
-            u0_suffix_len = (d0 >> 2) & 0x7;
-            total_suffix = u0_suffix_len + ((d1 >> 2) & 0x7);
-            u0 = d0 >> 5;
-            u1 = d1 >> 5;
-            uvlc_bias[i] = 0;
+            ui32 u0_suffix_len = (d0 >> 2) & 0x7;
+            t.tbl0[i] = uvlc_entry((d0 & 0x3) + (d1 & 0x3),
+                                   u0_suffix_len + ((d1 >> 2) & 0x7),
+                                   u0_suffix_len, d0 >> 5, d1 >> 5);
+            t.bias[i] = 0;
           }
-
-          uvlc_tbl0[i] = (ui16)(total_prefix | 
-                               (total_suffix << 3) |
-                               (u0_suffix_len << 7) |
-                               (u0 << 10) |
-                               (u1 << 13));
         }
         else if (mode == 4) // both u_off are 1, and MEL event is 1
         {
-          ui32 d0 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
-          vlc >>= d0 & 0x3;          // Consume bits
-          ui32 d1 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          ui32 d0 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          vlc >>= d0 & 0x3;               // Consume bits
+          ui32 d1 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
 
           ui32 total_prefix = (d0 & 0x3) + (d1 & 0x3);
           ui32 u0_suffix_len = (d0 >> 2) & 0x7;
@@ -275,12 +262,9 @@ namespace ojph {
           ui32 u0 = (d0 >> 5) + 2;
           ui32 u1 = (d1 >> 5) + 2;
 
-          uvlc_tbl0[i] = (ui16)(total_prefix | 
-                               (total_suffix << 3) |
-                               (u0_suffix_len << 7) |
-                               (u0 << 10) |
-                               (u1 << 13));
-          uvlc_bias[i] = 10; // 0b10 for u0 and 0b10 for u1
+          t.tbl0[i] = uvlc_entry(total_prefix, total_suffix, u0_suffix_len,
+                                 u0, u1);
+          t.bias[i] = 10; // 0b10 for u0 and 0b10 for u1
         }
       }
 
@@ -290,10 +274,10 @@ namespace ojph {
         ui32 vlc = i & 0x3F;
 
         if (mode == 0)       // both u_off are 0
-          uvlc_tbl1[i] = 0;
+          t.tbl1[i] = 0;
         else if (mode <= 2)  // u_off are either 01 or 10
         {
-          ui32 d = dec[vlc & 0x7];   // look at the 3 LSB bits
+          ui32 d = uvlc_dec[vlc & 0x7];   // look at the 3 LSB bits
 
           ui32 total_prefix = d & 0x3;
           ui32 total_suffix = (d >> 2) & 0x7;
@@ -301,17 +285,14 @@ namespace ojph {
           ui32 u0 = (mode == 1) ? (d >> 5) : 0;
           ui32 u1 = (mode == 1) ? 0 : (d >> 5);
 
-          uvlc_tbl1[i] = (ui16)(total_prefix | 
-                               (total_suffix << 3) |
-                               (u0_suffix_len << 7) |
-                               (u0 << 10) |
-                               (u1 << 13));
+          t.tbl1[i] = uvlc_entry(total_prefix, total_suffix, u0_suffix_len,
+                                 u0, u1);
         }
         else if (mode == 3) // both u_off are 1
         {
-          ui32 d0 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
-          vlc >>= d0 & 0x3;          // Consume bits
-          ui32 d1 = dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          ui32 d0 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
+          vlc >>= d0 & 0x3;               // Consume bits
+          ui32 d1 = uvlc_dec[vlc & 0x7];  // LSBs of VLC are prefix codeword
 
           ui32 total_prefix = (d0 & 0x3) + (d1 & 0x3);
           ui32 u0_suffix_len = (d0 >> 2) & 0x7;
@@ -319,27 +300,23 @@ namespace ojph {
           ui32 u0 = d0 >> 5;
           ui32 u1 = d1 >> 5;
 
-          uvlc_tbl1[i] = (ui16)(total_prefix | 
-                               (total_suffix << 3) |
-                               (u0_suffix_len << 7) |
-                               (u0 << 10) |
-                               (u1 << 13));
+          t.tbl1[i] = uvlc_entry(total_prefix, total_suffix, u0_suffix_len,
+                                 u0, u1);
         }
       }
-      return true;
+      return t;
     }
 
-    //************************************************************************/
-    /** @ingroup vlc_decoding_tables_grp
-     *  @brief Initializes VLC tables vlc_tbl0 and vlc_tbl1
-     */
-    static bool vlc_tables_initialized = vlc_init_tables();
+    static constexpr uvlc_tables uvlc_decoding_tables = uvlc_init_tables();
 
-    //************************************************************************/
-    /** @ingroup uvlc_decoding_tables_grp
-     *  @brief Initializes UVLC tables uvlc_tbl0 and uvlc_tbl1
-     */
-    static bool uvlc_tables_initialized = uvlc_init_tables();
+    /// @brief uvlc_tbl0 contains decoding information for initial row of quads
+    const ui16 (&uvlc_tbl0)[256+64] = uvlc_decoding_tables.tbl0;
+    /// @brief uvlc_tbl1 contains decoding information for non-initial row of 
+    ///        quads
+    const ui16 (&uvlc_tbl1)[256] = uvlc_decoding_tables.tbl1;
+    /// @brief uvlc_bias contains decoding info. for initial row of quads
+    const ui8 (&uvlc_bias)[256+64] = uvlc_decoding_tables.bias;
+    /// @}
 
   } // !namespace local
 } // !namespace ojph
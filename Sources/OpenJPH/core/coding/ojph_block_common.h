@@ -40,10 +40,11 @@
 namespace ojph{
   namespace local {
     
-    extern ui16 vlc_tbl0[1024];
-    extern ui16 vlc_tbl1[1024];
-    extern ui16 uvlc_tbl0[256+64];
-    extern ui16 uvlc_tbl1[256];
-    extern ui8 uvlc_bias[256+64];
+    // computed at compile time, so that no decode waits for them
+    extern const ui16 (&vlc_tbl0)[1024];
+    extern const ui16 (&vlc_tbl1)[1024];
+    extern const ui16 (&uvlc_tbl0)[256+64];
+    extern const ui16 (&uvlc_tbl1)[256];
+    extern const ui8 (&uvlc_bias)[256+64];
   } // !namespace local
 } // !namespace ojph
@@ -71,12 +71,72 @@ namespace ojph {
         ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
         ui32 width, ui32 height, ui32 stride, bool stripe_causal);
 
+    bool
+      ojph_decode_codeblock64_avx2(ui8* coded_data, ui64* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
+    // NEON-accelerated decoder
+    bool
+      ojph_decode_codeblock_neon(ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
+    bool
+      ojph_decode_codeblock64_neon(ui8* coded_data, ui64* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
+        ui32 width, ui32 height, ui32 stride, bool stripe_causal);
+
     // WASM SIMD-accelerated decoder
     bool
       ojph_decode_codeblock_wasm(ui8* coded_data, ui32* decoded_data,
         ui32 missing_msbs, ui32 num_passes, ui32 lengths1, ui32 lengths2,
         ui32 width, ui32 height, ui32 stride, bool stripe_causal);
 
+    //////////////////////////////////////////////////////////////////////////
+    // JPEG 2000 Part-1 (EBCOT) codeblocks, used when the codeblock style of
+    // COD/COC does not select HT coding
+
+    // Part-1 codeblock style flags, as found in SPcod/SPcoc
+    enum : ui32 {
+      PART1_BYPASS  = 0x01,  // selective arithmetic coding bypass
+      PART1_RESET   = 0x02,  // reset context probabilities on each pass
+      PART1_TERMALL = 0x04,  // termination on each coding pass
+      PART1_VCAUSAL = 0x08,  // vertically causal context
+      PART1_SEGMARK = 0x20,  // segmentation symbols
+    };
+
+    // the codeword segment that carries coding pass pass_idx, counting from
+    // the first cleanup pass; with neither TERMALL nor BYPASS, all passes
+    // share one segment
+    static inline
+    ui32 part1_segment_of_pass(ui32 pass_idx, ui32 block_style)
+    {
+      if (block_style & PART1_TERMALL)
+        return pass_idx;
+      if ((block_style & PART1_BYPASS) == 0 || pass_idx < 10)
+        return 0;
+      // after the first 10 passes, SigProp and MagRef of a bitplane share
+      // a raw segment, while cleanup has a segment of its own
+      ui32 t = pass_idx - 10;
+      return 1 + 2 * (t / 3) + (t % 3 == 2 ? 1 : 0);
+    }
+
+    // decodes num_passes coding passes; seg_lengths holds the length of each
+    // codeword segment, the segments being stored back to back in
+    // coded_data.  band_num is 0 for LL, 1 for HL, 2 for LH, and 3 for HH
+    bool
+      ojph_decode_part1_codeblock32(const ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, const ui32* seg_lengths,
+        ui32 band_num, ui32 block_style,
+        ui32 width, ui32 height, ui32 stride);
+
+    bool
+      ojph_decode_part1_codeblock64(const ui8* coded_data, ui64* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, const ui32* seg_lengths,
+        ui32 band_num, ui32 block_style,
+        ui32 width, ui32 height, ui32 stride);
+
   }
 }
 
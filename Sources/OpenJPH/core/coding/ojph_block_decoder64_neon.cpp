@@ -0,0 +1,333 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_decoder64_neon.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_decoder64_neon.cpp
+ *  @brief implements a faster 64-bit HTJ2K block decoder using NEON
+ */
+
+#include "ojph_arch.h"
+#if defined(OJPH_ENABLE_NEON)
+
+#include <string>
+#include <iostream>
+
+#include <cassert>
+#include <cstring>
+#include <arm_neon.h>
+#include "ojph_block_common.h"
+#include "ojph_block_decoder.h"
+#include "ojph_block_decoder_local.h"
+#include "ojph_message.h"
+
+namespace ojph {
+  namespace local {
+
+    //************************************************************************/
+    /** @brief Unstuffs the MagSgn bitstream ahead of decoding
+     *
+     *  The unstuffed bits are stored contiguously, LSB first, so that the
+     *  bits of any sample can be found from its bit position alone.  Once
+     *  the bitstream is exhausted, it reads as 1s, as frwd_fetch64<0xFF>
+     *  of the generic decoder does.
+     *
+     *  @param [in]  data is a pointer to the MagSgn bitstream
+     *  @param [in]  size is the number of bytes to unstuff
+     *  @param [out] dst receives the unstuffed bits; it must have room for
+     *               (8 * size + 31) / 32 + 13 values
+     *  @return the number of bits in dst that come from the bitstream
+     */
+    static inline
+    ui32 magsgn_unstuff(const ui8* data, ui32 size, ui32* dst)
+    {
+      ui64 tmp = 0;
+      ui32 bits = 0;
+      ui32 unstuff = 0;
+      ui32* dp = dst;
+      for (; size >= 4; size -= 4, data += 4)
+      {
+        ui32 val;
+        memcpy(&val, data, 4);
+        // no unstuffing is needed if none of the 4 bytes is 0xFF
+        if (unstuff == 0 &&
+            ((~val - 0x01010101u) & val & 0x80808080u) == 0)
+        {
+          tmp |= (ui64)val << bits;
+          bits += 32;
+        }
+        else
+          for (int i = 0; i < 4; ++i)
+          {
+            ui32 v = data[i];
+            tmp |= (ui64)v << bits;
+            bits += 8 - unstuff;
+            unstuff = (v == 0xFF);
+          }
+        if (bits >= 32)
+        {
+          *dp++ = (ui32)tmp;
+          tmp >>= 32;
+          bits -= 32;
+        }
+      }
+      for (; size > 0; --size)
+      {
+        ui32 v = *data++;
+        tmp |= (ui64)v << bits;
+        bits += 8 - unstuff;
+        unstuff = (v == 0xFF);
+      }
+      if (bits >= 32)
+      {
+        *dp++ = (ui32)tmp;
+        tmp >>= 32;
+        bits -= 32;
+      }
+      ui32 total = (ui32)(dp - dst) * 32 + bits;
+
+      tmp |= ~(ui64)0 << bits; // an exhausted bitstream reads as 1s
+      *dp++ = (ui32)tmp;
+      for (int i = 0; i < 12; ++i)
+        *dp++ = 0xFFFFFFFFu;
+      return total;
+    }
+
+    //************************************************************************/
+    /** @brief Decodes the MagSgn bits of one quad
+     *
+     *  The number of bits of each sample is found in the lanes of one
+     *  vector, in the order of the bits of inf: top-left, bottom-left,
+     *  top-right, then bottom-right, from U_q and e_k; their exclusive
+     *  prefix sum gives the bit position of each sample in the MagSgn
+     *  bitstream.  A sample can have more bits than the 57 that one
+     *  unaligned 64-bit load is sure to hold, so two words are loaded at
+     *  the byte holding each position, and funnel-shifted into place.
+     *  The samples are then formed in two 64-bit vectors, one per column.
+     *
+     *  @param [in]  ms is the unstuffed MagSgn bitstream
+     *  @param [in]  pos is the bit position of the quad; it is advanced
+     *  @param [in]  end is the number of bits of the bitstream
+     *  @param [in]  inf is the inf entry of the quad
+     *  @param [in]  U_q is the exponent bound of the quad
+     *  @param [in]  p is the least significant bitplane of the cleanup pass
+     *  @param [out] v_n receives v_n of the samples, used for kappa of the
+     *               next quad row
+     *  @return the decoded samples of the left and the right column
+     */
+    static inline
+    uint64x2x2_t decode_one_quad(const ui8* ms, ui32& pos, ui32 end,
+                                 ui32 inf, ui32 U_q, ui32 p,
+                                 uint64x2x2_t& v_n)
+    {
+      const ui32 sig_bits[4] = { 0x10, 0x20, 0x40, 0x80 };
+      const si32 e_1_shift[4] = { -8, -9, -10, -11 };
+      const si32 e_k_shift[4] = { -12, -13, -14, -15 };
+      const uint32x4_t one = vdupq_n_u32(1);
+      const uint32x4_t zero = vdupq_n_u32(0);
+      const uint64x2_t one64 = vdupq_n_u64(1);
+
+      uint32x4_t vinf = vdupq_n_u32(inf);
+      uint32x4_t sig = vtstq_u32(vinf, vld1q_u32(sig_bits));
+      uint32x4_t e_1 = vandq_u32(vshlq_u32(vinf, vld1q_s32(e_1_shift)), one);
+      uint32x4_t e_k = vandq_u32(vshlq_u32(vinf, vld1q_s32(e_k_shift)), one);
+
+      // m_n, the number of bits of each sample, and their positions
+      uint32x4_t m_n = vandq_u32(vsubq_u32(vdupq_n_u32(U_q), e_k), sig);
+      uint32x4_t ofs = vextq_u32(zero, m_n, 3);
+      ofs = vaddq_u32(ofs, vextq_u32(zero, ofs, 3));
+      ofs = vaddq_u32(ofs, vextq_u32(zero, ofs, 2));
+      ofs = vminq_u32(vaddq_u32(ofs, vdupq_n_u32(pos)), vdupq_n_u32(end));
+      pos += vaddvq_u32(m_n);
+
+      // two words from the byte holding each position
+      ui32 at[4];
+      vst1q_u32(at, ofs);
+      ui64 w[8];
+      for (int i = 0; i < 4; ++i)
+        memcpy(w + 2 * i, ms + (at[i] >> 3), 16);
+      uint64x2x2_t words0 = vld2q_u64(w);     // first words, then second
+      uint64x2x2_t words1 = vld2q_u64(w + 4); // words, of two samples each
+
+      uint64x2x2_t samples;
+      for (int c = 0; c < 2; ++c)
+      {
+        uint64x2x2_t &words = c == 0 ? words0 : words1;
+        uint32x2_t c_ofs = c == 0 ? vget_low_u32(ofs) : vget_high_u32(ofs);
+        uint32x2_t c_m_n = c == 0 ? vget_low_u32(m_n) : vget_high_u32(m_n);
+        uint32x2_t c_e_1 = c == 0 ? vget_low_u32(e_1) : vget_high_u32(e_1);
+        uint32x2_t c_sig = c == 0 ? vget_low_u32(sig) : vget_high_u32(sig);
+
+        // a shift of 64 gives 0, so the second word adds nothing to
+        // byte-aligned samples
+        int64x2_t shift = vreinterpretq_s64_u64(
+          vmovl_u32(vand_u32(c_ofs, vdup_n_u32(7))));
+        uint64x2_t ms_val = vorrq_u64(
+          vshlq_u64(words.val[0], vnegq_s64(shift)),
+          vshlq_u64(words.val[1], vsubq_s64(vdupq_n_s64(64), shift)));
+
+        // the sign bit, then m_n magnitude bits, with e_1 as the MSB and
+        // the center of the bin
+        int64x2_t sm_n = vreinterpretq_s64_u64(vmovl_u32(c_m_n));
+        uint64x2_t sig64 = vreinterpretq_u64_s64(
+          vmovl_s32(vreinterpret_s32_u32(c_sig)));
+        uint64x2_t val = vshlq_n_u64(ms_val, 63);
+        uint64x2_t mask = vsubq_u64(vshlq_u64(one64, sm_n), one64);
+        uint64x2_t v = vandq_u64(ms_val, mask);
+        v = vorrq_u64(v, vshlq_u64(vmovl_u32(c_e_1), sm_n));
+        v = vorrq_u64(v, one64);
+        //v_n now has 2 * (\mu - 1) + 0.5 with correct sign bit
+        //add 2 to make it 2*\mu+0.5, shift it up to missing MSBs
+        val = vorrq_u64(val, vshlq_u64(vaddq_u64(v, vdupq_n_u64(2)),
+                                       vdupq_n_s64((si64)p - 1)));
+        v_n.val[c] = vandq_u64(v, sig64);
+        samples.val[c] = vandq_u64(val, sig64);
+      }
+      return samples;
+    }
+
+    //************************************************************************/
+    /** @brief Decodes one codeblock, processing the cleanup, siginificance
+     *         propagation, and magnitude refinement pass
+     *
+     *  @param [in]   coded_data is a pointer to bitstream
+     *  @param [in]   decoded_data is a pointer to decoded codeblock data buf.
+     *  @param [in]   missing_msbs is the number of missing MSBs
+     *  @param [in]   num_passes is the number of passes: 1 if CUP only,
+     *                2 for CUP+SPP, and 3 for CUP+SPP+MRP
+     *  @param [in]   lengths1 is the length of cleanup pass
+     *  @param [in]   lengths2 is the length of refinement passes (either SPP
+     *                only or SPP+MRP)
+     *  @param [in]   width is the decoded codeblock width 
+     *  @param [in]   height is the decoded codeblock height
+     *  @param [in]   stride is the decoded codeblock buffer stride 
+     *  @param [in]   stripe_causal is true for stripe causal mode
+     */
+    bool ojph_decode_codeblock64_neon(ui8* coded_data, ui64* decoded_data,
+                                      ui32 missing_msbs, ui32 num_passes,
+                                      ui32 lengths1, ui32 lengths2,
+                                      ui32 width, ui32 height, ui32 stride,
+                                      bool stripe_causal)
+    {
+      int lcup, scup;
+      if (!check_codeblock64(coded_data, missing_msbs, num_passes,
+                             lengths1, lengths2, lcup, scup))
+        return false;
+      ui32 p = 62 - missing_msbs; // The least significant bitplane for CUP
+      // There is a way to handle the case of p == 0, but a different path
+      // is required
+
+      // inf and u_q of each quad; see decode_vlc_mel64
+      ui16 scratch[8 * 513] = {0};       // 8 kB
+      ui32 sstr = ((width + 2u) + 7u) & ~7u; // multiples of 8
+      ui32 mmsbp2 = missing_msbs + 2;
+
+      // step 1 decoding VLC and MEL segments
+      decode_vlc_mel64(coded_data, lcup, scup, scratch, sstr, width, height);
+
+      // step2 we decode magsgn
+      {
+        // We allocate a scratch row for storing v_n values.
+        // We have 512 quads horizontally.
+        // We need an extra entry to handle the case of vp[1]
+        // when vp is at the last column.
+        // Here, we allocate 4 instead of 1 to make the buffer size
+        // a multipled of 16 bytes.
+        const int v_n_size = 512 + 4;
+        ui64 v_n_scratch[v_n_size] = {0};  // 4+ kB
+
+        // Each sample consumes at most mmsbp2 bits, and each byte of the
+        // bitstream gives at least 7 bits; there is no need to unstuff
+        // more bytes than can be consumed.  A 4096-sample codeblock with
+        // 63 bits per sample needs no more than 9217 + 13 entries.
+        ui32 magsgn_buf[9232]; // 36 kB
+        ui32 ms_size = (ui32)(lcup - scup);
+        ui32 max_bytes = (mmsbp2 * width * height) / 7 + 2;
+        ms_size = ojph_min(ms_size, max_bytes);
+        ui32 ms_end = magsgn_unstuff(coded_data, ms_size, magsgn_buf);
+        const ui8* ms = (const ui8*)magsgn_buf;
+        ui32 ms_pos = 0;
+
+        // The samples of a quad are written as two rows of 2 samples; a
+        // right column beyond the width of the codeblock is insignificant,
+        // and is written as 0, within the stride of the codeblock.
+        for (ui32 y = 0; y < height; y += 2)
+        {
+          const ui16 *sp = scratch + (y >> 1) * sstr;
+          ui64 *vp = v_n_scratch;
+          ui64 *dp = decoded_data + y * stride;
+
+          ui64 prev_v_n = 0;
+          for (ui32 x = 0; x < width; x += 2, sp += 2, ++vp, dp += 2)
+          {
+            ui32 inf = sp[0];
+            ui32 U_q = sp[1];
+            if (y > 0)
+            {
+              ui32 gamma = inf & 0xF0; gamma &= gamma - 0x10; //is gamma_q 1?
+              ui32 emax = 63 - count_leading_zeros(2 | vp[0] | vp[1]);
+              U_q += gamma ? emax : 1; // emax is emax - 1
+            }
+            if (U_q > mmsbp2)
+              return false;
+            if (x + 1 >= width)
+              inf &= ~0xC0u;
+
+            uint64x2x2_t v_n;
+            uint64x2x2_t q = decode_one_quad(ms, ms_pos, ms_end, inf, U_q,
+                                             p, v_n);
+            // each column holds a top and a bottom sample
+            vst1q_u64(dp, vzip1q_u64(q.val[0], q.val[1]));
+            vst1q_u64(dp + stride, vzip2q_u64(q.val[0], q.val[1]));
+
+            // v_n of the bottom row, shared by horizontally adjacent quads
+            vp[0] = prev_v_n | vgetq_lane_u64(v_n.val[0], 1);
+            prev_v_n = vgetq_lane_u64(v_n.val[1], 1);
+          }
+          vp[0] = prev_v_n;
+        }
+      }
+
+      if (num_passes > 1)
+        decode_sigprop_magref64(coded_data, decoded_data, num_passes,
+                                lengths1, lengths2, p, scratch, sstr,
+                                width, height, stride, stripe_causal);
+      return true;
+    }
+  }
+}
+
+#endif // OJPH_ENABLE_NEON
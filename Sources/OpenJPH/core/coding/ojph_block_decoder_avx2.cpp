@@ -0,0 +1,365 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_decoder_avx2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_decoder_avx2.cpp
+ *  @brief implements a faster HTJ2K block decoder using AVX2
+ */
+
+#include "ojph_arch.h"
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <string>
+#include <iostream>
+
+#include <cassert>
+#include <cstring>
+#include <immintrin.h>
+#include "ojph_block_common.h"
+#include "ojph_block_decoder.h"
+#include "ojph_block_decoder_local.h"
+#include "ojph_message.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //************************************************************************/
+    /** @brief Unstuffs the MagSgn bitstream into a plain bit-packed buffer
+     *
+     *  The AVX2 quad decoder reads the bits of four samples at once from
+     *  arbitrary bit positions, which is only possible once the stuffing
+     *  bits are removed.  Unstuffing follows frwd_read exactly, including
+     *  OR-ing the MSB of a byte following 0xFF into the next bit; the
+     *  bitstream is followed by 1s, as if 0xFF were fed in, and by at least
+     *  32 bytes of padding, so that a quad can read past the end.
+     *
+     *  @param [in]  data is a pointer to the MagSgn bitstream
+     *  @param [in]  size is the number of bytes to unstuff
+     *  @param [out] dst receives the unstuffed bits; it must have room for
+     *               (8 * size + 31) / 32 + 12 values
+     *  @return the number of bits in dst that come from the bitstream
+     */
+    static inline
+    ui32 magsgn_unstuff(const ui8* data, ui32 size, ui32* dst)
+    {
+      ui64 tmp = 0;
+      ui32 bits = 0;
+      ui32 unstuff = 0;
+      ui32* dp = dst;
+      for (; size >= 4; size -= 4, data += 4)
+      {
+        ui32 val;
+        memcpy(&val, data, 4);
+        // no unstuffing is needed if none of the 4 bytes is 0xFF
+        if (unstuff == 0 &&
+            ((~val - 0x01010101u) & val & 0x80808080u) == 0)
+        {
+          tmp |= (ui64)val << bits;
+          bits += 32;
+        }
+        else
+          for (int i = 0; i < 4; ++i)
+          {
+            ui32 v = data[i];
+            tmp |= (ui64)v << bits;
+            bits += 8 - unstuff;
+            unstuff = (v == 0xFF);
+          }
+        if (bits >= 32)
+        {
+          *dp++ = (ui32)tmp;
+          tmp >>= 32;
+          bits -= 32;
+        }
+      }
+      for (; size > 0; --size)
+      {
+        ui32 v = *data++;
+        tmp |= (ui64)v << bits;
+        bits += 8 - unstuff;
+        unstuff = (v == 0xFF);
+      }
+      if (bits >= 32)
+      {
+        *dp++ = (ui32)tmp;
+        tmp >>= 32;
+        bits -= 32;
+      }
+      ui32 total = (ui32)(dp - dst) * 32 + bits;
+
+      tmp |= ~(ui64)0 << bits; // an exhausted bitstream reads as 1s
+      *dp++ = (ui32)tmp;
+      for (int i = 0; i < 12; ++i)
+        *dp++ = 0xFFFFFFFFu;
+      return total;
+    }
+
+    //************************************************************************/
+    /** @brief Decodes the MagSgn bits of one quad pair
+     *
+     *  The eight samples are handled in the lanes of one vector; each quad
+     *  takes four lanes, in the order of the bits of inf: top-left,
+     *  bottom-left, top-right, then bottom-right.  The number of bits of
+     *  each sample is found from U_q and e_k, and their exclusive prefix
+     *  sum over both quads gives the bit position of each sample in the
+     *  MagSgn bitstream.  The 64 bits starting at the byte holding each
+     *  position are gathered, and shifted into place.
+     *
+     *  @param [in]  ms is the unstuffed MagSgn bitstream
+     *  @param [in]  pos is the bit position of the pair; it is advanced
+     *  @param [in]  end is the number of bits of the bitstream
+     *  @param [in]  inf0 is the inf entry of the first quad
+     *  @param [in]  inf1 is the inf entry of the second quad
+     *  @param [in]  U_q0 is the exponent bound of the first quad
+     *  @param [in]  U_q1 is the exponent bound of the second quad
+     *  @param [in]  p is the least significant bitplane of the cleanup pass
+     *  @param [out] v_n receives v_n of the samples, used for kappa of the
+     *               next quad row
+     *  @return the decoded samples
+     */
+    static inline
+    __m256i decode_quad_pair(const ui8* ms, ui32& pos, ui32 end,
+                             ui32 inf0, ui32 inf1, ui32 U_q0, ui32 U_q1,
+                             ui32 p, __m256i& v_n)
+    {
+      const __m256i one = _mm256_set1_epi32(1);
+
+      __m256i vinf = _mm256_setr_epi32((si32)inf0, (si32)inf0, (si32)inf0,
+        (si32)inf0, (si32)inf1, (si32)inf1, (si32)inf1, (si32)inf1);
+      __m256i vU_q = _mm256_setr_epi32((si32)U_q0, (si32)U_q0, (si32)U_q0,
+        (si32)U_q0, (si32)U_q1, (si32)U_q1, (si32)U_q1, (si32)U_q1);
+      __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 0, 1, 2, 3);
+      __m256i sig = _mm256_and_si256(_mm256_srlv_epi32(vinf,
+        _mm256_add_epi32(idx, _mm256_set1_epi32(4))), one);
+      sig = _mm256_cmpeq_epi32(sig, one);
+      __m256i e_1 = _mm256_and_si256(_mm256_srlv_epi32(vinf,
+        _mm256_add_epi32(idx, _mm256_set1_epi32(8))), one);
+      __m256i e_k = _mm256_and_si256(_mm256_srlv_epi32(vinf,
+        _mm256_add_epi32(idx, _mm256_set1_epi32(12))), one);
+
+      // m_n, the number of bits of each sample, and their positions; the
+      // prefix sum is formed within each half, and the lower half's total
+      // is then added to the upper half
+      __m256i m_n = _mm256_and_si256(_mm256_sub_epi32(vU_q, e_k), sig);
+      __m256i ofs = _mm256_add_epi32(m_n, _mm256_slli_si256(m_n, 4));
+      ofs = _mm256_add_epi32(ofs, _mm256_slli_si256(ofs, 8));
+      __m256i low_total = _mm256_permutevar8x32_epi32(ofs,
+        _mm256_set1_epi32(3));
+      ofs = _mm256_add_epi32(ofs, _mm256_blend_epi32(
+        _mm256_setzero_si256(), low_total, 0xF0));
+      ofs = _mm256_sub_epi32(ofs, m_n); // exclusive
+      ofs = _mm256_add_epi32(ofs, _mm256_set1_epi32((si32)pos));
+      __m128i hi = _mm256_extracti128_si256(_mm256_add_epi32(ofs, m_n), 1);
+      pos = (ui32)_mm_extract_epi32(hi, 3);
+      ofs = _mm256_min_epu32(ofs, _mm256_set1_epi32((si32)end));
+
+      // gather the 8 bytes that start with the byte holding each position
+      __m256i byte_ofs = _mm256_srli_epi32(ofs, 3);
+      __m256i w_lo = _mm256_i32gather_epi64((const long long*)ms,
+        _mm256_castsi256_si128(byte_ofs), 1);
+      __m256i w_hi = _mm256_i32gather_epi64((const long long*)ms,
+        _mm256_extracti128_si256(byte_ofs, 1), 1);
+
+      // shift out the bits before each sample, and keep the lower halves
+      __m256i shift = _mm256_and_si256(ofs, _mm256_set1_epi32(7));
+      w_lo = _mm256_srlv_epi64(w_lo,
+        _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shift)));
+      w_hi = _mm256_srlv_epi64(w_hi,
+        _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shift, 1)));
+      __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+      w_lo = _mm256_permutevar8x32_epi32(w_lo, even);
+      w_hi = _mm256_permutevar8x32_epi32(w_hi, even);
+      __m256i ms_val = _mm256_blend_epi32(w_lo, w_hi, 0xF0);
+
+      // the sign bit, then m_n magnitude bits, with e_1 as the MSB and
+      // the center of the bin
+      __m256i val = _mm256_slli_epi32(ms_val, 31);
+      __m256i mask = _mm256_sub_epi32(_mm256_sllv_epi32(one, m_n), one);
+      __m256i v = _mm256_and_si256(ms_val, mask);
+      v = _mm256_or_si256(v, _mm256_sllv_epi32(e_1, m_n));
+      v = _mm256_or_si256(v, one);
+      //v_n now has 2 * (\mu - 1) + 0.5 with correct sign bit
+      //add 2 to make it 2*\mu+0.5, shift it up to missing MSBs
+      __m256i t = _mm256_add_epi32(v, _mm256_set1_epi32(2));
+      val = _mm256_or_si256(val,
+        _mm256_sll_epi32(t, _mm_cvtsi32_si128((si32)p - 1)));
+      v_n = _mm256_and_si256(v, sig);
+      return _mm256_and_si256(val, sig);
+    }
+
+    //************************************************************************/
+    /** @brief Decodes one codeblock, processing the cleanup, siginificance
+     *         propagation, and magnitude refinement pass
+     *
+     *  @param [in]   coded_data is a pointer to bitstream
+     *  @param [in]   decoded_data is a pointer to decoded codeblock data buf.
+     *  @param [in]   missing_msbs is the number of missing MSBs
+     *  @param [in]   num_passes is the number of passes: 1 if CUP only,
+     *                2 for CUP+SPP, and 3 for CUP+SPP+MRP
+     *  @param [in]   lengths1 is the length of cleanup pass
+     *  @param [in]   lengths2 is the length of refinement passes (either SPP
+     *                only or SPP+MRP)
+     *  @param [in]   width is the decoded codeblock width 
+     *  @param [in]   height is the decoded codeblock height
+     *  @param [in]   stride is the decoded codeblock buffer stride 
+     *  @param [in]   stripe_causal is true for stripe causal mode
+     */
+    bool ojph_decode_codeblock_avx2(ui8* coded_data, ui32* decoded_data,
+                                    ui32 missing_msbs, ui32 num_passes,
+                                    ui32 lengths1, ui32 lengths2,
+                                    ui32 width, ui32 height, ui32 stride,
+                                    bool stripe_causal)
+    {
+      int lcup, scup;
+      if (!check_codeblock32(coded_data, missing_msbs, num_passes,
+                             lengths1, lengths2, lcup, scup))
+        return false;
+      ui32 p = 30 - missing_msbs; // The least significant bitplane for CUP
+      // There is a way to handle the case of p == 0, but a different path
+      // is required
+
+      // inf and u_q of each quad; see decode_vlc_mel32
+      ui16 scratch[8 * 513] = {0};       // 8 kB
+      ui32 sstr = ((width + 2u) + 7u) & ~7u; // multiples of 8
+      ui32 mmsbp2 = missing_msbs + 2;
+
+      // step 1 decoding VLC and MEL segments
+      decode_vlc_mel32(coded_data, lcup, scup, scratch, sstr, width, height);
+
+      // step2 we decode magsgn
+      {
+        // We allocate a scratch row for storing v_n values.
+        // We have 512 quads horizontally.
+        // We need an extra entry to handle the case of vp[1]
+        // when vp is at the last column.
+        // Here, we allocate 4 instead of 1 to make the buffer size
+        // a multipled of 16 bytes.
+        const int v_n_size = 512 + 4;
+        ui32 v_n_scratch[v_n_size] = {0};  // 2+ kB
+
+        // Each sample consumes at most mmsbp2 bits, and each byte of the
+        // bitstream gives at least 7 bits; there is no need to unstuff
+        // more bytes than can be consumed.  A 4096-sample codeblock with
+        // 31 bits per sample needs no more than 4537 + 13 entries.
+        ui32 magsgn_buf[4560]; // 18 kB
+        ui32 ms_size = (ui32)(lcup - scup);
+        ui32 max_bytes = (mmsbp2 * width * height) / 7 + 2;
+        ms_size = ojph_min(ms_size, max_bytes);
+        ui32 ms_end = magsgn_unstuff(coded_data, ms_size, magsgn_buf);
+        const ui8* ms = (const ui8*)magsgn_buf;
+        ui32 ms_pos = 0;
+
+        // Both quads of a quad pair are decoded together, and the samples
+        // of the pair are then written as two rows of 4 samples.  Samples
+        // beyond the width of the codeblock are insignificant, and are
+        // written as 0, within the stride of the codeblock.
+        for (ui32 y = 0; y < height; y += 2)
+        {
+          ui16 *sp = scratch + (y >> 1) * sstr;
+          ui32 *vp = v_n_scratch;
+          ui32 *dp = decoded_data + y * stride;
+
+          ui32 prev_v_n = 0;
+          for (ui32 x = 0; x < width; x += 4, sp += 4, vp += 2, dp += 4)
+          {
+            ui32 inf0 = sp[0], inf1 = sp[2];
+            ui32 U_q0 = sp[1], U_q1 = sp[3];
+            if (y > 0)
+            {
+              ui32 gamma = inf0 & 0xF0; gamma &= gamma - 0x10;
+              ui32 emax = vp[0] | vp[1];
+              emax = 31 - count_leading_zeros(emax | 2); // emax - 1
+              U_q0 += gamma ? emax : 1;
+
+              gamma = inf1 & 0xF0; gamma &= gamma - 0x10;
+              emax = vp[1] | vp[2];
+              emax = 31 - count_leading_zeros(emax | 2); // emax - 1
+              U_q1 += gamma ? emax : 1;
+            }
+
+            // the right column of a quad is not decoded when it is outside
+            // the codeblock; the second quad is not decoded at all
+            if (x + 1 >= width)
+              inf0 &= ~0xC0u;
+            if (U_q0 > mmsbp2)
+              return false;
+            if (x + 2 >= width)
+              inf1 = 0;
+            else {
+              if (x + 3 >= width)
+                inf1 &= ~0xC0u;
+              if (U_q1 > mmsbp2)
+                return false;
+            }
+
+            __m256i v_n;
+            __m256i q = decode_quad_pair(ms, ms_pos, ms_end, inf0, inf1,
+                                         U_q0, U_q1, p, v_n);
+            // top row from the even lanes, bottom row from the odd lanes
+            const __m256i rows = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+            q = _mm256_permutevar8x32_epi32(q, rows);
+            _mm_storeu_si128((__m128i*)dp, _mm256_castsi256_si128(q));
+            _mm_storeu_si128((__m128i*)(dp + stride),
+                             _mm256_extracti128_si256(q, 1));
+
+            // v_n of the bottom row, shared by horizontally adjacent quads
+            __m128i b = _mm256_extracti128_si256(
+              _mm256_permutevar8x32_epi32(v_n, rows), 1);
+            vp[0] = prev_v_n | (ui32)_mm_cvtsi128_si32(b);
+            vp[1] = (ui32)(_mm_extract_epi32(b, 1) | _mm_extract_epi32(b, 2));
+            prev_v_n = (ui32)_mm_extract_epi32(b, 3);
+          }
+          vp[0] = prev_v_n;
+        }
+      }
+
+      if (num_passes > 1)
+        decode_sigprop_magref32(coded_data, decoded_data, num_passes,
+                                lengths1, lengths2, p, scratch, sstr,
+                                width, height, stride, stripe_causal);
+      return true;
+    }
+  }
+}
+
+OJPH_TARGET_END
+
+#endif // !OJPH_DISABLE_AVX2
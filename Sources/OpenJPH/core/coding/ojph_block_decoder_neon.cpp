@@ -0,0 +1,350 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_decoder_neon.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_decoder_neon.cpp
+ *  @brief implements a faster HTJ2K block decoder using NEON
+ */
+
+#include "ojph_arch.h"
+#if defined(OJPH_ENABLE_NEON)
+
+#include <string>
+#include <iostream>
+
+#include <cassert>
+#include <cstring>
+#include <arm_neon.h>
+#include "ojph_block_common.h"
+#include "ojph_block_decoder.h"
+#include "ojph_block_decoder_local.h"
+#include "ojph_message.h"
+
+namespace ojph {
+  namespace local {
+
+    //************************************************************************/
+    /** @brief Unstuffs the MagSgn bitstream into a plain bit-packed buffer
+     *
+     *  The NEON quad decoder reads the bits of four samples at once from
+     *  arbitrary bit positions, which is only possible once the stuffing
+     *  bits are removed.  Unstuffing follows frwd_read exactly, including
+     *  OR-ing the MSB of a byte following 0xFF into the next bit; the
+     *  bitstream is followed by 1s, as if 0xFF were fed in, and by at least
+     *  32 bytes of padding, so that a quad can read past the end.
+     *
+     *  @param [in]  data is a pointer to the MagSgn bitstream
+     *  @param [in]  size is the number of bytes to unstuff
+     *  @param [out] dst receives the unstuffed bits; it must have room for
+     *               (8 * size + 31) / 32 + 12 values
+     *  @return the number of bits in dst that come from the bitstream
+     */
+    static inline
+    ui32 magsgn_unstuff(const ui8* data, ui32 size, ui32* dst)
+    {
+      ui64 tmp = 0;
+      ui32 bits = 0;
+      ui32 unstuff = 0;
+      ui32* dp = dst;
+      for (; size >= 4; size -= 4, data += 4)
+      {
+        ui32 val;
+        memcpy(&val, data, 4);
+        // no unstuffing is needed if none of the 4 bytes is 0xFF
+        if (unstuff == 0 &&
+            ((~val - 0x01010101u) & val & 0x80808080u) == 0)
+        {
+          tmp |= (ui64)val << bits;
+          bits += 32;
+        }
+        else
+          for (int i = 0; i < 4; ++i)
+          {
+            ui32 v = data[i];
+            tmp |= (ui64)v << bits;
+            bits += 8 - unstuff;
+            unstuff = (v == 0xFF);
+          }
+        if (bits >= 32)
+        {
+          *dp++ = (ui32)tmp;
+          tmp >>= 32;
+          bits -= 32;
+        }
+      }
+      for (; size > 0; --size)
+      {
+        ui32 v = *data++;
+        tmp |= (ui64)v << bits;
+        bits += 8 - unstuff;
+        unstuff = (v == 0xFF);
+      }
+      if (bits >= 32)
+      {
+        *dp++ = (ui32)tmp;
+        tmp >>= 32;
+        bits -= 32;
+      }
+      ui32 total = (ui32)(dp - dst) * 32 + bits;
+
+      tmp |= ~(ui64)0 << bits; // an exhausted bitstream reads as 1s
+      *dp++ = (ui32)tmp;
+      for (int i = 0; i < 12; ++i)
+        *dp++ = 0xFFFFFFFFu;
+      return total;
+    }
+
+    //************************************************************************/
+    /** @brief Decodes the MagSgn bits of one quad
+     *
+     *  The four samples are handled in the lanes of one vector, in the
+     *  order of the bits of inf: top-left, bottom-left, top-right, then
+     *  bottom-right.  The number of bits of each sample is found from
+     *  U_q and e_k, and their exclusive prefix sum gives the bit position
+     *  of each sample in the MagSgn bitstream.  The bytes holding these
+     *  bits are gathered with a table lookup into two 64-bit lanes per pair
+     *  of samples, and shifted into place.
+     *
+     *  @param [in]  ms is the unstuffed MagSgn bitstream
+     *  @param [in]  pos is the bit position of the quad; it is advanced
+     *  @param [in]  end is the number of bits of the bitstream
+     *  @param [in]  inf is the inf entry of the quad
+     *  @param [in]  U_q is the exponent bound of the quad
+     *  @param [in]  p is the least significant bitplane of the cleanup pass
+     *  @param [out] v_n receives v_n of the samples, used for kappa of the
+     *               next quad row
+     *  @return the decoded samples
+     */
+    static inline
+    uint32x4_t decode_one_quad(const ui8* ms, ui32& pos, ui32 end,
+                               ui32 inf, ui32 U_q, ui32 p, uint32x4_t& v_n)
+    {
+      const ui32 sig_bits[4] = { 0x10, 0x20, 0x40, 0x80 };
+      const si32 e_1_shift[4] = { -8, -9, -10, -11 };
+      const si32 e_k_shift[4] = { -12, -13, -14, -15 };
+      const ui8 ramp[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+      const uint32x4_t one = vdupq_n_u32(1);
+      const uint32x4_t zero = vdupq_n_u32(0);
+
+      uint32x4_t vinf = vdupq_n_u32(inf);
+      uint32x4_t sig = vtstq_u32(vinf, vld1q_u32(sig_bits));
+      uint32x4_t e_1 = vandq_u32(vshlq_u32(vinf, vld1q_s32(e_1_shift)), one);
+      uint32x4_t e_k = vandq_u32(vshlq_u32(vinf, vld1q_s32(e_k_shift)), one);
+
+      // m_n, the number of bits of each sample, and their positions
+      uint32x4_t m_n = vandq_u32(vsubq_u32(vdupq_n_u32(U_q), e_k), sig);
+      uint32x4_t ofs = vextq_u32(zero, m_n, 3);
+      ofs = vaddq_u32(ofs, vextq_u32(zero, ofs, 3));
+      ofs = vaddq_u32(ofs, vextq_u32(zero, ofs, 2));
+      ofs = vminq_u32(vaddq_u32(ofs, vdupq_n_u32(pos)), vdupq_n_u32(end));
+      pos += vaddvq_u32(m_n);
+
+      // gather 8 bytes for each sample, from a 32-byte window; the samples
+      // of a quad span at most 93 + 7 bits, so 13 + 8 bytes are enough
+      ui32 base = vgetq_lane_u32(ofs, 0) >> 3;
+      uint8x16x2_t window;
+      window.val[0] = vld1q_u8(ms + base);
+      window.val[1] = vld1q_u8(ms + base + 16);
+      uint32x4_t rel = vsubq_u32(vshrq_n_u32(ofs, 3), vdupq_n_u32(base));
+      uint16x4_t rel16 = vmovn_u32(rel);
+      uint8x8_t rel8 = vmovn_u16(vcombine_u16(rel16, rel16));
+      uint8x16_t idx_lo = vcombine_u8(vdup_lane_u8(rel8, 0),
+                                      vdup_lane_u8(rel8, 1));
+      uint8x16_t idx_hi = vcombine_u8(vdup_lane_u8(rel8, 2),
+                                      vdup_lane_u8(rel8, 3));
+      uint8x16_t vramp = vld1q_u8(ramp);
+      uint64x2_t w_lo = 
+        vreinterpretq_u64_u8(vqtbl2q_u8(window, vaddq_u8(idx_lo, vramp)));
+      uint64x2_t w_hi = 
+        vreinterpretq_u64_u8(vqtbl2q_u8(window, vaddq_u8(idx_hi, vramp)));
+
+      // shift out the bits before each sample
+      int32x4_t shift = vnegq_s32(vreinterpretq_s32_u32(
+        vandq_u32(ofs, vdupq_n_u32(7))));
+      w_lo = vshlq_u64(w_lo, vmovl_s32(vget_low_s32(shift)));
+      w_hi = vshlq_u64(w_hi, vmovl_s32(vget_high_s32(shift)));
+      uint32x4_t ms_val = vcombine_u32(vmovn_u64(w_lo), vmovn_u64(w_hi));
+
+      // the sign bit, then m_n magnitude bits, with e_1 as the MSB and
+      // the center of the bin
+      int32x4_t sm_n = vreinterpretq_s32_u32(m_n);
+      uint32x4_t val = vshlq_n_u32(ms_val, 31);
+      uint32x4_t mask = vsubq_u32(vshlq_u32(one, sm_n), one);
+      uint32x4_t v = vandq_u32(ms_val, mask);
+      v = vorrq_u32(v, vshlq_u32(e_1, sm_n));
+      v = vorrq_u32(v, one);
+      //v_n now has 2 * (\mu - 1) + 0.5 with correct sign bit
+      //add 2 to make it 2*\mu+0.5, shift it up to missing MSBs
+      val = vorrq_u32(val, vshlq_u32(vaddq_u32(v, vdupq_n_u32(2)),
+                                     vdupq_n_s32((si32)p - 1)));
+      v_n = vandq_u32(v, sig);
+      return vandq_u32(val, sig);
+    }
+    //************************************************************************/
+    /** @brief Decodes one codeblock, processing the cleanup, siginificance
+     *         propagation, and magnitude refinement pass
+     *
+     *  @param [in]   coded_data is a pointer to bitstream
+     *  @param [in]   decoded_data is a pointer to decoded codeblock data buf.
+     *  @param [in]   missing_msbs is the number of missing MSBs
+     *  @param [in]   num_passes is the number of passes: 1 if CUP only,
+     *                2 for CUP+SPP, and 3 for CUP+SPP+MRP
+     *  @param [in]   lengths1 is the length of cleanup pass
+     *  @param [in]   lengths2 is the length of refinement passes (either SPP
+     *                only or SPP+MRP)
+     *  @param [in]   width is the decoded codeblock width 
+     *  @param [in]   height is the decoded codeblock height
+     *  @param [in]   stride is the decoded codeblock buffer stride 
+     *  @param [in]   stripe_causal is true for stripe causal mode
+     */
+    bool ojph_decode_codeblock_neon(ui8* coded_data, ui32* decoded_data,
+                                    ui32 missing_msbs, ui32 num_passes,
+                                    ui32 lengths1, ui32 lengths2,
+                                    ui32 width, ui32 height, ui32 stride,
+                                    bool stripe_causal)
+    {
+      int lcup, scup;
+      if (!check_codeblock32(coded_data, missing_msbs, num_passes,
+                             lengths1, lengths2, lcup, scup))
+        return false;
+      ui32 p = 30 - missing_msbs; // The least significant bitplane for CUP
+      // There is a way to handle the case of p == 0, but a different path
+      // is required
+
+      // inf and u_q of each quad; see decode_vlc_mel32
+      ui16 scratch[8 * 513] = {0};       // 8 kB
+      ui32 sstr = ((width + 2u) + 7u) & ~7u; // multiples of 8
+      ui32 mmsbp2 = missing_msbs + 2;
+
+      // step 1 decoding VLC and MEL segments
+      decode_vlc_mel32(coded_data, lcup, scup, scratch, sstr, width, height);
+
+      // step2 we decode magsgn
+      {
+        // We allocate a scratch row for storing v_n values.
+        // We have 512 quads horizontally.
+        // We need an extra entry to handle the case of vp[1]
+        // when vp is at the last column.
+        // Here, we allocate 4 instead of 1 to make the buffer size
+        // a multipled of 16 bytes.
+        const int v_n_size = 512 + 4;
+        ui32 v_n_scratch[v_n_size] = {0};  // 2+ kB
+
+        // Each sample consumes at most mmsbp2 bits, and each byte of the
+        // bitstream gives at least 7 bits; there is no need to unstuff
+        // more bytes than can be consumed.  A 4096-sample codeblock with
+        // 31 bits per sample needs no more than 4537 + 13 entries.
+        ui32 magsgn_buf[4560]; // 18 kB
+        ui32 ms_size = (ui32)(lcup - scup);
+        ui32 max_bytes = (mmsbp2 * width * height) / 7 + 2;
+        ms_size = ojph_min(ms_size, max_bytes);
+        ui32 ms_end = magsgn_unstuff(coded_data, ms_size, magsgn_buf);
+        const ui8* ms = (const ui8*)magsgn_buf;
+        ui32 ms_pos = 0;
+
+        // The quads of a quad pair are decoded one after the other, since
+        // the bit position of the second depends on the first; the samples
+        // of the pair are then written as two rows of 4 samples.  Samples
+        // beyond the width of the codeblock are insignificant, and are
+        // written as 0, within the stride of the codeblock.
+        for (ui32 y = 0; y < height; y += 2)
+        {
+          ui16 *sp = scratch + (y >> 1) * sstr;
+          ui32 *vp = v_n_scratch;
+          ui32 *dp = decoded_data + y * stride;
+
+          ui32 prev_v_n = 0;
+          for (ui32 x = 0; x < width; x += 4, sp += 4, vp += 2, dp += 4)
+          {
+            ui32 inf0 = sp[0], inf1 = sp[2];
+            ui32 U_q0 = sp[1], U_q1 = sp[3];
+            if (y > 0)
+            {
+              ui32 gamma = inf0 & 0xF0; gamma &= gamma - 0x10;
+              ui32 emax = vp[0] | vp[1];
+              emax = 31 - count_leading_zeros(emax | 2); // emax - 1
+              U_q0 += gamma ? emax : 1;
+
+              gamma = inf1 & 0xF0; gamma &= gamma - 0x10;
+              emax = vp[1] | vp[2];
+              emax = 31 - count_leading_zeros(emax | 2); // emax - 1
+              U_q1 += gamma ? emax : 1;
+            }
+
+            // the right column of a quad is not decoded when it is outside
+            // the codeblock; the second quad is not decoded at all
+            if (x + 1 >= width)
+              inf0 &= ~0xC0u;
+            if (U_q0 > mmsbp2)
+              return false;
+            if (x + 2 >= width)
+              inf1 = 0;
+            else {
+              if (x + 3 >= width)
+                inf1 &= ~0xC0u;
+              if (U_q1 > mmsbp2)
+                return false;
+            }
+
+            uint32x4_t v_n0, v_n1;
+            uint32x4_t q0 =
+              decode_one_quad(ms, ms_pos, ms_end, inf0, U_q0, p, v_n0);
+            uint32x4_t q1 =
+              decode_one_quad(ms, ms_pos, ms_end, inf1, U_q1, p, v_n1);
+            vst1q_u32(dp, vuzp1q_u32(q0, q1));
+            vst1q_u32(dp + stride, vuzp2q_u32(q0, q1));
+
+            // v_n of the bottom row, shared by horizontally adjacent quads
+            vp[0] = prev_v_n | vgetq_lane_u32(v_n0, 1);
+            vp[1] = vgetq_lane_u32(v_n0, 3) | vgetq_lane_u32(v_n1, 1);
+            prev_v_n = vgetq_lane_u32(v_n1, 3);
+          }
+          vp[0] = prev_v_n;
+        }
+      }
+
+      if (num_passes > 1)
+        decode_sigprop_magref32(coded_data, decoded_data, num_passes,
+                                lengths1, lengths2, p, scratch, sstr,
+                                width, height, stride, stripe_causal);
+      return true;
+    }
+  }
+}
+
+#endif // OJPH_ENABLE_NEON
@@ -0,0 +1,589 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_decoder_part1.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_decoder_part1.cpp
+ *  @brief implements a JPEG 2000 Part-1 (EBCOT) block decoder
+ */
+
+#include <cassert>
+#include <cstring>
+#include "ojph_block_decoder.h"
+
+namespace ojph {
+  namespace local {
+
+    //************************************************************************/
+    /** @brief MQ coder probability states, two for each row of the Qe table
+     *         of the standard, one per MPS value
+     */
+    struct mq_state
+    {
+      ui16 qe;        //!<probability estimate of the LPS
+      ui8 mps;        //!<the more probable symbol
+      ui8 nmps, nlps; //!<next state, after coding an MPS or an LPS
+    };
+
+
+    //************************************************************************/
+    /** @brief contexts of the block coder, and their initial states
+     */
+    enum : ui32 {
+      CTX_ZC = 0,     //!<9 zero coding contexts
+      CTX_SC = 9,     //!<5 sign coding contexts
+      CTX_MR = 14,    //!<3 magnitude refinement contexts
+      CTX_RL = 17,    //!<run-length context
+      CTX_UNI = 18,   //!<uniform context
+      NUM_CTXS = 19
+    };
+
+    //************************************************************************/
+    /** @brief state flags of a sample; the 8 neighbour significance bits
+     *         come first, with the horizontal and vertical neighbours in the
+     *         lower 4 bits
+     */
+    enum : ui32 {
+      SIG_N  = 0x0001, SIG_W  = 0x0002, SIG_E  = 0x0004, SIG_S  = 0x0008,
+      SIG_NW = 0x0010, SIG_NE = 0x0020, SIG_SW = 0x0040, SIG_SE = 0x0080,
+      NEG_N  = 0x0100, NEG_W  = 0x0200, NEG_E  = 0x0400, NEG_S  = 0x0800,
+      SIG     = 0x1000, //!<the sample is significant
+      VISITED = 0x2000, //!<coded by the SigProp pass of this bitplane
+      REFINED = 0x4000, //!<refined at least once
+      NBRS    = 0x00FF, //!<significance of the neighbours
+      NEXT_STRIPE = SIG_SW | SIG_S | SIG_SE | NEG_S //!<hidden by VCAUSAL
+    };
+
+    // (width + 2) * (height + 2) for the largest codeblock, 1024 x 4
+    static const ui32 max_flags = 1026 * 6;
+
+    //************************************************************************/
+    /** @brief zero coding context for the LL, LH, and, with h and v
+     *         swapped, HL subbands, from the number of significant
+     *         horizontal, vertical, and diagonal neighbours
+     */
+    static constexpr ui8 zc_context(ui32 h, ui32 v, ui32 d)
+    {
+      if (h == 2)
+        return 8;
+      if (h == 1)
+        return v ? 7 : (d ? 6 : 5);
+      if (v)
+        return v == 2 ? 4 : 3;
+      return d >= 2 ? 2 : (ui8)d;
+    }
+
+    //************************************************************************/
+    /** @brief zero coding context for the HH subband
+     */
+    static constexpr ui8 zc_context_hh(ui32 hv, ui32 d)
+    {
+      if (d >= 3)
+        return 8;
+      if (d == 2)
+        return hv ? 7 : 6;
+      if (d == 1)
+        return hv >= 2 ? 5 : (hv ? 4 : 3);
+      return hv >= 2 ? 2 : (ui8)hv;
+    }
+
+    //************************************************************************/
+    /** @brief the Qe table of the standard, with the next state indices
+     *         after an MPS and after an LPS
+     */
+    static constexpr ui16 mq_qe[47] = {
+      0x5601, 0x3401, 0x1801, 0x0AC1, 0x0521, 0x0221, 0x5601, 0x5401,
+      0x4801, 0x3801, 0x3001, 0x2401, 0x1C01, 0x1601, 0x5601, 0x5401,
+      0x5101, 0x4801, 0x3801, 0x3401, 0x3001, 0x2801, 0x2401, 0x2201,
+      0x1C01, 0x1801, 0x1601, 0x1401, 0x1201, 0x1101, 0x0AC1, 0x09C1,
+      0x08A1, 0x0521, 0x0441, 0x02A1, 0x0221, 0x0141, 0x0111, 0x0085,
+      0x0049, 0x0025, 0x0015, 0x0009, 0x0005, 0x0001, 0x5601 };
+    static constexpr ui8 mq_nmps[47] = {
+       1,  2,  3,  4,  5, 38,  7,  8,  9, 10, 11, 12, 13, 29, 15, 16,
+      17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32,
+      33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 45, 46 };
+    static constexpr ui8 mq_nlps[47] = {
+       1,  6,  9, 12, 29, 33,  6, 14, 14, 14, 17, 18, 20, 21, 14, 14,
+      15, 16, 17, 18, 19, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29,
+      30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 46 };
+
+    //************************************************************************/
+    /** @brief the MQ states and the context tables, computed by the
+     *         compiler
+     */
+    struct part1_tables
+    {
+      mq_state mq[47 * 2]; //!<MQ states, indexed by 2 * state + MPS
+      ui8 zc[4][256];      //!<zero coding context, per subband
+      ui8 sc[256];         //!<sign coding context, XOR bit in bit 7
+    };
+
+    static constexpr part1_tables part1_init_tables()
+    {
+      part1_tables t = {};
+      for (ui32 i = 0; i < 47; ++i)
+        for (ui32 m = 0; m < 2; ++m)
+        {
+          // states 0, 6, and 14 switch the MPS on an LPS
+          bool switch_mps = (i == 0 || i == 6 || i == 14);
+          mq_state& s = t.mq[2 * i + m];
+          s.qe = mq_qe[i];
+          s.mps = (ui8)m;
+          s.nmps = (ui8)(2 * mq_nmps[i] + m);
+          s.nlps = (ui8)(2 * mq_nlps[i] + (switch_mps ? 1 - m : m));
+        }
+
+      for (ui32 f = 0; f < 256; ++f)
+      {
+        ui32 h = ((f & SIG_W) != 0) + ((f & SIG_E) != 0);
+        ui32 v = ((f & SIG_N) != 0) + ((f & SIG_S) != 0);
+        ui32 d = ((f & SIG_NW) != 0) + ((f & SIG_NE) != 0)
+               + ((f & SIG_SW) != 0) + ((f & SIG_SE) != 0);
+        t.zc[0][f] = t.zc[2][f] = zc_context(h, v, d); // LL and LH
+        t.zc[1][f] = zc_context(v, h, d);                 // HL
+        t.zc[3][f] = zc_context_hh(h + v, d);             // HH
+      }
+
+      // the index holds the significance of the N, W, E, and S neighbours
+      // in bits 0 to 3, and their signs in bits 4 to 7
+      for (ui32 i = 0; i < 256; ++i)
+      {
+        int n = (i & 1) ? ((i & 0x10) ? -1 : 1) : 0;
+        int w = (i & 2) ? ((i & 0x20) ? -1 : 1) : 0;
+        int e = (i & 4) ? ((i & 0x40) ? -1 : 1) : 0;
+        int s = (i & 8) ? ((i & 0x80) ? -1 : 1) : 0;
+        int h = ojph_max(-1, ojph_min(1, w + e));
+        int v = ojph_max(-1, ojph_min(1, n + s));
+        ui32 ctx = 0, flip = 0;
+        if (h == 0) {
+          ctx = CTX_SC + (ui32)(v < 0 ? -v : v);
+          flip = v < 0;
+        }
+        else {
+          ctx = (ui32)((int)CTX_SC + 3 + h * v);
+          flip = h < 0;
+        }
+        t.sc[i] = (ui8)(ctx | (flip << 7));
+      }
+      return t;
+    }
+
+    static constexpr part1_tables part1_decoding_tables = part1_init_tables();
+    static constexpr const mq_state (&mq_states)[47 * 2] =
+      part1_decoding_tables.mq;
+    static constexpr const ui8 (&zc_ctx)[4][256] = part1_decoding_tables.zc;
+    static constexpr const ui8 (&sc_ctx)[256] = part1_decoding_tables.sc;
+
+    //************************************************************************/
+    /** @brief MQ arithmetic decoder of one codeword segment; reading
+     *         beyond the segment produces 0xFF bytes, as the standard
+     *         requires
+     */
+    struct mq_decoder
+    {
+      void init(const ui8* data, ui32 length)
+      {
+        this->data = data;
+        this->length = length;
+        pos = 0;
+        c = byte_at(0) << 16;
+        bytein();
+        c <<= 7;
+        ct -= 7;
+        a = 0x8000;
+      }
+
+      ui32 byte_at(ui32 i) const { return i < length ? data[i] : 0xFFu; }
+
+      void bytein()
+      {
+        if (byte_at(pos) == 0xFF)
+        {
+          ui32 b = byte_at(pos + 1);
+          if (b > 0x8F)   // a marker, or the end of the segment
+          { c += 0xFF00; ct = 8; }
+          else
+          { ++pos; c += b << 9; ct = 7; }
+        }
+        else
+        { ++pos; c += byte_at(pos) << 8; ct = 8; }
+      }
+
+      ui32 decode(ui8& cx)
+      {
+        const mq_state& s = mq_states[cx];
+        ui32 qe = s.qe, d;
+        a -= qe;
+        if ((c >> 16) < qe)
+        { // LPS exchange
+          if (a < qe)
+          { d = s.mps; cx = s.nmps; }
+          else
+          { d = 1u - s.mps; cx = s.nlps; }
+          a = qe;
+        }
+        else
+        {
+          c -= qe << 16;
+          if (a & 0x8000)
+            return s.mps;
+          // MPS exchange
+          if (a < qe)
+          { d = 1u - s.mps; cx = s.nlps; }
+          else
+          { d = s.mps; cx = s.nmps; }
+        }
+        do {
+          if (ct == 0)
+            bytein();
+          a <<= 1;
+          c <<= 1;
+          --ct;
+        } while ((a & 0x8000) == 0);
+        return d;
+      }
+
+      const ui8* data;
+      ui32 length, pos;
+      ui32 a, c, ct;
+    };
+
+    //************************************************************************/
+    /** @brief reads the raw (bypassed) bits of one codeword segment
+     */
+    struct raw_decoder
+    {
+      void init(const ui8* data, ui32 length)
+      {
+        this->data = data;
+        this->length = length;
+        pos = c = ct = 0;
+      }
+
+      ui32 decode()
+      {
+        if (ct == 0)
+        {
+          ui32 b = pos < length ? data[pos] : 0xFFu;
+          if (c == 0xFF)
+          { // the byte after 0xFF carries 7 bits, unless it is a marker
+            if (b > 0x8F)
+            { c = 0xFF; ct = 8; }
+            else
+            { c = b; ++pos; ct = 7; }
+          }
+          else
+          { c = b; ++pos; ct = 8; }
+        }
+        --ct;
+        return (c >> ct) & 1;
+      }
+
+      const ui8* data;
+      ui32 length, pos;
+      ui32 c, ct;
+    };
+
+    //************************************************************************/
+    /** @brief the state of the codeblock being decoded, and its coding
+     *         passes
+     *
+     *  Samples are stored in sign and magnitude, the sign in the MSB.  A
+     *  sample that becomes significant in bitplane p also gets the bit of
+     *  p - 1, which places it in the middle of its uncertainty interval;
+     *  refinement replaces that bit, and sets the one below.
+     */
+    template <typename T>
+    struct part1_block
+    {
+      static const T sign_bit = (T)1 << (sizeof(T) * 8 - 1);
+
+      void reset_contexts()
+      {
+        memset(ctxs, 0, sizeof(ctxs));
+        ctxs[CTX_ZC] = 4 * 2;
+        ctxs[CTX_RL] = 3 * 2;
+        ctxs[CTX_UNI] = 46 * 2;
+      }
+
+      // flags of a sample for context formation
+      ui32 context_flags(const ui16* fp, ui32 row) const
+      {
+        ui32 f = *fp;
+        if (vcausal && row == 3)
+          f &= ~(ui32)NEXT_STRIPE;
+        return f;
+      }
+
+      // makes a sample significant and informs its neighbours
+      void set_significant(ui16* fp, T* dp, ui32 neg, T val)
+      {
+        *dp = (neg ? sign_bit : 0) | val;
+        ui16 *np = fp - fstride, *sp = fp + fstride;
+        np[-1] |= SIG_SE;
+        np[0]  |= neg ? (SIG_S | NEG_S) : SIG_S;
+        np[1]  |= SIG_SW;
+        fp[-1] |= neg ? (SIG_E | NEG_E) : SIG_E;
+        fp[0]  |= SIG;
+        fp[1]  |= neg ? (SIG_W | NEG_W) : SIG_W;
+        sp[-1] |= SIG_NE;
+        sp[0]  |= neg ? (SIG_N | NEG_N) : SIG_N;
+        sp[1]  |= SIG_NW;
+      }
+
+      ui32 decode_sign(mq_decoder& mq, ui32 f)
+      {
+        ui32 t = sc_ctx[(f & 0xF) | ((f >> 4) & 0xF0)];
+        return mq.decode(ctxs[t & 0x7F]) ^ (t >> 7);
+      }
+
+      // significance propagation pass
+      template <bool RAW>
+      void sigprop(mq_decoder& mq, raw_decoder& raw, T val)
+      {
+        for (ui32 y0 = 0; y0 < height; y0 += 4)
+        {
+          ui32 rows = ojph_min(4u, height - y0);
+          for (ui32 x = 0; x < width; ++x)
+          {
+            ui16* fp = flags + (y0 + 1) * fstride + x + 1;
+            T* dp = data + y0 * stride + x;
+            for (ui32 r = 0; r < rows; ++r, fp += fstride, dp += stride)
+            {
+              ui32 f = context_flags(fp, r);
+              if ((f & SIG) || (f & NBRS) == 0)
+                continue;
+              ui32 bit = RAW ? raw.decode() : mq.decode(ctxs[zc[f & NBRS]]);
+              if (bit)
+              {
+                ui32 neg = RAW ? raw.decode() : decode_sign(mq, f);
+                set_significant(fp, dp, neg, val);
+              }
+              *fp |= VISITED;
+            }
+          }
+        }
+      }
+
+      // magnitude refinement pass
+      template <bool RAW>
+      void magref(mq_decoder& mq, raw_decoder& raw, T one, T half)
+      {
+        for (ui32 y0 = 0; y0 < height; y0 += 4)
+        {
+          ui32 rows = ojph_min(4u, height - y0);
+          for (ui32 x = 0; x < width; ++x)
+          {
+            ui16* fp = flags + (y0 + 1) * fstride + x + 1;
+            T* dp = data + y0 * stride + x;
+            for (ui32 r = 0; r < rows; ++r, fp += fstride, dp += stride)
+            {
+              ui32 f = context_flags(fp, r);
+              if ((f & (SIG | VISITED)) != SIG)
+                continue;
+              ui32 bit;
+              if (RAW)
+                bit = raw.decode();
+              else
+              {
+                ui32 cx = (f & REFINED) ? CTX_MR + 2
+                        : ((f & NBRS) ? CTX_MR + 1 : CTX_MR);
+                bit = mq.decode(ctxs[cx]);
+              }
+              *dp = (T)((*dp & ~one) | (bit ? one : 0) | half);
+              *fp |= REFINED;
+            }
+          }
+        }
+      }
+
+      // cleanup pass; it also clears VISITED for the next bitplane
+      void cleanup(mq_decoder& mq, T val)
+      {
+        for (ui32 y0 = 0; y0 < height; y0 += 4)
+        {
+          ui32 rows = ojph_min(4u, height - y0);
+          for (ui32 x = 0; x < width; ++x)
+          {
+            ui16* fp = flags + (y0 + 1) * fstride + x + 1;
+            T* dp = data + y0 * stride + x;
+            ui32 r = 0;
+            if (rows == 4)
+            {
+              ui32 t = fp[0] | fp[fstride] | fp[2 * fstride]
+                     | context_flags(fp + 3 * fstride, 3);
+              if ((t & (SIG | VISITED | NBRS)) == 0)
+              { // run-length mode
+                if (mq.decode(ctxs[CTX_RL]) == 0)
+                  continue;
+                r = mq.decode(ctxs[CTX_UNI]) << 1;
+                r |= mq.decode(ctxs[CTX_UNI]);
+                fp += r * fstride;
+                dp += r * stride;
+                ui32 neg = decode_sign(mq, context_flags(fp, r));
+                set_significant(fp, dp, neg, val);
+                ++r; fp += fstride; dp += stride;
+              }
+            }
+            for (; r < rows; ++r, fp += fstride, dp += stride)
+            {
+              ui32 f = context_flags(fp, r);
+              if ((f & (SIG | VISITED)) == 0 &&
+                  mq.decode(ctxs[zc[f & NBRS]]))
+              {
+                ui32 neg = decode_sign(mq, f);
+                set_significant(fp, dp, neg, val);
+              }
+              *fp &= (ui16)~VISITED;
+            }
+          }
+        }
+      }
+
+      T* data;
+      ui32 width, height, stride;
+      ui16* flags;
+      ui32 fstride;
+      const ui8* zc;
+      bool vcausal;
+      ui8 ctxs[NUM_CTXS];
+    };
+
+    //************************************************************************/
+    template <typename T>
+    static bool decode_part1(const ui8* coded_data, T* decoded_data,
+                             ui32 missing_msbs, ui32 num_passes,
+                             const ui32* seg_lengths, ui32 band_num,
+                             ui32 block_style, ui32 width, ui32 height,
+                             ui32 stride)
+    {
+      // the bitplane of the first cleanup pass; the MSB holds the sign
+      int top = (int)(sizeof(T) * 8) - 2 - (int)missing_msbs;
+      int num_planes = (int)(num_passes + 2) / 3;
+      if (num_passes == 0 || top + 1 < num_planes || band_num > 3)
+        return false;
+      if ((width + 2) * (height + 2) > max_flags)
+        return false;
+
+      ui16 flags[max_flags];
+      part1_block<T> cb;
+      cb.data = decoded_data;
+      cb.width = width;
+      cb.height = height;
+      cb.stride = stride;
+      cb.flags = flags;
+      cb.fstride = width + 2;
+      cb.zc = zc_ctx[band_num];
+      cb.vcausal = (block_style & PART1_VCAUSAL) != 0;
+      cb.reset_contexts();
+      memset(flags, 0, sizeof(ui16) * (width + 2) * (height + 2));
+      for (ui32 y = 0; y < height; ++y)
+        memset(decoded_data + y * stride, 0, sizeof(T) * width);
+
+      mq_decoder mq;
+      raw_decoder raw;
+      mq.init(NULL, 0);
+      raw.init(NULL, 0);
+      ui32 seg = 0, seg_offset = 0;
+      for (ui32 k = 0; k < num_passes; ++k)
+      {
+        ui32 pass = k == 0 ? 2 : (k - 1) % 3; // SigProp, MagRef, Cleanup
+        int p = top - (int)((k + 2) / 3);
+        bool raw_pass = (block_style & PART1_BYPASS) && k >= 10 && pass != 2;
+
+        ui32 s = part1_segment_of_pass(k, block_style);
+        if (k == 0 || s != seg)
+        { // a codeword segment starts
+          for (; seg < s; ++seg)
+            seg_offset += seg_lengths[seg];
+          if (raw_pass)
+            raw.init(coded_data + seg_offset, seg_lengths[s]);
+          else
+            mq.init(coded_data + seg_offset, seg_lengths[s]);
+        }
+        if (k > 0 && (block_style & PART1_RESET))
+          cb.reset_contexts();
+
+        T one = (T)1 << p, half = one >> 1;
+        if (pass == 0)
+        {
+          if (raw_pass)
+            cb.template sigprop<true>(mq, raw, one | half);
+          else
+            cb.template sigprop<false>(mq, raw, one | half);
+        }
+        else if (pass == 1)
+        {
+          if (raw_pass)
+            cb.template magref<true>(mq, raw, one, half);
+          else
+            cb.template magref<false>(mq, raw, one, half);
+        }
+        else
+        {
+          cb.cleanup(mq, one | half);
+          if (block_style & PART1_SEGMARK)
+            for (int i = 0; i < 4; ++i) // 1010, not checked
+              mq.decode(cb.ctxs[CTX_UNI]);
+        }
+      }
+      return true;
+    }
+
+    //************************************************************************/
+    bool
+      ojph_decode_part1_codeblock32(const ui8* coded_data, ui32* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, const ui32* seg_lengths,
+        ui32 band_num, ui32 block_style,
+        ui32 width, ui32 height, ui32 stride)
+    {
+      return decode_part1<ui32>(coded_data, decoded_data, missing_msbs,
+        num_passes, seg_lengths, band_num, block_style, width, height,
+        stride);
+    }
+
+    //************************************************************************/
+    bool
+      ojph_decode_part1_codeblock64(const ui8* coded_data, ui64* decoded_data,
+        ui32 missing_msbs, ui32 num_passes, const ui32* seg_lengths,
+        ui32 band_num, ui32 block_style,
+        ui32 width, ui32 height, ui32 stride)
+    {
+      return decode_part1<ui64>(coded_data, decoded_data, missing_msbs,
+        num_passes, seg_lengths, band_num, block_style, width, height,
+        stride);
+    }
+
+  }
+}
@@ -57,214 +57,116 @@ namespace ojph {
     // tables
     /////////////////////////////////////////////////////////////////////////
 
-    //VLC encoding
-    // index is (c_q << 8) + (rho << 4) + eps
-    // data is  (cwd << 8) + (cwd_len << 4) + eps
-    // table 0 is for the initial line of quads
-    static ui16 vlc_tbl0[2048] = { 0 };
-    static ui16 vlc_tbl1[2048] = { 0 };
-
-    //UVLC encoding
-    const int num_uvlc_entries = 75;
-    struct uvlc_tbl_struct {
-      ui8 pre, pre_len, suf, suf_len, ext, ext_len;
+    struct vlc_src_table { int c_q, rho, u_off, e_k, e_1, cwd, cwd_len; };
+    static constexpr vlc_src_table vlc_src_tbl0[] = {
+    #include "table0.h"
+    };
+    static constexpr vlc_src_table vlc_src_tbl1[] = {
+    #include "table1.h"
     };
-    static uvlc_tbl_struct uvlc_tbl[num_uvlc_entries];
-    
+
     /////////////////////////////////////////////////////////////////////////
-    static bool vlc_init_tables()
+    static constexpr int vlc_popcount(int v)
     {
-      struct vlc_src_table { int c_q, rho, u_off, e_k, e_1, cwd, cwd_len; };
-      vlc_src_table tbl0[] = {
-    #include "table0.h"
-      };
-      size_t tbl0_size = sizeof(tbl0) / sizeof(vlc_src_table);
-
-      si32 pattern_popcnt[16];
-      for (ui32 i = 0; i < 16; ++i)
-        pattern_popcnt[i] = (si32)population_count(i);
+      return (v & 1) + ((v >> 1) & 1) + ((v >> 2) & 1) + ((v >> 3) & 1);
+    }
 
-      vlc_src_table* src_tbl = tbl0;
-      ui16 *tgt_tbl = vlc_tbl0;
-      size_t tbl_size = tbl0_size;
-      for (int i = 0; i < 2048; ++i)
+    /////////////////////////////////////////////////////////////////////////
+    // Fills an encoding table from the rows of table0.h or table1.h.  An
+    // entry without u_off takes the first row of its c_q and rho; an entry
+    // with u_off, the row whose e_k has the most bits set among those whose
+    // EMB pattern matches, the last of them on a tie.  Entries whose eps
+    // is not within rho, and rho 0 of c_q 0, stay 0.
+    template <size_t N>
+    static constexpr void vlc_fill_table(const vlc_src_table (&src)[N],
+                                         ui16 (&tbl)[2048])
+    {
+      int best_e_k[2048] = {};  // 1 + bits set in e_k of the entry, or 0
+      for (size_t j = 0; j < N; ++j)
       {
-        int c_q = i >> 8, rho = (i >> 4) & 0xF, emb = i & 0xF;
-        if (((emb & rho) != emb) || (rho == 0 && c_q == 0))
-          tgt_tbl[i] = 0;
-        else
+        const vlc_src_table& e = src[j];
+        if (e.rho == 0 && e.c_q == 0)
+          continue;
+        int base = (e.c_q << 8) + (e.rho << 4);
+        ui16 entry = (ui16)((e.cwd << 8) + (e.cwd_len << 4) + e.e_k);
+        if (e.u_off == 0)
         {
-          vlc_src_table *best_entry = NULL;
-          if (emb) // u_off = 1
-          {
-            int best_e_k = -1;
-            for (size_t j = 0; j < tbl_size; ++j)
-            {
-              if (src_tbl[j].c_q == c_q && src_tbl[j].rho == rho)
-                if (src_tbl[j].u_off == 1)
-                  if ((emb & src_tbl[j].e_k) == src_tbl[j].e_1)
-                  {
-                    //now we need to find the smallest cwd with the highest
-                    // number of bits set in e_k
-                    int ones_count = pattern_popcnt[src_tbl[j].e_k];
-                    if (ones_count >= best_e_k)
-                    {
-                      best_entry = src_tbl + j;
-                      best_e_k = ones_count;
-                    }
-                  }
-            }
-          }
-          else // u_off = 0
+          if (best_e_k[base] == 0)
           {
-            for (size_t j = 0; j < tbl_size; ++j)
-            {
-              if (src_tbl[j].c_q == c_q && src_tbl[j].rho == rho)
-                if (src_tbl[j].u_off == 0)
-                {
-                  best_entry = src_tbl + j;
-                  break;
-                }
-            }
+            tbl[base] = entry;
+            best_e_k[base] = 1;
           }
-          assert(best_entry);
-          tgt_tbl[i] = (ui16)((best_entry->cwd<<8) + (best_entry->cwd_len<<4)
-                             + best_entry->e_k);
+          continue;
         }
-      }
-
-      vlc_src_table tbl1[] = {
-    #include "table1.h"
-      };
-      size_t tbl1_size = sizeof(tbl1) / sizeof(vlc_src_table);
-
-      src_tbl = tbl1;
-      tgt_tbl = vlc_tbl1;
-      tbl_size = tbl1_size;
-      for (int i = 0; i < 2048; ++i)
-      {
-        int c_q = i >> 8, rho = (i >> 4) & 0xF, emb = i & 0xF;
-        if (((emb & rho) != emb) || (rho == 0 && c_q == 0))
-          tgt_tbl[i] = 0;
-        else
-        {
-          vlc_src_table *best_entry = NULL;
-          if (emb) // u_off = 1
-          {
-            int best_e_k = -1;
-            for (size_t j = 0; j < tbl_size; ++j)
-            {
-              if (src_tbl[j].c_q == c_q && src_tbl[j].rho == rho)
-                if (src_tbl[j].u_off == 1)
-                  if ((emb & src_tbl[j].e_k) == src_tbl[j].e_1)
-                  {
-                    //now we need to find the smallest cwd with the highest
-                    // number of bits set in e_k
-                    int ones_count = pattern_popcnt[src_tbl[j].e_k];
-                    if (ones_count >= best_e_k)
-                    {
-                      best_entry = src_tbl + j;
-                      best_e_k = ones_count;
-                    }
-                  }
-            }
-          }
-          else // u_off = 0
+        for (int emb = 1; emb < 16; ++emb)
+          if ((emb & e.rho) == emb && (emb & e.e_k) == e.e_1)
           {
-            for (size_t j = 0; j < tbl_size; ++j)
+            int ones_count = 1 + vlc_popcount(e.e_k);
+            if (ones_count >= best_e_k[base + emb])
             {
-              if (src_tbl[j].c_q == c_q && src_tbl[j].rho == rho)
-                if (src_tbl[j].u_off == 0)
-                {
-                  best_entry = src_tbl + j;
-                  break;
-                }
+              tbl[base + emb] = entry;
+              best_e_k[base + emb] = ones_count;
             }
           }
-          assert(best_entry);
-          tgt_tbl[i] = (ui16)((best_entry->cwd<<8) + (best_entry->cwd_len<<4)
-                             + best_entry->e_k);
-        }
       }
+    }
 
+    //VLC encoding
+    // index is (c_q << 8) + (rho << 4) + eps
+    // data is  (cwd << 8) + (cwd_len << 4) + eps
+    // table 0 is for the initial line of quads
+    struct vlc_tables { ui16 tbl0[2048]; ui16 tbl1[2048]; };
 
-      return true;
+    /////////////////////////////////////////////////////////////////////////
+    static constexpr vlc_tables vlc_init_tables()
+    {
+      vlc_tables t = {};
+      vlc_fill_table(vlc_src_tbl0, t.tbl0);
+      vlc_fill_table(vlc_src_tbl1, t.tbl1);
+      return t;
     }
 
+    // computed at compile time, so that no encode waits for them
+    static constexpr vlc_tables vlc_encoding_tables = vlc_init_tables();
+    static constexpr const ui16 (&vlc_tbl0)[2048] = vlc_encoding_tables.tbl0;
+    static constexpr const ui16 (&vlc_tbl1)[2048] = vlc_encoding_tables.tbl1;
+
+    //UVLC encoding
+    const int num_uvlc_entries = 75;
+    struct uvlc_tbl_struct {
+      ui8 pre, pre_len, suf, suf_len, ext, ext_len;
+    };
+    struct uvlc_tables { uvlc_tbl_struct tbl[num_uvlc_entries]; };
+
     /////////////////////////////////////////////////////////////////////////
-    static bool uvlc_init_tables()
+    static constexpr uvlc_tables uvlc_init_tables()
     {
       //code goes from 0 to 31, extension and 32 are not supported here
-      uvlc_tbl[0].pre = 0;
-      uvlc_tbl[0].pre_len = 0;
-      uvlc_tbl[0].suf = 0;
-      uvlc_tbl[0].suf_len = 0;
-      uvlc_tbl[0].ext = 0;
-      uvlc_tbl[0].ext_len = 0;
-
-      uvlc_tbl[1].pre = 1;
-      uvlc_tbl[1].pre_len = 1;
-      uvlc_tbl[1].suf = 0;
-      uvlc_tbl[1].suf_len = 0;
-      uvlc_tbl[1].ext = 0;
-      uvlc_tbl[1].ext_len = 0;
-
-      uvlc_tbl[2].pre = 2;
-      uvlc_tbl[2].pre_len = 2;
-      uvlc_tbl[2].suf = 0;
-      uvlc_tbl[2].suf_len = 0;
-      uvlc_tbl[2].ext = 0;
-      uvlc_tbl[2].ext_len = 0;
-
-      uvlc_tbl[3].pre = 4;
-      uvlc_tbl[3].pre_len = 3;
-      uvlc_tbl[3].suf = 0;
-      uvlc_tbl[3].suf_len = 1;
-      uvlc_tbl[3].ext = 0;
-      uvlc_tbl[3].ext_len = 0;
-
-      uvlc_tbl[4].pre = 4;
-      uvlc_tbl[4].pre_len = 3;
-      uvlc_tbl[4].suf = 1;
-      uvlc_tbl[4].suf_len = 1;
-      uvlc_tbl[4].ext = 0;
-      uvlc_tbl[4].ext_len = 0;
+      uvlc_tables t = {};
+      t.tbl[0] = { 0, 0, 0, 0, 0, 0 };
+      t.tbl[1] = { 1, 1, 0, 0, 0, 0 };
+      t.tbl[2] = { 2, 2, 0, 0, 0, 0 };
+      t.tbl[3] = { 4, 3, 0, 1, 0, 0 };
+      t.tbl[4] = { 4, 3, 1, 1, 0, 0 };
 
       for (int i = 5; i < 33; ++i)
-      {
-        uvlc_tbl[i].pre = 0;
-        uvlc_tbl[i].pre_len = 3;
-        uvlc_tbl[i].suf = (ui8)(i - 5);
-        uvlc_tbl[i].suf_len = 5;
-        uvlc_tbl[i].ext = 0;
-        uvlc_tbl[i].ext_len = 0;
-      }
+        t.tbl[i] = { 0, 3, (ui8)(i - 5), 5, 0, 0 };
 
       for (int i = 33; i < num_uvlc_entries; ++i)
-      {
-        uvlc_tbl[i].pre = 0;
-        uvlc_tbl[i].pre_len = 3;
-        uvlc_tbl[i].suf = (ui8)(28 + (i - 33) % 4);
-        uvlc_tbl[i].suf_len = 5;
-        uvlc_tbl[i].ext = (ui8)((i - 33) / 4);
-        uvlc_tbl[i].ext_len = 4;
-      }
+        t.tbl[i] = { 0, 3, (ui8)(28 + (i - 33) % 4), 5,
+                     (ui8)((i - 33) / 4), 4 };
 
-      return true;
+      return t;
     }
 
-    /////////////////////////////////////////////////////////////////////////
-    static bool tables_initialized = false;
+    static constexpr uvlc_tables uvlc_encoding_tables = uvlc_init_tables();
+    static constexpr const uvlc_tbl_struct (&uvlc_tbl)[num_uvlc_entries] =
+      uvlc_encoding_tables.tbl;
 
     /////////////////////////////////////////////////////////////////////////
     bool initialize_block_encoder_tables() {
-      if (!tables_initialized) {
-        memset(vlc_tbl0, 0, 2048 * sizeof(ui16));
-        memset(vlc_tbl1, 0, 2048 * sizeof(ui16));
-        tables_initialized = vlc_init_tables();
-        tables_initialized = tables_initialized && uvlc_init_tables();
-      }
-      return tables_initialized;
+      // the tables are computed at compile time; nothing is left to build
+      return true;
     }
 
     /////////////////////////////////////////////////////////////////////////
@@ -533,17 +435,38 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    //
-    //
-    //
-    //
-    //
+    // The encoders below read each pair of rows through a ht_prepare_quads
+    // function, the only part with SIMD variants; the coding of the quads
+    // themselves is shared.
     //////////////////////////////////////////////////////////////////////////
-    void ojph_encode_codeblock32(ui32* buf, ui32 missing_msbs, ui32 num_passes,
-                                 ui32 width, ui32 height, ui32 stride,
-                                 ui32* lengths,
-                                 ojph::mem_elastic_allocator *elastic,
-                                 ojph::coded_lists *& coded)
+    void gen_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                bool two_rows, ui32 p, ui32 *s, ui32 *e)
+    {
+      const ui32 end = (width + 3) & ~3u;
+      for (ui32 x = 0; x < end; ++x, ++sp, s += 2, e += 2)
+        for (ui32 r = 0; r < 2; ++r)
+        {
+          ui32 t = x < width && (r == 0 || two_rows) ? sp[r * stride] : 0;
+          ui32 val = t + t; //multiply by 2 and get rid of sign
+          val >>= p;  // 2 \mu_p + x
+          val &= ~1u; // 2 \mu_p
+          e[r] = s[r] = 0;
+          if (val)
+          {
+            e[r] = 32 - count_leading_zeros(--val); //2\mu_p - 1
+            s[r] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
+          }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static void
+      encode_codeblock32(ht_prepare_quads_fun32 prepare_quads,
+                         ui32* buf, ui32 missing_msbs, ui32 num_passes,
+                         ui32 width, ui32 height, ui32 stride,
+                         ui32* lengths,
+                         ojph::mem_elastic_allocator *elastic,
+                         ojph::coded_lists *& coded)
     {
       assert(num_passes == 1);
       (void)num_passes;                      //currently not used
@@ -579,68 +502,31 @@ namespace ojph {
       ui8* lep = e_val;     lep[0] = 0;
       ui8* lcxp = cx_val;   lcxp[0] = 0;
 
+      //E values and MagSgn values of a pair of rows, in the order of
+      // their quads, as prepare_quads finds them; zero for insignificant
+      // samples and for those beyond the width, up to a multiple of 4
+      ui32 quad_e[2048], quad_s[2048];
+
       //initial row of quads
-      int e_qmax[2] = {0,0}, e_q[8] = {0,0,0,0,0,0,0,0};
-      int rho[2] = {0,0};
+      int e_qmax[2], e_q[8];
+      int rho[2];
       int c_q0 = 0;
-      ui32 s[8] = {0,0,0,0,0,0,0,0}, val, t;
       ui32 y = 0;
-      ui32 *sp = buf;
+      prepare_quads(buf, stride, width, height > 1, p, quad_s, quad_e);
       for (ui32 x = 0; x < width; x += 4)
       {
-        //prepare two quads
-        t = sp[0];
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p;  // 2 \mu_p + x
-        val &= ~1u; // 2 \mu_p
-        if (val)
-        {
-          rho[0] = 1;
-          e_q[0] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = e_q[0];
-          s[0] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        t = height > 1 ? sp[stride] : 0;
-        ++sp;
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p; // 2 \mu_p + x
-        val &= ~1u;// 2 \mu_p
-        if (val)
-        {
-          rho[0] += 2;
-          e_q[1] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-          s[1] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        if (x+1 < width)
-        {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 4;
-            e_q[2] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-            s[2] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 8;
-            e_q[3] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-            s[3] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-        }
+        //two quads
+        const ui32 *s = quad_s + 2 * x;
+        for (int i = 0; i < 8; ++i)
+          e_q[i] = (int)quad_e[2 * x + i];
+        rho[0] = (e_q[0] != 0) | (e_q[1] != 0) << 1
+               | (e_q[2] != 0) << 2 | (e_q[3] != 0) << 3;
+        rho[1] = (e_q[4] != 0) | (e_q[5] != 0) << 1
+               | (e_q[6] != 0) << 2 | (e_q[7] != 0) << 3;
+        e_qmax[0] = ojph_max(ojph_max(e_q[0], e_q[1]),
+                             ojph_max(e_q[2], e_q[3]));
+        e_qmax[1] = ojph_max(ojph_max(e_q[4], e_q[5]),
+                             ojph_max(e_q[6], e_q[7]));
 
         int Uq0 = ojph_max(e_qmax[0], 1); //kappa_q = 1
         int u_q0 = Uq0 - 1, u_q1 = 0; //kappa_q = 1
@@ -675,59 +561,6 @@ namespace ojph {
 
         if (x+2 < width)
         {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[1] = 1;
-            e_q[4] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = e_q[4];
-            s[4] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[1] += 2;
-            e_q[5] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-            s[5] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x+3 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 4;
-              e_q[6] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-              s[6] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = height > 1 ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 8;
-              e_q[7] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-              s[7] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
-
           int c_q1 = (rho[0] >> 1) | (rho[0] & 1);
           int Uq1 = ojph_max(e_qmax[1], 1); //kappa_q = 1
           u_q1 = Uq1 - 1; //kappa_q = 1
@@ -786,9 +619,6 @@ namespace ojph {
 
         //prepare for next iteration
         c_q0 = (rho[1] >> 1) | (rho[1] & 1);
-        s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-        e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-        rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
       }
 
       lep[1] = 0;
@@ -802,62 +632,22 @@ namespace ojph {
         c_q0 = lcxp[0] + (lcxp[1] << 2);
         lcxp[0] = 0;
 
-        sp = buf + y * stride;
+        prepare_quads(buf + y * stride, stride, width, y + 1 < height, p,
+                      quad_s, quad_e);
         for (ui32 x = 0; x < width; x += 4)
         {
-          //prepare two quads
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] = 1;
-            e_q[0] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = e_q[0];
-            s[0] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = y + 1 < height ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1u;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 2;
-            e_q[1] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-            s[1] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x+1 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 4;
-              e_q[2] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-              s[2] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 8;
-              e_q[3] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-              s[3] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
+          //two quads
+          const ui32 *s = quad_s + 2 * x;
+          for (int i = 0; i < 8; ++i)
+            e_q[i] = (int)quad_e[2 * x + i];
+          rho[0] = (e_q[0] != 0) | (e_q[1] != 0) << 1
+                 | (e_q[2] != 0) << 2 | (e_q[3] != 0) << 3;
+          rho[1] = (e_q[4] != 0) | (e_q[5] != 0) << 1
+                 | (e_q[6] != 0) << 2 | (e_q[7] != 0) << 3;
+          e_qmax[0] = ojph_max(ojph_max(e_q[0], e_q[1]),
+                               ojph_max(e_q[2], e_q[3]));
+          e_qmax[1] = ojph_max(ojph_max(e_q[4], e_q[5]),
+                               ojph_max(e_q[6], e_q[7]));
 
           int kappa = (rho[0] & (rho[0]-1)) ? ojph_max(1,max_e) : 1;
           int Uq0 = ojph_max(e_qmax[0], kappa);
@@ -894,59 +684,6 @@ namespace ojph {
 
           if (x+2 < width)
           {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] = 1;
-              e_q[4] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = e_q[4];
-              s[4] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1u;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 2;
-              e_q[5] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-              s[5] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            if (x+3 < width)
-            {
-              t = sp[0];
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1u;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 4;
-                e_q[6] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-                s[6] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-              }
-
-              t = y + 1 < height ? sp[stride] : 0;
-              ++sp;
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1u;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 8;
-                e_q[7] = 32 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-                s[7] = --val + (t >> 31); //v_n = 2(\mu_p-1) + s_n
-              }
-            }
-
             kappa = (rho[1] & (rho[1]-1)) ? ojph_max(1,max_e) : 1;
             c_q1 |= ((rho[0] & 4) >> 1) | ((rho[0] & 8) >> 2);
             int Uq1 = ojph_max(e_qmax[1], kappa);
@@ -989,9 +726,6 @@ namespace ojph {
 
           //prepare for next iteration
           c_q0 |= ((rho[1] & 4) >> 1) | ((rho[1] & 8) >> 2);
-          s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-          e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-          rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
         }
       }
 
@@ -1017,17 +751,34 @@ namespace ojph {
     }
 
     //////////////////////////////////////////////////////////////////////////
-    //
-    //
-    //
-    //
-    //
+    void gen_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                bool two_rows, ui32 p, ui64 *s, ui64 *e)
+    {
+      const ui32 end = (width + 3) & ~3u;
+      for (ui32 x = 0; x < end; ++x, ++sp, s += 2, e += 2)
+        for (ui32 r = 0; r < 2; ++r)
+        {
+          ui64 t = x < width && (r == 0 || two_rows) ? sp[r * stride] : 0;
+          ui64 val = t + t; //multiply by 2 and get rid of sign
+          val >>= p;  // 2 \mu_p + x
+          val &= ~1ULL; // 2 \mu_p
+          e[r] = s[r] = 0;
+          if (val)
+          {
+            e[r] = 64 - count_leading_zeros(--val); //2\mu_p - 1
+            s[r] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
+          }
+        }
+    }
+
     //////////////////////////////////////////////////////////////////////////
-    void ojph_encode_codeblock64(ui64* buf, ui32 missing_msbs, ui32 num_passes,
-                                 ui32 width, ui32 height, ui32 stride,
-                                 ui32* lengths,
-                                 ojph::mem_elastic_allocator *elastic,
-                                 ojph::coded_lists *& coded)
+    static void
+      encode_codeblock64(ht_prepare_quads_fun64 prepare_quads,
+                         ui64* buf, ui32 missing_msbs, ui32 num_passes,
+                         ui32 width, ui32 height, ui32 stride,
+                         ui32* lengths,
+                         ojph::mem_elastic_allocator *elastic,
+                         ojph::coded_lists *& coded)
     {
       assert(num_passes == 1);
       (void)num_passes;                      //currently not used
@@ -1076,68 +827,31 @@ namespace ojph {
       ui8* lep = e_val;     lep[0] = 0;
       ui8* lcxp = cx_val;   lcxp[0] = 0;
 
+      //E values and MagSgn values of a pair of rows, in the order of
+      // their quads, as prepare_quads finds them; zero for insignificant
+      // samples and for those beyond the width, up to a multiple of 4
+      ui64 quad_e[2048], quad_s[2048];
+
       //initial row of quads
-      int e_qmax[2] = {0,0}, e_q[8] = {0,0,0,0,0,0,0,0};
-      int rho[2] = {0,0};
+      int e_qmax[2], e_q[8];
+      int rho[2];
       int c_q0 = 0;
-      ui64 s[8] = {0,0,0,0,0,0,0,0}, val, t;
       ui32 y = 0;
-      ui64 *sp = buf;
+      prepare_quads(buf, stride, width, height > 1, p, quad_s, quad_e);
       for (ui32 x = 0; x < width; x += 4)
       {
-        //prepare two quads
-        t = sp[0];
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p;  // 2 \mu_p + x
-        val &= ~1ULL; // 2 \mu_p
-        if (val)
-        {
-          rho[0] = 1;
-          e_q[0] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = e_q[0];
-          s[0] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        t = height > 1 ? sp[stride] : 0;
-        ++sp;
-        val = t + t; //multiply by 2 and get rid of sign
-        val >>= p; // 2 \mu_p + x
-        val &= ~1ULL;// 2 \mu_p
-        if (val)
-        {
-          rho[0] += 2;
-          e_q[1] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-          e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-          s[1] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-        }
-
-        if (x + 1 < width)
-        {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 4;
-            e_q[2] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-            s[2] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 8;
-            e_q[3] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-            s[3] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-        }
+        //two quads
+        const ui64 *s = quad_s + 2 * x;
+        for (int i = 0; i < 8; ++i)
+          e_q[i] = (int)quad_e[2 * x + i];
+        rho[0] = (e_q[0] != 0) | (e_q[1] != 0) << 1
+               | (e_q[2] != 0) << 2 | (e_q[3] != 0) << 3;
+        rho[1] = (e_q[4] != 0) | (e_q[5] != 0) << 1
+               | (e_q[6] != 0) << 2 | (e_q[7] != 0) << 3;
+        e_qmax[0] = ojph_max(ojph_max(e_q[0], e_q[1]),
+                             ojph_max(e_q[2], e_q[3]));
+        e_qmax[1] = ojph_max(ojph_max(e_q[4], e_q[5]),
+                             ojph_max(e_q[6], e_q[7]));
 
         int Uq0 = ojph_max(e_qmax[0], 1); //kappa_q = 1
         int u_q0 = Uq0 - 1, u_q1 = 0; //kappa_q = 1
@@ -1159,7 +873,7 @@ namespace ojph {
         vlc_encode(&vlc, tuple0 >> 8, (tuple0 >> 4) & 7);
 
         if (c_q0 == 0)
-          mel_encode(&mel, rho[0] != 0);
+            mel_encode(&mel, rho[0] != 0);
 
         int m = (rho[0] & 1) ? Uq0 - (tuple0 & 1) : 0;
         ms_encode64(&ms, s[0] & ((1ULL << m) - 1), m);
@@ -1170,61 +884,8 @@ namespace ojph {
         m = (rho[0] & 8) ? Uq0 - ((tuple0 & 8) >> 3) : 0;
         ms_encode64(&ms, s[3] & ((1ULL << m) - 1), m);
 
-        if (x + 2 < width)
+        if (x+2 < width)
         {
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[1] = 1;
-            e_q[4] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = e_q[4];
-            s[4] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = height > 1 ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[1] += 2;
-            e_q[5] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-            s[5] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x + 3 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 4;
-              e_q[6] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-              s[6] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = height > 1 ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 8;
-              e_q[7] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-              s[7] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
-
           int c_q1 = (rho[0] >> 1) | (rho[0] & 1);
           int Uq1 = ojph_max(e_qmax[1], 1); //kappa_q = 1
           u_q1 = Uq1 - 1; //kappa_q = 1
@@ -1288,9 +949,6 @@ namespace ojph {
 
         //prepare for next iteration
         c_q0 = (rho[1] >> 1) | (rho[1] & 1);
-        s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-        e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-        rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
       }
 
       lep[1] = 0;
@@ -1304,62 +962,22 @@ namespace ojph {
         c_q0 = lcxp[0] + (lcxp[1] << 2);
         lcxp[0] = 0;
 
-        sp = buf + y * stride;
+        prepare_quads(buf + y * stride, stride, width, y + 1 < height, p,
+                      quad_s, quad_e);
         for (ui32 x = 0; x < width; x += 4)
         {
-          //prepare two quads
-          t = sp[0];
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[0] = 1;
-            e_q[0] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = e_q[0];
-            s[0] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          t = y + 1 < height ? sp[stride] : 0;
-          ++sp;
-          val = t + t; //multiply by 2 and get rid of sign
-          val >>= p; // 2 \mu_p + x
-          val &= ~1ULL;// 2 \mu_p
-          if (val)
-          {
-            rho[0] += 2;
-            e_q[1] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-            e_qmax[0] = ojph_max(e_qmax[0], e_q[1]);
-            s[1] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-          }
-
-          if (x + 1 < width)
-          {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 4;
-              e_q[2] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[2]);
-              s[2] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[0] += 8;
-              e_q[3] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[0] = ojph_max(e_qmax[0], e_q[3]);
-              s[3] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-          }
+          //two quads
+          const ui64 *s = quad_s + 2 * x;
+          for (int i = 0; i < 8; ++i)
+            e_q[i] = (int)quad_e[2 * x + i];
+          rho[0] = (e_q[0] != 0) | (e_q[1] != 0) << 1
+                 | (e_q[2] != 0) << 2 | (e_q[3] != 0) << 3;
+          rho[1] = (e_q[4] != 0) | (e_q[5] != 0) << 1
+                 | (e_q[6] != 0) << 2 | (e_q[7] != 0) << 3;
+          e_qmax[0] = ojph_max(ojph_max(e_q[0], e_q[1]),
+                               ojph_max(e_q[2], e_q[3]));
+          e_qmax[1] = ojph_max(ojph_max(e_q[4], e_q[5]),
+                               ojph_max(e_q[6], e_q[7]));
 
           int kappa = (rho[0] & (rho[0]-1)) ? ojph_max(1,max_e) : 1;
           int Uq0 = ojph_max(e_qmax[0], kappa);
@@ -1394,61 +1012,8 @@ namespace ojph {
           m = (rho[0] & 8) ? Uq0 - ((tuple0 & 8) >> 3) : 0;
           ms_encode64(&ms, s[3] & ((1ULL << m) - 1), m);
 
-          if (x + 2 < width)
+          if (x+2 < width)
           {
-            t = sp[0];
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[1] = 1;
-              e_q[4] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = e_q[4];
-              s[4] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            t = y + 1 < height ? sp[stride] : 0;
-            ++sp;
-            val = t + t; //multiply by 2 and get rid of sign
-            val >>= p; // 2 \mu_p + x
-            val &= ~1ULL;// 2 \mu_p
-            if (val)
-            {
-              rho[1] += 2;
-              e_q[5] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-              e_qmax[1] = ojph_max(e_qmax[1], e_q[5]);
-              s[5] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-            }
-
-            if (x + 3 < width)
-            {
-              t = sp[0];
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1ULL;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 4;
-                e_q[6] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[6]);
-                s[6] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-              }
-
-              t = y + 1 < height ? sp[stride] : 0;
-              ++sp;
-              val = t + t; //multiply by 2 and get rid of sign
-              val >>= p; // 2 \mu_p + x
-              val &= ~1ULL;// 2 \mu_p
-              if (val)
-              {
-                rho[1] += 8;
-                e_q[7] = 64 - (int)count_leading_zeros(--val); //2\mu_p - 1
-                e_qmax[1] = ojph_max(e_qmax[1], e_q[7]);
-                s[7] = --val + (t >> 63); //v_n = 2(\mu_p-1) + s_n
-              }
-            }
-
             kappa = (rho[1] & (rho[1]-1)) ? ojph_max(1,max_e) : 1;
             c_q1 |= ((rho[0] & 4) >> 1) | ((rho[0] & 8) >> 2);
             int Uq1 = ojph_max(e_qmax[1], kappa);
@@ -1493,9 +1058,6 @@ namespace ojph {
 
           //prepare for next iteration
           c_q0 |= ((rho[1] & 4) >> 1) | ((rho[1] & 8) >> 2);
-          s[0] = s[1] = s[2] = s[3] = s[4] = s[5] = s[6] = s[7] = 0;
-          e_q[0]=e_q[1]=e_q[2]=e_q[3]=e_q[4]=e_q[5]=e_q[6]=e_q[7]=0;
-          rho[0] = rho[1] = 0; e_qmax[0] = e_qmax[1] = 0;
         }
       }
 
@@ -1519,5 +1081,74 @@ namespace ojph {
 
       coded->avail_size -= lengths[0];
     }
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock32(ui32* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock32(gen_ht_prepare_quads32, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock64(ui64* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock64(gen_ht_prepare_quads64, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock_avx2(ui32* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock32(avx2_ht_prepare_quads32, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock64_avx2(ui64* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock64(avx2_ht_prepare_quads64, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+#endif // !OJPH_DISABLE_AVX2
+
+#ifdef OJPH_ENABLE_NEON
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock_neon(ui32* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock32(neon_ht_prepare_quads32, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void
+      ojph_encode_codeblock64_neon(ui64* buf, ui32 missing_msbs,
+        ui32 num_passes, ui32 width, ui32 height, ui32 stride, ui32* lengths,
+        ojph::mem_elastic_allocator *elastic, ojph::coded_lists *& coded)
+    {
+      encode_codeblock64(neon_ht_prepare_quads64, buf, missing_msbs,
+        num_passes, width, height, stride, lengths, elastic, coded);
+    }
+
+#endif // OJPH_ENABLE_NEON
   }
 }
@@ -69,19 +69,57 @@ namespace ojph {
       ojph_encode_codeblock_avx2(ui32* buf, ui32 missing_msbs,
                                  ui32 num_passes, ui32 width, ui32 height,
                                  ui32 stride, ui32* lengths,
-                                 ojph::mem_elastic_allocator* elastic,
-                                 ojph::coded_lists*& coded);
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded);
 
     void
-      ojph_encode_codeblock_avx512(ui32* buf, ui32 missing_msbs, 
-                                   ui32 num_passes, ui32 width, ui32 height, 
+      ojph_encode_codeblock64_avx2(ui64* buf, ui32 missing_msbs,
+                                   ui32 num_passes, ui32 width, ui32 height,
                                    ui32 stride, ui32* lengths,
                                    ojph::mem_elastic_allocator *elastic,
                                    ojph::coded_lists *& coded);
 
+    void
+      ojph_encode_codeblock_neon(ui32* buf, ui32 missing_msbs,
+                                 ui32 num_passes, ui32 width, ui32 height,
+                                 ui32 stride, ui32* lengths,
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded);
+
+    void
+      ojph_encode_codeblock64_neon(ui64* buf, ui32 missing_msbs,
+                                   ui32 num_passes, ui32 width, ui32 height,
+                                   ui32 stride, ui32* lengths,
+                                   ojph::mem_elastic_allocator *elastic,
+                                   ojph::coded_lists *& coded);
+
+    //////////////////////////////////////////////////////////////////////////
+    // finds the exponent E and the MagSgn value of each sample of a pair of
+    // rows (one row if two_rows is false), in the order the encoder visits
+    // them: top then bottom sample of each column.  Entries up to the next
+    // multiple of 4 columns are written; those beyond width are zero, as
+    // are those of insignificant samples.  p is the bit position of the
+    // least significant magnitude bit that is coded, plus one.
+    typedef void (*ht_prepare_quads_fun32)(const ui32 *sp, ui32 stride,
+      ui32 width, bool two_rows, ui32 p, ui32 *s, ui32 *e);
+
+    typedef void (*ht_prepare_quads_fun64)(const ui64 *sp, ui32 stride,
+      ui32 width, bool two_rows, ui32 p, ui64 *s, ui64 *e);
+
+    void  gen_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui32 *s, ui32 *e);
+    void avx2_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui32 *s, ui32 *e);
+    void neon_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui32 *s, ui32 *e);
+    void  gen_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui64 *s, ui64 *e);
+    void avx2_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui64 *s, ui64 *e);
+    void neon_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui64 *s, ui64 *e);
+
     bool initialize_block_encoder_tables();
-    bool initialize_block_encoder_tables_avx2();
-    bool initialize_block_encoder_tables_avx512();
   }
 }
 
@@ -0,0 +1,189 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_avx2.cpp
+// Author: Aous Naman
+// Date: 15 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_avx2.cpp
+ *  @brief implements the sample preparation of the HTJ2K block encoder
+ *         using AVX2
+ */
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <immintrin.h>
+#include "ojph_defs.h"
+#include "ojph_block_encoder.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // number of significant bits in each 32-bit lane of x; AVX2 has no
+    // vector lzcnt, so the two 16-bit halves go through float conversion,
+    // which is exact for them, and their exponents give the bit counts
+    static inline __m256i avx2_bit_width32(__m256i x)
+    {
+      const __m256i bias = _mm256_set1_epi32(126);
+      __m256i hi = _mm256_castps_si256(
+        _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 16)));
+      __m256i lo = _mm256_castps_si256(_mm256_cvtepi32_ps(
+        _mm256_and_si256(x, _mm256_set1_epi32(0xFFFF))));
+      hi = _mm256_sub_epi32(_mm256_srli_epi32(hi, 23), bias);
+      lo = _mm256_sub_epi32(_mm256_srli_epi32(lo, 23), bias);
+      hi = _mm256_add_epi32(hi, _mm256_set1_epi32(16));
+      return _mm256_max_epi32(_mm256_max_epi32(hi, lo),
+                              _mm256_setzero_si256());
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+      avx2_prepare_samples32(__m256i t, __m128i shift, __m256i& s, __m256i& e)
+    {
+      const __m256i one = _mm256_set1_epi32(1);
+      __m256i val = _mm256_add_epi32(t, t);       //get rid of sign
+      val = _mm256_srl_epi32(val, shift);         // 2 \mu_p + x
+      val = _mm256_andnot_si256(one, val);        // 2 \mu_p
+      __m256i sig = _mm256_cmpeq_epi32(val, _mm256_setzero_si256());
+      val = _mm256_sub_epi32(val, one);           // 2 \mu_p - 1
+      e = _mm256_andnot_si256(sig, avx2_bit_width32(val));
+      val = _mm256_sub_epi32(val, one);           // 2 (\mu_p - 1)
+      val = _mm256_add_epi32(val, _mm256_srli_epi32(t, 31)); // + s_n
+      s = _mm256_andnot_si256(sig, val);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui32 *s, ui32 *e)
+    {
+      const __m128i shift = _mm_cvtsi32_si128((int)p);
+      ui32 x = 0;
+      for (; x + 8 <= width; x += 8, sp += 8, s += 16, e += 16)
+      {
+        __m256i t = _mm256_loadu_si256((__m256i*)sp);
+        __m256i b = two_rows ? _mm256_loadu_si256((__m256i*)(sp + stride))
+                             : _mm256_setzero_si256();
+        __m256i ts, te, bs, be;
+        avx2_prepare_samples32(t, shift, ts, te);
+        avx2_prepare_samples32(b, shift, bs, be);
+
+        // top and bottom samples of each column next to each other
+        __m256i lo = _mm256_unpacklo_epi32(ts, bs);
+        __m256i hi = _mm256_unpackhi_epi32(ts, bs);
+        _mm256_storeu_si256((__m256i*)s,
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)s + 1,
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+        lo = _mm256_unpacklo_epi32(te, be);
+        hi = _mm256_unpackhi_epi32(te, be);
+        _mm256_storeu_si256((__m256i*)e,
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)e + 1,
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+      if (x < width)
+        gen_ht_prepare_quads32(sp, stride, width - x, two_rows, p, s, e);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+      avx2_prepare_samples64(__m256i t, __m128i shift, __m256i& s, __m256i& e)
+    {
+      const __m256i one = _mm256_set1_epi64x(1);
+      __m256i val = _mm256_add_epi64(t, t);       //get rid of sign
+      val = _mm256_srl_epi64(val, shift);         // 2 \mu_p + x
+      val = _mm256_andnot_si256(one, val);        // 2 \mu_p
+      __m256i sig = _mm256_cmpeq_epi64(val, _mm256_setzero_si256());
+      val = _mm256_sub_epi64(val, one);           // 2 \mu_p - 1
+
+      // bit width of each half, then of the 64-bit lane
+      __m256i w = avx2_bit_width32(val);
+      __m256i wh = _mm256_srli_epi64(w, 32);
+      __m256i wl = _mm256_and_si256(w, _mm256_set1_epi64x(0xFFFFFFFF));
+      __m256i no_hi = _mm256_cmpeq_epi64(wh, _mm256_setzero_si256());
+      w = _mm256_blendv_epi8(_mm256_add_epi64(wh, _mm256_set1_epi64x(32)),
+                             wl, no_hi);
+      e = _mm256_andnot_si256(sig, w);
+
+      val = _mm256_sub_epi64(val, one);           // 2 (\mu_p - 1)
+      val = _mm256_add_epi64(val, _mm256_srli_epi64(t, 63)); // + s_n
+      s = _mm256_andnot_si256(sig, val);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui64 *s, ui64 *e)
+    {
+      const __m128i shift = _mm_cvtsi32_si128((int)p);
+      ui32 x = 0;
+      for (; x + 4 <= width; x += 4, sp += 4, s += 8, e += 8)
+      {
+        __m256i t = _mm256_loadu_si256((__m256i*)sp);
+        __m256i b = two_rows ? _mm256_loadu_si256((__m256i*)(sp + stride))
+                             : _mm256_setzero_si256();
+        __m256i ts, te, bs, be;
+        avx2_prepare_samples64(t, shift, ts, te);
+        avx2_prepare_samples64(b, shift, bs, be);
+
+        // top and bottom samples of each column next to each other
+        __m256i lo = _mm256_unpacklo_epi64(ts, bs);
+        __m256i hi = _mm256_unpackhi_epi64(ts, bs);
+        _mm256_storeu_si256((__m256i*)s,
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)s + 1,
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+        lo = _mm256_unpacklo_epi64(te, be);
+        hi = _mm256_unpackhi_epi64(te, be);
+        _mm256_storeu_si256((__m256i*)e,
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)e + 1,
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+      }
+      if (x < width)
+        gen_ht_prepare_quads64(sp, stride, width - x, two_rows, p, s, e);
+    }
+
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
@@ -0,0 +1,151 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_neon.cpp
+// Author: Aous Naman
+// Date: 15 October 2026
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_neon.cpp
+ *  @brief implements the sample preparation of the HTJ2K block encoder
+ *         using NEON
+ */
+
+#include "ojph_arch.h"
+#if defined(OJPH_ENABLE_NEON)
+
+#include <arm_neon.h>
+#include "ojph_defs.h"
+#include "ojph_block_encoder.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+      neon_prepare_samples32(uint32x4_t t, int32x4_t shift,
+                             uint32x4_t& s, uint32x4_t& e)
+    {
+      const uint32x4_t one = vdupq_n_u32(1);
+      uint32x4_t val = vaddq_u32(t, t);          //get rid of sign
+      val = vshlq_u32(val, shift);               // 2 \mu_p + x
+      val = vbicq_u32(val, one);                 // 2 \mu_p
+      uint32x4_t sig = vtstq_u32(val, val);
+      val = vsubq_u32(val, one);                 // 2 \mu_p - 1
+      e = vandq_u32(sig, vsubq_u32(vdupq_n_u32(32), vclzq_u32(val)));
+      val = vsubq_u32(val, one);                 // 2 (\mu_p - 1)
+      val = vaddq_u32(val, vshrq_n_u32(t, 31));  // + s_n
+      s = vandq_u32(sig, val);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_ht_prepare_quads32(const ui32 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui32 *s, ui32 *e)
+    {
+      const int32x4_t shift = vdupq_n_s32(-(si32)p);
+      ui32 x = 0;
+      for (; x + 4 <= width; x += 4, sp += 4, s += 8, e += 8)
+      {
+        uint32x4_t t = vld1q_u32(sp);
+        uint32x4_t b = two_rows ? vld1q_u32(sp + stride) : vdupq_n_u32(0);
+        uint32x4_t ts, te, bs, be;
+        neon_prepare_samples32(t, shift, ts, te);
+        neon_prepare_samples32(b, shift, bs, be);
+
+        // top and bottom samples of each column next to each other
+        vst1q_u32(s, vzip1q_u32(ts, bs));
+        vst1q_u32(s + 4, vzip2q_u32(ts, bs));
+        vst1q_u32(e, vzip1q_u32(te, be));
+        vst1q_u32(e + 4, vzip2q_u32(te, be));
+      }
+      if (x < width)
+        gen_ht_prepare_quads32(sp, stride, width - x, two_rows, p, s, e);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+      neon_prepare_samples64(uint64x2_t t, int64x2_t shift,
+                             uint64x2_t& s, uint64x2_t& e)
+    {
+      const uint64x2_t one = vdupq_n_u64(1);
+      uint64x2_t val = vaddq_u64(t, t);          //get rid of sign
+      val = vshlq_u64(val, shift);               // 2 \mu_p + x
+      val = vbicq_u64(val, one);                 // 2 \mu_p
+      uint64x2_t sig = vtstq_u64(val, val);
+      val = vsubq_u64(val, one);                 // 2 \mu_p - 1
+
+      // there is no 64-bit vclz; the lower half counts only when the
+      // upper one is all zeros
+      uint64x2_t c = vreinterpretq_u64_u32(
+        vclzq_u32(vreinterpretq_u32_u64(val)));
+      uint64x2_t ch = vshrq_n_u64(c, 32);
+      uint64x2_t cl = vandq_u64(c, vdupq_n_u64(0xFFFFFFFFULL));
+      cl = vandq_u64(cl, vceqq_u64(ch, vdupq_n_u64(32)));
+      e = vandq_u64(sig, vsubq_u64(vdupq_n_u64(64), vaddq_u64(ch, cl)));
+
+      val = vsubq_u64(val, one);                 // 2 (\mu_p - 1)
+      val = vaddq_u64(val, vshrq_n_u64(t, 63));  // + s_n
+      s = vandq_u64(sig, val);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_ht_prepare_quads64(const ui64 *sp, ui32 stride, ui32 width,
+                                 bool two_rows, ui32 p, ui64 *s, ui64 *e)
+    {
+      const int64x2_t shift = vdupq_n_s64(-(si64)p);
+      ui32 x = 0;
+      // a quad at a time, so that the tail starts on a quad boundary
+      for (; x + 4 <= width; x += 4)
+        for (int i = 0; i < 2; ++i, sp += 2, s += 4, e += 4)
+        {
+          uint64x2_t t = vld1q_u64(sp);
+          uint64x2_t b = two_rows ? vld1q_u64(sp + stride) : vdupq_n_u64(0);
+          uint64x2_t ts, te, bs, be;
+          neon_prepare_samples64(t, shift, ts, te);
+          neon_prepare_samples64(b, shift, bs, be);
+
+          // top and bottom samples of each column next to each other
+          vst1q_u64(s, vzip1q_u64(ts, bs));
+          vst1q_u64(s + 2, vzip2q_u64(ts, bs));
+          vst1q_u64(e, vzip1q_u64(te, be));
+          vst1q_u64(e + 2, vzip2q_u64(te, be));
+        }
+      if (x < width)
+        gen_ht_prepare_quads64(sp, stride, width - x, two_rows, p, s, e);
+    }
+
+  }
+}
+
+#endif // OJPH_ENABLE_NEON
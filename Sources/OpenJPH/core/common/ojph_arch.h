@@ -97,6 +97,38 @@ namespace ojph {
 #define OJPH_DISABLE_SIMD
 #endif // !OJPH_ARCH_UNKNOWN
 
+  ////////////////////////////////////////////////////////////////////////////
+  //              NEON kernels are written for 64-bit ARM only
+  ////////////////////////////////////////////////////////////////////////////
+#if defined(OJPH_ARCH_ARM) && (defined(__aarch64__) || defined(_M_ARM64)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_NEON)
+#define OJPH_ENABLE_NEON
+#endif // OJPH_ARCH_ARM && 64-bit
+
+  ////////////////////////////////////////////////////////////////////////////
+  //           instruction set selection for the x86 SIMD kernels
+  ////////////////////////////////////////////////////////////////////////////
+  // All translation units are compiled with the same flags; each x86 kernel
+  // file enables its instruction set for the functions it defines between
+  // OJPH_TARGET_BEGIN and OJPH_TARGET_END, placed after all the #includes.
+  // These functions are only called once get_cpu_ext_level() reports the
+  // instruction set.  MSVC does not need this to use intrinsics.
+  // Floating point contraction must be off (-ffp-contract=off): the kernels
+  // match the generic code only when neither fuses a multiply and an add.
+#define OJPH_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define OJPH_TARGET_BEGIN(isa) OJPH_PRAGMA(clang attribute push \
+  (__attribute__((target(isa))), apply_to = function))
+#define OJPH_TARGET_END OJPH_PRAGMA(clang attribute pop)
+#elif defined(OJPH_COMPILER_GNUC)
+#define OJPH_TARGET_BEGIN(isa) OJPH_PRAGMA(GCC push_options) \
+  OJPH_PRAGMA(GCC target(isa))
+#define OJPH_TARGET_END OJPH_PRAGMA(GCC pop_options)
+#else
+#define OJPH_TARGET_BEGIN(isa)
+#define OJPH_TARGET_END
+#endif
+
   ////////////////////////////////////////////////////////////////////////////
   //                         OS detection definitions
   ////////////////////////////////////////////////////////////////////////////
@@ -122,9 +154,21 @@ namespace ojph {
   /////////////////////////////////////////////////////////////////////////////
   //                             cpu features
   /////////////////////////////////////////////////////////////////////////////
+  // get_cpu_ext_level() is the level the kernels are chosen for: the level
+  // detected on this CPU, lowered to the cap set by set_cpu_ext_level_cap().
   OJPH_EXPORT
   int get_cpu_ext_level();
 
+  OJPH_EXPORT
+  int get_detected_cpu_ext_level();
+
+  // Limits the instruction set extensions used, e.g. to compare kernels or
+  // to step around a faulty one without rebuilding; a negative level lifts
+  // the cap.  Codestreams created after the call use the new kernels; the
+  // cap must not change while a codestream decodes or encodes.
+  OJPH_EXPORT
+  void set_cpu_ext_level_cap(int level);
+
   enum : int {
     X86_CPU_EXT_LEVEL_GENERIC = 0,
     X86_CPU_EXT_LEVEL_MMX = 1,
@@ -312,6 +356,14 @@ namespace ojph {
     return reinterpret_cast<T *>(p);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  // true if the address is a multiple of N; kernels take aligned loads
+  // and stores when all their lines pass this test
+  template <ui32 N>
+  inline bool is_aligned(const void *ptr) {
+    return (reinterpret_cast<intptr_t>(ptr) & (N - 1)) == 0;
+  }
+
 }
 
 #endif // !OJPH_ARCH_H
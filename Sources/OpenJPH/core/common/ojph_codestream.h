@@ -39,7 +39,9 @@
 #ifndef OJPH_CODESTREAM_H
 #define OJPH_CODESTREAM_H
 
+#include <atomic>
 #include <cstdlib>
+#include <exception>
 
 #include "ojph_arch.h"
 #include "ojph_defs.h"
@@ -61,9 +63,66 @@ namespace ojph {
   class comment_exchange;
   class mem_fixed_allocator;
   struct point;
+  struct rect;
   class line_buf;
   class outfile_base;
   class infile_base;
+  class thread_pool;
+  struct decode_stats;
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Thrown by a decoding codestream once its cancel flag is raised;
+   *         see codestream::set_cancel_flag().  Cancelling is not an error,
+   *         so no message is reported for it.
+   */
+  class OJPH_EXPORT decode_cancelled : public std::exception
+  {
+  public:
+    const char* what() const noexcept override
+    { return "Decoding was cancelled"; }
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Receives the dequantized samples of subbands, for a backend,
+   *         such as a GPU, that runs the inverse wavelet transform itself;
+   *         see codestream::pull_subbands().
+   *
+   *  Codeblocks may be decoded on the threads of the codestream's pool, but
+   *  begin_band() and push_line() are only called from the thread that
+   *  calls pull_subbands(), one call at a time, so a sink needs no locking.
+   */
+  class OJPH_EXPORT subband_sink
+  {
+  public:
+    virtual ~subband_sink() {}
+
+    /**
+     * @brief Starts a subband; its rows follow, from the top, through
+     *        push_line().
+     *
+     * @param comp_num the component.
+     * @param res_num the resolution, 0 being the lowest one.
+     * @param band_num 0 for LL, which only resolution 0 has, then 1 for HL,
+     *                 2 for LH and 3 for HH.
+     * @param res_rect the resolution the subband is synthesized into; the
+     *                 parity of its origin tells which samples are low pass.
+     * @param band_rect the subband, in its own coordinates.
+     */
+    virtual void begin_band(ui32 comp_num, ui32 res_num, ui32 band_num,
+                            const rect& res_rect, const rect& band_rect) = 0;
+
+    /**
+     * @brief Receives the next row of the subband begun last; the line is
+     *        only valid during the call.  Its samples are si32 for
+     *        reversible coding, and floats otherwise, or si64 for samples
+     *        wider than 32 bits.
+     *
+     * @return false to stop pulling.
+     */
+    virtual bool push_line(const line_buf* line) = 0;
+  };
 
   ////////////////////////////////////////////////////////////////////////////
   /**
@@ -210,6 +269,46 @@ namespace ojph {
 
     bool is_tlm_requested();
 
+    /**
+     *  @brief Request the addition of the optional PLT marker segments.
+     *  This request should occur before writing codestream headers
+     *  ojph::codestream::write_headers())
+     *
+     *  Every tile-part header then lists the lengths of its packets, so a
+     *  reader can seek to the precincts it needs, e.g. for a region or a
+     *  reduced resolution, instead of parsing every packet header.
+     *
+     *  @param needed true when the markers are needed.
+     */
+    void request_plt_marker(bool needed);
+
+    /**
+     *  @brief Query if the optional PLT marker segments are to be added.
+     *
+     *  @return true if the addition of PLT marker segments was requested.
+     */
+    bool is_plt_requested();
+
+    /**
+     *  @brief Request that each row of tiles be written as soon as its
+     *  last line is pushed, rather than all tiles by
+     *  ojph::codestream::flush().  This request should occur before
+     *  writing codestream headers (ojph::codestream::write_headers()).
+     *
+     *  A tile row is released once written, and the next one reuses its
+     *  buffers, so memory holds one tile row and its coded data instead
+     *  of the whole image; tiling a large image thus bounds the memory of
+     *  encoding it.  The
+     *  outfile receives the codestream in order and is never seeked.
+     *  It takes effect only when all components of a line are pushed
+     *  together (not planar), and not when a TLM marker segment is
+     *  needed, since that lists the length of every tile-part before the
+     *  first one.
+     *
+     *  @param needed true to write tile rows early.
+     */
+    void request_tile_row_output(bool needed);
+
     /**
      *  @brief Writes codestream headers when the codestream is used for
      *  writing.  This function should be called after setting all the
@@ -272,6 +371,20 @@ namespace ojph {
      */
     void enable_resilience();             // before read_headers
 
+    /**
+     * @brief This keeps the parsed main header of a reading (decoding)
+     *        codestream across codestream::restart().  A later
+     *        codestream::read_headers() compares the incoming main header
+     *        with the kept one byte for byte and, when they are identical,
+     *        resumes at the first tile-part without parsing the marker
+     *        segments again; otherwise, the header is parsed as usual.
+     *        This is useful for the frames of a multi-frame object, which
+     *        normally share SIZ, COD and QCD.  Call this function once,
+     *        before codestream::read_headers(); it is not reset by
+     *        codestream::restart().
+     */
+    void enable_header_cache();           // before read_headers
+
     /**
      * @brief This call reads the headers of a codestream.  It is for a
      *        reading (or decoding) codestream, and should be called
@@ -305,6 +418,145 @@ namespace ojph {
     void restrict_input_resolution(ui32 skipped_res_for_data,
                                    ui32 skipped_res_for_recon); //before create
 
+    /**
+     * @brief This function restricts decoding to a region of the image.  It
+     *        is for a reading (decoding) codestream.  Call this function
+     *        after codestream::read_headers() but before
+     *        codestream::create().
+     *
+     *  The decoded lines keep their full width and height, but only the
+     *  samples inside the region are guaranteed to be correct.  Tiles that
+     *  do not intersect the region are not reconstructed, and codeblocks
+     *  that do not contribute to the region, taking the support of the
+     *  wavelet synthesis filters into account, are not decoded.  Lines
+     *  below the region need not be pulled.
+     *
+     * @param region the region on the image reference grid, at full
+     *               resolution, in the same coordinates as the image
+     *               extent of param_siz.
+     */
+    void restrict_input_region(const rect& region);             //before create
+
+    /**
+     * @brief This function restricts decoding to some of the components,
+     *        e.g. the luminance of a colour image.  It is for a reading
+     *        (decoding) codestream.  Call this function after
+     *        codestream::read_headers() but before codestream::create().
+     *
+     *  Lines of every component are still pulled, but those of components
+     *  that are not selected are left undefined: their codeblocks are not
+     *  decoded, nor their wavelet synthesis run, and their packet bodies
+     *  are skipped.  When the colour transform is employed but not all of
+     *  its three components are selected, it is bypassed, and the selected
+     *  ones are reconstructed as coded, e.g. Y of YCbCr.
+     *
+     * @param mask bit c selects component c; components 32 and above are
+     *             only decoded when every bit is set, which is the default.
+     */
+    void restrict_input_components(ui32 mask);                  //before create
+
+    /**
+     * @brief This function leaves the inverse colour transform to the
+     *        reader, who can then fuse it with the conversion of pulled
+     *        lines into pixels.  It is for a reading (decoding) codestream.
+     *        Call this function after codestream::read_headers() but
+     *        before codestream::create().
+     *
+     *  When the colour transform is employed, and applied, the first three
+     *  components are then pulled as coded, without their DC level shift:
+     *  integer Y, Cb and Cr of the reversible transform, or floats of the
+     *  irreversible one, in the nominal range [-0.5, 0.5).  The transform
+     *  is still applied when it is bypassed for the selected components
+     *  (see restrict_input_components()) or when a nonlinearity follows it;
+     *  is_colour_transform_deferred() tells, after create().
+     */
+    void defer_colour_transform();                              //before create
+
+    /**
+     * @brief Tells whether the first three components are pulled before
+     *        their inverse colour transform; see defer_colour_transform().
+     *        Valid after codestream::create().
+     */
+    bool is_colour_transform_deferred() const;
+
+    /**
+     * @brief Asks a reading codestream to run the dequantization and the
+     *        wavelet synthesis of irreversibly (9/7) coded components in
+     *        fixed-point arithmetic, rather than in floats.  It is meant
+     *        for display, where exact reconstruction is not needed.  Call
+     *        this function after codestream::read_headers() but before
+     *        codestream::create().
+     *
+     *  Samples are carried in 32-bit integers with 24 fractional bits of
+     *  the nominal range; components coded at more than 32 bits of
+     *  precision, and reversibly coded ones, are decoded as usual.  The
+     *  colour transform and the conversion of pulled lines stay in floats,
+     *  and the pulled samples of components of up to 16 bits differ from
+     *  those of the float decode by at most 1.
+     */
+    void request_fixed_point_synthesis();                       //before create
+
+    /**
+     * @brief Asks a reading codestream to decode only the cleanup pass of
+     *        every HTJ2K codeblock, skipping its SigProp and MagRef
+     *        refinement passes, for a quick preview.  Call this function
+     *        after codestream::read_headers() but before
+     *        codestream::create().
+     *
+     *  Samples then lack the bit-plane the refinement passes add, where
+     *  codeblocks have them; the coded data is read as usual, and JPEG 2000
+     *  Part-1 codeblocks are decoded in full.
+     */
+    void request_cleanup_pass_only();                           //before create
+
+    /**
+     * @brief Lets a codestream use worker threads.  When reading, call
+     *        this function after codestream::read_headers() but before
+     *        codestream::create(); when writing, call it before
+     *        codestream::write_headers().
+     *
+     *  When the image has more than one tile across and is pulled one row of
+     *  all components at a time (not planar), the tiles of a tile row are
+     *  decoded concurrently, a strip of lines at a time, and their lines are
+     *  stitched back in raster order.  Within every tile, the codeblocks of
+     *  each subband are decoded as pool jobs one codeblock row ahead of the
+     *  inverse wavelet transform, which waits only for the row it needs.
+     *  When writing, each completed codeblock row is encoded as pool jobs
+     *  while the forward transform fills the next row; codestream::flush()
+     *  waits for the last rows.
+     *  The pool must outlive the codestream, or be removed by passing NULL.
+     *
+     * @param pool the pool to use, or NULL to code on the calling thread.
+     */
+    void set_thread_pool(thread_pool *pool);                    //before create
+
+    /**
+     * @brief Adds the time spent in each stage of reading and decoding
+     *        this codestream, and counters of the work done, to stats;
+     *        see decode_stats.  Call this function before
+     *        codestream::read_headers() to include the main header;
+     *        codestream::restart() removes it.  Nothing is collected when
+     *        OpenJPH is built with OJPH_DISABLE_STATS.
+     *
+     * @param stats where to add the measurements, or NULL to stop; it must
+     *              outlive the decoding of the codestream.
+     */
+    void set_stats(decode_stats *stats);
+
+    /**
+     * @brief Lets another thread stop the decoding of this codestream.
+     *        The flag is checked before each codeblock row is decoded and
+     *        whenever pulling moves on to the next row of tiles; once it
+     *        is raised, codestream::pull() throws decode_cancelled.
+     *        Codeblock jobs already given to the thread pool run to
+     *        completion.  Call this function before codestream::create();
+     *        codestream::restart() removes it.
+     *
+     * @param flag the flag to watch, or NULL to decode to the end; it must
+     *             outlive the decoding of the codestream.
+     */
+    void set_cancel_flag(const std::atomic<bool> *flag);        //before create
+
     /**
      * @brief This call is for a decoding (or reading) codestream.  Call this
      *        function after calling restrict_input_resolution(), if
@@ -318,6 +570,18 @@ namespace ojph {
      *        the image; the returned comp_num tells the reader the
      *        component to which this row belongs.
      *
+     *        When not planar, and components have different numbers of
+     *        lines, as vertically subsampled ones do, each row of
+     *        component 0 comes with the lines of the other components that
+     *        start on the reference grid before the next row of
+     *        component 0, and the first row with at least one line of
+     *        each: with vertical factors d (shifted by the discarded
+     *        resolutions) and an image starting at row y0, component c has
+     *        delivered min(height_c, max(1, ceil(e / d_c) - ceil(y0 / d_c)))
+     *        lines once row r of component 0 is pulled, where
+     *        e = (ceil(y0 / d_0) + r + 1) * d_0.  Components come in
+     *        increasing order within a row.
+     *
      * @param comp_num returns the component to which the returned
      *                 line_buf object belongs.
      * @return line_buf* this object holds one row of the component indexed
@@ -325,6 +589,153 @@ namespace ojph {
      */
     line_buf* pull(ui32 &comp_num);
 
+    /**
+     * @brief Asks for the image to be pulled in strips of up to max_rows
+     *        rows of every component, with codestream::pull_strip().  It
+     *        is for a reading (decoding) codestream.  Call this function
+     *        after codestream::read_headers() but before
+     *        codestream::create().
+     *
+     *  Strips need all components to have the same number of lines, and
+     *  are not used for planar pulls; get_strip_height() tells, after
+     *  create().  codestream::pull() still works, one line of a strip at a
+     *  time, but the two should not be mixed within a strip.
+     *
+     * @param max_rows the most rows of a strip; 0 uses 32.
+     */
+    void request_strips(ui32 max_rows);                         //before create
+
+    /**
+     * @brief After codestream::create(), returns the most rows of a strip,
+     *        or 0 if strips are not used; see request_strips().
+     */
+    ui32 get_strip_height() const;
+
+    /**
+     * @brief After codestream::create(), returns the distance, in samples,
+     *        between consecutive rows of a component in a strip.  The rows
+     *        of a component lie in one block, each aligned, so that a strip
+     *        can be read as a 2D array.
+     */
+    size_t get_strip_pitch() const;
+
+    /**
+     * @brief Pulls the next rows of every component at once, which saves a
+     *        call down the tile, component and resolution chain for each
+     *        line, and lets the reader convert the rows as a block.
+     *
+     * @param rows returns the strip; row r of component c is
+     *             rows[c * get_strip_height() + r].  The lines stay valid
+     *             until the next pull.
+     * @return the number of rows pulled, 0 once all rows have been pulled;
+     *         a strip ends with its tile row, so it can be short.
+     */
+    ui32 pull_strip(line_buf *&rows);
+
+    /**
+     * @brief Asks a reading codestream to keep the lines of up to `levels`
+     *        resolutions below the one it reconstructs, so that after the
+     *        image is pulled, the images that skipping 1 to `levels` more
+     *        resolutions would give can be pulled with pull_retained(),
+     *        without decoding again.  Call this function after
+     *        codestream::read_headers() but before codestream::create().
+     *
+     *  Lines are only kept for codestreams of one tile, and without a
+     *  region; get_retained_levels() tells, after create().  Each level
+     *  holds a quarter of the samples of the one above it, at the width
+     *  of the wavelet samples.
+     *
+     * @param levels the most levels to keep; 0 keeps none.
+     */
+    void retain_resolutions(ui32 levels);                       //before create
+
+    /**
+     * @brief After codestream::create(), returns how many levels below the
+     *        reconstructed resolution are kept; see retain_resolutions().
+     */
+    ui32 get_retained_levels() const;
+
+    /**
+     * @brief Pulls the next line of component `comp_num` of the image
+     *        `level` resolutions below the one reconstructed, once every
+     *        line of the reconstructed image has been pulled.  It is
+     *        converted as pull() converts its lines, so it is the line the
+     *        same decode restricted by `level` more resolutions would give.
+     *        With a colour transform, pull the components of a line in
+     *        order, starting with component 0.  Moving to another level
+     *        starts it from its first line.
+     *
+     * @param level from 1 to get_retained_levels().
+     * @param comp_num the component.
+     * @return the line, or NULL past the last line of the component.
+     */
+    line_buf* pull_retained(ui32 level, ui32 comp_num);
+
+    /**
+     * @brief Pulls the dequantized samples of every subband of the
+     *        reconstructed resolutions into `sink`, instead of pulling lines
+     *        of the image; the inverse wavelet transform, the colour
+     *        transform and the conversion of samples are left to the sink.
+     *        Call this function after codestream::create(), in place of
+     *        pull().
+     *
+     *  Subbands are pulled component by component, from resolution 0 up,
+     *  so that every subband a resolution needs precedes it.  Codeblocks
+     *  are still decoded on the thread pool, if any.  Only codestreams of
+     *  one tile, coded with the wavelets of Part 1 and the full
+     *  decomposition of each level, can be pulled this way.
+     *
+     * @param sink receives the subbands.
+     * @return false if the sink stopped the pull.
+     */
+    bool pull_subbands(subband_sink *sink);
+
+    /**
+     * @brief For a reading (decoding) codestream, after
+     *        codestream::create(), returns how many fine resolutions were
+     *        not read whole, in at least one tile-component.
+     *
+     *  A resolution counts only if all of its packets, and those of every
+     *  lower resolution, were read in full, which is what a truncated
+     *  codestream in a resolution-major progression (RLCP or RPCL) still
+     *  offers.  Passing the returned value to restrict_input_resolution(),
+     *  for a fresh read of the same bytes, decodes the largest image they
+     *  describe completely; values above the number of decompositions mean
+     *  that not even the lowest resolution is complete.  Resilience must be
+     *  enabled to read a truncated codestream.
+     *
+     * @return ui32 the number of fine resolutions to skip.
+     */
+    ui32 get_num_incomplete_resolutions();                       //after create
+
+    /**
+     * @brief Caps the memory a reading codestream allocates up front, for
+     *        its lines, codeblocks and buffers.  Call this function after
+     *        codestream::read_headers() but before codestream::create().
+     *
+     *  When the allocations, sized at create(), would exceed the cap, the
+     *  buffers that only buy speed are given up rather than failing: the
+     *  strips, and with them tile-parallel decoding, and the resolutions
+     *  asked for with retain_resolutions().  The coded data read from the
+     *  file comes on top, and is not capped.
+     *
+     * @param bytes the cap; 0, the default, sets none.
+     */
+    void set_memory_limit(size_t bytes);                        //before create
+
+    /**
+     * @brief After codestream::create(), tells whether the memory limit
+     *        made the codestream give up buffers; see set_memory_limit().
+     */
+    bool is_memory_limited() const;
+
+    /**
+     * @brief Returns the bytes the codestream holds for its current image:
+     *        its allocations, and the stores of the coded data read or
+     *        written so far.
+     */
+    size_t get_memory_use() const;
+
     /**
      * @brief Call this function to close the underlying file; works for both
      *        encoding and decoding codestreams.
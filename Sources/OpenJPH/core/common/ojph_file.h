@@ -41,6 +41,8 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <condition_variable>
+#include <mutex>
 
 #include "ojph_arch.h"
 
@@ -303,6 +305,93 @@ namespace ojph {
     size_t size;
   };
 
+  ////////////////////////////////////////////////////////////////////////////
+  /**  @brief mmap_infile reads a codestream by mapping its file into memory
+   *
+   *  The codestream is read straight from the page cache, without first
+   *  being copied to the heap, and only the pages that are read are
+   *  brought in.  This suits codestreams held in large files, such as the
+   *  fragments of an encapsulated DICOM object, where the codestream is a
+   *  byte range of the file.  The file must not shrink while mapped.
+   */
+  class OJPH_EXPORT mmap_infile : public infile_base
+  {
+  public:
+    mmap_infile() { map = NULL; map_size = 0; }
+    ~mmap_infile() override { close(); }
+
+    /**  @brief Maps `length` bytes of an open file, from `offset` on.
+     *
+     *  The descriptor is not taken over; it may be closed once this
+     *  function returns.
+     */
+    void open(int fd, si64 offset, size_t length);
+
+    /**  @brief Maps a whole file. */
+    void open(const char *filename);
+
+    //read reads size bytes, returns the number of bytes read
+    size_t read(void *ptr, size_t size) override
+    { return view.read(ptr, size); }
+    //seek returns 0 on success
+    int seek(si64 offset, enum infile_base::seek origin) override
+    { return view.seek(offset, origin); }
+    si64 tell() override { return view.tell(); }
+    bool eof() override { return view.eof(); }
+    void close() override;
+
+  private:
+    mem_infile view;  // the mapped bytes of the codestream
+    void *map;        // the mapping starts at a page boundary before them
+    size_t map_size;
+  };
+
+  ////////////////////////////////////////////////////////////////////////////
+  /**  @brief stream_infile reads a codestream that arrives in pieces
+   *
+   *  One thread pushes bytes as they are received while the decoder reads
+   *  them on another.  A read, or a seek, that reaches beyond the bytes
+   *  received so far waits for more to be pushed instead of failing; only
+   *  after finish() does it behave like the end of a memory file.  All
+   *  pushed bytes are kept, so the decoder can seek back within them.
+   */
+  class OJPH_EXPORT stream_infile : public infile_base
+  {
+  public:
+    stream_infile() { buf = NULL; buf_size = used_size = cur = 0;
+                      finished = false; }
+    ~stream_infile() override { if (buf) free(buf); }
+
+    /**  @brief Call this function, from any thread, to append received
+     *         bytes; they become visible to a waiting reader at once.
+     *         Bytes pushed after finish() are ignored.
+     */
+    void push(const void *data, size_t size);
+
+    /**  @brief Call this function, from any thread, when no more bytes
+     *         will arrive; reads beyond the pushed bytes then come short.
+     */
+    void finish();
+
+    //read reads size bytes, returns the number of bytes read
+    size_t read(void *ptr, size_t size) override;
+    //seek returns 0 on success
+    int seek(si64 offset, enum infile_base::seek origin) override;
+    si64 tell() override { return (si64)cur; }
+    bool eof() override;
+
+  private:
+    size_t wait_for(size_t end); // returns used_size, once it reaches end
+                                 // or the stream is finished
+  private:
+    std::mutex mutex;
+    std::condition_variable arrived;
+    ui8 *buf;
+    size_t buf_size, used_size;  // used_size bytes have been pushed
+    size_t cur;                  // read position; only the reader moves it
+    bool finished;
+  };
+
 
 }
 
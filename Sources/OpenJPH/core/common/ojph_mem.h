@@ -39,15 +39,109 @@
 #ifndef OJPH_MEM_H
 #define OJPH_MEM_H
 
+#include <atomic>
 #include <cstdlib>
 #include <cassert>
+#include <climits>
 #include <cstring>
+#include <mutex>
 #include <type_traits>
 
 #include "ojph_arch.h"
 
 namespace ojph {
 
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief A process-wide pool of the memory stores that codestream
+   *         allocators are built on.
+   *
+   *  Stores come in size classes, four per octave, so a store released by
+   *  one codestream satisfies the next request of a similar size.  A
+   *  released store is kept in a free list of the releasing thread, or in
+   *  a shared free list when that one is full, instead of being returned
+   *  to the heap; once the pool stores are warm, decoding a sequence of
+   *  similar images does not go to the heap for its stores at all.  Idle
+   *  stores are retained up to a high-water limit; stores released beyond
+   *  it are freed.
+   */
+  class OJPH_EXPORT mem_store_pool
+  {
+  public:
+    struct stats
+    {
+      size_t reserved;   // bytes held by the pool, in use or idle
+      size_t in_use;     // bytes lent to allocators
+      size_t peak;       // largest in_use seen so far
+      size_t retention_limit; // largest number of idle bytes kept
+    };
+
+  public:
+    /**
+     *  @brief Returns the pool shared by all codestreams.
+     */
+    static mem_store_pool& get_instance();
+
+    /**
+     *  @brief Lends a store of at least `bytes` bytes.
+     *
+     *  @param granted returns the usable size of the store, which must be
+     *                 passed back to release().
+     *  @return the store, or NULL if the heap is exhausted.
+     */
+    void* acquire(size_t bytes, size_t& granted);
+
+    /**
+     *  @brief Returns a store obtained from acquire(); accepts NULL.
+     */
+    void release(void* store, size_t granted);
+
+    /**
+     *  @brief Sets how many bytes of idle stores may be kept; 0 returns
+     *         every released store to the heap.  Idle stores beyond a new,
+     *         lower limit are freed.  The default is 4 megabytes.
+     */
+    void set_retention_limit(size_t bytes);
+
+    /**
+     *  @brief Frees the idle stores of the shared list and of the calling
+     *         thread; other threads keep theirs until they exit.
+     */
+    void trim();
+
+    stats get_stats() const;
+
+  private:
+    enum : ui32 {
+      MIN_CLASS_LOG = 12,  // the smallest store holds 4 kB
+      NUM_CLASSES = 4 * (48 - MIN_CLASS_LOG), // larger ones are not pooled
+    };
+
+    // idle stores, linked through their first bytes, one list per class
+    struct free_list
+    {
+      void* head[NUM_CLASSES];
+      size_t bytes;
+    };
+
+  private:
+    mem_store_pool();
+    static si32 get_class(size_t bytes, size_t& class_bytes);
+    static size_t get_class_bytes(si32 store_class);
+    static free_list& get_local_list();
+    static void* pop(free_list& list, si32 store_class, size_t bytes);
+    static void push(free_list& list, si32 store_class, size_t bytes,
+                     void* store);
+    void free_stores(free_list& list, size_t limit);
+    bool claim_idle(size_t bytes);
+
+  private:
+    std::mutex mutex;                       // guards shared
+    free_list shared;
+    std::atomic<size_t> reserved, in_use, peak, idle;
+    std::atomic<size_t> retention_limit;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   class mem_fixed_allocator
   {
@@ -59,9 +153,13 @@ namespace ojph {
     }
     ~mem_fixed_allocator()
     {
-      if (store) free(store);
+      mem_store_pool::get_instance().release(store, allocated_data);
     }
 
+    // data, such as lines and codeblock buffers, starts on a multiple of
+    // byte_alignment (a cache line, except with Emscripten) after its
+    // pre_size samples, and its size is rounded up to a multiple of it;
+    // buffers filled by different threads therefore share no cache line
     template<typename T>
     void pre_alloc_data(size_t num_ele, ui32 pre_size)
     {
@@ -81,12 +179,16 @@ namespace ojph {
       {
         // We should be here once only, because, in subsequent, calls we
         // should have size_data + size_obj <= allocated_data
-        free(store);
-        allocated_data = size_data + size_obj;
-        allocated_data = allocated_data + (allocated_data + 19) / 20; // 5%
-        store = malloc(allocated_data);
+        mem_store_pool& pool = mem_store_pool::get_instance();
+        pool.release(store, allocated_data);
+        size_t needed = size_data + size_obj;
+        needed = needed + (needed + 19) / 20; // 5%
+        store = pool.acquire(needed, allocated_data);
         if (store == NULL)
+        {
+          allocated_data = 0;
           throw "malloc failed";
+        }
       }
       avail_obj = store;
       avail_data = (ui8*)store + size_obj;
@@ -116,6 +218,35 @@ namespace ojph {
         (num_ele, 0, avail_size_obj, avail_obj);
     }
 
+    // bytes of both regions, as alloc() needs them
+    size_t get_size() const { return size_data + size_obj; }
+
+    // each region is a stack; going back to an earlier position lets
+    // later allocations reuse memory whose users are done with it
+    struct position { size_t obj, data; };
+
+    position get_position() const
+    {
+      position p = { size_obj, size_data };
+      if (!preallocation)
+      { p.obj -= avail_size_obj; p.data -= avail_size_data; }
+      return p;
+    }
+
+    void set_position(const position& p)
+    {
+      if (preallocation)
+      { size_obj = p.obj; size_data = p.data; }
+      else
+      {
+        assert(p.obj <= size_obj && p.data <= size_data);
+        avail_obj = (ui8*)store + p.obj;
+        avail_size_obj = size_obj - p.obj;
+        avail_data = (ui8*)store + size_obj + p.data;
+        avail_size_data = size_data - p.data;
+      }
+    }
+
   private:
     template<typename T, int N>
     void pre_alloc_local(size_t num_ele, ui32 pre_size, size_t& sz)
@@ -167,14 +298,24 @@ namespace ojph {
     };
 
   public:
-    line_buf() : size(0), pre_size(0), flags(LFT_UNDEFINED), i32(0) {}
+    line_buf() : size(0), pre_size(0), flags(LFT_UNDEFINED),
+                 span_begin(0), span_end(UINT_MAX), i32(0) {}
 
     template<typename T>
     void wrap(T *buffer, size_t num_ele, ui32 pre_size);
 
+    // when decoding, the samples outside [span_begin, span_end) are zero;
+    // the span is only narrowed by stages that know it, and is clamped to
+    // the line's width by those that read it
+    void set_full_span() { span_begin = 0; span_end = UINT_MAX; }
+    void set_zero_span() { span_begin = UINT_MAX; span_end = 0; }
+    bool is_zero(ui32 width) const
+    { return span_begin >= ojph_min(span_end, width); }
+
     size_t size;
     ui32 pre_size;
     ui32 flags;
+    ui32 span_begin, span_end;
     union {
       si32* i32;  // 32bit integer type, used for lossless compression
       si64* i64;  // 64bit integer type, used for lossless compression
@@ -212,38 +353,34 @@ namespace ojph {
   {
     /*
       advantage: allocate large chunks of memory
+      get_buffer() may be called concurrently, by codeblock encoding jobs
     */
 
   public:
     mem_elastic_allocator(ui32 chunk_size)
     : chunk_size(chunk_size)
-    { cur_store = store = avail = NULL; total_allocated = 0; }
+    { cur_store = store = avail = NULL; total_allocated = used = 0; }
 
     ~mem_elastic_allocator()
     {
-      while (store) { // stores in use
-        stores_list* t = store->next_store;
-        free(store);
-        store = t;
-      }
-      while (avail) { // available stores
-        stores_list* t = avail->next_store;
-        free(avail);
-        avail = t;
-      }
+      release(store);  // stores in use
+      release(avail);  // available stores
     }
 
     void get_buffer(ui32 needed_bytes, coded_lists*& p);
     void restart();
+    // bytes of the stores holding data since the last restart()
+    size_t get_used() const { return used; }
 
   private:
     struct stores_list
     {
-      stores_list(ui32 available_bytes)
+      stores_list(ui32 available_bytes, size_t store_bytes)
       {
         this->next_store = NULL;
         this->orig_size = this->available = available_bytes;
         this->orig_data = this->data = (ui8*)this + sizeof(stores_list);
+        this->store_bytes = store_bytes;
       }
       void restart()
       {
@@ -258,15 +395,19 @@ namespace ojph {
       stores_list *next_store;
       ui8 *orig_data, *data;
       ui32 orig_size, available;
+      size_t store_bytes; // as granted by mem_store_pool
     };
 
     stores_list* allocate(stores_list** list, ui32 extended_bytes);
+    static void release(stores_list* list);
 
     stores_list *store;
     stores_list *cur_store;
     stores_list *avail;
     size_t total_allocated;
+    size_t used;
     const ui32 chunk_size;
+    std::mutex mutex;          // guards get_buffer()
   };
 
 
@@ -76,6 +76,9 @@ namespace ojph {
    *      class must override the virtual operator() to perform the desired 
    *      behaviour.  Remember for message_error, the user must throw an 
    *      exception at the end of the implementation of operator().
+   *   3. Calling set_message_sink; the default message objects then hand
+   *      their messages, formatted, to a user function instead of the
+   *      streams, filtered by level and rate before they are formatted.
    * 
    *   The customization is global, and cannot be separately tailored for
    *   each decoder's instantiation.
@@ -262,6 +265,45 @@ namespace ojph {
    */
   OJPH_EXPORT
     void set_message_level(OJPH_MSG_LEVEL level);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * @brief A function that receives the messages of the default message
+   *        objects in place of the streams; messages are formatted with
+   *        their arguments, without the code, file and line prefix.
+   */
+  typedef void (*message_sink)(void *context, OJPH_MSG_LEVEL level,
+                               int code, const char *file_name,
+                               int line_num, const char *message);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * @brief Hands the messages of the default message objects to a sink.
+   *
+   *  Messages below min_level, and those beyond max_per_second in any
+   *  second, are dropped before they are formatted; a max_per_second of 0
+   *  does not limit them.  Errors still throw after the sink returns.
+   *  The sink is called from the thread that raised the message, under a
+   *  lock, so it is never called again once this function returns with
+   *  another sink; it must not call set_message_sink.  A NULL sink
+   *  restores the streams.
+   *
+   * @param sink           the function receiving the messages, or NULL.
+   * @param context        passed to sink unchanged.
+   * @param min_level      the least severity delivered.
+   * @param max_per_second the most messages delivered in a second.
+   */
+  OJPH_EXPORT
+    void set_message_sink(message_sink sink, void *context,
+                          OJPH_MSG_LEVEL min_level, ui32 max_per_second);
+
+  //////////////////////////////////////////////////////////////////////////////
+  /**
+   * @brief Returns how many messages the rate limit of the message sink
+   *        has dropped since the sink was set.
+   */
+  OJPH_EXPORT
+    ui64 get_dropped_messages();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -126,6 +126,7 @@ namespace ojph {
     bool packets_may_use_sop() const;
     bool packets_use_eph() const;
     bool get_block_vertical_causality() const;
+    bool is_high_throughput() const;   // HTJ2K codeblocks, not Part 1 ones
 
   private:
     local::param_cod* state;
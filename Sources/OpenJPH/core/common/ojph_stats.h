@@ -0,0 +1,196 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_stats.h
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#ifndef OJPH_STATS_H
+#define OJPH_STATS_H
+
+#include <atomic>
+
+#include "ojph_arch.h"
+
+namespace ojph {
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief The coded data of an HT codeblock, and the parameters needed
+   *         to decode it again, as handed to a codeblock_sink.
+   */
+  struct codeblock_record
+  {
+    const ui8 *coded;      // lengths[0] + lengths[1] bytes of coded data
+    ui32 lengths[2];       // of the cleanup pass, and of the SigProp and
+                           // MagRef passes
+    ui32 missing_msbs;
+    ui32 num_passes;
+    ui32 width, height;
+    ui32 K_max;            // bitplanes of the subband
+    float delta;           // step size of irreversible subbands
+    bool stripe_causal;
+    bool reversible;
+    bool wide;             // decoded into 64-bit samples
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Receives every HT codeblock before it is decoded, e.g. to
+   *         replay real codeblocks in kernel benchmarks.
+   *
+   *  capture() runs on the threads that decode the codeblocks, possibly
+   *  several at once; the record is only valid during the call.
+   */
+  class OJPH_EXPORT codeblock_sink
+  {
+  public:
+    virtual ~codeblock_sink() {}
+    virtual void capture(const codeblock_record& cb) = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Time spent in the stages of one decode, and counters of the
+   *         work done.
+   *
+   *  Stage times are in nanoseconds and exclusive of each other: a stage
+   *  entered from within another one, on the same thread, pauses it.
+   *  Stages that run on pool workers are summed over threads, so that
+   *  their total can exceed the elapsed time of the decode.  All fields
+   *  are updated with relaxed atomics.
+   *
+   *  The instrumentation compiles to nothing when OJPH_DISABLE_STATS is
+   *  defined; otherwise, a codestream that was not given a decode_stats
+   *  with codestream::set_stats() only tests a pointer per stage.
+   *  The codeblock sink is not part of the instrumentation, and is called
+   *  in either case.
+   */
+  struct OJPH_EXPORT decode_stats
+  {
+    enum stage : ui32 {
+      HEADERS = 0,    // main and tile-part header marker segments
+      PACKETS,        // packet headers and bodies
+      BLOCKS,         // codeblock decoding
+      BLOCK_WAIT,     // waiting for codeblocks decoded by pool workers
+      IDWT,           // inverse wavelet transform
+      COLOUR,         // inverse colour transform and level shift
+      OUTPUT,         // conversion of lines into the caller's samples
+      NUM_STAGES
+    };
+
+    enum counter : ui32 {
+      BYTES_PARSED = 0,    // codestream bytes read, headers included
+      PACKETS_PARSED,      // packets whose headers were read
+      PACKETS_SKIPPED,     // packets stepped over with PLT lengths
+      CODEBLOCKS_DECODED,  // codeblocks with coding passes, decoded
+      ZERO_BLOCKS,         // codeblocks without coding passes, or skipped
+      MEMORY_BYTES,        // held by the decode at its peak, by the reader
+      MEMORY_LIMITED,      // 1 if the memory limit gave up buffers
+      NUM_COUNTERS
+    };
+
+    decode_stats() : sink(NULL) { reset(); }
+
+    void reset()
+    {
+      for (ui32 i = 0; i < NUM_STAGES; ++i)
+        stage_ns[i].store(0, std::memory_order_relaxed);
+      for (ui32 i = 0; i < NUM_COUNTERS; ++i)
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+
+    void add_time(stage s, ui64 ns)
+    { stage_ns[s].fetch_add(ns, std::memory_order_relaxed); }
+    void add(counter c, ui64 n)
+    { counts[c].fetch_add(n, std::memory_order_relaxed); }
+
+    ui64 get_time(stage s) const
+    { return stage_ns[s].load(std::memory_order_relaxed); }
+    ui64 get_count(counter c) const
+    { return counts[c].load(std::memory_order_relaxed); }
+
+    /** @brief Nanoseconds of a monotonic clock. */
+    static ui64 now();
+
+    /** @brief Given every HT codeblock before it is decoded; see
+     *         codeblock_sink.  Not changed by reset(). */
+    codeblock_sink *sink;
+
+  private:
+    std::atomic<ui64> stage_ns[NUM_STAGES];
+    std::atomic<ui64> counts[NUM_COUNTERS];
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Adds the time of its scope to one stage of a decode_stats.
+   *
+   *  Timers of one thread nest: a timer pauses the one that was running
+   *  when it was created, and resumes it when it is destroyed.  A timer
+   *  given a NULL decode_stats does nothing.
+   */
+  class OJPH_EXPORT stage_timer
+  {
+  public:
+    stage_timer(decode_stats *stats, decode_stats::stage s)
+    : stats(stats), s(s), start(0), outer(NULL)
+    { if (stats) begin(); }
+    ~stage_timer() { if (stats) end(); }
+
+    stage_timer(const stage_timer&) = delete;
+    stage_timer& operator=(const stage_timer&) = delete;
+
+  private:
+    void begin();
+    void end();
+
+  private:
+    decode_stats *stats;
+    decode_stats::stage s;
+    ui64 start;           // when the timer last started or resumed
+    stage_timer *outer;   // the timer this one paused
+  };
+
+}
+
+#ifdef OJPH_DISABLE_STATS
+  #define OJPH_STATS_TIMER(stats, stage)
+  #define OJPH_STATS_COUNT(stats, counter, n) do {} while (0)
+#else
+  #define OJPH_STATS_TIMER(stats, stage)                                    \
+    ojph::stage_timer ojph_stats_timer(stats, ojph::decode_stats::stage)
+  #define OJPH_STATS_COUNT(stats, counter, n)                               \
+    do { if (stats) (stats)->add(ojph::decode_stats::counter, n); }        \
+    while (0)
+#endif
+
+#endif // !OJPH_STATS_H
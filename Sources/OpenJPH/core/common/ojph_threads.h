@@ -0,0 +1,148 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_threads.h
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#ifndef OJPH_THREADS_H
+#define OJPH_THREADS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ojph_arch.h"
+
+namespace ojph {
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief A unit of work that can be queued on a thread_pool.
+   *
+   *  The pool does not take ownership of tasks; the submitter must keep a
+   *  task alive until it has been executed.
+   */
+  class OJPH_EXPORT worker_thread_base
+  {
+  public:
+    virtual ~worker_thread_base() {}
+    virtual void execute() = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief A fixed-size, work-stealing pool of worker threads.
+   *
+   *  Every worker owns a task queue; tasks added by a worker go to its own
+   *  queue and are taken back most-recent first, which keeps the data they
+   *  touch in cache.  Tasks added by other threads go to a shared queue.
+   *  An idle worker first drains its own queue, then the shared queue, and
+   *  then steals the oldest task from another worker.
+   */
+  class OJPH_EXPORT thread_pool
+  {
+  public:
+    thread_pool() : queues(NULL), num_queues(0), num_pending(0), stop(false)
+    {}
+    ~thread_pool();
+
+    /**
+     *  @brief Starts num_threads workers; must be called once, before
+     *         any task is added.
+     */
+    void init(size_t num_threads);
+
+    /**
+     *  @brief Queues a task; it runs on the first worker that gets to it.
+     */
+    void add_task(worker_thread_base* task);
+
+    /**
+     *  @brief Runs one queued task on the calling thread, if any.
+     *
+     *  This lets a thread that waits for its own tasks help draining the
+     *  queues instead of sleeping.
+     *
+     *  @return true if a task was executed.
+     */
+    bool run_pending_task();
+
+    size_t get_num_threads() const { return threads.size(); }
+
+  private:
+    struct task_queue
+    {
+      std::mutex mutex;
+      std::deque<worker_thread_base*> tasks;
+    };
+
+    static void start_thread(thread_pool* tp, size_t index);
+    size_t home_queue() const;
+    worker_thread_base* pop_from(size_t idx, bool newest);
+    worker_thread_base* pop_task(size_t home);
+
+  private:
+    std::vector<std::thread> threads;
+    task_queue* queues;    // one per worker, plus a shared one at the end
+    size_t num_queues;
+    std::atomic<size_t> num_pending;
+    std::mutex sleep_mutex;
+    std::condition_variable condition;
+    bool stop;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  /**
+   *  @brief Blocks a thread until a known number of tasks have finished.
+   */
+  class OJPH_EXPORT task_latch
+  {
+  public:
+    explicit task_latch(ui32 count = 0) : count(count) {}
+
+    void add(ui32 n);
+    void count_down();
+    void wait();
+    bool is_done() { return count.load(std::memory_order_acquire) == 0; }
+
+  private:
+    std::atomic<ui32> count;
+    std::mutex mutex;
+    std::condition_variable condition;
+  };
+
+}
+
+#endif // !OJPH_THREADS_H
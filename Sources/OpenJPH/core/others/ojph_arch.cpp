@@ -35,6 +35,7 @@
 // Date: 28 August 2019
 //***************************************************************************/
 
+#include <atomic>
 #include <cassert>
 
 #include "ojph_arch.h"
@@ -237,14 +238,31 @@ namespace ojph {
 #endif
 
   ////////////////////////////////////////////////////////////////////////////
-  static int cpu_level;
-  static bool cpu_level_initialized = init_cpu_ext_level(cpu_level);
+  static std::atomic<int> cpu_level_cap(-1);
 
   ////////////////////////////////////////////////////////////////////////////
-  int get_cpu_ext_level()
+  int get_detected_cpu_ext_level()
   {
-    assert(cpu_level_initialized);
+    // a function-local static is initialized once, even when the first
+    // calls come from several threads
+    static int cpu_level = -1;
+    static bool cpu_level_initialized = init_cpu_ext_level(cpu_level);
+    assert(cpu_level_initialized); ojph_unused(cpu_level_initialized);
     return cpu_level;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  int get_cpu_ext_level()
+  {
+    int level = get_detected_cpu_ext_level();
+    int cap = cpu_level_cap.load(std::memory_order_relaxed);
+    return (cap >= 0 && cap < level) ? cap : level;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void set_cpu_ext_level_cap(int level)
+  {
+    cpu_level_cap.store(level < 0 ? -1 : level, std::memory_order_relaxed);
+  }
+
 }
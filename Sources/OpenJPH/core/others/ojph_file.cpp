@@ -42,10 +42,22 @@
 
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 
 #include "ojph_file.h"
 #include "ojph_message.h"
 
+#ifdef OJPH_OS_WINDOWS
+  #include <fcntl.h>
+  #include <io.h>
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
 namespace ojph {
 
   ////////////////////////////////////////////////////////////////////////////
@@ -332,5 +344,197 @@ namespace ojph {
     return result;
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  //
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mmap_infile::open(int fd, si64 offset, size_t length)
+  {
+    assert(map == NULL);
+    if (fd < 0 || offset < 0 || length == 0)
+      OJPH_ERROR(0x00060006, "mmap_infile needs a file and a byte range");
+
+#ifdef OJPH_OS_WINDOWS
+    HANDLE fh = (HANDLE)_get_osfhandle(fd);
+    LARGE_INTEGER file_size;
+    if (fh == INVALID_HANDLE_VALUE || !GetFileSizeEx(fh, &file_size))
+      OJPH_ERROR(0x00060007, "mmap_infile cannot query the file size");
+    if ((ui64)offset > (ui64)file_size.QuadPart ||
+        length > (ui64)file_size.QuadPart - (ui64)offset)
+      OJPH_ERROR(0x00060008, "mmap_infile byte range goes beyond the end "
+        "of the file");
+
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    ui64 granularity = info.dwAllocationGranularity;
+    ui64 map_offset = (ui64)offset - (ui64)offset % granularity;
+    size_t delta = (size_t)((ui64)offset - map_offset);
+    HANDLE mapping = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL)
+    {
+      map = MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)(map_offset >> 32),
+        (DWORD)(map_offset & 0xFFFFFFFFu), delta + length);
+      CloseHandle(mapping); // the view keeps the mapping alive
+    }
+    if (map == NULL)
+      OJPH_ERROR(0x00060009, "mmap_infile failed to map the file");
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+      OJPH_ERROR(0x00060007, "mmap_infile cannot query the file size");
+    if (offset > (si64)st.st_size ||
+        length > (ui64)((si64)st.st_size - offset))
+      OJPH_ERROR(0x00060008, "mmap_infile byte range goes beyond the end "
+        "of the file");
+
+    ui64 page = (ui64)sysconf(_SC_PAGESIZE);
+    ui64 map_offset = (ui64)offset - (ui64)offset % page;
+    size_t delta = (size_t)((ui64)offset - map_offset);
+    void *p = mmap(NULL, delta + length, PROT_READ, MAP_PRIVATE, fd,
+                   (off_t)map_offset);
+    if (p == MAP_FAILED)
+      OJPH_ERROR(0x00060009, "mmap_infile failed to map the file");
+    map = p;
+#endif
+    map_size = delta + length;
+    view.open((const ui8*)map + delta, length);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  static void close_descriptor(int fd)
+  {
+#ifdef OJPH_OS_WINDOWS
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mmap_infile::open(const char *filename)
+  {
+#ifdef OJPH_OS_WINDOWS
+    int fd = _open(filename, _O_RDONLY | _O_BINARY);
+    si64 size = fd < 0 ? 0 : _lseeki64(fd, 0, SEEK_END);
+#else
+    int fd = ::open(filename, O_RDONLY);
+    si64 size = fd < 0 ? 0 : (si64)lseek(fd, 0, SEEK_END);
+#endif
+    if (fd < 0)
+      OJPH_ERROR(0x00060002, "failed to open %s for reading", filename);
+
+    // the mapping does not need the descriptor
+    try {
+      open(fd, 0, size > 0 ? (size_t)size : 0);
+    }
+    catch (...) {
+      close_descriptor(fd);
+      throw;
+    }
+    close_descriptor(fd);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mmap_infile::close()
+  {
+    if (map != NULL)
+    {
+#ifdef OJPH_OS_WINDOWS
+      UnmapViewOfFile(map);
+#else
+      munmap(map, map_size);
+#endif
+    }
+    map = NULL;
+    map_size = 0;
+    view.close();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  //
+  //
+  //
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  void stream_infile::push(const void *data, size_t size)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (finished || size == 0)
+        return;
+      if (used_size + size > buf_size)
+      {
+        size_t needed_size = used_size + size;
+        needed_size += (needed_size + 1) >> 1; // x1.5
+        ui8 *p = (ui8*)realloc(buf, needed_size);
+        if (p == NULL)
+          OJPH_ERROR(0x00060005, "stream_infile failed to allocate memory");
+        buf = p;
+        buf_size = needed_size;
+      }
+      memcpy(buf + used_size, data, size);
+      used_size += size;
+    }
+    arrived.notify_all();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void stream_infile::finish()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+    arrived.notify_all();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t stream_infile::wait_for(size_t end)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    arrived.wait(lock, [&] { return used_size >= end || finished; });
+    return used_size;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t stream_infile::read(void *ptr, size_t size)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    arrived.wait(lock, [&] { return used_size - cur >= size || finished; });
+    size_t bytes_to_read = ojph_min(size, used_size - cur);
+    memcpy(ptr, buf + cur, bytes_to_read);
+    cur += bytes_to_read;
+    return bytes_to_read;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  int stream_infile::seek(si64 offset, enum infile_base::seek origin)
+  {
+    if (origin == OJPH_SEEK_CUR)
+      offset += (si64)cur;
+    else if (origin == OJPH_SEEK_END)
+      offset += (si64)wait_for(SIZE_MAX); // the end is known once finished
+    else
+      assert(origin == OJPH_SEEK_SET);
+
+    if (offset < 0 || (size_t)offset > wait_for((size_t)offset))
+      return -1;
+    cur = (size_t)offset;
+    return 0;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool stream_infile::eof()
+  {
+    return wait_for(cur + 1) <= cur;
+  }
 
 }
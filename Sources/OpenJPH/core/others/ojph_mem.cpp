@@ -56,6 +56,7 @@ namespace ojph {
     this->i32 = buffer;
     this->size = num_ele;
     this->pre_size = pre_size;
+    set_full_span();
     this->flags = LFT_32BIT | LFT_INTEGER;
   }
 
@@ -66,6 +67,7 @@ namespace ojph {
     this->f32 = buffer;
     this->size = num_ele;
     this->pre_size = pre_size;
+    set_full_span();
     this->flags = LFT_32BIT;
   }
 
@@ -76,6 +78,7 @@ namespace ojph {
     this->i64 = buffer;
     this->size = num_ele;
     this->pre_size = pre_size;
+    set_full_span();
     this->flags = LFT_64BIT | LFT_INTEGER;
   }
 
@@ -87,6 +90,219 @@ namespace ojph {
   //
   ////////////////////////////////////////////////////////////////////////////
 
+  ////////////////////////////////////////////////////////////////////////////
+  mem_store_pool& mem_store_pool::get_instance()
+  {
+    // never destroyed, so that threads exiting late can still hand their
+    // stores back
+    static mem_store_pool* pool = new mem_store_pool;
+    return *pool;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  mem_store_pool::mem_store_pool()
+  : reserved(0), in_use(0), peak(0), idle(0),
+    retention_limit((size_t)4 << 20) // 4 megabytes; larger is opt-in
+  {
+    memset(&shared, 0, sizeof(shared));
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // Classes grow by a quarter of an octave: 4 kB, 5 kB, 6 kB, 7 kB, 8 kB,
+  // 10 kB, ...; returns -1 for stores too large to be pooled.
+  si32 mem_store_pool::get_class(size_t bytes, size_t& class_bytes)
+  {
+    if (bytes <= ((size_t)1 << MIN_CLASS_LOG))
+    {
+      class_bytes = (size_t)1 << MIN_CLASS_LOG;
+      return 0;
+    }
+    ui32 log = 63 - count_leading_zeros((ui64)(bytes - 1));
+    size_t step = (size_t)1 << (log - 2);
+    size_t quarters = (bytes - ((size_t)1 << log) + step - 1) >> (log - 2);
+    ui32 store_class = (log - MIN_CLASS_LOG) * 4 + (ui32)quarters;
+    if (store_class >= NUM_CLASSES)
+    {
+      class_bytes = bytes;
+      return -1;
+    }
+    class_bytes = (4 + quarters) << (log - 2);
+    return (si32)store_class;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t mem_store_pool::get_class_bytes(si32 store_class)
+  {
+    return ((4 + (size_t)(store_class & 3)) << (MIN_CLASS_LOG - 2))
+      << (store_class >> 2);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  mem_store_pool::free_list& mem_store_pool::get_local_list()
+  {
+    // the stores of an exiting thread move to the shared list
+    struct local_list : free_list
+    {
+      local_list() { memset(this, 0, sizeof(free_list)); }
+      ~local_list()
+      {
+        mem_store_pool& pool = get_instance();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        for (si32 c = 0; c < (si32)NUM_CLASSES; ++c)
+          while (head[c] != NULL)
+            push(pool.shared, c, get_class_bytes(c),
+                 pop(*this, c, get_class_bytes(c)));
+      }
+    };
+    static thread_local local_list list;
+    return list;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void* mem_store_pool::pop(free_list& list, si32 store_class, size_t bytes)
+  {
+    void* store = list.head[store_class];
+    if (store != NULL)
+    {
+      list.head[store_class] = *(void**)store;
+      list.bytes -= bytes;
+    }
+    return store;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_store_pool::push(free_list& list, si32 store_class, size_t bytes,
+                            void* store)
+  {
+    *(void**)store = list.head[store_class];
+    list.head[store_class] = store;
+    list.bytes += bytes;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool mem_store_pool::claim_idle(size_t bytes)
+  {
+    size_t cur = idle.load(std::memory_order_relaxed);
+    do {
+      if (cur + bytes > retention_limit.load(std::memory_order_relaxed))
+        return false;
+    } while (!idle.compare_exchange_weak(cur, cur + bytes,
+                                         std::memory_order_relaxed));
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void* mem_store_pool::acquire(size_t bytes, size_t& granted)
+  {
+    si32 store_class = get_class(bytes, granted);
+    void* store = NULL;
+    if (store_class >= 0)
+    {
+      store = pop(get_local_list(), store_class, granted);
+      if (store == NULL)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        store = pop(shared, store_class, granted);
+      }
+    }
+    if (store != NULL)
+      idle.fetch_sub(granted, std::memory_order_relaxed);
+    else
+    {
+      store = malloc(granted);
+      if (store == NULL)
+        return NULL;
+      reserved.fetch_add(granted, std::memory_order_relaxed);
+    }
+
+    size_t now =
+      in_use.fetch_add(granted, std::memory_order_relaxed) + granted;
+    size_t cur = peak.load(std::memory_order_relaxed);
+    while (now > cur &&
+           !peak.compare_exchange_weak(cur, now, std::memory_order_relaxed))
+      ;
+    return store;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_store_pool::release(void* store, size_t granted)
+  {
+    if (store == NULL)
+      return;
+    in_use.fetch_sub(granted, std::memory_order_relaxed);
+
+    size_t class_bytes;
+    si32 store_class = get_class(granted, class_bytes);
+    if (store_class < 0 || !claim_idle(granted))
+    {
+      free(store);
+      reserved.fetch_sub(granted, std::memory_order_relaxed);
+      return;
+    }
+    assert(class_bytes == granted);
+
+    // a thread keeps up to an eighth of the limit for itself
+    free_list& local = get_local_list();
+    if (local.bytes + granted <=
+        retention_limit.load(std::memory_order_relaxed) / 8)
+      push(local, store_class, granted, store);
+    else
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      push(shared, store_class, granted, store);
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // frees the stores of `list`, the largest first, until no more than
+  // `limit` idle bytes remain in the pool
+  void mem_store_pool::free_stores(free_list& list, size_t limit)
+  {
+    for (si32 c = (si32)NUM_CLASSES - 1; c >= 0 && list.bytes != 0; --c)
+    {
+      size_t class_bytes = get_class_bytes(c);
+      while (idle.load(std::memory_order_relaxed) > limit)
+      {
+        void* store = pop(list, c, class_bytes);
+        if (store == NULL)
+          break;
+        free(store);
+        idle.fetch_sub(class_bytes, std::memory_order_relaxed);
+        reserved.fetch_sub(class_bytes, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_store_pool::set_retention_limit(size_t bytes)
+  {
+    retention_limit.store(bytes, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free_stores(shared, bytes);
+    }
+    free_stores(get_local_list(), bytes);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_store_pool::trim()
+  {
+    free_stores(get_local_list(), 0);
+    std::lock_guard<std::mutex> lock(mutex);
+    free_stores(shared, 0);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  mem_store_pool::stats mem_store_pool::get_stats() const
+  {
+    stats s;
+    s.reserved = reserved.load(std::memory_order_relaxed);
+    s.in_use = in_use.load(std::memory_order_relaxed);
+    s.peak = peak.load(std::memory_order_relaxed);
+    s.retention_limit = retention_limit.load(std::memory_order_relaxed);
+    return s;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   mem_elastic_allocator::stores_list*
   mem_elastic_allocator::allocate(mem_elastic_allocator::stores_list** list,
@@ -98,14 +314,30 @@ namespace ojph {
       *list = avail;
       avail = avail->next_store;
       (*list)->restart();
+      used += (*list)->store_bytes;
       return *list;
     }
     else
     {
       ui32 store_bytes = stores_list::eval_store_bytes(bytes);
-      *list = (stores_list*) malloc(store_bytes);
-      total_allocated += store_bytes;
-      return new (*list) stores_list(bytes);
+      size_t granted;
+      *list = (stores_list*)
+        mem_store_pool::get_instance().acquire(store_bytes, granted);
+      if (*list == NULL)
+        throw "malloc failed";
+      total_allocated += granted;
+      used += granted;
+      return new (*list) stores_list(bytes, granted);
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void mem_elastic_allocator::release(stores_list* list)
+  {
+    while (list) {
+      stores_list* t = list->next_store;
+      mem_store_pool::get_instance().release(list, list->store_bytes);
+      list = t;
     }
   }
 
@@ -114,6 +346,7 @@ namespace ojph {
   {
     ui32 extended_bytes = needed_bytes + (ui32)sizeof(coded_lists);
 
+    std::lock_guard<std::mutex> lock(mutex);
     if (store == NULL)
       cur_store = store = allocate(&store, extended_bytes);
     else if (cur_store->available < extended_bytes)
@@ -135,6 +368,7 @@ namespace ojph {
       p = &((*p)->next_store);
     *p = store;
     cur_store = store = NULL;
+    used = 0;
   }
 
 }
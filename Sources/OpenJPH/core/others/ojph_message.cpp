@@ -35,15 +35,86 @@
 // Date: 29 August 2019
 //***************************************************************************/
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdarg>
+#include <mutex>
 #include <stdexcept>
 
 #include "ojph_message.h"
 
 namespace ojph {
 
+  ////////////////////////////////////////////////////////////////////////////
+  // the sink of set_message_sink; sink_level is NO_MSG + 1 while there is
+  // none, so that the streams are used without taking sink_mutex
+  static std::mutex sink_mutex;
+  static message_sink sink_function = NULL;
+  static void *sink_context = NULL;
+  static std::atomic<int> sink_level(OJPH_MSG_LEVEL::NO_MSG + 1);
+  static ui32 sink_rate = 0;
+  static si64 sink_second = 0;     // the second of sink_count messages
+  static ui32 sink_count = 0;
+  static std::atomic<ui64> sink_dropped(0);
+
+  ////////////////////////////////////////////////////////////////////////////
+  void set_message_sink(message_sink sink, void *context,
+                        OJPH_MSG_LEVEL min_level, ui32 max_per_second)
+  {
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    sink_function = sink;
+    sink_context = context;
+    sink_rate = max_per_second;
+    sink_count = 0;
+    sink_dropped = 0;
+    sink_level = sink ? (int)min_level : OJPH_MSG_LEVEL::NO_MSG + 1;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui64 get_dropped_messages()
+  {
+    return sink_dropped;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  // returns false when there is no sink, and the streams are to be used
+  static bool sink_message(OJPH_MSG_LEVEL level, int code,
+                           const char *file_name, int line_num,
+                           const char *fmt, va_list args)
+  {
+    int min_level = sink_level.load(std::memory_order_relaxed);
+    if (min_level > OJPH_MSG_LEVEL::NO_MSG)
+      return false;
+    if (level < min_level)
+      return true;
+
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (sink_function == NULL)
+      return false;
+    if (sink_rate != 0)
+    {
+      si64 second = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      if (second != sink_second)
+      {
+        sink_second = second;
+        sink_count = 0;
+      }
+      if (sink_count >= sink_rate)
+      {
+        ++sink_dropped;
+        return true;
+      }
+      ++sink_count;
+    }
+    char message[512];
+    vsnprintf(message, sizeof(message), fmt, args);
+    sink_function(sink_context, level, code, file_name, line_num, message);
+    return true;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   FILE* info_stream = stdout;
 
@@ -74,12 +145,16 @@ namespace ojph {
   void message_info::operator()(int info_code, const char* file_name,
     int line_num, const char* fmt, ...)
   {
-    if (info_stream == NULL || message_level > OJPH_MSG_LEVEL::INFO)
+    va_list args;
+    va_start(args, fmt);
+    bool sunk = sink_message(OJPH_MSG_LEVEL::INFO, info_code, file_name,
+                             line_num, fmt, args);
+    va_end(args);
+    if (sunk || info_stream == NULL || message_level > OJPH_MSG_LEVEL::INFO)
       return;
     
     fprintf(info_stream, "ojph info 0x%08X at %s:%d: ",
       info_code, file_name, line_num);
-    va_list args;
     va_start(args, fmt);
     vfprintf(info_stream, fmt, args);
     fprintf(info_stream, "\n");
@@ -115,12 +190,17 @@ namespace ojph {
   void message_warning::operator()(int warn_code, const char* file_name,
     int line_num, const char *fmt, ...)
   {
-    if (warning_stream == NULL || message_level > OJPH_MSG_LEVEL::WARN)
+    va_list args;
+    va_start(args, fmt);
+    bool sunk = sink_message(OJPH_MSG_LEVEL::WARN, warn_code, file_name,
+                             line_num, fmt, args);
+    va_end(args);
+    if (sunk || warning_stream == NULL ||
+        message_level > OJPH_MSG_LEVEL::WARN)
       return;
 
     fprintf(warning_stream, "ojph warning 0x%08X at %s:%d: ",
       warn_code, file_name, line_num);
-    va_list args;
     va_start(args, fmt);
     vfprintf(warning_stream, fmt, args);
     fprintf(warning_stream, "\n");
@@ -156,18 +236,28 @@ namespace ojph {
   void message_error::operator()(int error_code, const char* file_name,
     int line_num, const char *fmt, ...)
   {
-    if (error_stream != NULL && message_level <= OJPH_MSG_LEVEL::ERROR)
+    va_list args;
+    va_start(args, fmt);
+    bool sunk = sink_message(OJPH_MSG_LEVEL::ERROR, error_code, file_name,
+                             line_num, fmt, args);
+    va_end(args);
+    if (!sunk && error_stream != NULL &&
+        message_level <= OJPH_MSG_LEVEL::ERROR)
     {
       fprintf(error_stream, "ojph error 0x%08X at %s:%d: ",
         error_code, file_name, line_num);
-      va_list args;
       va_start(args, fmt);
       vfprintf(error_stream, fmt, args);
       fprintf(error_stream, "\n");
       va_end(args);
     }
 
-    throw std::runtime_error("ojph error");
+    // the exception carries the message, for callers that report it
+    char message[512];
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    throw std::runtime_error(message);
   }
 
   ////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,73 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_stats.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include <chrono>
+
+#include "ojph_stats.h"
+
+namespace ojph {
+
+  ////////////////////////////////////////////////////////////////////////////
+  // the innermost timer running on this thread
+  static thread_local stage_timer* current_timer = NULL;
+
+  ////////////////////////////////////////////////////////////////////////////
+  ui64 decode_stats::now()
+  {
+    return (ui64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void stage_timer::begin()
+  {
+    start = decode_stats::now();
+    outer = current_timer;
+    if (outer)
+      outer->stats->add_time(outer->s, start - outer->start);
+    current_timer = this;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void stage_timer::end()
+  {
+    ui64 t = decode_stats::now();
+    stats->add_time(s, t - start);
+    if (outer)
+      outer->start = t;
+    current_timer = outer;
+  }
+
+}
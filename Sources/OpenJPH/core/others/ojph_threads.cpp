@@ -0,0 +1,192 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_threads.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_threads.h"
+
+namespace ojph {
+
+  ////////////////////////////////////////////////////////////////////////////
+  // identifies the pool and queue of the worker running on this thread
+  static thread_local const thread_pool* current_pool = NULL;
+  static thread_local size_t current_queue = 0;
+
+  ////////////////////////////////////////////////////////////////////////////
+  thread_pool::~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stop = true;
+    }
+    condition.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+    delete[] queues;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void thread_pool::init(size_t num_threads)
+  {
+    num_queues = num_threads + 1;
+    queues = new task_queue[num_queues];
+    threads.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i)
+      threads.emplace_back(start_thread, this, i);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  size_t thread_pool::home_queue() const
+  {
+    return current_pool == this ? current_queue : num_queues - 1;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void thread_pool::add_task(worker_thread_base* task)
+  {
+    task_queue& q = queues[home_queue()];
+    {
+      std::lock_guard<std::mutex> lock(q.mutex);
+      q.tasks.push_back(task);
+    }
+    num_pending.fetch_add(1, std::memory_order_release);
+    {
+      // taking the lock orders this notification after a sleeping worker
+      // has checked num_pending, so the wake-up cannot be lost
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    condition.notify_one();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  worker_thread_base* thread_pool::pop_from(size_t idx, bool newest)
+  {
+    task_queue& q = queues[idx];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+      return NULL;
+    worker_thread_base* task;
+    if (newest) {
+      task = q.tasks.back();
+      q.tasks.pop_back();
+    }
+    else {
+      task = q.tasks.front();
+      q.tasks.pop_front();
+    }
+    num_pending.fetch_sub(1, std::memory_order_acq_rel);
+    return task;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  worker_thread_base* thread_pool::pop_task(size_t home)
+  {
+    if (num_pending.load(std::memory_order_acquire) == 0)
+      return NULL;
+
+    // own queue first (newest task), then the shared queue, then steal the
+    // oldest task of the other workers, starting with the next one
+    const size_t shared = num_queues - 1;
+    worker_thread_base* task = pop_from(home, home != shared);
+    if (task == NULL && home != shared)
+      task = pop_from(shared, false);
+    size_t start = home == shared ? 0 : home + 1;
+    for (size_t k = 0; task == NULL && k < shared; ++k)
+    {
+      size_t idx = (start + k) % shared;
+      if (idx != home)
+        task = pop_from(idx, false);
+    }
+    return task;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  bool thread_pool::run_pending_task()
+  {
+    if (queues == NULL)
+      return false;
+    worker_thread_base* task = pop_task(home_queue());
+    if (task == NULL)
+      return false;
+    task->execute();
+    return true;
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void thread_pool::start_thread(thread_pool* tp, size_t index)
+  {
+    current_pool = tp;
+    current_queue = index;
+    while (true)
+    {
+      worker_thread_base* task = tp->pop_task(index);
+      if (task)
+      {
+        task->execute();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(tp->sleep_mutex);
+      tp->condition.wait(lock, [tp] {
+        return tp->stop || tp->num_pending.load(std::memory_order_acquire);
+      });
+      if (tp->stop && tp->num_pending.load(std::memory_order_acquire) == 0)
+        return;
+    }
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void task_latch::add(ui32 n)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    count.fetch_add(n, std::memory_order_acq_rel);
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void task_latch::count_down()
+  {
+    // decrementing under the lock ensures the waiter, which may destroy
+    // this object as soon as wait() returns, cannot observe zero before we
+    // are done touching the mutex and condition variable
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      condition.notify_all();
+  }
+
+  ////////////////////////////////////////////////////////////////////////////
+  void task_latch::wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return is_done(); });
+  }
+
+}
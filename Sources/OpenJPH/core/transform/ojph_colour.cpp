@@ -35,8 +35,10 @@
 // Date: 28 August 2019
 //***************************************************************************/
 
-#include <cmath>
+#include <atomic>
 #include <climits>
+#include <cmath>
+#include <mutex>
 
 #include "ojph_defs.h"
 #include "ojph_arch.h"
@@ -105,12 +107,18 @@ namespace ojph {
        float *r, float *g, float *b, ui32 repeat) = NULL;
 
     //////////////////////////////////////////////////////////////////////////
-    static bool colour_transform_functions_initialized = false;
+    // extension level of the chosen functions, -1 until the first call
+    static std::atomic<int> colour_functions_level(-1);
+    static std::mutex colour_functions_mutex;
 
     //////////////////////////////////////////////////////////////////////////
     void init_colour_transform_functions()
     {
-      if (colour_transform_functions_initialized)
+      const int level = get_cpu_ext_level();
+      if (colour_functions_level.load(std::memory_order_acquire) == level)
+        return;
+      std::lock_guard<std::mutex> lock(colour_functions_mutex);
+      if (colour_functions_level.load(std::memory_order_relaxed) == level)
         return;
 
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
@@ -199,7 +207,7 @@ namespace ojph {
 
 #endif // !OJPH_ENABLE_WASM_SIMD
 
-      colour_transform_functions_initialized = true;
+      colour_functions_level.store(level, std::memory_order_release);
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -449,7 +457,7 @@ namespace ojph {
         for (ui32 i = repeat; i > 0; --i)
         {
           si32 rr = *rp++, gg = *gp++, bb = *bp++;
-          *yp++ = (rr + (gg << 1) + bb) >> 2;
+          *yp++ = (rr + 2 * gg + bb) >> 2;
           *cbp++ = (bb - gg);
           *crp++ = (rr - gg);
         }
@@ -467,7 +475,7 @@ namespace ojph {
         for (ui32 i = repeat; i > 0; --i)
         {
           si64 rr = *rp++, gg = *gp++, bb = *bp++;
-          *yp++ = (rr + (gg << 1) + bb) >> 2;
+          *yp++ = (rr + 2 * gg + bb) >> 2;
           *cbp++ = (bb - gg);
           *crp++ = (rr - gg);
         }
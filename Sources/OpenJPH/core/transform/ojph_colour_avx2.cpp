@@ -0,0 +1,361 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_colour_avx2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <cassert>
+#include <climits>
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_colour.h"
+#include "ojph_colour_local.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // Only lines of 32-bit samples are vectorized here; lines that involve
+    // 64-bit samples are rare (very high bit depths), and are passed to the
+    // generic implementation.  Leftover samples that do not fill a vector
+    // are also handled by the generic implementation, which keeps the
+    // results identical to it.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256i avx2_select(__m256i mask, __m256i a, __m256i b)
+    { // a where mask is set, b otherwise
+      return _mm256_blendv_epi8(b, a, mask);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256i avx2_nlt_type3(__m256i v, __m256i bias)
+    { // v >= 0 ? v : (- v - bias)
+      __m256i zero = _mm256_setzero_si256();
+      __m256i neg = _mm256_cmpgt_epi32(zero, v);
+      __m256i t = _mm256_sub_epi32(_mm256_sub_epi32(zero, v), bias);
+      return avx2_select(neg, t, v);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<bool NLT_TYPE3>
+    static inline
+    void local_avx2_rev_convert(
+      const line_buf *src_line, const ui32 src_line_offset,
+      line_buf *dst_line, const ui32 dst_line_offset,
+      si64 shift, ui32 width)
+    {
+      if ((src_line->flags & line_buf::LFT_32BIT) == 0 ||
+          (dst_line->flags & line_buf::LFT_32BIT) == 0)
+      {
+        if (NLT_TYPE3)
+          gen_rev_convert_nlt_type3(src_line, src_line_offset,
+            dst_line, dst_line_offset, shift, width);
+        else
+          gen_rev_convert(src_line, src_line_offset,
+            dst_line, dst_line_offset, shift, width);
+        return;
+      }
+
+      const si32 *sp = src_line->i32 + src_line_offset;
+      si32 *dp = dst_line->i32 + dst_line_offset;
+      __m256i sh = _mm256_set1_epi32((si32)shift);
+      ui32 i = width;
+      for (; i >= 8; i -= 8, sp += 8, dp += 8)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        if (NLT_TYPE3)
+          v = avx2_nlt_type3(v, sh);
+        else
+          v = _mm256_add_epi32(v, sh);
+        _mm256_storeu_si256((__m256i*)dp, v);
+      }
+      ui32 done = width - i;
+      if (i && NLT_TYPE3)
+        gen_rev_convert_nlt_type3(src_line, src_line_offset + done,
+          dst_line, dst_line_offset + done, shift, i);
+      else if (i)
+        gen_rev_convert(src_line, src_line_offset + done,
+          dst_line, dst_line_offset + done, shift, i);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_convert(
+      const line_buf *src_line, const ui32 src_line_offset,
+      line_buf *dst_line, const ui32 dst_line_offset,
+      si64 shift, ui32 width)
+    {
+      local_avx2_rev_convert<false>(src_line, src_line_offset,
+        dst_line, dst_line_offset, shift, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_convert_nlt_type3(
+      const line_buf *src_line, const ui32 src_line_offset,
+      line_buf *dst_line, const ui32 dst_line_offset,
+      si64 shift, ui32 width)
+    {
+      local_avx2_rev_convert<true>(src_line, src_line_offset,
+        dst_line, dst_line_offset, shift, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<bool NLT_TYPE3>
+    static inline
+    void local_avx2_irv_convert_to_integer(const line_buf *src_line,
+      line_buf *dst_line, ui32 dst_line_offset,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      assert((src_line->flags & line_buf::LFT_32BIT) &&
+             (src_line->flags & line_buf::LFT_INTEGER) == 0 &&
+             (dst_line->flags & line_buf::LFT_32BIT) &&
+             (dst_line->flags & line_buf::LFT_INTEGER));
+
+      assert(bit_depth <= 32);
+      const float* sp = src_line->f32;
+      si32* dp = dst_line->i32 + dst_line_offset;
+      // the limits are those of the generic implementation; values outside
+      // [fl_low_lim, fl_up_lim), including NaNs, saturate as they do there
+      si32 neg_limit = (si32)INT_MIN >> (32 - bit_depth);
+      __m256 mul = _mm256_set1_ps((float)(1ull << bit_depth));
+      __m256 fl_up_lim = _mm256_set1_ps(-(float)neg_limit);
+      __m256 fl_low_lim = _mm256_set1_ps((float)neg_limit);
+      __m256i s32_up_lim = _mm256_set1_epi32(INT_MAX >> (32 - bit_depth));
+      __m256i s32_low_lim = _mm256_set1_epi32(INT_MIN >> (32 - bit_depth));
+      __m256 zero = _mm256_setzero_ps();
+      __m256 half_p = _mm256_set1_ps(0.5f), half_n = _mm256_set1_ps(-0.5f);
+      __m256i bias = is_signed
+        ? _mm256_set1_epi32((si32)((1ULL << (bit_depth - 1)) + 1))
+        : _mm256_set1_epi32((si32)(1ULL << (bit_depth - 1)));
+
+      ui32 i = width;
+      for (; i >= 8; i -= 8, sp += 8, dp += 8)
+      {
+        __m256 t = _mm256_mul_ps(_mm256_loadu_ps(sp), mul);
+        __m256 ge0 = _mm256_cmp_ps(t, zero, _CMP_GE_OQ);
+        __m256 r = _mm256_blendv_ps(half_n, half_p, ge0);
+        __m256i v = _mm256_cvttps_epi32(_mm256_add_ps(t, r)); // ojph_round
+        __m256 ge_low = _mm256_cmp_ps(t, fl_low_lim, _CMP_GE_OQ);
+        __m256 lt_up = _mm256_cmp_ps(t, fl_up_lim, _CMP_LT_OQ);
+        v = avx2_select(_mm256_castps_si256(ge_low), v, s32_low_lim);
+        v = avx2_select(_mm256_castps_si256(lt_up), v, s32_up_lim);
+        if (is_signed) {
+          if (NLT_TYPE3)
+            v = avx2_nlt_type3(v, bias);
+        }
+        else
+          v = _mm256_add_epi32(v, bias);
+        _mm256_storeu_si256((__m256i*)dp, v);
+      }
+      if (i)
+      {
+        line_buf src = *src_line;
+        src.f32 += width - i;
+        if (NLT_TYPE3)
+          gen_irv_convert_to_integer_nlt_type3(&src, dst_line,
+            dst_line_offset + width - i, bit_depth, is_signed, i);
+        else
+          gen_irv_convert_to_integer(&src, dst_line,
+            dst_line_offset + width - i, bit_depth, is_signed, i);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_convert_to_integer(const line_buf *src_line,
+      line_buf *dst_line, ui32 dst_line_offset,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      local_avx2_irv_convert_to_integer<false>(src_line, dst_line,
+        dst_line_offset, bit_depth, is_signed, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_convert_to_integer_nlt_type3(const line_buf *src_line,
+      line_buf *dst_line, ui32 dst_line_offset,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      local_avx2_irv_convert_to_integer<true>(src_line, dst_line,
+        dst_line_offset, bit_depth, is_signed, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template<bool NLT_TYPE3>
+    static inline
+    void local_avx2_irv_convert_to_float(const line_buf *src_line,
+      ui32 src_line_offset, line_buf *dst_line,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      assert((src_line->flags & line_buf::LFT_32BIT) &&
+             (src_line->flags & line_buf::LFT_INTEGER) &&
+             (dst_line->flags & line_buf::LFT_32BIT) &&
+             (dst_line->flags & line_buf::LFT_INTEGER) == 0);
+
+      assert(bit_depth <= 32);
+      __m256 mul = _mm256_set1_ps((float)(1.0 / (double)(1ULL << bit_depth)));
+      __m256i bias = is_signed
+        ? _mm256_set1_epi32((si32)((1ULL << (bit_depth - 1)) + 1))
+        : _mm256_set1_epi32((si32)(1ULL << (bit_depth - 1)));
+
+      const si32* sp = src_line->i32 + src_line_offset;
+      float* dp = dst_line->f32;
+      ui32 i = width;
+      for (; i >= 8; i -= 8, sp += 8, dp += 8)
+      {
+        __m256i v = _mm256_loadu_si256((__m256i*)sp);
+        if (is_signed) {
+          if (NLT_TYPE3)
+            v = avx2_nlt_type3(v, bias);
+        }
+        else
+          v = _mm256_sub_epi32(v, bias);
+        _mm256_storeu_ps(dp, _mm256_mul_ps(_mm256_cvtepi32_ps(v), mul));
+      }
+      if (i)
+      {
+        line_buf dst = *dst_line;
+        dst.f32 += width - i;
+        if (NLT_TYPE3)
+          gen_irv_convert_to_float_nlt_type3(src_line,
+            src_line_offset + width - i, &dst, bit_depth, is_signed, i);
+        else
+          gen_irv_convert_to_float(src_line,
+            src_line_offset + width - i, &dst, bit_depth, is_signed, i);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_convert_to_float(const line_buf *src_line,
+      ui32 src_line_offset, line_buf *dst_line,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      local_avx2_irv_convert_to_float<false>(src_line, src_line_offset,
+        dst_line, bit_depth, is_signed, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_irv_convert_to_float_nlt_type3(const line_buf *src_line,
+      ui32 src_line_offset, line_buf *dst_line,
+      ui32 bit_depth, bool is_signed, ui32 width)
+    {
+      local_avx2_irv_convert_to_float<true>(src_line, src_line_offset,
+        dst_line, bit_depth, is_signed, width);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rct_forward(
+      const line_buf *r, const line_buf *g, const line_buf *b,
+      line_buf *y, line_buf *cb, line_buf *cr, ui32 repeat)
+    {
+      if ((y->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rct_forward(r, g, b, y, cb, cr, repeat);
+        return;
+      }
+
+      const si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+      si32 *yp = y->i32, *cbp = cb->i32, *crp = cr->i32;
+      ui32 i = repeat;
+      for (; i >= 8; i -= 8)
+      {
+        __m256i mr = _mm256_loadu_si256((__m256i*)rp); rp += 8;
+        __m256i mg = _mm256_loadu_si256((__m256i*)gp); gp += 8;
+        __m256i mb = _mm256_loadu_si256((__m256i*)bp); bp += 8;
+        __m256i t = _mm256_add_epi32(_mm256_add_epi32(mr, mb),
+                                     _mm256_slli_epi32(mg, 1));
+        _mm256_storeu_si256((__m256i*)yp, _mm256_srai_epi32(t, 2)); yp += 8;
+        _mm256_storeu_si256((__m256i*)cbp, _mm256_sub_epi32(mb, mg)); cbp += 8;
+        _mm256_storeu_si256((__m256i*)crp, _mm256_sub_epi32(mr, mg)); crp += 8;
+      }
+      for (; i > 0; --i)
+      {
+        si32 rr = *rp++, gg = *gp++, bb = *bp++;
+        *yp++ = (rr + 2 * gg + bb) >> 2;
+        *cbp++ = (bb - gg);
+        *crp++ = (rr - gg);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rct_backward(
+      const line_buf *y, const line_buf *cb, const line_buf *cr,
+      line_buf *r, line_buf *g, line_buf *b, ui32 repeat)
+    {
+      if ((y->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rct_backward(y, cb, cr, r, g, b, repeat);
+        return;
+      }
+
+      const si32 *yp = y->i32, *cbp = cb->i32, *crp = cr->i32;
+      si32 *rp = r->i32, *gp = g->i32, *bp = b->i32;
+      ui32 i = repeat;
+      for (; i >= 8; i -= 8)
+      {
+        __m256i my = _mm256_loadu_si256((__m256i*)yp); yp += 8;
+        __m256i mcb = _mm256_loadu_si256((__m256i*)cbp); cbp += 8;
+        __m256i mcr = _mm256_loadu_si256((__m256i*)crp); crp += 8;
+        __m256i t = _mm256_srai_epi32(_mm256_add_epi32(mcb, mcr), 2);
+        __m256i mg = _mm256_sub_epi32(my, t);
+        _mm256_storeu_si256((__m256i*)rp, _mm256_add_epi32(mcr, mg)); rp += 8;
+        _mm256_storeu_si256((__m256i*)gp, mg); gp += 8;
+        _mm256_storeu_si256((__m256i*)bp, _mm256_add_epi32(mcb, mg)); bp += 8;
+      }
+      for (; i > 0; --i)
+      {
+        si32 yy = *yp++, cbb = *cbp++, crr = *crp++;
+        si32 gg = yy - ((cbb + crr) >> 2);
+        *rp++ = crr + gg;
+        *gp++ = gg;
+        *bp++ = cbb + gg;
+      }
+    }
+
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
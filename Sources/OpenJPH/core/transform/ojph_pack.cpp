@@ -0,0 +1,502 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "ojph_defs.h"
+#include "ojph_arch.h"
+#include "ojph_pack.h"
+#include "ojph_pack_local.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_si32_to_ui8)
+      (const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+       ui32 width, si32 lo, si32 hi, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_si32_to_ui16)
+      (const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+       ui32 width, si32 lo, si32 hi, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_f32_to_ui8)
+      (const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+       ui32 width, si32 lo, si32 hi, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_f32_to_ui16)
+      (const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+       ui32 width, si32 lo, si32 hi, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_si32_to_f32)
+      (const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+       ui32 width, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_f32_to_f32)
+      (const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+       ui32 width, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_si32_to_f16)
+      (const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+       ui32 width, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_f32_to_f16)
+      (const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+       ui32 width, float mul, float add) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_ycc_to_rgb8)
+      (const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+       ui32 width, ui32 shift, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_ycc_to_rgb16)
+      (const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+       ui32 width, ui32 shift, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_rct_to_rgb8)
+      (const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+       ui32 width, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_rct_to_rgb16)
+      (const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+       ui32 width, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_ict_to_rgb8)
+      (const float* y, const float* cb, const float* cr, ui8* dst,
+       ui32 stride, ui32 width, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    void (*pack_ict_to_rgb16)
+      (const float* y, const float* cb, const float* cr, ui16* dst,
+       ui32 stride, ui32 width, si32 half, si32 hi) = NULL;
+
+    //////////////////////////////////////////////////////////////////////////
+    // extension level of the chosen functions, -1 until the first decoder
+    // asks for them; decoders starting together wait on the mutex
+    static std::atomic<int> pack_functions_level(-1);
+    static std::mutex pack_functions_mutex;
+
+    //////////////////////////////////////////////////////////////////////////
+    void init_pack_functions()
+    {
+      const int level = get_cpu_ext_level();
+      if (pack_functions_level.load(std::memory_order_acquire) == level)
+        return;
+      std::lock_guard<std::mutex> lock(pack_functions_mutex);
+      if (pack_functions_level.load(std::memory_order_relaxed) == level)
+        return;
+
+      pack_si32_to_ui8 = gen_pack_si32_to_ui8;
+      pack_si32_to_ui16 = gen_pack_si32_to_ui16;
+      pack_f32_to_ui8 = gen_pack_f32_to_ui8;
+      pack_f32_to_ui16 = gen_pack_f32_to_ui16;
+      pack_si32_to_f32 = gen_pack_si32_to_f32;
+      pack_f32_to_f32 = gen_pack_f32_to_f32;
+      pack_si32_to_f16 = gen_pack_si32_to_f16;
+      pack_f32_to_f16 = gen_pack_f32_to_f16;
+      pack_ycc_to_rgb8 = gen_pack_ycc_to_rgb8;
+      pack_ycc_to_rgb16 = gen_pack_ycc_to_rgb16;
+      pack_rct_to_rgb8 = gen_pack_rct_to_rgb8;
+      pack_rct_to_rgb16 = gen_pack_rct_to_rgb16;
+      pack_ict_to_rgb8 = gen_pack_ict_to_rgb8;
+      pack_ict_to_rgb16 = gen_pack_ict_to_rgb16;
+
+  #ifndef OJPH_DISABLE_SIMD
+
+    #if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+
+      #ifndef OJPH_DISABLE_SSE2
+        if (get_cpu_ext_level() >= X86_CPU_EXT_LEVEL_SSE2)
+        {
+          pack_si32_to_ui8 = sse2_pack_si32_to_ui8;
+          pack_si32_to_ui16 = sse2_pack_si32_to_ui16;
+          pack_f32_to_ui8 = sse2_pack_f32_to_ui8;
+          pack_f32_to_ui16 = sse2_pack_f32_to_ui16;
+          pack_si32_to_f32 = sse2_pack_si32_to_f32;
+          pack_f32_to_f32 = sse2_pack_f32_to_f32;
+          pack_si32_to_f16 = sse2_pack_si32_to_f16;
+          pack_f32_to_f16 = sse2_pack_f32_to_f16;
+        }
+      #endif // !OJPH_DISABLE_SSE2
+
+      #ifndef OJPH_DISABLE_AVX2
+        if (get_cpu_ext_level() >= X86_CPU_EXT_LEVEL_AVX2)
+        {
+          pack_si32_to_ui8 = avx2_pack_si32_to_ui8;
+          pack_si32_to_ui16 = avx2_pack_si32_to_ui16;
+          pack_f32_to_ui8 = avx2_pack_f32_to_ui8;
+          pack_f32_to_ui16 = avx2_pack_f32_to_ui16;
+          pack_si32_to_f32 = avx2_pack_si32_to_f32;
+          pack_f32_to_f32 = avx2_pack_f32_to_f32;
+          pack_si32_to_f16 = avx2_pack_si32_to_f16;
+          pack_f32_to_f16 = avx2_pack_f32_to_f16;
+          pack_ycc_to_rgb8 = avx2_pack_ycc_to_rgb8;
+          pack_ycc_to_rgb16 = avx2_pack_ycc_to_rgb16;
+          pack_rct_to_rgb8 = avx2_pack_rct_to_rgb8;
+          pack_rct_to_rgb16 = avx2_pack_rct_to_rgb16;
+          pack_ict_to_rgb8 = avx2_pack_ict_to_rgb8;
+          pack_ict_to_rgb16 = avx2_pack_ict_to_rgb16;
+        }
+      #endif // !OJPH_DISABLE_AVX2
+
+    #elif defined(OJPH_ARCH_ARM)
+
+      #ifdef OJPH_ENABLE_NEON
+        if (get_cpu_ext_level() >= ARM_CPU_EXT_LEVEL_NEON)
+        {
+          pack_si32_to_ui8 = neon_pack_si32_to_ui8;
+          pack_si32_to_ui16 = neon_pack_si32_to_ui16;
+          pack_f32_to_ui8 = neon_pack_f32_to_ui8;
+          pack_f32_to_ui16 = neon_pack_f32_to_ui16;
+          pack_si32_to_f32 = neon_pack_si32_to_f32;
+          pack_f32_to_f32 = neon_pack_f32_to_f32;
+          pack_si32_to_f16 = neon_pack_si32_to_f16;
+          pack_f32_to_f16 = neon_pack_f32_to_f16;
+          pack_ycc_to_rgb8 = neon_pack_ycc_to_rgb8;
+          pack_ycc_to_rgb16 = neon_pack_ycc_to_rgb16;
+          pack_rct_to_rgb8 = neon_pack_rct_to_rgb8;
+          pack_rct_to_rgb16 = neon_pack_rct_to_rgb16;
+          pack_ict_to_rgb8 = neon_pack_ict_to_rgb8;
+          pack_ict_to_rgb16 = neon_pack_ict_to_rgb16;
+        }
+      #endif // !OJPH_ENABLE_NEON
+
+    #endif // !(defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+
+  #endif // !OJPH_DISABLE_SIMD
+
+      pack_functions_level.store(level, std::memory_order_release);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline si32 gen_round(float v, si32 lo, si32 hi)
+    {
+      // NaN maps to lo; the difference between v and its truncation is
+      // exact, so halfway cases are detected without double rounding
+      float t = !(v >= (float)lo) ? (float)lo : v;
+      t = t > (float)hi ? (float)hi : t;
+      si32 r = (si32)t;
+      float d = t - (float)r;
+      return r + (d >= 0.5f ? 1 : 0) - (d <= -0.5f ? 1 : 0);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    si32 gen_convert(si32 v, si32 lo, si32 hi, float mul, float add)
+    {
+      if (MAP)
+        return gen_round((float)v * mul + add, lo, hi);
+      return v < lo ? lo : (v > hi ? hi : v);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    si32 gen_convert(float v, si32 lo, si32 hi, float mul, float add)
+    {
+      return gen_round(MAP ? v * mul + add : v, lo, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T, typename D>
+    static inline
+    void gen_pack_samples(const T* const* src, ui32 num_srcs, D* dst,
+                          ui32 stride, ui32 width, si32 lo, si32 hi,
+                          float mul, float add)
+    {
+      for (ui32 c = 0; c < num_srcs; ++c)
+      {
+        const T* sp = src[c];
+        D* dp = dst + c;
+        for (ui32 i = width; i > 0; --i, dp += stride)
+          *dp = (D)gen_convert<MAP>(*sp++, lo, hi, mul, add);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void gen_pack_lines(const T* const* src, ui32 num_srcs, D* dst,
+                        ui32 stride, ui32 width, si32 lo, si32 hi,
+                        float mul, float add)
+    {
+      if (mul == 1.0f && add == 0.0f)
+        gen_pack_samples<false>(src, num_srcs, dst, stride, width, lo, hi,
+                                mul, add);
+      else
+        gen_pack_samples<true>(src, num_srcs, dst, stride, width, lo, hi,
+                               mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline ui16 gen_f32_to_f16(float f)
+    {
+      // rounds to nearest even, after "float_to_half_fast3_rtne" by
+      // F. Giesen; NaNs become a quiet NaN
+      ui32 u;
+      memcpy(&u, &f, sizeof(u));
+      ui32 sign = u & 0x80000000u;
+      u ^= sign;
+      ui32 h;
+      if (u >= 0x47800000u)      // 2^16 and up, infinities and NaNs
+        h = u > 0x7F800000u ? 0x7E00u : 0x7C00u;
+      else if (u < 0x38800000u)  // below 2^-14, subnormal halves
+      { // adding 0.5f aligns the half mantissa with the float one
+        float t;
+        memcpy(&t, &u, sizeof(t));
+        t += 0.5f;
+        memcpy(&h, &t, sizeof(h));
+        h -= 0x3F000000u;
+      }
+      else
+      { // rebias the exponent and round the 13 dropped mantissa bits
+        ui32 odd = (u >> 13) & 1;
+        h = (u + 0xC8000FFFu + odd) >> 13;
+      }
+      return (ui16)(h | (sign >> 16));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline float gen_store(float v, const float*) { return v; }
+    static inline ui16 gen_store(float v, const ui16*)
+    { return gen_f32_to_f16(v); }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void gen_map_lines(const T* const* src, ui32 num_srcs, D* dst,
+                       ui32 stride, ui32 width, float mul, float add)
+    {
+      for (ui32 c = 0; c < num_srcs; ++c)
+      {
+        const T* sp = src[c];
+        D* dp = dst + c;
+        for (ui32 i = width; i > 0; --i, dp += stride)
+          *dp = gen_store((float)*sp++ * mul + add, dp);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename D>
+    static inline
+    void gen_put_rgb(D* dp, ui32 stride, si32 r, si32 g, si32 b)
+    {
+      dp[0] = (D)r;
+      dp[1] = (D)g;
+      dp[2] = (D)b;
+      if (stride == 4)
+        dp[3] = (D)~(D)0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename D>
+    static inline
+    void gen_ycc_to_rgb(const si32* y, const si32* cb, const si32* cr,
+                        D* dst, ui32 stride, ui32 width, ui32 shift,
+                        si32 half, si32 hi)
+    {
+      for (ui32 x = 0; x < width; ++x, dst += stride)
+      {
+        float fy = (float)y[x];
+        float fb = (float)(cb[x >> shift] - half);
+        float fr = (float)(cr[x >> shift] - half);
+        gen_put_rgb(dst, stride,
+          gen_round(fy + ycc_cr_to_r * fr, 0, hi),
+          gen_round(fy - ycc_cb_to_g * fb - ycc_cr_to_g * fr, 0, hi),
+          gen_round(fy + ycc_cb_to_b * fb, 0, hi));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename D>
+    static inline
+    void gen_rct_to_rgb(const si32* y, const si32* cb, const si32* cr,
+                        D* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      for (ui32 x = 0; x < width; ++x, dst += stride)
+      {
+        si32 g = y[x] - ((cb[x] + cr[x]) >> 2);
+        gen_put_rgb(dst, stride,
+          gen_convert<false>(cr[x] + g + half, 0, hi, 1.0f, 0.0f),
+          gen_convert<false>(g + half, 0, hi, 1.0f, 0.0f),
+          gen_convert<false>(cb[x] + g + half, 0, hi, 1.0f, 0.0f));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename D>
+    static inline
+    void gen_ict_to_rgb(const float* y, const float* cb, const float* cr,
+                        D* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      float mul = 2.0f * (float)half, add = (float)half;
+      for (ui32 x = 0; x < width; ++x, dst += stride)
+      {
+        float r = y[x] + ycc_cr_to_r * cr[x];
+        float g = y[x] - ycc_cb_to_g * cb[x] - ycc_cr_to_g * cr[x];
+        float b = y[x] + ycc_cb_to_b * cb[x];
+        gen_put_rgb(dst, stride, gen_round(r * mul + add, 0, hi),
+          gen_round(g * mul + add, 0, hi), gen_round(b * mul + add, 0, hi));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      gen_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      gen_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      gen_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      gen_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      gen_map_lines(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      gen_map_lines(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      gen_map_lines(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      gen_map_lines(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      gen_ycc_to_rgb(y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      gen_ycc_to_rgb(y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      gen_rct_to_rgb(y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      gen_rct_to_rgb(y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      gen_ict_to_rgb(y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      gen_ict_to_rgb(y, cb, cr, dst, stride, width, half, hi);
+    }
+
+  }
+}
@@ -0,0 +1,160 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack.h
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+
+#ifndef OJPH_PACK_H
+#define OJPH_PACK_H
+
+#include "ojph_defs.h"
+
+namespace ojph {
+  namespace local {
+
+  ////////////////////////////////////////////////////////////////////////////
+  // These functions map decoded lines through `x * mul + add`, clamp them
+  // to [lo, hi] and interleave them into one row of output pixels; sample
+  // `x` of `src[c]` goes to `dst[x * stride + c]`, for `c < num_srcs`, and
+  // `stride >= num_srcs`.  16-bit outputs keep the low 16 bits of the
+  // clamped value, so signed samples are stored in two's complement; 8-bit
+  // outputs require 0 <= lo and hi <= 255.  Mapped and float samples are
+  // rounded to the nearest integer, halfway cases away from zero; the map
+  // is computed in single precision, exactly so for integer `mul` and `add`
+  // as long as results stay below 2^24.  With `mul == 1` and `add == 0`,
+  // integer samples are only clamped.
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  void init_pack_functions();
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_si32_to_ui8)
+    (const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+     ui32 width, si32 lo, si32 hi, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_si32_to_ui16)
+    (const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+     ui32 width, si32 lo, si32 hi, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_f32_to_ui8)
+    (const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+     ui32 width, si32 lo, si32 hi, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_f32_to_ui16)
+    (const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+     ui32 width, si32 lo, si32 hi, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // These functions write decoded lines as floating-point samples, mapped
+  // through `x * mul + add` in single precision without rounding or
+  // clamping, with the same layout as the functions above.  The f16
+  // variants store IEEE half-precision bit patterns, rounded to nearest
+  // even; magnitudes beyond the half range become infinities.
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_si32_to_f32)
+    (const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+     ui32 width, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_f32_to_f32)
+    (const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+     ui32 width, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_si32_to_f16)
+    (const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+     ui32 width, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_f32_to_f16)
+    (const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+     ui32 width, float mul, float add);
+
+  ////////////////////////////////////////////////////////////////////////////
+  // These functions convert three lines of colour components to RGB,
+  // clamp the result to [0, hi], rounding as above, and interleave it into
+  // `dst[x * stride + c]`; `stride` is 3, or 4 for RGBA pixels, whose
+  // fourth sample is set to all ones, opaque alpha.  `half`,
+  // 1 << (bit_depth - 1), is the DC level, and the chroma of grey.
+  //
+  // The ycc functions convert full-range YCbCr, as DICOM YBR_FULL and
+  // YBR_FULL_422 define it.  Sample `x` takes its chroma from
+  // `cb[x >> shift]` and `cr[x >> shift]`, with `shift` 0 or 1, so
+  // horizontally subsampled chroma is upsampled, by repetition, in the same
+  // pass.  The rct and ict functions undo the colour transforms of
+  // JPEG 2000 Part 1 on components pulled before it, without their level
+  // shift (see codestream::defer_colour_transform()): integers for the
+  // reversible transform, computed exactly, and floats in [-0.5, 0.5) for
+  // the irreversible one, whose RGB is scaled by 2 * half.  YCbCr and the
+  // irreversible transform are computed in single precision.
+  ////////////////////////////////////////////////////////////////////////////
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_ycc_to_rgb8)
+    (const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+     ui32 width, ui32 shift, si32 half, si32 hi);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_ycc_to_rgb16)
+    (const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+     ui32 width, ui32 shift, si32 half, si32 hi);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_rct_to_rgb8)
+    (const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+     ui32 width, si32 half, si32 hi);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_rct_to_rgb16)
+    (const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+     ui32 width, si32 half, si32 hi);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_ict_to_rgb8)
+    (const float* y, const float* cb, const float* cr, ui8* dst,
+     ui32 stride, ui32 width, si32 half, si32 hi);
+
+  ////////////////////////////////////////////////////////////////////////////
+  extern void (*pack_ict_to_rgb16)
+    (const float* y, const float* cb, const float* cr, ui16* dst,
+     ui32 stride, ui32 width, si32 half, si32 hi);
+  }
+}
+
+#endif // !OJPH_PACK_H
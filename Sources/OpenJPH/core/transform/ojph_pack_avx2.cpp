@@ -0,0 +1,747 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack_avx2.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_pack.h"
+#include "ojph_pack_local.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // One to four interleaved sources are vectorized here; other layouts,
+    // and leftover samples that do not fill a vector, are left to the
+    // generic implementation.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    // Byte shuffles that spread three vectors of 8 16-bit samples, one per
+    // source, over three interleaved vectors; entry [k][c] selects the
+    // samples of source c that go to output vector k, and -1 clears a byte
+    static const si8 shuffle3_ui16[3][3][16] = {
+      { { 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 4, 5, -1, -1 },
+        { -1, -1, 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 4, 5 },
+        { -1, -1, -1, -1, 0, 1, -1, -1, -1, -1, 2, 3, -1, -1, -1, -1 } },
+      { { -1, -1, 6, 7, -1, -1, -1, -1, 8, 9, -1, -1, -1, -1, 10, 11 },
+        { -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, 8, 9, -1, -1, -1, -1 },
+        { 4, 5, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, 8, 9, -1, -1 } },
+      { { -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1 },
+        { 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1 },
+        { -1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15 } }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    // The same for three vectors of 16 8-bit samples
+    static const si8 shuffle3_ui8[3][3][16] = {
+      { { 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5 },
+        { -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1 },
+        { -1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1 } },
+      { { -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1 },
+        { 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10 },
+        { -1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1 } },
+      { { -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1 },
+        { -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1 },
+        { 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15 } }
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct avx2_limits
+    {
+      avx2_limits(si32 lo, si32 hi, float mul, float add)
+      : lo(_mm256_set1_epi32(lo)), hi(_mm256_set1_epi32(hi)),
+        flo(_mm256_set1_ps((float)lo)), fhi(_mm256_set1_ps((float)hi)),
+        mul(_mm256_set1_ps(mul)), add(_mm256_set1_ps(add)) {}
+
+      __m256i lo, hi;
+      __m256 flo, fhi, mul, add;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256i avx2_round(__m256 v, const avx2_limits& l)
+    { // _mm256_max_ps returns its second operand for NaN, giving lo
+      v = _mm256_max_ps(v, l.flo);
+      v = _mm256_min_ps(v, l.fhi);
+      __m256i r = _mm256_cvttps_epi32(v);
+      __m256 d = _mm256_sub_ps(v, _mm256_cvtepi32_ps(r));
+      // masks are -1 where set; round halfway cases away from zero
+      __m256 up = _mm256_cmp_ps(d, _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+      __m256 dn = _mm256_cmp_ps(d, _mm256_set1_ps(-0.5f), _CMP_LE_OQ);
+      r = _mm256_sub_epi32(r, _mm256_castps_si256(up));
+      return _mm256_add_epi32(r, _mm256_castps_si256(dn));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    __m256i avx2_load(const si32* sp, const avx2_limits& l)
+    {
+      __m256i v = _mm256_loadu_si256((__m256i*)sp);
+      if (MAP)
+        return avx2_round(_mm256_add_ps(
+          _mm256_mul_ps(_mm256_cvtepi32_ps(v), l.mul), l.add), l);
+      return _mm256_min_epi32(_mm256_max_epi32(v, l.lo), l.hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    __m256i avx2_load(const float* sp, const avx2_limits& l)
+    {
+      __m256 v = _mm256_loadu_ps(sp);
+      if (MAP)
+        v = _mm256_add_ps(_mm256_mul_ps(v, l.mul), l.add);
+      return avx2_round(v, l);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    __m256i avx2_load_ui16(const T* sp, const avx2_limits& l)
+    { // 16 samples; sign extending the low 16 bits keeps _mm256_packs_epi32
+      // from saturating them
+      __m256i a = avx2_load<MAP>(sp, l), b = avx2_load<MAP>(sp + 8, l);
+      a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+      b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+      // packing works within 128-bit lanes; restore the sample order
+      return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    __m256i avx2_load_ui8(const T* sp, const avx2_limits& l)
+    { // 32 samples, already within [0, 255]
+      __m256i a = _mm256_packs_epi32(avx2_load<MAP>(sp, l),
+                                     avx2_load<MAP>(sp + 8, l));
+      __m256i b = _mm256_packs_epi32(avx2_load<MAP>(sp + 16, l),
+                                     avx2_load<MAP>(sp + 24, l));
+      __m256i idx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+      return _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), idx);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_store3(const si8 shuffle[3][3][16],
+                     __m128i s0, __m128i s1, __m128i s2, __m128i* dp)
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        __m128i m0 = _mm_loadu_si128((__m128i*)shuffle[k][0]);
+        __m128i m1 = _mm_loadu_si128((__m128i*)shuffle[k][1]);
+        __m128i m2 = _mm_loadu_si128((__m128i*)shuffle[k][2]);
+        __m128i v = _mm_or_si128(_mm_shuffle_epi8(s0, m0),
+                                 _mm_shuffle_epi8(s1, m1));
+        _mm_storeu_si128(dp + k, _mm_or_si128(v, _mm_shuffle_epi8(s2, m2)));
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_store3(const si8 shuffle[3][3][16],
+                     __m256i s0, __m256i s1, __m256i s2, __m128i* dp)
+    {
+      avx2_store3(shuffle, _mm256_castsi256_si128(s0),
+                  _mm256_castsi256_si128(s1), _mm256_castsi256_si128(s2),
+                  dp);
+      avx2_store3(shuffle, _mm256_extracti128_si256(s0, 1),
+                  _mm256_extracti128_si256(s1, 1),
+                  _mm256_extracti128_si256(s2, 1), dp + 3);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_store2(__m256i lo, __m256i hi, __m256i* dp)
+    { // lo and hi hold interleaved samples in the order of unpacking
+      _mm256_storeu_si256(dp, _mm256_permute2x128_si256(lo, hi, 0x20));
+      _mm256_storeu_si256(dp + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_store4(__m256i w0, __m256i w1, __m256i w2, __m256i w3,
+                     __m256i* dp)
+    { // w0 to w3 hold interleaved samples in the order of unpacking
+      _mm256_storeu_si256(dp, _mm256_permute2x128_si256(w0, w1, 0x20));
+      _mm256_storeu_si256(dp + 1, _mm256_permute2x128_si256(w2, w3, 0x20));
+      _mm256_storeu_si256(dp + 2, _mm256_permute2x128_si256(w0, w1, 0x31));
+      _mm256_storeu_si256(dp + 3, _mm256_permute2x128_si256(w2, w3, 0x31));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void avx2_pack(const T* const* src, ui32 num_srcs, ui16* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride || num_srcs == 0 || num_srcs > 4)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      avx2_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 16 <= width; x += 16)
+          _mm256_storeu_si256((__m256i*)(dst + x),
+                              avx2_load_ui16<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 16 <= width; x += 16)
+        {
+          __m256i p0 = avx2_load_ui16<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui16<MAP>(src[1] + x, l);
+          avx2_store2(_mm256_unpacklo_epi16(p0, p1),
+                      _mm256_unpackhi_epi16(p0, p1),
+                      (__m256i*)(dst + 2 * (size_t)x));
+        }
+      else if (num_srcs == 3)
+        for (; x + 16 <= width; x += 16)
+        {
+          __m256i p0 = avx2_load_ui16<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui16<MAP>(src[1] + x, l);
+          __m256i p2 = avx2_load_ui16<MAP>(src[2] + x, l);
+          avx2_store3(shuffle3_ui16, p0, p1, p2,
+                      (__m128i*)(dst + 3 * (size_t)x));
+        }
+      else
+        for (; x + 16 <= width; x += 16)
+        {
+          __m256i p0 = avx2_load_ui16<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui16<MAP>(src[1] + x, l);
+          __m256i p2 = avx2_load_ui16<MAP>(src[2] + x, l);
+          __m256i p3 = avx2_load_ui16<MAP>(src[3] + x, l);
+          __m256i t0 = _mm256_unpacklo_epi16(p0, p1);
+          __m256i t1 = _mm256_unpackhi_epi16(p0, p1);
+          __m256i u0 = _mm256_unpacklo_epi16(p2, p3);
+          __m256i u1 = _mm256_unpackhi_epi16(p2, p3);
+          avx2_store4(_mm256_unpacklo_epi32(t0, u0),
+                      _mm256_unpackhi_epi32(t0, u0),
+                      _mm256_unpacklo_epi32(t1, u1),
+                      _mm256_unpackhi_epi32(t1, u1),
+                      (__m256i*)(dst + 4 * (size_t)x));
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void avx2_pack(const T* const* src, ui32 num_srcs, ui8* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride || num_srcs == 0 || num_srcs > 4)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      avx2_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 32 <= width; x += 32)
+          _mm256_storeu_si256((__m256i*)(dst + x),
+                              avx2_load_ui8<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 32 <= width; x += 32)
+        {
+          __m256i p0 = avx2_load_ui8<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui8<MAP>(src[1] + x, l);
+          avx2_store2(_mm256_unpacklo_epi8(p0, p1),
+                      _mm256_unpackhi_epi8(p0, p1),
+                      (__m256i*)(dst + 2 * (size_t)x));
+        }
+      else if (num_srcs == 3)
+        for (; x + 32 <= width; x += 32)
+        {
+          __m256i p0 = avx2_load_ui8<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui8<MAP>(src[1] + x, l);
+          __m256i p2 = avx2_load_ui8<MAP>(src[2] + x, l);
+          avx2_store3(shuffle3_ui8, p0, p1, p2,
+                      (__m128i*)(dst + 3 * (size_t)x));
+        }
+      else
+        for (; x + 32 <= width; x += 32)
+        {
+          __m256i p0 = avx2_load_ui8<MAP>(src[0] + x, l);
+          __m256i p1 = avx2_load_ui8<MAP>(src[1] + x, l);
+          __m256i p2 = avx2_load_ui8<MAP>(src[2] + x, l);
+          __m256i p3 = avx2_load_ui8<MAP>(src[3] + x, l);
+          __m256i t0 = _mm256_unpacklo_epi8(p0, p1);
+          __m256i t1 = _mm256_unpackhi_epi8(p0, p1);
+          __m256i u0 = _mm256_unpacklo_epi8(p2, p3);
+          __m256i u1 = _mm256_unpackhi_epi8(p2, p3);
+          avx2_store4(_mm256_unpacklo_epi16(t0, u0),
+                      _mm256_unpackhi_epi16(t0, u0),
+                      _mm256_unpacklo_epi16(t1, u1),
+                      _mm256_unpackhi_epi16(t1, u1),
+                      (__m256i*)(dst + 4 * (size_t)x));
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void avx2_pack_lines(const T* const* src, ui32 num_srcs, D* dst,
+                         ui32 stride, ui32 width, si32 lo, si32 hi,
+                         float mul, float add)
+    {
+      if (mul == 1.0f && add == 0.0f)
+        avx2_pack<false>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+      else
+        avx2_pack<true>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Floating-point outputs are vectorized for a single source written
+    // contiguously, as planar and single-component images are.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256 avx2_map(const si32* sp, __m256 mul, __m256 add)
+    {
+      __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i*)sp));
+      return _mm256_add_ps(_mm256_mul_ps(v, mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256 avx2_map(const float* sp, __m256 mul, __m256 add)
+    {
+      return _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(sp), mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256i avx2_f32_to_f16(__m256 v)
+    { // gen_f32_to_f16 on 8 samples, leaving them in the low 16 bits
+      __m256i u = _mm256_castps_si256(v);
+      __m256i sign = _mm256_and_si256(u, _mm256_set1_epi32((si32)0x80000000u));
+      u = _mm256_xor_si256(u, sign);
+      // normal halves
+      __m256i odd = _mm256_and_si256(_mm256_srli_epi32(u, 13),
+                                     _mm256_set1_epi32(1));
+      __m256i h = _mm256_add_epi32(u, _mm256_set1_epi32((si32)0xC8000FFFu));
+      h = _mm256_srli_epi32(_mm256_add_epi32(h, odd), 13);
+      // subnormal halves
+      __m256 t = _mm256_add_ps(_mm256_castsi256_ps(u), _mm256_set1_ps(0.5f));
+      __m256i s = _mm256_sub_epi32(_mm256_castps_si256(t),
+                                   _mm256_set1_epi32(0x3F000000));
+      __m256i m = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), u);
+      h = _mm256_blendv_epi8(h, s, m);
+      // infinities and NaNs
+      __m256i nan = _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x7F800000));
+      __m256i inf = _mm256_or_si256(_mm256_set1_epi32(0x7C00),
+        _mm256_and_si256(nan, _mm256_set1_epi32(0x200)));
+      m = _mm256_cmpgt_epi32(u, _mm256_set1_epi32(0x477FFFFF));
+      h = _mm256_blendv_epi8(h, inf, m);
+      return _mm256_or_si256(h, _mm256_srli_epi32(sign, 16));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void avx2_to_f32(const T* const* src, ui32 num_srcs, float* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      __m256 m = _mm256_set1_ps(mul), a = _mm256_set1_ps(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 8 <= width; x += 8)
+        _mm256_storeu_ps(dst + x, avx2_map(sp + x, m, a));
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void avx2_to_f16(const T* const* src, ui32 num_srcs, ui16* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      __m256 m = _mm256_set1_ps(mul), a = _mm256_set1_ps(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 16 <= width; x += 16)
+      { // sign extension keeps _mm256_packs_epi32 from saturating, and
+        // the permutation restores the sample order
+        __m256i h0 = avx2_f32_to_f16(avx2_map(sp + x, m, a));
+        __m256i h1 = avx2_f32_to_f16(avx2_map(sp + x + 8, m, a));
+        h0 = _mm256_srai_epi32(_mm256_slli_epi32(h0, 16), 16);
+        h1 = _mm256_srai_epi32(_mm256_slli_epi32(h1, 16), 16);
+        __m256i p = _mm256_packs_epi32(h0, h1);
+        _mm256_storeu_si256((__m256i*)(dst + x),
+                            _mm256_permute4x64_epi64(p, 0xD8));
+      }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // The colour conversions compute 8 samples of each colour at a time, in
+    // the operation order of the generic code, and interleave them with the
+    // byte shuffles of the three-source packing above, or with the
+    // unpacking of the four-source one, alpha being the fourth source.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m256 avx2_load_chroma(const si32* sp, ui32 shift, __m256i half)
+    { // 8 chroma samples, less half; sample i is sp[i >> shift]
+      __m256i v;
+      if (shift == 0)
+        v = _mm256_loadu_si256((__m256i*)sp);
+      else
+        v = _mm256_permutevar8x32_epi32(
+          _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)sp)),
+          _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+      return _mm256_cvtepi32_ps(_mm256_sub_epi32(v, half));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    struct avx2_ycc
+    { // full-range YCbCr, with cb and cr of sample x at x >> shift
+      avx2_ycc(const si32* y, const si32* cb, const si32* cr, ui32 shift,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), shift(shift), half(_mm256_set1_epi32(half)),
+        l(0, hi, 1.0f, 0.0f) {}
+
+      void operator()(ui32 x, __m256i rgb[3]) const
+      {
+        __m256 fy = _mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i*)(y + x)));
+        __m256 fb = avx2_load_chroma(cb + (x >> shift), shift, half);
+        __m256 fr = avx2_load_chroma(cr + (x >> shift), shift, half);
+        __m256 r = _mm256_add_ps(fy,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cr_to_r), fr));
+        __m256 g = _mm256_sub_ps(fy,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cb_to_g), fb));
+        g = _mm256_sub_ps(g, _mm256_mul_ps(_mm256_set1_ps(ycc_cr_to_g), fr));
+        __m256 b = _mm256_add_ps(fy,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cb_to_b), fb));
+        rgb[0] = avx2_round(r, l);
+        rgb[1] = avx2_round(g, l);
+        rgb[2] = avx2_round(b, l);
+      }
+
+      const si32 *y, *cb, *cr;
+      ui32 shift;
+      __m256i half;
+      avx2_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct avx2_rct
+    { // the reversible colour transform, then the level shift
+      avx2_rct(const si32* y, const si32* cb, const si32* cr,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), half(_mm256_set1_epi32(half)),
+        l(0, hi, 1.0f, 0.0f) {}
+
+      void operator()(ui32 x, __m256i rgb[3]) const
+      {
+        __m256i my = _mm256_loadu_si256((__m256i*)(y + x));
+        __m256i mb = _mm256_loadu_si256((__m256i*)(cb + x));
+        __m256i mr = _mm256_loadu_si256((__m256i*)(cr + x));
+        __m256i g = _mm256_sub_epi32(my,
+          _mm256_srai_epi32(_mm256_add_epi32(mb, mr), 2));
+        g = _mm256_add_epi32(g, half);
+        rgb[0] = clamp(_mm256_add_epi32(mr, g));
+        rgb[1] = clamp(g);
+        rgb[2] = clamp(_mm256_add_epi32(mb, g));
+      }
+
+      __m256i clamp(__m256i v) const
+      { return _mm256_min_epi32(_mm256_max_epi32(v, l.lo), l.hi); }
+
+      const si32 *y, *cb, *cr;
+      __m256i half;
+      avx2_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct avx2_ict
+    { // the irreversible colour transform, then scaling and level shift
+      avx2_ict(const float* y, const float* cb, const float* cr,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), l(0, hi, 2.0f * (float)half, (float)half) {}
+
+      void operator()(ui32 x, __m256i rgb[3]) const
+      {
+        __m256 my = _mm256_loadu_ps(y + x);
+        __m256 mb = _mm256_loadu_ps(cb + x);
+        __m256 mr = _mm256_loadu_ps(cr + x);
+        __m256 r = _mm256_add_ps(my,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cr_to_r), mr));
+        __m256 g = _mm256_sub_ps(my,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cb_to_g), mb));
+        g = _mm256_sub_ps(g, _mm256_mul_ps(_mm256_set1_ps(ycc_cr_to_g), mr));
+        __m256 b = _mm256_add_ps(my,
+          _mm256_mul_ps(_mm256_set1_ps(ycc_cb_to_b), mb));
+        rgb[0] = avx2_round(_mm256_add_ps(_mm256_mul_ps(r, l.mul), l.add), l);
+        rgb[1] = avx2_round(_mm256_add_ps(_mm256_mul_ps(g, l.mul), l.add), l);
+        rgb[2] = avx2_round(_mm256_add_ps(_mm256_mul_ps(b, l.mul), l.add), l);
+      }
+
+      const float *y, *cb, *cr;
+      avx2_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename C>
+    static inline
+    ui32 avx2_rgb_row(const C& conv, ui8* dst, ui32 stride, ui32 width)
+    { // converts 32 pixels at a time; returns the first one left
+      __m256i idx = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+      __m256i alpha = _mm256_set1_epi32(-1);
+      ui32 x = 0;
+      for (; x + 32 <= width; x += 32)
+      {
+        __m256i v[4][3], p[3];
+        for (ui32 k = 0; k < 4; ++k)
+          conv(x + 8 * k, v[k]);
+        for (int c = 0; c < 3; ++c)
+        { // samples are already within [0, 255]
+          __m256i a = _mm256_packs_epi32(v[0][c], v[1][c]);
+          __m256i b = _mm256_packs_epi32(v[2][c], v[3][c]);
+          p[c] = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), idx);
+        }
+        if (stride == 3)
+          avx2_store3(shuffle3_ui8, p[0], p[1], p[2],
+                      (__m128i*)(dst + 3 * (size_t)x));
+        else
+        {
+          __m256i t0 = _mm256_unpacklo_epi8(p[0], p[1]);
+          __m256i t1 = _mm256_unpackhi_epi8(p[0], p[1]);
+          __m256i u0 = _mm256_unpacklo_epi8(p[2], alpha);
+          __m256i u1 = _mm256_unpackhi_epi8(p[2], alpha);
+          avx2_store4(_mm256_unpacklo_epi16(t0, u0),
+                      _mm256_unpackhi_epi16(t0, u0),
+                      _mm256_unpacklo_epi16(t1, u1),
+                      _mm256_unpackhi_epi16(t1, u1),
+                      (__m256i*)(dst + 4 * (size_t)x));
+        }
+      }
+      return x;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename C>
+    static inline
+    ui32 avx2_rgb_row(const C& conv, ui16* dst, ui32 stride, ui32 width)
+    { // converts 16 pixels at a time; returns the first one left
+      __m256i alpha = _mm256_set1_epi32(-1);
+      ui32 x = 0;
+      for (; x + 16 <= width; x += 16)
+      {
+        __m256i v[2][3], p[3];
+        for (ui32 k = 0; k < 2; ++k)
+          conv(x + 8 * k, v[k]);
+        for (int c = 0; c < 3; ++c)
+        { // as avx2_load_ui16, sign extension keeps packing from saturating
+          __m256i a = _mm256_srai_epi32(_mm256_slli_epi32(v[0][c], 16), 16);
+          __m256i b = _mm256_srai_epi32(_mm256_slli_epi32(v[1][c], 16), 16);
+          p[c] = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        }
+        if (stride == 3)
+          avx2_store3(shuffle3_ui16, p[0], p[1], p[2],
+                      (__m128i*)(dst + 3 * (size_t)x));
+        else
+        {
+          __m256i t0 = _mm256_unpacklo_epi16(p[0], p[1]);
+          __m256i t1 = _mm256_unpackhi_epi16(p[0], p[1]);
+          __m256i u0 = _mm256_unpacklo_epi16(p[2], alpha);
+          __m256i u1 = _mm256_unpackhi_epi16(p[2], alpha);
+          avx2_store4(_mm256_unpacklo_epi32(t0, u0),
+                      _mm256_unpackhi_epi32(t0, u0),
+                      _mm256_unpacklo_epi32(t1, u1),
+                      _mm256_unpackhi_epi32(t1, u1),
+                      (__m256i*)(dst + 4 * (size_t)x));
+        }
+      }
+      return x;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_ycc(y, cb, cr, shift, half, hi),
+                            dst, stride, width);
+      gen_pack_ycc_from(x, y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_ycc(y, cb, cr, shift, half, hi),
+                            dst, stride, width);
+      gen_pack_ycc_from(x, y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_rct(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_rct(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_ict(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = avx2_rgb_row(avx2_ict(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      avx2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      avx2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      avx2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      avx2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      avx2_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      avx2_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      avx2_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      avx2_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
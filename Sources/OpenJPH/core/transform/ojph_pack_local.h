@@ -0,0 +1,497 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack_local.h
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+
+#ifndef OJPH_PACK_LOCAL_H
+#define OJPH_PACK_LOCAL_H
+
+#include <cstddef>
+
+#include "ojph_defs.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //                           Generic Functions
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    // Overloads of the generic functions, used by the SIMD implementations
+    // for the layouts they do not vectorize and for leftover samples
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const si32* const* src, ui32 num_srcs, ui8* dst,
+                  ui32 stride, ui32 width, si32 lo, si32 hi,
+                  float mul, float add)
+    { gen_pack_si32_to_ui8(src, num_srcs, dst, stride, width, lo, hi,
+                           mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const si32* const* src, ui32 num_srcs, ui16* dst,
+                  ui32 stride, ui32 width, si32 lo, si32 hi,
+                  float mul, float add)
+    { gen_pack_si32_to_ui16(src, num_srcs, dst, stride, width, lo, hi,
+                            mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const float* const* src, ui32 num_srcs, ui8* dst,
+                  ui32 stride, ui32 width, si32 lo, si32 hi,
+                  float mul, float add)
+    { gen_pack_f32_to_ui8(src, num_srcs, dst, stride, width, lo, hi,
+                          mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const float* const* src, ui32 num_srcs, ui16* dst,
+                  ui32 stride, ui32 width, si32 lo, si32 hi,
+                  float mul, float add)
+    { gen_pack_f32_to_ui16(src, num_srcs, dst, stride, width, lo, hi,
+                           mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const si32* const* src, ui32 num_srcs, float* dst,
+                  ui32 stride, ui32 width, float mul, float add)
+    { gen_pack_si32_to_f32(src, num_srcs, dst, stride, width, mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const float* const* src, ui32 num_srcs, float* dst,
+                  ui32 stride, ui32 width, float mul, float add)
+    { gen_pack_f32_to_f32(src, num_srcs, dst, stride, width, mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const si32* const* src, ui32 num_srcs, ui16* dst,
+                  ui32 stride, ui32 width, float mul, float add)
+    { gen_pack_si32_to_f16(src, num_srcs, dst, stride, width, mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack(const float* const* src, ui32 num_srcs, ui16* dst,
+                  ui32 stride, ui32 width, float mul, float add)
+    { gen_pack_f32_to_f16(src, num_srcs, dst, stride, width, mul, add); }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void gen_pack_from(ui32 x, const T* const* src, ui32 num_srcs, D* dst,
+                       ui32 stride, ui32 width, si32 lo, si32 hi,
+                       float mul, float add)
+    { // converts samples x and up; used with at most 4 sources
+      if (x >= width)
+        return;
+      const T* sp[4];
+      for (ui32 c = 0; c < num_srcs; ++c)
+        sp[c] = src[c] + x;
+      gen_pack(sp, num_srcs, dst + (size_t)x * stride, stride, width - x,
+               lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void gen_pack_from(ui32 x, const T* const* src, ui32 num_srcs, D* dst,
+                       ui32 stride, ui32 width, float mul, float add)
+    { // the same, for floating-point outputs
+      if (x >= width)
+        return;
+      const T* sp[4];
+      for (ui32 c = 0; c < num_srcs; ++c)
+        sp[c] = src[c] + x;
+      gen_pack(sp, num_srcs, dst + (size_t)x * stride, stride, width - x,
+               mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Coefficients of the YCbCr to RGB conversion, from ITU-R BT.601 as
+    // DICOM PS3.3 C.7.6.3.1.2 gives them; the irreversible colour
+    // transform of JPEG 2000 uses the same
+    static const float ycc_cr_to_r = 1.402f;
+    static const float ycc_cb_to_g = 0.344136f;
+    static const float ycc_cr_to_g = 0.714136f;
+    static const float ycc_cb_to_b = 1.772f;
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_ycc(const si32* y, const si32* cb, const si32* cr,
+                      ui8* dst, ui32 stride, ui32 width, ui32 shift,
+                      si32 half, si32 hi)
+    { gen_pack_ycc_to_rgb8(y, cb, cr, dst, stride, width, shift, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_ycc(const si32* y, const si32* cb, const si32* cr,
+                      ui16* dst, ui32 stride, ui32 width, ui32 shift,
+                      si32 half, si32 hi)
+    { gen_pack_ycc_to_rgb16(y, cb, cr, dst, stride, width, shift, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename D>
+    static inline
+    void gen_pack_ycc_from(ui32 x, const si32* y, const si32* cb,
+                           const si32* cr, D* dst, ui32 stride, ui32 width,
+                           ui32 shift, si32 half, si32 hi)
+    { // converts samples x and up; x must be even when shift is 1
+      if (x >= width)
+        return;
+      gen_pack_ycc(y + x, cb + (x >> shift), cr + (x >> shift),
+                   dst + stride * (size_t)x, stride, width - x, shift,
+                   half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_rct(const si32* y, const si32* cb, const si32* cr,
+                      ui8* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    { gen_pack_rct_to_rgb8(y, cb, cr, dst, stride, width, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_rct(const si32* y, const si32* cb, const si32* cr,
+                      ui16* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    { gen_pack_rct_to_rgb16(y, cb, cr, dst, stride, width, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_rct(const float* y, const float* cb, const float* cr,
+                      ui8* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    { gen_pack_ict_to_rgb8(y, cb, cr, dst, stride, width, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void gen_pack_rct(const float* y, const float* cb, const float* cr,
+                      ui16* dst, ui32 stride, ui32 width, si32 half, si32 hi)
+    { gen_pack_ict_to_rgb16(y, cb, cr, dst, stride, width, half, hi); }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void gen_pack_rct_from(ui32 x, const T* y, const T* cb, const T* cr,
+                           D* dst, ui32 stride, ui32 width, si32 half,
+                           si32 hi)
+    { // converts samples x and up, of either colour transform
+      if (x >= width)
+        return;
+      gen_pack_rct(y + x, cb + x, cr + x, dst + stride * (size_t)x, stride,
+                   width - x, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //                             SSE2 Functions
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //                             AVX2 Functions
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //                             NEON Functions
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi);
+  }
+}
+
+#endif // !OJPH_PACK_LOCAL_H
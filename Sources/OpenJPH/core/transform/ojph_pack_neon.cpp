@@ -0,0 +1,594 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack_neon.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#ifdef OJPH_ENABLE_NEON
+
+#include <arm_neon.h>
+
+#include "ojph_defs.h"
+#include "ojph_pack.h"
+#include "ojph_pack_local.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // One to four interleaved sources are vectorized here, using the
+    // interleaving stores of NEON; other layouts, and leftover samples that
+    // do not fill a vector, are left to the generic implementation.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    struct neon_limits
+    {
+      neon_limits(si32 lo, si32 hi, float mul, float add)
+      : lo(vdupq_n_s32(lo)), hi(vdupq_n_s32(hi)),
+        flo(vdupq_n_f32((float)lo)), fhi(vdupq_n_f32((float)hi)),
+        mul(vdupq_n_f32(mul)), add(vdupq_n_f32(add)) {}
+
+      int32x4_t lo, hi;
+      float32x4_t flo, fhi, mul, add;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    int32x4_t neon_round(float32x4_t v, const neon_limits& l)
+    { // vmaxnmq_f32 returns the number for NaN, giving lo; vcvtaq_s32_f32
+      // rounds halfway cases away from zero
+      v = vmaxnmq_f32(v, l.flo);
+      return vcvtaq_s32_f32(vminq_f32(v, l.fhi));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    int32x4_t neon_load(const si32* sp, const neon_limits& l)
+    {
+      int32x4_t v = vld1q_s32(sp);
+      if (MAP)
+        return neon_round(vaddq_f32(vmulq_f32(vcvtq_f32_s32(v), l.mul),
+                                    l.add), l);
+      return vminq_s32(vmaxq_s32(v, l.lo), l.hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    int32x4_t neon_load(const float* sp, const neon_limits& l)
+    {
+      float32x4_t v = vld1q_f32(sp);
+      if (MAP)
+        v = vaddq_f32(vmulq_f32(v, l.mul), l.add);
+      return neon_round(v, l);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    uint16x8_t neon_load_ui16(const T* sp, const neon_limits& l)
+    { // 8 samples; narrowing keeps the low 16 bits
+      uint32x4_t a = vreinterpretq_u32_s32(neon_load<MAP>(sp, l));
+      uint32x4_t b = vreinterpretq_u32_s32(neon_load<MAP>(sp + 4, l));
+      return vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    uint8x16_t neon_load_ui8(const T* sp, const neon_limits& l)
+    { // 16 samples, already within [0, 255]
+      uint16x8_t a = neon_load_ui16<MAP>(sp, l);
+      uint16x8_t b = neon_load_ui16<MAP>(sp + 8, l);
+      return vcombine_u8(vmovn_u16(a), vmovn_u16(b));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void neon_pack(const T* const* src, ui32 num_srcs, ui16* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride || num_srcs == 0 || num_srcs > 4)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      neon_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 8 <= width; x += 8)
+          vst1q_u16(dst + x, neon_load_ui16<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 8 <= width; x += 8)
+        {
+          uint16x8x2_t v;
+          v.val[0] = neon_load_ui16<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui16<MAP>(src[1] + x, l);
+          vst2q_u16(dst + 2 * (size_t)x, v);
+        }
+      else if (num_srcs == 3)
+        for (; x + 8 <= width; x += 8)
+        {
+          uint16x8x3_t v;
+          v.val[0] = neon_load_ui16<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui16<MAP>(src[1] + x, l);
+          v.val[2] = neon_load_ui16<MAP>(src[2] + x, l);
+          vst3q_u16(dst + 3 * (size_t)x, v);
+        }
+      else
+        for (; x + 8 <= width; x += 8)
+        {
+          uint16x8x4_t v;
+          v.val[0] = neon_load_ui16<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui16<MAP>(src[1] + x, l);
+          v.val[2] = neon_load_ui16<MAP>(src[2] + x, l);
+          v.val[3] = neon_load_ui16<MAP>(src[3] + x, l);
+          vst4q_u16(dst + 4 * (size_t)x, v);
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void neon_pack(const T* const* src, ui32 num_srcs, ui8* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride || num_srcs == 0 || num_srcs > 4)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      neon_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 16 <= width; x += 16)
+          vst1q_u8(dst + x, neon_load_ui8<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 16 <= width; x += 16)
+        {
+          uint8x16x2_t v;
+          v.val[0] = neon_load_ui8<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui8<MAP>(src[1] + x, l);
+          vst2q_u8(dst + 2 * (size_t)x, v);
+        }
+      else if (num_srcs == 3)
+        for (; x + 16 <= width; x += 16)
+        {
+          uint8x16x3_t v;
+          v.val[0] = neon_load_ui8<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui8<MAP>(src[1] + x, l);
+          v.val[2] = neon_load_ui8<MAP>(src[2] + x, l);
+          vst3q_u8(dst + 3 * (size_t)x, v);
+        }
+      else
+        for (; x + 16 <= width; x += 16)
+        {
+          uint8x16x4_t v;
+          v.val[0] = neon_load_ui8<MAP>(src[0] + x, l);
+          v.val[1] = neon_load_ui8<MAP>(src[1] + x, l);
+          v.val[2] = neon_load_ui8<MAP>(src[2] + x, l);
+          v.val[3] = neon_load_ui8<MAP>(src[3] + x, l);
+          vst4q_u8(dst + 4 * (size_t)x, v);
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void neon_pack_lines(const T* const* src, ui32 num_srcs, D* dst,
+                         ui32 stride, ui32 width, si32 lo, si32 hi,
+                         float mul, float add)
+    {
+      if (mul == 1.0f && add == 0.0f)
+        neon_pack<false>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+      else
+        neon_pack<true>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Floating-point outputs are vectorized for a single source written
+    // contiguously, as planar and single-component images are; the
+    // conversion to half precision rounds to nearest even, the default
+    // rounding mode.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    float32x4_t neon_map(const si32* sp, float32x4_t mul, float32x4_t add)
+    {
+      return vaddq_f32(vmulq_f32(vcvtq_f32_s32(vld1q_s32(sp)), mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    float32x4_t neon_map(const float* sp, float32x4_t mul, float32x4_t add)
+    {
+      return vaddq_f32(vmulq_f32(vld1q_f32(sp), mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void neon_to_f32(const T* const* src, ui32 num_srcs, float* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      float32x4_t m = vdupq_n_f32(mul), a = vdupq_n_f32(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 4 <= width; x += 4)
+        vst1q_f32(dst + x, neon_map(sp + x, m, a));
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void neon_to_f16(const T* const* src, ui32 num_srcs, ui16* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      float32x4_t m = vdupq_n_f32(mul), a = vdupq_n_f32(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 8 <= width; x += 8)
+      {
+        float16x4_t h0 = vcvt_f16_f32(neon_map(sp + x, m, a));
+        float16x4_t h1 = vcvt_f16_f32(neon_map(sp + x + 4, m, a));
+        vst1q_u16(dst + x, vreinterpretq_u16_f16(vcombine_f16(h0, h1)));
+      }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // The colour conversions compute 4 samples of each colour at a time, in
+    // the operation order of the generic code, and interleave them with
+    // vst3, or with vst4 and an alpha of all ones.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    float32x4_t neon_load_chroma(const si32* sp, ui32 shift, int32x4_t half)
+    { // 4 chroma samples, less half; sample i is sp[i >> shift]
+      int32x4_t v;
+      if (shift == 0)
+        v = vld1q_s32(sp);
+      else
+      {
+        int32x2_t t = vld1_s32(sp);
+        int32x2x2_t z = vzip_s32(t, t);
+        v = vcombine_s32(z.val[0], z.val[1]);
+      }
+      return vcvtq_f32_s32(vsubq_s32(v, half));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    struct neon_ycc
+    { // full-range YCbCr, with cb and cr of sample x at x >> shift
+      neon_ycc(const si32* y, const si32* cb, const si32* cr, ui32 shift,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), shift(shift), half(vdupq_n_s32(half)),
+        l(0, hi, 1.0f, 0.0f) {}
+
+      void operator()(ui32 x, uint32x4_t rgb[3]) const
+      {
+        float32x4_t fy = vcvtq_f32_s32(vld1q_s32(y + x));
+        float32x4_t fb = neon_load_chroma(cb + (x >> shift), shift, half);
+        float32x4_t fr = neon_load_chroma(cr + (x >> shift), shift, half);
+        float32x4_t r =
+          vaddq_f32(fy, vmulq_f32(vdupq_n_f32(ycc_cr_to_r), fr));
+        float32x4_t g =
+          vsubq_f32(fy, vmulq_f32(vdupq_n_f32(ycc_cb_to_g), fb));
+        g = vsubq_f32(g, vmulq_f32(vdupq_n_f32(ycc_cr_to_g), fr));
+        float32x4_t b =
+          vaddq_f32(fy, vmulq_f32(vdupq_n_f32(ycc_cb_to_b), fb));
+        rgb[0] = vreinterpretq_u32_s32(neon_round(r, l));
+        rgb[1] = vreinterpretq_u32_s32(neon_round(g, l));
+        rgb[2] = vreinterpretq_u32_s32(neon_round(b, l));
+      }
+
+      const si32 *y, *cb, *cr;
+      ui32 shift;
+      int32x4_t half;
+      neon_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct neon_rct
+    { // the reversible colour transform, then the level shift
+      neon_rct(const si32* y, const si32* cb, const si32* cr,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), half(vdupq_n_s32(half)),
+        l(0, hi, 1.0f, 0.0f) {}
+
+      void operator()(ui32 x, uint32x4_t rgb[3]) const
+      {
+        int32x4_t my = vld1q_s32(y + x);
+        int32x4_t mb = vld1q_s32(cb + x);
+        int32x4_t mr = vld1q_s32(cr + x);
+        int32x4_t g = vsubq_s32(my, vshrq_n_s32(vaddq_s32(mb, mr), 2));
+        g = vaddq_s32(g, half);
+        rgb[0] = clamp(vaddq_s32(mr, g));
+        rgb[1] = clamp(g);
+        rgb[2] = clamp(vaddq_s32(mb, g));
+      }
+
+      uint32x4_t clamp(int32x4_t v) const
+      { return vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(v, l.lo), l.hi)); }
+
+      const si32 *y, *cb, *cr;
+      int32x4_t half;
+      neon_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    struct neon_ict
+    { // the irreversible colour transform, then scaling and level shift
+      neon_ict(const float* y, const float* cb, const float* cr,
+               si32 half, si32 hi)
+      : y(y), cb(cb), cr(cr), l(0, hi, 2.0f * (float)half, (float)half) {}
+
+      void operator()(ui32 x, uint32x4_t rgb[3]) const
+      {
+        float32x4_t my = vld1q_f32(y + x);
+        float32x4_t mb = vld1q_f32(cb + x);
+        float32x4_t mr = vld1q_f32(cr + x);
+        float32x4_t r =
+          vaddq_f32(my, vmulq_f32(vdupq_n_f32(ycc_cr_to_r), mr));
+        float32x4_t g =
+          vsubq_f32(my, vmulq_f32(vdupq_n_f32(ycc_cb_to_g), mb));
+        g = vsubq_f32(g, vmulq_f32(vdupq_n_f32(ycc_cr_to_g), mr));
+        float32x4_t b =
+          vaddq_f32(my, vmulq_f32(vdupq_n_f32(ycc_cb_to_b), mb));
+        rgb[0] = scale(r);
+        rgb[1] = scale(g);
+        rgb[2] = scale(b);
+      }
+
+      uint32x4_t scale(float32x4_t v) const
+      {
+        v = vaddq_f32(vmulq_f32(v, l.mul), l.add);
+        return vreinterpretq_u32_s32(neon_round(v, l));
+      }
+
+      const float *y, *cb, *cr;
+      neon_limits l;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename C>
+    static inline
+    ui32 neon_rgb_row(const C& conv, ui8* dst, ui32 stride, ui32 width)
+    { // converts 16 pixels at a time; returns the first one left
+      ui32 x = 0;
+      for (; x + 16 <= width; x += 16)
+      {
+        uint32x4_t v[4][3];
+        for (ui32 k = 0; k < 4; ++k)
+          conv(x + 4 * k, v[k]);
+        uint8x16x4_t p;
+        for (int c = 0; c < 3; ++c)
+        { // samples are already within [0, 255]
+          uint16x8_t a = vcombine_u16(vmovn_u32(v[0][c]), vmovn_u32(v[1][c]));
+          uint16x8_t b = vcombine_u16(vmovn_u32(v[2][c]), vmovn_u32(v[3][c]));
+          p.val[c] = vcombine_u8(vmovn_u16(a), vmovn_u16(b));
+        }
+        if (stride == 3)
+        {
+          uint8x16x3_t q = { { p.val[0], p.val[1], p.val[2] } };
+          vst3q_u8(dst + 3 * (size_t)x, q);
+        }
+        else
+        {
+          p.val[3] = vdupq_n_u8(0xFF);
+          vst4q_u8(dst + 4 * (size_t)x, p);
+        }
+      }
+      return x;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename C>
+    static inline
+    ui32 neon_rgb_row(const C& conv, ui16* dst, ui32 stride, ui32 width)
+    { // converts 8 pixels at a time; returns the first one left
+      ui32 x = 0;
+      for (; x + 8 <= width; x += 8)
+      {
+        uint32x4_t v[2][3];
+        for (ui32 k = 0; k < 2; ++k)
+          conv(x + 4 * k, v[k]);
+        uint16x8x4_t p;
+        for (int c = 0; c < 3; ++c)
+          p.val[c] = vcombine_u16(vmovn_u32(v[0][c]), vmovn_u32(v[1][c]));
+        if (stride == 3)
+        {
+          uint16x8x3_t q = { { p.val[0], p.val[1], p.val[2] } };
+          vst3q_u16(dst + 3 * (size_t)x, q);
+        }
+        else
+        {
+          p.val[3] = vdupq_n_u16(0xFFFF);
+          vst4q_u16(dst + 4 * (size_t)x, p);
+        }
+      }
+      return x;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ycc_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_ycc(y, cb, cr, shift, half, hi),
+                            dst, stride, width);
+      gen_pack_ycc_from(x, y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ycc_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, ui32 shift, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_ycc(y, cb, cr, shift, half, hi),
+                            dst, stride, width);
+      gen_pack_ycc_from(x, y, cb, cr, dst, stride, width, shift, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_rct_to_rgb8(
+      const si32* y, const si32* cb, const si32* cr, ui8* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_rct(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_rct_to_rgb16(
+      const si32* y, const si32* cb, const si32* cr, ui16* dst, ui32 stride,
+      ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_rct(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ict_to_rgb8(
+      const float* y, const float* cb, const float* cr, ui8* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_ict(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_ict_to_rgb16(
+      const float* y, const float* cb, const float* cr, ui16* dst,
+      ui32 stride, ui32 width, si32 half, si32 hi)
+    {
+      ui32 x = neon_rgb_row(neon_ict(y, cb, cr, half, hi),
+                            dst, stride, width);
+      gen_pack_rct_from(x, y, cb, cr, dst, stride, width, half, hi);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      neon_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      neon_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      neon_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      neon_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      neon_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      neon_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      neon_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      neon_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+  }
+}
+
+#endif // OJPH_ENABLE_NEON
@@ -0,0 +1,408 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_pack_sse2.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_SSE2)
+
+#include <emmintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_pack.h"
+#include "ojph_pack_local.h"
+
+OJPH_TARGET_BEGIN("sse2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // One, two and four interleaved sources are vectorized here; three
+    // sources need byte shuffles, which SSE2 does not have, and are left,
+    // with other layouts, to the generic implementation.  Leftover samples
+    // that do not fill a vector are also handled by the generic code.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    struct sse2_limits
+    {
+      sse2_limits(si32 lo, si32 hi, float mul, float add)
+      : lo(_mm_set1_epi32(lo)), hi(_mm_set1_epi32(hi)),
+        flo(_mm_set1_ps((float)lo)), fhi(_mm_set1_ps((float)hi)),
+        mul(_mm_set1_ps(mul)), add(_mm_set1_ps(add)) {}
+
+      __m128i lo, hi;
+      __m128 flo, fhi, mul, add;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m128i sse2_round(__m128 v, const sse2_limits& l)
+    { // _mm_max_ps returns its second operand for NaN, giving lo
+      v = _mm_max_ps(v, l.flo);
+      v = _mm_min_ps(v, l.fhi);
+      __m128i r = _mm_cvttps_epi32(v);
+      __m128 d = _mm_sub_ps(v, _mm_cvtepi32_ps(r));
+      // masks are -1 where set; round halfway cases away from zero
+      __m128 up = _mm_cmpge_ps(d, _mm_set1_ps(0.5f));
+      __m128 dn = _mm_cmple_ps(d, _mm_set1_ps(-0.5f));
+      r = _mm_sub_epi32(r, _mm_castps_si128(up));
+      return _mm_add_epi32(r, _mm_castps_si128(dn));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    __m128i sse2_load(const si32* sp, const sse2_limits& l)
+    {
+      __m128i v = _mm_loadu_si128((__m128i*)sp);
+      if (MAP)
+        return sse2_round(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), l.mul),
+                                     l.add), l);
+      // there is no _mm_max_epi32 or _mm_min_epi32 before SSE4.1
+      __m128i m = _mm_cmplt_epi32(v, l.lo);
+      v = _mm_or_si128(_mm_and_si128(m, l.lo), _mm_andnot_si128(m, v));
+      m = _mm_cmpgt_epi32(v, l.hi);
+      return _mm_or_si128(_mm_and_si128(m, l.hi), _mm_andnot_si128(m, v));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP>
+    static inline
+    __m128i sse2_load(const float* sp, const sse2_limits& l)
+    {
+      __m128 v = _mm_loadu_ps(sp);
+      if (MAP)
+        v = _mm_add_ps(_mm_mul_ps(v, l.mul), l.add);
+      return sse2_round(v, l);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    __m128i sse2_load_ui16(const T* sp, const sse2_limits& l)
+    { // 8 samples; sign extending the low 16 bits keeps _mm_packs_epi32
+      // from saturating them
+      __m128i a = sse2_load<MAP>(sp, l), b = sse2_load<MAP>(sp + 4, l);
+      a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+      b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+      return _mm_packs_epi32(a, b);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    __m128i sse2_load_ui8(const T* sp, const sse2_limits& l)
+    { // 16 samples, already within [0, 255]
+      __m128i a = _mm_packs_epi32(sse2_load<MAP>(sp, l),
+                                  sse2_load<MAP>(sp + 4, l));
+      __m128i b = _mm_packs_epi32(sse2_load<MAP>(sp + 8, l),
+                                  sse2_load<MAP>(sp + 12, l));
+      return _mm_packus_epi16(a, b);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void sse2_pack(const T* const* src, ui32 num_srcs, ui16* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride ||
+          (num_srcs != 1 && num_srcs != 2 && num_srcs != 4))
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      sse2_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 8 <= width; x += 8)
+          _mm_storeu_si128((__m128i*)(dst + x),
+                           sse2_load_ui16<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 8 <= width; x += 8)
+        {
+          __m128i p0 = sse2_load_ui16<MAP>(src[0] + x, l);
+          __m128i p1 = sse2_load_ui16<MAP>(src[1] + x, l);
+          __m128i* dp = (__m128i*)(dst + 2 * (size_t)x);
+          _mm_storeu_si128(dp, _mm_unpacklo_epi16(p0, p1));
+          _mm_storeu_si128(dp + 1, _mm_unpackhi_epi16(p0, p1));
+        }
+      else
+        for (; x + 8 <= width; x += 8)
+        {
+          __m128i p0 = sse2_load_ui16<MAP>(src[0] + x, l);
+          __m128i p1 = sse2_load_ui16<MAP>(src[1] + x, l);
+          __m128i p2 = sse2_load_ui16<MAP>(src[2] + x, l);
+          __m128i p3 = sse2_load_ui16<MAP>(src[3] + x, l);
+          __m128i t0 = _mm_unpacklo_epi16(p0, p1);
+          __m128i t1 = _mm_unpackhi_epi16(p0, p1);
+          __m128i u0 = _mm_unpacklo_epi16(p2, p3);
+          __m128i u1 = _mm_unpackhi_epi16(p2, p3);
+          __m128i* dp = (__m128i*)(dst + 4 * (size_t)x);
+          _mm_storeu_si128(dp, _mm_unpacklo_epi32(t0, u0));
+          _mm_storeu_si128(dp + 1, _mm_unpackhi_epi32(t0, u0));
+          _mm_storeu_si128(dp + 2, _mm_unpacklo_epi32(t1, u1));
+          _mm_storeu_si128(dp + 3, _mm_unpackhi_epi32(t1, u1));
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool MAP, typename T>
+    static inline
+    void sse2_pack(const T* const* src, ui32 num_srcs, ui8* dst,
+                   ui32 stride, ui32 width, si32 lo, si32 hi,
+                   float mul, float add)
+    {
+      if (num_srcs != stride ||
+          (num_srcs != 1 && num_srcs != 2 && num_srcs != 4))
+      {
+        gen_pack(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+        return;
+      }
+
+      sse2_limits l(lo, hi, mul, add);
+      ui32 x = 0;
+      if (num_srcs == 1)
+        for (; x + 16 <= width; x += 16)
+          _mm_storeu_si128((__m128i*)(dst + x),
+                           sse2_load_ui8<MAP>(src[0] + x, l));
+      else if (num_srcs == 2)
+        for (; x + 16 <= width; x += 16)
+        {
+          __m128i p0 = sse2_load_ui8<MAP>(src[0] + x, l);
+          __m128i p1 = sse2_load_ui8<MAP>(src[1] + x, l);
+          __m128i* dp = (__m128i*)(dst + 2 * (size_t)x);
+          _mm_storeu_si128(dp, _mm_unpacklo_epi8(p0, p1));
+          _mm_storeu_si128(dp + 1, _mm_unpackhi_epi8(p0, p1));
+        }
+      else
+        for (; x + 16 <= width; x += 16)
+        {
+          __m128i p0 = sse2_load_ui8<MAP>(src[0] + x, l);
+          __m128i p1 = sse2_load_ui8<MAP>(src[1] + x, l);
+          __m128i p2 = sse2_load_ui8<MAP>(src[2] + x, l);
+          __m128i p3 = sse2_load_ui8<MAP>(src[3] + x, l);
+          __m128i t0 = _mm_unpacklo_epi8(p0, p1);
+          __m128i t1 = _mm_unpackhi_epi8(p0, p1);
+          __m128i u0 = _mm_unpacklo_epi8(p2, p3);
+          __m128i u1 = _mm_unpackhi_epi8(p2, p3);
+          __m128i* dp = (__m128i*)(dst + 4 * (size_t)x);
+          _mm_storeu_si128(dp, _mm_unpacklo_epi16(t0, u0));
+          _mm_storeu_si128(dp + 1, _mm_unpackhi_epi16(t0, u0));
+          _mm_storeu_si128(dp + 2, _mm_unpacklo_epi16(t1, u1));
+          _mm_storeu_si128(dp + 3, _mm_unpackhi_epi16(t1, u1));
+        }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T, typename D>
+    static inline
+    void sse2_pack_lines(const T* const* src, ui32 num_srcs, D* dst,
+                         ui32 stride, ui32 width, si32 lo, si32 hi,
+                         float mul, float add)
+    {
+      if (mul == 1.0f && add == 0.0f)
+        sse2_pack<false>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+      else
+        sse2_pack<true>(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Floating-point outputs are vectorized for a single source written
+    // contiguously, as planar and single-component images are.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m128 sse2_map(const si32* sp, __m128 mul, __m128 add)
+    {
+      __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((__m128i*)sp));
+      return _mm_add_ps(_mm_mul_ps(v, mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m128 sse2_map(const float* sp, __m128 mul, __m128 add)
+    {
+      return _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(sp), mul), add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    __m128i sse2_f32_to_f16(__m128 v)
+    { // gen_f32_to_f16 on 4 samples, leaving them in the low 16 bits
+      __m128i u = _mm_castps_si128(v);
+      __m128i sign = _mm_and_si128(u, _mm_set1_epi32((si32)0x80000000u));
+      u = _mm_xor_si128(u, sign);
+      // normal halves
+      __m128i odd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+      __m128i h = _mm_add_epi32(u, _mm_set1_epi32((si32)0xC8000FFFu));
+      h = _mm_srli_epi32(_mm_add_epi32(h, odd), 13);
+      // subnormal halves
+      __m128 t = _mm_add_ps(_mm_castsi128_ps(u), _mm_set1_ps(0.5f));
+      __m128i s = _mm_sub_epi32(_mm_castps_si128(t),
+                                _mm_set1_epi32(0x3F000000));
+      __m128i m = _mm_cmplt_epi32(u, _mm_set1_epi32(0x38800000));
+      h = _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, h));
+      // infinities and NaNs
+      __m128i nan = _mm_cmpgt_epi32(u, _mm_set1_epi32(0x7F800000));
+      __m128i inf = _mm_or_si128(_mm_set1_epi32(0x7C00),
+                                 _mm_and_si128(nan, _mm_set1_epi32(0x200)));
+      m = _mm_cmpgt_epi32(u, _mm_set1_epi32(0x477FFFFF));
+      h = _mm_or_si128(_mm_and_si128(m, inf), _mm_andnot_si128(m, h));
+      return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void sse2_to_f32(const T* const* src, ui32 num_srcs, float* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      __m128 m = _mm_set1_ps(mul), a = _mm_set1_ps(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 4 <= width; x += 4)
+        _mm_storeu_ps(dst + x, sse2_map(sp + x, m, a));
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    static inline
+    void sse2_to_f16(const T* const* src, ui32 num_srcs, ui16* dst,
+                     ui32 stride, ui32 width, float mul, float add)
+    {
+      if (num_srcs != 1 || stride != 1)
+      {
+        gen_pack(src, num_srcs, dst, stride, width, mul, add);
+        return;
+      }
+
+      __m128 m = _mm_set1_ps(mul), a = _mm_set1_ps(add);
+      const T* sp = src[0];
+      ui32 x = 0;
+      for (; x + 8 <= width; x += 8)
+      { // sign extension keeps _mm_packs_epi32 from saturating
+        __m128i h0 = sse2_f32_to_f16(sse2_map(sp + x, m, a));
+        __m128i h1 = sse2_f32_to_f16(sse2_map(sp + x + 4, m, a));
+        h0 = _mm_srai_epi32(_mm_slli_epi32(h0, 16), 16);
+        h1 = _mm_srai_epi32(_mm_slli_epi32(h1, 16), 16);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(h0, h1));
+      }
+      gen_pack_from(x, src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_ui8(
+      const si32* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      sse2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_ui16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      sse2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_ui8(
+      const float* const* src, ui32 num_srcs, ui8* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      sse2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_ui16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, si32 lo, si32 hi, float mul, float add)
+    {
+      sse2_pack_lines(src, num_srcs, dst, stride, width, lo, hi, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_f32(
+      const si32* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      sse2_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_f32(
+      const float* const* src, ui32 num_srcs, float* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      sse2_to_f32(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_si32_to_f16(
+      const si32* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      sse2_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_pack_f32_to_f16(
+      const float* const* src, ui32 num_srcs, ui16* dst, ui32 stride,
+      ui32 width, float mul, float add)
+    {
+      sse2_to_f16(src, num_srcs, dst, stride, width, mul, add);
+    }
+  }
+}
+
+OJPH_TARGET_END
+
+#endif
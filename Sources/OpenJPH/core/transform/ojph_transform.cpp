@@ -35,7 +35,9 @@
 // Date: 28 August 2019
 //***************************************************************************/
 
+#include <atomic>
 #include <cstdio>
+#include <mutex>
 
 #include "ojph_arch.h"
 #include "ojph_mem.h"
@@ -93,15 +95,51 @@ namespace ojph {
       (const param_atk* atk, const line_buf* dst, const line_buf* lsrc,
         const line_buf* hsrc, ui32 width, bool even) = NULL;
 
+    /////////////////////////////////////////////////////////////////////////
+    // Fixed-point irreversible functions
+    /////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////
+    void (*fix_vert_step)
+      (const lifting_step* s, const line_buf* sig, const line_buf* other,
+        const line_buf* aug, ui32 repeat, bool synthesis) = NULL;
+
+    /////////////////////////////////////////////////////////////////////////
+    void (*fix_vert_times_K)
+      (float K, const line_buf* aug, ui32 repeat) = NULL;
+
+    /////////////////////////////////////////////////////////////////////////
+    void (*fix_horz_syn)
+      (const param_atk* atk, const line_buf* dst, const line_buf* lsrc,
+        const line_buf* hsrc, ui32 width, bool even) = NULL;
+
+    /////////////////////////////////////////////////////////////////////////
+    void (*fix_to_float)
+      (const line_buf* src, const line_buf* dst, ui32 width) = NULL;
+
     ////////////////////////////////////////////////////////////////////////////
-    static bool wavelet_transform_functions_initialized = false;
+    // the extension level the functions were chosen for, -1 before the
+    // first call; codestreams created at the same time on several threads
+    // choose them one at a time
+    static std::atomic<int> wavelet_functions_level(-1);
+    static std::mutex wavelet_functions_mutex;
 
     //////////////////////////////////////////////////////////////////////////
     void init_wavelet_transform_functions()
     {
-      if (wavelet_transform_functions_initialized)
+      const int level = get_cpu_ext_level();
+      if (wavelet_functions_level.load(std::memory_order_acquire) == level)
+        return;
+      std::lock_guard<std::mutex> lock(wavelet_functions_mutex);
+      if (wavelet_functions_level.load(std::memory_order_relaxed) == level)
         return;
 
+      // the fixed-point functions have no WASM versions
+      fix_vert_step             = gen_fix_vert_step;
+      fix_vert_times_K          = gen_fix_vert_times_K;
+      fix_horz_syn              = gen_fix_horz_syn;
+      fix_to_float              = gen_fix_to_float;
+
 #if !defined(OJPH_ENABLE_WASM_SIMD) || !defined(OJPH_EMSCRIPTEN)
 
       rev_vert_step             = gen_rev_vert_step;
@@ -171,6 +209,24 @@ namespace ojph {
     
     #elif defined(OJPH_ARCH_ARM)
 
+      #ifdef OJPH_ENABLE_NEON
+        if (get_cpu_ext_level() >= ARM_CPU_EXT_LEVEL_NEON)
+        {
+          // analysis runs only when encoding; it keeps the generic code
+          rev_vert_step             = neon_rev_vert_step;
+          rev_horz_syn              = neon_rev_horz_syn;
+
+          irv_vert_step             = neon_irv_vert_step;
+          irv_vert_times_K          = neon_irv_vert_times_K;
+          irv_horz_syn              = neon_irv_horz_syn;
+
+          fix_vert_step             = neon_fix_vert_step;
+          fix_vert_times_K          = neon_fix_vert_times_K;
+          fix_horz_syn              = neon_fix_horz_syn;
+          fix_to_float              = neon_fix_to_float;
+        }
+      #endif // !OJPH_ENABLE_NEON
+
     #endif // !(defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
 
   #endif // !OJPH_DISABLE_SIMD
@@ -186,7 +242,7 @@ namespace ojph {
         irv_horz_syn              = wasm_irv_horz_syn;
 #endif // !OJPH_ENABLE_WASM_SIMD
 
-      wavelet_transform_functions_initialized = true;
+      wavelet_functions_level.store(level, std::memory_order_release);
     }
     
     //////////////////////////////////////////////////////////////////////////
@@ -840,5 +896,118 @@ namespace ojph {
 
 #endif // !OJPH_ENABLE_WASM_SIMD
 
+    //////////////////////////////////////////////////////////////////////////
+    // a * x rounded to the nearest step of 2^-fix_frac_bits, for `a` from
+    // fix_coefficient(); NEON's vrshrn rounds the same way
+    static inline si32 fix_multiply(si32 a, si32 x)
+    {
+      const si64 half = (si64)1 << (fix_frac_bits - 1);
+      return (si32)(((si64)a * x + half) >> fix_frac_bits);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_fix_vert_step(const lifting_step* s, const line_buf* sig,
+                           const line_buf* other, const line_buf* aug,
+                           ui32 repeat, bool synthesis)
+    {
+      float a = s->irv.Aatk;
+
+      if (synthesis)
+        a = -a;
+
+      const si32 fa = fix_coefficient(a);
+      si32* dst = aug->i32;
+      const si32* src1 = sig->i32, * src2 = other->i32;
+      for (ui32 i = repeat; i > 0; --i)
+        *dst++ += fix_multiply(fa, *src1++ + *src2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_fix_vert_times_K(float K, const line_buf* aug, ui32 repeat)
+    {
+      const si32 fK = fix_coefficient(K);
+      si32* dst = aug->i32;
+      for (ui32 i = repeat; i > 0; --i, ++dst)
+        *dst = fix_multiply(fK, *dst);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_fix_horz_syn(const param_atk* atk, const line_buf* dst,
+                          const line_buf* lsrc, const line_buf* hsrc,
+                          ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si32* oth = hsrc->i32, * aug = lsrc->i32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+
+        {
+          const si32 fK = fix_coefficient(atk->get_K());
+          const si32 fK_inv = fix_coefficient(1.0f / atk->get_K());
+          si32* dp;
+
+          dp = aug;
+          for (ui32 i = aug_width; i > 0; --i, ++dp)
+            *dp = fix_multiply(fK, *dp);
+
+          dp = oth;
+          for (ui32 i = oth_width; i > 0; --i, ++dp)
+            *dp = fix_multiply(fK_inv, *dp);
+        }
+
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const si32 fa = fix_coefficient(s->irv.Aatk);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si32* sp = oth + (ev ? 0 : 1);
+          si32* dp = aug;
+          for (ui32 i = aug_width; i > 0; --i, sp++, dp++)
+            *dp -= fix_multiply(fa, sp[-1] + sp[0]);
+
+          // swap buffers
+          si32* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        si32* sph = hsrc->i32;
+        si32* spl = lsrc->i32;
+        si32* dp = dst->i32;
+        ui32 w = width;
+        if (!even)
+        { *dp++ = *sph++; --w; }
+        for (; w > 1; w -= 2)
+        { *dp++ = *spl++; *dp++ = *sph++; }
+        if (w)
+        { *dp++ = *spl++; --w; }
+      }
+      else {
+        if (even)
+          dst->i32[0] = lsrc->i32[0];
+        else
+          dst->i32[0] = hsrc->i32[0] >> 1;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void gen_fix_to_float(const line_buf* src, const line_buf* dst,
+                          ui32 width)
+    {
+      const float scale = 1.0f / (float)(1 << fix_frac_bits);
+      const si32* sp = src->i32;
+      float* dp = dst->f32;
+      for (ui32 i = width; i > 0; --i)
+        *dp++ = (float)*sp++ * scale;
+    }
+
   }
 }
@@ -39,6 +39,8 @@
 #ifndef OJPH_TRANSFORM_H
 #define OJPH_TRANSFORM_H
 
+#include <cmath>
+
 #include "ojph_defs.h"
 
 namespace ojph {
@@ -95,6 +97,51 @@ namespace ojph {
       (const param_atk* atk, const line_buf* dst, const line_buf* lsrc, 
         const line_buf* hsrc, ui32 width, bool even);
 
+    /////////////////////////////////////////////////////////////////////////
+    // Fixed-point irreversible synthesis
+    /////////////////////////////////////////////////////////////////////////
+    // For display-only decoding, irreversible samples can be carried in
+    // si32 lines instead of float ones; a sample holds the normalized
+    // float value times 2^fix_frac_bits, so the range of a line is
+    // [-128, 128).  Each multiplication rounds to the nearest step of
+    // 2^-fix_frac_bits, and the SIMD versions round exactly as the
+    // generic ones do.
+    const int fix_frac_bits = 24;
+
+    /////////////////////////////////////////////////////////////////////////
+    // For fixed-point lines, a magnitude m is dequantized to
+    // (m * mult + 2^(shift - 1)) >> shift, m * delta in steps of
+    // 2^-fix_frac_bits; mult has 31 bits, all those of delta, so the product
+    // fits in 62 bits and the result is m * delta rounded once
+    inline void fix_dequantizer(float delta, ui32& mult, ui32& shift)
+    {
+      int e;
+      float f = frexpf(delta, &e);        // delta = f * 2^e, f in [0.5, 1)
+      mult = (ui32)(f * (float)(1u << 31));
+      int s = 31 - fix_frac_bits - e;
+      shift = (ui32)(s < 1 ? 1 : (s > 63 ? 63 : s)); // 63 gives 0
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    extern void (*fix_vert_step)
+      (const lifting_step* s, const line_buf* sig, const line_buf* other,
+        const line_buf* aug, ui32 repeat, bool synthesis);
+
+    /////////////////////////////////////////////////////////////////////////
+    extern void (*fix_vert_times_K)
+      (float K, const line_buf* aug, ui32 repeat);
+
+    /////////////////////////////////////////////////////////////////////////
+    extern void (*fix_horz_syn)
+      (const param_atk* atk, const line_buf* dst, const line_buf* lsrc,
+        const line_buf* hsrc, ui32 width, bool even);
+
+    /////////////////////////////////////////////////////////////////////////
+    // the float samples of a fixed-point line, for the colour transform
+    // and the conversion to integers
+    extern void (*fix_to_float)
+      (const line_buf* src, const line_buf* dst, ui32 width);
+
   }
 }
 
@@ -0,0 +1,349 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_transform_avx2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX2)
+
+#include <cassert>
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "../codestream/ojph_params_local.h"
+
+#include "ojph_transform.h"
+#include "ojph_transform_local.h"
+
+OJPH_TARGET_BEGIN("avx2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // The vector loops below handle eight samples at a time, and the
+    // remaining samples are handled one at a time, so no sample beyond the
+    // width of a line is written.  Only 32-bit lines are vectorized; 64-bit
+    // lines are rare, and stay with the generic code.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_deinterleave(si32* dpl, si32* dph, const si32* sp,
+                           ui32 width, bool even)
+    {
+      if (!even)
+      { *dph++ = *sp++; --width; }
+      for (; width >= 16; width -= 16, sp += 16, dpl += 8, dph += 8)
+      {
+        __m256 a = _mm256_loadu_ps((const float*)sp);
+        __m256 b = _mm256_loadu_ps((const float*)sp + 8);
+        __m256 c = _mm256_permute2f128_ps(a, b, 0x20); // s0-s3, s8-s11
+        __m256 d = _mm256_permute2f128_ps(a, b, 0x31); // s4-s7, s12-s15
+        _mm256_storeu_ps((float*)dpl,
+          _mm256_shuffle_ps(c, d, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps((float*)dph,
+          _mm256_shuffle_ps(c, d, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+      for (; width > 1; width -= 2)
+      { *dpl++ = *sp++; *dph++ = *sp++; }
+      if (width)
+        *dpl = *sp;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx2_interleave(si32* dp, const si32* spl, const si32* sph,
+                         ui32 width, bool even)
+    {
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 16; width -= 16, dp += 16, spl += 8, sph += 8)
+      {
+        __m256i l = _mm256_loadu_si256((__m256i*)spl);
+        __m256i h = _mm256_loadu_si256((__m256i*)sph);
+        __m256i c = _mm256_unpacklo_epi32(l, h); // l0 h0 l1 h1, l4 h4 l5 h5
+        __m256i d = _mm256_unpackhi_epi32(l, h); // l2 h2 l3 h3, l6 h6 l7 h7
+        _mm256_storeu_si256((__m256i*)dp,
+          _mm256_permute2x128_si256(c, d, 0x20));
+        _mm256_storeu_si256((__m256i*)dp + 1,
+          _mm256_permute2x128_si256(c, d, 0x31));
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool aligned>
+    static inline __m256i avx2_load(const si32* p)
+    {
+      return aligned ? _mm256_load_si256((const __m256i*)p)
+                     : _mm256_loadu_si256((const __m256i*)p);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool aligned>
+    static inline void avx2_store(si32* p, __m256i v)
+    {
+      if (aligned)
+        _mm256_store_si256((__m256i*)p, v);
+      else
+        _mm256_storeu_si256((__m256i*)p, v);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Applies one reversible lifting step to count samples of dp, using
+    // sp1[i] + sp2[i]; the step forms are those of gen_rev_vert_step32, and
+    // synthesis undoes what analysis does.  With aligned, the three
+    // pointers are multiples of 32 bytes
+    template <bool aligned>
+    static inline
+    void avx2_rev_lift(const lifting_step* s, si32* dp, const si32* sp1,
+                       const si32* sp2, ui32 count, bool synthesis)
+    {
+      const si32 a = s->rev.Aatk;
+      const si32 b = s->rev.Batk;
+      const ui8 e = s->rev.Eatk;
+      __m256i vb = _mm256_set1_epi32(b);
+      __m128i ve = _mm_cvtsi32_si128(e);
+
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        for (; count >= 8; count -= 8, dp += 8, sp1 += 8, sp2 += 8)
+        {
+          __m256i t = _mm256_add_epi32(avx2_load<aligned>(sp1),
+                                       avx2_load<aligned>(sp2));
+          t = _mm256_sra_epi32(_mm256_add_epi32(vb, t), ve);
+          __m256i d = avx2_load<aligned>(dp);
+          d = synthesis ? _mm256_sub_epi32(d, t) : _mm256_add_epi32(d, t);
+          avx2_store<aligned>(dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b + *sp1++ + *sp2++) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b + *sp1++ + *sp2++) >> e;
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        for (; count >= 8; count -= 8, dp += 8, sp1 += 8, sp2 += 8)
+        {
+          __m256i t = _mm256_add_epi32(avx2_load<aligned>(sp1),
+                                       avx2_load<aligned>(sp2));
+          t = _mm256_srai_epi32(t, 1);
+          __m256i d = avx2_load<aligned>(dp);
+          d = synthesis ? _mm256_add_epi32(d, t) : _mm256_sub_epi32(d, t);
+          avx2_store<aligned>(dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ += (*sp1++ + *sp2++) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ -= (*sp1++ + *sp2++) >> e;
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        for (; count >= 8; count -= 8, dp += 8, sp1 += 8, sp2 += 8)
+        {
+          __m256i t = _mm256_add_epi32(avx2_load<aligned>(sp1),
+                                       avx2_load<aligned>(sp2));
+          t = _mm256_sra_epi32(_mm256_sub_epi32(vb, t), ve);
+          __m256i d = avx2_load<aligned>(dp);
+          d = synthesis ? _mm256_sub_epi32(d, t) : _mm256_add_epi32(d, t);
+          avx2_store<aligned>(dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b - (*sp1++ + *sp2++)) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b - (*sp1++ + *sp2++)) >> e;
+      }
+      else { // general case
+        __m256i va = _mm256_set1_epi32(a);
+        for (; count >= 8; count -= 8, dp += 8, sp1 += 8, sp2 += 8)
+        {
+          __m256i t = _mm256_add_epi32(avx2_load<aligned>(sp1),
+                                       avx2_load<aligned>(sp2));
+          t = _mm256_add_epi32(vb, _mm256_mullo_epi32(va, t));
+          t = _mm256_sra_epi32(t, ve);
+          __m256i d = avx2_load<aligned>(dp);
+          d = synthesis ? _mm256_sub_epi32(d, t) : _mm256_add_epi32(d, t);
+          avx2_store<aligned>(dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b + a * (*sp1++ + *sp2++)) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b + a * (*sp1++ + *sp2++)) >> e;
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    void avx2_rev_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis)
+    {
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_32BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_32BIT) &&
+               (aug == NULL || aug->flags & line_buf::LFT_32BIT));
+        // whole lines, which the codestream allocates on cache lines
+        if (is_aligned<32>(aug->i32) && is_aligned<32>(sig->i32)
+            && is_aligned<32>(other->i32))
+          avx2_rev_lift<true>(s, aug->i32, sig->i32, other->i32, repeat,
+                              synthesis);
+        else
+          avx2_rev_lift<false>(s, aug->i32, sig->i32, other->i32, repeat,
+                               synthesis);
+      }
+      else
+        gen_rev_vert_step(s, sig, other, aug, repeat, synthesis);
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    void avx2_rev_horz_ana(const param_atk* atk, const line_buf* ldst,
+                           const line_buf* hdst, const line_buf* src,
+                           ui32 width, bool even)
+    {
+      if ((src->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rev_horz_ana(atk, ldst, hdst, src, width, even);
+        return;
+      }
+
+      assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
+             (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        avx2_deinterleave(ldst->i32, hdst->i32, src->i32, width, even);
+
+        si32* hp = hdst->i32, * lp = ldst->i32;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          const si32* sp = lp + (even ? 1 : 0);
+          avx2_rev_lift<false>(s, hp, sp - 1, sp, h_width, false);
+
+          // swap buffers
+          si32* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+      }
+      else {
+        if (even)
+          ldst->i32[0] = src->i32[0];
+        else
+          hdst->i32[0] = src->i32[0] << 1;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx2_rev_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even)
+    {
+      if ((dst->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rev_horz_syn(atk, dst, lsrc, hsrc, width, even);
+        return;
+      }
+
+      assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
+             (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
+      if (width > 1)
+      {
+        bool ev = even;
+        si32* oth = hsrc->i32, * aug = lsrc->i32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si32* sp = oth + (ev ? 0 : 1);
+          avx2_rev_lift<false>(s, aug, sp - 1, sp, aug_width, true);
+
+          // swap buffers
+          si32* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        avx2_interleave(dst->i32, lsrc->i32, hsrc->i32, width, even);
+      }
+      else {
+        if (even)
+          dst->i32[0] = lsrc->i32[0];
+        else
+          dst->i32[0] = hsrc->i32[0] >> 1;
+      }
+    }
+
+  } // !local
+} // !ojph
+
+OJPH_TARGET_END
+
+#endif
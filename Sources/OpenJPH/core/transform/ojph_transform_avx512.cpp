@@ -0,0 +1,304 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_transform_avx512.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if defined(OJPH_ARCH_X86_64) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_AVX512)
+
+#include <cassert>
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "../codestream/ojph_params_local.h"
+
+#include "ojph_transform.h"
+#include "ojph_transform_local.h"
+
+OJPH_TARGET_BEGIN("avx512f")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // The vector loops below handle sixteen samples at a time, and the
+    // remaining samples are handled one at a time, so no sample beyond the
+    // width of a line is written.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx512_deinterleave(float* dpl, float* dph, const float* sp,
+                             ui32 width, bool even)
+    {
+      const __m512i idx_l = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16,
+                                             14, 12, 10,  8,  6,  4,  2,  0);
+      const __m512i idx_h = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17,
+                                             15, 13, 11,  9,  7,  5,  3,  1);
+      if (!even)
+      { *dph++ = *sp++; --width; }
+      for (; width >= 32; width -= 32, sp += 32, dpl += 16, dph += 16)
+      {
+        __m512 a = _mm512_loadu_ps(sp);
+        __m512 b = _mm512_loadu_ps(sp + 16);
+        _mm512_storeu_ps(dpl, _mm512_permutex2var_ps(a, idx_l, b));
+        _mm512_storeu_ps(dph, _mm512_permutex2var_ps(a, idx_h, b));
+      }
+      for (; width > 1; width -= 2)
+      { *dpl++ = *sp++; *dph++ = *sp++; }
+      if (width)
+        *dpl = *sp;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void avx512_interleave(float* dp, const float* spl, const float* sph,
+                           ui32 width, bool even)
+    {
+      const __m512i idx_lo = _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4,
+                                              19, 3, 18, 2, 17, 1, 16, 0);
+      const __m512i idx_hi = _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12,
+                                              27, 11, 26, 10, 25,  9, 24,  8);
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 32; width -= 32, dp += 32, spl += 16, sph += 16)
+      {
+        __m512 l = _mm512_loadu_ps(spl);
+        __m512 h = _mm512_loadu_ps(sph);
+        _mm512_storeu_ps(dp, _mm512_permutex2var_ps(l, idx_lo, h));
+        _mm512_storeu_ps(dp + 16, _mm512_permutex2var_ps(l, idx_hi, h));
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool aligned>
+    static inline __m512 avx512_load(const float* p)
+    { return aligned ? _mm512_load_ps(p) : _mm512_loadu_ps(p); }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool aligned>
+    static inline void avx512_store(float* p, __m512 v)
+    {
+      if (aligned)
+        _mm512_store_ps(p, v);
+      else
+        _mm512_storeu_ps(p, v);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // dp[i] += a * (sp1[i] + sp2[i]); with aligned, the three pointers are
+    // multiples of 64 bytes
+    template <bool aligned>
+    static inline
+    void avx512_lift(float* dp, const float* sp1, const float* sp2,
+                     float a, ui32 count)
+    {
+      __m512 va = _mm512_set1_ps(a);
+      for (; count >= 16; count -= 16, dp += 16, sp1 += 16, sp2 += 16)
+      {
+        __m512 t = _mm512_add_ps(avx512_load<aligned>(sp1), avx512_load<aligned>(sp2));
+        t = _mm512_mul_ps(va, t);
+        avx512_store<aligned>(dp, _mm512_add_ps(avx512_load<aligned>(dp), t));
+      }
+      for (; count > 0; --count)
+        *dp++ += a * (*sp1++ + *sp2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // same as avx512_lift, but subtracts
+    static inline
+    void avx512_lift_sub(float* dp, const float* sp1, const float* sp2,
+                         float a, ui32 count)
+    {
+      __m512 va = _mm512_set1_ps(a);
+      for (; count >= 16; count -= 16, dp += 16, sp1 += 16, sp2 += 16)
+      {
+        __m512 t = _mm512_add_ps(_mm512_loadu_ps(sp1), _mm512_loadu_ps(sp2));
+        t = _mm512_mul_ps(va, t);
+        _mm512_storeu_ps(dp, _mm512_sub_ps(_mm512_loadu_ps(dp), t));
+      }
+      for (; count > 0; --count)
+        *dp++ -= a * (*sp1++ + *sp2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    template <bool aligned>
+    static inline void avx512_multiply(float* dp, float K, ui32 count)
+    {
+      __m512 vK = _mm512_set1_ps(K);
+      for (; count >= 16; count -= 16, dp += 16)
+        avx512_store<aligned>(dp, _mm512_mul_ps(avx512_load<aligned>(dp), vK));
+      for (; count > 0; --count)
+        *dp++ *= K;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx512_irv_vert_step(const lifting_step* s, const line_buf* sig,
+                              const line_buf* other, const line_buf* aug,
+                              ui32 repeat, bool synthesis)
+    {
+      float a = s->irv.Aatk;
+
+      if (synthesis)
+        a = -a;
+
+      // whole lines, which the codestream allocates on cache lines
+      if (is_aligned<64>(aug->f32) && is_aligned<64>(sig->f32)
+          && is_aligned<64>(other->f32))
+        avx512_lift<true>(aug->f32, sig->f32, other->f32, a, repeat);
+      else
+        avx512_lift<false>(aug->f32, sig->f32, other->f32, a, repeat);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx512_irv_vert_times_K(float K, const line_buf* aug, ui32 repeat)
+    {
+      if (is_aligned<64>(aug->f32))
+        avx512_multiply<true>(aug->f32, K, repeat);
+      else
+        avx512_multiply<false>(aug->f32, K, repeat);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx512_irv_horz_ana(const param_atk* atk, const line_buf* ldst,
+                             const line_buf* hdst, const line_buf* src,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        avx512_deinterleave(ldst->f32, hdst->f32, src->f32, width, even);
+
+        float* hp = hdst->f32, * lp = ldst->f32;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+          const float a = s->irv.Aatk;
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          const float* sp = lp + (even ? 1 : 0);
+          avx512_lift<false>(hp, sp - 1, sp, a, h_width);
+
+          // swap buffers
+          float* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+
+        {
+          float K = atk->get_K();
+          float K_inv = 1.0f / K;
+          avx512_multiply<false>(lp, K_inv, l_width);
+          avx512_multiply<false>(hp, K, h_width);
+        }
+      }
+      else {
+        if (even)
+          ldst->f32[0] = src->f32[0];
+        else
+          hdst->f32[0] = src->f32[0] * 2.0f;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void avx512_irv_horz_syn(const param_atk* atk, const line_buf* dst,
+                             const line_buf* lsrc, const line_buf* hsrc,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        float* oth = hsrc->f32, * aug = lsrc->f32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+
+        {
+          float K = atk->get_K();
+          float K_inv = 1.0f / K;
+          avx512_multiply<false>(aug, K, aug_width);
+          avx512_multiply<false>(oth, K_inv, oth_width);
+        }
+
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const float a = s->irv.Aatk;
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const float* sp = oth + (ev ? 0 : 1);
+          avx512_lift_sub(aug, sp - 1, sp, a, aug_width);
+
+          // swap buffers
+          float* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        avx512_interleave(dst->f32, lsrc->f32, hsrc->f32, width, even);
+      }
+      else {
+        if (even)
+          dst->f32[0] = lsrc->f32[0];
+        else
+          dst->f32[0] = hsrc->f32[0] * 0.5f;
+      }
+    }
+
+  } // !local
+} // !ojph
+
+OJPH_TARGET_END
+
+#endif
@@ -39,7 +39,10 @@
 #ifndef OJPH_TRANSFORM_LOCAL_H
 #define OJPH_TRANSFORM_LOCAL_H
 
+#include <cmath>
+
 #include "ojph_defs.h"
+#include "ojph_transform.h"
 
 namespace ojph {
 
@@ -80,6 +83,32 @@ namespace ojph {
                           const line_buf *lsrc, const line_buf *hsrc, 
                           ui32 width, bool even);
 
+    //////////////////////////////////////////////////////////////////////////
+    // Fixed-point irreversible functions
+    //////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////
+    // a lifting coefficient, or K, in steps of 2^-fix_frac_bits
+    inline si32 fix_coefficient(float a)
+    { return (si32)lrintf(a * (float)(1 << fix_frac_bits)); }
+
+    /////////////////////////////////////////////////////////////////////////
+    void gen_fix_vert_step(const lifting_step* s, const line_buf* sig,
+                           const line_buf* other, const line_buf* aug,
+                           ui32 repeat, bool synthesis);
+
+    /////////////////////////////////////////////////////////////////////////
+    void gen_fix_vert_times_K(float K, const line_buf* aug, ui32 repeat);
+
+    /////////////////////////////////////////////////////////////////////////
+    void gen_fix_horz_syn(const param_atk *atk, const line_buf* dst,
+                          const line_buf *lsrc, const line_buf *hsrc,
+                          ui32 width, bool even);
+
+    /////////////////////////////////////////////////////////////////////////
+    void gen_fix_to_float(const line_buf* src, const line_buf* dst,
+                          ui32 width);
+
     //////////////////////////////////////////////////////////////////////////
     // Reversible functions
     //////////////////////////////////////////////////////////////////////////
@@ -264,6 +293,66 @@ namespace ojph {
                              const line_buf* lsrc, const line_buf* hsrc, 
                              ui32 width, bool even);
 
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //                          NEON Functions
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    // Irreversible functions
+    //////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_irv_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_irv_vert_times_K(float K, const line_buf* aug, ui32 repeat);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_irv_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even);
+
+    //////////////////////////////////////////////////////////////////////////
+    // Fixed-point irreversible functions
+    //////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_fix_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_fix_vert_times_K(float K, const line_buf* aug, ui32 repeat);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_fix_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_fix_to_float(const line_buf* src, const line_buf* dst,
+                           ui32 width);
+
+    //////////////////////////////////////////////////////////////////////////
+    // Reversible functions
+    //////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_rev_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis);
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_rev_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even);
+
     //////////////////////////////////////////////////////////////////////////
     //
     //
@@ -0,0 +1,546 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman 
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_transform_neon.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#ifdef OJPH_ENABLE_NEON
+
+#include <cassert>
+#include <arm_neon.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "../codestream/ojph_params_local.h"
+
+#include "ojph_transform.h"
+#include "ojph_transform_local.h"
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // Lifting steps compute each sample of `dp` from `sp[-1] + sp[0]`; the
+    // vector loops below handle four samples at a time, and the remaining
+    // samples are handled one at a time, so no sample beyond the width of
+    // a line is written.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void neon_interleave32(si32* dp, const si32* spl, const si32* sph,
+                           ui32 width, bool even)
+    {
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 8; width -= 8, dp += 8, spl += 4, sph += 4)
+      {
+        int32x4x2_t v;
+        v.val[0] = vld1q_s32(spl);
+        v.val[1] = vld1q_s32(sph);
+        vst2q_s32(dp, v);
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void neon_interleave32(float* dp, const float* spl, const float* sph,
+                           ui32 width, bool even)
+    {
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 8; width -= 8, dp += 8, spl += 4, sph += 4)
+      {
+        float32x4x2_t v;
+        v.val[0] = vld1q_f32(spl);
+        v.val[1] = vld1q_f32(sph);
+        vst2q_f32(dp, v);
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // dst[i] += sign * ((b + a * (src1[i] + src2[i])) >> e), with the Part 1
+    // forms of the steps identified, as in gen_rev_vert_step
+    static
+    void neon_rev_vert_step32(const lifting_step* s, const line_buf* sig,
+                              const line_buf* other, const line_buf* aug,
+                              ui32 repeat, bool synthesis)
+    {
+      const si32 a = s->rev.Aatk;
+      const si32 b = s->rev.Batk;
+      const ui8 e = s->rev.Eatk;
+      const int32x4_t va = vdupq_n_s32(a);
+      const int32x4_t vb = vdupq_n_s32(b);
+      const int32x4_t ve = vdupq_n_s32(-(si32)e); // negative: right shift
+
+      si32* dst = aug->i32;
+      const si32* src1 = sig->i32, * src2 = other->i32;
+      ui32 i = repeat;
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+        {
+          int32x4_t t = vaddq_s32(vld1q_s32(src1), vld1q_s32(src2));
+          t = vshlq_s32(vaddq_s32(vb, t), ve);
+          int32x4_t d = vld1q_s32(dst);
+          vst1q_s32(dst, synthesis ? vsubq_s32(d, t) : vaddq_s32(d, t));
+        }
+        if (synthesis)
+          for (; i > 0; --i)
+            *dst++ -= (b + *src1++ + *src2++) >> e;
+        else
+          for (; i > 0; --i)
+            *dst++ += (b + *src1++ + *src2++) >> e;
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+        {
+          int32x4_t t = vaddq_s32(vld1q_s32(src1), vld1q_s32(src2));
+          t = vshrq_n_s32(t, 1);
+          int32x4_t d = vld1q_s32(dst);
+          vst1q_s32(dst, synthesis ? vaddq_s32(d, t) : vsubq_s32(d, t));
+        }
+        if (synthesis)
+          for (; i > 0; --i)
+            *dst++ += (*src1++ + *src2++) >> e;
+        else
+          for (; i > 0; --i)
+            *dst++ -= (*src1++ + *src2++) >> e;
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+        {
+          int32x4_t t = vaddq_s32(vld1q_s32(src1), vld1q_s32(src2));
+          t = vshlq_s32(vsubq_s32(vb, t), ve);
+          int32x4_t d = vld1q_s32(dst);
+          vst1q_s32(dst, synthesis ? vsubq_s32(d, t) : vaddq_s32(d, t));
+        }
+        if (synthesis)
+          for (; i > 0; --i)
+            *dst++ -= (b - (*src1++ + *src2++)) >> e;
+        else
+          for (; i > 0; --i)
+            *dst++ += (b - (*src1++ + *src2++)) >> e;
+      }
+      else { // general case
+        for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+        {
+          int32x4_t t = vaddq_s32(vld1q_s32(src1), vld1q_s32(src2));
+          t = vshlq_s32(vmlaq_s32(vb, va, t), ve);
+          int32x4_t d = vld1q_s32(dst);
+          vst1q_s32(dst, synthesis ? vsubq_s32(d, t) : vaddq_s32(d, t));
+        }
+        if (synthesis)
+          for (; i > 0; --i)
+            *dst++ -= (b + a * (*src1++ + *src2++)) >> e;
+        else
+          for (; i > 0; --i)
+            *dst++ += (b + a * (*src1++ + *src2++)) >> e;
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    void neon_rev_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis)
+    {
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_32BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_32BIT) &&
+               (aug == NULL || aug->flags & line_buf::LFT_32BIT));
+        neon_rev_vert_step32(s, sig, other, aug, repeat, synthesis);
+      }
+      else // 64-bit lines are rare; they stay with the generic code
+        gen_rev_vert_step(s, sig, other, aug, repeat, synthesis);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static
+    void neon_rev_horz_syn32(const param_atk* atk, const line_buf* dst,
+                             const line_buf* lsrc, const line_buf* hsrc,
+                             ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si32* oth = hsrc->i32, * aug = lsrc->i32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const si32 a = s->rev.Aatk;
+          const si32 b = s->rev.Batk;
+          const ui8 e = s->rev.Eatk;
+          const int32x4_t va = vdupq_n_s32(a);
+          const int32x4_t vb = vdupq_n_s32(b);
+          const int32x4_t ve = vdupq_n_s32(-(si32)e);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si32* sp = oth + (ev ? 0 : 1);
+          si32* dp = aug;
+          ui32 i = aug_width;
+          if (a == 1)
+          { // 5/3 update and any case with a == 1
+            for (; i >= 4; i -= 4, sp += 4, dp += 4)
+            {
+              int32x4_t t = vaddq_s32(vld1q_s32(sp - 1), vld1q_s32(sp));
+              t = vshlq_s32(vaddq_s32(vb, t), ve);
+              vst1q_s32(dp, vsubq_s32(vld1q_s32(dp), t));
+            }
+            for (; i > 0; --i, sp++, dp++)
+              *dp -= (b + (sp[-1] + sp[0])) >> e;
+          }
+          else if (a == -1 && b == 1 && e == 1)
+          {  // 5/3 predict
+            for (; i >= 4; i -= 4, sp += 4, dp += 4)
+            {
+              int32x4_t t = vaddq_s32(vld1q_s32(sp - 1), vld1q_s32(sp));
+              t = vshrq_n_s32(t, 1);
+              vst1q_s32(dp, vaddq_s32(vld1q_s32(dp), t));
+            }
+            for (; i > 0; --i, sp++, dp++)
+              *dp += (sp[-1] + sp[0]) >> e;
+          }
+          else if (a == -1)
+          { // any case with a == -1, which is not 5/3 predict
+            for (; i >= 4; i -= 4, sp += 4, dp += 4)
+            {
+              int32x4_t t = vaddq_s32(vld1q_s32(sp - 1), vld1q_s32(sp));
+              t = vshlq_s32(vsubq_s32(vb, t), ve);
+              vst1q_s32(dp, vsubq_s32(vld1q_s32(dp), t));
+            }
+            for (; i > 0; --i, sp++, dp++)
+              *dp -= (b - (sp[-1] + sp[0])) >> e;
+          }
+          else {
+            // general case
+            for (; i >= 4; i -= 4, sp += 4, dp += 4)
+            {
+              int32x4_t t = vaddq_s32(vld1q_s32(sp - 1), vld1q_s32(sp));
+              t = vshlq_s32(vmlaq_s32(vb, va, t), ve);
+              vst1q_s32(dp, vsubq_s32(vld1q_s32(dp), t));
+            }
+            for (; i > 0; --i, sp++, dp++)
+              *dp -= (b + a * (sp[-1] + sp[0])) >> e;
+          }
+
+          // swap buffers
+          si32* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        neon_interleave32(dst->i32, lsrc->i32, hsrc->i32, width, even);
+      }
+      else {
+        if (even)
+          dst->i32[0] = lsrc->i32[0];
+        else
+          dst->i32[0] = hsrc->i32[0] >> 1;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_rev_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even)
+    {
+      if (dst->flags & line_buf::LFT_32BIT)
+      {
+        assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
+               (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
+        neon_rev_horz_syn32(atk, dst, lsrc, hsrc, width, even);
+      }
+      else // 64-bit lines are rare; they stay with the generic code
+        gen_rev_horz_syn(atk, dst, lsrc, hsrc, width, even);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_irv_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis)
+    {
+      float a = s->irv.Aatk;
+
+      if (synthesis)
+        a = -a;
+
+      const float32x4_t va = vdupq_n_f32(a);
+      float* dst = aug->f32;
+      const float* src1 = sig->f32, * src2 = other->f32;
+      ui32 i = repeat;
+      for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+      {
+        float32x4_t t = vaddq_f32(vld1q_f32(src1), vld1q_f32(src2));
+        vst1q_f32(dst, vaddq_f32(vld1q_f32(dst), vmulq_f32(va, t)));
+      }
+      for (; i > 0; --i)
+        *dst++ += a * (*src1++ + *src2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_irv_vert_times_K(float K, const line_buf* aug, ui32 repeat)
+    {
+      const float32x4_t vK = vdupq_n_f32(K);
+      float* dst = aug->f32;
+      ui32 i = repeat;
+      for (; i >= 4; i -= 4, dst += 4)
+        vst1q_f32(dst, vmulq_f32(vld1q_f32(dst), vK));
+      for (; i > 0; --i)
+        *dst++ *= K;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void neon_multiply(float* dp, float K, ui32 width)
+    {
+      const float32x4_t vK = vdupq_n_f32(K);
+      for (; width >= 4; width -= 4, dp += 4)
+        vst1q_f32(dp, vmulq_f32(vld1q_f32(dp), vK));
+      for (; width > 0; --width)
+        *dp++ *= K;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_irv_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        float* oth = hsrc->f32, * aug = lsrc->f32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+
+        {
+          float K = atk->get_K();
+          float K_inv = 1.0f / K;
+          neon_multiply(aug, K, aug_width);
+          neon_multiply(oth, K_inv, oth_width);
+        }
+
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const float a = s->irv.Aatk;
+          const float32x4_t va = vdupq_n_f32(a);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const float* sp = oth + (ev ? 0 : 1);
+          float* dp = aug;
+          ui32 i = aug_width;
+          for (; i >= 4; i -= 4, sp += 4, dp += 4)
+          {
+            float32x4_t t = vaddq_f32(vld1q_f32(sp - 1), vld1q_f32(sp));
+            vst1q_f32(dp, vsubq_f32(vld1q_f32(dp), vmulq_f32(va, t)));
+          }
+          for (; i > 0; --i, sp++, dp++)
+            *dp -= a * (sp[-1] + sp[0]);
+
+          // swap buffers
+          float* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        neon_interleave32(dst->f32, lsrc->f32, hsrc->f32, width, even);
+      }
+      else {
+        if (even)
+          dst->f32[0] = lsrc->f32[0];
+        else
+          dst->f32[0] = hsrc->f32[0] * 0.5f;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // fa * v for four samples of a fixed-point line, rounded to the nearest
+    // step as gen_fix_vert_step rounds them
+    static inline int32x4_t neon_fix_multiply(int32x2_t fa, int32x4_t v)
+    {
+      int64x2_t lo = vmull_s32(vget_low_s32(v), fa);
+      int64x2_t hi = vmull_s32(vget_high_s32(v), fa);
+      return vcombine_s32(vrshrn_n_s64(lo, fix_frac_bits),
+                          vrshrn_n_s64(hi, fix_frac_bits));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline si32 neon_fix_multiply(si32 fa, si32 x)
+    {
+      const si64 half = (si64)1 << (fix_frac_bits - 1);
+      return (si32)(((si64)fa * x + half) >> fix_frac_bits);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_fix_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis)
+    {
+      float a = s->irv.Aatk;
+
+      if (synthesis)
+        a = -a;
+
+      const si32 fa = fix_coefficient(a);
+      const int32x2_t va = vdup_n_s32(fa);
+      si32* dst = aug->i32;
+      const si32* src1 = sig->i32, * src2 = other->i32;
+      ui32 i = repeat;
+      for (; i >= 4; i -= 4, dst += 4, src1 += 4, src2 += 4)
+      {
+        int32x4_t t = vaddq_s32(vld1q_s32(src1), vld1q_s32(src2));
+        vst1q_s32(dst, vaddq_s32(vld1q_s32(dst), neon_fix_multiply(va, t)));
+      }
+      for (; i > 0; --i)
+        *dst++ += neon_fix_multiply(fa, *src1++ + *src2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void neon_fix_multiply_line(si32* dp, si32 fK, ui32 width)
+    {
+      const int32x2_t vK = vdup_n_s32(fK);
+      for (; width >= 4; width -= 4, dp += 4)
+        vst1q_s32(dp, neon_fix_multiply(vK, vld1q_s32(dp)));
+      for (; width > 0; --width, ++dp)
+        *dp = neon_fix_multiply(fK, *dp);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_fix_vert_times_K(float K, const line_buf* aug, ui32 repeat)
+    {
+      neon_fix_multiply_line(aug->i32, fix_coefficient(K), repeat);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_fix_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        si32* oth = hsrc->i32, * aug = lsrc->i32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+
+        {
+          float K = atk->get_K();
+          neon_fix_multiply_line(aug, fix_coefficient(K), aug_width);
+          neon_fix_multiply_line(oth, fix_coefficient(1.0f / K), oth_width);
+        }
+
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const si32 fa = fix_coefficient(s->irv.Aatk);
+          const int32x2_t va = vdup_n_s32(fa);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si32* sp = oth + (ev ? 0 : 1);
+          si32* dp = aug;
+          ui32 i = aug_width;
+          for (; i >= 4; i -= 4, sp += 4, dp += 4)
+          {
+            int32x4_t t = vaddq_s32(vld1q_s32(sp - 1), vld1q_s32(sp));
+            vst1q_s32(dp, vsubq_s32(vld1q_s32(dp), neon_fix_multiply(va, t)));
+          }
+          for (; i > 0; --i, sp++, dp++)
+            *dp -= neon_fix_multiply(fa, sp[-1] + sp[0]);
+
+          // swap buffers
+          si32* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        neon_interleave32(dst->i32, lsrc->i32, hsrc->i32, width, even);
+      }
+      else {
+        if (even)
+          dst->i32[0] = lsrc->i32[0];
+        else
+          dst->i32[0] = hsrc->i32[0] >> 1;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void neon_fix_to_float(const line_buf* src, const line_buf* dst,
+                           ui32 width)
+    {
+      const float scale = 1.0f / (float)(1 << fix_frac_bits);
+      const si32* sp = src->i32;
+      float* dp = dst->f32;
+      for (; width >= 4; width -= 4, sp += 4, dp += 4)
+        vst1q_f32(dp, vcvtq_n_f32_s32(vld1q_s32(sp), fix_frac_bits));
+      for (; width > 0; --width)
+        *dp++ = (float)*sp++ * scale;
+    }
+
+  } // !local
+} // !ojph
+
+#endif // OJPH_ENABLE_NEON
@@ -0,0 +1,268 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_transform_sse.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_SSE)
+
+#include <cassert>
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "../codestream/ojph_params_local.h"
+
+#include "ojph_transform.h"
+#include "ojph_transform_local.h"
+
+OJPH_TARGET_BEGIN("sse")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // The vector loops below handle four samples at a time, and the
+    // remaining samples are handled one at a time, so no sample beyond the
+    // width of a line is written.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse_deinterleave(float* dpl, float* dph, const float* sp,
+                          ui32 width, bool even)
+    {
+      if (!even)
+      { *dph++ = *sp++; --width; }
+      for (; width >= 8; width -= 8, sp += 8, dpl += 4, dph += 4)
+      {
+        __m128 a = _mm_loadu_ps(sp);
+        __m128 b = _mm_loadu_ps(sp + 4);
+        _mm_storeu_ps(dpl, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(dph, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+      for (; width > 1; width -= 2)
+      { *dpl++ = *sp++; *dph++ = *sp++; }
+      if (width)
+        *dpl = *sp;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse_interleave(float* dp, const float* spl, const float* sph,
+                        ui32 width, bool even)
+    {
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 8; width -= 8, dp += 8, spl += 4, sph += 4)
+      {
+        __m128 l = _mm_loadu_ps(spl);
+        __m128 h = _mm_loadu_ps(sph);
+        _mm_storeu_ps(dp, _mm_unpacklo_ps(l, h));
+        _mm_storeu_ps(dp + 4, _mm_unpackhi_ps(l, h));
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // dp[i] += a * (sp1[i] + sp2[i])
+    static inline
+    void sse_lift(float* dp, const float* sp1, const float* sp2, float a,
+                  ui32 count)
+    {
+      __m128 va = _mm_set1_ps(a);
+      for (; count >= 4; count -= 4, dp += 4, sp1 += 4, sp2 += 4)
+      {
+        __m128 t = _mm_add_ps(_mm_loadu_ps(sp1), _mm_loadu_ps(sp2));
+        _mm_storeu_ps(dp, _mm_add_ps(_mm_loadu_ps(dp), _mm_mul_ps(va, t)));
+      }
+      for (; count > 0; --count)
+        *dp++ += a * (*sp1++ + *sp2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // same as sse_lift, but subtracts
+    static inline
+    void sse_lift_sub(float* dp, const float* sp1, const float* sp2,
+                      float a, ui32 count)
+    {
+      __m128 va = _mm_set1_ps(a);
+      for (; count >= 4; count -= 4, dp += 4, sp1 += 4, sp2 += 4)
+      {
+        __m128 t = _mm_add_ps(_mm_loadu_ps(sp1), _mm_loadu_ps(sp2));
+        _mm_storeu_ps(dp, _mm_sub_ps(_mm_loadu_ps(dp), _mm_mul_ps(va, t)));
+      }
+      for (; count > 0; --count)
+        *dp++ -= a * (*sp1++ + *sp2++);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void sse_multiply(float* dp, float K, ui32 count)
+    {
+      __m128 vK = _mm_set1_ps(K);
+      for (; count >= 4; count -= 4, dp += 4)
+        _mm_storeu_ps(dp, _mm_mul_ps(_mm_loadu_ps(dp), vK));
+      for (; count > 0; --count)
+        *dp++ *= K;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse_irv_vert_step(const lifting_step* s, const line_buf* sig,
+                           const line_buf* other, const line_buf* aug,
+                           ui32 repeat, bool synthesis)
+    {
+      float a = s->irv.Aatk;
+
+      if (synthesis)
+        a = -a;
+
+      sse_lift(aug->f32, sig->f32, other->f32, a, repeat);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse_irv_vert_times_K(float K, const line_buf* aug, ui32 repeat)
+    {
+      sse_multiply(aug->f32, K, repeat);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse_irv_horz_ana(const param_atk* atk, const line_buf* ldst,
+                          const line_buf* hdst, const line_buf* src,
+                          ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        sse_deinterleave(ldst->f32, hdst->f32, src->f32, width, even);
+
+        float* hp = hdst->f32, * lp = ldst->f32;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+          const float a = s->irv.Aatk;
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          const float* sp = lp + (even ? 1 : 0);
+          sse_lift(hp, sp - 1, sp, a, h_width);
+
+          // swap buffers
+          float* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+
+        {
+          float K = atk->get_K();
+          float K_inv = 1.0f / K;
+          sse_multiply(lp, K_inv, l_width);
+          sse_multiply(hp, K, h_width);
+        }
+      }
+      else {
+        if (even)
+          ldst->f32[0] = src->f32[0];
+        else
+          hdst->f32[0] = src->f32[0] * 2.0f;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse_irv_horz_syn(const param_atk* atk, const line_buf* dst,
+                          const line_buf* lsrc, const line_buf* hsrc,
+                          ui32 width, bool even)
+    {
+      if (width > 1)
+      {
+        bool ev = even;
+        float* oth = hsrc->f32, * aug = lsrc->f32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+
+        {
+          float K = atk->get_K();
+          float K_inv = 1.0f / K;
+          sse_multiply(aug, K, aug_width);
+          sse_multiply(oth, K_inv, oth_width);
+        }
+
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+          const float a = s->irv.Aatk;
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const float* sp = oth + (ev ? 0 : 1);
+          sse_lift_sub(aug, sp - 1, sp, a, aug_width);
+
+          // swap buffers
+          float* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        sse_interleave(dst->f32, lsrc->f32, hsrc->f32, width, even);
+      }
+      else {
+        if (even)
+          dst->f32[0] = lsrc->f32[0];
+        else
+          dst->f32[0] = hsrc->f32[0] * 0.5f;
+      }
+    }
+
+  } // !local
+} // !ojph
+
+OJPH_TARGET_END
+
+#endif
@@ -0,0 +1,305 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2022, Aous Naman 
+// Copyright (c) 2022, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2022, The University of New South Wales, Australia
+// Copyright (c) 2026, The DcmSwift contributors (vector code)
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_transform_sse2.cpp
+// Author: Aous Naman
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "ojph_arch.h"
+
+#if (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)) \
+  && !defined(OJPH_DISABLE_SIMD) && !defined(OJPH_DISABLE_SSE2)
+
+#include <cassert>
+#include <immintrin.h>
+
+#include "ojph_defs.h"
+#include "ojph_mem.h"
+#include "ojph_params.h"
+#include "../codestream/ojph_params_local.h"
+
+#include "ojph_transform.h"
+#include "ojph_transform_local.h"
+
+OJPH_TARGET_BEGIN("sse2")
+
+namespace ojph {
+  namespace local {
+
+    //////////////////////////////////////////////////////////////////////////
+    // The vector loops below handle four samples at a time, and the
+    // remaining samples are handled one at a time, so no sample beyond the
+    // width of a line is written.  Only 32-bit lines are vectorized; 64-bit
+    // lines are rare, and stay with the generic code.
+    //////////////////////////////////////////////////////////////////////////
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse2_deinterleave(si32* dpl, si32* dph, const si32* sp,
+                           ui32 width, bool even)
+    {
+      if (!even)
+      { *dph++ = *sp++; --width; }
+      for (; width >= 8; width -= 8, sp += 8, dpl += 4, dph += 4)
+      {
+        __m128 a = _mm_loadu_ps((const float*)sp);
+        __m128 b = _mm_loadu_ps((const float*)sp + 4);
+        _mm_storeu_ps((float*)dpl,
+          _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps((float*)dph,
+          _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+      }
+      for (; width > 1; width -= 2)
+      { *dpl++ = *sp++; *dph++ = *sp++; }
+      if (width)
+        *dpl = *sp;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline
+    void sse2_interleave(si32* dp, const si32* spl, const si32* sph,
+                         ui32 width, bool even)
+    {
+      if (!even)
+      { *dp++ = *sph++; --width; }
+      for (; width >= 8; width -= 8, dp += 8, spl += 4, sph += 4)
+      {
+        __m128i l = _mm_loadu_si128((__m128i*)spl);
+        __m128i h = _mm_loadu_si128((__m128i*)sph);
+        _mm_storeu_si128((__m128i*)dp, _mm_unpacklo_epi32(l, h));
+        _mm_storeu_si128((__m128i*)dp + 1, _mm_unpackhi_epi32(l, h));
+      }
+      for (; width > 1; width -= 2)
+      { *dp++ = *spl++; *dp++ = *sph++; }
+      if (width)
+        *dp = *spl;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // Applies one reversible lifting step to count samples of dp, using
+    // sp1[i] + sp2[i]; the step forms are those of gen_rev_vert_step32, and
+    // synthesis undoes what analysis does
+    static inline
+    void sse2_rev_lift(const lifting_step* s, si32* dp, const si32* sp1,
+                       const si32* sp2, ui32 count, bool synthesis)
+    {
+      const si32 a = s->rev.Aatk;
+      const si32 b = s->rev.Batk;
+      const ui8 e = s->rev.Eatk;
+      __m128i vb = _mm_set1_epi32(b);
+      __m128i ve = _mm_cvtsi32_si128(e);
+
+      if (a == 1)
+      { // 5/3 update and any case with a == 1
+        for (; count >= 4; count -= 4, dp += 4, sp1 += 4, sp2 += 4)
+        {
+          __m128i t = _mm_add_epi32(_mm_loadu_si128((__m128i*)sp1),
+                                    _mm_loadu_si128((__m128i*)sp2));
+          t = _mm_sra_epi32(_mm_add_epi32(vb, t), ve);
+          __m128i d = _mm_loadu_si128((__m128i*)dp);
+          d = synthesis ? _mm_sub_epi32(d, t) : _mm_add_epi32(d, t);
+          _mm_storeu_si128((__m128i*)dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b + *sp1++ + *sp2++) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b + *sp1++ + *sp2++) >> e;
+      }
+      else if (a == -1 && b == 1 && e == 1)
+      { // 5/3 predict
+        for (; count >= 4; count -= 4, dp += 4, sp1 += 4, sp2 += 4)
+        {
+          __m128i t = _mm_add_epi32(_mm_loadu_si128((__m128i*)sp1),
+                                    _mm_loadu_si128((__m128i*)sp2));
+          t = _mm_srai_epi32(t, 1);
+          __m128i d = _mm_loadu_si128((__m128i*)dp);
+          d = synthesis ? _mm_add_epi32(d, t) : _mm_sub_epi32(d, t);
+          _mm_storeu_si128((__m128i*)dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ += (*sp1++ + *sp2++) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ -= (*sp1++ + *sp2++) >> e;
+      }
+      else if (a == -1)
+      { // any case with a == -1, which is not 5/3 predict
+        for (; count >= 4; count -= 4, dp += 4, sp1 += 4, sp2 += 4)
+        {
+          __m128i t = _mm_add_epi32(_mm_loadu_si128((__m128i*)sp1),
+                                    _mm_loadu_si128((__m128i*)sp2));
+          t = _mm_sra_epi32(_mm_sub_epi32(vb, t), ve);
+          __m128i d = _mm_loadu_si128((__m128i*)dp);
+          d = synthesis ? _mm_sub_epi32(d, t) : _mm_add_epi32(d, t);
+          _mm_storeu_si128((__m128i*)dp, d);
+        }
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b - (*sp1++ + *sp2++)) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b - (*sp1++ + *sp2++)) >> e;
+      }
+      else { // general case; SSE2 has no 32-bit multiply, so no vectors
+        if (synthesis)
+          for (; count > 0; --count)
+            *dp++ -= (b + a * (*sp1++ + *sp2++)) >> e;
+        else
+          for (; count > 0; --count)
+            *dp++ += (b + a * (*sp1++ + *sp2++)) >> e;
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    void sse2_rev_vert_step(const lifting_step* s, const line_buf* sig,
+                            const line_buf* other, const line_buf* aug,
+                            ui32 repeat, bool synthesis)
+    {
+      if (((sig != NULL) && (sig->flags & line_buf::LFT_32BIT)) ||
+          ((aug != NULL) && (aug->flags & line_buf::LFT_32BIT)) ||
+          ((other != NULL) && (other->flags & line_buf::LFT_32BIT)))
+      {
+        assert((sig == NULL || sig->flags & line_buf::LFT_32BIT) &&
+               (other == NULL || other->flags & line_buf::LFT_32BIT) &&
+               (aug == NULL || aug->flags & line_buf::LFT_32BIT));
+        sse2_rev_lift(s, aug->i32, sig->i32, other->i32, repeat, synthesis);
+      }
+      else
+        gen_rev_vert_step(s, sig, other, aug, repeat, synthesis);
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    void sse2_rev_horz_ana(const param_atk* atk, const line_buf* ldst,
+                           const line_buf* hdst, const line_buf* src,
+                           ui32 width, bool even)
+    {
+      if ((src->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rev_horz_ana(atk, ldst, hdst, src, width, even);
+        return;
+      }
+
+      assert((ldst == NULL || ldst->flags & line_buf::LFT_32BIT) &&
+             (hdst == NULL || hdst->flags & line_buf::LFT_32BIT));
+      if (width > 1)
+      {
+        // split src into ldst and hdst
+        sse2_deinterleave(ldst->i32, hdst->i32, src->i32, width, even);
+
+        si32* hp = hdst->i32, * lp = ldst->i32;
+        ui32 l_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 h_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = num_steps; j > 0; --j)
+        {
+          const lifting_step* s = atk->get_step(j - 1);
+
+          // extension
+          lp[-1] = lp[0];
+          lp[l_width] = lp[l_width - 1];
+          // lifting step
+          const si32* sp = lp + (even ? 1 : 0);
+          sse2_rev_lift(s, hp, sp - 1, sp, h_width, false);
+
+          // swap buffers
+          si32* t = lp; lp = hp; hp = t;
+          even = !even;
+          ui32 w = l_width; l_width = h_width; h_width = w;
+        }
+      }
+      else {
+        if (even)
+          ldst->i32[0] = src->i32[0];
+        else
+          hdst->i32[0] = src->i32[0] << 1;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    void sse2_rev_horz_syn(const param_atk* atk, const line_buf* dst,
+                           const line_buf* lsrc, const line_buf* hsrc,
+                           ui32 width, bool even)
+    {
+      if ((dst->flags & line_buf::LFT_32BIT) == 0)
+      {
+        gen_rev_horz_syn(atk, dst, lsrc, hsrc, width, even);
+        return;
+      }
+
+      assert((lsrc == NULL || lsrc->flags & line_buf::LFT_32BIT) &&
+             (hsrc == NULL || hsrc->flags & line_buf::LFT_32BIT));
+      if (width > 1)
+      {
+        bool ev = even;
+        si32* oth = hsrc->i32, * aug = lsrc->i32;
+        ui32 aug_width = (width + (even ? 1 : 0)) >> 1;  // low pass
+        ui32 oth_width = (width + (even ? 0 : 1)) >> 1;  // high pass
+        ui32 num_steps = atk->get_num_steps();
+        for (ui32 j = 0; j < num_steps; ++j)
+        {
+          const lifting_step* s = atk->get_step(j);
+
+          // extension
+          oth[-1] = oth[0];
+          oth[oth_width] = oth[oth_width - 1];
+          // lifting step
+          const si32* sp = oth + (ev ? 0 : 1);
+          sse2_rev_lift(s, aug, sp - 1, sp, aug_width, true);
+
+          // swap buffers
+          si32* t = aug; aug = oth; oth = t;
+          ev = !ev;
+          ui32 w = aug_width; aug_width = oth_width; oth_width = w;
+        }
+
+        // combine both lsrc and hsrc into dst
+        sse2_interleave(dst->i32, lsrc->i32, hsrc->i32, width, even);
+      }
+      else {
+        if (even)
+          dst->i32[0] = lsrc->i32[0];
+        else
+          dst->i32[0] = hsrc->i32[0] >> 1;
+      }
+    }
+
+  } // !local
+} // !ojph
+
+OJPH_TARGET_END
+
+#endif
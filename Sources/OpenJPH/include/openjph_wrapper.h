@@ -14,18 +14,169 @@ typedef struct {
     uint16_t bit_depth;
     uint8_t is_signed;
     uint8_t is_float;
-    uint16_t reserved;
+    uint8_t is_planar;   // see OJPH_LAYOUT_PLANAR
+    uint8_t reserved;
     size_t pixel_count;
+    size_t plane_pitch;  // bytes between the starts of two planes; 0 if interleaved
     uint8_t *pixels8;
-    uint16_t *pixels16;
+    uint16_t *pixels16;  // also holds half floats, see OJPH_SAMPLE_FLOAT16
+    float *pixels32;     // see OJPH_SAMPLE_FLOAT32
 } ojph_decoded_image;
 
 typedef enum {
     OJPH_STATUS_OK = 0,
     OJPH_STATUS_UNSUPPORTED = 1,
-    OJPH_STATUS_ERROR = 2
+    OJPH_STATUS_ERROR = 2,
+    OJPH_STATUS_BUFFER_TOO_SMALL = 3,
+    OJPH_STATUS_CANCELLED = 4  // see ojph_decode_queue_cancel
 } ojph_status;
 
+typedef enum {
+    /// The samples of a pixel are stored next to each other.
+    OJPH_LAYOUT_INTERLEAVED = 0,
+    /// Each component is stored in its own plane of `width` x `height`
+    /// samples, with the same row pitch as the other planes; plane `c` starts
+    /// `c * plane_pitch` bytes after the first one. Codestreams without a
+    /// colour transform are then decoded one component at a time.
+    OJPH_LAYOUT_PLANAR = 1,
+    /// Interleaved, with a fourth alpha sample of all ones after the three
+    /// of each pixel, for textures of 4-byte pixels; `components` is then 4.
+    /// Needs three output components and integer samples.
+    OJPH_LAYOUT_RGBA = 2
+} ojph_layout;
+
+typedef enum {
+    /// 8-bit or 16-bit integers, as described by `bit_depth` and `is_signed`.
+    OJPH_SAMPLE_INTEGER = 0,
+    /// 32-bit floats in `pixels32`, e.g. Hounsfield units for volume
+    /// rendering; `is_float` is set and `bit_depth` is 32.
+    OJPH_SAMPLE_FLOAT32 = 1,
+    /// IEEE half floats in `pixels16`, ready for half-float textures; `is_float`
+    /// is set and `bit_depth` is 16. Values are rounded to nearest even, and
+    /// magnitudes beyond 65504 become infinities.
+    OJPH_SAMPLE_FLOAT16 = 2
+} ojph_sample_format;
+
+typedef enum {
+    /// No window; samples keep their own range.
+    OJPH_VOI_NONE = 0,
+    /// DICOM LINEAR window: values up to `center - 0.5 - (width - 1) / 2`
+    /// are black, and a width of 1 thresholds at `center - 0.5`.
+    OJPH_VOI_LINEAR = 1,
+    /// DICOM LINEAR_EXACT window, from `center - width / 2` to
+    /// `center + width / 2`.
+    OJPH_VOI_LINEAR_EXACT = 2,
+    /// DICOM SIGMOID window; needs samples of at most 16 bits, and float
+    /// samples of irreversible codestreams are rounded before it.
+    OJPH_VOI_SIGMOID = 3
+} ojph_voi_function;
+
+/// Where the time of one decode went, and how much work it did; see
+/// `ojph_decode_options.stats`. Times are in nanoseconds. Stage times exclude
+/// each other, e.g. `idwt_ns` does not include the codeblock decoding that
+/// the transform waits for; stages that run on worker threads (codeblock
+/// decoding, and the tiles of images that are several tiles wide) are summed
+/// over threads and can exceed `total_ns`. All fields are zero when OpenJPH
+/// is built with OJPH_DISABLE_STATS.
+typedef struct {
+    uint64_t total_ns;         // elapsed time of the call
+    uint64_t headers_ns;       // main and tile-part header marker segments
+    uint64_t packets_ns;       // packet headers and bodies
+    uint64_t blocks_ns;        // codeblock decoding and dequantization
+    uint64_t block_wait_ns;    // waiting for codeblocks decoded by workers
+    uint64_t idwt_ns;          // inverse wavelet transform
+    uint64_t colour_ns;        // inverse colour transform and level shift
+    uint64_t output_ns;        // conversion into the output samples
+    uint64_t bytes_parsed;     // codestream bytes read, headers included
+    uint64_t packets_parsed;   // packets whose headers were read
+    uint64_t packets_skipped;  // packets stepped over using PLT lengths
+    uint64_t codeblocks_decoded;
+    uint64_t zero_blocks;      // codeblocks without data, or not needed
+    /// Bytes the decode held at its peak: the working memory of the
+    /// codestream, its coded data, and the output samples it allocated.
+    uint64_t memory_bytes;
+    /// Non-zero when `ojph_decode_options.memory_limit` made the decode
+    /// give up buffers.
+    uint64_t memory_limited;
+} ojph_decode_stats;
+
+/// Options of `ojph_decode_with_options` and `ojph_decode_into_with_options`.
+/// A zeroed structure decodes the whole image, at full resolution, into
+/// interleaved samples, unchanged.
+///
+/// The sample transforms are applied while samples are converted to their
+/// output format, in this order: `invert`, the rescale, then `bias`. When any
+/// of them is set and the output is integer, `bit_depth` and `is_signed` of
+/// the returned image describe the transformed samples: the smallest format
+/// that holds the transformed sample range, with 8-bit storage when it is
+/// unsigned and at most 8 bits; values outside 16 bits are clamped. Float
+/// outputs are neither rounded nor clamped.
+///
+/// A VOI window, applied to the transformed samples, produces 8-bit display
+/// samples straight from the decoded lines, as `WindowCenter`/`WindowWidth`
+/// and `VOILUTFunction` describe them; the format must then be integer.
+typedef struct {
+    /// Finest resolution levels to skip, as for `ojph_decode_thumbnail`.
+    uint32_t discard_levels;
+    /// Window to decode, as for `ojph_decode_region`; the whole image when
+    /// both `region_width` and `region_height` are 0.
+    uint32_t region_x;
+    uint32_t region_y;
+    uint32_t region_width;
+    uint32_t region_height;
+    ojph_layout layout;
+    /// Non-zero reflects samples within their nominal range, e.g. 4095 - v
+    /// for unsigned 12-bit samples, as MONOCHROME1 images need.
+    uint8_t invert;
+    /// Applies `v * rescale_slope + rescale_intercept`, the DICOM modality
+    /// rescale; a slope of 0 is taken as 1.
+    double rescale_slope;
+    double rescale_intercept;
+    /// Added last, e.g. `1 << (bit_depth - 1)` turns signed samples into
+    /// unsigned ones.
+    int32_t bias;
+    ojph_sample_format format;
+    ojph_voi_function voi_function;
+    double window_center;
+    double window_width;
+    /// Components to decode and output, bit c selecting component c; 0
+    /// selects them all. The others skip codeblock decoding and the inverse
+    /// wavelet transform, and the colour transform is bypassed unless all
+    /// of its three components are selected, so 1 decodes the luma of a
+    /// YCbCr codestream alone, even with subsampled chroma. Output
+    /// components follow the order of the codestream.
+    uint32_t component_mask;
+    /// Non-zero converts full range YCbCr samples (YBR_FULL, YBR_FULL_422)
+    /// to RGB while interleaving them; chroma subsampled by two is repeated
+    /// in the same pass. Needs three unsigned components, interleaved
+    /// integer output, and no sample transform nor VOI window.
+    uint8_t ycbcr_to_rgb;
+    /// Non-zero runs the dequantization and inverse wavelet transform of
+    /// lossy (9/7) components in 24-bit fixed point instead of floats,
+    /// which is faster on devices with slow float units. For display only:
+    /// samples of up to 16 bits differ from the default decode by at most 1.
+    /// Lossless components are unaffected.
+    uint8_t fixed_point_synthesis;
+    /// Non-zero decodes only the cleanup pass of HTJ2K codeblocks, skipping
+    /// their refinement passes: a faster, slightly coarser image, e.g. while
+    /// scrolling through a series, to be followed by a full decode once it
+    /// stops. Samples lack the last bit-plane where the encoder coded one;
+    /// JPEG 2000 Part 1 codeblocks are decoded in full.
+    uint8_t cleanup_pass_only;
+    /// Bytes the decode should stay within, e.g. to keep a large mammogram
+    /// clear of the iOS memory limit; 0 sets no limit. When the output and
+    /// the working memory predicted once the headers are read exceed it,
+    /// the decode gives up what only buys speed rather than failing: the
+    /// strips of tile-parallel decoding, and the coarser images of frame
+    /// cache pyramids. The coded data, read as the decode goes, comes on
+    /// top; `stats` tell the bytes held in the end.
+    size_t memory_limit;
+    /// Non-NULL collects the stage times and counters of the decode into it,
+    /// overwriting its contents; NULL measures nothing. It must stay valid until
+    /// the call returns, or until `ojph_stream_finish` for streams.
+    ojph_decode_stats *stats;
+} ojph_decode_options;
+
 /// Decodes a JPEG 2000 / HTJ2K codestream into 8-bit or 16-bit interleaved pixels.
 /// On success the caller owns the returned pixel buffer(s) and must release them
 /// with `ojph_free_image`.
@@ -35,6 +186,741 @@ ojph_status ojph_decode_image(const uint8_t *codestream,
                               char *error_message,
                               size_t error_length);
 
+/// Decodes a JPEG 2000 / HTJ2K codestream directly into a caller-owned buffer.
+///
+/// Samples are written interleaved, using 8-bit storage when the image is
+/// unsigned with at most 8 bits per sample and 16-bit storage otherwise
+/// (signed samples are stored as two's complement `int16_t`).
+/// `row_pitch` is the distance in bytes between the starts of two rows; pass 0
+/// for the tightest pitch that satisfies `alignment`. `alignment` must be 0
+/// (natural sample alignment) or a power of two, and both `destination` and
+/// `row_pitch` must be multiples of it.
+///
+/// `out_info` receives the image description; its pixel pointers are left
+/// NULL because the caller keeps ownership of `destination`, so it must not be
+/// passed to `ojph_free_image`. When `destination` is NULL or
+/// `destination_size` is too small, only the headers are parsed, `out_info`
+/// and `required_size` (if non-NULL) are filled in, and
+/// `OJPH_STATUS_BUFFER_TOO_SMALL` is returned.
+ojph_status ojph_decode_image_into(const uint8_t *codestream,
+                                   size_t length,
+                                   void *destination,
+                                   size_t destination_size,
+                                   size_t row_pitch,
+                                   size_t alignment,
+                                   ojph_decoded_image *out_info,
+                                   size_t *required_size,
+                                   char *error_message,
+                                   size_t error_length);
+
+/// Decodes a reduced-resolution version of the image, as `ojph_decode_image`
+/// does for the full one. The `discard_levels` finest resolution levels are
+/// skipped entirely (no codeblock decoding, no inverse wavelet transform), so
+/// each level halves the width and height (rounded up). Requests beyond the
+/// number of wavelet decomposition levels are clamped to the coarsest
+/// resolution available. `out_image` reports the reduced dimensions.
+ojph_status ojph_decode_thumbnail(const uint8_t *codestream,
+                                  size_t length,
+                                  uint32_t discard_levels,
+                                  ojph_decoded_image *out_image,
+                                  char *error_message,
+                                  size_t error_length);
+
+/// Same as `ojph_decode_thumbnail`, but writes into a caller-owned buffer with
+/// the conventions of `ojph_decode_image_into`.
+ojph_status ojph_decode_thumbnail_into(const uint8_t *codestream,
+                                       size_t length,
+                                       uint32_t discard_levels,
+                                       void *destination,
+                                       size_t destination_size,
+                                       size_t row_pitch,
+                                       size_t alignment,
+                                       ojph_decoded_image *out_info,
+                                       size_t *required_size,
+                                       char *error_message,
+                                       size_t error_length);
+
+/// Decodes only the `width` x `height` window at (`x`, `y`) of the image, as
+/// `ojph_decode_image` does for the whole one. The window is given in the
+/// coordinates of the image after discarding `discard_levels` resolution
+/// levels (see `ojph_decode_thumbnail`), relative to its top-left sample, and
+/// is clipped to the image. Tiles that do not intersect the window are not
+/// reconstructed, codeblocks outside the support of the wavelet synthesis
+/// filters are not decoded, and decoding stops after the last row of the
+/// window. `out_image` describes the clipped window.
+ojph_status ojph_decode_region(const uint8_t *codestream,
+                               size_t length,
+                               uint32_t x,
+                               uint32_t y,
+                               uint32_t width,
+                               uint32_t height,
+                               uint32_t discard_levels,
+                               ojph_decoded_image *out_image,
+                               char *error_message,
+                               size_t error_length);
+
+/// Same as `ojph_decode_region`, but writes into a caller-owned buffer with
+/// the conventions of `ojph_decode_image_into`.
+ojph_status ojph_decode_region_into(const uint8_t *codestream,
+                                    size_t length,
+                                    uint32_t x,
+                                    uint32_t y,
+                                    uint32_t width,
+                                    uint32_t height,
+                                    uint32_t discard_levels,
+                                    void *destination,
+                                    size_t destination_size,
+                                    size_t row_pitch,
+                                    size_t alignment,
+                                    ojph_decoded_image *out_info,
+                                    size_t *required_size,
+                                    char *error_message,
+                                    size_t error_length);
+
+/// Opaque decoder context that keeps the codestream machinery and its memory
+/// stores alive between frames. Back-to-back frames with the same structure
+/// reuse the allocations of the previous frame instead of rebuilding them,
+/// and a main header (SIZ, COD, QCD, ...) byte-identical to the previous
+/// frame's is matched rather than parsed again. A context must not be used
+/// by more than one thread at a time.
+typedef struct ojph_decoder ojph_decoder;
+
+/// Creates a reusable decoder context; returns NULL on allocation failure.
+ojph_decoder *ojph_decoder_create(void);
+
+/// Destroys a context created by `ojph_decoder_create`. Accepts NULL.
+void ojph_decoder_destroy(ojph_decoder *decoder);
+
+/// Same as `ojph_decode_image`, but runs on the given decoder context.
+ojph_status ojph_decoder_decode(ojph_decoder *decoder,
+                                const uint8_t *codestream,
+                                size_t length,
+                                ojph_decoded_image *out_image,
+                                char *error_message,
+                                size_t error_length);
+
+/// Same as `ojph_decode_image_into`, but runs on the given decoder context.
+ojph_status ojph_decoder_decode_into(ojph_decoder *decoder,
+                                     const uint8_t *codestream,
+                                     size_t length,
+                                     void *destination,
+                                     size_t destination_size,
+                                     size_t row_pitch,
+                                     size_t alignment,
+                                     ojph_decoded_image *out_info,
+                                     size_t *required_size,
+                                     char *error_message,
+                                     size_t error_length);
+
+/// Decodes with the given options, as `ojph_decode_image` does with the
+/// defaults. Runs on `decoder` unless it is NULL; `options` may be NULL.
+/// Planar images are returned as one buffer holding all planes in turn.
+ojph_status ojph_decode_with_options(ojph_decoder *decoder,
+                                     const uint8_t *codestream,
+                                     size_t length,
+                                     const ojph_decode_options *options,
+                                     ojph_decoded_image *out_image,
+                                     char *error_message,
+                                     size_t error_length);
+
+/// Same as `ojph_decode_with_options`, but writes into a caller-owned buffer
+/// with the conventions of `ojph_decode_image_into`. Planar planes are
+/// `row_pitch * height` bytes apart, so each of them keeps the alignment.
+ojph_status ojph_decode_into_with_options(ojph_decoder *decoder,
+                                          const uint8_t *codestream,
+                                          size_t length,
+                                          const ojph_decode_options *options,
+                                          void *destination,
+                                          size_t destination_size,
+                                          size_t row_pitch,
+                                          size_t alignment,
+                                          ojph_decoded_image *out_info,
+                                          size_t *required_size,
+                                          char *error_message,
+                                          size_t error_length);
+
+/// Receives `row_count` output rows, from row `first_row` of the image on,
+/// `row_pitch` bytes apart; the planes of planar output are `plane_pitch`
+/// bytes apart. The rows are only valid for the duration of the call.
+/// Returns non-zero to go on; 0 stops the decode.
+typedef int (*ojph_row_callback)(void *context,
+                                 const uint8_t *rows,
+                                 uint32_t first_row,
+                                 uint32_t row_count,
+                                 size_t row_pitch,
+                                 size_t plane_pitch);
+
+/// Same as `ojph_decode_with_options`, but hands the output to `callback`
+/// in bands of `band_height` rows (0 for 32, the height the decoder works
+/// in), top to bottom, as soon as each is decoded, instead of returning a
+/// whole image; the last band may be shorter. Only one band is held, so the
+/// memory of the decode and the time to the first rows do not grow with the
+/// height of the image, e.g. to upload rows into tiled textures or resample
+/// them on the fly. `out_info` describes the image, with NULL samples and
+/// the `plane_pitch` of a band; it is filled in before the first call of
+/// `callback`. A callback that returns 0 ends the decode with
+/// `OJPH_STATUS_CANCELLED`.
+ojph_status ojph_decode_rows(ojph_decoder *decoder,
+                             const uint8_t *codestream,
+                             size_t length,
+                             const ojph_decode_options *options,
+                             uint32_t band_height,
+                             ojph_row_callback callback,
+                             void *context,
+                             ojph_decoded_image *out_info,
+                             char *error_message,
+                             size_t error_length);
+
+/// A subband handed to an `ojph_subband_callback`. Resolution r > 0 of a
+/// component is synthesized from resolution r - 1, as its LL band, and its
+/// own bands 1 to 3; its samples at odd positions of the `res_x`, `res_y`
+/// grid are the high-pass ones, as in JPEG 2000.
+typedef struct {
+    uint32_t component;
+    uint32_t resolution;   // 0 is the lowest
+    uint32_t band;         // 0 LL, of resolution 0 only; 1 HL, 2 LH, 3 HH
+    uint32_t res_x;        // the resolution the subband is synthesized into
+    uint32_t res_y;
+    uint32_t res_width;
+    uint32_t res_height;
+    uint32_t width;        // of the subband
+    uint32_t height;
+    /// Non-zero for float samples, of the 9/7 wavelet, which synthesize
+    /// into samples in [-0.5, 0.5) to be scaled by 2^bit_depth; otherwise
+    /// int32_t samples of the 5/3 wavelet. In both cases, the synthesized
+    /// samples still need the inverse colour transform, if any, and the DC
+    /// level shift of unsigned components.
+    uint8_t is_float;
+    uint8_t reserved[3];
+} ojph_subband;
+
+/// Receives row `row` of `band`, `band->width` samples that are only valid
+/// for the duration of the call. Returns non-zero to go on; 0 stops the
+/// decode. Calls come one at a time from the thread that called
+/// `ojph_decode_subbands`, even though codeblocks are decoded in parallel.
+typedef int (*ojph_subband_callback)(void *context,
+                                     const ojph_subband *band,
+                                     uint32_t row,
+                                     const void *samples);
+
+/// Decodes the codeblocks of a codestream, in parallel, but hands the
+/// dequantized samples of its subbands to `callback`, row by row, instead
+/// of running the inverse wavelet transform, so that a backend such as a
+/// GPU can run the synthesis, the inverse colour transform and the window
+/// itself; `ojph_probe_image` describes the image. Subbands come component
+/// by component, from resolution 0 up, each from its top row. Of the
+/// options, `discard_levels`, `component_mask`, `cleanup_pass_only`,
+/// `memory_limit` and `stats` apply. Returns `OJPH_STATUS_UNSUPPORTED` for codestreams of more than one
+/// tile or samples wider than 32 bits, and `OJPH_STATUS_ERROR` for Part 2
+/// wavelets; a callback that returns 0 ends the decode with
+/// `OJPH_STATUS_CANCELLED`.
+ojph_status ojph_decode_subbands(ojph_decoder *decoder,
+                                 const uint8_t *codestream,
+                                 size_t length,
+                                 const ojph_decode_options *options,
+                                 ojph_subband_callback callback,
+                                 void *context,
+                                 char *error_message,
+                                 size_t error_length);
+
+/// Same as `ojph_decode_with_options`, but reads the codestream from bytes
+/// `offset` to `offset + length` of the open file `fd`, e.g. one fragment
+/// of an encapsulated DICOM file. The range is mapped into memory rather
+/// than read into the heap, so only the pages the decoder touches are
+/// loaded, and from the page cache. `fd` stays owned by the caller and may
+/// be closed once the call returns. The file must not shrink meanwhile.
+ojph_status ojph_decode_file(ojph_decoder *decoder,
+                             int fd,
+                             uint64_t offset,
+                             size_t length,
+                             const ojph_decode_options *options,
+                             ojph_decoded_image *out_image,
+                             char *error_message,
+                             size_t error_length);
+
+/// Decodes the finest resolution that the first `length` bytes of a
+/// codestream hold completely, for example a byte-range prefix of a frame in
+/// a resolution-major progression such as RPCL, where lower resolutions come
+/// first. The levels discarded are the larger of what the data requires and
+/// `options->discard_levels`, and are reported in `out_discard_levels` (may be
+/// NULL); the image is the one `ojph_decode_thumbnail` would return at that
+/// level from the whole codestream. The window fields of `options` are
+/// ignored. Returns `OJPH_STATUS_UNSUPPORTED` while the bytes hold the main
+/// header but not yet the lowest resolution, and `OJPH_STATUS_ERROR` while
+/// they do not even hold the main header.
+ojph_status ojph_decode_preview(ojph_decoder *decoder,
+                                const uint8_t *codestream,
+                                size_t length,
+                                const ojph_decode_options *options,
+                                ojph_decoded_image *out_image,
+                                uint32_t *out_discard_levels,
+                                char *error_message,
+                                size_t error_length);
+
+/// Decodes `frame_count` independent codestreams (for example the frames of an
+/// enhanced multi-frame object) concurrently on an internal worker pool.
+/// Frame `i` is read from `codestreams[i]` / `lengths[i]`; its image and status
+/// are written to `out_images[i]` and `out_statuses[i]`. Every image whose
+/// status is `OJPH_STATUS_OK` must be released with `ojph_free_image`.
+/// Each worker owns its own decoder context. `max_threads` bounds the number of
+/// threads working on this batch, including the caller; 0 uses all of them.
+/// Returns `OJPH_STATUS_OK` if every frame decoded, otherwise the status of the
+/// first frame that failed.
+ojph_status ojph_decode_frames(const uint8_t *const *codestreams,
+                               const size_t *lengths,
+                               size_t frame_count,
+                               ojph_decoded_image *out_images,
+                               ojph_status *out_statuses,
+                               uint32_t max_threads);
+
+/// Incremental decoder for a codestream that arrives in chunks, for example
+/// over C-GET/C-MOVE or DICOMweb. Decoding starts on a background thread as
+/// soon as the stream is created and consumes the bytes as they are pushed,
+/// waiting where it runs ahead of them instead of failing; headers and
+/// tile-parts are therefore parsed while the transfer is still going on.
+typedef struct ojph_stream ojph_stream;
+
+/// Creates a stream decoding with `options` (NULL for the defaults). Returns
+/// NULL if the stream or its thread cannot be created.
+ojph_stream *ojph_stream_create(const ojph_decode_options *options);
+
+/// Appends the next `length` bytes of the codestream; the bytes are copied.
+/// Fails after `ojph_stream_finish`.
+ojph_status ojph_stream_push(ojph_stream *stream,
+                             const uint8_t *data,
+                             size_t length);
+
+/// Marks the end of the codestream, waits for the decode and hands over the
+/// image as `ojph_decode_with_options` would. A stream ended before its last
+/// tile-part arrived is decoded as far as its data goes.
+ojph_status ojph_stream_finish(ojph_stream *stream,
+                               ojph_decoded_image *out_image,
+                               char *error_message,
+                               size_t error_length);
+
+/// Destroys a stream, ending it first if needed; an image that was not
+/// collected by `ojph_stream_finish` is released. Accepts NULL.
+void ojph_stream_destroy(ojph_stream *stream);
+
+/// Asynchronous decodes on the worker pool of `ojph_decode_frames`, run most
+/// urgent first, e.g. the frame on screen ahead of those prefetched around
+/// it. A job is stopped between codeblock rows and tiles when cancelled, so
+/// frames scrolled past cost little. A queue may be used from several threads.
+typedef struct ojph_decode_queue ojph_decode_queue;
+
+/// Receives the outcome of a job, exactly once. The image is zeroed unless
+/// `status` is `OJPH_STATUS_OK`, and belongs to the callback, which releases
+/// it with `ojph_free_image`; `error_message` is valid for the duration of
+/// the call. The callback runs on a pool thread, or on the thread calling
+/// `ojph_decode_queue_cancel` or `ojph_decode_queue_destroy` for a job that
+/// had not started, and must not destroy the queue.
+typedef void (*ojph_job_callback)(void *context,
+                                  uint64_t job_id,
+                                  ojph_status status,
+                                  ojph_decoded_image *image,
+                                  const char *error_message);
+
+/// Creates a queue running up to `max_jobs` decodes at a time, each on its
+/// own decoder context; 0 allows one per pool thread. Returns NULL on
+/// allocation failure.
+ojph_decode_queue *ojph_decode_queue_create(uint32_t max_jobs);
+
+/// Queues a decode of `codestream`, which is copied, with `options` (NULL
+/// for the defaults), as `ojph_decode_with_options` would; the `stats` of
+/// the options must outlive the job. Jobs of higher `priority` start first,
+/// those of equal priority in the order they were queued. When every slot
+/// is busy, the running job of the lowest priority below `priority` is
+/// stopped and queued again, to start over after the more urgent ones.
+/// Returns the ID of the job, never 0, or 0 if it could not be queued, in
+/// which case `callback` is not called.
+uint64_t ojph_decode_queue_submit(ojph_decode_queue *queue,
+                                  const uint8_t *codestream,
+                                  size_t length,
+                                  const ojph_decode_options *options,
+                                  int32_t priority,
+                                  ojph_job_callback callback,
+                                  void *context);
+
+/// Changes the priority of a job that has not finished, preempting as
+/// `ojph_decode_queue_submit` does when a waiting job is raised above a
+/// running one. Returns `OJPH_STATUS_ERROR` if the job is unknown or done.
+ojph_status ojph_decode_queue_set_priority(ojph_decode_queue *queue,
+                                           uint64_t job_id,
+                                           int32_t priority);
+
+/// Cancels a job; its callback receives `OJPH_STATUS_CANCELLED`, at once if
+/// it had not started. A decode that completes while being cancelled is
+/// dropped too. Returns `OJPH_STATUS_ERROR` if the job is unknown or done.
+ojph_status ojph_decode_queue_cancel(ojph_decode_queue *queue,
+                                     uint64_t job_id);
+
+/// Cancels every job, waits for those running and destroys the queue.
+/// Accepts NULL.
+void ojph_decode_queue_destroy(ojph_decode_queue *queue);
+
+/// Decoded frames kept for reuse, e.g. while a series is scrolled back and
+/// forth. A frame is found again by the ID its caller gave it and the
+/// options it was decoded with; the least recently used frames are dropped
+/// to keep the cache within its byte budget. Frames that are handed out, or
+/// pinned, are never dropped. A cache may be used from several threads.
+typedef struct ojph_frame_cache ojph_frame_cache;
+
+/// Counters of `ojph_frame_cache_get_stats`.
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;     // frames dropped to stay within the budget
+    uint64_t uncached;      // decoded frames handed out without being kept
+    uint64_t reduced;       // coarser images kept from decodes; see
+                            // ojph_frame_cache_set_pyramid_levels
+    size_t cached_bytes;
+    size_t locked_bytes;    // of the cached frames that are pinned or handed out
+    size_t budget_bytes;
+    uint32_t frames;        // cached frames
+    uint32_t handed_out;    // frames not yet released, cached or not
+} ojph_frame_cache_stats;
+
+/// Creates a cache holding at most `budget_bytes` of decoded samples.
+/// Returns NULL on allocation failure.
+ojph_frame_cache *ojph_frame_cache_create(size_t budget_bytes);
+
+/// Destroys a cache and the frames it holds, which must all have been
+/// released. Accepts NULL.
+void ojph_frame_cache_destroy(ojph_frame_cache *cache);
+
+/// Changes the budget, dropping frames that no longer fit and may be dropped.
+void ojph_frame_cache_set_budget(ojph_frame_cache *cache, size_t budget_bytes);
+
+/// Non-zero `levels` makes each whole-image decode of the cache also keep
+/// up to that many coarser images of the frame, as decodes skipping one to
+/// `levels` more resolutions with the same options would give, so that
+/// zooming out is served without decoding again. They are rendered from the
+/// lower resolutions the inverse wavelet transform goes through anyway, and
+/// count against the budget like other frames, but only take the room left:
+/// nothing is evicted for them, and those that do not fit are not kept.
+/// Only codestreams of one tile whose output components are not subsampled
+/// have them. The default is 0.
+void ojph_frame_cache_set_pyramid_levels(ojph_frame_cache *cache,
+                                         uint32_t levels);
+
+/// Returns the frame `frame_id` decoded with `options` (NULL for the
+/// defaults), decoding `codestream` as `ojph_decode_with_options` does when
+/// the cache does not hold it. The image shares the cached samples, so a
+/// hit neither decodes nor copies; it must be given back with
+/// `ojph_frame_cache_release`, not `ojph_free_image`, and its samples must
+/// not be written. Decoded frames larger than the room left by frames that
+/// may not be dropped are handed out without being kept. On a hit, the
+/// `stats` of the options only receive the time of the lookup. A request
+/// with `cleanup_pass_only` is also served by a cached full decode.
+ojph_status ojph_frame_cache_decode(ojph_frame_cache *cache,
+                                    ojph_decoder *decoder,
+                                    uint64_t frame_id,
+                                    const uint8_t *codestream,
+                                    size_t length,
+                                    const ojph_decode_options *options,
+                                    ojph_decoded_image *out_image,
+                                    char *error_message,
+                                    size_t error_length);
+
+/// Gives back an image of `ojph_frame_cache_decode` and zeroes the structure.
+void ojph_frame_cache_release(ojph_frame_cache *cache,
+                              ojph_decoded_image *image);
+
+/// Non-zero `pinned` keeps every decode of `frame_id`, present or to come,
+/// in the cache until it is unpinned, e.g. while the frame is on screen.
+void ojph_frame_cache_pin(ojph_frame_cache *cache,
+                          uint64_t frame_id,
+                          int pinned);
+
+/// Drops the decodes of `frame_id`, pinned or not, e.g. when its data
+/// changed; those handed out stay valid until released.
+void ojph_frame_cache_evict(ojph_frame_cache *cache, uint64_t frame_id);
+
+/// Drops every cached frame, as `ojph_frame_cache_evict` does.
+void ojph_frame_cache_clear(ojph_frame_cache *cache);
+
+/// Reads the counters of the cache.
+void ojph_frame_cache_get_stats(ojph_frame_cache *cache,
+                                ojph_frame_cache_stats *out_stats);
+
+/// Progression orders of `ojph_encode_options`.
+typedef enum {
+    /// Resolution first, then position; lower resolutions come first in the
+    /// codestream, as the DICOM HTJ2K RPCL transfer syntax requires.
+    OJPH_PROGRESSION_RPCL = 0,
+    OJPH_PROGRESSION_LRCP = 1,
+    OJPH_PROGRESSION_RLCP = 2,
+    OJPH_PROGRESSION_PCRL = 3,
+    OJPH_PROGRESSION_CPRL = 4
+} ojph_progression;
+
+/// What the main header of a codestream tells, as `ojph_probe_image` reads
+/// it. Sizes are those of the reconstructed image at full resolution.
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint16_t components;
+    uint16_t bit_depth;       // of component 0
+    uint8_t is_signed;        // of component 0
+    uint8_t uniform;          // every component has the format of component 0
+    uint8_t subsampled;       // some component is subsampled
+    uint8_t high_throughput;  // HTJ2K codeblocks; Part 1 ones otherwise
+    uint8_t reversible;       // 5/3 wavelet; 9/7 otherwise
+    uint8_t color_transform;  // RCT or ICT on the first three components
+    /// Non-zero when `ojph_decode_image` can decode the codestream; the
+    /// reason is written to the error message otherwise.
+    uint8_t decodable;
+    uint8_t reserved;
+    /// Horizontal and vertical subsampling factors of the first components.
+    uint8_t x_subsampling[4];
+    uint8_t y_subsampling[4];
+    uint32_t tile_width;
+    uint32_t tile_height;
+    uint32_t tiles_across;
+    uint32_t tiles_down;
+    /// Wavelet levels; `ojph_decode_thumbnail` may discard up to this many.
+    uint32_t decompositions;
+    uint32_t quality_layers;
+    uint32_t block_width;
+    uint32_t block_height;
+    ojph_progression progression;
+    /// Bytes of the pixels `ojph_decode_image` returns, e.g. to size the
+    /// destination of `ojph_decode_image_into`; 0 unless `decodable`.
+    size_t decoded_size;
+} ojph_image_probe;
+
+/// Reads the main header of a codestream, without decoding any of it, to
+/// route frames, size output buffers or choose thumbnail levels up front.
+/// Returns `OJPH_STATUS_ERROR` if the header cannot be read.
+ojph_status ojph_probe_image(const uint8_t *codestream,
+                             size_t length,
+                             ojph_image_probe *out_probe,
+                             char *error_message,
+                             size_t error_length);
+
+/// Image description and coding parameters of `ojph_encode_image`. Apart from
+/// the image description, a zeroed structure encodes losslessly, in RPCL
+/// order, with five decomposition levels and 64x64 codeblocks, as one tile.
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint16_t components;
+    /// Up to 16 bits. Samples of up to 8 bits are read as bytes, others as
+    /// 16-bit words; bits above `bit_depth` are ignored, as for DICOM
+    /// `BitsStored`, and signed samples are sign-extended from it.
+    uint16_t bit_depth;
+    uint8_t is_signed;
+    /// Non-zero selects lossy coding with the irreversible 9/7 wavelet;
+    /// otherwise the reversible 5/3 wavelet codes the image losslessly.
+    uint8_t irreversible;
+    /// Non-zero applies the colour transform (RCT when lossless, ICT when
+    /// lossy) to the first three components, e.g. for YBR_RCT or YBR_ICT.
+    uint8_t color_transform;
+    /// Non-zero writes PLT packet lengths in every tile-part header, so that
+    /// readers can seek to the precincts of a region or a resolution.
+    uint8_t packet_lengths;
+    /// Arrangement of the input samples; planes are `row_pitch * height`
+    /// bytes apart.
+    ojph_layout layout;
+    ojph_progression progression;
+    /// Wavelet levels; 0 uses five, or fewer (but at least one) when the
+    /// image is small.
+    uint32_t decompositions;
+    /// Codeblock size, powers of two from 4 to 1024 with an area of at most
+    /// 4096 samples; 0 uses 64.
+    uint32_t block_width;
+    uint32_t block_height;
+    /// Tile size; 0 codes the image as one tile.
+    uint32_t tile_width;
+    uint32_t tile_height;
+    /// Base quantization step of lossy coding; smaller is better quality.
+    /// 0 keeps the OpenJPH default.
+    float quantization_step;
+} ojph_encode_options;
+
+/// Encodes an image into an HTJ2K codestream, e.g. to transcode an inbound
+/// study before archiving. `pixels` holds `height` rows `row_pitch` bytes
+/// apart (0 for packed rows) in the given layout. Codeblocks are encoded on
+/// the internal worker pool, so one call uses every core. On success,
+/// `*out_codestream` receives a buffer of `*out_length` bytes, to be released
+/// with `ojph_free_codestream`. Returns `OJPH_STATUS_UNSUPPORTED` for image
+/// descriptions or parameters that cannot be coded.
+ojph_status ojph_encode_image(const void *pixels,
+                              size_t row_pitch,
+                              const ojph_encode_options *options,
+                              uint8_t **out_codestream,
+                              size_t *out_length,
+                              char *error_message,
+                              size_t error_length);
+
+/// Releases a codestream returned by `ojph_encode_image`. Accepts NULL.
+void ojph_free_codestream(uint8_t *codestream);
+
+/// Grows the buffer an encode writes into to at least `capacity` bytes,
+/// keeping its contents, as `realloc` does; `buffer` is NULL the first time.
+/// Returns the buffer, which may have moved, or NULL to fail the encode.
+typedef uint8_t *(*ojph_grow_callback)(void *context,
+                                       uint8_t *buffer,
+                                       size_t capacity);
+
+/// Where the output of `ojph_encode_frames` goes, and how it is laid out.
+typedef struct {
+    ojph_grow_callback grow;
+    void *context;
+    /// Expected compression ratio, e.g. 2.5 for lossless CT; the buffer is
+    /// grown once up front to hold frames coded that well, then as needed.
+    /// 0 leaves the buffer to grow as it fills.
+    float expected_ratio;
+    /// Non-zero fills the Basic Offset Table; otherwise it is left empty,
+    /// as it must be when an Extended Offset Table is written.
+    uint8_t basic_offset_table;
+} ojph_frames_options;
+
+/// Position of one frame in the output of `ojph_encode_frames`.
+typedef struct {
+    /// From the first byte after the Basic Offset Table item to the Item tag
+    /// of the frame's fragment: its Basic and Extended Offset Table entry.
+    uint64_t offset;
+    /// Bytes of the frame's codestream, its Extended Offset Table Lengths
+    /// entry; the fragment ends with a padding byte when this is odd.
+    uint64_t length;
+} ojph_frame_fragment;
+
+/// Encodes `frame_count` frames, `frame_pitch` bytes apart (0 for packed
+/// frames), each as `ojph_encode_image` would, straight into the value of an
+/// encapsulated Pixel Data element: the Basic Offset Table item, one fragment
+/// per frame and the sequence delimiter, `*out_length` bytes in the buffer
+/// last returned by `frames->grow`. The caller writes the element header
+/// (7FE0,0010) OB with undefined length before it, and the Extended Offset
+/// Table from `out_fragments`, which receives `frame_count` entries, so the
+/// object reaches disk with one copy. The buffer stays the caller's, also
+/// on failure.
+ojph_status ojph_encode_frames(const void *pixels,
+                               size_t row_pitch,
+                               size_t frame_pitch,
+                               uint32_t frame_count,
+                               const ojph_encode_options *options,
+                               const ojph_frames_options *frames,
+                               ojph_frame_fragment *out_fragments,
+                               size_t *out_length,
+                               char *error_message,
+                               size_t error_length);
+
+/// Receives the next `length` bytes of a codestream as it is encoded.
+/// Returns non-zero if it took them; 0 makes the encode fail.
+typedef int (*ojph_write_callback)(void *context,
+                                   const uint8_t *data,
+                                   size_t length);
+
+/// Encoder fed row by row, e.g. to transcode a whole-slide level or a large
+/// radiograph without holding its samples at once. The codestream leaves
+/// through a write callback in order, the main header when the encoder is
+/// created and each row of tiles as soon as its last row is pushed. Apart
+/// from the rows in flight, the encoder keeps the wavelet lines of about
+/// a codeblock row across the image and the coded data of one row of
+/// tiles, so a tile height (e.g. 1024) bounds memory for any image size.
+typedef struct ojph_encoder ojph_encoder;
+
+/// Starts encoding the image `options` describe, as `ojph_encode_image`
+/// would, and writes the main header. Returns NULL, with the reason in
+/// `error_message`, for options that cannot be coded or a failed write.
+ojph_encoder *ojph_encoder_create(const ojph_encode_options *options,
+                                  ojph_write_callback write,
+                                  void *context,
+                                  char *error_message,
+                                  size_t error_length);
+
+/// Encodes the next `rows` rows of the image, `row_pitch` bytes apart (0 for
+/// packed rows) in the layout of the options; planar input holds the rows
+/// of each component one plane after the other, planes `row_pitch * rows`
+/// bytes apart. After an error, every call fails.
+ojph_status ojph_encoder_push_rows(ojph_encoder *encoder,
+                                   const void *pixels,
+                                   size_t row_pitch,
+                                   uint32_t rows,
+                                   char *error_message,
+                                   size_t error_length);
+
+/// Writes the rest of the codestream, once every row has been pushed.
+ojph_status ojph_encoder_finish(ojph_encoder *encoder,
+                                char *error_message,
+                                size_t error_length);
+
+/// Destroys an encoder, finished or not. Accepts NULL.
+void ojph_encoder_destroy(ojph_encoder *encoder);
+
+/// Counters of the process-wide pool that decoders borrow their working
+/// memory from. Released memory is kept for the next decode, up to the
+/// retention limit, instead of going back to the heap.
+typedef struct {
+    size_t reserved_bytes;   // held by the pool, in use or idle
+    size_t in_use_bytes;     // lent to decoders at the moment
+    size_t peak_bytes;       // largest `in_use_bytes` so far
+    size_t retention_limit;  // idle bytes the pool may keep
+} ojph_memory_stats;
+
+/// Reads the pool counters.
+void ojph_get_memory_stats(ojph_memory_stats *out_stats);
+
+/// Sets how many idle bytes the pool may keep; 0 returns all memory to the
+/// heap as soon as decoders release it. The default, 4 MB, keeps the
+/// working memory of small decodes; raise it to keep that of large ones.
+void ojph_set_memory_retention(size_t bytes);
+
+/// Returns the idle memory of the pool, and of the calling thread, to the
+/// heap; worker threads hand theirs over when they exit.
+void ojph_trim_memory(void);
+
+/// Severity of the messages that OpenJPH reports while decoding.
+typedef enum {
+    OJPH_MESSAGE_INFO = 1,     // e.g. a corrupt packet skipped by a decode
+    OJPH_MESSAGE_WARNING = 2,
+    OJPH_MESSAGE_ERROR = 3,    // the decode fails with OJPH_STATUS_ERROR;
+                               // cancelling a decode reports no message
+    OJPH_MESSAGE_NONE = 4
+} ojph_message_level;
+
+/// Receives one message; `message` is valid for the duration of the call.
+typedef void (*ojph_message_callback)(void *context,
+                                      ojph_message_level level,
+                                      uint32_t code,
+                                      const char *message);
+
+/// Routes the messages of every decoder, which are otherwise printed to
+/// stdout and stderr, to `callback`. Messages below `min_level` are dropped
+/// before they are formatted, and at most `max_per_second` (0 for no limit)
+/// are delivered, so that a stack of corrupt frames cannot flood a log. The
+/// callback may run on any decoding thread, one message at a time, and must
+/// not call this function. A NULL callback discards all messages.
+void ojph_set_message_callback(ojph_message_callback callback,
+                               void *context,
+                               ojph_message_level min_level,
+                               uint32_t max_per_second);
+
+/// Messages that the rate limit has dropped since the callback was set.
+uint64_t ojph_dropped_messages(void);
+
+/// Highest instruction set the decoder and encoder kernels may use.
+typedef enum {
+    OJPH_ISA_GENERIC = 0,   // portable C++ kernels only
+    OJPH_ISA_SSE2 = 1,
+    OJPH_ISA_SSSE3 = 2,
+    OJPH_ISA_AVX = 3,
+    OJPH_ISA_AVX2 = 4,      // AVX2 and FMA
+    OJPH_ISA_ALL = 5        // whatever the CPU supports, e.g. AVX-512 or NEON
+} ojph_instruction_set;
+
+/// Limits the kernels to `cap`, or to what the CPU supports if that is less,
+/// e.g. to compare the speed of instruction sets in the field or to avoid a
+/// faulty kernel without a rebuild; `OJPH_ISA_ALL` lifts the limit. On ARM,
+/// NEON counts as any level above `OJPH_ISA_GENERIC`. Decodes and encodes
+/// started after the call use the new kernels; the cap must not be changed
+/// while others run.
+void ojph_set_instruction_set_cap(ojph_instruction_set cap);
+
+/// The instruction set the kernels are chosen for, after the cap.
+ojph_instruction_set ojph_instruction_set_in_use(void);
+
 /// Releases buffers allocated during decoding and zeroes the structure.
 void ojph_free_image(ojph_decoded_image *image);
 
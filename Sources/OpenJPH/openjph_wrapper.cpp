@@ -1,19 +1,30 @@
 #include "openjph_wrapper.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
+#include <list>
+#include <mutex>
 #include <new>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "common/ojph_arch.h"
 #include "common/ojph_codestream.h"
 #include "common/ojph_file.h"
 #include "common/ojph_mem.h"
 #include "common/ojph_message.h"
 #include "common/ojph_params.h"
+#include "common/ojph_stats.h"
+#include "common/ojph_threads.h"
+#include "transform/ojph_pack.h"
 
 namespace {
 
@@ -34,61 +45,337 @@ inline void write_error(char *dst, size_t max_len, const char *msg) {
   dst[to_copy] = '\0';
 }
 
-struct ImageBuffers {
-  std::vector<uint8_t> u8;
-  std::vector<uint16_t> u16;
+// How many lines of each codestream component have been delivered once a
+// row of component 0 is pulled; components with fewer lines, as vertically
+// subsampled ones have, skip some rows (see codestream::pull).
+struct LinePacing {
+  std::vector<ui32> steps;    // reference grid rows between lines
+  std::vector<ui32> firsts;   // grid index of the first line
+  std::vector<ui32> heights;  // lines in all
+
+  ui32 lines_due(ui32 comp, ui32 row) const {
+    const uint64_t end =
+      (static_cast<uint64_t>(firsts[0]) + row + 1) * steps[0];
+    const uint64_t due = std::max<uint64_t>(
+      (end + steps[comp] - 1) / steps[comp] - firsts[comp], 1);
+    return static_cast<ui32>(std::min<uint64_t>(due, heights[comp]));
+  }
 };
 
-inline uint16_t clamp_to_uint16(int32_t value, uint32_t bit_depth, bool is_signed) {
-  if (bit_depth >= 16 && !is_signed) {
-    if (value < 0) value = 0;
-    if (value > 0xFFFF) value = 0xFFFF;
-    return static_cast<uint16_t>(value);
-  }
-  if (is_signed) {
-    const int32_t min_val = -(1 << (bit_depth - 1));
-    const int32_t max_val = (1 << (bit_depth - 1)) - 1;
-    if (value < min_val) value = min_val;
-    if (value > max_val) value = max_val;
-    int16_t signed_val = static_cast<int16_t>(value);
-    return static_cast<uint16_t>(signed_val);
-  } else {
-    const int32_t max_val = (bit_depth >= 16) ? 0xFFFF : ((1 << bit_depth) - 1);
-    if (value < 0) value = 0;
-    if (value > max_val) value = max_val;
-    return static_cast<uint16_t>(value);
+struct ImageLayout {
+  ui32 x0 = 0;  // first column and row of the reconstructed image that are
+  ui32 y0 = 0;  // output; non-zero when decoding a region
+  ui32 width = 0;
+  ui32 height = 0;
+  ui32 num_components = 0;  // output components
+  // Codestream component of each output one, in order; the codestream has
+  // `codestream_components` in all.
+  std::vector<ui32> components;
+  ui32 codestream_components = 0;
+  LinePacing pacing;
+  // Reference grid columns between the samples of each output component,
+  // and the first column of the image on the grid; output components whose
+  // samples are further apart than those of the first one are upsampled.
+  std::vector<ui32> column_steps;
+  ui32 grid_x0 = 0;
+  bool subsampled = false;
+  bool ycbcr_to_rgb = false;  // interleave YCbCr samples converted to RGB
+  ui32 bit_depth = 0;
+  bool is_signed = false;
+  bool output_u8 = false;
+  bool planar = false;  // one plane per component instead of interleaved
+  bool rgba = false;  // a fourth, opaque, alpha sample ends each pixel
+  // The first three components are pulled before the inverse colour
+  // transform, which is applied while they are interleaved.
+  bool raw_colour = false;
+  float map_mul = 1.0f;  // samples are output as `v * map_mul + map_add`
+  float map_add = 0.0f;
+  ojph_sample_format format = OJPH_SAMPLE_INTEGER;
+  // Display values of the sigmoid VOI window, indexed by the mapped sample
+  // less its minimum; the kernels then only produce the indices.
+  std::vector<uint8_t> voi_lut;
+
+  size_t bytes_per_sample() const {
+    if (format == OJPH_SAMPLE_FLOAT32) {
+      return 4;
+    }
+    return output_u8 ? 1 : 2;
+  }
+  // Samples of one pixel in a row, alpha included; 1 when planar.
+  ui32 pixel_samples() const {
+    return planar ? 1 : num_components + (rgba ? 1 : 0);
+  }
+  // Bytes of one row of samples, of one plane when planar.
+  size_t packed_row_bytes() const {
+    return static_cast<size_t>(width) * pixel_samples() * bytes_per_sample();
+  }
+  size_t total_samples() const {
+    return static_cast<size_t>(width) * height *
+      (planar ? num_components : pixel_samples());
+  }
+  // Output samples are clamped to [min_value(), max_value()]; signed
+  // samples are stored in two's complement.
+  si32 min_value() const {
+    return is_signed ? -(1 << (std::min<ui32>(bit_depth, 31) - 1)) : 0;
+  }
+  si32 max_value() const {
+    if (is_signed) {
+      return (1 << (std::min<ui32>(bit_depth, 31) - 1)) - 1;
+    }
+    return (1 << std::min<ui32>(bit_depth, output_u8 ? 8 : 16)) - 1;
+  }
+};
+
+// What to decode; by default, the whole image at full resolution.
+struct DecodeRequest {
+  ui32 discard_levels = 0;
+  bool has_region = false;
+  ui32 region_x = 0;
+  ui32 region_y = 0;
+  ui32 region_width = 0;
+  ui32 region_height = 0;
+  bool planar = false;
+  bool rgba = false;
+  bool invert = false;
+  double rescale_slope = 1.0;
+  double rescale_intercept = 0.0;
+  si32 bias = 0;
+  ojph_sample_format format = OJPH_SAMPLE_INTEGER;
+  ojph_voi_function voi = OJPH_VOI_NONE;
+  double window_center = 0.0;
+  double window_width = 0.0;
+  ui32 component_mask = 0;  // bit c selects component c; 0 selects all
+  bool ycbcr_to_rgb = false;
+  bool fixed_point = false;  // fixed-point 9/7 synthesis, for display
+  bool cleanup_only = false;  // HT cleanup passes alone, for previews
+  size_t memory_limit = 0;  // bytes, output included; 0 for none
+  const std::atomic<bool> *cancel = nullptr;  // stops the decode if raised
+  ojph_decode_stats *stats = nullptr;  // filled in after the decode if set
+  // Up to this many coarser images of a whole-image decode are rendered
+  // into `pyramid` too, from the lower resolutions the decode produced.
+  ui32 pyramid_levels = 0;
+  std::vector<ojph_decoded_image> *pyramid = nullptr;
+
+  bool maps_samples() const {
+    return invert || rescale_slope != 1.0 || rescale_intercept != 0.0 ||
+      bias != 0;
+  }
+
+  // Whether both requests produce the same samples; `stats` and the
+  // pyramid do not count.
+  bool same_output(const DecodeRequest &other) const {
+    return discard_levels == other.discard_levels &&
+      has_region == other.has_region &&
+      (!has_region || (region_x == other.region_x &&
+                       region_y == other.region_y &&
+                       region_width == other.region_width &&
+                       region_height == other.region_height)) &&
+      planar == other.planar && rgba == other.rgba &&
+      invert == other.invert && rescale_slope == other.rescale_slope &&
+      rescale_intercept == other.rescale_intercept && bias == other.bias &&
+      format == other.format && voi == other.voi &&
+      (voi == OJPH_VOI_NONE || (window_center == other.window_center &&
+                                window_width == other.window_width)) &&
+      component_mask == other.component_mask &&
+      ycbcr_to_rgb == other.ycbcr_to_rgb &&
+      fixed_point == other.fixed_point &&
+      cleanup_only == other.cleanup_only;
+  }
+
+  // Whether the output of this request can be shown for `other`: the same
+  // samples, or the full-quality ones of a cleanup-pass-only preview.
+  bool stands_in_for(const DecodeRequest &other) const {
+    if (cleanup_only || !other.cleanup_only) {
+      return same_output(other);
+    }
+    DecodeRequest preview = *this;
+    preview.cleanup_only = true;
+    return preview.same_output(other);
+  }
+};
+
+DecodeRequest request_from(const ojph_decode_options *options) {
+  DecodeRequest request;
+  if (!options) {
+    return request;
+  }
+  request.discard_levels = options->discard_levels;
+  request.has_region = options->region_width != 0 || options->region_height != 0;
+  request.region_x = options->region_x;
+  request.region_y = options->region_y;
+  request.region_width = options->region_width;
+  request.region_height = options->region_height;
+  request.planar = options->layout == OJPH_LAYOUT_PLANAR;
+  request.rgba = options->layout == OJPH_LAYOUT_RGBA;
+  request.invert = options->invert != 0;
+  if (options->rescale_slope != 0.0) {
+    request.rescale_slope = options->rescale_slope;
+  }
+  request.rescale_intercept = options->rescale_intercept;
+  request.bias = options->bias;
+  request.format = options->format;
+  request.voi = options->voi_function;
+  request.window_center = options->window_center;
+  request.window_width = options->window_width;
+  request.component_mask = options->component_mask;
+  request.ycbcr_to_rgb = options->ycbcr_to_rgb != 0;
+  request.fixed_point = options->fixed_point_synthesis != 0;
+  request.cleanup_only = options->cleanup_pass_only != 0;
+  request.memory_limit = options->memory_limit;
+  request.stats = options->stats;
+  return request;
+}
+
+// Copies the measurements of one decode into the ojph_decode_stats of its
+// request, if any, when it goes out of scope. The decode_stats given to
+// collect() must outlive it, and the codeblock jobs of the codestream.
+class StatsReport {
+public:
+  explicit StatsReport(const DecodeRequest &request)
+  : out(request.stats), start(out ? ojph::decode_stats::now() : 0) {}
+
+  ~StatsReport() {
+    if (!out) {
+      return;
+    }
+    std::memset(out, 0, sizeof(*out));
+#ifndef OJPH_DISABLE_STATS
+    using ojph::decode_stats;
+    out->total_ns = decode_stats::now() - start;
+    if (!stats) {
+      return;
+    }
+    out->headers_ns = stats->get_time(decode_stats::HEADERS);
+    out->packets_ns = stats->get_time(decode_stats::PACKETS);
+    out->blocks_ns = stats->get_time(decode_stats::BLOCKS);
+    out->block_wait_ns = stats->get_time(decode_stats::BLOCK_WAIT);
+    out->idwt_ns = stats->get_time(decode_stats::IDWT);
+    out->colour_ns = stats->get_time(decode_stats::COLOUR);
+    out->output_ns = stats->get_time(decode_stats::OUTPUT);
+    out->bytes_parsed = stats->get_count(decode_stats::BYTES_PARSED);
+    out->packets_parsed = stats->get_count(decode_stats::PACKETS_PARSED);
+    out->packets_skipped = stats->get_count(decode_stats::PACKETS_SKIPPED);
+    out->codeblocks_decoded =
+      stats->get_count(decode_stats::CODEBLOCKS_DECODED);
+    out->zero_blocks = stats->get_count(decode_stats::ZERO_BLOCKS);
+    out->memory_bytes = stats->get_count(decode_stats::MEMORY_BYTES);
+    out->memory_limited = stats->get_count(decode_stats::MEMORY_LIMITED);
+#endif
+  }
+
+  StatsReport(const StatsReport &) = delete;
+  StatsReport &operator=(const StatsReport &) = delete;
+
+  // Returns `storage`, reset, for the codestream to add its measurements
+  // to, or NULL when the request asks for none.
+  ojph::decode_stats *collect(ojph::decode_stats &storage) {
+#ifndef OJPH_DISABLE_STATS
+    if (out) {
+      storage.reset();
+      stats = &storage;
+    }
+#endif
+    return stats;
   }
+
+private:
+  ojph_decode_stats *out;
+  uint64_t start;
+  ojph::decode_stats *stats = nullptr;
+};
+
+inline bool is_power_of_two(size_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
 }
 
-inline uint8_t clamp_to_uint8(int32_t value, uint32_t bit_depth) {
-  const int32_t max_val = (bit_depth >= 8) ? 0xFF : ((1 << bit_depth) - 1);
-  if (value < 0) value = 0;
-  if (value > max_val) value = max_val;
-  return static_cast<uint8_t>(value);
+// The pool is sized so that, together with the calling thread, every
+// hardware thread can work on a batch.
+ojph::thread_pool &shared_thread_pool() {
+  struct holder {
+    ojph::thread_pool pool;
+    holder() {
+      const unsigned hw = std::thread::hardware_concurrency();
+      pool.init(hw > 1 ? hw - 1 : 0);
+    }
+  };
+  static holder instance;
+  return instance.pool;
 }
 
-inline uint8_t float_to_uint8(float value, uint32_t bit_depth) {
-  int32_t rounded = static_cast<int32_t>(std::lround(value));
-  return clamp_to_uint8(rounded, bit_depth);
+// Skips the `discard_levels` finest resolutions, both their codeblock data
+// and their inverse DWT; each level halves the reconstructed size. Requests
+// beyond the coarsest resolution are clamped to it. Returns the number of
+// levels actually discarded.
+ui32 discard_resolutions(codestream &cs, ui32 discard_levels) {
+  if (discard_levels == 0) {
+    return 0;
+  }
+  const ui32 levels = cs.access_cod().get_num_decompositions();
+  discard_levels = std::min(discard_levels, levels);
+  cs.restrict_input_resolution(discard_levels, discard_levels);
+  return discard_levels;
 }
 
-inline uint16_t float_to_uint16(float value, uint32_t bit_depth, bool is_signed) {
-  int32_t rounded = static_cast<int32_t>(std::lround(value));
-  return clamp_to_uint16(rounded, bit_depth, is_signed);
+// Maps the start of reconstructed sample `u` back to the reference grid,
+// where the reconstructed samples are `scale` reference samples apart.
+inline ui32 to_reference_grid(ui32 u, ui32 scale) {
+  return u == 0 ? 0 : (u - 1) * scale + 1;
 }
 
-bool decode_codestream(const uint8_t *codestream_data,
-                       size_t length,
-                       ojph_decoded_image *out_image,
-                       char *error_message,
-                       size_t error_length) {
-  mem_infile input;
-  input.open(codestream_data, length);
+// Clips the requested region to the reconstructed image, shrinks `layout`
+// to it and lets the codestream skip what does not contribute to it.
+bool restrict_region(codestream &cs,
+                     const DecodeRequest &request,
+                     ui32 discarded_levels,
+                     ImageLayout &layout,
+                     char *error_message,
+                     size_t error_length) {
+  if (!request.has_region) {
+    return true;
+  }
+  const uint64_t x1 = static_cast<uint64_t>(request.region_x) +
+    request.region_width;
+  const uint64_t y1 = static_cast<uint64_t>(request.region_y) +
+    request.region_height;
+  const ui32 rx0 = std::min(request.region_x, layout.width);
+  const ui32 ry0 = std::min(request.region_y, layout.height);
+  const ui32 rx1 = static_cast<ui32>(std::min<uint64_t>(x1, layout.width));
+  const ui32 ry1 = static_cast<ui32>(std::min<uint64_t>(y1, layout.height));
+  if (rx0 >= rx1 || ry0 >= ry1) {
+    write_error(error_message, error_length,
+                "region does not intersect the image");
+    return false;
+  }
 
-  codestream cs;
-  cs.enable_resilience();
-  cs.read_headers(&input);
+  // read_layout guarantees that every output component shares these factors
+  param_siz siz = cs.access_siz();
+  const point downsample = siz.get_downsampling(layout.components[0]);
+  const point offset = siz.get_image_offset();
+  const ui32 sx = downsample.x << discarded_levels;
+  const ui32 sy = downsample.y << discarded_levels;
+  const ui32 ox = (offset.x + sx - 1) / sx;
+  const ui32 oy = (offset.y + sy - 1) / sy;
 
+  ojph::rect region;
+  region.org.x = to_reference_grid(ox + rx0, sx);
+  region.org.y = to_reference_grid(oy + ry0, sy);
+  region.siz.w = to_reference_grid(ox + rx1, sx) - region.org.x;
+  region.siz.h = to_reference_grid(oy + ry1, sy) - region.org.y;
+  cs.restrict_input_region(region);
+
+  layout.x0 = rx0;
+  layout.y0 = ry0;
+  layout.width = rx1 - rx0;
+  layout.height = ry1 - ry0;
+  return true;
+}
+
+bool read_layout(codestream &cs,
+                 ui32 component_mask,
+                 ui32 discarded_levels,
+                 ImageLayout &layout,
+                 char *error_message,
+                 size_t error_length) {
   param_siz siz = cs.access_siz();
   const ui32 num_components = siz.get_num_components();
   if (num_components == 0) {
@@ -96,22 +383,46 @@ bool decode_codestream(const uint8_t *codestream_data,
     return false;
   }
 
+  // Only the selected components must agree on their format; the others
+  // are not decoded.
+  layout.components.clear();
+  for (ui32 c = 0; c < num_components; ++c) {
+    if (component_mask == 0 || (c < 32 && ((component_mask >> c) & 1))) {
+      layout.components.push_back(c);
+    }
+  }
+  if (layout.components.empty()) {
+    write_error(error_message, error_length,
+                "component mask selects no component of the codestream");
+    return false;
+  }
+  if (component_mask != 0) {
+    cs.restrict_input_components(component_mask);
+  }
+
+  // The codestream delivers lines at the pace of component 0, so the first
+  // output component must have its size; the others may be subsampled, and
+  // are upsampled to it.
+  const ui32 first = layout.components[0];
   const ui32 width = siz.get_recon_width(0);
   const ui32 height = siz.get_recon_height(0);
-  const point downsample0 = siz.get_downsampling(0);
-  const ui32 bit_depth0 = siz.get_bit_depth(0);
-  const bool signed0 = siz.is_signed(0) != 0;
+  if (siz.get_recon_width(first) != width ||
+      siz.get_recon_height(first) != height) {
+    write_error(error_message, error_length,
+                "the first decoded component must not be subsampled");
+    return false;
+  }
+  const point downsample0 = siz.get_downsampling(first);
+  const ui32 bit_depth0 = siz.get_bit_depth(first);
+  const bool signed0 = siz.is_signed(first) != 0;
 
-  for (ui32 c = 1; c < num_components; ++c) {
-    if (siz.get_recon_width(c) != width || siz.get_recon_height(c) != height) {
-      write_error(error_message, error_length,
-                  "subsampled components are not yet supported");
-      return false;
-    }
+  layout.subsampled = false;
+  layout.column_steps.clear();
+  for (ui32 c : layout.components) {
     point p = siz.get_downsampling(c);
-    if (p.x != downsample0.x || p.y != downsample0.y) {
+    if (p.x < downsample0.x || p.y < downsample0.y) {
       write_error(error_message, error_length,
-                  "component downsampling mismatch is not supported");
+                  "components finer than the first one are not supported");
       return false;
     }
     if (siz.get_bit_depth(c) != bit_depth0) {
@@ -124,141 +435,3437 @@ bool decode_codestream(const uint8_t *codestream_data,
                   "mixed signed/unsigned components are not supported");
       return false;
     }
+    layout.subsampled = layout.subsampled ||
+      p.x != downsample0.x || p.y != downsample0.y;
+    layout.column_steps.push_back(p.x << discarded_levels);
   }
 
-  cs.set_planar(false);
-  cs.create();
+  const point offset = siz.get_image_offset();
+  layout.grid_x0 = offset.x;
+  LinePacing &pacing = layout.pacing;
+  pacing.steps.resize(num_components);
+  pacing.firsts.resize(num_components);
+  pacing.heights.resize(num_components);
+  for (ui32 c = 0; c < num_components; ++c) {
+    const ui32 step = siz.get_downsampling(c).y << discarded_levels;
+    pacing.steps[c] = step;
+    pacing.firsts[c] = (offset.y + step - 1) / step;
+    pacing.heights[c] = siz.get_recon_height(c);
+  }
+
+  layout.width = width;
+  layout.height = height;
+  layout.num_components = static_cast<ui32>(layout.components.size());
+  layout.codestream_components = num_components;
+  layout.bit_depth = bit_depth0;
+  layout.is_signed = signed0;
+  layout.output_u8 = (bit_depth0 <= 8) && !signed0;
+  return true;
+}
+
+// Maps modality values, `v * mul + add` for samples v within [lo, hi],
+// through the VOI window of `request` to 8-bit display values, as DICOM
+// PS3.3 C.11.2.1.2 defines them. The linear functions fold into the sample
+// map; the sigmoid is tabulated over the sample range.
+bool apply_window(const DecodeRequest &request,
+                  double lo,
+                  double hi,
+                  double mul,
+                  double add,
+                  ImageLayout &layout,
+                  char *error_message,
+                  size_t error_length) {
+  const double center = request.window_center;
+  const double width = request.window_width;
+  if (request.voi == OJPH_VOI_LINEAR ? !(width >= 1.0) : !(width > 0.0)) {
+    write_error(error_message, error_length, "window width is out of range");
+    return false;
+  }
+  layout.bit_depth = 8;
+  layout.is_signed = false;
+  layout.output_u8 = true;
+
+  if (request.voi != OJPH_VOI_SIGMOID) {
+    // ((x - c) / w + 0.5) * 255, which the kernels clamp to [0, 255];
+    // LINEAR shifts the center by half a unit and narrows the width by
+    // one, a steep step for a width of 1.
+    const bool exact = request.voi == OJPH_VOI_LINEAR_EXACT;
+    const double c = exact ? center : center - 0.5;
+    const double w = exact ? width : std::max(width - 1.0, 1.0 / 256);
+    const double scale = 255.0 / w;
+    const double offset = (0.5 - c / w) * 255.0;
+    layout.map_mul = static_cast<float>(mul * scale);
+    layout.map_add = static_cast<float>(add * scale + offset);
+    return true;
+  }
+
+  if (hi - lo >= 65536.0) {
+    write_error(error_message, error_length,
+                "the sigmoid VOI function needs at most 16-bit samples");
+    return false;
+  }
+  layout.voi_lut.resize(static_cast<size_t>(hi - lo) + 1);
+  for (size_t i = 0; i < layout.voi_lut.size(); ++i) {
+    const double x = (lo + static_cast<double>(i)) * mul + add;
+    const double y = 255.0 / (1.0 + std::exp(-4.0 * (x - center) / width));
+    layout.voi_lut[i] = static_cast<uint8_t>(std::lround(y));
+  }
+  layout.map_mul = 1.0f;
+  layout.map_add = static_cast<float>(-lo);
+  return true;
+}
+
+// Lets the samples of three YCbCr components be converted to RGB while they
+// are interleaved, which has no room for other sample transforms.
+bool apply_ycbcr_to_rgb(const DecodeRequest &request,
+                        ImageLayout &layout,
+                        char *error_message,
+                        size_t error_length) {
+  if (layout.num_components != 3 || layout.is_signed || layout.planar ||
+      request.maps_samples() || request.format != OJPH_SAMPLE_INTEGER ||
+      request.voi != OJPH_VOI_NONE) {
+    write_error(error_message, error_length,
+                "YCbCr to RGB needs three unsigned components, interleaved "
+                "integer output and no other sample transform");
+    return false;
+  }
+  layout.ycbcr_to_rgb = true;
+  return true;
+}
+
+// Folds the sample transforms of `request` into the map applied while
+// samples are converted, and describes the samples it produces: floats as
+// requested, windowed display values, or the smallest integer format
+// holding the mapped nominal range, clamped to 16 bits.
+bool apply_sample_map(const DecodeRequest &request,
+                      ImageLayout &layout,
+                      char *error_message,
+                      size_t error_length) {
+  if (request.format != OJPH_SAMPLE_INTEGER &&
+      request.format != OJPH_SAMPLE_FLOAT32 &&
+      request.format != OJPH_SAMPLE_FLOAT16) {
+    write_error(error_message, error_length, "unknown sample format");
+    return false;
+  }
+  if (request.voi != OJPH_VOI_NONE && request.voi != OJPH_VOI_LINEAR &&
+      request.voi != OJPH_VOI_LINEAR_EXACT &&
+      request.voi != OJPH_VOI_SIGMOID) {
+    write_error(error_message, error_length, "unknown VOI function");
+    return false;
+  }
+  if (request.voi != OJPH_VOI_NONE && request.format != OJPH_SAMPLE_INTEGER) {
+    write_error(error_message, error_length,
+                "a VOI window requires the integer sample format");
+    return false;
+  }
+  if (request.rgba) {
+    if (layout.num_components != 3 || request.format != OJPH_SAMPLE_INTEGER) {
+      write_error(error_message, error_length,
+                  "RGBA output needs three components and integer samples");
+      return false;
+    }
+    layout.rgba = true;
+  }
+  if (request.ycbcr_to_rgb) {
+    return apply_ycbcr_to_rgb(request, layout, error_message, error_length);
+  }
+  if (!request.maps_samples() && request.format == OJPH_SAMPLE_INTEGER &&
+      request.voi == OJPH_VOI_NONE) {
+    return true;
+  }
+  // The nominal range of the decoded samples, beyond the 16 bits that
+  // min_value() and max_value() clamp unmapped samples to.
+  const int depth = static_cast<int>(std::min<ui32>(layout.bit_depth, 32));
+  const double lo = layout.is_signed ? -std::ldexp(1.0, depth - 1) : 0.0;
+  const double hi = std::ldexp(1.0, layout.is_signed ? depth - 1 : depth) -
+    1.0;
 
-  const bool output_u8 = (bit_depth0 <= 8) && !signed0;
-  const size_t total_samples = static_cast<size_t>(width) * height * num_components;
+  // Reflecting v to lo + hi - v commutes with the rescale, so both fold
+  // into a single multiply-add.
+  const double slope = request.rescale_slope;
+  const double mul = request.invert ? -slope : slope;
+  const double add = (request.invert ? (lo + hi) * slope : 0.0) +
+    request.rescale_intercept + request.bias;
+  layout.map_mul = static_cast<float>(mul);
+  layout.map_add = static_cast<float>(add);
+  if (request.format != OJPH_SAMPLE_INTEGER) {
+    layout.format = request.format;
+    layout.bit_depth = request.format == OJPH_SAMPLE_FLOAT32 ? 32 : 16;
+    layout.is_signed = true;
+    layout.output_u8 = false;
+    return true;
+  }
+  if (request.voi != OJPH_VOI_NONE) {
+    return apply_window(request, lo, hi, mul, add, layout,
+                        error_message, error_length);
+  }
 
-  ImageBuffers buffers;
-  if (output_u8) {
-    buffers.u8.resize(total_samples);
+  const double a = std::round(lo * mul + add);
+  const double b = std::round(hi * mul + add);
+  const double lowest = std::min(a, b);
+  const double highest = std::max(a, b);
+  layout.is_signed = lowest < 0.0;
+  ui32 bits = 1;
+  if (layout.is_signed) {
+    while (bits < 16 && (lowest < -std::ldexp(1.0, bits - 1) ||
+                         highest > std::ldexp(1.0, bits - 1) - 1.0)) {
+      ++bits;
+    }
   } else {
-    buffers.u16.resize(total_samples);
+    while (bits < 16 && highest > std::ldexp(1.0, bits) - 1.0) {
+      ++bits;
+    }
+  }
+  layout.bit_depth = bits;
+  layout.output_u8 = bits <= 8 && !layout.is_signed;
+  return true;
+}
+
+void fill_info(const ImageLayout &layout,
+               size_t plane_pitch,
+               ojph_decoded_image *info) {
+  info->width = layout.width;
+  info->height = layout.height;
+  info->components = static_cast<uint16_t>(layout.num_components +
+                                          (layout.rgba ? 1 : 0));
+  info->bit_depth = static_cast<uint16_t>(layout.bit_depth);
+  info->is_signed = layout.is_signed ? 1 : 0;
+  info->is_float = layout.format != OJPH_SAMPLE_INTEGER ? 1 : 0;
+  info->is_planar = layout.planar ? 1 : 0;
+  info->reserved = 0;
+  info->pixel_count = layout.total_samples();
+  info->plane_pitch = layout.planar ? plane_pitch : 0;
+}
+
+// Planar output pulls one component at a time when the codestream allows
+// it, which keeps only one component's wavelet state hot in cache. The
+// colour transform needs all components of a line together, regions stop
+// pulling after their last row, and several tile columns are decoded in
+// parallel strips that need all components, as does upsampling subsampled
+// components; those pull lines interleaved and only write them to
+// separate planes.
+bool pull_planes(codestream &cs,
+                 const DecodeRequest &request,
+                 const ImageLayout &layout) {
+  // the colour transform is bypassed unless it has all of its components
+  const ui32 mask = request.component_mask;
+  const bool colour_transform = cs.access_cod().is_using_color_transform() &&
+    (mask == 0 || (mask & 7) == 7);
+  if (!request.planar || request.has_region || colour_transform ||
+      layout.subsampled) {
+    return false;
   }
+  param_siz siz = cs.access_siz();
+  const point extent = siz.get_image_extent();
+  const point tile_offset = siz.get_tile_offset();
+  const ojph::size tile_size = siz.get_tile_size();
+  return extent.x - tile_offset.x <= tile_size.w;
+}
 
-  for (ui32 row = 0; row < height; ++row) {
-    for (ui32 comp = 0; comp < num_components; ++comp) {
-      ui32 comp_index = comp;
-      ojph::line_buf *line = cs.pull(comp_index);
-      if (!line) {
-        write_error(error_message, error_length, "failed to pull line from codestream");
-        return false;
+// Interleaved RGB(A) output of the three components of a colour transform,
+// unsigned and not otherwise mapped, applies the inverse transform while
+// interleaving, in the same pass as the clamp, instead of in the codestream.
+bool defers_colour(codestream &cs,
+                   const DecodeRequest &request,
+                   const ImageLayout &layout) {
+  if (!cs.access_cod().is_using_color_transform() || layout.planar ||
+      layout.num_components != 3 || layout.ycbcr_to_rgb ||
+      layout.is_signed || layout.bit_depth > 16 ||
+      request.maps_samples() || request.format != OJPH_SAMPLE_INTEGER ||
+      request.voi != OJPH_VOI_NONE) {
+    return false;
+  }
+  for (ui32 c = 0; c < 3; ++c) {
+    if (layout.components[c] != c) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Converts the lines of one row, one per component, into output samples;
+// the lines are mapped, clamped and rounded to integers, or written as
+// floats, and interleaved together by the SIMD kernels of ojph_pack.h.
+struct RowPacker {
+  const ImageLayout &layout;
+  std::vector<ojph::line_buf *> lines;  // one per output component
+  std::vector<const si32 *> int_sources;
+  std::vector<const float *> float_sources;
+  // Output component of each codestream one, kUnselected if not output.
+  std::vector<ui32> slots;
+  // Index, in the line of each output component, of the sample of the
+  // first output column. Subsampled components are upsampled by gathering
+  // the sample of every output column, given by their column map, into
+  // `expanded`; the fused YCbCr conversion repeats chroma subsampled by
+  // two itself, `chroma_shift` being 1 and `chroma_phase` 1 when the first
+  // output column shares its chroma with the column before it.
+  std::vector<ui32> offsets;
+  std::vector<std::vector<ui32>> column_maps;
+  std::vector<std::vector<si32>> expanded;
+  std::vector<std::vector<si32>> rounded;  // float lines converted from YCbCr
+  ui32 chroma_shift = 0;
+  ui32 chroma_phase = 0;
+  mutable std::vector<uint16_t> indices;  // scratch of pack_through_lut
+
+  // Writes one row; picked by select_row() for the first row of the frame.
+  typedef void (RowPacker::*RowFunction)(uint8_t *) const;
+  mutable RowFunction row_function = nullptr;
+  mutable si32 lo = 0, hi = 0;  // limits of the integer output
+
+  enum : ui32 { kUnselected = 0xFFFFFFFFu };
+
+  explicit RowPacker(const ImageLayout &image_layout)
+  : layout(image_layout),
+    lines(image_layout.num_components),
+    int_sources(image_layout.num_components),
+    float_sources(image_layout.num_components),
+    slots(image_layout.codestream_components, kUnselected),
+    offsets(image_layout.num_components, image_layout.x0),
+    column_maps(image_layout.num_components),
+    expanded(image_layout.num_components),
+    rounded(image_layout.num_components) {
+    ojph::local::init_pack_functions();
+    for (ui32 i = 0; i < layout.num_components; ++i) {
+      slots[layout.components[i]] = i;
+    }
+    if (layout.subsampled) {
+      map_columns();
+    }
+  }
+
+  // Maps each output column to the sample of every output component that
+  // covers its position on the reference grid.
+  void map_columns() {
+    const std::vector<ui32> &steps = layout.column_steps;
+    const uint64_t step0 = steps[0];
+    const uint64_t origin = (layout.grid_x0 + step0 - 1) / step0 + layout.x0;
+    const bool halved = layout.ycbcr_to_rgb && steps[1] == 2 * step0 &&
+      steps[2] == steps[1];
+    if (halved) {
+      chroma_shift = 1;
+      chroma_phase = static_cast<ui32>(origin & 1);
+    }
+    for (ui32 i = 1; i < layout.num_components; ++i) {
+      const uint64_t step = steps[i];
+      if (step == step0) {
+        continue;
       }
-      if (comp_index != comp) {
-        comp = comp_index; // keep indices in sync if library reorders
+      if (halved) {
+        // the chroma of the column after a peeled one
+        offsets[i] = sample_of(origin + chroma_phase, step0, step);
+        continue;
       }
+      column_maps[i].resize(layout.width);
+      for (ui32 x = 0; x < layout.width; ++x) {
+        column_maps[i][x] = sample_of(origin + x, step0, step);
+      }
+      expanded[i].resize(layout.width);
+    }
+  }
 
-      const size_t samples_in_line = std::min(static_cast<size_t>(line->size), static_cast<size_t>(width));
-      const size_t base_index = (static_cast<size_t>(row) * width) * num_components + comp;
+  // Index of the sample, with `step` grid columns between samples, that
+  // covers output column `column` of the first component; the first one
+  // for columns left of it.
+  ui32 sample_of(uint64_t column, uint64_t step0, uint64_t step) const {
+    const uint64_t base = (layout.grid_x0 + step - 1) / step;
+    const uint64_t index = column * step0 / step;
+    return index > base ? static_cast<ui32>(index - base) : 0;
+  }
 
-      if ((line->flags & ojph::line_buf::LFT_INTEGER) != 0) {
-        const si32 *src = line->i32;
-        if (output_u8) {
-          uint8_t *dst = buffers.u8.data();
-          for (size_t x = 0; x < samples_in_line; ++x) {
-            dst[base_index + x * num_components] = clamp_to_uint8(src[x], bit_depth0);
-          }
-        } else {
-          uint16_t *dst = buffers.u16.data();
-          for (size_t x = 0; x < samples_in_line; ++x) {
-            dst[base_index + x * num_components] = clamp_to_uint16(src[x], bit_depth0, signed0);
-          }
-        }
-      } else if ((line->flags & ojph::line_buf::LFT_32BIT) != 0) {
-        const float *src = line->f32;
-        if (output_u8) {
-          uint8_t *dst = buffers.u8.data();
-          for (size_t x = 0; x < samples_in_line; ++x) {
-            dst[base_index + x * num_components] = float_to_uint8(src[x], bit_depth0);
-          }
-        } else {
-          uint16_t *dst = buffers.u16.data();
-          for (size_t x = 0; x < samples_in_line; ++x) {
-            dst[base_index + x * num_components] = float_to_uint16(src[x], bit_depth0, signed0);
-          }
-        }
-      } else {
-        write_error(error_message, error_length, "unsupported line buffer layout");
-        return false;
+  // Output component of codestream component `comp`, or kUnselected.
+  ui32 slot_of(ui32 comp) const {
+    return comp < slots.size() ? slots[comp] : kUnselected;
+  }
+
+  // Records the line pulled for `comp`; returns false when it holds neither
+  // 32-bit integers nor floats.
+  bool set_line(ui32 comp, ojph::line_buf *line) {
+    if ((line->flags & ojph::line_buf::LFT_32BIT) == 0) {
+      return false;
+    }
+    lines[comp] = line;
+    const si32 *src = line->i32;
+    if (layout.ycbcr_to_rgb && is_float(comp)) {
+      // the conversion takes integers, as reversible codestreams give them
+      std::vector<si32> &dp = rounded[comp];
+      dp.resize(line->size);
+      for (size_t x = 0; x < dp.size(); ++x) {
+        dp[x] = static_cast<si32>(std::floor(line->f32[x] + 0.5f));
+      }
+      src = dp.data();
+    }
+    const std::vector<ui32> &map = column_maps[comp];
+    if (!map.empty()) {
+      // 32-bit words are gathered alike for integers and floats
+      const ui32 last = static_cast<ui32>(line->size) - 1;
+      si32 *dp = expanded[comp].data();
+      for (size_t x = 0; x < map.size(); ++x) {
+        dp[x] = src[std::min(map[x], last)];
       }
+      int_sources[comp] = dp;
+      float_sources[comp] = reinterpret_cast<const float *>(dp);
+      return true;
     }
+    int_sources[comp] = src + offsets[comp];
+    float_sources[comp] = line->f32 + offsets[comp];
+    return true;
   }
 
-  cs.close();
-  input.close();
+  bool is_float(ui32 comp) const {
+    return (lines[comp]->flags & ojph::line_buf::LFT_INTEGER) == 0;
+  }
 
-  if (output_u8) {
-    uint8_t *result = static_cast<uint8_t *>(std::malloc(buffers.u8.size()));
-    if (!result) {
-      write_error(error_message, error_length, "memory allocation failure");
-      return false;
+  ui32 samples(ui32 comp) const {
+    if (!column_maps[comp].empty()) {
+      return layout.width;
     }
-    std::memcpy(result, buffers.u8.data(), buffers.u8.size());
-    out_image->pixels8 = result;
-    out_image->pixels16 = nullptr;
-  } else {
-    uint16_t *result = static_cast<uint16_t *>(std::malloc(buffers.u16.size() * sizeof(uint16_t)));
-    if (!result) {
-      write_error(error_message, error_length, "memory allocation failure");
-      return false;
+    const ui32 size = static_cast<ui32>(lines[comp]->size);
+    const ui32 offset = offsets[comp];
+    return size > offset ? std::min(size - offset, layout.width) : 0;
+  }
+
+  // Writes the recorded lines as one row of interleaved samples.
+  void pack_row(uint8_t *row_start) const {
+    if (!row_function) {
+      row_function = select_row();
     }
-    std::memcpy(result, buffers.u16.data(), buffers.u16.size() * sizeof(uint16_t));
-    out_image->pixels8 = nullptr;
-    out_image->pixels16 = result;
+    (this->*row_function)(row_start);
   }
 
-  out_image->width = width;
-  out_image->height = height;
-  out_image->components = static_cast<uint16_t>(num_components);
-  out_image->bit_depth = static_cast<uint16_t>(bit_depth0);
-  out_image->is_signed = signed0 ? 1 : 0;
-  out_image->is_float = 0;
-  out_image->reserved = 0;
-  out_image->pixel_count = total_samples;
-  return true;
-}
+  // Picks the row function of the frame from the lines of its first row,
+  // which all rows share the formats of. Integer mono and RGB output,
+  // without alpha nor lookup table, is what most frames are: 16-bit CT,
+  // 8-bit secondary captures, colour photographs; their rows are one call
+  // of a kernel with the component count and sample types fixed.
+  RowFunction select_row() const {
+    if (layout.ycbcr_to_rgb) {
+      return &RowPacker::pack_ycbcr_row;
+    }
+    if (layout.raw_colour) {
+      return &RowPacker::pack_colour_row;
+    }
+    const ui32 num_components = layout.num_components;
+    bool fixed = layout.format == OJPH_SAMPLE_INTEGER &&
+      layout.voi_lut.empty() && !layout.rgba &&
+      (num_components == 1 || (num_components == 3 && layout.output_u8));
+    for (ui32 c = 1; c < num_components && fixed; ++c) {
+      fixed = is_float(c) == is_float(0);
+    }
+    if (!fixed) {
+      return &RowPacker::pack_any_row;
+    }
+    static const RowFunction table[2][3] = {
+      { &RowPacker::pack_fixed_row<si32, uint8_t, 1>,
+        &RowPacker::pack_fixed_row<si32, uint16_t, 1>,
+        &RowPacker::pack_fixed_row<si32, uint8_t, 3> },
+      { &RowPacker::pack_fixed_row<float, uint8_t, 1>,
+        &RowPacker::pack_fixed_row<float, uint16_t, 1>,
+        &RowPacker::pack_fixed_row<float, uint8_t, 3> } };
+    lo = layout.min_value();
+    hi = layout.max_value();
+    const int kind = num_components == 3 ? 2 : layout.output_u8 ? 0 : 1;
+    return table[is_float(0) ? 1 : 0][kind];
+  }
 
-} // namespace
+  static void pack_lines(const si32 *const *src, ui32 count, uint8_t *dst,
+                         ui32 width, si32 lo, si32 hi, float mul, float add) {
+    ojph::local::pack_si32_to_ui8(src, count, dst, count, width,
+                                  lo, hi, mul, add);
+  }
+  static void pack_lines(const si32 *const *src, ui32 count, uint16_t *dst,
+                         ui32 width, si32 lo, si32 hi, float mul, float add) {
+    ojph::local::pack_si32_to_ui16(src, count, dst, count, width,
+                                   lo, hi, mul, add);
+  }
+  static void pack_lines(const float *const *src, ui32 count, uint8_t *dst,
+                         ui32 width, si32 lo, si32 hi, float mul, float add) {
+    ojph::local::pack_f32_to_ui8(src, count, dst, count, width,
+                                 lo, hi, mul, add);
+  }
+  static void pack_lines(const float *const *src, ui32 count, uint16_t *dst,
+                         ui32 width, si32 lo, si32 hi, float mul, float add) {
+    ojph::local::pack_f32_to_ui16(src, count, dst, count, width,
+                                  lo, hi, mul, add);
+  }
 
-extern "C" ojph_status ojph_decode_image(const uint8_t *codestream_data,
-                                          size_t length,
-                                          ojph_decoded_image *out_image,
-                                          char *error_message,
-                                          size_t error_length) {
-  if (!codestream_data || length == 0 || !out_image) {
-    write_error(error_message, error_length, "invalid arguments");
-    return OJPH_STATUS_ERROR;
+  const si32 *const *sources(const si32 *) const { return int_sources.data(); }
+  const float *const *sources(const float *) const {
+    return float_sources.data();
   }
 
-  std::memset(out_image, 0, sizeof(*out_image));
+  // Writes `N` components of `T` lines, all of them, as `D` samples.
+  template <typename T, typename D, ui32 N>
+  void pack_fixed_row(uint8_t *row_start) const {
+    ui32 width = samples(0);
+    for (ui32 c = 1; c < N; ++c) {
+      width = std::min(width, samples(c));
+    }
+    pack_lines(sources(static_cast<const T *>(nullptr)), N,
+               reinterpret_cast<D *>(row_start), width, lo, hi,
+               layout.map_mul, layout.map_add);
+  }
 
-  try {
-    const bool ok = decode_codestream(codestream_data, length, out_image,
-                                      error_message, error_length);
-    return ok ? OJPH_STATUS_OK : OJPH_STATUS_UNSUPPORTED;
-  } catch (const std::exception &ex) {
-    write_error(error_message, error_length, ex.what());
-    ojph_free_image(out_image);
-    return OJPH_STATUS_ERROR;
-  } catch (...) {
-    write_error(error_message, error_length, "unknown OpenJPH error");
-    ojph_free_image(out_image);
-    return OJPH_STATUS_ERROR;
+  // Writes a row of any other output.
+  void pack_any_row(uint8_t *row_start) const {
+    const ui32 num_components = layout.num_components;
+    const ui32 stride = layout.pixel_samples();
+    ui32 width = layout.width;
+    bool mixed = false;
+    for (ui32 c = 0; c < num_components; ++c) {
+      width = std::min(width, samples(c));
+      mixed = mixed || is_float(c) != is_float(0);
+    }
+    if (!mixed) {
+      pack_components(0, num_components, row_start, stride, width);
+    } else {
+      // Components coded with different wavelets; convert them one at a
+      // time.
+      for (ui32 c = 0; c < num_components; ++c) {
+        pack_components(c, 1, row_start + c * layout.bytes_per_sample(),
+                        stride, samples(c));
+      }
+    }
+    if (layout.rgba) {
+      fill_alpha(row_start, width);
+    }
+  }
+
+  // Sets the alpha sample of the first `width` pixels of a row to all ones.
+  void fill_alpha(uint8_t *row_start, ui32 width) const {
+    if (layout.output_u8) {
+      uint8_t *dp = row_start + 3;
+      for (ui32 x = 0; x < width; ++x, dp += 4) {
+        *dp = 0xFF;
+      }
+    } else {
+      uint16_t *dp = reinterpret_cast<uint16_t *>(row_start) + 3;
+      for (ui32 x = 0; x < width; ++x, dp += 4) {
+        *dp = 0xFFFF;
+      }
+    }
+  }
+
+  // Writes the recorded lines of the three components of a deferred colour
+  // transform as one row of interleaved RGB(A) samples.
+  void pack_colour_row(uint8_t *row_start) const {
+    const ui32 stride = layout.pixel_samples();
+    const ui32 width = std::min(samples(0), std::min(samples(1), samples(2)));
+    const si32 half = 1 << (layout.bit_depth - 1);
+    const si32 hi = layout.max_value();
+    uint16_t *dst16 = reinterpret_cast<uint16_t *>(row_start);
+    if (is_float(0)) {
+      const float *const *f = float_sources.data();
+      if (layout.output_u8) {
+        ojph::local::pack_ict_to_rgb8(f[0], f[1], f[2], row_start, stride,
+                                      width, half, hi);
+      } else {
+        ojph::local::pack_ict_to_rgb16(f[0], f[1], f[2], dst16, stride,
+                                       width, half, hi);
+      }
+    } else {
+      const si32 *const *s = int_sources.data();
+      if (layout.output_u8) {
+        ojph::local::pack_rct_to_rgb8(s[0], s[1], s[2], row_start, stride,
+                                      width, half, hi);
+      } else {
+        ojph::local::pack_rct_to_rgb16(s[0], s[1], s[2], dst16, stride,
+                                       width, half, hi);
+      }
+    }
+  }
+
+  // Writes the recorded YCbCr lines as one row of interleaved RGB samples.
+  void pack_ycbcr_row(uint8_t *row_start) const {
+    const si32 *y = int_sources[0];
+    const si32 *cb = int_sources[1];
+    const si32 *cr = int_sources[2];
+    ui32 width = samples(0);
+    if (chroma_phase != 0 && width > 0) {
+      // shares its chroma with the column before it, or has none of its own
+      const ui32 peeled = offsets[1] > 0 ? 1 : 0;
+      pack_ycbcr(y++, cb - peeled, cr - peeled, row_start, 1, 0);
+      row_start += layout.pixel_samples() * layout.bytes_per_sample();
+      --width;
+    }
+    pack_ycbcr(y, cb, cr, row_start, width, chroma_shift);
+  }
+
+  void pack_ycbcr(const si32 *y, const si32 *cb, const si32 *cr,
+                  uint8_t *dst, ui32 width, ui32 shift) const {
+    const si32 half = 1 << (layout.bit_depth - 1);
+    const si32 hi = layout.max_value();
+    const ui32 stride = layout.pixel_samples();
+    if (layout.output_u8) {
+      ojph::local::pack_ycc_to_rgb8(y, cb, cr, dst, stride, width, shift,
+                                    half, hi);
+    } else {
+      ojph::local::pack_ycc_to_rgb16(y, cb, cr,
+                                     reinterpret_cast<uint16_t *>(dst),
+                                     stride, width, shift, half, hi);
+    }
+  }
+
+  // Writes the line recorded for `comp` as one row of its plane.
+  void pack_plane_row(ui32 comp, uint8_t *row_start) const {
+    pack_components(comp, 1, row_start, 1, samples(comp));
+  }
+
+  // Converts `count` components from `first` on; `dst` points to the first
+  // sample of `first`, and the samples of a component are `stride` apart.
+  void pack_components(ui32 first, ui32 count, uint8_t *dst, ui32 stride,
+                       ui32 width) const {
+    if (!layout.voi_lut.empty()) {
+      pack_through_lut(first, count, dst, stride, width);
+      return;
+    }
+    const float mul = layout.map_mul;
+    const float add = layout.map_add;
+    const si32 *const *ints = &int_sources[first];
+    const float *const *floats = &float_sources[first];
+    const bool from_float = is_float(first);
+    uint16_t *dst16 = reinterpret_cast<uint16_t *>(dst);
+    if (layout.format == OJPH_SAMPLE_FLOAT32) {
+      float *dst32 = reinterpret_cast<float *>(dst);
+      if (from_float) {
+        ojph::local::pack_f32_to_f32(floats, count, dst32, stride, width,
+                                     mul, add);
+      } else {
+        ojph::local::pack_si32_to_f32(ints, count, dst32, stride, width,
+                                      mul, add);
+      }
+      return;
+    }
+    if (layout.format == OJPH_SAMPLE_FLOAT16) {
+      if (from_float) {
+        ojph::local::pack_f32_to_f16(floats, count, dst16, stride, width,
+                                     mul, add);
+      } else {
+        ojph::local::pack_si32_to_f16(ints, count, dst16, stride, width,
+                                      mul, add);
+      }
+      return;
+    }
+
+    const si32 lo = layout.min_value();
+    const si32 hi = layout.max_value();
+    if (layout.output_u8) {
+      if (from_float) {
+        ojph::local::pack_f32_to_ui8(floats, count, dst, stride, width,
+                                     lo, hi, mul, add);
+      } else {
+        ojph::local::pack_si32_to_ui8(ints, count, dst, stride, width,
+                                      lo, hi, mul, add);
+      }
+    } else {
+      if (from_float) {
+        ojph::local::pack_f32_to_ui16(floats, count, dst16, stride, width,
+                                      lo, hi, mul, add);
+      } else {
+        ojph::local::pack_si32_to_ui16(ints, count, dst16, stride, width,
+                                       lo, hi, mul, add);
+      }
+    }
+  }
+
+  // Writes display values through layout.voi_lut, one component at a time:
+  // the kernels write the table indices of a row into `indices`, which
+  // stays in cache, and the table is then looked up.
+  void pack_through_lut(ui32 first, ui32 count, uint8_t *dst, ui32 stride,
+                        ui32 width) const {
+    indices.resize(width);
+    const si32 last = static_cast<si32>(layout.voi_lut.size() - 1);
+    const uint8_t *lut = layout.voi_lut.data();
+    for (ui32 c = first; c < first + count; ++c) {
+      if (is_float(c)) {
+        ojph::local::pack_f32_to_ui16(&float_sources[c], 1, indices.data(),
+                                      1, width, 0, last, layout.map_mul,
+                                      layout.map_add);
+      } else {
+        ojph::local::pack_si32_to_ui16(&int_sources[c], 1, indices.data(),
+                                       1, width, 0, last, layout.map_mul,
+                                       layout.map_add);
+      }
+      uint8_t *dp = dst + (c - first);
+      for (ui32 x = 0; x < width; ++x, dp += stride) {
+        *dp = lut[indices[x]];
+      }
+    }
+  }
+};
+
+// Pulls the next line of the codestream, expected for `comp`, into `packer`;
+// `comp` is a codestream component, whose line is dropped if not output.
+bool pull_line(codestream &cs,
+               ui32 &comp,
+               RowPacker &packer,
+               char *error_message,
+               size_t error_length) {
+  ui32 comp_index = comp;
+  ojph::line_buf *line = cs.pull(comp_index);
+  if (!line) {
+    write_error(error_message, error_length, "failed to pull line from codestream");
+    return false;
   }
+  if (comp_index != comp) {
+    comp = comp_index; // keep indices in sync if library reorders
+  }
+  const ui32 slot = packer.slot_of(comp);
+  if (slot == RowPacker::kUnselected) {
+    return true;  // not decoded, nor output
+  }
+  if (!packer.set_line(slot, line)) {
+    write_error(error_message, error_length, "unsupported line buffer layout");
+    return false;
+  }
+  return true;
 }
 
-extern "C" void ojph_free_image(ojph_decoded_image *image) {
-  if (!image) {
-    return;
+// Where decode_rows writes the output rows: the whole image, or a band of
+// `band_height` rows handed to `sink` each time it fills, then reused.
+struct OutputRows {
+  uint8_t *base = nullptr;  // first sample of output row `first`
+  size_t row_pitch = 0;
+  size_t plane_pitch = 0;   // between the planes of planar output
+  ojph_row_callback sink = nullptr;  // NULL when `base` holds every row
+  void *context = nullptr;
+  ui32 band_height = 0;
+  ui32 height = 0;          // output rows of the image
+  ui32 first = 0;
+  bool stopped = false;     // the sink asked to stop
+
+  uint8_t *row(ui32 r) const {
+    return base + static_cast<size_t>(r - first) * row_pitch;
   }
-  if (image->pixels8) {
-    std::free(image->pixels8);
+
+  // Called once output row `r` is written; returns false when the sink
+  // took its band but asked to stop.
+  bool done(ui32 r) {
+    if (!sink || (r + 1 - first < band_height && r + 1 < height)) {
+      return true;
+    }
+    const ui32 count = r + 1 - first;
+    const int taken = sink(context, base, first, count, row_pitch,
+                           plane_pitch);
+    first = r + 1;
+    stopped = taken == 0;
+    return !stopped;
   }
-  if (image->pixels16) {
-    std::free(image->pixels16);
+};
+
+// Pulls the lines of a created codestream down to the last row of `layout`
+// and converts its window of them in place into `out`. `planar_pull` tells
+// whether the codestream delivers one component at a time (see
+// pull_planes), which only a whole-image `out` takes. The conversion is
+// timed as the OUTPUT stage of `stats`, which may be NULL.
+bool decode_rows(codestream &cs,
+                 const ImageLayout &layout,
+                 bool planar_pull,
+                 OutputRows &out,
+                 ojph::decode_stats *stats,
+                 char *error_message,
+                 size_t error_length) {
+  const ui32 num_components = layout.num_components;
+  const ui32 codestream_components = layout.codestream_components;
+  RowPacker packer(layout);
+  if (planar_pull) {
+    // Components that are not output may be subsampled; their lines are
+    // still pulled, but come back untouched.
+    param_siz siz = cs.access_siz();
+    for (ui32 comp = 0; comp < codestream_components; ++comp) {
+      const ui32 slot = packer.slot_of(comp);
+      if (slot == RowPacker::kUnselected) {
+        for (ui32 row = siz.get_recon_height(comp); row > 0; --row) {
+          if (!pull_line(cs, comp, packer, error_message, error_length)) {
+            return false;
+          }
+        }
+        continue;
+      }
+      uint8_t *plane = out.base + slot * out.plane_pitch;
+      for (ui32 row = 0; row < layout.height; ++row) {
+        if (!pull_line(cs, comp, packer, error_message, error_length)) {
+          return false;
+        }
+        OJPH_STATS_TIMER(stats, OUTPUT);
+        packer.pack_plane_row(slot, plane + row * out.row_pitch);
+      }
+    }
+    return true;
+  }
+
+  const ui32 y0 = layout.y0;
+  const ui32 strip_height = cs.get_strip_height();
+  if (strip_height > 0) {
+    // Every component has a line in every row; rows come a strip at a time.
+    for (ui32 row = 0; row < y0 + layout.height;) {
+      ojph::line_buf *strip = nullptr;
+      const ui32 count = cs.pull_strip(strip);
+      if (count == 0) {
+        write_error(error_message, error_length,
+                    "failed to pull line from codestream");
+        return false;
+      }
+      OJPH_STATS_TIMER(stats, OUTPUT);
+      for (ui32 r = 0; r < count && row < y0 + layout.height; ++r, ++row) {
+        if (row < y0) {
+          continue;
+        }
+        for (ui32 comp = 0; comp < codestream_components; ++comp) {
+          const ui32 slot = packer.slot_of(comp);
+          if (slot != RowPacker::kUnselected &&
+              !packer.set_line(slot, strip + comp * strip_height + r)) {
+            write_error(error_message, error_length,
+                        "unsupported line buffer layout");
+            return false;
+          }
+        }
+        uint8_t *row_start = out.row(row - y0);
+        if (layout.planar) {
+          for (ui32 comp = 0; comp < num_components; ++comp) {
+            packer.pack_plane_row(comp, row_start + comp * out.plane_pitch);
+          }
+        } else {
+          packer.pack_row(row_start);
+        }
+        if (!out.done(row - y0)) {
+          write_error(error_message, error_length,
+                      "the row callback stopped the decode");
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Subsampled components keep their last line for the rows that bring
+  // none of theirs.
+  std::vector<ui32> pulled(codestream_components, 0);
+  for (ui32 row = 0; row < y0 + layout.height; ++row) {
+    for (ui32 comp = 0; comp < codestream_components; ++comp) {
+      const ui32 due = layout.pacing.lines_due(comp, row);
+      for (; pulled[comp] < due; ++pulled[comp]) {
+        ui32 pulled_comp = comp;
+        if (!pull_line(cs, pulled_comp, packer,
+                       error_message, error_length)) {
+          return false;
+        }
+      }
+    }
+    if (row < y0) {
+      continue; // above the region, only pulled to advance the decoder
+    }
+    uint8_t *row_start = out.row(row - y0);
+    OJPH_STATS_TIMER(stats, OUTPUT);
+    if (layout.planar) {
+      for (ui32 comp = 0; comp < num_components; ++comp) {
+        packer.pack_plane_row(comp, row_start + comp * out.plane_pitch);
+      }
+    } else {
+      packer.pack_row(row_start);
+    }
+    if (!out.done(row - y0)) {
+      write_error(error_message, error_length,
+                  "the row callback stopped the decode");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Length, in samples `scale` reference grid samples apart, of the span
+// from x0 to x1 of the reference grid.
+inline ui32 reduced_extent(ui32 x0, ui32 x1, uint64_t scale) {
+  return static_cast<ui32>((x1 + scale - 1) / scale -
+                           (x0 + scale - 1) / scale);
+}
+
+// Renders the images that discarding 1 to get_retained_levels() more
+// resolutions would give, from the lines the codestream kept while `layout`
+// was decoded, and appends them to `images`, largest first. A level that
+// cannot be rendered, for lack of memory, ends the pyramid.
+void render_pyramid(codestream &cs,
+                    const ImageLayout &layout,
+                    ui32 discarded,
+                    ojph::decode_stats *stats,
+                    std::vector<ojph_decoded_image> &images) {
+  param_siz siz = cs.access_siz();
+  const point offset = siz.get_image_offset();
+  const point extent = siz.get_image_extent();
+  const point downsampling = siz.get_downsampling(layout.components[0]);
+  for (ui32 level = 1; level <= cs.get_retained_levels(); ++level) {
+    ImageLayout reduced = layout;
+    const ui32 shift = discarded + level;
+    const uint64_t x_scale = static_cast<uint64_t>(downsampling.x) << shift;
+    const uint64_t y_scale = static_cast<uint64_t>(downsampling.y) << shift;
+    reduced.width = reduced_extent(offset.x, extent.x, x_scale);
+    reduced.height = reduced_extent(offset.y, extent.y, y_scale);
+    for (ui32 &step : reduced.column_steps) {
+      step = static_cast<ui32>(x_scale);
+    }
+    const size_t row_bytes = reduced.packed_row_bytes();
+    const size_t plane_pitch = row_bytes * reduced.height;
+    uint8_t *result = static_cast<uint8_t *>(
+      std::malloc(reduced.total_samples() * reduced.bytes_per_sample()));
+    if (!result || reduced.width == 0 || reduced.height == 0) {
+      std::free(result);
+      return;
+    }
+    ojph_decoded_image image = {};
+    if (reduced.format == OJPH_SAMPLE_FLOAT32) {
+      image.pixels32 = reinterpret_cast<float *>(result);
+    } else if (reduced.output_u8) {
+      image.pixels8 = result;
+    } else {
+      image.pixels16 = reinterpret_cast<uint16_t *>(result);
+    }
+
+    RowPacker packer(reduced);
+    for (ui32 row = 0; row < reduced.height; ++row) {
+      for (ui32 comp = 0; comp < reduced.codestream_components; ++comp) {
+        ojph::line_buf *line = cs.pull_retained(level, comp);
+        const ui32 slot = packer.slot_of(comp);
+        if (!line || (slot != RowPacker::kUnselected &&
+                      !packer.set_line(slot, line))) {
+          ojph_free_image(&image);
+          return;
+        }
+      }
+      OJPH_STATS_TIMER(stats, OUTPUT);
+      uint8_t *row_start = result + row * row_bytes;
+      if (reduced.planar) {
+        for (ui32 comp = 0; comp < reduced.num_components; ++comp) {
+          packer.pack_plane_row(comp, row_start + comp * plane_pitch);
+        }
+      } else {
+        packer.pack_row(row_start);
+      }
+    }
+    fill_info(reduced, plane_pitch, &image);
+    images.push_back(image);
+  }
+}
+
+// Hands the codestream what the memory limit of `request` leaves beside
+// `output_bytes` of samples, for its allocations.
+void limit_memory(codestream &cs, const DecodeRequest &request,
+                  size_t output_bytes) {
+  if (request.memory_limit != 0) {
+    cs.set_memory_limit(request.memory_limit > output_bytes
+                          ? request.memory_limit - output_bytes : 1);
+  }
+}
+
+// Counts the memory of a decode about to close, which is when it holds
+// the most: every allocation is still there, with all the coded data.
+void report_memory(const codestream &cs, ojph::decode_stats *stats,
+                   size_t output_bytes) {
+  OJPH_STATS_COUNT(stats, MEMORY_BYTES, cs.get_memory_use() + output_bytes);
+  OJPH_STATS_COUNT(stats, MEMORY_LIMITED, cs.is_memory_limited() ? 1 : 0);
+}
+
+ojph_status decode_codestream(codestream &cs,
+                              ojph::infile_base &input,
+                              const DecodeRequest &request,
+                              ojph::decode_stats *stats,
+                              ojph_decoded_image *out_image,
+                              char *error_message,
+                              size_t error_length) {
+  cs.set_stats(stats);
+  cs.enable_resilience();
+  cs.read_headers(&input);
+  const ui32 discarded = discard_resolutions(cs, request.discard_levels);
+
+  ImageLayout layout;
+  if (!read_layout(cs, request.component_mask, discarded, layout,
+                   error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (!restrict_region(cs, request, discarded, layout,
+                       error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+  layout.planar = request.planar;
+  if (!apply_sample_map(request, layout, error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+
+  const bool planar_pull = pull_planes(cs, request, layout);
+  cs.set_planar(planar_pull);
+  cs.set_thread_pool(&shared_thread_pool());
+  cs.set_cancel_flag(request.cancel);
+  if (defers_colour(cs, request, layout)) {
+    cs.defer_colour_transform();
+  }
+  if (request.fixed_point) {
+    cs.request_fixed_point_synthesis();
+  }
+  if (request.cleanup_only) {
+    cs.request_cleanup_pass_only();
+  }
+  if (!planar_pull) {
+    cs.request_strips(0);  // the default height, 32 rows
+  }
+  const bool pyramid = request.pyramid && request.pyramid_levels > 0 &&
+    !request.has_region && !layout.subsampled;
+  if (pyramid) {
+    cs.retain_resolutions(request.pyramid_levels);
+  }
+  const size_t total_bytes = layout.total_samples() * layout.bytes_per_sample();
+  limit_memory(cs, request, total_bytes);
+  cs.create();
+  layout.raw_colour = cs.is_colour_transform_deferred();
+
+  uint8_t *result = static_cast<uint8_t *>(std::malloc(total_bytes));
+  if (!result) {
+    write_error(error_message, error_length, "memory allocation failure");
+    return OJPH_STATUS_ERROR;
+  }
+  // Assign ownership before decoding so every failure path, including
+  // exceptions thrown by the codestream, releases the buffer.
+  if (layout.format == OJPH_SAMPLE_FLOAT32) {
+    out_image->pixels32 = reinterpret_cast<float *>(result);
+  } else if (layout.output_u8) {
+    out_image->pixels8 = result;
+  } else {
+    out_image->pixels16 = reinterpret_cast<uint16_t *>(result);
+  }
+
+  const size_t plane_pitch = layout.packed_row_bytes() * layout.height;
+  OutputRows out;
+  out.base = result;
+  out.row_pitch = layout.packed_row_bytes();
+  out.plane_pitch = plane_pitch;
+  if (!decode_rows(cs, layout, planar_pull, out, stats,
+                   error_message, error_length)) {
+    ojph_free_image(out_image);
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (pyramid) {
+    render_pyramid(cs, layout, discarded, stats, *request.pyramid);
+  }
+  report_memory(cs, stats, total_bytes);
+
+  cs.close();
+
+  fill_info(layout, plane_pitch, out_image);
+  return OJPH_STATUS_OK;
+}
+
+ojph_status decode_codestream_into(codestream &cs,
+                                   const uint8_t *codestream_data,
+                                   size_t length,
+                                   const DecodeRequest &request,
+                                   ojph::decode_stats *stats,
+                                   void *destination,
+                                   size_t destination_size,
+                                   size_t row_pitch,
+                                   size_t alignment,
+                                   ojph_decoded_image *out_info,
+                                   size_t *required_size,
+                                   char *error_message,
+                                   size_t error_length) {
+  mem_infile input;
+  input.open(codestream_data, length);
+
+  cs.set_stats(stats);
+  cs.enable_resilience();
+  cs.read_headers(&input);
+  const ui32 discarded = discard_resolutions(cs, request.discard_levels);
+
+  ImageLayout layout;
+  if (!read_layout(cs, request.component_mask, discarded, layout,
+                   error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (!restrict_region(cs, request, discarded, layout,
+                       error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+  layout.planar = request.planar;
+  if (!apply_sample_map(request, layout, error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+
+  if (alignment == 0) {
+    alignment = layout.bytes_per_sample();
+  }
+  const size_t packed_row_bytes = layout.packed_row_bytes();
+  if (row_pitch == 0) {
+    row_pitch = (packed_row_bytes + alignment - 1) & ~(alignment - 1);
+  }
+  if (row_pitch < packed_row_bytes || row_pitch % alignment != 0 ||
+      row_pitch % layout.bytes_per_sample() != 0) {
+    write_error(error_message, error_length,
+                "row pitch is too small or not a multiple of the alignment");
+    return OJPH_STATUS_ERROR;
+  }
+
+  // Planes start a whole number of rows apart, so each of them keeps the
+  // alignment; the last row only needs its packed samples, not a full pitch.
+  const size_t plane_pitch = row_pitch * layout.height;
+  const size_t planes = layout.planar ? layout.num_components : 1;
+  const size_t needed = layout.height == 0 ? 0 :
+    plane_pitch * (planes - 1) + row_pitch * (layout.height - 1) +
+    packed_row_bytes;
+  fill_info(layout, plane_pitch, out_info);
+  if (required_size) {
+    *required_size = needed;
+  }
+  if (!destination || destination_size < needed) {
+    write_error(error_message, error_length, "destination buffer is too small");
+    return OJPH_STATUS_BUFFER_TOO_SMALL;
+  }
+  if (reinterpret_cast<uintptr_t>(destination) % alignment != 0) {
+    write_error(error_message, error_length,
+                "destination buffer does not satisfy the requested alignment");
+    return OJPH_STATUS_ERROR;
+  }
+
+  const bool planar_pull = pull_planes(cs, request, layout);
+  cs.set_planar(planar_pull);
+  cs.set_thread_pool(&shared_thread_pool());
+  cs.set_cancel_flag(request.cancel);
+  if (defers_colour(cs, request, layout)) {
+    cs.defer_colour_transform();
+  }
+  if (request.fixed_point) {
+    cs.request_fixed_point_synthesis();
+  }
+  if (request.cleanup_only) {
+    cs.request_cleanup_pass_only();
+  }
+  if (!planar_pull) {
+    cs.request_strips(0);  // the default height, 32 rows
+  }
+  limit_memory(cs, request, needed);
+  cs.create();
+  layout.raw_colour = cs.is_colour_transform_deferred();
+
+  OutputRows out;
+  out.base = static_cast<uint8_t *>(destination);
+  out.row_pitch = row_pitch;
+  out.plane_pitch = plane_pitch;
+  if (!decode_rows(cs, layout, planar_pull, out, stats,
+                   error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+
+  report_memory(cs, stats, 0);  // the destination is the caller's
+  cs.close();
+  input.close();
+  return OJPH_STATUS_OK;
+}
+
+// Decodes as decode_codestream_into does, but into a band of rows that is
+// handed to `sink` each time it fills, so that the memory held does not
+// grow with the height of the image.
+ojph_status decode_codestream_rows(codestream &cs,
+                                   const uint8_t *codestream_data,
+                                   size_t length,
+                                   const DecodeRequest &request,
+                                   ojph::decode_stats *stats,
+                                   ui32 band_height,
+                                   ojph_row_callback sink,
+                                   void *context,
+                                   ojph_decoded_image *out_info,
+                                   char *error_message,
+                                   size_t error_length) {
+  mem_infile input;
+  input.open(codestream_data, length);
+
+  cs.set_stats(stats);
+  cs.enable_resilience();
+  cs.read_headers(&input);
+  const ui32 discarded = discard_resolutions(cs, request.discard_levels);
+
+  ImageLayout layout;
+  if (!read_layout(cs, request.component_mask, discarded, layout,
+                   error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (!restrict_region(cs, request, discarded, layout,
+                       error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+  layout.planar = request.planar;
+  if (!apply_sample_map(request, layout, error_message, error_length)) {
+    return OJPH_STATUS_ERROR;
+  }
+
+  // a band of the height of a strip is filled by pulling one strip
+  if (band_height == 0) {
+    band_height = 32;
+  }
+  band_height = std::max<ui32>(1, std::min(band_height, layout.height));
+  OutputRows out;
+  out.row_pitch = layout.packed_row_bytes();
+  out.plane_pitch = out.row_pitch * band_height;
+  out.sink = sink;
+  out.context = context;
+  out.band_height = band_height;
+  out.height = layout.height;
+  const size_t planes = layout.planar ? layout.num_components : 1;
+  std::vector<uint8_t> band(out.plane_pitch * planes);
+  out.base = band.data();
+  fill_info(layout, out.plane_pitch, out_info);
+
+  // planes are pulled whole, which a band cannot hold
+  cs.set_planar(false);
+  cs.set_thread_pool(&shared_thread_pool());
+  cs.set_cancel_flag(request.cancel);
+  if (defers_colour(cs, request, layout)) {
+    cs.defer_colour_transform();
+  }
+  if (request.fixed_point) {
+    cs.request_fixed_point_synthesis();
+  }
+  if (request.cleanup_only) {
+    cs.request_cleanup_pass_only();
+  }
+  cs.request_strips(0);  // the default height, 32 rows
+  limit_memory(cs, request, band.size());
+  cs.create();
+  layout.raw_colour = cs.is_colour_transform_deferred();
+
+  if (!decode_rows(cs, layout, false, out, stats,
+                   error_message, error_length)) {
+    return out.stopped ? OJPH_STATUS_CANCELLED : OJPH_STATUS_UNSUPPORTED;
+  }
+
+  report_memory(cs, stats, band.size());
+  cs.close();
+  input.close();
+  return OJPH_STATUS_OK;
+}
+
+// Hands the subbands pulled by codestream::pull_subbands() to a C callback.
+class SubbandForwarder : public ojph::subband_sink {
+public:
+  SubbandForwarder(ojph_subband_callback callback, void *context)
+    : callback(callback), context(context) {
+    std::memset(&band, 0, sizeof(band));
+  }
+
+  void begin_band(ui32 comp_num, ui32 res_num, ui32 band_num,
+                  const ojph::rect &res_rect,
+                  const ojph::rect &band_rect) override {
+    band.component = comp_num;
+    band.resolution = res_num;
+    band.band = band_num;
+    band.res_x = res_rect.org.x;
+    band.res_y = res_rect.org.y;
+    band.res_width = res_rect.siz.w;
+    band.res_height = res_rect.siz.h;
+    band.width = band_rect.siz.w;
+    band.height = band_rect.siz.h;
+    row = 0;
+  }
+
+  bool push_line(const ojph::line_buf *line) override {
+    if (line->flags & ojph::line_buf::LFT_64BIT) {
+      wide = true;
+      return false;
+    }
+    band.is_float = (line->flags & ojph::line_buf::LFT_INTEGER) ? 0 : 1;
+    if (callback(context, &band, row++, line->p) == 0) {
+      return false;
+    }
+    return true;
+  }
+
+  bool wide = false;  // samples of more than 32 bits stopped the pull
+
+private:
+  ojph_subband_callback callback;
+  void *context;
+  ojph_subband band;
+  ui32 row = 0;
+};
+
+ojph_status decode_codestream_subbands(codestream &cs,
+                                       const uint8_t *codestream_data,
+                                       size_t length,
+                                       const DecodeRequest &request,
+                                       ojph::decode_stats *stats,
+                                       ojph_subband_callback callback,
+                                       void *context,
+                                       char *error_message,
+                                       size_t error_length) {
+  mem_infile input;
+  input.open(codestream_data, length);
+
+  cs.set_stats(stats);
+  cs.enable_resilience();
+  cs.read_headers(&input);
+  discard_resolutions(cs, request.discard_levels);
+
+  const param_siz siz = cs.access_siz();
+  const point extent = siz.get_image_extent();
+  const point tile_offset = siz.get_tile_offset();
+  const ojph::size tile = siz.get_tile_size();
+  if (extent.x - tile_offset.x > tile.w || extent.y - tile_offset.y > tile.h) {
+    write_error(error_message, error_length,
+                "subbands are only handed out for codestreams of one tile");
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (request.component_mask != 0) {
+    cs.restrict_input_components(request.component_mask);
+  }
+
+  cs.set_thread_pool(&shared_thread_pool());
+  cs.set_cancel_flag(request.cancel);
+  if (request.cleanup_only) {
+    cs.request_cleanup_pass_only();
+  }
+  limit_memory(cs, request, 0);
+  cs.create();
+
+  SubbandForwarder forwarder(callback, context);
+  if (!cs.pull_subbands(&forwarder)) {
+    if (forwarder.wide) {
+      write_error(error_message, error_length,
+                  "subband samples of more than 32 bits are not handed out");
+      return OJPH_STATUS_UNSUPPORTED;
+    }
+    return OJPH_STATUS_CANCELLED;
+  }
+
+  report_memory(cs, stats, 0);
+  cs.close();
+  input.close();
+  return OJPH_STATUS_OK;
+}
+
+} // namespace
+
+struct ojph_decoder {
+  codestream cs;
+  ojph::decode_stats stats;  // outlives the codeblock jobs of cs
+  bool used = false;
+
+  // Returns the codestream ready for a new frame; restart() keeps the
+  // allocator stores of the previous frame, so only growth reallocates,
+  // and the main header, so a frame with identical header bytes skips
+  // straight to its first tile-part.
+  codestream &prepare() {
+    if (used) {
+      cs.restart();
+    } else {
+      cs.enable_header_cache();
+    }
+    used = true;
+    return cs;
+  }
+};
+
+namespace {
+
+ojph_status decode_image_from(ojph_decoder *decoder,
+                              ojph::infile_base &input,
+                              const DecodeRequest &request,
+                              ojph_decoded_image *out_image,
+                              char *error_message,
+                              size_t error_length) {
+  std::memset(out_image, 0, sizeof(*out_image));
+
+  ojph::decode_stats stats;  // declared first, to outlive a local cs
+  StatsReport report(request);
+  try {
+    if (decoder) {
+      codestream &cs = decoder->prepare();
+      return decode_codestream(cs, input, request,
+                               report.collect(decoder->stats), out_image,
+                               error_message, error_length);
+    }
+    codestream cs;
+    return decode_codestream(cs, input, request, report.collect(stats),
+                             out_image, error_message, error_length);
+  } catch (const ojph::decode_cancelled &) {
+    write_error(error_message, error_length, "decoding was cancelled");
+    ojph_free_image(out_image);
+    return OJPH_STATUS_CANCELLED;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    ojph_free_image(out_image);
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    ojph_free_image(out_image);
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+ojph_status decode_image_with(ojph_decoder *decoder,
+                              const uint8_t *codestream_data,
+                              size_t length,
+                              const DecodeRequest &request,
+                              ojph_decoded_image *out_image,
+                              char *error_message,
+                              size_t error_length) {
+  if (!codestream_data || length == 0 || !out_image) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+
+  mem_infile input;
+  input.open(codestream_data, length);
+  return decode_image_from(decoder, input, request, out_image,
+                           error_message, error_length);
+}
+
+ojph_status decode_file_with(ojph_decoder *decoder,
+                             int fd,
+                             uint64_t offset,
+                             size_t length,
+                             const DecodeRequest &request,
+                             ojph_decoded_image *out_image,
+                             char *error_message,
+                             size_t error_length) {
+  if (fd < 0 || length == 0 || offset > INT64_MAX || !out_image) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+
+  ojph::mmap_infile input;
+  try {
+    input.open(fd, static_cast<ojph::si64>(offset), length);
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    std::memset(out_image, 0, sizeof(*out_image));
+    return OJPH_STATUS_ERROR;
+  }
+  return decode_image_from(decoder, input, request, out_image,
+                           error_message, error_length);
+}
+
+const char *progression_name(ojph_progression progression) {
+  switch (progression) {
+  case OJPH_PROGRESSION_LRCP: return "LRCP";
+  case OJPH_PROGRESSION_RLCP: return "RLCP";
+  case OJPH_PROGRESSION_PCRL: return "PCRL";
+  case OJPH_PROGRESSION_CPRL: return "CPRL";
+  default: return "RPCL";
+  }
+}
+
+ojph_progression progression_of(const param_cod &cod) {
+  const char *name = cod.get_progression_order_as_string();
+  const ojph_progression orders[] = {
+    OJPH_PROGRESSION_LRCP, OJPH_PROGRESSION_RLCP, OJPH_PROGRESSION_PCRL,
+    OJPH_PROGRESSION_CPRL};
+  for (ojph_progression order : orders) {
+    if (std::strcmp(name, progression_name(order)) == 0) {
+      return order;
+    }
+  }
+  return OJPH_PROGRESSION_RPCL;
+}
+
+// Describes the codestream whose main header `cs` has read. A default decode
+// is tried as far as the checks of read_layout, which write the reason it
+// would fail to the error message.
+void probe_codestream(codestream &cs,
+                      ojph_image_probe *probe,
+                      char *error_message,
+                      size_t error_length) {
+  param_siz siz = cs.access_siz();
+  param_cod cod = cs.access_cod();
+  const ui32 num_components = siz.get_num_components();
+  probe->components = static_cast<uint16_t>(num_components);
+  if (num_components > 0) {
+    probe->width = siz.get_recon_width(0);
+    probe->height = siz.get_recon_height(0);
+    probe->bit_depth = static_cast<uint16_t>(siz.get_bit_depth(0));
+    probe->is_signed = siz.is_signed(0) ? 1 : 0;
+  }
+  probe->uniform = 1;
+  for (ui32 c = 0; c < num_components; ++c) {
+    const point factors = siz.get_downsampling(c);
+    if (c < 4) {
+      probe->x_subsampling[c] = static_cast<uint8_t>(factors.x);
+      probe->y_subsampling[c] = static_cast<uint8_t>(factors.y);
+    }
+    if (factors.x != 1 || factors.y != 1) {
+      probe->subsampled = 1;
+    }
+    if (siz.get_bit_depth(c) != probe->bit_depth ||
+        (siz.is_signed(c) ? 1 : 0) != probe->is_signed ||
+        factors.x != siz.get_downsampling(0).x ||
+        factors.y != siz.get_downsampling(0).y) {
+      probe->uniform = 0;
+    }
+  }
+  probe->high_throughput = cod.is_high_throughput() ? 1 : 0;
+  probe->reversible = cod.is_reversible() ? 1 : 0;
+  probe->color_transform = cod.is_using_color_transform() ? 1 : 0;
+
+  const point extent = siz.get_image_extent();
+  const point tile_offset = siz.get_tile_offset();
+  const ojph::size tile = siz.get_tile_size();
+  probe->tile_width = tile.w;
+  probe->tile_height = tile.h;
+  if (tile.w > 0 && tile.h > 0) {
+    probe->tiles_across = (extent.x - tile_offset.x + tile.w - 1) / tile.w;
+    probe->tiles_down = (extent.y - tile_offset.y + tile.h - 1) / tile.h;
+  }
+  probe->decompositions = cod.get_num_decompositions();
+  probe->quality_layers = static_cast<uint32_t>(cod.get_num_layers());
+  const ojph::size blocks = cod.get_block_dims();
+  probe->block_width = blocks.w;
+  probe->block_height = blocks.h;
+  probe->progression = progression_of(cod);
+
+  ImageLayout layout;
+  if (read_layout(cs, 0, 0, layout, error_message, error_length)) {
+    probe->decodable = 1;
+    probe->decoded_size = layout.total_samples() * layout.bytes_per_sample();
+  }
+}
+
+// Parses `length` bytes of a possibly truncated codestream, without decoding
+// any codeblock, and returns how many fine resolution levels must be
+// discarded for the remaining ones to be complete.
+ui32 incomplete_levels(codestream &cs,
+                       const uint8_t *codestream_data,
+                       size_t length) {
+  mem_infile input;
+  input.open(codestream_data, length);
+  cs.enable_resilience();
+  cs.read_headers(&input);
+  cs.create();
+  const ui32 incomplete = cs.get_num_incomplete_resolutions();
+  cs.close();
+  return incomplete;
+}
+
+ojph_status decode_preview_with(ojph_decoder *decoder,
+                                const uint8_t *codestream_data,
+                                size_t length,
+                                DecodeRequest request,
+                                ojph_decoded_image *out_image,
+                                uint32_t *out_discard_levels,
+                                char *error_message,
+                                size_t error_length) {
+  if (!codestream_data || length == 0 || !out_image) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  std::memset(out_image, 0, sizeof(*out_image));
+
+  ui32 levels, incomplete;
+  try {
+    if (decoder) {
+      codestream &cs = decoder->prepare();
+      incomplete = incomplete_levels(cs, codestream_data, length);
+      levels = cs.access_cod().get_num_decompositions();
+    } else {
+      codestream cs;
+      incomplete = incomplete_levels(cs, codestream_data, length);
+      levels = cs.access_cod().get_num_decompositions();
+    }
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+  if (incomplete > levels) {
+    write_error(error_message, error_length,
+                "the data does not hold the lowest resolution yet");
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+
+  // a window would be relative to a level the caller cannot know
+  request.has_region = false;
+  request.discard_levels = std::min(std::max(request.discard_levels,
+                                             incomplete), levels);
+  const ojph_status status = decode_image_with(
+      decoder, codestream_data, length, request, out_image,
+      error_message, error_length);
+  if (status == OJPH_STATUS_OK && out_discard_levels) {
+    *out_discard_levels = request.discard_levels;
+  }
+  return status;
+}
+
+ojph_status decode_image_into_with(ojph_decoder *decoder,
+                                   const uint8_t *codestream_data,
+                                   size_t length,
+                                   const DecodeRequest &request,
+                                   void *destination,
+                                   size_t destination_size,
+                                   size_t row_pitch,
+                                   size_t alignment,
+                                   ojph_decoded_image *out_info,
+                                   size_t *required_size,
+                                   char *error_message,
+                                   size_t error_length) {
+  if (!codestream_data || length == 0 || !out_info ||
+      (alignment != 0 && !is_power_of_two(alignment))) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+
+  std::memset(out_info, 0, sizeof(*out_info));
+  if (required_size) {
+    *required_size = 0;
+  }
+
+  ojph::decode_stats stats;  // declared first, to outlive a local cs
+  StatsReport report(request);
+  try {
+    if (decoder) {
+      codestream &cs = decoder->prepare();
+      return decode_codestream_into(cs, codestream_data, length, request,
+                                    report.collect(decoder->stats),
+                                    destination, destination_size,
+                                    row_pitch, alignment,
+                                    out_info, required_size,
+                                    error_message, error_length);
+    }
+    codestream cs;
+    return decode_codestream_into(cs, codestream_data, length, request,
+                                  report.collect(stats),
+                                  destination, destination_size,
+                                  row_pitch, alignment,
+                                  out_info, required_size,
+                                  error_message, error_length);
+  } catch (const ojph::decode_cancelled &) {
+    write_error(error_message, error_length, "decoding was cancelled");
+    return OJPH_STATUS_CANCELLED;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+ojph_status decode_image_rows_with(ojph_decoder *decoder,
+                                   const uint8_t *codestream_data,
+                                   size_t length,
+                                   const DecodeRequest &request,
+                                   ui32 band_height,
+                                   ojph_row_callback sink,
+                                   void *context,
+                                   ojph_decoded_image *out_info,
+                                   char *error_message,
+                                   size_t error_length) {
+  if (!codestream_data || length == 0 || !sink || !out_info) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+
+  std::memset(out_info, 0, sizeof(*out_info));
+
+  ojph::decode_stats stats;  // declared first, to outlive a local cs
+  StatsReport report(request);
+  try {
+    if (decoder) {
+      codestream &cs = decoder->prepare();
+      return decode_codestream_rows(cs, codestream_data, length, request,
+                                    report.collect(decoder->stats),
+                                    band_height, sink, context, out_info,
+                                    error_message, error_length);
+    }
+    codestream cs;
+    return decode_codestream_rows(cs, codestream_data, length, request,
+                                  report.collect(stats), band_height, sink,
+                                  context, out_info,
+                                  error_message, error_length);
+  } catch (const ojph::decode_cancelled &) {
+    write_error(error_message, error_length, "decoding was cancelled");
+    return OJPH_STATUS_CANCELLED;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+ojph_status decode_subbands_with(ojph_decoder *decoder,
+                                 const uint8_t *codestream_data,
+                                 size_t length,
+                                 const DecodeRequest &request,
+                                 ojph_subband_callback callback,
+                                 void *context,
+                                 char *error_message,
+                                 size_t error_length) {
+  if (!codestream_data || length == 0 || !callback) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+
+  ojph::decode_stats stats;  // declared first, to outlive a local cs
+  StatsReport report(request);
+  try {
+    if (decoder) {
+      codestream &cs = decoder->prepare();
+      return decode_codestream_subbands(cs, codestream_data, length, request,
+                                        report.collect(decoder->stats),
+                                        callback, context,
+                                        error_message, error_length);
+    }
+    codestream cs;
+    return decode_codestream_subbands(cs, codestream_data, length, request,
+                                      report.collect(stats), callback,
+                                      context, error_message, error_length);
+  } catch (const ojph::decode_cancelled &) {
+    write_error(error_message, error_length, "decoding was cancelled");
+    return OJPH_STATUS_CANCELLED;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+struct FrameBatch {
+  const uint8_t *const *codestreams = nullptr;
+  const size_t *lengths = nullptr;
+  size_t count = 0;
+  ojph_decoded_image *images = nullptr;
+  ojph_status *statuses = nullptr;
+  std::atomic<size_t> next{0};
+
+  // Claims frames until none are left; one decoder context per thread lets
+  // consecutive frames of the same thread reuse their allocations.
+  void run() {
+    try {
+      ojph_decoder decoder;
+      for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+        statuses[i] = decode_image_with(&decoder, codestreams[i], lengths[i],
+                                        DecodeRequest(), &images[i],
+                                        nullptr, 0);
+      }
+    } catch (...) {
+      // Could not create a context; frames left behind are picked up by the
+      // other threads, or keep their OJPH_STATUS_ERROR preset.
+    }
+  }
+};
+
+struct FrameBatchWorker : ojph::worker_thread_base {
+  FrameBatch *batch = nullptr;
+  ojph::task_latch *latch = nullptr;
+
+  void execute() override {
+    batch->run();
+    latch->count_down();
+  }
+};
+
+// Checks what the codestream parameters would otherwise reject with less
+// helpful messages.
+bool check_encode_options(const ojph_encode_options &options,
+                          char *error_message,
+                          size_t error_length) {
+  const char *problem = nullptr;
+  if (options.width == 0 || options.height == 0 || options.components == 0) {
+    problem = "empty image";
+  } else if (options.bit_depth == 0 || options.bit_depth > 16) {
+    problem = "only samples of 1 to 16 bits can be encoded";
+  } else if (options.color_transform && options.components < 3) {
+    problem = "the colour transform needs three components";
+  } else if (options.layout != OJPH_LAYOUT_INTERLEAVED &&
+             options.layout != OJPH_LAYOUT_PLANAR) {
+    problem = "unknown sample layout";
+  } else if (options.decompositions > 32) {
+    problem = "too many decomposition levels";
+  } else {
+    const ui32 bw = options.block_width ? options.block_width : 64;
+    const ui32 bh = options.block_height ? options.block_height : 64;
+    if (!is_power_of_two(bw) || !is_power_of_two(bh) || bw < 4 || bh < 4 ||
+        (size_t)bw * bh > 4096) {
+      problem = "codeblock sizes must be powers of two from 4, with an area "
+                "of at most 4096 samples";
+    }
+  }
+  if (problem) {
+    write_error(error_message, error_length, problem);
+    return false;
+  }
+  return true;
+}
+
+// Five levels, or as many as leave the lowest resolution one sample wide;
+// at least one, even for an image a single sample wide or high.
+ui32 encode_decompositions(const ojph_encode_options &options) {
+  if (options.decompositions != 0) {
+    return options.decompositions;
+  }
+  const ui32 shortest = std::min(options.width, options.height);
+  ui32 levels = 5;
+  while (levels > 1 && (shortest >> levels) == 0) {
+    --levels;
+  }
+  return levels;
+}
+
+// Keeps the low `bit_depth` bits of each sample, sign-extended if signed.
+template <typename D, typename T>
+void store_samples(D *dst, const T *src, size_t step, ui32 width,
+                   ui32 bit_depth, bool is_signed) {
+  const ui32 unused_bits = 32 - bit_depth;
+  for (ui32 x = 0; x < width; ++x, src += step) {
+    const ui32 raw = static_cast<ui32>(*src) << unused_bits;
+    const si32 value = is_signed ? static_cast<si32>(raw) >> unused_bits
+                                 : static_cast<si32>(raw >> unused_bits);
+    dst[x] = static_cast<D>(value);
+  }
+}
+
+template <typename T>
+void fill_line(ojph::line_buf *line, const T *src, size_t step, ui32 width,
+               ui32 bit_depth, bool is_signed) {
+  if (!(line->flags & ojph::line_buf::LFT_INTEGER)) {
+    store_samples(line->f32, src, step, width, bit_depth, is_signed);
+  } else if (line->flags & ojph::line_buf::LFT_64BIT) {
+    store_samples(line->i64, src, step, width, bit_depth, is_signed);
+  } else {
+    store_samples(line->i32, src, step, width, bit_depth, is_signed);
+  }
+}
+
+// Sets `cs` up to encode the image `options` describe; `planar` pushes
+// lines a component at a time.
+void set_up_encoder(codestream &cs, const ojph_encode_options &options,
+                    bool planar) {
+  const ui32 width = options.width;
+  const ui32 height = options.height;
+  const ui32 components = options.components;
+  param_siz siz = cs.access_siz();
+  siz.set_image_extent(point(width, height));
+  siz.set_num_components(components);
+  for (ui32 c = 0; c < components; ++c) {
+    siz.set_component(c, point(1, 1), options.bit_depth,
+                      options.is_signed != 0);
+  }
+  siz.set_image_offset(point(0, 0));
+  siz.set_tile_offset(point(0, 0));
+  siz.set_tile_size(ojph::size(options.tile_width ? options.tile_width : width,
+                               options.tile_height ? options.tile_height
+                                                   : height));
+
+  param_cod cod = cs.access_cod();
+  cod.set_num_decomposition(encode_decompositions(options));
+  cod.set_block_dims(options.block_width ? options.block_width : 64,
+                     options.block_height ? options.block_height : 64);
+  cod.set_progression_order(progression_name(options.progression));
+  cod.set_color_transform(options.color_transform != 0);
+  cod.set_reversible(options.irreversible == 0);
+  if (options.irreversible && options.quantization_step > 0.0f) {
+    cs.access_qcd().set_irrev_quant(options.quantization_step);
+  }
+  cs.set_planar(planar);
+  cs.set_thread_pool(&shared_thread_pool());
+  cs.request_plt_marker(options.packet_lengths != 0);
+}
+
+// Feeds `count` lines to the encoder, in the component order it asks for;
+// `line` and `comp` carry the line to fill between calls. `rows` counts the
+// rows of each component taken from `pixels`, whose planes, if planar, are
+// `plane_pitch` bytes apart.
+void push_lines(codestream &cs, ojph::line_buf *&line, ui32 &comp,
+                std::vector<ui32> &rows, const uint8_t *pixels,
+                size_t row_pitch, size_t plane_pitch, size_t count,
+                const ojph_encode_options &options) {
+  const ui32 width = options.width;
+  const ui32 components = options.components;
+  const bool planar = options.layout == OJPH_LAYOUT_PLANAR;
+  const size_t sample_bytes = options.bit_depth <= 8 ? 1 : 2;
+  for (size_t i = 0; i < count; ++i) {
+    const ui32 y = rows[comp]++;
+    const uint8_t *row = pixels + y * row_pitch;
+    size_t step = 1;
+    if (planar) {
+      row += comp * plane_pitch;
+    } else {
+      row += comp * sample_bytes;
+      step = components;
+    }
+    if (sample_bytes == 1) {
+      fill_line(line, row, step, width, options.bit_depth,
+                options.is_signed != 0);
+    } else {
+      fill_line(line, reinterpret_cast<const uint16_t *>(row), step, width,
+                options.bit_depth, options.is_signed != 0);
+    }
+    line = cs.exchange(line, comp);
+  }
+}
+
+inline size_t packed_row_bytes(const ojph_encode_options &options) {
+  const size_t sample_bytes = options.bit_depth <= 8 ? 1 : 2;
+  const bool planar = options.layout == OJPH_LAYOUT_PLANAR;
+  return (size_t)options.width * sample_bytes *
+    (planar ? 1 : options.components);
+}
+
+// Encodes the image into `out`, which receives the whole codestream.
+void encode_codestream(const uint8_t *pixels,
+                       size_t row_pitch,
+                       const ojph_encode_options &options,
+                       ojph::outfile_base &out) {
+  const bool planar = options.layout == OJPH_LAYOUT_PLANAR;
+  if (row_pitch == 0) {
+    row_pitch = packed_row_bytes(options);
+  }
+
+  codestream cs;
+  // planar input is pushed a component at a time, unless the colour
+  // transform needs the three components of each row together
+  set_up_encoder(cs, options, planar && !options.color_transform);
+
+  cs.write_headers(&out);
+
+  std::vector<ui32> rows(options.components, 0);
+  ui32 comp = 0;
+  ojph::line_buf *line = cs.exchange(nullptr, comp);
+  push_lines(cs, line, comp, rows, pixels, row_pitch,
+             row_pitch * options.height,
+             (size_t)options.components * options.height, options);
+  cs.flush();
+}
+
+// Hands the bytes of a codestream to a write callback as they are produced.
+class callback_outfile : public ojph::outfile_base {
+public:
+  callback_outfile(ojph_write_callback write, void *context)
+      : write_bytes(write), context(context) {}
+
+  size_t write(const void *ptr, size_t size) override {
+    if (size != 0 &&
+        !write_bytes(context, static_cast<const uint8_t *>(ptr), size)) {
+      return 0;
+    }
+    written += size;
+    return size;
+  }
+  ojph::si64 tell() override { return written; }
+
+private:
+  ojph_write_callback write_bytes;
+  void *context;
+  ojph::si64 written = 0;
+};
+
+// Writes into a buffer the caller grows, so that the codestream is produced
+// where it is going to stay instead of being copied there afterwards.
+class sink_outfile : public ojph::outfile_base {
+public:
+  sink_outfile(ojph_grow_callback grow, void *context)
+      : grow(grow), context(context) {}
+
+  bool reserve(size_t size) {
+    if (size <= capacity) {
+      return true;
+    }
+    uint8_t *grown = grow(context, buffer, size);
+    if (!grown) {
+      return false;
+    }
+    buffer = grown;
+    capacity = size;
+    return true;
+  }
+
+  size_t write(const void *ptr, size_t size) override {
+    if (used + size > capacity &&
+        !reserve(std::max(used + size, capacity + capacity / 2))) {
+      return 0;
+    }
+    if (size != 0) {
+      std::memcpy(buffer + used, ptr, size);
+    }
+    used += size;
+    return size;
+  }
+  ojph::si64 tell() override { return (ojph::si64)used; }
+
+  uint8_t *data() const { return buffer; }
+  size_t size() const { return used; }
+
+private:
+  ojph_grow_callback grow;
+  void *context;
+  uint8_t *buffer = nullptr;
+  size_t capacity = 0;
+  size_t used = 0;
+};
+
+uint8_t *realloc_grow(void *, uint8_t *buffer, size_t capacity) {
+  return static_cast<uint8_t *>(std::realloc(buffer, capacity));
+}
+
+// Bytes of the samples of one frame as `ojph_encode_image` reads them.
+size_t frame_bytes(const ojph_encode_options &options, size_t row_pitch) {
+  const size_t planes =
+    options.layout == OJPH_LAYOUT_PLANAR ? options.components : 1;
+  return row_pitch * options.height * planes;
+}
+
+// Writes the header of an item of an encapsulated sequence, little endian,
+// as in every transfer syntax that encapsulates pixel data.
+void put_item_header(uint8_t *p, uint16_t element, uint32_t length) {
+  const uint8_t header[8] = {
+    0xFE, 0xFF, (uint8_t)element, (uint8_t)(element >> 8),
+    (uint8_t)length, (uint8_t)(length >> 8),
+    (uint8_t)(length >> 16), (uint8_t)(length >> 24)};
+  std::memcpy(p, header, sizeof(header));
+}
+
+} // namespace
+
+struct ojph_stream {
+  ojph::stream_infile input;
+  DecodeRequest request;
+  ojph_decoded_image image = {};
+  ojph_status status = OJPH_STATUS_ERROR;
+  char error[256] = "";
+  std::thread worker;
+
+  // Decodes on its own thread; reads that run ahead of the pushed bytes
+  // block there, so parsing keeps pace with the transfer. The shared pool
+  // is left free for codeblock jobs.
+  void start() {
+    worker = std::thread([this] {
+      status = decode_image_from(nullptr, input, request, &image,
+                                 error, sizeof(error));
+    });
+  }
+
+  // Ends the input and waits for the decode; safe to call more than once.
+  void join() {
+    input.finish();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+};
+
+namespace {
+
+// A decode held by an ojph_frame_cache. It sits in the cache's LRU list
+// while `cached`; one that did not fit lives until its last release.
+struct CachedFrame {
+  uint64_t frame_id = 0;
+  DecodeRequest request;
+  ojph_decoded_image image = {};
+  size_t bytes = 0;
+  ui32 references = 0;  // images handed out and not yet released
+  bool cached = false;
+  std::list<CachedFrame *>::iterator position;
+};
+
+inline const void *samples_of(const ojph_decoded_image &image) {
+  if (image.pixels32) {
+    return image.pixels32;
+  }
+  if (image.pixels16) {
+    return image.pixels16;
+  }
+  return image.pixels8;
+}
+
+inline size_t bytes_of(const ojph_decoded_image &image) {
+  const size_t sample_bytes =
+    image.pixels32 ? sizeof(float) : image.pixels16 ? sizeof(uint16_t) : 1;
+  return image.pixel_count * sample_bytes;
+}
+
+} // namespace
+
+struct ojph_frame_cache {
+  std::mutex mutex;
+  size_t budget = 0;
+  size_t bytes = 0;                // of the cached frames
+  std::list<CachedFrame *> lru;    // cached frames, most recently used first
+  std::unordered_multimap<uint64_t, CachedFrame *> frames;
+  std::unordered_map<const void *, CachedFrame *> handed_out;
+  std::unordered_set<uint64_t> pinned;
+  ui32 pyramid_levels = 0;
+  uint64_t hits = 0, misses = 0, evictions = 0, uncached = 0, reduced = 0;
+
+  ~ojph_frame_cache() {
+    for (CachedFrame *frame : lru) {
+      ojph_free_image(&frame->image);
+      delete frame;
+    }
+    for (const auto &entry : handed_out) {
+      if (!entry.second->cached) {
+        ojph_free_image(&entry.second->image);
+        delete entry.second;
+      }
+    }
+  }
+
+  CachedFrame *find(uint64_t frame_id, const DecodeRequest &request) {
+    const auto range = frames.equal_range(frame_id);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->request.stands_in_for(request)) {
+        return it->second;
+      }
+    }
+    return nullptr;
+  }
+
+  bool evictable(const CachedFrame *frame) const {
+    return frame->references == 0 && pinned.count(frame->frame_id) == 0;
+  }
+
+  // Takes a frame out of the cache, erasing it from `lru` unless the caller
+  // already has; the frame is deleted unless it is still handed out.
+  void drop(CachedFrame *frame, bool erase_position = true) {
+    if (erase_position) {
+      lru.erase(frame->position);
+    }
+    const auto range = frames.equal_range(frame->frame_id);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == frame) {
+        frames.erase(it);
+        break;
+      }
+    }
+    bytes -= frame->bytes;
+    frame->cached = false;
+    if (frame->references == 0) {
+      ojph_free_image(&frame->image);
+      delete frame;
+    }
+  }
+
+  // Drops the least recently used frames that may be dropped until
+  // `needed` more bytes fit the budget, or none is left.
+  void trim(size_t needed) {
+    auto it = lru.end();
+    while (bytes + needed > budget && it != lru.begin()) {
+      CachedFrame *frame = *--it;
+      if (evictable(frame)) {
+        it = lru.erase(it);
+        drop(frame, false);
+        ++evictions;
+      }
+    }
+  }
+
+  // Whether `needed` bytes can be made to fit by dropping frames.
+  bool has_room(size_t needed) const {
+    if (needed > budget) {
+      return false;
+    }
+    size_t locked = 0;
+    for (const CachedFrame *frame : lru) {
+      if (!evictable(frame)) {
+        locked += frame->bytes;
+      }
+    }
+    return locked <= budget - needed;
+  }
+
+  void hand_out(CachedFrame *frame, ojph_decoded_image *out_image) {
+    ++frame->references;
+    handed_out[samples_of(frame->image)] = frame;
+    *out_image = frame->image;
+  }
+
+  // Takes over a new decode, caching it if it fits, within the room left
+  // unless `may_evict`.
+  CachedFrame *add(uint64_t frame_id, const DecodeRequest &request,
+                   ojph_decoded_image &image, bool may_evict) {
+    CachedFrame *frame = new CachedFrame;
+    frame->frame_id = frame_id;
+    frame->request = request;
+    frame->request.stats = nullptr;
+    frame->request.pyramid = nullptr;
+    frame->image = image;
+    frame->bytes = bytes_of(image);
+    std::memset(&image, 0, sizeof(image));
+    if (may_evict ? has_room(frame->bytes)
+                  : frame->bytes <= budget && bytes <= budget - frame->bytes) {
+      trim(frame->bytes);
+      lru.push_front(frame);
+      frame->position = lru.begin();
+      frame->cached = true;
+      frames.emplace(frame_id, frame);
+      bytes += frame->bytes;
+    }
+    return frame;
+  }
+
+  // Caches the coarser images of a decode in the room left, without
+  // evicting anything for them, down to the first that does not fit.
+  void add_pyramid(uint64_t frame_id, DecodeRequest request,
+                   std::vector<ojph_decoded_image> &images) {
+    bool fits = true;
+    for (ojph_decoded_image &image : images) {
+      ++request.discard_levels;
+      if (fits && find(frame_id, request) == nullptr) {
+        CachedFrame *frame = add(frame_id, request, image, false);
+        fits = frame->cached;
+        if (fits) {
+          ++reduced;
+        } else {
+          ojph_free_image(&frame->image);
+          delete frame;
+        }
+      }
+      ojph_free_image(&image);
+    }
+    images.clear();
+  }
+};
+
+namespace {
+
+struct DecodeJob {
+  uint64_t id = 0;
+  int32_t priority = 0;
+  std::vector<uint8_t> codestream;
+  DecodeRequest request;
+  ojph_job_callback callback = nullptr;
+  void *context = nullptr;
+  std::atomic<bool> stop{false};  // the cancel flag of its codestream
+  bool cancelled = false;         // by the caller, rather than preempted
+};
+
+// Whether job `a` starts after job `b`; ties go to the job queued first,
+// which keeps a preempted job ahead of those queued after it.
+inline bool starts_after(const DecodeJob *a, const DecodeJob *b) {
+  return a->priority != b->priority ? a->priority < b->priority
+                                    : a->id > b->id;
+}
+
+void report(DecodeJob *job, ojph_status status, ojph_decoded_image *image,
+            const char *error_message) {
+  job->callback(job->context, job->id, status, image, error_message);
+  delete job;
+}
+
+void report_cancelled(DecodeJob *job) {
+  ojph_decoded_image image = {};
+  report(job, OJPH_STATUS_CANCELLED, &image, "decoding was cancelled");
+}
+
+// One decode slot of a queue. It runs a single job each time the pool
+// executes it, then adds itself again; a runner picked up by a thread that
+// waits for its own codeblocks thus holds that thread for one frame only.
+struct JobRunner : ojph::worker_thread_base {
+  ojph_decode_queue *queue = nullptr;
+  ojph_decoder decoder;  // shared by the jobs of this slot
+
+  void execute() override;
+};
+
+} // namespace
+
+struct ojph_decode_queue {
+  std::mutex mutex;
+  std::condition_variable runner_idle;
+  ojph::thread_pool own_pool;  // used if the shared pool has no threads
+  ojph::thread_pool *pool = nullptr;
+  std::vector<JobRunner> runners;
+  std::vector<JobRunner *> idle;      // never left while jobs wait
+  std::vector<DecodeJob *> waiting;   // a heap ordered by starts_after
+  std::vector<DecodeJob *> running;
+  uint64_t last_id = 0;
+
+  explicit ojph_decode_queue(size_t slots) : runners(slots) {
+    for (JobRunner &runner : runners) {
+      runner.queue = this;
+      idle.push_back(&runner);
+    }
+  }
+
+  // Claims an idle runner for a job of `priority` that was just made to
+  // wait. Without one, the least urgent running job below `priority` is
+  // told to stop; it is queued again when it does. The runner returned, if
+  // any, is to be added to the pool once the mutex is released.
+  JobRunner *make_room(int32_t priority) {
+    if (!idle.empty()) {
+      JobRunner *runner = idle.back();
+      idle.pop_back();
+      return runner;
+    }
+    DecodeJob *victim = nullptr;
+    for (DecodeJob *job : running) {
+      if (job->priority < priority &&
+          !job->stop.load(std::memory_order_relaxed) &&
+          (!victim || starts_after(job, victim))) {
+        victim = job;
+      }
+    }
+    if (victim) {
+      victim->stop.store(true, std::memory_order_relaxed);
+    }
+    return nullptr;
+  }
+
+  // The most urgent waiting job, now running, or NULL after idling `runner`.
+  DecodeJob *take(JobRunner *runner) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (waiting.empty()) {
+      idle.push_back(runner);
+      runner_idle.notify_all();
+      return nullptr;
+    }
+    std::pop_heap(waiting.begin(), waiting.end(), starts_after);
+    DecodeJob *job = waiting.back();
+    waiting.pop_back();
+    running.push_back(job);
+    return job;
+  }
+
+  // Ends the run of `job`. Returns false if it was preempted before it
+  // completed, and is waiting again; `status` becomes
+  // OJPH_STATUS_CANCELLED if the caller cancelled it.
+  bool finish(DecodeJob *job, ojph_status &status) {
+    std::lock_guard<std::mutex> lock(mutex);
+    running.erase(std::find(running.begin(), running.end(), job));
+    if (job->cancelled) {
+      status = OJPH_STATUS_CANCELLED;
+    } else if (status != OJPH_STATUS_OK &&
+               job->stop.load(std::memory_order_relaxed)) {
+      job->stop.store(false, std::memory_order_relaxed);
+      waiting.push_back(job);
+      std::push_heap(waiting.begin(), waiting.end(), starts_after);
+      return false;
+    }
+    return true;
+  }
+
+  // Waits until no runner is on the pool, running pool tasks meanwhile,
+  // since an idle thread may be the one that would execute a runner.
+  void wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (idle.size() < runners.size()) {
+      lock.unlock();
+      const bool ran = pool->run_pending_task();
+      lock.lock();
+      if (!ran && idle.size() < runners.size()) {
+        runner_idle.wait(lock);
+      }
+    }
+  }
+
+  std::vector<DecodeJob *>::iterator find(std::vector<DecodeJob *> &jobs,
+                                          uint64_t job_id) {
+    return std::find_if(jobs.begin(), jobs.end(), [job_id](DecodeJob *job) {
+      return job->id == job_id;
+    });
+  }
+};
+
+namespace {
+
+void JobRunner::execute() {
+  DecodeJob *job = queue->take(this);
+  if (!job) {
+    return;
+  }
+  DecodeRequest request = job->request;
+  request.cancel = &job->stop;
+  ojph_decoded_image image;
+  char error[256] = "";
+  ojph_status status = decode_image_with(&decoder, job->codestream.data(),
+                                         job->codestream.size(), request,
+                                         &image, error, sizeof(error));
+  if (queue->finish(job, status)) {
+    if (status == OJPH_STATUS_CANCELLED) {
+      ojph_free_image(&image);
+      report_cancelled(job);
+    } else {
+      report(job, status, &image, error);
+    }
+  }
+  queue->pool->add_task(this);
+}
+
+} // namespace
+
+extern "C" ojph_status ojph_probe_image(const uint8_t *codestream_data,
+                                        size_t length,
+                                        ojph_image_probe *out_probe,
+                                        char *error_message,
+                                        size_t error_length) {
+  if (!codestream_data || length == 0 || !out_probe) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  std::memset(out_probe, 0, sizeof(*out_probe));
+  try {
+    mem_infile input;
+    input.open(codestream_data, length);
+    codestream cs;
+    cs.read_headers(&input);
+    probe_codestream(cs, out_probe, error_message, error_length);
+    cs.close();
+    return OJPH_STATUS_OK;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+extern "C" ojph_status ojph_decode_image(const uint8_t *codestream_data,
+                                          size_t length,
+                                          ojph_decoded_image *out_image,
+                                          char *error_message,
+                                          size_t error_length) {
+  return decode_image_with(nullptr, codestream_data, length, DecodeRequest(),
+                           out_image, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_image_into(const uint8_t *codestream_data,
+                                               size_t length,
+                                               void *destination,
+                                               size_t destination_size,
+                                               size_t row_pitch,
+                                               size_t alignment,
+                                               ojph_decoded_image *out_info,
+                                               size_t *required_size,
+                                               char *error_message,
+                                               size_t error_length) {
+  return decode_image_into_with(nullptr, codestream_data, length,
+                                DecodeRequest(), destination, destination_size,
+                                row_pitch, alignment, out_info, required_size,
+                                error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_thumbnail(const uint8_t *codestream_data,
+                                              size_t length,
+                                              uint32_t discard_levels,
+                                              ojph_decoded_image *out_image,
+                                              char *error_message,
+                                              size_t error_length) {
+  DecodeRequest request;
+  request.discard_levels = discard_levels;
+  return decode_image_with(nullptr, codestream_data, length, request,
+                           out_image, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_thumbnail_into(const uint8_t *codestream_data,
+                                                   size_t length,
+                                                   uint32_t discard_levels,
+                                                   void *destination,
+                                                   size_t destination_size,
+                                                   size_t row_pitch,
+                                                   size_t alignment,
+                                                   ojph_decoded_image *out_info,
+                                                   size_t *required_size,
+                                                   char *error_message,
+                                                   size_t error_length) {
+  DecodeRequest request;
+  request.discard_levels = discard_levels;
+  return decode_image_into_with(nullptr, codestream_data, length, request,
+                                destination, destination_size,
+                                row_pitch, alignment, out_info, required_size,
+                                error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_region(const uint8_t *codestream_data,
+                                           size_t length,
+                                           uint32_t x,
+                                           uint32_t y,
+                                           uint32_t width,
+                                           uint32_t height,
+                                           uint32_t discard_levels,
+                                           ojph_decoded_image *out_image,
+                                           char *error_message,
+                                           size_t error_length) {
+  DecodeRequest request;
+  request.discard_levels = discard_levels;
+  request.has_region = true;
+  request.region_x = x;
+  request.region_y = y;
+  request.region_width = width;
+  request.region_height = height;
+  return decode_image_with(nullptr, codestream_data, length, request,
+                           out_image, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_region_into(const uint8_t *codestream_data,
+                                                size_t length,
+                                                uint32_t x,
+                                                uint32_t y,
+                                                uint32_t width,
+                                                uint32_t height,
+                                                uint32_t discard_levels,
+                                                void *destination,
+                                                size_t destination_size,
+                                                size_t row_pitch,
+                                                size_t alignment,
+                                                ojph_decoded_image *out_info,
+                                                size_t *required_size,
+                                                char *error_message,
+                                                size_t error_length) {
+  DecodeRequest request;
+  request.discard_levels = discard_levels;
+  request.has_region = true;
+  request.region_x = x;
+  request.region_y = y;
+  request.region_width = width;
+  request.region_height = height;
+  return decode_image_into_with(nullptr, codestream_data, length, request,
+                                destination, destination_size,
+                                row_pitch, alignment, out_info, required_size,
+                                error_message, error_length);
+}
+
+extern "C" ojph_decoder *ojph_decoder_create(void) {
+  try {
+    return new ojph_decoder;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+extern "C" void ojph_decoder_destroy(ojph_decoder *decoder) {
+  delete decoder;
+}
+
+extern "C" ojph_status ojph_decoder_decode(ojph_decoder *decoder,
+                                            const uint8_t *codestream_data,
+                                            size_t length,
+                                            ojph_decoded_image *out_image,
+                                            char *error_message,
+                                            size_t error_length) {
+  if (!decoder) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  return decode_image_with(decoder, codestream_data, length, DecodeRequest(),
+                           out_image, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decoder_decode_into(ojph_decoder *decoder,
+                                                 const uint8_t *codestream_data,
+                                                 size_t length,
+                                                 void *destination,
+                                                 size_t destination_size,
+                                                 size_t row_pitch,
+                                                 size_t alignment,
+                                                 ojph_decoded_image *out_info,
+                                                 size_t *required_size,
+                                                 char *error_message,
+                                                 size_t error_length) {
+  if (!decoder) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  return decode_image_into_with(decoder, codestream_data, length,
+                                DecodeRequest(), destination, destination_size,
+                                row_pitch, alignment, out_info, required_size,
+                                error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_with_options(
+    ojph_decoder *decoder,
+    const uint8_t *codestream_data,
+    size_t length,
+    const ojph_decode_options *options,
+    ojph_decoded_image *out_image,
+    char *error_message,
+    size_t error_length) {
+  return decode_image_with(decoder, codestream_data, length,
+                           request_from(options), out_image,
+                           error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_file(ojph_decoder *decoder,
+                                        int fd,
+                                        uint64_t offset,
+                                        size_t length,
+                                        const ojph_decode_options *options,
+                                        ojph_decoded_image *out_image,
+                                        char *error_message,
+                                        size_t error_length) {
+  return decode_file_with(decoder, fd, offset, length, request_from(options),
+                          out_image, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_preview(ojph_decoder *decoder,
+                                           const uint8_t *codestream_data,
+                                           size_t length,
+                                           const ojph_decode_options *options,
+                                           ojph_decoded_image *out_image,
+                                           uint32_t *out_discard_levels,
+                                           char *error_message,
+                                           size_t error_length) {
+  return decode_preview_with(decoder, codestream_data, length,
+                             request_from(options), out_image,
+                             out_discard_levels, error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_into_with_options(
+    ojph_decoder *decoder,
+    const uint8_t *codestream_data,
+    size_t length,
+    const ojph_decode_options *options,
+    void *destination,
+    size_t destination_size,
+    size_t row_pitch,
+    size_t alignment,
+    ojph_decoded_image *out_info,
+    size_t *required_size,
+    char *error_message,
+    size_t error_length) {
+  return decode_image_into_with(decoder, codestream_data, length,
+                                request_from(options), destination,
+                                destination_size, row_pitch, alignment,
+                                out_info, required_size,
+                                error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_rows(ojph_decoder *decoder,
+                                        const uint8_t *codestream_data,
+                                        size_t length,
+                                        const ojph_decode_options *options,
+                                        uint32_t band_height,
+                                        ojph_row_callback callback,
+                                        void *context,
+                                        ojph_decoded_image *out_info,
+                                        char *error_message,
+                                        size_t error_length) {
+  return decode_image_rows_with(decoder, codestream_data, length,
+                                request_from(options), band_height,
+                                callback, context, out_info,
+                                error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_subbands(ojph_decoder *decoder,
+                                            const uint8_t *codestream_data,
+                                            size_t length,
+                                            const ojph_decode_options *options,
+                                            ojph_subband_callback callback,
+                                            void *context,
+                                            char *error_message,
+                                            size_t error_length) {
+  return decode_subbands_with(decoder, codestream_data, length,
+                              request_from(options), callback, context,
+                              error_message, error_length);
+}
+
+extern "C" ojph_status ojph_decode_frames(const uint8_t *const *codestreams,
+                                           const size_t *lengths,
+                                           size_t frame_count,
+                                           ojph_decoded_image *out_images,
+                                           ojph_status *out_statuses,
+                                           uint32_t max_threads) {
+  if (frame_count == 0) {
+    return OJPH_STATUS_OK;
+  }
+  if (!codestreams || !lengths || !out_images || !out_statuses) {
+    return OJPH_STATUS_ERROR;
+  }
+
+  for (size_t i = 0; i < frame_count; ++i) {
+    std::memset(&out_images[i], 0, sizeof(out_images[i]));
+    out_statuses[i] = OJPH_STATUS_ERROR;
+  }
+
+  FrameBatch batch;
+  batch.codestreams = codestreams;
+  batch.lengths = lengths;
+  batch.count = frame_count;
+  batch.images = out_images;
+  batch.statuses = out_statuses;
+
+  ojph::thread_pool &pool = shared_thread_pool();
+  size_t helpers = pool.get_num_threads();
+  if (max_threads != 0) {
+    helpers = std::min(helpers, static_cast<size_t>(max_threads - 1));
+  }
+  helpers = std::min(helpers, frame_count - 1);
+
+  std::vector<FrameBatchWorker> workers(helpers);
+  ojph::task_latch latch(static_cast<ui32>(helpers));
+  for (FrameBatchWorker &worker : workers) {
+    worker.batch = &batch;
+    worker.latch = &latch;
+    pool.add_task(&worker);
+  }
+
+  batch.run();
+  // Help with queued work rather than sleeping while helpers are still busy.
+  while (!latch.is_done() && pool.run_pending_task()) {
+  }
+  latch.wait();
+
+  for (size_t i = 0; i < frame_count; ++i) {
+    if (out_statuses[i] != OJPH_STATUS_OK) {
+      return out_statuses[i];
+    }
+  }
+  return OJPH_STATUS_OK;
+}
+
+extern "C" ojph_stream *ojph_stream_create(
+    const ojph_decode_options *options) {
+  ojph_stream *stream = nullptr;
+  try {
+    stream = new ojph_stream;
+    stream->request = request_from(options);
+    stream->start();
+    return stream;
+  } catch (...) {
+    delete stream;
+    return nullptr;
+  }
+}
+
+extern "C" ojph_status ojph_stream_push(ojph_stream *stream,
+                                         const uint8_t *data,
+                                         size_t length) {
+  if (!stream || (!data && length != 0) || !stream->worker.joinable()) {
+    return OJPH_STATUS_ERROR;
+  }
+  try {
+    stream->input.push(data, length);
+    return OJPH_STATUS_OK;
+  } catch (...) {
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+extern "C" ojph_status ojph_stream_finish(ojph_stream *stream,
+                                           ojph_decoded_image *out_image,
+                                           char *error_message,
+                                           size_t error_length) {
+  if (!stream || !out_image || !stream->worker.joinable()) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  stream->join();
+  *out_image = stream->image;
+  std::memset(&stream->image, 0, sizeof(stream->image));
+  write_error(error_message, error_length, stream->error);
+  return stream->status;
+}
+
+extern "C" void ojph_stream_destroy(ojph_stream *stream) {
+  if (!stream) {
+    return;
+  }
+  stream->join();
+  ojph_free_image(&stream->image);
+  delete stream;
+}
+
+extern "C" ojph_decode_queue *ojph_decode_queue_create(uint32_t max_jobs) {
+  try {
+    ojph::thread_pool *pool = &shared_thread_pool();
+    const size_t threads = std::max(pool->get_num_threads(), (size_t)1);
+    ojph_decode_queue *queue =
+        new ojph_decode_queue(max_jobs ? max_jobs : threads);
+    if (pool->get_num_threads() == 0) {
+      queue->own_pool.init(1);
+      pool = &queue->own_pool;
+    }
+    queue->pool = pool;
+    return queue;
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+extern "C" uint64_t ojph_decode_queue_submit(
+    ojph_decode_queue *queue,
+    const uint8_t *codestream_data,
+    size_t length,
+    const ojph_decode_options *options,
+    int32_t priority,
+    ojph_job_callback callback,
+    void *context) {
+  if (!queue || !codestream_data || length == 0 || !callback) {
+    return 0;
+  }
+  DecodeJob *job = new (std::nothrow) DecodeJob;
+  if (!job) {
+    return 0;
+  }
+  job->priority = priority;
+  job->request = request_from(options);
+  job->callback = callback;
+  job->context = context;
+  JobRunner *runner;
+  uint64_t job_id;  // read before the job can run, and be deleted
+  try {
+    job->codestream.assign(codestream_data, codestream_data + length);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->waiting.push_back(job);
+    job_id = job->id = ++queue->last_id;
+    std::push_heap(queue->waiting.begin(), queue->waiting.end(),
+                   starts_after);
+    runner = queue->make_room(priority);
+  } catch (...) {
+    delete job;
+    return 0;
+  }
+  if (runner) {
+    queue->pool->add_task(runner);
+  }
+  return job_id;
+}
+
+extern "C" ojph_status ojph_decode_queue_set_priority(ojph_decode_queue *queue,
+                                                      uint64_t job_id,
+                                                      int32_t priority) {
+  if (!queue) {
+    return OJPH_STATUS_ERROR;
+  }
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  auto waiting = queue->find(queue->waiting, job_id);
+  if (waiting != queue->waiting.end()) {
+    (*waiting)->priority = priority;
+    std::make_heap(queue->waiting.begin(), queue->waiting.end(),
+                   starts_after);
+    // no runner is idle while jobs wait, so at most a job is preempted
+    queue->make_room(priority);
+    return OJPH_STATUS_OK;
+  }
+  auto running = queue->find(queue->running, job_id);
+  if (running == queue->running.end()) {
+    return OJPH_STATUS_ERROR;
+  }
+  (*running)->priority = priority;
+  return OJPH_STATUS_OK;
+}
+
+extern "C" ojph_status ojph_decode_queue_cancel(ojph_decode_queue *queue,
+                                                uint64_t job_id) {
+  if (!queue) {
+    return OJPH_STATUS_ERROR;
+  }
+  DecodeJob *job;
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    auto waiting = queue->find(queue->waiting, job_id);
+    if (waiting == queue->waiting.end()) {
+      auto running = queue->find(queue->running, job_id);
+      if (running == queue->running.end() || (*running)->cancelled) {
+        return OJPH_STATUS_ERROR;
+      }
+      (*running)->cancelled = true;
+      (*running)->stop.store(true, std::memory_order_relaxed);
+      return OJPH_STATUS_OK;
+    }
+    job = *waiting;
+    queue->waiting.erase(waiting);
+    std::make_heap(queue->waiting.begin(), queue->waiting.end(),
+                   starts_after);
+  }
+  report_cancelled(job);
+  return OJPH_STATUS_OK;
+}
+
+extern "C" void ojph_decode_queue_destroy(ojph_decode_queue *queue) {
+  if (!queue) {
+    return;
+  }
+  std::vector<DecodeJob *> waiting;
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    waiting.swap(queue->waiting);
+    for (DecodeJob *job : queue->running) {
+      job->cancelled = true;
+      job->stop.store(true, std::memory_order_relaxed);
+    }
+  }
+  for (DecodeJob *job : waiting) {
+    report_cancelled(job);
+  }
+  queue->wait_idle();
+  delete queue;
+}
+
+extern "C" ojph_frame_cache *ojph_frame_cache_create(size_t budget_bytes) {
+  ojph_frame_cache *cache = new (std::nothrow) ojph_frame_cache;
+  if (cache) {
+    cache->budget = budget_bytes;
+  }
+  return cache;
+}
+
+extern "C" void ojph_frame_cache_destroy(ojph_frame_cache *cache) {
+  delete cache;
+}
+
+extern "C" void ojph_frame_cache_set_budget(ojph_frame_cache *cache,
+                                            size_t budget_bytes) {
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->budget = budget_bytes;
+  cache->trim(0);
+}
+
+extern "C" void ojph_frame_cache_set_pyramid_levels(ojph_frame_cache *cache,
+                                                    uint32_t levels) {
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  cache->pyramid_levels = levels;
+}
+
+extern "C" ojph_status ojph_frame_cache_decode(
+    ojph_frame_cache *cache,
+    ojph_decoder *decoder,
+    uint64_t frame_id,
+    const uint8_t *codestream_data,
+    size_t length,
+    const ojph_decode_options *options,
+    ojph_decoded_image *out_image,
+    char *error_message,
+    size_t error_length) {
+  if (!cache || !out_image) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  const DecodeRequest request = request_from(options);
+  DecodeRequest decode = request;
+  {
+    StatsReport report(request);
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    if (CachedFrame *frame = cache->find(frame_id, request)) {
+      cache->lru.splice(cache->lru.begin(), cache->lru, frame->position);
+      cache->hand_out(frame, out_image);
+      ++cache->hits;
+      return OJPH_STATUS_OK;
+    }
+    ++cache->misses;
+    decode.pyramid_levels = cache->pyramid_levels;
+  }
+
+  // Decoded without the lock, so other frames can be served meanwhile; a
+  // thread that decoded the same frame first wins.
+  std::vector<ojph_decoded_image> pyramid;
+  decode.pyramid = &pyramid;
+  ojph_decoded_image image;
+  const ojph_status status =
+    decode_image_with(decoder, codestream_data, length, decode, &image,
+                      error_message, error_length);
+  if (status != OJPH_STATUS_OK) {
+    for (ojph_decoded_image &reduced : pyramid) {
+      ojph_free_image(&reduced);
+    }
+    std::memset(out_image, 0, sizeof(*out_image));
+    return status;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  CachedFrame *frame = cache->find(frame_id, request);
+  if (frame) {
+    ojph_free_image(&image);
+  } else {
+    frame = cache->add(frame_id, request, image, true);
+    cache->uncached += frame->cached ? 0 : 1;
+  }
+  cache->hand_out(frame, out_image);
+  cache->add_pyramid(frame_id, request, pyramid);
+  return OJPH_STATUS_OK;
+}
+
+extern "C" void ojph_frame_cache_release(ojph_frame_cache *cache,
+                                         ojph_decoded_image *image) {
+  if (!cache || !image) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  const auto it = cache->handed_out.find(samples_of(*image));
+  std::memset(image, 0, sizeof(*image));
+  if (it == cache->handed_out.end()) {
+    return;
+  }
+  CachedFrame *frame = it->second;
+  if (--frame->references > 0) {
+    return;
+  }
+  cache->handed_out.erase(it);
+  if (!frame->cached) {
+    ojph_free_image(&frame->image);
+    delete frame;
+  } else if (cache->bytes > cache->budget) {
+    cache->trim(0);  // over the budget since it shrank
+  }
+}
+
+extern "C" void ojph_frame_cache_pin(ojph_frame_cache *cache,
+                                     uint64_t frame_id,
+                                     int pinned) {
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  if (pinned) {
+    cache->pinned.insert(frame_id);
+  } else if (cache->pinned.erase(frame_id) && cache->bytes > cache->budget) {
+    cache->trim(0);
+  }
+}
+
+extern "C" void ojph_frame_cache_evict(ojph_frame_cache *cache,
+                                       uint64_t frame_id) {
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  std::vector<CachedFrame *> victims;
+  const auto range = cache->frames.equal_range(frame_id);
+  for (auto it = range.first; it != range.second; ++it) {
+    victims.push_back(it->second);
+  }
+  for (CachedFrame *frame : victims) {
+    cache->drop(frame);
+  }
+}
+
+extern "C" void ojph_frame_cache_clear(ojph_frame_cache *cache) {
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  while (!cache->lru.empty()) {
+    cache->drop(cache->lru.front());
+  }
+}
+
+extern "C" void ojph_frame_cache_get_stats(ojph_frame_cache *cache,
+                                           ojph_frame_cache_stats *out_stats) {
+  if (!out_stats) {
+    return;
+  }
+  std::memset(out_stats, 0, sizeof(*out_stats));
+  if (!cache) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  out_stats->hits = cache->hits;
+  out_stats->misses = cache->misses;
+  out_stats->evictions = cache->evictions;
+  out_stats->uncached = cache->uncached;
+  out_stats->reduced = cache->reduced;
+  out_stats->cached_bytes = cache->bytes;
+  out_stats->budget_bytes = cache->budget;
+  out_stats->frames = static_cast<uint32_t>(cache->lru.size());
+  out_stats->handed_out = static_cast<uint32_t>(cache->handed_out.size());
+  for (const CachedFrame *frame : cache->lru) {
+    if (!cache->evictable(frame)) {
+      out_stats->locked_bytes += frame->bytes;
+    }
+  }
+}
+
+extern "C" ojph_status ojph_encode_image(const void *pixels,
+                                         size_t row_pitch,
+                                         const ojph_encode_options *options,
+                                         uint8_t **out_codestream,
+                                         size_t *out_length,
+                                         char *error_message,
+                                         size_t error_length) {
+  if (!pixels || !options || !out_codestream || !out_length) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  *out_codestream = nullptr;
+  *out_length = 0;
+  if (!check_encode_options(*options, error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+
+  sink_outfile out(realloc_grow, nullptr);
+  try {
+    // a lossless codestream is rarely above half the samples; the
+    // buffer grows from there if need be, and is trimmed at the end
+    const size_t raw = frame_bytes(*options, row_pitch ? row_pitch
+                                     : packed_row_bytes(*options));
+    if (!out.reserve(raw / 2 + 4096)) {
+      write_error(error_message, error_length, "memory allocation failure");
+      return OJPH_STATUS_ERROR;
+    }
+    encode_codestream(static_cast<const uint8_t *>(pixels), row_pitch,
+                      *options, out);
+    uint8_t *result = out.data();
+    if (uint8_t *trimmed = realloc_grow(nullptr, result, out.size())) {
+      result = trimmed;
+    }
+    *out_codestream = result;
+    *out_length = out.size();
+    return OJPH_STATUS_OK;
+  } catch (const std::exception &ex) {
+    std::free(out.data());
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    std::free(out.data());
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+extern "C" void ojph_free_codestream(uint8_t *codestream) {
+  std::free(codestream);
+}
+
+extern "C" ojph_status ojph_encode_frames(const void *pixels,
+                                          size_t row_pitch,
+                                          size_t frame_pitch,
+                                          uint32_t frame_count,
+                                          const ojph_encode_options *options,
+                                          const ojph_frames_options *frames,
+                                          ojph_frame_fragment *out_fragments,
+                                          size_t *out_length,
+                                          char *error_message,
+                                          size_t error_length) {
+  if (!pixels || !options || !frames || !frames->grow || !out_fragments ||
+      !out_length || frame_count == 0) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  *out_length = 0;
+  if (!check_encode_options(*options, error_message, error_length)) {
+    return OJPH_STATUS_UNSUPPORTED;
+  }
+  if (row_pitch == 0) {
+    row_pitch = packed_row_bytes(*options);
+  }
+  const size_t raw = frame_bytes(*options, row_pitch);
+  if (frame_pitch == 0) {
+    frame_pitch = raw;
+  }
+
+  sink_outfile out(frames->grow, frames->context);
+  try {
+    const size_t table = frames->basic_offset_table ? 4 * (size_t)frame_count
+                                                    : 0;
+    size_t expected = 0;
+    if (frames->expected_ratio > 0) {
+      expected = (size_t)((double)raw / frames->expected_ratio) + 16;
+      expected += expected / 16;  // room for a frame coding a little worse
+    }
+    if (!out.reserve(8 + table + (expected + 8) * frame_count + 8)) {
+      write_error(error_message, error_length, "memory allocation failure");
+      return OJPH_STATUS_ERROR;
+    }
+
+    // the Basic Offset Table item, filled in once the frames are placed
+    uint8_t header[8] = {};
+    out.write(header, sizeof(header));
+    for (size_t i = 0; i < table; i += 4) {
+      out.write(header, 4);
+    }
+    const size_t first_item = out.size();
+
+    const uint8_t *src = static_cast<const uint8_t *>(pixels);
+    for (uint32_t f = 0; f < frame_count; ++f, src += frame_pitch) {
+      const size_t item = out.size();
+      if (out.write(header, sizeof(header)) != sizeof(header)) {
+        throw std::bad_alloc();
+      }
+      encode_codestream(src, row_pitch, *options, out);
+      const size_t length = out.size() - item - 8;
+      if (length & 1) {  // items are of even length
+        const uint8_t pad = 0;
+        if (out.write(&pad, 1) != 1) {
+          throw std::bad_alloc();
+        }
+      }
+      if (out.size() - item - 8 > 0xFFFFFFFEu) {
+        write_error(error_message, error_length,
+                    "a frame is too large for a fragment");
+        return OJPH_STATUS_ERROR;
+      }
+      put_item_header(out.data() + item, 0xE000,
+                      (uint32_t)(out.size() - item - 8));
+      out_fragments[f].offset = item - first_item;
+      out_fragments[f].length = length;
+    }
+
+    if (table != 0) {
+      if (out_fragments[frame_count - 1].offset > 0xFFFFFFFFu) {
+        write_error(error_message, error_length,
+                    "the offsets do not fit a Basic Offset Table; use the "
+                    "Extended Offset Table instead");
+        return OJPH_STATUS_ERROR;
+      }
+      uint8_t *entry = out.data() + 8;
+      for (uint32_t f = 0; f < frame_count; ++f, entry += 4) {
+        const uint32_t v = (uint32_t)out_fragments[f].offset;
+        const uint8_t le[4] = {(uint8_t)v, (uint8_t)(v >> 8),
+                               (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        std::memcpy(entry, le, 4);
+      }
+    }
+    put_item_header(out.data(), 0xE000, (uint32_t)table);
+
+    put_item_header(header, 0xE0DD, 0);  // sequence delimitation item
+    if (out.write(header, sizeof(header)) != sizeof(header)) {
+      throw std::bad_alloc();
+    }
+    *out_length = out.size();
+    return OJPH_STATUS_OK;
+  } catch (const std::bad_alloc &) {
+    write_error(error_message, error_length, "memory allocation failure");
+    return OJPH_STATUS_ERROR;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+    return OJPH_STATUS_ERROR;
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+    return OJPH_STATUS_ERROR;
+  }
+}
+
+struct ojph_encoder {
+  ojph_encode_options options;
+  callback_outfile out;
+  codestream cs;
+  ojph::line_buf *line = nullptr;  // the line the codestream asks for next
+  ui32 comp = 0;
+  ui32 rows_pushed = 0;
+  bool failed = false;  // an error left the codestream unusable
+  bool finished = false;
+
+  ojph_encoder(const ojph_encode_options &options, ojph_write_callback write,
+               void *context)
+      : options(options), out(write, context) {}
+};
+
+extern "C" ojph_encoder *ojph_encoder_create(
+    const ojph_encode_options *options,
+    ojph_write_callback write,
+    void *context,
+    char *error_message,
+    size_t error_length) {
+  if (!options || !write) {
+    write_error(error_message, error_length, "invalid arguments");
+    return nullptr;
+  }
+  if (!check_encode_options(*options, error_message, error_length)) {
+    return nullptr;
+  }
+
+  ojph_encoder *encoder = nullptr;
+  try {
+    encoder = new ojph_encoder(*options, write, context);
+    // rows arrive a few at a time, so every component of a row is pushed
+    // together, even from planar input, and tile rows leave once coded
+    set_up_encoder(encoder->cs, *options, false);
+    encoder->cs.request_tile_row_output(true);
+    encoder->cs.write_headers(&encoder->out);
+    encoder->line = encoder->cs.exchange(nullptr, encoder->comp);
+    return encoder;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+  }
+  delete encoder;
+  return nullptr;
+}
+
+extern "C" ojph_status ojph_encoder_push_rows(ojph_encoder *encoder,
+                                              const void *pixels,
+                                              size_t row_pitch,
+                                              uint32_t rows,
+                                              char *error_message,
+                                              size_t error_length) {
+  if (!encoder || (!pixels && rows != 0)) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  const ojph_encode_options &options = encoder->options;
+  if (encoder->failed || encoder->finished) {
+    write_error(error_message, error_length,
+                encoder->failed ? "the encode failed earlier"
+                                : "the encode is finished");
+    return OJPH_STATUS_ERROR;
+  }
+  if (rows > options.height - encoder->rows_pushed) {
+    write_error(error_message, error_length,
+                "more rows than the image has");
+    return OJPH_STATUS_ERROR;
+  }
+  if (row_pitch == 0) {
+    row_pitch = packed_row_bytes(options);
+  }
+
+  try {
+    std::vector<ui32> chunk_rows(options.components, 0);
+    push_lines(encoder->cs, encoder->line, encoder->comp, chunk_rows,
+               static_cast<const uint8_t *>(pixels), row_pitch,
+               row_pitch * rows, (size_t)options.components * rows, options);
+    encoder->rows_pushed += rows;
+    return OJPH_STATUS_OK;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+  }
+  encoder->failed = true;
+  return OJPH_STATUS_ERROR;
+}
+
+extern "C" ojph_status ojph_encoder_finish(ojph_encoder *encoder,
+                                           char *error_message,
+                                           size_t error_length) {
+  if (!encoder) {
+    write_error(error_message, error_length, "invalid arguments");
+    return OJPH_STATUS_ERROR;
+  }
+  if (encoder->failed || encoder->finished ||
+      encoder->rows_pushed != encoder->options.height) {
+    write_error(error_message, error_length,
+                encoder->failed     ? "the encode failed earlier"
+                : encoder->finished ? "the encode is finished"
+                                    : "rows are missing");
+    return OJPH_STATUS_ERROR;
+  }
+
+  try {
+    encoder->cs.flush();
+    encoder->finished = true;
+    return OJPH_STATUS_OK;
+  } catch (const std::exception &ex) {
+    write_error(error_message, error_length, ex.what());
+  } catch (...) {
+    write_error(error_message, error_length, "unknown OpenJPH error");
+  }
+  encoder->failed = true;
+  return OJPH_STATUS_ERROR;
+}
+
+extern "C" void ojph_encoder_destroy(ojph_encoder *encoder) {
+  delete encoder;
+}
+
+extern "C" void ojph_get_memory_stats(ojph_memory_stats *out_stats) {
+  if (!out_stats) {
+    return;
+  }
+  const ojph::mem_store_pool::stats stats =
+      ojph::mem_store_pool::get_instance().get_stats();
+  out_stats->reserved_bytes = stats.reserved;
+  out_stats->in_use_bytes = stats.in_use;
+  out_stats->peak_bytes = stats.peak;
+  out_stats->retention_limit = stats.retention_limit;
+}
+
+extern "C" void ojph_set_memory_retention(size_t bytes) {
+  ojph::mem_store_pool::get_instance().set_retention_limit(bytes);
+}
+
+extern "C" void ojph_trim_memory(void) {
+  ojph::mem_store_pool::get_instance().trim();
+}
+
+namespace {
+
+struct MessageRoute {
+  ojph_message_callback callback;
+  void *context;
+};
+
+MessageRoute message_route = {nullptr, nullptr};
+
+void route_message(void *context, ojph::OJPH_MSG_LEVEL level, int code,
+                   const char * /*file_name*/, int /*line_num*/,
+                   const char *message) {
+  const MessageRoute *route = static_cast<const MessageRoute *>(context);
+  if (route->callback) {
+    route->callback(route->context, static_cast<ojph_message_level>(level),
+                    static_cast<uint32_t>(code), message);
+  }
+}
+
+} // namespace
+
+extern "C" void ojph_set_message_callback(ojph_message_callback callback,
+                                          void *context,
+                                          ojph_message_level min_level,
+                                          uint32_t max_per_second) {
+  // the sink is detached while the route changes, so that no message sees
+  // a callback with the context of another
+  ojph::set_message_sink(nullptr, nullptr, ojph::NO_MSG, 0);
+  message_route.callback = callback;
+  message_route.context = context;
+  const ojph::OJPH_MSG_LEVEL level = callback
+      ? static_cast<ojph::OJPH_MSG_LEVEL>(
+            std::min(std::max(static_cast<int>(min_level), 1), 4))
+      : ojph::NO_MSG;
+  ojph::set_message_sink(route_message, &message_route, level,
+                         max_per_second);
+}
+
+extern "C" void ojph_set_instruction_set_cap(ojph_instruction_set cap) {
+  int level = -1;
+#if defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)
+  switch (cap) {
+    case OJPH_ISA_GENERIC: level = ojph::X86_CPU_EXT_LEVEL_GENERIC; break;
+    case OJPH_ISA_SSE2: level = ojph::X86_CPU_EXT_LEVEL_SSE2; break;
+    case OJPH_ISA_SSSE3: level = ojph::X86_CPU_EXT_LEVEL_SSSE3; break;
+    case OJPH_ISA_AVX: level = ojph::X86_CPU_EXT_LEVEL_AVX; break;
+    case OJPH_ISA_AVX2: level = ojph::X86_CPU_EXT_LEVEL_AVX2FMA; break;
+    default: break;
+  }
+#else
+  if (cap == OJPH_ISA_GENERIC) {
+    level = 0;
+  }
+#endif
+  ojph::set_cpu_ext_level_cap(level);
+}
+
+extern "C" ojph_instruction_set ojph_instruction_set_in_use(void) {
+  const int level = ojph::get_cpu_ext_level();
+#if defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386)
+  if (level > ojph::X86_CPU_EXT_LEVEL_AVX2FMA) {
+    return OJPH_ISA_ALL;
+  }
+  if (level >= ojph::X86_CPU_EXT_LEVEL_AVX2) {
+    return OJPH_ISA_AVX2;
+  }
+  if (level >= ojph::X86_CPU_EXT_LEVEL_AVX) {
+    return OJPH_ISA_AVX;
+  }
+  if (level >= ojph::X86_CPU_EXT_LEVEL_SSSE3) {
+    return OJPH_ISA_SSSE3;
+  }
+  if (level >= ojph::X86_CPU_EXT_LEVEL_SSE2) {
+    return OJPH_ISA_SSE2;
+  }
+  return OJPH_ISA_GENERIC;
+#else
+  return level > 0 ? OJPH_ISA_ALL : OJPH_ISA_GENERIC;
+#endif
+}
+
+extern "C" uint64_t ojph_dropped_messages(void) {
+  return ojph::get_dropped_messages();
+}
+
+extern "C" void ojph_free_image(ojph_decoded_image *image) {
+  if (!image) {
+    return;
+  }
+  if (image->pixels8) {
+    std::free(image->pixels8);
+  }
+  if (image->pixels16) {
+    std::free(image->pixels16);
+  }
+  if (image->pixels32) {
+    std::free(image->pixels32);
   }
   std::memset(image, 0, sizeof(*image));
 }
@@ -0,0 +1,74 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the DcmSwift benchmarks of OpenJPH.
+// File: openjph_kernel_bench.h
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Speed of one implementation of an internal kernel, as measured by
+/// `ojph_benchmark_kernels`. The strings are static.
+typedef struct {
+    const char *kernel;     // e.g. "decode_cb32", "tx_from_cb32_rev", "irv_horz_syn"
+    const char *variant;    // instruction set: "gen", "sse2", "avx2", "neon", ...
+    const char *input;      // "synthetic", or "captured" from the codestreams given
+    uint8_t dispatched;     // non-zero for the variant that decoders use on this CPU
+    uint64_t samples;       // samples produced by one pass over the input
+    uint64_t passes;        // passes that were timed
+    double ns_per_sample;   // of the fastest pass
+    double max_abs_error;   // largest output difference to the "gen" variant
+} ojph_kernel_timing;
+
+/// Times every variant of the HT block decoders, of the codeblock to subband
+/// line transfers, and of the wavelet synthesis steps that is compiled in and
+/// that the CPU supports, to check the dispatch choices and catch kernel
+/// regressions. The kernels run on codeblocks and image rows of synthetic
+/// CT-like images, then on those captured by decoding the `count` codestreams
+/// (possibly none), each pass repeated for at least `min_seconds` (0 for
+/// 50 ms). Writes up to `max_results` timings and returns how many there are.
+size_t ojph_benchmark_kernels(const uint8_t *const *codestreams,
+                              const size_t *lengths,
+                              size_t count,
+                              double min_seconds,
+                              ojph_kernel_timing *results,
+                              size_t max_results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,905 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2026, The DcmSwift contributors
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// 
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the DcmSwift benchmarks of OpenJPH.
+// File: openjph_kernel_bench.cpp
+// Author: The DcmSwift contributors
+// Date: 14 October 2026
+//***************************************************************************/
+
+#include "openjph_kernel_bench.h"
+#include "openjph_wrapper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#include "common/ojph_arch.h"
+#include "common/ojph_codestream.h"
+#include "common/ojph_file.h"
+#include "common/ojph_mem.h"
+#include "common/ojph_params.h"
+#include "common/ojph_stats.h"
+#include "codestream/ojph_codeblock.h"
+#include "codestream/ojph_codeblock_fun.h"
+#include "codestream/ojph_params_local.h"
+#include "coding/ojph_block_decoder.h"
+#include "transform/ojph_transform.h"
+#include "transform/ojph_transform_local.h"
+
+#if !defined(OJPH_DISABLE_SIMD) \
+  && (defined(OJPH_ARCH_X86_64) || defined(OJPH_ARCH_I386))
+  #define OJPH_BENCH_X86
+#endif
+
+namespace {
+
+using ojph::codestream;
+using ojph::line_buf;
+using ojph::mem_infile;
+using ojph::param_siz;
+using ojph::si32;
+using ojph::si64;
+using ojph::ui8;
+using ojph::ui32;
+using ojph::ui64;
+using ojph::local::coded_cb_header;
+using ojph::local::lifting_step;
+using ojph::local::param_atk;
+
+const size_t kMaxBlocks = 256;     // kept per kind of codeblock and input
+const size_t kMaxRows = 64;        // image rows kept per input
+const ui32 kMaxRowWidth = 4096;
+const ui32 kMinRowWidth = 16;
+const ui32 kLinePadding = 32;      // samples around lines, for SIMD overreads
+const double kDefaultSeconds = 0.05;
+
+// One implementation of a kernel; `name` is the instruction set it uses.
+template <typename F>
+struct Variant {
+  const char *name;
+  F fun;
+};
+
+inline bool cpu_at_least(int level) {
+  return ojph::get_cpu_ext_level() >= level;
+}
+
+// The variants below mirror the choices of codeblock_fun::init and
+// init_wavelet_transform_functions, but list every one that is compiled in
+// and that this CPU can run, instead of the best one; "gen" comes first.
+
+std::vector<Variant<ojph::local::cb_decoder_fun32>> decode_cb32_variants() {
+  std::vector<Variant<ojph::local::cb_decoder_fun32>> v;
+  v.push_back({"gen", ojph::local::ojph_decode_codeblock32});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSSE3
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSSE3))
+    v.push_back({"ssse3", ojph::local::ojph_decode_codeblock_ssse3});
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+    v.push_back({"avx2", ojph::local::ojph_decode_codeblock_avx2});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+  if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+    v.push_back({"neon", ojph::local::ojph_decode_codeblock_neon});
+#endif
+  return v;
+}
+
+std::vector<Variant<ojph::local::cb_decoder_fun64>> decode_cb64_variants() {
+  std::vector<Variant<ojph::local::cb_decoder_fun64>> v;
+  v.push_back({"gen", ojph::local::ojph_decode_codeblock64});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_AVX2
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+    v.push_back({"avx2", ojph::local::ojph_decode_codeblock64_avx2});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+  if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+    v.push_back({"neon", ojph::local::ojph_decode_codeblock64_neon});
+#endif
+  return v;
+}
+
+std::vector<Variant<ojph::local::tx_from_cb_fun32>>
+tx_from_cb32_variants(bool reversible) {
+  std::vector<Variant<ojph::local::tx_from_cb_fun32>> v;
+  v.push_back({"gen", reversible ? ojph::local::gen_rev_tx_from_cb32
+                                 : ojph::local::gen_irv_tx_from_cb32});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE2))
+    v.push_back({"sse2", reversible ? ojph::local::sse2_rev_tx_from_cb32
+                                    : ojph::local::sse2_irv_tx_from_cb32});
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+    v.push_back({"avx2", reversible ? ojph::local::avx2_rev_tx_from_cb32
+                                    : ojph::local::avx2_irv_tx_from_cb32});
+  #endif
+#endif
+  return v;
+}
+
+std::vector<Variant<ojph::local::tx_from_cb_fun64>>
+tx_from_cb64_variants(bool reversible) {
+  std::vector<Variant<ojph::local::tx_from_cb_fun64>> v;
+  v.push_back({"gen", reversible ? ojph::local::gen_rev_tx_from_cb64
+                                 : ojph::local::gen_irv_tx_from_cb64});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+  if (reversible && cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE2))
+    v.push_back({"sse2", ojph::local::sse2_rev_tx_from_cb64});
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+  if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+    v.push_back({"avx2", reversible ? ojph::local::avx2_rev_tx_from_cb64
+                                    : ojph::local::avx2_irv_tx_from_cb64});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+  if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+    v.push_back({"neon", reversible ? ojph::local::neon_rev_tx_from_cb64
+                                    : ojph::local::neon_irv_tx_from_cb64});
+#endif
+  return v;
+}
+
+typedef void (*horz_syn_fun)(const param_atk *atk, const line_buf *dst,
+                             const line_buf *lsrc, const line_buf *hsrc,
+                             ui32 width, bool even);
+typedef void (*vert_step_fun)(const lifting_step *s, const line_buf *sig,
+                              const line_buf *other, const line_buf *aug,
+                              ui32 repeat, bool synthesis);
+
+std::vector<Variant<horz_syn_fun>> horz_syn_variants(bool reversible) {
+  std::vector<Variant<horz_syn_fun>> v;
+  if (reversible) {
+    v.push_back({"gen", ojph::local::gen_rev_horz_syn});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE2))
+      v.push_back({"sse2", ojph::local::sse2_rev_horz_syn});
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+      v.push_back({"avx2", ojph::local::avx2_rev_horz_syn});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+    if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+      v.push_back({"neon", ojph::local::neon_rev_horz_syn});
+#endif
+  } else {
+    v.push_back({"gen", ojph::local::gen_irv_horz_syn});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE))
+      v.push_back({"sse", ojph::local::sse_irv_horz_syn});
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX))
+      v.push_back({"avx", ojph::local::avx_irv_horz_syn});
+  #endif
+  #if defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512)
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX512))
+      v.push_back({"avx512", ojph::local::avx512_irv_horz_syn});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+    if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+      v.push_back({"neon", ojph::local::neon_irv_horz_syn});
+#endif
+  }
+  return v;
+}
+
+std::vector<Variant<vert_step_fun>> vert_step_variants(bool reversible) {
+  std::vector<Variant<vert_step_fun>> v;
+  if (reversible) {
+    v.push_back({"gen", ojph::local::gen_rev_vert_step});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE2
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE2))
+      v.push_back({"sse2", ojph::local::sse2_rev_vert_step});
+  #endif
+  #ifndef OJPH_DISABLE_AVX2
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX2))
+      v.push_back({"avx2", ojph::local::avx2_rev_vert_step});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+    if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+      v.push_back({"neon", ojph::local::neon_rev_vert_step});
+#endif
+  } else {
+    v.push_back({"gen", ojph::local::gen_irv_vert_step});
+#ifdef OJPH_BENCH_X86
+  #ifndef OJPH_DISABLE_SSE
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_SSE))
+      v.push_back({"sse", ojph::local::sse_irv_vert_step});
+  #endif
+  #ifndef OJPH_DISABLE_AVX
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX))
+      v.push_back({"avx", ojph::local::avx_irv_vert_step});
+  #endif
+  #if defined(OJPH_ARCH_X86_64) && !defined(OJPH_DISABLE_AVX512)
+    if (cpu_at_least(ojph::X86_CPU_EXT_LEVEL_AVX512))
+      v.push_back({"avx512", ojph::local::avx512_irv_vert_step});
+  #endif
+#endif
+#ifdef OJPH_ENABLE_NEON
+    if (cpu_at_least(ojph::ARM_CPU_EXT_LEVEL_NEON))
+      v.push_back({"neon", ojph::local::neon_irv_vert_step});
+#endif
+  }
+  return v;
+}
+
+// Samples aligned as the allocators of the codestream align them, with
+// room on both sides for kernels that read or write past the ends.
+template <typename T>
+class AlignedSamples {
+public:
+  explicit AlignedSamples(size_t count)
+    : store(count + 2 * kLinePadding + ojph::byte_alignment / sizeof(T)) {
+    data = ojph::align_ptr<T, ojph::byte_alignment>(
+      store.data() + kLinePadding);
+  }
+  AlignedSamples(AlignedSamples &&) = default;
+  AlignedSamples(const AlignedSamples &) = delete;
+
+  T *data;
+
+private:
+  std::vector<T> store;
+};
+
+// The line_buf of `count` samples at the start of `samples`.
+template <typename T>
+line_buf wrap_line(AlignedSamples<T> &samples, size_t count) {
+  line_buf line;
+  line.wrap(samples.data, count, 1);
+  return line;
+}
+
+// A codeblock copied out of a decode, with the padding that the block
+// decoders expect around coded data.
+struct CapturedBlock {
+  ojph::codeblock_record record;  // `record.coded` is not used
+  std::vector<ui8> data;
+
+  ui8 *coded() { return data.data() + coded_cb_header::prefix_buf_size; }
+  ui32 stride() const { return (record.width + 15) & ~15u; }
+  // rows written by the decoders, which work on stripes of four rows
+  ui32 buffer_rows() const { return (record.height + 3) & ~3u; }
+};
+
+// Codeblocks and image rows collected from decodes, to run the kernels on.
+struct KernelInputs : public ojph::codeblock_sink {
+  std::vector<CapturedBlock> rev;   // reversible, 32-bit samples
+  std::vector<CapturedBlock> irv;   // irreversible
+  std::vector<CapturedBlock> wide;  // 64-bit samples
+  std::vector<std::vector<si32>> rows;
+
+  // Decodes without a thread pool, so captures come from one thread.
+  void capture(const ojph::codeblock_record &cb) override {
+    std::vector<CapturedBlock> &list = cb.wide ? wide
+                                     : cb.reversible ? rev : irv;
+    if (list.size() >= kMaxBlocks || cb.width == 0 || cb.height == 0) {
+      return;
+    }
+    const size_t bytes = size_t(cb.lengths[0]) + cb.lengths[1];
+    CapturedBlock block;
+    block.record = cb;
+    block.record.coded = NULL;
+    block.data.assign(coded_cb_header::prefix_buf_size + bytes
+                      + coded_cb_header::suffix_buf_size, 0);
+    std::memcpy(block.coded(), cb.coded, bytes);
+    list.push_back(std::move(block));
+  }
+
+  void add_row(const line_buf *line, ui32 width) {
+    if (rows.size() >= kMaxRows || width < kMinRowWidth) {
+      return;
+    }
+    width = std::min(width, kMaxRowWidth);
+    std::vector<si32> row(width);
+    if (line->flags & line_buf::LFT_INTEGER) {
+      for (ui32 x = 0; x < width; ++x) {
+        row[x] = (line->flags & line_buf::LFT_64BIT) ? (si32)line->i64[x]
+                                                     : line->i32[x];
+      }
+    } else {
+      for (ui32 x = 0; x < width; ++x) {
+        row[x] = (si32)std::lround(line->f32[x]);
+      }
+    }
+    rows.push_back(std::move(row));
+  }
+
+  // Decodes `length` bytes of a codestream, keeping its codeblocks and
+  // the first rows of its first component; returns false on errors.
+  bool collect(const uint8_t *data, size_t length) {
+    try {
+      mem_infile input;
+      input.open(data, length);
+      ojph::decode_stats stats;
+      stats.sink = this;
+      codestream cs;
+      cs.set_stats(&stats);
+      cs.enable_resilience();
+      cs.read_headers(&input);
+      cs.create();
+      param_siz siz = cs.access_siz();
+      const ui32 num_components = siz.get_num_components();
+      const ui32 height = siz.get_recon_height(0);
+      const ui32 width = siz.get_recon_width(0);
+      for (ui32 y = 0; y < height; ++y) {
+        for (ui32 c = 0; c < num_components; ++c) {
+          ui32 comp = c;
+          line_buf *line = cs.pull(comp);
+          if (!line) {
+            break;
+          }
+          if (comp == 0) {
+            add_row(line, width);
+          }
+        }
+      }
+      cs.close();
+      return true;
+    } catch (const std::exception &) {
+      return false;
+    } catch (...) {
+      return false;
+    }
+  }
+};
+
+// Fills `inputs` from 12-bit images that resemble CT slices, coded
+// losslessly and lossily by ojph_encode_image.
+void synthesize_inputs(KernelInputs &inputs) {
+  const ui32 width = 1024, height = 512;
+  std::vector<uint16_t> pixels(size_t(width) * height);
+  ui32 seed = 0x2545F491u;
+  for (ui32 y = 0; y < height; ++y) {
+    for (ui32 x = 0; x < width; ++x) {
+      seed = seed * 1664525u + 1013904223u;
+      const float dx = (float)x - width / 2.0f, dy = (float)y - height / 2.0f;
+      const float body = dx * dx + 4 * dy * dy < 200000.0f ? 1000.0f : 0.0f;
+      const float texture = 300.0f * std::sin(x * 0.05f) * std::cos(y * 0.03f);
+      const float noise = (float)(seed >> 24) - 128.0f;
+      const float v = 1024.0f + body + texture + noise;
+      pixels[size_t(y) * width + x] =
+        (uint16_t)std::min(4095.0f, std::max(0.0f, v));
+    }
+  }
+
+  for (int irreversible = 0; irreversible < 2; ++irreversible) {
+    ojph_encode_options options;
+    std::memset(&options, 0, sizeof(options));
+    options.width = width;
+    options.height = height;
+    options.components = 1;
+    options.bit_depth = 12;
+    options.irreversible = (uint8_t)irreversible;
+    uint8_t *codestream_data = NULL;
+    size_t length = 0;
+    if (ojph_encode_image(pixels.data(), 0, &options, &codestream_data,
+                          &length, NULL, 0) == OJPH_STATUS_OK) {
+      inputs.collect(codestream_data, length);
+    }
+    ojph_free_codestream(codestream_data);
+  }
+}
+
+// Times passes over the whole input, until `min_seconds` have elapsed and
+// at least three passes ran. `restore` resets what the kernels modify in
+// place; its own cost is measured apart and taken out.
+template <typename Pass, typename Restore>
+void time_passes(ojph_kernel_timing &timing, double min_seconds,
+                 Pass pass, Restore restore) {
+  const ui64 budget = (ui64)(min_seconds * 1e9);
+  ui64 best = ~(ui64)0, best_restore = ~(ui64)0, passes = 0;
+  const ui64 start = ojph::decode_stats::now();
+  do {
+    ui64 t0 = ojph::decode_stats::now();
+    restore();
+    ui64 t1 = ojph::decode_stats::now();
+    pass();
+    ui64 t2 = ojph::decode_stats::now();
+    best_restore = std::min(best_restore, t1 - t0);
+    best = std::min(best, t2 - t1);
+    ++passes;
+  } while (passes < 3 || ojph::decode_stats::now() - start < budget);
+  timing.passes = passes;
+  const ui64 net = best > best_restore ? best - best_restore : 0;
+  timing.ns_per_sample =
+    timing.samples ? (double)net / (double)timing.samples : 0.0;
+}
+
+// Does nothing, for kernels that do not modify their inputs.
+struct NoRestore {
+  void operator()() const {}
+};
+
+// Value of a sign-magnitude sample, as the block decoders produce them.
+template <typename T>
+double signed_value(T v) {
+  const T sign = (T)1 << (sizeof(T) * 8 - 1);
+  const double magnitude = (double)(v & ~sign);
+  return (v & sign) ? -magnitude : magnitude;
+}
+
+class KernelBench {
+public:
+  KernelBench(double min_seconds) : min_seconds(min_seconds) {
+    ojph::local::init_wavelet_transform_functions();
+    dispatched_rev.init(true, false);
+    dispatched_irv.init(false, false);
+    rev_atk = rev_atk_store.get_atk(1);
+    irv_atk = irv_atk_store.get_atk(0);
+  }
+
+  void run(KernelInputs &inputs, const char *input) {
+    std::vector<CapturedBlock> blocks32 = inputs.rev;
+    blocks32.insert(blocks32.end(), inputs.irv.begin(), inputs.irv.end());
+    // the 64-bit path decodes any codeblock; without 64-bit codeblocks,
+    // it is timed on the reversible 32-bit ones
+    std::vector<CapturedBlock> &blocks64 =
+      inputs.wide.empty() ? inputs.rev : inputs.wide;
+
+    std::vector<std::vector<ui32>> rev_coeffs, irv_coeffs;
+    std::vector<std::vector<ui64>> wide_coeffs;
+    decode_cb32(blocks32, input);
+    decode_blocks(inputs.rev, rev_coeffs);
+    decode_blocks(inputs.irv, irv_coeffs);
+    decode_cb64(blocks64, wide_coeffs, input);
+    tx_from_cb32(inputs.rev, rev_coeffs, true, input);
+    tx_from_cb32(inputs.irv, irv_coeffs, false, input);
+    tx_from_cb64(blocks64, wide_coeffs, input);
+    horz_syn(inputs.rows, true, input);
+    horz_syn(inputs.rows, false, input);
+    vert_step(inputs.rows, true, input);
+    vert_step(inputs.rows, false, input);
+  }
+
+  std::vector<ojph_kernel_timing> results;
+
+private:
+  ojph_kernel_timing &add(const char *kernel, const char *variant,
+                          const char *input, bool dispatched,
+                          uint64_t samples) {
+    ojph_kernel_timing timing;
+    std::memset(&timing, 0, sizeof(timing));
+    timing.kernel = kernel;
+    timing.variant = variant;
+    timing.input = input;
+    timing.dispatched = dispatched ? 1 : 0;
+    timing.samples = samples;
+    results.push_back(timing);
+    return results.back();
+  }
+
+  template <typename T, typename F>
+  static bool decode(CapturedBlock &b, F fun, T *buf) {
+    const ojph::codeblock_record &r = b.record;
+    return fun(b.coded(), buf, r.missing_msbs, r.num_passes, r.lengths[0],
+               r.lengths[1], r.width, r.height, b.stride(), r.stripe_causal);
+  }
+
+  static size_t max_block_size(const std::vector<CapturedBlock> &blocks) {
+    size_t size = 0;
+    for (const CapturedBlock &b : blocks) {
+      size = std::max(size, size_t(b.stride()) * b.buffer_rows());
+    }
+    return size;
+  }
+
+  // The generic decoder output of every block, `stride` samples per row.
+  void decode_blocks(std::vector<CapturedBlock> &blocks,
+                     std::vector<std::vector<ui32>> &coeffs) {
+    coeffs.clear();
+    for (CapturedBlock &b : blocks) {
+      AlignedSamples<ui32> buf(size_t(b.stride()) * b.buffer_rows());
+      decode(b, ojph::local::ojph_decode_codeblock32, buf.data);
+      coeffs.emplace_back(buf.data,
+                          buf.data + size_t(b.stride()) * b.record.height);
+    }
+  }
+
+  template <typename T, typename F>
+  void time_decoders(std::vector<CapturedBlock> &blocks,
+                     const std::vector<Variant<F>> &variants,
+                     F dispatched, const char *kernel, const char *input,
+                     std::vector<std::vector<T>> &coeffs) {
+    if (blocks.empty()) {
+      return;
+    }
+    uint64_t samples = 0;
+    for (const CapturedBlock &b : blocks) {
+      samples += uint64_t(b.record.width) * b.record.height;
+    }
+    AlignedSamples<T> buf(max_block_size(blocks));
+    coeffs.clear();
+    for (CapturedBlock &b : blocks) {
+      decode(b, variants[0].fun, buf.data);
+      coeffs.emplace_back(buf.data,
+                          buf.data + size_t(b.stride()) * b.record.height);
+    }
+    for (const Variant<F> &v : variants) {
+      ojph_kernel_timing &t =
+        add(kernel, v.name, input, v.fun == dispatched, samples);
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        CapturedBlock &b = blocks[i];
+        decode(b, v.fun, buf.data);
+        for (ui32 y = 0; y < b.record.height; ++y) {
+          for (ui32 x = 0; x < b.record.width; ++x) {
+            const size_t k = size_t(y) * b.stride() + x;
+            t.max_abs_error = std::max(t.max_abs_error, std::fabs(
+              signed_value(buf.data[k]) - signed_value(coeffs[i][k])));
+          }
+        }
+      }
+      time_passes(t, min_seconds, [&] {
+        for (CapturedBlock &b : blocks) {
+          decode(b, v.fun, buf.data);
+        }
+      }, NoRestore());
+    }
+  }
+
+  void decode_cb32(std::vector<CapturedBlock> &blocks, const char *input) {
+    std::vector<std::vector<ui32>> coeffs;
+    time_decoders(blocks, decode_cb32_variants(), dispatched_rev.decode_cb32,
+                  "decode_cb32", input, coeffs);
+  }
+
+  void decode_cb64(std::vector<CapturedBlock> &blocks,
+                   std::vector<std::vector<ui64>> &coeffs, const char *input) {
+    time_decoders(blocks, decode_cb64_variants(), dispatched_rev.decode_cb64,
+                  "decode_cb64", input, coeffs);
+  }
+
+  template <typename T, typename D, typename F>
+  void time_transfers(std::vector<CapturedBlock> &blocks,
+                      const std::vector<std::vector<T>> &coeffs,
+                      const std::vector<Variant<F>> &variants, F dispatched,
+                      const char *kernel, const char *input) {
+    if (blocks.empty()) {
+      return;
+    }
+    uint64_t samples = 0;
+    ui32 max_width = 0;
+    for (const CapturedBlock &b : blocks) {
+      samples += uint64_t(b.record.width) * b.record.height;
+      max_width = std::max(max_width, b.record.width);
+    }
+    AlignedSamples<D> line(max_width);
+    // the generic output of every row of every block, one after the other
+    std::vector<D> reference;
+    reference.reserve(samples);
+    auto transfer = [&](F fun, bool check, ojph_kernel_timing *t) {
+      size_t k = 0;
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        const ojph::codeblock_record &r = blocks[i].record;
+        const ui32 stride = blocks[i].stride();
+        for (ui32 y = 0; y < r.height; ++y) {
+          fun(coeffs[i].data() + size_t(y) * stride, line.data, r.K_max,
+              r.delta, r.width);
+          if (!check) {
+            continue;
+          }
+          if (!t) {
+            reference.insert(reference.end(), line.data,
+                             line.data + r.width);
+            continue;
+          }
+          for (ui32 x = 0; x < r.width; ++x, ++k) {
+            t->max_abs_error = std::max(t->max_abs_error, std::fabs(
+              (double)line.data[x] - (double)reference[k]));
+          }
+        }
+      }
+    };
+    transfer(variants[0].fun, true, NULL);
+    for (const Variant<F> &v : variants) {
+      ojph_kernel_timing &t =
+        add(kernel, v.name, input, v.fun == dispatched, samples);
+      transfer(v.fun, true, &t);
+      time_passes(t, min_seconds, [&] { transfer(v.fun, false, NULL); },
+                  NoRestore());
+    }
+  }
+
+  void tx_from_cb32(std::vector<CapturedBlock> &blocks,
+                    const std::vector<std::vector<ui32>> &coeffs,
+                    bool reversible, const char *input) {
+    if (reversible) {
+      time_transfers<ui32, si32>(blocks, coeffs, tx_from_cb32_variants(true),
+                                 dispatched_rev.tx_from_cb32,
+                                 "tx_from_cb32_rev", input);
+    } else {
+      time_transfers<ui32, float>(blocks, coeffs,
+                                  tx_from_cb32_variants(false),
+                                  dispatched_irv.tx_from_cb32,
+                                  "tx_from_cb32_irv", input);
+    }
+  }
+
+  void tx_from_cb64(std::vector<CapturedBlock> &blocks,
+                    const std::vector<std::vector<ui64>> &coeffs,
+                    const char *input) {
+    // 64-bit codeblocks come from either wavelet; each kind is timed on
+    // its own kernels
+    for (bool reversible : {true, false}) {
+      std::vector<CapturedBlock> kind;
+      std::vector<std::vector<ui64>> kind_coeffs;
+      for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].record.reversible == reversible) {
+          kind.push_back(blocks[i]);
+          kind_coeffs.push_back(coeffs[i]);
+        }
+      }
+      if (reversible) {
+        time_transfers<ui64, si64>(kind, kind_coeffs,
+                                   tx_from_cb64_variants(true),
+                                   dispatched_rev.tx_from_cb64,
+                                   "tx_from_cb64_rev", input);
+      } else {
+        time_transfers<ui64, float>(kind, kind_coeffs,
+                                    tx_from_cb64_variants(false),
+                                    dispatched_irv.tx_from_cb64,
+                                    "tx_from_cb64_irv", input);
+      }
+    }
+  }
+
+  // Rows of the image, as integers for the reversible kernels or floats
+  // for the irreversible ones.
+  template <typename T>
+  static std::vector<AlignedSamples<T>>
+  row_samples(const std::vector<std::vector<si32>> &rows) {
+    std::vector<AlignedSamples<T>> samples;
+    for (const std::vector<si32> &row : rows) {
+      samples.emplace_back(row.size());
+      std::copy(row.begin(), row.end(), samples.back().data);
+    }
+    return samples;
+  }
+
+  template <typename T>
+  static double max_difference(const T *a, const T *b, size_t count) {
+    double error = 0;
+    for (size_t i = 0; i < count; ++i) {
+      error = std::max(error, std::fabs((double)a[i] - (double)b[i]));
+    }
+    return error;
+  }
+
+  // The horizontal synthesis of every row is timed on the bands that the
+  // generic analysis produces from it; the lifting steps run in place on
+  // the bands, so these are restored before each call.
+  template <typename T>
+  void time_horz_syn(const std::vector<std::vector<si32>> &rows,
+                     bool reversible, const char *input) {
+    const param_atk *atk = reversible ? rev_atk : irv_atk;
+    const horz_syn_fun dispatched = reversible ? ojph::local::rev_horz_syn
+                                               : ojph::local::irv_horz_syn;
+    std::vector<AlignedSamples<T>> src = row_samples<T>(rows);
+    std::vector<std::vector<T>> low, high, reference;
+    AlignedSamples<T> l(kMaxRowWidth / 2 + 1), h(kMaxRowWidth / 2 + 1);
+    AlignedSamples<T> dst(kMaxRowWidth);
+    line_buf l_line = wrap_line(l, kMaxRowWidth / 2 + 1);
+    line_buf h_line = wrap_line(h, kMaxRowWidth / 2 + 1);
+    line_buf dst_line = wrap_line(dst, kMaxRowWidth);
+    uint64_t samples = 0;
+    for (size_t r = 0; r < rows.size(); ++r) {
+      const ui32 width = (ui32)rows[r].size();
+      line_buf src_line = wrap_line(src[r], width);
+      if (reversible) {
+        ojph::local::gen_rev_horz_ana(atk, &l_line, &h_line, &src_line,
+                                      width, true);
+      } else {
+        ojph::local::gen_irv_horz_ana(atk, &l_line, &h_line, &src_line,
+                                      width, true);
+      }
+      low.emplace_back(l.data, l.data + (width + 1) / 2);
+      high.emplace_back(h.data, h.data + width / 2);
+      samples += width;
+    }
+    auto restore = [&](size_t r) {
+      std::copy(low[r].begin(), low[r].end(), l.data);
+      std::copy(high[r].begin(), high[r].end(), h.data);
+    };
+    for (const Variant<horz_syn_fun> &v : horz_syn_variants(reversible)) {
+      ojph_kernel_timing &t = add(reversible ? "rev_horz_syn"
+                                             : "irv_horz_syn",
+                                  v.name, input, v.fun == dispatched,
+                                  samples);
+      for (size_t r = 0; r < rows.size(); ++r) {
+        const ui32 width = (ui32)rows[r].size();
+        restore(r);
+        v.fun(atk, &dst_line, &l_line, &h_line, width, true);
+        if (reference.size() < rows.size()) {
+          reference.emplace_back(dst.data, dst.data + width);
+        } else {
+          t.max_abs_error = std::max(t.max_abs_error,
+            max_difference(dst.data, reference[r].data(), width));
+        }
+      }
+      time_passes(t, min_seconds, [&] {
+        for (size_t r = 0; r < rows.size(); ++r) {
+          restore(r);
+          v.fun(atk, &dst_line, &l_line, &h_line, (ui32)rows[r].size(),
+                true);
+        }
+      }, [&] {
+        for (size_t r = 0; r < rows.size(); ++r) {
+          restore(r);
+        }
+      });
+    }
+  }
+
+  void horz_syn(const std::vector<std::vector<si32>> &rows, bool reversible,
+                const char *input) {
+    if (rows.empty()) {
+      return;
+    }
+    if (reversible) {
+      time_horz_syn<si32>(rows, true, input);
+    } else {
+      time_horz_syn<float>(rows, false, input);
+    }
+  }
+
+  // Each row is updated from the two that follow it, with the lifting
+  // steps of the wavelet in turn; the updated row is restored before
+  // each call.
+  template <typename T>
+  void time_vert_step(const std::vector<std::vector<si32>> &rows,
+                      bool reversible, const char *input) {
+    const param_atk *atk = reversible ? rev_atk : irv_atk;
+    const vert_step_fun dispatched = reversible ? ojph::local::rev_vert_step
+                                                : ojph::local::irv_vert_step;
+    std::vector<AlignedSamples<T>> src = row_samples<T>(rows);
+    std::vector<std::vector<T>> reference;
+    AlignedSamples<T> aug(kMaxRowWidth);
+    line_buf aug_line = wrap_line(aug, kMaxRowWidth);
+    const size_t count = rows.size() - 2;
+    uint64_t samples = 0;
+    std::vector<line_buf> lines;
+    for (size_t r = 0; r < rows.size(); ++r) {
+      lines.push_back(wrap_line(src[r], rows[r].size()));
+    }
+    for (size_t r = 0; r < count; ++r) {
+      samples += rows[r].size();
+    }
+    auto width = [&](size_t r) {
+      return (ui32)std::min(rows[r].size(),
+                            std::min(rows[r + 1].size(), rows[r + 2].size()));
+    };
+    auto restore = [&](size_t r) {
+      std::copy(src[r].data, src[r].data + rows[r].size(), aug.data);
+    };
+    auto step = [&](size_t r) {
+      return atk->get_step((ui32)(r % atk->get_num_steps()));
+    };
+    for (const Variant<vert_step_fun> &v : vert_step_variants(reversible)) {
+      ojph_kernel_timing &t = add(reversible ? "rev_vert_step"
+                                             : "irv_vert_step",
+                                  v.name, input, v.fun == dispatched,
+                                  samples);
+      for (size_t r = 0; r < count; ++r) {
+        restore(r);
+        v.fun(step(r), &lines[r + 1], &lines[r + 2], &aug_line, width(r),
+              true);
+        if (reference.size() < count) {
+          reference.emplace_back(aug.data, aug.data + width(r));
+        } else {
+          t.max_abs_error = std::max(t.max_abs_error,
+            max_difference(aug.data, reference[r].data(), width(r)));
+        }
+      }
+      time_passes(t, min_seconds, [&] {
+        for (size_t r = 0; r < count; ++r) {
+          restore(r);
+          v.fun(step(r), &lines[r + 1], &lines[r + 2], &aug_line, width(r),
+                true);
+        }
+      }, [&] {
+        for (size_t r = 0; r < count; ++r) {
+          restore(r);
+        }
+      });
+    }
+  }
+
+  void vert_step(const std::vector<std::vector<si32>> &rows, bool reversible,
+                 const char *input) {
+    if (rows.size() < 3) {
+      return;
+    }
+    if (reversible) {
+      time_vert_step<si32>(rows, true, input);
+    } else {
+      time_vert_step<float>(rows, false, input);
+    }
+  }
+
+  double min_seconds;
+  ojph::local::codeblock_fun dispatched_rev, dispatched_irv;
+  param_atk rev_atk_store, irv_atk_store;
+  const param_atk *rev_atk;
+  const param_atk *irv_atk;
+};
+
+} // namespace
+
+extern "C" size_t ojph_benchmark_kernels(const uint8_t *const *codestreams,
+                                         const size_t *lengths,
+                                         size_t count,
+                                         double min_seconds,
+                                         ojph_kernel_timing *results,
+                                         size_t max_results) {
+  std::vector<ojph_kernel_timing> timings;
+  try {
+    KernelBench bench(min_seconds > 0 ? min_seconds : kDefaultSeconds);
+
+    KernelInputs synthetic;
+    synthesize_inputs(synthetic);
+    bench.run(synthetic, "synthetic");
+
+    KernelInputs captured;
+    for (size_t i = 0; codestreams && lengths && i < count; ++i) {
+      if (codestreams[i] && lengths[i] > 0) {
+        captured.collect(codestreams[i], lengths[i]);
+      }
+    }
+    bench.run(captured, "captured");
+    timings.swap(bench.results);
+  } catch (...) {
+    return 0;
+  }
+
+  if (results) {
+    std::copy(timings.begin(),
+              timings.begin() + std::min(max_results, timings.size()),
+              results);
+  }
+  return timings.size();
+}
@@ -0,0 +1,90 @@
+import XCTest
+@testable import DcmSwift
+
+/// Checks the sample transform the router hands to the native decoder: the
+/// decoded samples, with the rescale the frame carries, must give the
+/// modality values of the stored samples.
+final class CompressedPixelRouterTests: XCTestCase {
+    private let width = 23, height = 17
+
+    func testUnsignedCTRescaleIsFolded() throws {
+        let stored = (0..<(width * height)).map { UInt16(($0 * 97) % 4096) }
+        let (samples, slope, intercept) = try decode(stored, bits: 12, signed: false,
+                                                     invert: false, slope: 1, intercept: -1024)
+        XCTAssertEqual(slope, 1)
+        XCTAssertEqual(intercept, -1024)
+        XCTAssertEqual(samples, stored)
+    }
+
+    func testSignedCTRescaleIsFoldedIntoUnsignedSamples() throws {
+        let values = (0..<(width * height)).map { Int16(truncatingIfNeeded: ($0 * 331) % 4000 - 2000) }
+        let stored = values.map { UInt16(bitPattern: $0) }
+        let (samples, slope, intercept) = try decode(stored, bits: 16, signed: true,
+                                                     invert: false, slope: 1, intercept: -1024)
+        for (sample, value) in zip(samples, values) {
+            XCTAssertEqual(Double(sample) * slope + intercept, Double(value) - 1024)
+        }
+    }
+
+    func testMonochrome1IsReflectedWithinBitsStored() throws {
+        let stored = (0..<(width * height)).map { UInt16(($0 * 53) % 4096) }
+        let (samples, slope, intercept) = try decode(stored, bits: 12, signed: false,
+                                                     invert: true, slope: 1, intercept: 0)
+        XCTAssertEqual(slope, 1)
+        XCTAssertEqual(intercept, 0)
+        XCTAssertEqual(samples, stored.map { 4095 - $0 })
+    }
+
+    func testMonochrome1IsReflectedIn8BitFrames() throws {
+        let stored = (0..<(width * height)).map { UInt8(($0 * 29) % 256) }
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(stored, width: width, height: height,
+                                                               components: 1))
+        let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream))
+        let gray = CompressedPixelRouter.nativeGrayTransform(info: info, invert: true,
+                                                             slope: 1, intercept: 0)
+        let result = try XCTUnwrap(J2KNativeDecoder.decode(codestream, transform: gray.transform))
+        XCTAssertEqual(result.pixels8, stored.map { 255 - $0 })
+    }
+
+    /// A slope of 2 needs 9 bits, so 8-bit samples come back as 16-bit ones.
+    func testRescaleWidens8BitFrames() throws {
+        let stored = (0..<(width * height)).map { UInt8(($0 * 29) % 256) }
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(stored, width: width, height: height,
+                                                               components: 1))
+        let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream))
+        let gray = CompressedPixelRouter.nativeGrayTransform(info: info, invert: false,
+                                                             slope: 2, intercept: -100)
+        let result = try XCTUnwrap(J2KNativeDecoder.decode(codestream, transform: gray.transform))
+        let samples = try XCTUnwrap(result.pixels16)
+        for (sample, value) in zip(samples, stored) {
+            XCTAssertEqual(Double(sample) * gray.slope + gray.intercept, Double(value) * 2 - 100)
+        }
+    }
+
+    func testFractionalRescaleIsLeftToTheFrame() throws {
+        let stored = (0..<(width * height)).map { UInt16(($0 * 41) % 1024) }
+        let (samples, slope, intercept) = try decode(stored, bits: 10, signed: false,
+                                                     invert: false, slope: 0.25, intercept: 3)
+        XCTAssertEqual(slope, 0.25)
+        XCTAssertEqual(intercept, 3)
+        XCTAssertEqual(samples, stored)
+    }
+
+    private func decode(_ stored: [UInt16], bits: Int, signed: Bool, invert: Bool,
+                        slope: Double, intercept: Double,
+                        file: StaticString = #filePath, line: UInt = #line) throws
+        -> (samples: [UInt16], slope: Double, intercept: Double) {
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(stored, width: width, height: height,
+                                                               components: 1, bitsStored: bits,
+                                                               isSigned: signed),
+                                       file: file, line: line)
+        let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream), file: file, line: line)
+        let gray = CompressedPixelRouter.nativeGrayTransform(info: info, invert: invert,
+                                                             slope: slope, intercept: intercept)
+        let result = try XCTUnwrap(J2KNativeDecoder.decode(codestream, transform: gray.transform),
+                                   file: file, line: line)
+        XCTAssertFalse(result.isSigned, file: file, line: line)
+        let samples = result.pixels16 ?? result.pixels8.map { $0.map(UInt16.init) }
+        return (try XCTUnwrap(samples, file: file, line: line), gray.slope, gray.intercept)
+    }
+}
@@ -0,0 +1,87 @@
+import XCTest
+@testable import DcmSwift
+
+/// Encodes and decodes the same images with the kernels capped at each
+/// instruction set, and compares the codestreams and samples with those of
+/// the generic kernels. They must match exactly, lossy coding included:
+/// the SIMD kernels follow the operations of the generic ones, and OpenJPH
+/// is built without floating point contraction.
+final class InstructionSetCapTests: XCTestCase {
+    private let width = 203, height = 118
+    private let caps: [J2KNativeInstructionSet] = [.sse2, .ssse3, .avx, .avx2, .all]
+
+    override func tearDown() {
+        J2KNativeDecoder.instructionSet = .all
+        super.tearDown()
+    }
+
+    private struct Case {
+        let name: String
+        let components: Int
+        let bits: Int
+        let options: J2KNativeEncodingOptions
+    }
+
+    private let cases: [Case] = [
+        Case(name: "reversible gray", components: 1, bits: 12,
+             options: J2KNativeEncodingOptions()),
+        Case(name: "irreversible gray", components: 1, bits: 12,
+             options: J2KNativeEncodingOptions(lossless: false, quantizationStep: 0.002)),
+        Case(name: "16-bit tiles", components: 1, bits: 16,
+             options: J2KNativeEncodingOptions(blockWidth: 32, blockHeight: 32,
+                                               tileSize: (width: 96, height: 64))),
+        Case(name: "RCT", components: 3, bits: 8,
+             options: J2KNativeEncodingOptions(colorTransform: true)),
+        Case(name: "ICT", components: 3, bits: 8,
+             options: J2KNativeEncodingOptions(lossless: false, colorTransform: true,
+                                               quantizationStep: 0.004)),
+    ]
+
+    private func samples(components: Int, bits: Int) -> [UInt16] {
+        (0..<(width * height * components)).map { i in
+            let pixel = i / components, x = pixel % width, y = pixel / width
+            let value = (x * 41 + y * 23 + (i % components) * 300 + (x * y) % 61) * 7
+            return UInt16(value % (1 << bits))
+        }
+    }
+
+    private func encode(_ test: Case) -> Data? {
+        let pixels = samples(components: test.components, bits: test.bits)
+        if test.bits <= 8 {
+            return J2KNativeEncoder.encode(pixels.map { UInt8($0) }, width: width, height: height,
+                                           components: test.components, options: test.options)
+        }
+        return J2KNativeEncoder.encode(pixels, width: width, height: height,
+                                       components: test.components, bitsStored: test.bits,
+                                       options: test.options)
+    }
+
+    private func decodes(_ codestream: Data) throws -> [[Float]] {
+        let integer = try XCTUnwrap(J2KNativeDecoder.decode(codestream))
+        let samples = integer.pixels8.map { $0.map(Float.init) }
+            ?? integer.pixels16.map { $0.map(Float.init) }
+        let planar = try XCTUnwrap(J2KNativeDecoder.decode(codestream, planar: true))
+        let planes = planar.pixels8.map { $0.map(Float.init) }
+            ?? planar.pixels16.map { $0.map(Float.init) }
+        let float = try XCTUnwrap(J2KNativeDecoder.decode(codestream, format: .float32))
+        return [try XCTUnwrap(samples), try XCTUnwrap(planes), try XCTUnwrap(float.pixels32)]
+    }
+
+    func testCapsMatchGenericKernels() throws {
+        for test in cases {
+            J2KNativeDecoder.instructionSet = .generic
+            let codestream = try XCTUnwrap(encode(test), test.name)
+            let reference = try decodes(codestream)
+            for cap in caps {
+                J2KNativeDecoder.instructionSet = cap
+                XCTAssertEqual(encode(test), codestream, "\(test.name), encoded with \(cap)")
+                let decoded = try decodes(codestream)
+                for (index, output) in ["interleaved", "planar", "float"].enumerated() {
+                    XCTAssertEqual(decoded[index].count, reference[index].count)
+                    let differing = zip(decoded[index], reference[index]).filter { $0 != $1 }.count
+                    XCTAssertEqual(differing, 0, "\(test.name), \(output) decode with \(cap)")
+                }
+            }
+        }
+    }
+}
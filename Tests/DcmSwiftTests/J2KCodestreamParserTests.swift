@@ -0,0 +1,49 @@
+import XCTest
+@testable import DcmSwift
+
+final class J2KCodestreamParserTests: XCTestCase {
+    private func codestream() throws -> Data {
+        let samples = (0..<(13 * 7)).map { UInt16($0 * 37 % 1024) }
+        return try XCTUnwrap(J2KNativeEncoder.encode(samples, width: 13, height: 7,
+                                                     components: 1, bitsStored: 10))
+    }
+
+    private func check(_ info: J2KCodestreamInfo, file: StaticString = #filePath, line: UInt = #line) {
+        XCTAssertEqual(info.width, 13, file: file, line: line)
+        XCTAssertEqual(info.height, 7, file: file, line: line)
+        XCTAssertEqual(info.components, 1, file: file, line: line)
+        XCTAssertEqual(info.bitsPerComponent, 10, file: file, line: line)
+        XCTAssertFalse(info.isSigned, file: file, line: line)
+    }
+
+    func testCodestream() throws {
+        check(try J2KCodestreamParser.parseSIZ(codestream()))
+    }
+
+    /// Padding, or the boxes of a JP2 file ahead of its contiguous codestream
+    /// box, are skipped.
+    func testLeadingBytesAreSkipped() throws {
+        let codestream = try codestream()
+        check(try J2KCodestreamParser.parseSIZ(Data(repeating: 0, count: 5) + codestream))
+
+        var box = Data([0x00, 0x00, 0x00, 0x0C, 0x6A, 0x50, 0x20, 0x20, 0x0D, 0x0A, 0x87, 0x0A])
+        let length = UInt32(8 + codestream.count)
+        box += [UInt8(length >> 24), UInt8(length >> 16 & 0xFF), UInt8(length >> 8 & 0xFF), UInt8(length & 0xFF)]
+        box += Array("jp2c".utf8)
+        check(try J2KCodestreamParser.parseSIZ(box + codestream))
+    }
+
+    func testSliceOfLargerBuffer() throws {
+        let buffer = Data([0xFF, 0x4F, 0xFF]) + (try codestream())
+        check(try J2KCodestreamParser.parseSIZ(buffer[2...]))
+    }
+
+    func testMissingSOC() throws {
+        let codestream = try codestream()
+        XCTAssertThrowsError(try J2KCodestreamParser.parseSIZ(codestream.dropFirst(2))) {
+            guard case J2KParseError.sizNotFound = $0 else {
+                return XCTFail("\($0)")
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#if canImport(Metal)
+import XCTest
+import Metal
+@testable import DcmSwift
+
+/// Compares the textures of the Metal synthesis with the samples the CPU
+/// decoder returns for the same codestreams, mapped as the output kernel
+/// maps them without a window: the nominal range to black and white.
+/// Conversion to 8-bit unorm may round either way, and the float synthesis
+/// of lossy codestreams may differ from the CPU's by a sample; a missing
+/// barrier between the passes would show up as far larger differences.
+final class J2KMetalSynthesisTests: XCTestCase {
+    private let width = 141, height = 77
+
+    private func gray(bits: Int) -> [UInt16] {
+        (0..<(width * height)).map { i in
+            let x = i % width, y = i / width
+            return UInt16((x * 29 + y * 53 + (x * y) % 97) % (1 << bits))
+        }
+    }
+
+    private func texture(_ codestream: Data) throws -> [UInt8] {
+        let synthesis = J2KMetalSynthesis.shared
+        guard synthesis.isAvailable else { throw XCTSkip("Metal synthesis is unavailable") }
+        let texture = try XCTUnwrap(synthesis.decode(codestream))
+        XCTAssertEqual(texture.width, width)
+        XCTAssertEqual(texture.height, height)
+        #if os(macOS)
+        if texture.storageMode == .managed, let queue = texture.device.makeCommandQueue(),
+           let commandBuffer = queue.makeCommandBuffer(),
+           let blit = commandBuffer.makeBlitCommandEncoder() {
+            blit.synchronize(resource: texture)
+            blit.endEncoding()
+            commandBuffer.commit()
+            commandBuffer.waitUntilCompleted()
+        }
+        #endif
+        var bytes = [UInt8](repeating: 0, count: width * height * 4)
+        texture.getBytes(&bytes, bytesPerRow: width * 4,
+                         from: MTLRegionMake2D(0, 0, width, height), mipmapLevel: 0)
+        return bytes
+    }
+
+    /// The red channel of gray textures, or every colour channel, against
+    /// `expected`, samples of `bits` bits, `components` per pixel.
+    private func compare(_ bytes: [UInt8], _ expected: [UInt16], bits: Int, components: Int,
+                         tolerance: Int, file: StaticString = #filePath, line: UInt = #line) {
+        let top = Double((1 << bits) - 1)
+        var worst = 0
+        for pixel in 0..<(width * height) {
+            for c in 0..<(components == 3 ? 3 : 1) {
+                let sample = Double(expected[pixel * components + c])
+                let reference = Int((sample / top * 255).rounded())
+                worst = max(worst, abs(Int(bytes[pixel * 4 + c]) - reference))
+            }
+        }
+        XCTAssertLessThanOrEqual(worst, tolerance, file: file, line: line)
+    }
+
+    func testReversibleGray() throws {
+        let samples = gray(bits: 12)
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 1, bitsStored: 12))
+        compare(try texture(codestream), samples, bits: 12, components: 1, tolerance: 1)
+    }
+
+    func testIrreversibleGray() throws {
+        let samples = gray(bits: 12)
+        let options = J2KNativeEncodingOptions(lossless: false, quantizationStep: 0.001)
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 1, bitsStored: 12,
+                                                               options: options))
+        let cpu = try XCTUnwrap(J2KNativeDecoder.decode(codestream)?.pixels16)
+        compare(try texture(codestream), cpu, bits: 12, components: 1, tolerance: 1)
+    }
+
+    func testReversibleColour() throws {
+        let samples = (0..<(width * height * 3)).map { UInt8(($0 * 7 + $0 / 3 * 11) % 256) }
+        let options = J2KNativeEncodingOptions(colorTransform: true)
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 3, options: options))
+        compare(try texture(codestream), samples.map(UInt16.init), bits: 8, components: 3,
+                tolerance: 1)
+    }
+
+    func testIrreversibleColour() throws {
+        let samples = (0..<(width * height * 3)).map { UInt8(($0 * 7 + $0 / 3 * 11) % 256) }
+        let options = J2KNativeEncodingOptions(lossless: false, colorTransform: true,
+                                               quantizationStep: 0.002)
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 3, options: options))
+        let cpu = try XCTUnwrap(J2KNativeDecoder.decode(codestream)?.pixels8)
+        compare(try texture(codestream), cpu.map(UInt16.init), bits: 8, components: 3,
+                tolerance: 2)
+    }
+}
+#endif
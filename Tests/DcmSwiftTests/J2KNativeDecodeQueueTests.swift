@@ -0,0 +1,62 @@
+import XCTest
+@testable import DcmSwift
+
+/// Runs decodes through a `J2KNativeDecodeQueue` of one slot, held busy by a
+/// first job whose completion waits, so that the order of the others and
+/// their cancellation do not depend on timing.
+final class J2KNativeDecodeQueueTests: XCTestCase {
+    private let width = 75, height = 53
+
+    private func samples(_ frame: Int) -> [UInt16] {
+        (0..<(width * height)).map { UInt16(($0 * 37 + frame * 997) % 4096) }
+    }
+
+    private func codestream(_ frame: Int) throws -> Data {
+        try XCTUnwrap(J2KNativeEncoder.encode(samples(frame), width: width, height: height,
+                                              components: 1, bitsStored: 12))
+    }
+
+    func testPriorityAndCancellation() throws {
+        let queue = try XCTUnwrap(J2KNativeDecodeQueue(maxJobs: 1))
+        let lock = NSLock()
+        var completed: [Int] = []
+        var pixels: [Int: [UInt16]] = [:]
+        let started = DispatchSemaphore(value: 0), proceed = DispatchSemaphore(value: 0)
+        let done = expectation(description: "completions")
+        done.expectedFulfillmentCount = 4
+
+        func submit(_ frame: Int) throws -> UInt64 {
+            try XCTUnwrap(queue.submit(codestream(frame)) { result in
+                if frame == 0 {
+                    started.signal()
+                    proceed.wait()
+                }
+                lock.lock()
+                completed.append(frame)
+                pixels[frame] = result?.pixels16
+                lock.unlock()
+                done.fulfill()
+            })
+        }
+
+        _ = try submit(0)
+        started.wait()
+        defer { proceed.signal() }  // lets the queue go, should a check throw
+        let jobs = try (1...3).map { try submit($0) }
+        XCTAssertTrue(queue.setPriority(5, of: jobs[2]))
+        XCTAssertTrue(queue.cancel(jobs[1]))
+        lock.lock()
+        XCTAssertEqual(completed, [2])
+        lock.unlock()
+        proceed.signal()
+        wait(for: [done], timeout: 30)
+
+        XCTAssertEqual(completed, [2, 0, 3, 1])
+        for frame in [0, 1, 3] {
+            XCTAssertEqual(pixels[frame], samples(frame), "frame \(frame)")
+        }
+        XCTAssertNil(pixels[2])
+        XCTAssertFalse(queue.cancel(jobs[0]))
+        XCTAssertFalse(queue.setPriority(1, of: jobs[2]))
+    }
+}
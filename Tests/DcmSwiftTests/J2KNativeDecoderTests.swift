@@ -0,0 +1,79 @@
+import XCTest
+@testable import DcmSwift
+
+/// Decodes lossless codestreams through the reduced decode entry points of
+/// the native decoder and checks them against full decodes.
+final class J2KNativeDecoderTests: XCTestCase {
+    private let width = 75, height = 53
+
+    private func samples() -> [UInt16] {
+        (0..<(width * height)).map { i in
+            let x = i % width, y = i / width
+            return UInt16((x * 37 + y * 59 + (x * y) % 89) % 4096)
+        }
+    }
+
+    private func codestream(tileSize: (width: Int, height: Int)? = nil) throws -> Data {
+        try XCTUnwrap(J2KNativeEncoder.encode(samples(), width: width, height: height,
+                                              components: 1, bitsStored: 12,
+                                              options: J2KNativeEncodingOptions(tileSize: tileSize)))
+    }
+
+    /// Each discarded level halves the size, rounding up, down to the five
+    /// levels of the codestream; a preview of the whole codestream is the
+    /// thumbnail of the levels it discards.
+    func testThumbnailsAndPreviews() throws {
+        let codestream = try codestream()
+        let full = try XCTUnwrap(J2KNativeDecoder.decode(codestream))
+        for levels in 0...7 {
+            let thumbnail = try XCTUnwrap(J2KNativeDecoder.decodeThumbnail(codestream,
+                                                                           discardLevels: levels))
+            let scale = 1 << min(levels, 5)
+            XCTAssertEqual(thumbnail.width, (width + scale - 1) / scale, "\(levels) levels")
+            XCTAssertEqual(thumbnail.height, (height + scale - 1) / scale, "\(levels) levels")
+            if levels == 0 {
+                XCTAssertEqual(thumbnail.pixels16, full.pixels16)
+            }
+
+            let preview = try XCTUnwrap(J2KNativeDecoder.decodePreview(codestream,
+                                                                       minimumDiscardLevels: levels))
+            XCTAssertEqual(preview.discardLevels, min(levels, 5))
+            XCTAssertEqual(preview.result.pixels16, thumbnail.pixels16, "\(levels) levels")
+        }
+    }
+
+    private func crop(_ image: J2KNativeResult, x: Int, y: Int, width: Int, height: Int) -> [UInt16]? {
+        image.pixels16.map { pixels in
+            (y..<(y + height)).flatMap { row in pixels[(row * image.width + x)..<(row * image.width + x + width)] }
+        }
+    }
+
+    /// A region is the crop of the image at its resolution, as one tile or
+    /// as several, and is clipped to the image.
+    func testRegionsMatchCrops() throws {
+        let tileSizes: [(width: Int, height: Int)?] = [nil, (width: 40, height: 24)]
+        for tileSize in tileSizes {
+            let codestream = try codestream(tileSize: tileSize)
+            for levels in 0...2 {
+                let image = try XCTUnwrap(J2KNativeDecoder.decodeThumbnail(codestream,
+                                                                           discardLevels: levels))
+                let x = 13 >> levels, y = 9 >> levels, w = 31 >> levels, h = 22 >> levels
+                let region = try XCTUnwrap(J2KNativeDecoder.decodeRegion(codestream, x: x, y: y,
+                                                                         width: w, height: h,
+                                                                         discardLevels: levels))
+                XCTAssertEqual(region.width, w)
+                XCTAssertEqual(region.height, h)
+                XCTAssertEqual(region.pixels16, crop(image, x: x, y: y, width: w, height: h),
+                               "\(levels) levels")
+            }
+
+            let image = try XCTUnwrap(J2KNativeDecoder.decode(codestream))
+            let clipped = try XCTUnwrap(J2KNativeDecoder.decodeRegion(codestream, x: 60, y: 40,
+                                                                      width: 40, height: 40))
+            XCTAssertEqual(clipped.width, width - 60)
+            XCTAssertEqual(clipped.height, height - 40)
+            XCTAssertEqual(clipped.pixels16, crop(image, x: 60, y: 40, width: width - 60,
+                                                  height: height - 40))
+        }
+    }
+}
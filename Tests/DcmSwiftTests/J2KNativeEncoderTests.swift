@@ -0,0 +1,222 @@
+import XCTest
+@testable import DcmSwift
+
+/// Encodes images with the native encoder and decodes them back with the
+/// native decoder; lossless codestreams must give back the samples exactly.
+final class J2KNativeEncoderTests: XCTestCase {
+    private let width = 75, height = 53
+
+    private func gray12() -> [UInt16] {
+        (0..<(width * height)).map { i in
+            let x = i % width, y = i / width
+            return UInt16((x * 37 + y * 59 + (x * y) % 89) % 4096)
+        }
+    }
+
+    private func rgb8() -> [UInt8] {
+        (0..<(width * height * 3)).map { UInt8(($0 * 7 + $0 / 3 * 11) % 256) }
+    }
+
+    /// Largest difference between the decoded samples and `expected`.
+    private func worstError(_ codestream: Data, _ expected: [UInt16],
+                            file: StaticString = #filePath, line: UInt = #line) throws -> Int {
+        let decoded = try XCTUnwrap(J2KNativeDecoder.decode(codestream)?.pixels16,
+                                    file: file, line: line)
+        XCTAssertEqual(decoded.count, expected.count, file: file, line: line)
+        return zip(decoded, expected).map { abs(Int($0) - Int($1)) }.max() ?? 0
+    }
+
+    func testProgressionsRoundTrip() throws {
+        let samples = gray12()
+        let orders: [(J2KNativeProgression, String)] = [(.rpcl, "RPCL"), (.lrcp, "LRCP"),
+                                                        (.rlcp, "RLCP"), (.pcrl, "PCRL"),
+                                                        (.cprl, "CPRL")]
+        for (progression, name) in orders {
+            let options = J2KNativeEncodingOptions(progression: progression)
+            let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width,
+                                                                   height: height, components: 1,
+                                                                   bitsStored: 12, options: options))
+            XCTAssertEqual(J2KNativeDecoder.probe(codestream)?.progression, name)
+            XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels16, samples, name)
+        }
+    }
+
+    func testCodingStructureRoundTrip() throws {
+        let samples = gray12()
+        let options = J2KNativeEncodingOptions(decompositions: 2, blockWidth: 32, blockHeight: 16,
+                                               tileSize: (width: 40, height: 24))
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 1, bitsStored: 12,
+                                                               options: options))
+        let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream))
+        XCTAssertEqual(info.decompositionLevels, 2)
+        XCTAssertEqual(info.blockWidth, 32)
+        XCTAssertEqual(info.blockHeight, 16)
+        XCTAssertEqual(info.tileWidth, 40)
+        XCTAssertEqual(info.tileHeight, 24)
+        XCTAssertEqual(info.tilesAcross, 2)
+        XCTAssertEqual(info.tilesDown, 3)
+        XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels16, samples)
+    }
+
+    func testColourRoundTrip() throws {
+        let samples = rgb8()
+        for colorTransform in [false, true] {
+            let options = J2KNativeEncodingOptions(colorTransform: colorTransform)
+            let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width,
+                                                                   height: height, components: 3,
+                                                                   options: options))
+            XCTAssertEqual(J2KNativeDecoder.probe(codestream)?.usesColorTransform, colorTransform)
+            XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels8, samples)
+        }
+
+        let planes = (0..<samples.count).map { samples[$0 % (width * height) * 3 + $0 / (width * height)] }
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(planes, width: width, height: height,
+                                                               components: 3, planar: true))
+        XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels8, samples)
+        XCTAssertEqual(J2KNativeDecoder.decode(codestream, planar: true)?.pixels8, planes)
+    }
+
+    /// Signed samples come back as two's complement 16-bit words, 8-bit ones
+    /// included.
+    func testSignedRoundTrip() throws {
+        let samples12 = gray12().map { UInt16(bitPattern: Int16($0) - 2048) }
+        let codestream12 = try XCTUnwrap(J2KNativeEncoder.encode(samples12, width: width,
+                                                                 height: height, components: 1,
+                                                                 bitsStored: 12, isSigned: true))
+        XCTAssertEqual(J2KNativeDecoder.probe(codestream12)?.isSigned, true)
+        XCTAssertEqual(J2KNativeDecoder.decode(codestream12)?.pixels16, samples12)
+
+        let values = (0..<(width * height)).map { Int8(truncatingIfNeeded: $0 * 29) }
+        let codestream8 = try XCTUnwrap(J2KNativeEncoder.encode(values.map { UInt8(bitPattern: $0) },
+                                                                width: width, height: height,
+                                                                components: 1, isSigned: true))
+        XCTAssertEqual(J2KNativeDecoder.decode(codestream8)?.pixels16,
+                       values.map { UInt16(bitPattern: Int16($0)) })
+    }
+
+    /// Lossy codestreams are irreversible, smaller than lossless ones and
+    /// within a few quantization steps of the samples; coarser steps trade
+    /// error for size.
+    func testLossyRoundTrip() throws {
+        let samples = gray12()
+        let lossless = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                             components: 1, bitsStored: 12))
+        var previous = lossless.count
+        for (step, bound) in [(Float(0.002), 32), (0.02, 256)] {
+            let options = J2KNativeEncodingOptions(lossless: false, quantizationStep: step)
+            let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width,
+                                                                   height: height, components: 1,
+                                                                   bitsStored: 12, options: options))
+            XCTAssertEqual(J2KNativeDecoder.probe(codestream)?.isReversible, false)
+            XCTAssertLessThan(codestream.count, previous, "step \(step)")
+            XCTAssertLessThanOrEqual(try worstError(codestream, samples), bound, "step \(step)")
+            previous = codestream.count
+        }
+    }
+
+    /// Images a single sample wide or high still get a wavelet level.
+    func testDegenerateSizesRoundTrip() throws {
+        for (width, height) in [(1, 1), (4, 1), (1, 4), (2, 1), (1, 7), (3, 3)] {
+            let samples8 = (0..<(width * height)).map { UInt8((17 + $0 * 31) % 256) }
+            let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples8, width: width,
+                                                                   height: height, components: 1))
+            let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream))
+            XCTAssertEqual(info.decompositionLevels, 1, "\(width)x\(height)")
+            let result = try XCTUnwrap(J2KNativeDecoder.decode(codestream))
+            XCTAssertEqual(result.pixels8, samples8, "\(width)x\(height)")
+
+            let samples16 = samples8.map { UInt16($0) << 4 | 0x9 }
+            let decoded = try XCTUnwrap(J2KNativeDecoder.decode(
+                XCTUnwrap(J2KNativeEncoder.encode(samples16, width: width, height: height,
+                                                  components: 1, bitsStored: 12))))
+            XCTAssertEqual(decoded.pixels16, samples16, "\(width)x\(height)")
+        }
+    }
+
+    private func markers(_ marker: UInt8, in codestream: Data) -> Int {
+        zip(codestream, codestream.dropFirst()).filter { $0 == 0xFF && $1 == marker }.count
+    }
+
+    /// One PLT marker segment per tile-part when asked for, none otherwise.
+    func testPacketLengthsRoundTrip() throws {
+        let samples = gray12()
+        let tileSizes: [(width: Int, height: Int)?] = [nil, (width: 40, height: 24)]
+        for tileSize in tileSizes {
+            for packetLengths in [false, true] {
+                let options = J2KNativeEncodingOptions(tileSize: tileSize,
+                                                       packetLengths: packetLengths)
+                let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width,
+                                                                       height: height, components: 1,
+                                                                       bitsStored: 12,
+                                                                       options: options))
+                XCTAssertEqual(markers(0x58, in: codestream),
+                               packetLengths ? markers(0x90, in: codestream) : 0)
+                XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels16, samples)
+            }
+        }
+    }
+
+    /// Rows appended a few at a time give the codestream of a whole-image
+    /// encode, with one tile or a row of tiles at a time.
+    func testStreamEncoderMatchesEncode() throws {
+        let samples = gray12()
+        let tileSizes: [(width: Int, height: Int)?] = [nil, (width: 40, height: 24)]
+        for tileSize in tileSizes {
+            let options = J2KNativeEncodingOptions(tileSize: tileSize)
+            let expected = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width,
+                                                                 height: height, components: 1,
+                                                                 bitsStored: 12, options: options))
+            var codestream = Data()
+            let encoder = try XCTUnwrap(J2KNativeStreamEncoder(width: width, height: height,
+                                                               components: 1, bitsStored: 12,
+                                                               options: options) {
+                codestream.append(contentsOf: $0)
+                return true
+            })
+            for first in stride(from: 0, to: height, by: 7) {
+                let rows = samples[(first * width)..<(min(first + 7, height) * width)]
+                XCTAssertTrue(rows.withUnsafeBytes { encoder.append(rows: $0) })
+            }
+            XCTAssertTrue(encoder.finish())
+            XCTAssertEqual(codestream, expected)
+        }
+    }
+
+    private func uint32(_ data: Data, at offset: Int) -> Int {
+        (0..<4).reduce(0) { $0 | Int(data[data.startIndex + offset + $1]) << (8 * $1) }
+    }
+
+    /// The encapsulated Pixel Data holds the offset table, one even-length
+    /// fragment per frame with the frame's codestream, and the delimiter.
+    func testEncodeFramesFragments() throws {
+        let frames = (0..<3).map { frame in gray12().map { ($0 + UInt16(997 * frame)) % 4096 } }
+        let pixelData = Array(frames.joined()).withUnsafeBytes { Data($0) }
+        for basicOffsetTable in [true, false] {
+            let encoded = try XCTUnwrap(J2KNativeEncoder.encodeFrames(
+                pixelData: pixelData, frameCount: 3, width: width, height: height, components: 1,
+                bitsStored: 12, basicOffsetTable: basicOffsetTable))
+            let data = encoded.pixelData
+            XCTAssertEqual(Array(data.prefix(4)), [0xFE, 0xFF, 0x00, 0xE0])
+            let tableLength = uint32(data, at: 4)
+            XCTAssertEqual(tableLength, basicOffsetTable ? 12 : 0)
+            let fragments = 8 + tableLength
+            for (frame, samples) in frames.enumerated() {
+                let offset = Int(encoded.offsets[frame]), length = Int(encoded.lengths[frame])
+                if basicOffsetTable {
+                    XCTAssertEqual(uint32(data, at: 8 + 4 * frame), offset)
+                }
+                let item = fragments + offset
+                XCTAssertEqual(Array(data[(data.startIndex + item)..<(data.startIndex + item + 4)]),
+                               [0xFE, 0xFF, 0x00, 0xE0])
+                XCTAssertEqual(uint32(data, at: item + 4), (length + 1) & ~1)
+                let start = data.startIndex + item + 8
+                let codestream = data.subdata(in: start..<(start + length))
+                XCTAssertEqual(codestream, J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                                   components: 1, bitsStored: 12))
+                XCTAssertEqual(J2KNativeDecoder.decode(codestream)?.pixels16, samples)
+            }
+            XCTAssertEqual(Array(data.suffix(8)), [0xFE, 0xFF, 0xDD, 0xE0, 0, 0, 0, 0])
+        }
+    }
+}
@@ -0,0 +1,102 @@
+import XCTest
+@testable import DcmSwift
+
+/// Serves frames of 12-bit codestreams from a `J2KNativeFrameCache` and checks
+/// its counters, and the samples, against direct decodes.
+final class J2KNativeFrameCacheTests: XCTestCase {
+    private let width = 75, height = 53
+    private var frameBytes: Int { width * height * 2 }
+
+    private func codestreams(_ count: Int) throws -> [Data] {
+        try (0..<count).map { frame in
+            let samples = (0..<(width * height)).map { UInt16(($0 * 37 + frame * 997) % 4096) }
+            return try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                         components: 1, bitsStored: 12))
+        }
+    }
+
+    private func frame(_ cache: J2KNativeFrameCache, _ id: Int, _ codestreams: [Data],
+                       discardLevels: Int = 0) throws -> J2KNativeCachedFrame {
+        try XCTUnwrap(cache.frame(UInt64(id), codestream: codestreams[id],
+                                  discardLevels: discardLevels))
+    }
+
+    /// A second request is a hit that shares the samples of the first.
+    func testHitSharesTheDecodedFrame() throws {
+        let codestreams = try codestreams(1)
+        let cache = try XCTUnwrap(J2KNativeFrameCache(budgetBytes: 4 * frameBytes))
+        let first = try frame(cache, 0, codestreams)
+        XCTAssertEqual(cache.statistics.misses, 1)
+        XCTAssertEqual(cache.statistics.hits, 0)
+        let second = try frame(cache, 0, codestreams)
+        XCTAssertEqual(cache.statistics.hits, 1)
+        XCTAssertEqual(second.pixels16?.baseAddress, first.pixels16?.baseAddress)
+        XCTAssertEqual(second.result().pixels16, J2KNativeDecoder.decode(codestreams[0])?.pixels16)
+        XCTAssertEqual(cache.statistics.framesInUse, 1)
+        XCTAssertEqual(cache.statistics.lockedBytes, frameBytes)
+    }
+
+    /// The least recently used frame goes first, pinned frames stay, and
+    /// evicted ones are decoded again.
+    func testBudgetEvictsLeastRecentlyUsed() throws {
+        let codestreams = try codestreams(3)
+        let cache = try XCTUnwrap(J2KNativeFrameCache(budgetBytes: 2 * frameBytes + 100))
+        for id in 0..<3 {
+            _ = try frame(cache, id, codestreams)
+        }
+        XCTAssertEqual(cache.statistics.frames, 2)
+        XCTAssertEqual(cache.statistics.evictions, 1)
+        XCTAssertEqual(cache.statistics.cachedBytes, 2 * frameBytes)
+        _ = try frame(cache, 2, codestreams)
+        XCTAssertEqual(cache.statistics.hits, 1)
+        _ = try frame(cache, 0, codestreams)
+        XCTAssertEqual(cache.statistics.misses, 4)
+
+        cache.pin(1)
+        for id in [1, 0, 2, 0, 2] {
+            _ = try frame(cache, id, codestreams)
+        }
+        let hits = cache.statistics.hits
+        _ = try frame(cache, 1, codestreams)
+        XCTAssertEqual(cache.statistics.hits, hits + 1)
+        cache.unpin(1)
+
+        cache.evict(1)
+        let misses = cache.statistics.misses
+        _ = try frame(cache, 1, codestreams)
+        XCTAssertEqual(cache.statistics.misses, misses + 1)
+
+        cache.removeAll()
+        XCTAssertEqual(cache.statistics.frames, 0)
+        XCTAssertEqual(cache.statistics.cachedBytes, 0)
+    }
+
+    /// A frame larger than the budget is handed out without being kept.
+    func testFrameLargerThanBudgetIsNotKept() throws {
+        let codestreams = try codestreams(1)
+        let cache = try XCTUnwrap(J2KNativeFrameCache(budgetBytes: 100))
+        let frame = try frame(cache, 0, codestreams)
+        XCTAssertEqual(frame.result().pixels16, J2KNativeDecoder.decode(codestreams[0])?.pixels16)
+        XCTAssertEqual(cache.statistics.uncached, 1)
+        XCTAssertEqual(cache.statistics.frames, 0)
+    }
+
+    /// A full decode leaves `pyramidLevels` coarser images, which serve
+    /// zooming out as thumbnails would.
+    func testPyramidServesZoomingOut() throws {
+        let codestreams = try codestreams(1)
+        let cache = try XCTUnwrap(J2KNativeFrameCache(budgetBytes: 4 * frameBytes))
+        cache.pyramidLevels = 2
+        _ = try frame(cache, 0, codestreams)
+        XCTAssertEqual(cache.statistics.reducedFrames, 2)
+        for levels in 1...2 {
+            let reduced = try frame(cache, 0, codestreams, discardLevels: levels)
+            XCTAssertEqual(cache.statistics.hits, levels)
+            XCTAssertEqual(reduced.result().pixels16,
+                           J2KNativeDecoder.decodeThumbnail(codestreams[0],
+                                                            discardLevels: levels)?.pixels16)
+        }
+        _ = try frame(cache, 0, codestreams, discardLevels: 3)
+        XCTAssertEqual(cache.statistics.misses, 2)
+    }
+}
@@ -0,0 +1,104 @@
+import XCTest
+@testable import DcmSwift
+
+/// Decodes JPEG 2000 Part 1 codestreams with the native decoder and compares
+/// the samples with those the fixtures expect. The fixtures are written by
+/// Resources/make_j2k_part1.py, an encoder that shares no code with OpenJPH:
+/// one per codeblock style, then lossy 9/7 ones and ones in each progression
+/// order, some with precincts. No codestreams of a reference encoder or of
+/// ISO/IEC 15444-4 are available to the build. Lossless fixtures must decode
+/// exactly; lossy ones may differ by 1 from the double precision
+/// reconstruction of the generator.
+final class J2KPart1ConformanceTests: XCTestCase {
+    func testDefaultStyle() throws {
+        try check("default", width: 61, height: 45, components: 1, bits: 12, layers: 1)
+    }
+
+    func testBypass() throws {
+        try check("bypass", width: 53, height: 38, components: 1, bits: 16, layers: 2)
+    }
+
+    func testTermAllResetVerticallyCausal() throws {
+        try check("termall_reset_vcausal", width: 47, height: 50, components: 1, bits: 12, layers: 3)
+    }
+
+    func testSegmentationSymbols() throws {
+        try check("segmark", width: 40, height: 33, components: 3, bits: 8, layers: 1)
+    }
+
+    /// Codeblocks join in later layers, skip layers, and have segments split
+    /// between layers.
+    func testQualityLayers() throws {
+        try check("layers", width: 64, height: 41, components: 1, bits: 12, layers: 6)
+    }
+
+    func testAllStyles() throws {
+        try check("all_styles", width: 45, height: 29, components: 1, bits: 14, layers: 4)
+    }
+
+    func testIrreversible() throws {
+        try check("irreversible", width: 59, height: 43, components: 1, bits: 12, layers: 1,
+                  reversible: false)
+    }
+
+    func testIrreversibleLayersRLCP() throws {
+        try check("irreversible_layers", width: 50, height: 37, components: 3, bits: 8, layers: 3,
+                  progression: "RLCP", reversible: false)
+    }
+
+    func testPrecinctsRPCL() throws {
+        try check("rpcl_precincts", width: 57, height: 46, components: 2, bits: 10, layers: 3,
+                  progression: "RPCL")
+    }
+
+    func testPrecinctsPCRL() throws {
+        try check("pcrl_precincts", width: 45, height: 52, components: 3, bits: 8, layers: 2,
+                  progression: "PCRL")
+    }
+
+    func testIrreversiblePrecinctsCPRL() throws {
+        try check("cprl_irreversible", width: 62, height: 35, components: 2, bits: 12, layers: 4,
+                  progression: "CPRL", reversible: false)
+    }
+
+    private func check(_ name: String, width: Int, height: Int, components: Int,
+                       bits: Int, layers: Int, progression: String = "LRCP", reversible: Bool = true,
+                       file: StaticString = #filePath, line: UInt = #line) throws {
+        let codestream = try fixture(name, "j2k")
+        let raw = try fixture(name, "raw")
+        let reference = stride(from: 0, to: raw.count - 1, by: 2).map {
+            UInt16(raw[raw.startIndex + $0]) | UInt16(raw[raw.startIndex + $0 + 1]) << 8
+        }
+
+        let info = try XCTUnwrap(J2KNativeDecoder.probe(codestream), file: file, line: line)
+        XCTAssertFalse(info.isHighThroughput, file: file, line: line)
+        XCTAssertTrue(info.isDecodable, info.unsupportedReason ?? "", file: file, line: line)
+        XCTAssertEqual(info.qualityLayers, layers, file: file, line: line)
+        XCTAssertEqual(info.progression, progression, file: file, line: line)
+        XCTAssertEqual(info.isReversible, reversible, file: file, line: line)
+
+        let result = try XCTUnwrap(J2KNativeDecoder.decode(codestream), file: file, line: line)
+        XCTAssertEqual(result.width, width, file: file, line: line)
+        XCTAssertEqual(result.height, height, file: file, line: line)
+        XCTAssertEqual(result.components, components, file: file, line: line)
+        XCTAssertEqual(result.bitsPerSample, bits, file: file, line: line)
+        XCTAssertFalse(result.isSigned, file: file, line: line)
+
+        let samples = bits <= 8 ? result.pixels8.map { $0.map(UInt16.init) } : result.pixels16
+        let decoded = try XCTUnwrap(samples, file: file, line: line)
+        XCTAssertEqual(decoded.count, reference.count, file: file, line: line)
+        let tolerance = reversible ? 0 : 1
+        if let index = decoded.indices.first(where: {
+            $0 < reference.count && abs(Int(decoded[$0]) - Int(reference[$0])) > tolerance
+        }) {
+            XCTFail("\(name): sample \(index) is \(decoded[index]), not \(reference[index])",
+                    file: file, line: line)
+        }
+    }
+
+    private func fixture(_ name: String, _ ext: String) throws -> Data {
+        let url = try XCTUnwrap(Bundle.module.url(forResource: name, withExtension: ext,
+                                                  subdirectory: "J2KPart1"))
+        return try Data(contentsOf: url)
+    }
+}
@@ -0,0 +1,167 @@
+import XCTest
+import OpenJPH
+@testable import DcmSwift
+
+/// Calls the C entry points of the OpenJPH wrapper that the Swift decoder
+/// does not surface as such, e.g. to check the errors they report.
+final class OpenJPHWrapperTests: XCTestCase {
+    private let width = 29, height = 19
+
+    private func samples() -> [UInt8] {
+        (0..<(width * height)).map { UInt8(($0 * 13) % 251) }
+    }
+
+    private func codestream() throws -> Data {
+        try XCTUnwrap(J2KNativeEncoder.encode(samples(), width: width, height: height,
+                                              components: 1))
+    }
+
+    /// Writes `data` after `padding` bytes into a temporary file, and returns
+    /// its descriptor, open for reading.
+    private func file(_ data: Data, padding: Int = 0) throws -> Int32 {
+        let url = FileManager.default.temporaryDirectory
+            .appendingPathComponent("ojph-\(UUID().uuidString).j2k")
+        try (Data(repeating: 0xAA, count: padding) + data).write(to: url)
+        let descriptor = open(url.path, O_RDONLY)
+        try? FileManager.default.removeItem(at: url)
+        XCTAssertGreaterThanOrEqual(descriptor, 0)
+        return descriptor
+    }
+
+    private func decodeFile(_ descriptor: Int32, offset: UInt64, length: Int)
+        -> (status: ojph_status, image: ojph_decoded_image, error: String) {
+        var options = ojph_decode_options()
+        var image = ojph_decoded_image()
+        var error = [CChar](repeating: 0, count: 256)
+        let status = ojph_decode_file(nil, descriptor, offset, length, &options, &image,
+                                      &error, error.count)
+        return (status, image, String(cString: error))
+    }
+
+    func testDecodeFileRange() throws {
+        let codestream = try codestream()
+        let descriptor = try file(codestream, padding: 4099)
+        defer { close(descriptor) }
+        var result = decodeFile(descriptor, offset: 4099, length: codestream.count)
+        defer { ojph_free_image(&result.image) }
+        XCTAssertEqual(result.status, OJPH_STATUS_OK, result.error)
+        XCTAssertEqual(Int(result.image.width), width)
+        XCTAssertEqual(Int(result.image.height), height)
+        let pixels = try XCTUnwrap(result.image.pixels8)
+        XCTAssertEqual(Array(UnsafeBufferPointer(start: pixels, count: width * height)), samples())
+    }
+
+    func testDecodeFileReportsRangeBeyondEnd() throws {
+        let codestream = try codestream()
+        let descriptor = try file(codestream)
+        defer { close(descriptor) }
+        for (offset, length) in [(0, codestream.count + 1), (codestream.count + 8, 16)] {
+            let result = decodeFile(descriptor, offset: UInt64(offset), length: length)
+            XCTAssertEqual(result.status, OJPH_STATUS_ERROR)
+            XCTAssertTrue(result.error.contains("beyond the end of the file"), result.error)
+        }
+    }
+
+    func testDecodeFileReportsCodestreamErrors() throws {
+        let codestream = try codestream().dropFirst(2)  // no SOC
+        let descriptor = try file(codestream)
+        defer { close(descriptor) }
+        let result = decodeFile(descriptor, offset: 0, length: codestream.count)
+        XCTAssertEqual(result.status, OJPH_STATUS_ERROR)
+        XCTAssertTrue(result.error.contains("SIZ"), result.error)
+    }
+
+    private final class Subbands {
+        var bands: [ojph_subband] = []
+        var rows: [Int] = []
+        var lowest: [Int32] = []
+        let caller = pthread_self()
+        var otherThread = false
+    }
+
+    private func decodeSubbands(_ codestream: Data, discardLevels: UInt32 = 0,
+                                into subbands: Subbands) -> ojph_status {
+        var options = ojph_decode_options()
+        options.discard_levels = discardLevels
+        let context = Unmanaged.passUnretained(subbands).toOpaque()
+        return codestream.withUnsafeBytes { rawBuffer in
+            ojph_decode_subbands(nil, rawBuffer.bindMemory(to: UInt8.self).baseAddress,
+                                 rawBuffer.count, &options, { context, band, row, samples in
+                guard let context = context, let band = band?.pointee else { return 0 }
+                let subbands = Unmanaged<Subbands>.fromOpaque(context).takeUnretainedValue()
+                subbands.otherThread = subbands.otherThread || pthread_equal(pthread_self(), subbands.caller) == 0
+                if row == 0 {
+                    subbands.bands.append(band)
+                    subbands.rows.append(0)
+                }
+                XCTAssertEqual(Int(row), subbands.rows[subbands.rows.count - 1])
+                subbands.rows[subbands.rows.count - 1] += 1
+                if band.resolution == 0, let samples = samples {
+                    let values = samples.assumingMemoryBound(to: Int32.self)
+                    subbands.lowest += UnsafeBufferPointer(start: values, count: Int(band.width))
+                }
+                return 1
+            }, context, nil, 0)
+        }
+    }
+
+    /// Subbands come resolution by resolution, each row by row from its
+    /// top, on the calling thread; the bands of a resolution split its
+    /// samples between low- and high-pass ones. The lowest band of a
+    /// reversible codestream is its coarsest thumbnail before the DC shift.
+    func testDecodeSubbands() throws {
+        let width = 75, height = 53
+        let samples = (0..<(width * height)).map { UInt16(($0 % width * 37 + $0 / width * 59) % 4096) }
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: width, height: height,
+                                                               components: 1, bitsStored: 12))
+        let subbands = Subbands()
+        XCTAssertEqual(decodeSubbands(codestream, into: subbands), OJPH_STATUS_OK)
+        XCTAssertFalse(subbands.otherThread)
+        XCTAssertEqual(subbands.bands.count, 1 + 3 * 5)
+        var previous = (width: 0, height: 0)
+        for (index, band) in subbands.bands.enumerated() {
+            let resolution = index == 0 ? 0 : (index - 1) / 3 + 1
+            XCTAssertEqual(Int(band.resolution), resolution)
+            XCTAssertEqual(Int(band.band), index == 0 ? 0 : (index - 1) % 3 + 1)
+            XCTAssertEqual(subbands.rows[index], Int(band.height))
+            let scale = 1 << (5 - resolution)
+            let resWidth = (width + scale - 1) / scale, resHeight = (height + scale - 1) / scale
+            XCTAssertEqual(Int(band.res_width), resWidth)
+            XCTAssertEqual(Int(band.res_height), resHeight)
+            let low = previous
+            let high = (width: resWidth - low.width, height: resHeight - low.height)
+            switch band.band {
+            case 0:
+                XCTAssertEqual(Int(band.width), resWidth)
+                XCTAssertEqual(Int(band.height), resHeight)
+            case 1:
+                XCTAssertEqual(Int(band.width), high.width)
+                XCTAssertEqual(Int(band.height), low.height)
+            case 2:
+                XCTAssertEqual(Int(band.width), low.width)
+                XCTAssertEqual(Int(band.height), high.height)
+            default:
+                XCTAssertEqual(Int(band.width), high.width)
+                XCTAssertEqual(Int(band.height), high.height)
+            }
+            if band.band == 0 || band.band == 3 {
+                previous = (resWidth, resHeight)
+            }
+        }
+
+        let thumbnail = try XCTUnwrap(J2KNativeDecoder.decodeThumbnail(codestream, discardLevels: 5))
+        XCTAssertEqual(subbands.lowest.map { UInt16($0 + 2048) }, thumbnail.pixels16)
+
+        let reduced = Subbands()
+        XCTAssertEqual(decodeSubbands(codestream, discardLevels: 2, into: reduced), OJPH_STATUS_OK)
+        XCTAssertEqual(reduced.bands.count, 1 + 3 * 3)
+    }
+
+    func testDecodeSubbandsNeedsOneTile() throws {
+        let samples = [UInt8](repeating: 7, count: 64 * 64)
+        let options = J2KNativeEncodingOptions(tileSize: (width: 32, height: 32))
+        let codestream = try XCTUnwrap(J2KNativeEncoder.encode(samples, width: 64, height: 64,
+                                                               components: 1, options: options))
+        XCTAssertEqual(decodeSubbands(codestream, into: Subbands()), OJPH_STATUS_UNSUPPORTED)
+    }
+}
@@ -0,0 +1,911 @@
+#!/usr/bin/env python3
+"""Writes the JPEG 2000 Part 1 conformance fixtures of J2KPart1ConformanceTests.
+
+Each fixture is a codestream, `<name>.j2k`, of a synthetic image, and the
+samples a decoder must reconstruct from it, `<name>.raw`: unsigned 16-bit
+little-endian samples, components interleaved. The encoder below follows
+ITU-T T.800 Annexes A to F and shares no code with OpenJPH, so the test
+compares the decoder against an independent reading of the standard: one
+tile, the reversible 5/3 or the irreversible 9/7 wavelet, any progression
+order, and one precinct per resolution or user-defined precincts.
+
+Lossless fixtures store the image itself. Lossy ones store its
+reconstruction by the reference decoder below, in double precision, with
+coefficients dequantised to the middle of their interval (r = 1/2, the usual
+choice of E.1.1.2); a decoder working in single precision may differ from it
+by 1 in a few samples.
+
+No reference encoder (OpenJPEG, Kakadu) or ISO/IEC 15444-4 codestream is
+available to the build, which is why the fixtures are written here.
+
+    python3 make_j2k_part1.py [output directory, J2KPart1 by default]
+"""
+
+import math
+import os
+import struct
+import sys
+
+# --- MQ coder, T.800 Annex C ---------------------------------------------
+
+# (Qe, NMPS, NLPS, SWITCH), Table C.2
+MQ_TABLE = [
+    (0x5601, 1, 1, 1), (0x3401, 2, 6, 0), (0x1801, 3, 9, 0),
+    (0x0AC1, 4, 12, 0), (0x0521, 5, 29, 0), (0x0221, 38, 33, 0),
+    (0x5601, 7, 6, 1), (0x5401, 8, 14, 0), (0x4801, 9, 14, 0),
+    (0x3801, 10, 14, 0), (0x3001, 11, 17, 0), (0x2401, 12, 18, 0),
+    (0x1C01, 13, 20, 0), (0x1601, 29, 21, 0), (0x5601, 15, 14, 1),
+    (0x5401, 16, 14, 0), (0x5101, 17, 15, 0), (0x4801, 18, 16, 0),
+    (0x3801, 19, 17, 0), (0x3401, 20, 18, 0), (0x3001, 21, 19, 0),
+    (0x2801, 22, 19, 0), (0x2401, 23, 20, 0), (0x2201, 24, 21, 0),
+    (0x1C01, 25, 22, 0), (0x1801, 26, 23, 0), (0x1601, 27, 24, 0),
+    (0x1401, 28, 25, 0), (0x1201, 29, 26, 0), (0x1101, 30, 27, 0),
+    (0x0AC1, 31, 28, 0), (0x09C1, 32, 29, 0), (0x08A1, 33, 30, 0),
+    (0x0521, 34, 31, 0), (0x0441, 35, 32, 0), (0x02A1, 36, 33, 0),
+    (0x0221, 37, 34, 0), (0x0141, 38, 35, 0), (0x0111, 39, 36, 0),
+    (0x0085, 40, 37, 0), (0x0049, 41, 38, 0), (0x0025, 42, 39, 0),
+    (0x0015, 43, 40, 0), (0x0009, 44, 41, 0), (0x0005, 45, 42, 0),
+    (0x0001, 45, 43, 0), (0x5601, 46, 46, 0),
+]
+
+CX_SC = 9     # 9 to 13
+CX_MR = 14    # 14 to 16
+CX_RL = 17
+CX_UNI = 18
+
+
+def initial_contexts():
+    """Table D.7: state 4 for ZC context 0, 3 for RL, 46 for UNI."""
+    cx = [[0, 0] for _ in range(19)]   # [index, mps]
+    cx[0][0] = 4
+    cx[CX_RL][0] = 3
+    cx[CX_UNI][0] = 46
+    return cx
+
+
+class MQEncoder:
+    def __init__(self):
+        self.out = bytearray([0])   # out[0] stands for the byte before BPST
+        self.a = 0x8000
+        self.c = 0
+        self.ct = 12
+
+    def encode(self, d, cx):
+        qe, nmps, nlps, switch = MQ_TABLE[cx[0]]
+        self.a -= qe
+        if d == cx[1]:                                      # CODEMPS
+            if self.a & 0x8000 == 0:
+                if self.a < qe:
+                    self.a = qe
+                else:
+                    self.c += qe
+                cx[0] = nmps
+                self.renorm()
+            else:
+                self.c += qe
+        else:                                               # CODELPS
+            if self.a < qe:
+                self.c += qe
+            else:
+                self.a = qe
+            if switch:
+                cx[1] = 1 - cx[1]
+            cx[0] = nlps
+            self.renorm()
+
+    def renorm(self):
+        while True:
+            self.a = (self.a << 1) & 0xFFFF
+            self.c <<= 1
+            self.ct -= 1
+            if self.ct == 0:
+                self.byte_out()
+            if self.a & 0x8000:
+                break
+
+    def byte_out(self):
+        if self.out[-1] == 0xFF:
+            self.out.append((self.c >> 20) & 0xFF)
+            self.c &= 0xFFFFF
+            self.ct = 7
+        elif self.c < 0x8000000:
+            self.out.append((self.c >> 19) & 0xFF)
+            self.c &= 0x7FFFF
+            self.ct = 8
+        else:
+            self.out[-1] += 1
+            if self.out[-1] == 0xFF:
+                self.c &= 0x7FFFFFF
+                self.out.append((self.c >> 20) & 0xFF)
+                self.c &= 0xFFFFF
+                self.ct = 7
+            else:
+                self.out.append((self.c >> 19) & 0xFF)
+                self.c &= 0x7FFFF
+                self.ct = 8
+
+    def length(self):
+        """Bytes that are final so far."""
+        return max(len(self.out) - 2, 0)
+
+    def flush(self):
+        temp = self.c + self.a                              # SETBITS
+        self.c |= 0xFFFF
+        if self.c >= temp:
+            self.c -= 0x8000
+        self.c <<= self.ct
+        self.byte_out()
+        self.c <<= self.ct
+        self.byte_out()
+        data = self.out[1:]
+        if data and data[-1] == 0xFF:
+            data = data[:-1]
+        return bytes(data)
+
+
+class RawEncoder:
+    """Arithmetic coding bypass, T.800 D.6."""
+
+    def __init__(self):
+        self.out = bytearray()
+        self.c = 0
+        self.ct = 8
+
+    def encode(self, d, cx=None):
+        self.c = (self.c << 1) | d
+        self.ct -= 1
+        if self.ct == 0:
+            self.out.append(self.c)
+            self.ct = 7 if self.c == 0xFF else 8
+            self.c = 0
+
+    def length(self):
+        return len(self.out)
+
+    def flush(self):
+        if self.ct != (7 if self.out and self.out[-1] == 0xFF else 8):
+            self.out.append(self.c << self.ct)
+        data = bytes(self.out)
+        if data and data[-1] == 0xFF:
+            data = data[:-1]
+        return data
+
+
+# --- Coefficient bit modelling, T.800 Annex D ----------------------------
+
+STYLE_BYPASS = 0x01
+STYLE_RESET = 0x02
+STYLE_TERMALL = 0x04
+STYLE_VCAUSAL = 0x08
+STYLE_SEGMARK = 0x20
+
+BAND_LL, BAND_HL, BAND_LH, BAND_HH = 0, 1, 2, 3
+
+
+def zc_context(band, h, v, d):
+    """Table D.1."""
+    if band == BAND_HH:
+        hv = h + v
+        if d >= 3:
+            return 8
+        if d == 2:
+            return 7 if hv >= 1 else 6
+        if d == 1:
+            return 5 if hv >= 2 else (4 if hv == 1 else 3)
+        return 2 if hv >= 2 else hv
+    if band == BAND_HL:
+        h, v = v, h
+    if h == 2:
+        return 8
+    if h == 1:
+        return 7 if v >= 1 else (6 if d >= 1 else 5)
+    if v == 2:
+        return 4
+    if v == 1:
+        return 3
+    return 2 if d >= 2 else d
+
+
+def sign_context(hc, vc):
+    """Tables D.2 and D.3: context and XOR bit."""
+    hc = max(-1, min(1, hc))
+    vc = max(-1, min(1, vc))
+    table = {
+        (1, 1): (13, 0), (1, 0): (12, 0), (1, -1): (11, 0),
+        (0, 1): (10, 0), (0, 0): (9, 0), (0, -1): (10, 1),
+        (-1, 1): (11, 1), (-1, 0): (12, 1), (-1, -1): (13, 1),
+    }
+    return table[(hc, vc)]
+
+
+class CodeBlock:
+    def __init__(self, coeffs, band, style):
+        self.h = len(coeffs)
+        self.w = len(coeffs[0]) if self.h else 0
+        self.mag = [[abs(c) for c in row] for row in coeffs]
+        self.neg = [[1 if c < 0 else 0 for c in row] for row in coeffs]
+        self.band = band
+        self.style = style
+        top = max((m for row in self.mag for m in row), default=0)
+        self.planes = top.bit_length()
+        self.num_passes = 3 * self.planes - 2 if self.planes else 0
+
+    # neighbourhood -------------------------------------------------------
+
+    def neighbours(self, y, x):
+        """(h, v, d, hc, vc) of the sample at (y, x)."""
+        below_ok = not (self.style & STYLE_VCAUSAL and y % 4 == 3)
+
+        def s(yy, xx):
+            if yy < 0 or xx < 0 or yy >= self.h or xx >= self.w:
+                return 0
+            if yy > y and not below_ok:
+                return 0
+            return self.sig[yy][xx]
+
+        def contrib(yy, xx):
+            if not s(yy, xx):
+                return 0
+            return -1 if self.neg[yy][xx] else 1
+
+        h = s(y, x - 1) + s(y, x + 1)
+        v = s(y - 1, x) + s(y + 1, x)
+        d = s(y - 1, x - 1) + s(y - 1, x + 1) + s(y + 1, x - 1) + s(y + 1, x + 1)
+        hc = contrib(y, x - 1) + contrib(y, x + 1)
+        vc = contrib(y - 1, x) + contrib(y + 1, x)
+        return h, v, d, hc, vc
+
+    def code_sign(self, y, x, coder, raw):
+        if raw:
+            coder.encode(self.neg[y][x])
+            return
+        _, _, _, hc, vc = self.neighbours(y, x)
+        ctx, xor = sign_context(hc, vc)
+        coder.encode(self.neg[y][x] ^ xor, self.cx[ctx])
+
+    def bit(self, y, x, p):
+        return (self.mag[y][x] >> p) & 1
+
+    def samples(self):
+        for y0 in range(0, self.h, 4):
+            for x in range(self.w):
+                for y in range(y0, min(y0 + 4, self.h)):
+                    yield y, x
+
+    # passes --------------------------------------------------------------
+
+    def sigprop(self, p, coder, raw):
+        for y, x in self.samples():
+            if self.sig[y][x]:
+                continue
+            h, v, d, _, _ = self.neighbours(y, x)
+            if h + v + d == 0:
+                continue
+            b = self.bit(y, x, p)
+            if raw:
+                coder.encode(b)
+            else:
+                coder.encode(b, self.cx[zc_context(self.band, h, v, d)])
+            if b:
+                self.code_sign(y, x, coder, raw)
+                self.sig[y][x] = 1
+            self.visited[y][x] = 1
+
+    def magref(self, p, coder, raw):
+        for y, x in self.samples():
+            if not self.sig[y][x] or self.visited[y][x]:
+                continue
+            if raw:
+                coder.encode(self.bit(y, x, p))
+            else:
+                if self.refined[y][x]:
+                    ctx = CX_MR + 2
+                else:
+                    h, v, d, _, _ = self.neighbours(y, x)
+                    ctx = CX_MR + (1 if h + v + d else 0)
+                coder.encode(self.bit(y, x, p), self.cx[ctx])
+            self.refined[y][x] = 1
+
+    def cleanup(self, p, coder):
+        for y0 in range(0, self.h, 4):
+            for x in range(self.w):
+                rows = range(y0, min(y0 + 4, self.h))
+                start = y0
+                if len(rows) == 4 and all(
+                        not self.sig[y][x] and not self.visited[y][x]
+                        and sum(self.neighbours(y, x)[:3]) == 0
+                        for y in rows):
+                    first = next((y for y in rows if self.bit(y, x, p)), None)
+                    if first is None:
+                        coder.encode(0, self.cx[CX_RL])
+                        continue
+                    coder.encode(1, self.cx[CX_RL])
+                    r = first - y0
+                    coder.encode(r >> 1, self.cx[CX_UNI])
+                    coder.encode(r & 1, self.cx[CX_UNI])
+                    self.code_sign(first, x, coder, False)
+                    self.sig[first][x] = 1
+                    start = first + 1
+                for y in range(start, y0 + len(rows)):
+                    if self.sig[y][x] or self.visited[y][x]:
+                        continue
+                    h, v, d, _, _ = self.neighbours(y, x)
+                    b = self.bit(y, x, p)
+                    coder.encode(b, self.cx[zc_context(self.band, h, v, d)])
+                    if b:
+                        self.code_sign(y, x, coder, False)
+                        self.sig[y][x] = 1
+        if self.style & STYLE_SEGMARK:
+            for b in (1, 0, 1, 0):
+                coder.encode(b, self.cx[CX_UNI])
+        self.visited = [[0] * self.w for _ in range(self.h)]
+
+    def is_raw(self, k):
+        return self.style & STYLE_BYPASS and k >= 10 and k % 3 != 0
+
+    def terminates(self, k):
+        if k == self.num_passes - 1 or self.style & STYLE_TERMALL:
+            return True
+        if not self.style & STYLE_BYPASS or k < 9:
+            return False
+        return k % 3 != 1      # cleanups from the 10th on, and refinements
+
+    def encode(self):
+        """Returns the segments and, for each pass, (segment, bytes of the
+        segment available once the pass is coded)."""
+        self.sig = [[0] * self.w for _ in range(self.h)]
+        self.visited = [[0] * self.w for _ in range(self.h)]
+        self.refined = [[0] * self.w for _ in range(self.h)]
+        self.cx = initial_contexts()
+        segments, ends = [], []
+        coder = None
+        for k in range(self.num_passes):
+            raw = self.is_raw(k)
+            if coder is None:
+                coder = RawEncoder() if raw else MQEncoder()
+            p = self.planes - 1 - (k + 2) // 3
+            kind = k % 3              # 0 cleanup, 1 sigprop, 2 magref
+            if kind == 0:
+                self.cleanup(p, coder)
+            elif kind == 1:
+                self.sigprop(p, coder, raw)
+            else:
+                self.magref(p, coder, raw)
+            if self.style & STYLE_RESET:
+                self.cx = initial_contexts()
+            if self.terminates(k):
+                segments.append(coder.flush())
+                ends.append((len(segments) - 1, None))
+                coder = None
+            else:
+                ends.append((len(segments), coder.length()))
+        result = []
+        for seg, n in ends:
+            full = len(segments[seg])
+            result.append((seg, full if n is None else min(n, full)))
+        return segments, result
+
+
+# --- Wavelet, T.800 Annex F ----------------------------------------------
+
+def fwd53(x):
+    n = len(x)
+    if n == 1:
+        return x[:], []
+
+    def ext(i):
+        if i < 0:
+            i = -i
+        if i >= n:
+            i = 2 * (n - 1) - i
+        return x[i]
+
+    d = [x[2 * k + 1] - (ext(2 * k) + ext(2 * k + 2)) // 2
+         for k in range(n // 2)]
+
+    def dext(k):
+        # d of the odd position 2k + 1, mirrored around the ends
+        pos = 2 * k + 1
+        if pos < 0:
+            pos = -pos
+        if pos >= n:
+            pos = 2 * (n - 1) - pos
+        return d[(pos - 1) // 2]
+
+    s = [x[2 * k] + (dext(k - 1) + dext(k) + 2) // 4
+         for k in range((n + 1) // 2)]
+    return s, d
+
+
+# Lifting constants and scaling of the 9/7 wavelet, F.4.8.2
+ALPHA = -1.586134342059924
+BETA = -0.052980118572961
+GAMMA = 0.882911075530934
+DELTA = 0.443506852043971
+K97 = 1.230174104914001
+
+
+def lift97(x, steps):
+    """Applies the lifting steps, (parity of the updated samples,
+    coefficient), to the interleaved signal x in place, extending it
+    symmetrically."""
+    n = len(x)
+
+    def ext(i):
+        if i < 0:
+            i = -i
+        if i >= n:
+            i = 2 * (n - 1) - i
+        return x[i]
+
+    for parity, c in steps:
+        for i in range(parity, n, 2):
+            x[i] += c * (ext(i - 1) + ext(i + 1))
+
+
+def fwd97(x):
+    n = len(x)
+    if n == 1:
+        return [float(x[0])], []
+    y = [float(v) for v in x]
+    lift97(y, [(1, ALPHA), (0, BETA), (1, GAMMA), (0, DELTA)])
+    return [v / K97 for v in y[0::2]], [v * K97 for v in y[1::2]]
+
+
+def inv97(s, d):
+    """1D_SR of the 9/7 wavelet, F.3.8.2."""
+    n = len(s) + len(d)
+    if n == 1:
+        return s[:]
+    x = [0.0] * n
+    x[0::2] = [v * K97 for v in s]
+    x[1::2] = [v / K97 for v in d]
+    lift97(x, [(0, -DELTA), (1, -GAMMA), (0, -BETA), (1, -ALPHA)])
+    return x
+
+
+def fwd_dwt(img, levels, fwd=fwd53):
+    """Returns bands[level] = (HL, LH, HH) for level 1..levels and the LL."""
+    bands = {}
+    ll = img
+    for lev in range(1, levels + 1):
+        h, w = len(ll), len(ll[0])
+        # VER_SD on every column, then HOR_SD on every row (F.4.8.1)
+        lo_rows = [[0] * w for _ in range((h + 1) // 2)]
+        hi_rows = [[0] * w for _ in range(h // 2)]
+        for x in range(w):
+            s, d = fwd([ll[y][x] for y in range(h)])
+            for i, v in enumerate(s):
+                lo_rows[i][x] = v
+            for i, v in enumerate(d):
+                hi_rows[i][x] = v
+
+        def split(rows):
+            lo, hi = [], []
+            for r in rows:
+                s, d = fwd(r)
+                lo.append(s)
+                hi.append(d)
+            return lo, hi
+
+        ll, hl = split(lo_rows)
+        lh, hh = split(hi_rows)
+        bands[lev] = (hl, lh, hh)
+    return ll, bands
+
+
+def inv_dwt97(ll, bands, levels):
+    """2D_SR: HOR_SR on every row, then VER_SR on every column (F.3.8.1)."""
+    for lev in range(levels, 0, -1):
+        hl, lh, hh = bands[lev]
+
+        def join(lo, hi):
+            return [inv97(s, d) for s, d in zip(lo, hi)]
+
+        lo_rows = join(ll, hl)
+        hi_rows = join(lh, hh)
+        h = len(lo_rows) + len(hi_rows)
+        w = len(lo_rows[0]) if lo_rows else len(hi_rows[0])
+        out = [[0.0] * w for _ in range(h)]
+        for x in range(w):
+            col = inv97([r[x] for r in lo_rows], [r[x] for r in hi_rows])
+            for y in range(h):
+                out[y][x] = col[y]
+        ll = out
+    return ll
+
+
+# --- Scalar quantisation, T.800 Annex E ----------------------------------
+
+def step_size(rb, delta):
+    """(exponent, mantissa) of the step nearest below delta, E.1.1.1."""
+    e = math.floor(math.log2(delta))
+    mu = min(int((delta / 2.0 ** e - 1) * 2048), 2047)
+    return rb - e, mu
+
+
+def quantise(coeffs, eps, mu, rb):
+    step = 2.0 ** (rb - eps) * (1 + mu / 2048.0)
+    q = [[int(abs(v) / step) * (1 if v >= 0 else -1) for v in row]
+         for row in coeffs]
+    # midpoint reconstruction of the reference decoder
+    rec = [[(abs(v) + 0.5) * step * (1 if v > 0 else -1) if v else 0.0
+            for v in row] for row in q]
+    return q, rec
+
+
+# --- Packets, T.800 Annex B ----------------------------------------------
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.c = 0
+        self.ct = 8
+
+    def put(self, b, n=1):
+        for i in range(n - 1, -1, -1):
+            self.c = (self.c << 1) | ((b >> i) & 1)
+            self.ct -= 1
+            if self.ct == 0:
+                self.out.append(self.c)
+                self.ct = 7 if self.c == 0xFF else 8
+                self.c = 0
+
+    def flush(self):
+        full = 7 if self.out and self.out[-1] == 0xFF else 8
+        if self.ct != full:
+            self.out.append(self.c << self.ct)
+        if self.out and self.out[-1] == 0xFF:
+            self.out.append(0)
+        return bytes(self.out)
+
+
+class TagTree:
+    def __init__(self, w, h, values):
+        self.levels = []
+        vals = [values[y * w + x] for y in range(h) for x in range(w)]
+        while True:
+            self.levels.append({'w': w, 'h': h, 'value': vals,
+                                'low': [0] * len(vals),
+                                'known': [False] * len(vals)})
+            if w == 1 and h == 1:
+                break
+            nw, nh = (w + 1) // 2, (h + 1) // 2
+            nv = [min(vals[yy * w + xx]
+                      for yy in range(2 * y, min(2 * y + 2, h))
+                      for xx in range(2 * x, min(2 * x + 2, w)))
+                  for y in range(nh) for x in range(nw)]
+            w, h, vals = nw, nh, nv
+
+    def encode(self, bw, x, y, threshold):
+        path = []
+        for lev in self.levels:
+            path.append((lev, y * lev['w'] + x))
+            x, y = x // 2, y // 2
+        low = 0
+        for lev, i in reversed(path):
+            if low > lev['low'][i]:
+                lev['low'][i] = low
+            else:
+                low = lev['low'][i]
+            while low < threshold:
+                if low >= lev['value'][i]:
+                    if not lev['known'][i]:
+                        bw.put(1)
+                        lev['known'][i] = True
+                    break
+                bw.put(0)
+                low += 1
+            lev['low'][i] = low
+
+
+def put_passes(bw, n):
+    """Table B.4."""
+    if n == 1:
+        bw.put(0)
+    elif n == 2:
+        bw.put(0b10, 2)
+    elif n <= 5:
+        bw.put(0b11, 2)
+        bw.put(n - 3, 2)
+    elif n <= 36:
+        bw.put(0b1111, 4)
+        bw.put(n - 6, 5)
+    else:
+        bw.put(0b111111111, 9)
+        bw.put(n - 37, 7)
+
+
+def floor_log2(n):
+    return n.bit_length() - 1
+
+
+class BandBlocks:
+    """Codeblocks of one band of one precinct, with their packet state."""
+
+    def __init__(self, coeffs, band, kmax, xcb, ycb, style, layers, salt):
+        self.blocks = []
+        h = len(coeffs)
+        w = len(coeffs[0]) if h else 0
+        self.bw = (w + (1 << xcb) - 1) >> xcb if w else 0
+        self.bh = (h + (1 << ycb) - 1) >> ycb if h else 0
+        for by in range(self.bh):
+            for bx in range(self.bw):
+                y0, x0 = by << ycb, bx << xcb
+                rows = [r[x0:x0 + (1 << xcb)] for r in coeffs[y0:y0 + (1 << ycb)]]
+                cb = CodeBlock(rows, band, style)
+                assert cb.planes <= kmax, 'coefficient beyond Kmax'
+                cb.segments, cb.ends = cb.encode()
+                cb.zero_planes = kmax - cb.planes
+                cb.lblock = 3
+                cb.passes_sent = 0
+                cb.layer_end = layer_ends(cb.num_passes, layers,
+                                          salt + len(self.blocks))
+                cb.first_layer = next((l for l in range(layers)
+                                       if cb.layer_end[l] > 0), 1 << 16)
+                self.blocks.append(cb)
+        if self.blocks:
+            self.inclusion = TagTree(self.bw, self.bh,
+                                     [b.first_layer for b in self.blocks])
+            self.zero_planes = TagTree(self.bw, self.bh,
+                                       [b.zero_planes for b in self.blocks])
+
+
+def layer_ends(passes, layers, salt):
+    """Passes coded once each layer is received; spread unevenly so that
+    blocks join late, skip layers, and split terminated and unterminated
+    segments between layers."""
+    ends = []
+    for l in range(layers - 1):
+        f = ((l + 1) / layers) ** (1 + (salt % 3) * 0.5)
+        ends.append(int(passes * f))
+    ends.append(passes)
+    if layers > 2 and salt % 4 == 1:
+        ends[0] = 0
+    for l in range(1, layers):
+        ends[l] = max(ends[l], ends[l - 1])
+    return ends
+
+
+def encode_packet(bands, layer):
+    bw = BitWriter()
+    body = bytearray()
+    if not any(cb.layer_end[layer] > cb.passes_sent
+               for b in bands for cb in b.blocks):
+        bw.put(0)
+        return bw.flush()
+    bw.put(1)
+    for b in bands:
+        for i, cb in enumerate(b.blocks):
+            x, y = i % b.bw, i // b.bw
+            new = cb.layer_end[layer] - cb.passes_sent
+            if cb.passes_sent == 0:
+                b.inclusion.encode(bw, x, y, layer + 1)
+            else:
+                bw.put(1 if new else 0)
+            if not new:
+                continue
+            if cb.passes_sent == 0:
+                b.zero_planes.encode(bw, x, y, 1 << 16)
+            put_passes(bw, new)
+            # one length per segment the new passes touch
+            first, last = cb.passes_sent, cb.passes_sent + new
+            pieces = []
+            for k in range(first, last):
+                seg, end = cb.ends[k]
+                if pieces and pieces[-1][0] == seg:
+                    pieces[-1][1] += 1
+                    pieces[-1][3] = end
+                else:
+                    start = cb.ends[k - 1][1] \
+                        if k and cb.ends[k - 1][0] == seg else 0
+                    pieces.append([seg, 1, start, end])
+            need = cb.lblock
+            for seg, n, start, end in pieces:
+                while (end - start) >> (need + floor_log2(n)):
+                    need += 1
+            bw.put((1 << (need - cb.lblock + 1)) - 2, need - cb.lblock + 1)
+            cb.lblock = need
+            for seg, n, start, end in pieces:
+                bw.put(end - start, cb.lblock + floor_log2(n))
+                body += cb.segments[seg][start:end]
+            cb.passes_sent = last
+    return bw.flush() + bytes(body)
+
+
+# --- Codestream ----------------------------------------------------------
+
+def marker(code, payload):
+    return struct.pack('>HH', code, len(payload) + 2) + payload
+
+
+PROGRESSIONS = ['LRCP', 'RLCP', 'RPCL', 'PCRL', 'CPRL']
+
+
+def encode_image(comps, width, height, bits, levels, xcb, ycb, style, layers,
+                 progression='LRCP', precincts=None, irreversible=False):
+    """Returns the codestream and the samples a decoder reconstructs from it.
+    precincts holds the (PPx, PPy) of each resolution, from the lowest."""
+    guard = 2
+    pps = precincts or [(15, 15)] * (levels + 1)
+    # (R_b, exponent, mantissa) of LL, then HL, LH, HH of each level; the
+    # log2 gains are 0, 1, 1, 2 (E.1.1.1). Lossy steps shrink at higher
+    # levels, roughly as the synthesis gains of the 9/7 bands grow.
+    steps = []
+    band_list = [(levels, BAND_LL)] + [(lev, band)
+                                       for lev in range(levels, 0, -1)
+                                       for band in (BAND_HL, BAND_LH,
+                                                    BAND_HH)]
+    for lev, band in band_list:
+        rb = bits + (band + 1) // 2
+        if irreversible:
+            base = 2.0 ** (bits - 7)
+            steps.append((rb,) + step_size(
+                rb, base / (1 << lev) * (1.5 if band == BAND_HH else 1.0)))
+        else:
+            steps.append((rb, rb, 0))
+
+    packets = {}      # (c, r, precinct) -> BandBlocks of the precinct
+    origins = {}      # (c, r, precinct) -> (y, x) on the reference grid
+    recon = []
+    for c, img in enumerate(comps):
+        shifted = [[v - (1 << (bits - 1)) for v in row] for row in img]
+        ll, dwt = fwd_dwt(shifted, levels, fwd97 if irreversible else fwd53)
+        coeffs = {(levels, BAND_LL): ll}
+        for lev in range(1, levels + 1):
+            hl, lh, hh = dwt[lev]
+            coeffs[(lev, BAND_HL)] = hl
+            coeffs[(lev, BAND_LH)] = lh
+            coeffs[(lev, BAND_HH)] = hh
+        quantised, rec = {}, {}
+        for (lev, band), (rb, eps, mu) in zip(band_list, steps):
+            if irreversible:
+                quantised[(lev, band)], rec[(lev, band)] = quantise(
+                    coeffs[(lev, band)], eps, mu, rb)
+            else:
+                quantised[(lev, band)] = coeffs[(lev, band)]
+        if irreversible:
+            out = inv_dwt97(rec[(levels, BAND_LL)],
+                            {lev: tuple(rec[(lev, b)]
+                                        for b in (BAND_HL, BAND_LH, BAND_HH))
+                             for lev in range(1, levels + 1)}, levels)
+            top = (1 << bits) - 1
+            recon.append([[max(0, min(top, math.floor(v + 0.5)
+                                      + (1 << (bits - 1))))
+                           for v in row] for row in out])
+        else:
+            recon.append(img)
+
+        for r in range(levels + 1):
+            ppx, ppy = pps[r]
+            scale = levels - r
+            rw = -(-width // (1 << scale))
+            rh = -(-height // (1 << scale))
+            if r == 0:
+                bands = [(levels, BAND_LL)]
+                bx, by = ppx, ppy
+            else:
+                bands = [(levels - r + 1, b)
+                         for b in (BAND_HL, BAND_LH, BAND_HH)]
+                bx, by = ppx - 1, ppy - 1
+            cbx, cby = min(xcb, bx), min(ycb, by)
+            npx = -(-rw // (1 << ppx))
+            npy = -(-rh // (1 << ppy))
+            for py in range(npy):
+                for px in range(npx):
+                    k = py * npx + px
+                    blocks = []
+                    for i, key in enumerate(bands):
+                        q = quantised[key]
+                        rb, eps, mu = steps[band_list.index(key)]
+                        sub = [row[px << bx:(px + 1) << bx]
+                               for row in q[py << by:(py + 1) << by]]
+                        sub = [row for row in sub if row]
+                        blocks.append(BandBlocks(
+                            sub, key[1], guard + eps - 1, cbx, cby, style,
+                            layers, 7 * r + 3 * c + i + 11 * k))
+                    packets[(c, r, k)] = blocks
+                    origins[(c, r, k)] = ((py << ppy) << scale,
+                                          (px << ppx) << scale)
+
+    order = {
+        'LRCP': lambda l, c, r, k: (l, r, c, k),
+        'RLCP': lambda l, c, r, k: (r, l, c, k),
+        'RPCL': lambda l, c, r, k: (r,) + origins[(c, r, k)] + (c, l),
+        'PCRL': lambda l, c, r, k: origins[(c, r, k)] + (c, r, l),
+        'CPRL': lambda l, c, r, k: (c,) + origins[(c, r, k)] + (r, l),
+    }[progression]
+    data = bytearray()
+    for l, (c, r, k) in sorted(((l, key) for l in range(layers)
+                                for key in packets),
+                               key=lambda p: order(p[0], *p[1])):
+        data += encode_packet(packets[(c, r, k)], l)
+
+    siz = struct.pack('>HIIIIIIIIH', 0, width, height, 0, 0, width, height,
+                      0, 0, len(comps))
+    siz += bytes([bits - 1, 1, 1]) * len(comps)
+    cod = struct.pack('>BBHBBBBBB', 1 if precincts else 0,
+                      PROGRESSIONS.index(progression), layers, 0, levels,
+                      xcb - 2, ycb - 2, style, 0 if irreversible else 1)
+    if precincts:
+        cod += bytes(ppx | ppy << 4 for ppx, ppy in precincts)
+    if irreversible:
+        qcd = bytes([guard << 5 | 2]) + b''.join(
+            struct.pack('>H', eps << 11 | mu) for _, eps, mu in steps)
+    else:
+        qcd = bytes([guard << 5]) + bytes(eps << 3 for _, eps, _ in steps)
+    sot_len = 12 + 2 + len(data)
+    sot = struct.pack('>HHHIBB', 0xFF90, 10, 0, sot_len, 0, 1)
+    return (b'\xff\x4f' + marker(0xFF51, siz) + marker(0xFF52, cod)
+            + marker(0xFF5C, qcd) + sot + b'\xff\x93' + bytes(data)
+            + b'\xff\xd9'), recon
+
+
+def synthetic(width, height, bits, comp, seed):
+    """Smooth gradients, flat patches and noise, so that blocks use both
+    run-length and regular cleanup coding and many bitplanes."""
+    top = (1 << bits) - 1
+    state = seed * 2654435761 + comp * 40503 + 1
+    img = []
+    for y in range(height):
+        row = []
+        for x in range(width):
+            state = (state * 1103515245 + 12345) & 0x7FFFFFFF
+            if (x // 8 + y // 8 + comp) % 5 == 0:
+                v = top // 3                               # flat patch
+            else:
+                v = (x * top) // max(width - 1, 1) // 2 \
+                    + (y * top) // max(height - 1, 1) // 3
+                v += (state >> 8) % (1 << max(bits - 3, 1))
+            row.append(max(0, min(top, v)))
+        img.append(row)
+    return img
+
+
+FIXTURES = [
+    # name, width, height, components, bits, levels, xcb, ycb, style, layers
+    ('default', 61, 45, 1, 12, 3, 4, 4, 0, 1),
+    ('bypass', 53, 38, 1, 16, 2, 5, 4, STYLE_BYPASS, 2),
+    ('termall_reset_vcausal', 47, 50, 1, 12, 3, 4, 5,
+     STYLE_TERMALL | STYLE_RESET | STYLE_VCAUSAL, 3),
+    ('segmark', 40, 33, 3, 8, 2, 4, 4, STYLE_SEGMARK, 1),
+    ('layers', 64, 41, 1, 12, 4, 4, 3, 0, 6),
+    ('all_styles', 45, 29, 1, 14, 2, 4, 4,
+     STYLE_BYPASS | STYLE_RESET | STYLE_TERMALL | STYLE_VCAUSAL
+     | STYLE_SEGMARK, 4),
+]
+
+# as above, then the progression, precincts of each resolution and wavelet
+EXTRA_FIXTURES = [
+    ('irreversible', 59, 43, 1, 12, 3, 4, 4, 0, 1, 'LRCP', None, True),
+    ('irreversible_layers', 50, 37, 3, 8, 2, 4, 4, STYLE_BYPASS, 3,
+     'RLCP', None, True),
+    ('rpcl_precincts', 57, 46, 2, 10, 3, 4, 4, 0, 3,
+     'RPCL', [(3, 3), (3, 3), (4, 3), (4, 4)], False),
+    ('pcrl_precincts', 45, 52, 3, 8, 2, 4, 4, STYLE_TERMALL, 2,
+     'PCRL', [(3, 4), (4, 3), (4, 4)], False),
+    ('cprl_irreversible', 62, 35, 2, 12, 2, 4, 4, 0, 4,
+     'CPRL', [(4, 4), (4, 4), (5, 4)], True),
+]
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), 'J2KPart1')
+    fixtures = [f + ('LRCP', None, False) for f in FIXTURES] + EXTRA_FIXTURES
+    for seed, (name, w, h, nc, bits, levels, xcb, ycb, style, layers,
+               progression, precincts, irreversible) in enumerate(fixtures):
+        comps = [synthetic(w, h, bits, c, seed + 1) for c in range(nc)]
+        cs, recon = encode_image(comps, w, h, bits, levels, xcb, ycb, style,
+                                 layers, progression, precincts,
+                                 irreversible)
+        with open(os.path.join(out, name + '.j2k'), 'wb') as f:
+            f.write(cs)
+        with open(os.path.join(out, name + '.raw'), 'wb') as f:
+            f.write(b''.join(struct.pack('<H', recon[c][y][x])
+                             for y in range(h) for x in range(w)
+                             for c in range(nc)))
+
+
+if __name__ == '__main__':
+    main()